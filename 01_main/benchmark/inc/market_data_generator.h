@@ -0,0 +1,79 @@
+// market_data_generator.h
+#ifndef MAIN_BENCHMARK_MARKET_DATA_GENERATOR_H_
+#define MAIN_BENCHMARK_MARKET_DATA_GENERATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+struct MarketDataOptions {
+  size_t assets = 100;
+  // New ticks per asset each advance(), one market second apart
+  size_t ticksPerRound = 60;
+  // Rounds a payload reaches back: with 2 every payload repeats the ticks
+  // of the round before, as a full-history API does
+  size_t historyRounds = 2;
+  // Share of ticks sent before the tick preceding them, in [0, 1]
+  double outOfOrderRatio = 0.0;
+  // Standard deviation of one tick's relative price step
+  double volatility = 0.001;
+  uint64_t seed = 1;
+  // Market time of the first tick, Unix seconds
+  int64_t startSeconds = 1700000000;
+};
+
+// Synthetic market data for N assets: prices follow a geometric random
+// walk, and chartPayload() renders an asset's recent ticks as a
+// dataForInstrument body for LsTcRepository::parseResponse(). The same
+// options, seed included, give the same payloads, round for round.
+// Not thread-safe; chartPayload() may be called concurrently between
+// advance() calls.
+class MarketDataGenerator {
+ public:
+  // Throws std::invalid_argument for no assets, no ticks per round, no
+  // history or a ratio outside [0, 1]
+  explicit MarketDataGenerator(const MarketDataOptions& options);
+
+  // "A0", "A1", ...
+  const std::vector<std::string>& assetIds() const { return m_assetIds; }
+
+  // Appends ticksPerRound ticks to every asset, dropping those past the
+  // history
+  void advance();
+
+  // Rounds advanced so far, and ticks generated per asset
+  size_t rounds() const { return m_rounds; }
+  int64_t ticksPerAsset() const {
+    return static_cast<int64_t>(m_rounds * m_options.ticksPerRound);
+  }
+  // Market time of the newest tick, Unix seconds
+  int64_t newestSeconds() const;
+
+  // The asset's ticks within the history, in send order
+  std::string chartPayload(size_t asset) const;
+  // chartPayload() of the asset with that id; throws std::out_of_range
+  // for an unknown one
+  std::string chartPayload(const std::string& asset_id) const;
+
+ private:
+  struct Tick {
+    int64_t seconds = 0;
+    double price = 0.0;
+  };
+
+  MarketDataOptions m_options;
+  std::vector<std::string> m_assetIds;
+  // Per asset, the ticks of the history in send order
+  std::vector<std::vector<Tick>> m_ticks;
+  std::vector<double> m_prices;
+  std::mt19937_64 m_random;
+  size_t m_rounds = 0;
+};
+
+}  // namespace Benchmark
+
+#endif  // MAIN_BENCHMARK_MARKET_DATA_GENERATOR_H_
@@ -0,0 +1,422 @@
+// macro_benchmark.cc
+//
+// End-to-end ingest and query benchmark. Every round the synthetic market
+// advances and the ingest use case pulls all assets through the real
+// path: LsTcRepository fetches and parses each payload, the interactor
+// filters it past the stored watermark, and TimeSeriesRepository writes
+// it through a SqlitePool. Query threads meanwhile aggregate recent
+// windows of random assets on the pool's readers.
+//
+// macro_benchmark [--assets N] [--ticks-per-round N] [--rounds N]
+//                 [--tick-rate TICKS_PER_S] [--out-of-order RATIO]
+//                 [--query-threads N] [--seed N] [--db PATH] [--json]
+//                 [--trace FILE]
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "i_time_series_repository.h"
+#include "ingest_time_series.h"
+#include "market_data_generator.h"
+#include "network_connector.h"
+#include "network_data_repository.h"
+#include "sqlite3_pool.h"
+#include "timeseries_repository.h"
+#include "tracing.h"
+
+namespace Benchmark {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr char kUnit[] = "USD";
+
+struct RunOptions {
+  MarketDataOptions market;
+  size_t rounds = 50;
+  // Ticks per second over all assets the feed is held to; 0 runs flat out
+  double tickRate = 0.0;
+  size_t queryThreads = 2;
+  // Each query aggregates this much recent market time in 1 minute
+  // buckets
+  int64_t queryWindowSeconds = 3600;
+  int64_t bucketSeconds = 60;
+  size_t fetchConcurrency = 4;
+  // Empty: a temporary file, removed afterwards
+  std::string dbPath;
+  bool json = false;
+  // Non-empty: the run's trace spans are written there as Chrome JSON
+  std::string tracePath;
+};
+
+// ============================================================
+// Wiring
+// ============================================================
+
+class SyntheticResponse : public Gateways::Network::IHttpResponse {
+ public:
+  explicit SyntheticResponse(std::string body) : m_body(std::move(body)) {}
+
+  int statusCode() const override { return 200; }
+  std::string body() const override { return m_body; }
+  std::string_view bodyView() const override { return m_body; }
+  std::string takeBody() override { return std::move(m_body); }
+  const Gateways::Network::ResponseHeaders& headers() const override {
+    return m_headers;
+  }
+  std::string header(const std::string&) const override { return ""; }
+
+ private:
+  std::string m_body;
+  Gateways::Network::ResponseHeaders m_headers;
+};
+
+// Answers each instrument request with the generator's current payload
+class SyntheticChartClient : public Gateways::Network::IHttpClient {
+ public:
+  explicit SyntheticChartClient(const MarketDataGenerator& market)
+      : m_market(market) {}
+
+  void setDefaultHeaders(const Gateways::Network::Headers&) override {}
+  void setConnectTimeout(int) override {}
+  void setReadTimeout(int) override {}
+
+  std::unique_ptr<Gateways::Network::IHttpResponse> get(
+      const std::string& url,
+      const Gateways::Network::QueryParams& params) override {
+    return get(url, params, {});
+  }
+  std::unique_ptr<Gateways::Network::IHttpResponse> get(
+      const std::string&, const Gateways::Network::QueryParams& params,
+      const Gateways::Network::Headers&) override {
+    return std::make_unique<SyntheticResponse>(
+        m_market.chartPayload(params.at("instrumentId")));
+  }
+  std::unique_ptr<Gateways::Network::IHttpResponse> post(
+      const std::string&, const std::string&, const std::string&) override {
+    throw Gateways::Network::NetworkException("Not supported");
+  }
+
+ private:
+  const MarketDataGenerator& m_market;
+};
+
+// The ingest use case's port onto the sqlite3 gateway
+class TimeSeriesStore : public UseCases::ITimeSeriesRepository {
+ public:
+  explicit TimeSeriesStore(
+      Gateways::Repositories::Sqlite3::TimeSeriesRepository& repository)
+      : m_repository(repository) {}
+
+  std::optional<Entities::TimeSeriesPoint> getLatestPoint(
+      const std::string& asset_id, const std::string& unit_id) override {
+    return m_repository.getLatestPoint(asset_id, unit_id);
+  }
+  void addPoints(
+      const std::vector<Entities::TimeSeriesPoint>& points) override {
+    m_repository.addPoints(points);
+  }
+
+ private:
+  Gateways::Repositories::Sqlite3::TimeSeriesRepository& m_repository;
+};
+
+// ============================================================
+// Measurement
+// ============================================================
+
+// Peak resident set, in KiB
+int64_t peakRssKib() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;  // KiB on Linux
+}
+
+// Current resident set, in KiB; 0 where /proc is missing
+int64_t currentRssKib() {
+  std::ifstream statm("/proc/self/statm");
+  int64_t pages = 0;
+  int64_t resident = 0;
+  if (!(statm >> pages >> resident)) return 0;
+  return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+double quantile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) return 0.0;
+  const size_t rank = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+struct Report {
+  size_t rounds = 0;
+  size_t fetched = 0;
+  size_t written = 0;
+  size_t expected = 0;  // ticks generated, what written should reach
+  double ingestSeconds = 0.0;
+  std::vector<double> queryMicros;  // sorted
+  size_t queryErrors = 0;
+  int64_t peakRss = 0;
+  int64_t endRss = 0;
+};
+
+void printReport(const RunOptions& options, const Report& report) {
+  const double pointsPerSecond =
+      report.ingestSeconds > 0 ? report.written / report.ingestSeconds : 0.0;
+  const auto& latencies = report.queryMicros;
+  if (options.json) {
+    std::printf(
+        "{\"seed\":%llu,\"assets\":%zu,\"rounds\":%zu,"
+        "\"ticks_per_round\":%zu,\"out_of_order\":%g,"
+        "\"query_threads\":%zu,\"fetched_points\":%zu,"
+        "\"written_points\":%zu,\"expected_points\":%zu,"
+        "\"ingest_seconds\":%.6f,\"ingest_points_per_second\":%.1f,"
+        "\"queries\":%zu,\"query_errors\":%zu,\"query_p50_us\":%.1f,"
+        "\"query_p99_us\":%.1f,\"query_max_us\":%.1f,"
+        "\"peak_rss_kib\":%lld,\"end_rss_kib\":%lld}\n",
+        static_cast<unsigned long long>(options.market.seed),
+        options.market.assets, report.rounds, options.market.ticksPerRound,
+        options.market.outOfOrderRatio, options.queryThreads, report.fetched,
+        report.written, report.expected, report.ingestSeconds,
+        pointsPerSecond, latencies.size(), report.queryErrors,
+        quantile(latencies, 0.5), quantile(latencies, 0.99),
+        latencies.empty() ? 0.0 : latencies.back(),
+        static_cast<long long>(report.peakRss),
+        static_cast<long long>(report.endRss));
+    return;
+  }
+  std::printf("seed %llu: %zu assets x %zu ticks x %zu rounds, %g out of "
+              "order, %zu query threads\n",
+              static_cast<unsigned long long>(options.market.seed),
+              options.market.assets, options.market.ticksPerRound,
+              report.rounds, options.market.outOfOrderRatio,
+              options.queryThreads);
+  std::printf("ingest:  %zu of %zu points written (%zu fetched) in %.3f s, "
+              "%.0f points/s\n",
+              report.written, report.expected, report.fetched,
+              report.ingestSeconds, pointsPerSecond);
+  std::printf("queries: %zu (%zu failed), p50 %.1f us, p99 %.1f us, "
+              "max %.1f us\n",
+              latencies.size(), report.queryErrors, quantile(latencies, 0.5),
+              quantile(latencies, 0.99),
+              latencies.empty() ? 0.0 : latencies.back());
+  std::printf("memory:  peak RSS %lld KiB, at end %lld KiB\n",
+              static_cast<long long>(report.peakRss),
+              static_cast<long long>(report.endRss));
+}
+
+// ============================================================
+// Run
+// ============================================================
+
+int run(const RunOptions& options) {
+  namespace fs = std::filesystem;
+  const bool temporary = options.dbPath.empty();
+  const std::string path =
+      temporary ? (fs::temp_directory_path() /
+                   ("macro_benchmark_" + std::to_string(getpid()) + ".db"))
+                      .string()
+                : options.dbPath;
+
+  MarketDataGenerator market(options.market);
+  Report report;
+  {
+    Gateways::Database::SqlitePoolOptions pool_options;
+    pool_options.readerCount = std::max<size_t>(options.queryThreads, 1);
+    Gateways::Database::SqlitePool pool(path, pool_options);
+
+    // One repository per thread over the shared pool
+    Gateways::Repositories::Sqlite3::TimeSeriesRepository writer(pool);
+    writer.initSchema();
+    writer.createUnit({kUnit, "$", "US Dollar"});
+    for (const auto& id : market.assetIds()) {
+      writer.createAsset({id, id, "", "synthetic"});
+    }
+
+    SyntheticChartClient client(market);
+    Gateways::Repositories::Network::LsTcRepository network(client);
+    TimeSeriesStore store(writer);
+    UseCases::IngestTimeSeriesOptions ingest_options;
+    ingest_options.fetchConcurrency = options.fetchConcurrency;
+    UseCases::IngestTimeSeriesInteractor ingest(network, store,
+                                                ingest_options);
+
+    std::atomic<int64_t> newest_ms{-1};  // none until the first round
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<double>> latencies(options.queryThreads);
+    std::vector<size_t> errors(options.queryThreads, 0);
+    std::vector<std::thread> queriers;
+    for (size_t t = 0; t < options.queryThreads; ++t) {
+      queriers.emplace_back([&, t] {
+        Gateways::Repositories::Sqlite3::TimeSeriesRepository reader(pool);
+        std::mt19937_64 random(options.market.seed + 1 + t);
+        const auto& ids = market.assetIds();
+        while (!stop.load(std::memory_order_acquire)) {
+          const int64_t to_ms = newest_ms.load(std::memory_order_acquire);
+          if (to_ms < 0) {
+            std::this_thread::yield();
+            continue;
+          }
+          const auto& id = ids[random() % ids.size()];
+          const auto start = Clock::now();
+          try {
+            auto buckets = reader.aggregate(
+                id, kUnit, to_ms - options.queryWindowSeconds * 1000, to_ms,
+                options.bucketSeconds * 1000);
+            latencies[t].push_back(
+                std::chrono::duration<double, std::micro>(Clock::now() -
+                                                          start)
+                    .count());
+          } catch (const std::exception&) {
+            ++errors[t];
+          }
+        }
+      });
+    }
+
+    const double round_ticks = static_cast<double>(
+        options.market.assets * options.market.ticksPerRound);
+    if (!options.tracePath.empty()) {
+      Tracing::Tracer::instance().start();
+    }
+    const auto ingest_start = Clock::now();
+    try {
+      for (size_t round = 0; round < options.rounds; ++round) {
+        if (options.tickRate > 0) {
+          // Round r may start once its ticks are due
+          std::this_thread::sleep_until(
+              ingest_start + std::chrono::duration_cast<Clock::duration>(
+                                 std::chrono::duration<double>(
+                                     round * round_ticks / options.tickRate)));
+        }
+        market.advance();
+        const auto response = ingest.execute({market.assetIds(), kUnit});
+        for (const auto& result : response.instruments) {
+          report.fetched += result.fetched;
+        }
+        report.written += response.written;
+        ++report.rounds;
+        newest_ms.store(market.newestSeconds() * 1000,
+                        std::memory_order_release);
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "Ingest failed: " << e.what() << "\n";
+    }
+    report.ingestSeconds =
+        std::chrono::duration<double>(Clock::now() - ingest_start).count();
+    stop.store(true, std::memory_order_release);
+    for (auto& querier : queriers) {
+      querier.join();
+    }
+    if (!options.tracePath.empty()) {
+      Tracing::Tracer::instance().stop();
+      std::ofstream trace(options.tracePath);
+      Tracing::Tracer::instance().writeChromeTrace(trace);
+      if (!trace) {
+        std::cerr << "Cannot write " << options.tracePath << "\n";
+      }
+    }
+
+    for (size_t t = 0; t < options.queryThreads; ++t) {
+      report.queryMicros.insert(report.queryMicros.end(),
+                                latencies[t].begin(), latencies[t].end());
+      report.queryErrors += errors[t];
+    }
+    std::sort(report.queryMicros.begin(), report.queryMicros.end());
+    report.expected = static_cast<size_t>(market.ticksPerAsset()) *
+                      options.market.assets;
+    report.peakRss = peakRssKib();
+    report.endRss = currentRssKib();
+  }
+  if (temporary) {
+    std::error_code ignored;
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+      fs::remove(path + suffix, ignored);
+    }
+  }
+
+  printReport(options, report);
+  return report.rounds == options.rounds && report.queryErrors == 0 ? 0 : 1;
+}
+
+bool parseArgs(int argc, char** argv, RunOptions& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--json") {
+      options.json = true;
+      continue;
+    }
+    if (i + 1 >= argc) return false;
+    const char* value = argv[++i];
+    char* end = nullptr;
+    if (arg == "--db") {
+      options.dbPath = value;
+      continue;
+    }
+    if (arg == "--trace") {
+      options.tracePath = value;
+      continue;
+    }
+    if (arg == "--tick-rate" || arg == "--out-of-order") {
+      const double number = std::strtod(value, &end);
+      if (*end != '\0') return false;
+      (arg == "--tick-rate" ? options.tickRate
+                            : options.market.outOfOrderRatio) = number;
+      continue;
+    }
+    const unsigned long long number = std::strtoull(value, &end, 10);
+    if (*end != '\0' || *value == '-') return false;
+    if (arg == "--assets") {
+      options.market.assets = number;
+    } else if (arg == "--ticks-per-round") {
+      options.market.ticksPerRound = number;
+    } else if (arg == "--rounds") {
+      options.rounds = number;
+    } else if (arg == "--query-threads") {
+      options.queryThreads = number;
+    } else if (arg == "--fetch-concurrency") {
+      options.fetchConcurrency = number;
+    } else if (arg == "--seed") {
+      options.market.seed = number;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+}  // namespace Benchmark
+
+int main(int argc, char** argv) {
+  Benchmark::RunOptions options;
+  if (!Benchmark::parseArgs(argc, argv, options)) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--assets N] [--ticks-per-round N] [--rounds N]"
+                 " [--tick-rate TICKS_PER_S] [--out-of-order RATIO]"
+                 " [--query-threads N] [--fetch-concurrency N] [--seed N]"
+                 " [--db PATH] [--json] [--trace FILE]\n";
+    return 2;
+  }
+  try {
+    return Benchmark::run(options);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 2;
+  }
+}
@@ -0,0 +1,109 @@
+// market_data_generator.cc
+#include "market_data_generator.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+namespace Benchmark {
+
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586;
+
+// In [0, 1), from the top 53 bits. The standard distributions may differ
+// between libraries, so they are avoided to keep runs reproducible.
+double uniform(std::mt19937_64& random) {
+  return static_cast<double>(random() >> 11) * 0x1.0p-53;
+}
+
+// Standard normal, Box-Muller
+double normal(std::mt19937_64& random) {
+  const double u1 = 1.0 - uniform(random);  // in (0, 1]
+  const double u2 = uniform(random);
+  return std::sqrt(-2.0 * std::log(u1)) * std::cos(kTwoPi * u2);
+}
+
+}  // namespace
+
+MarketDataGenerator::MarketDataGenerator(const MarketDataOptions& options)
+    : m_options(options), m_random(options.seed) {
+  if (options.assets == 0 || options.ticksPerRound == 0 ||
+      options.historyRounds == 0) {
+    throw std::invalid_argument(
+        "Assets, ticks per round and history rounds must be positive");
+  }
+  if (!(options.outOfOrderRatio >= 0.0 && options.outOfOrderRatio <= 1.0)) {
+    throw std::invalid_argument("Out-of-order ratio must be in [0, 1]");
+  }
+
+  m_assetIds.reserve(options.assets);
+  m_prices.reserve(options.assets);
+  for (size_t i = 0; i < options.assets; ++i) {
+    m_assetIds.push_back("A" + std::to_string(i));
+    m_prices.push_back(10.0 + 190.0 * uniform(m_random));
+  }
+  m_ticks.resize(options.assets);
+}
+
+void MarketDataGenerator::advance() {
+  const int64_t first = m_options.startSeconds + ticksPerAsset();
+  const size_t history = m_options.historyRounds * m_options.ticksPerRound;
+  for (size_t a = 0; a < m_options.assets; ++a) {
+    auto& ticks = m_ticks[a];
+    for (size_t i = 0; i < m_options.ticksPerRound; ++i) {
+      m_prices[a] *= std::exp(m_options.volatility * normal(m_random));
+      ticks.push_back({first + static_cast<int64_t>(i), m_prices[a]});
+      // Drawn for every tick, so the ratio does not shift later prices
+      const bool late = uniform(m_random) < m_options.outOfOrderRatio;
+      if (late && ticks.size() > 1) {
+        std::swap(ticks[ticks.size() - 1], ticks[ticks.size() - 2]);
+      }
+    }
+    if (ticks.size() > history) {
+      const auto dropped = static_cast<std::ptrdiff_t>(ticks.size() - history);
+      ticks.erase(ticks.begin(), ticks.begin() + dropped);
+    }
+  }
+  ++m_rounds;
+}
+
+int64_t MarketDataGenerator::newestSeconds() const {
+  return m_options.startSeconds + ticksPerAsset() - 1;
+}
+
+std::string MarketDataGenerator::chartPayload(size_t asset) const {
+  const auto& ticks = m_ticks.at(asset);
+  std::string body =
+      R"({"info":{"instrumentId":)" + std::to_string(asset) +
+      R"(,"currency":"USD"},"series":{"history":{"data":[)";
+  body.reserve(body.size() + ticks.size() * 24 + 8);
+  char pair[64];
+  for (size_t i = 0; i < ticks.size(); ++i) {
+    const int length = std::snprintf(
+        pair, sizeof(pair), "%s[%lld,%.4f]", i == 0 ? "" : ",",
+        static_cast<long long>(ticks[i].seconds), ticks[i].price);
+    body.append(pair, static_cast<size_t>(length));
+  }
+  body += "]}}}";
+  return body;
+}
+
+std::string MarketDataGenerator::chartPayload(
+    const std::string& asset_id) const {
+  // Ids are "A<index>", so the index is read back from the id
+  size_t index = 0;
+  bool valid = asset_id.size() > 1 && asset_id[0] == 'A';
+  for (size_t i = 1; valid && i < asset_id.size(); ++i) {
+    valid = asset_id[i] >= '0' && asset_id[i] <= '9' && i < 10;
+    index = index * 10 + static_cast<size_t>(asset_id[i] - '0');
+  }
+  if (!valid || index >= m_assetIds.size() || m_assetIds[index] != asset_id) {
+    throw std::out_of_range("Unknown asset: " + asset_id);
+  }
+  return chartPayload(index);
+}
+
+}  // namespace Benchmark
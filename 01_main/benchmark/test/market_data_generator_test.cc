@@ -0,0 +1,99 @@
+#include "market_data_generator.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "network_data_repository.h"
+
+namespace Benchmark {
+namespace {
+
+using Gateways::Repositories::Network::LsTcRepository;
+
+MarketDataOptions SmallMarket() {
+  MarketDataOptions options;
+  options.assets = 3;
+  options.ticksPerRound = 10;
+  options.seed = 42;
+  return options;
+}
+
+std::vector<std::string> Payloads(MarketDataGenerator& market,
+                                  size_t rounds) {
+  std::vector<std::string> payloads;
+  for (size_t r = 0; r < rounds; ++r) {
+    market.advance();
+    for (size_t a = 0; a < market.assetIds().size(); ++a) {
+      payloads.push_back(market.chartPayload(a));
+    }
+  }
+  return payloads;
+}
+
+TEST(MarketDataGeneratorTest, SameSeedSamePayloads) {
+  MarketDataGenerator first(SmallMarket());
+  MarketDataGenerator second(SmallMarket());
+  EXPECT_EQ(Payloads(first, 3), Payloads(second, 3));
+
+  auto options = SmallMarket();
+  options.seed = 43;
+  MarketDataGenerator other(options);
+  MarketDataGenerator again(SmallMarket());
+  EXPECT_NE(Payloads(other, 1), Payloads(again, 1));
+}
+
+TEST(MarketDataGeneratorTest, PayloadParsesToTheHistory) {
+  MarketDataGenerator market(SmallMarket());
+  market.advance();
+  auto points = LsTcRepository::parseResponse("A1", market.chartPayload(1));
+  ASSERT_EQ(points.size(), 10u);
+  EXPECT_EQ(points.front().timestamp_ms, 1700000000LL * 1000);
+  EXPECT_EQ(points.back().timestamp_ms, market.newestSeconds() * 1000);
+  for (const auto& point : points) {
+    EXPECT_GT(point.value, 0.0);
+  }
+
+  // Two rounds of history: the third drops the first
+  market.advance();
+  market.advance();
+  points = LsTcRepository::parseResponse("A1", market.chartPayload("A1"));
+  ASSERT_EQ(points.size(), 20u);
+  EXPECT_EQ(points.front().timestamp_ms, (1700000000LL + 10) * 1000);
+  EXPECT_EQ(market.ticksPerAsset(), 30);
+}
+
+TEST(MarketDataGeneratorTest, OutOfOrderTicksStillParseSorted) {
+  auto options = SmallMarket();
+  options.outOfOrderRatio = 1.0;
+  MarketDataGenerator market(options);
+  market.advance();
+  const auto payload = market.chartPayload(0);
+  // The second tick went out before the first
+  EXPECT_NE(payload.find("[[1700000001,"), std::string::npos);
+
+  const auto points = LsTcRepository::parseResponse("A0", payload);
+  ASSERT_EQ(points.size(), 10u);
+  for (size_t i = 1; i < points.size(); ++i) {
+    EXPECT_LT(points[i - 1].timestamp_ms, points[i].timestamp_ms);
+  }
+}
+
+TEST(MarketDataGeneratorTest, RejectsBadOptions) {
+  auto options = SmallMarket();
+  options.assets = 0;
+  EXPECT_THROW(MarketDataGenerator{options}, std::invalid_argument);
+  options = SmallMarket();
+  options.outOfOrderRatio = 1.5;
+  EXPECT_THROW(MarketDataGenerator{options}, std::invalid_argument);
+
+  MarketDataGenerator market(SmallMarket());
+  EXPECT_THROW(market.chartPayload("A3"), std::out_of_range);
+  EXPECT_THROW(market.chartPayload("B0"), std::out_of_range);
+  EXPECT_THROW(market.chartPayload("A01"), std::out_of_range);
+}
+
+}  // namespace
+}  // namespace Benchmark
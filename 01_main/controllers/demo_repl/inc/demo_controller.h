@@ -3,7 +3,9 @@
 #define DEMO_CONTROLLER_H_
 
 #include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -40,12 +42,19 @@ class DemoController : public RequestResponseInterface {
 
   // Implement the interface methods
   Response HandleRequest(const Request& request) override;
+  Response HandleRequestView(const RequestView& request) override;
   std::vector<std::string> GetAvailableCommands() const override;
+  const CommandMetrics* GetMetrics() const override { return metrics_.get(); }
+
+  // Times every command into metrics from now on; nullptr stops it
+  void SetMetrics(std::shared_ptr<CommandMetrics> metrics) {
+    metrics_ = std::move(metrics);
+  }
 
  private:
   // Command handler type
   using CommandHandler =
-      std::function<Response(const std::vector<std::string>&)>;
+      std::function<Response(const std::vector<std::string_view>&)>;
 
   struct CommandData {
     std::string description;
@@ -58,10 +67,12 @@ class DemoController : public RequestResponseInterface {
   // Storage for text items
   std::vector<std::string> items_;
 
+  std::shared_ptr<CommandMetrics> metrics_;
+
   // Individual command handlers
-  Response HandleAdd(const std::vector<std::string>& args);
-  Response HandleDelete(const std::vector<std::string>& args);
-  Response HandleList(const std::vector<std::string>& args);
+  Response HandleAdd(const std::vector<std::string_view>& args);
+  Response HandleDelete(const std::vector<std::string_view>& args);
+  Response HandleList(const std::vector<std::string_view>& args);
 
   // Helper to register commands
   void RegisterCommand(const std::string& name, const std::string& description,
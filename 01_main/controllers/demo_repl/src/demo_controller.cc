@@ -2,6 +2,8 @@
 
 #include <sstream>
 
+#include "tracing.h"
+
 namespace presenter {
 
 DemoController::DemoController() {
@@ -15,15 +17,26 @@ DemoController::DemoController() {
 }
 
 Response DemoController::HandleRequest(const Request& request) {
+  RequestView view{request.command, {}};
+  view.arguments.assign(request.arguments.begin(), request.arguments.end());
+  return HandleRequestView(view);
+}
+
+Response DemoController::HandleRequestView(const RequestView& request) {
   // Find the command handler
-  auto it = command_handlers_.find(request.command);
+  const std::string command(request.command);
+  auto it = command_handlers_.find(command);
 
   if (it == command_handlers_.end()) {
-    return Response{false, "Unknown command: " + request.command};
+    return Response{false, "Unknown command: " + command};
   }
 
-  // Execute the handler
-  return it->second.handler(request.arguments);
+  // Execute the handler, timed and traced under its registered name
+  TRACE_SPAN("controller", it->first.c_str());
+  ScopedCommandTimer timer(metrics_.get(), it->first);
+  Response response = it->second.handler(request.arguments);
+  timer.Succeeded(response.success);
+  return response;
 }
 
 std::vector<std::string> DemoController::GetAvailableCommands() const {
@@ -41,44 +54,49 @@ void DemoController::RegisterCommand(const std::string& name,
   command_handlers_[name] = {description, std::move(handler)};
 }
 
-Response DemoController::HandleAdd(const std::vector<std::string>& args) {
+Response DemoController::HandleAdd(const std::vector<std::string_view>& args) {
   if (args.empty()) {
     return Response{false, "Add requires at least one argument"};
   }
 
   // Join all arguments into a single string
-  std::ostringstream oss;
+  std::string item;
   for (size_t i = 0; i < args.size(); ++i) {
-    if (i > 0) oss << " ";
-    oss << args[i];
+    if (i > 0) item += ' ';
+    item.append(args[i]);
   }
 
-  std::string item = oss.str();
   items_.push_back(item);
 
   return Response{true, "Added: \"" + item + "\""};
 }
 
-Response DemoController::HandleDelete(const std::vector<std::string>& args) {
+Response DemoController::HandleDelete(
+    const std::vector<std::string_view>& args) {
   size_t count = items_.size();
   items_.clear();
 
   return Response{true, "Deleted " + std::to_string(count) + " item(s)"};
 }
 
-Response DemoController::HandleList(const std::vector<std::string>& args) {
+Response DemoController::HandleList(
+    const std::vector<std::string_view>& args) {
   if (items_.empty()) {
     return Response{true, "No items stored"};
   }
 
   std::ostringstream oss;
   oss << "Stored items (" << items_.size() << "):\n";
+  ResponseData data;
+  data.columns = {"index", "item"};
+  data.rows.reserve(items_.size());
 
   for (size_t i = 0; i < items_.size(); ++i) {
     oss << "  " << (i + 1) << ". " << items_[i] << "\n";
+    data.rows.push_back({static_cast<int64_t>(i + 1), items_[i]});
   }
 
-  return Response{true, oss.str()};
+  return Response{true, oss.str(), std::move(data)};
 }
 
 }  // namespace presenter
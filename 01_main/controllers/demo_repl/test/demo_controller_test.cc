@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+
 namespace presenter {
 namespace {
 
@@ -107,6 +109,10 @@ TEST_F(DemoControllerTest, HandleListWithItems) {
   EXPECT_NE(resp.message.find("Stored items"), std::string::npos);
   EXPECT_NE(resp.message.find("1. first"), std::string::npos);
   EXPECT_NE(resp.message.find("2. second"), std::string::npos);
+  ASSERT_EQ(resp.data.rows.size(), 2u);
+  EXPECT_EQ(resp.data.columns, (std::vector<std::string>{"index", "item"}));
+  EXPECT_EQ(resp.data.rows[1],
+            (std::vector<Value>{int64_t{2}, std::string("second")}));
 }
 
 // Test: Delete when empty
@@ -174,5 +180,24 @@ TEST_F(DemoControllerTest, HandleDeleteIgnoresArguments) {
   EXPECT_NE(resp.message.find("Deleted 1 item(s)"), std::string::npos);
 }
 
+// Test: Metrics count each registered command and its failures
+TEST_F(DemoControllerTest, MetricsRecordEachCommand) {
+  EXPECT_EQ(controller_.GetMetrics(), nullptr);
+  auto metrics = std::make_shared<CommandMetrics>();
+  controller_.SetMetrics(metrics);
+
+  controller_.HandleRequest({"add", {"item"}});
+  controller_.HandleRequest({"add", {}});
+  controller_.HandleRequest({"list", {}});
+  controller_.HandleRequest({"unknown", {}});
+
+  EXPECT_EQ(controller_.GetMetrics(), metrics.get());
+  const auto commands = metrics->Commands();
+  ASSERT_EQ(commands.size(), 2u);  // unknown commands have no series
+  EXPECT_EQ(commands.at("add").calls, 2u);
+  EXPECT_EQ(commands.at("add").errors, 1u);
+  EXPECT_EQ(commands.at("list").calls, 1u);
+}
+
 }  // namespace
 }  // namespace presenter
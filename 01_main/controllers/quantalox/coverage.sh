@@ -8,6 +8,36 @@ set -e
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 IMAGE_NAME="gtest-dev:latest"
 
+# -----------------------------------------------------------------------------
+# Configuration
+# -----------------------------------------------------------------------------
+
+# Destination relative to where the script is executed (CWD)
+# This matches the Docker volume mount logic (-v $(pwd):/project)
+DEST_PARENT_DIR="./integration"
+
+# The per-command metrics the CLI interface header includes
+M_HPP_PATH="${SCRIPT_DIR}/../../presenters/cli/inc/command_metrics.h"
+
+# -----------------------------------------------------------------------------
+# Setup & Cleanup
+# -----------------------------------------------------------------------------
+
+echo "📂 Copying required header files..."
+cp -r "${M_HPP_PATH}" "${DEST_PARENT_DIR}/"
+
+cleanup() {
+    echo "🧹 Cleaning up integration artifacts..."
+    rm -rf "${DEST_PARENT_DIR}/command_metrics.h"
+}
+
+# Register the trap to run on EXIT (happens on success, error, or interrupt)
+trap cleanup EXIT
+
+# -----------------------------------------------------------------------------
+# Main Execution
+# -----------------------------------------------------------------------------
+
 # Build image if it doesn't exist
 if [[ "$(docker images -q ${IMAGE_NAME} 2> /dev/null)" == "" ]]; then
     echo "Image not found. Building..."
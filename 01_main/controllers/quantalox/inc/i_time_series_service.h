@@ -0,0 +1,67 @@
+#ifndef USE_CASES_I_TIME_SERIES_SERVICE_H_
+#define USE_CASES_I_TIME_SERIES_SERVICE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+
+namespace UseCases {
+
+// One instrument of an ingest, as IngestTimeSeriesResult
+struct TimeSeriesIngestResult {
+  std::string instrument_id;
+  size_t fetched = 0;  // points the source returned
+  size_t written = 0;  // of those, newer than the stored series
+  std::optional<std::string> error;  // the fetch failed; nothing written
+};
+
+// One bucket of an aggregate, as the gateway's PointBucket: points with
+// timestamp_ms in [bucket_start_ms, bucket_start_ms + bucket width)
+struct TimeSeriesBucket {
+  int64_t bucket_start_ms = 0;
+  double open = 0.0;
+  double high = 0.0;
+  double low = 0.0;
+  double close = 0.0;
+  double avg = 0.0;
+  int64_t count = 0;
+};
+
+// What the time-series commands drive: the ingest use case and the
+// queries of the time-series store. The application wires it to
+// IngestTimeSeriesInteractor and the sqlite3 TimeSeriesRepository.
+class ITimeSeriesService {
+ public:
+  virtual ~ITimeSeriesService() = default;
+
+  // Incremental ingest: only points past each series' newest are
+  // written. One result per distinct instrument, in request order
+  virtual std::vector<TimeSeriesIngestResult> ingest(
+      const std::vector<std::string>& instrument_ids,
+      const std::string& unit_id) = 0;
+  // Downsampled in the store: one bucket per non-empty bucket_ms wide
+  // bucket in [from_ms, to_ms], by start
+  virtual std::vector<TimeSeriesBucket> aggregate(const std::string& asset_id,
+                                                  const std::string& unit_id,
+                                                  int64_t from_ms,
+                                                  int64_t to_ms,
+                                                  int64_t bucket_ms) = 0;
+  // Newest point of each asset in one batch; result[i] is for
+  // asset_ids[i], nullopt if it has none
+  virtual std::vector<std::optional<Entities::TimeSeriesPoint>>
+  getLatestPoints(const std::vector<std::string>& asset_ids,
+                  const std::string& unit_id) = 0;
+  // Converts values in place from from_unit_id to to_unit_id; false,
+  // with values untouched, if the units are not connected
+  virtual bool convert(std::vector<double>& values,
+                       const std::string& from_unit_id,
+                       const std::string& to_unit_id) = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_I_TIME_SERIES_SERVICE_H_
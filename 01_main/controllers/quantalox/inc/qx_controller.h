@@ -2,13 +2,17 @@
 #ifndef QX_CONTROLLER_H_
 #define QX_CONTROLLER_H_
 
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "i_account_repository.h"
 #include "i_request_response.h"
+#include "i_time_series_service.h"
 
 namespace presenter {
 
@@ -22,8 +26,27 @@ class DemoController : public RequestResponseInterface {
   DemoController(DemoController&&) = delete;
   DemoController& operator=(DemoController&&) = delete;
 
+  // Accounts per list_accounts page unless the command gives a limit
+  static constexpr size_t kListPageSize = 100;
+
   Response HandleRequest(const Request& request) override;
+  // list_accounts streams every account page by page (each page a part);
+  // the other commands answer whole
+  Response HandleRequestStreamed(const RequestView& request,
+                                 const ResponseSink& sink) override;
   std::vector<std::string> GetAvailableCommands() const override;
+  const CommandMetrics* GetMetrics() const override { return metrics_.get(); }
+
+  // Times every command into metrics from now on; nullptr stops it
+  void SetMetrics(std::shared_ptr<CommandMetrics> metrics) {
+    metrics_ = std::move(metrics);
+  }
+
+  // Adds the time-series commands (ingest, range, latest, convert),
+  // reading and writing series in unit_id; each reply ends with the rows
+  // it handled and how long that took
+  void SetTimeSeries(std::shared_ptr<UseCases::ITimeSeriesService> service,
+                     const std::string& unit_id);
 
  private:
   using CommandHandler =
@@ -37,14 +60,27 @@ class DemoController : public RequestResponseInterface {
   std::unordered_map<std::string, CommandData> command_handlers_;
 
   UseCases::IAccountRepository& repository_;
+  std::shared_ptr<CommandMetrics> metrics_;
+  std::shared_ptr<UseCases::ITimeSeriesService> time_series_;
+  std::string unit_id_;
 
   // Command handlers - each one routes to repository interface
   Response HandleCreateAccount(const std::vector<std::string>& args);
   Response HandleGetAccount(const std::vector<std::string>& args);
   Response HandleListAccounts(const std::vector<std::string>& args);
+  Response StreamListAccounts(const std::vector<std::string>& args,
+                              const ResponseSink& sink);
+  // The limit and start of list_accounts; an error Response if malformed
+  std::optional<Response> ParseListArgs(const std::vector<std::string>& args,
+                                        std::optional<size_t>& limit,
+                                        std::optional<std::string>& after_name);
   Response HandleDeleteAccount(const std::vector<std::string>& args);
   Response HandleSetProperty(const std::vector<std::string>& args);
   Response HandleGetProperty(const std::vector<std::string>& args);
+  Response HandleIngest(const std::vector<std::string>& args);
+  Response HandleRange(const std::vector<std::string>& args);
+  Response HandleLatest(const std::vector<std::string>& args);
+  Response HandleConvert(const std::vector<std::string>& args);
 
   void RegisterCommand(const std::string& name, const std::string& description,
                        CommandHandler handler);
@@ -1,11 +1,56 @@
 // demo_controller.cc
 #include "qx_controller.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <optional>
 #include <sstream>
 
+#include "tracing.h"
+
 namespace presenter {
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Whole text as a decimal integer
+bool ParseInt64(const std::string& text, int64_t& value) {
+  if (text.empty()) return false;
+  errno = 0;
+  char* end = nullptr;
+  const long long parsed = std::strtoll(text.c_str(), &end, 10);
+  if (errno != 0 || *end != '\0') return false;
+  value = parsed;
+  return true;
+}
+
+bool ParseDouble(const std::string& text, double& value) {
+  if (text.empty()) return false;
+  errno = 0;
+  char* end = nullptr;
+  const double parsed = std::strtod(text.c_str(), &end);
+  if (errno != 0 || *end != '\0') return false;
+  value = parsed;
+  return true;
+}
+
+// The closing line of a time-series reply: "<rows> rows in <ms> ms"
+std::string Handled(size_t rows, Clock::time_point start) {
+  const std::chrono::duration<double, std::milli> elapsed =
+      Clock::now() - start;
+  std::ostringstream oss;
+  oss << rows << (rows == 1 ? " row" : " rows") << " in " << std::fixed
+      << std::setprecision(3) << elapsed.count() << " ms";
+  return oss.str();
+}
+
+}  // namespace
+
 DemoController::DemoController(UseCases::IAccountRepository& repository)
     : repository_(repository) {
   RegisterCommand(
@@ -14,7 +59,8 @@ DemoController::DemoController(UseCases::IAccountRepository& repository)
   RegisterCommand("get_account", "Get account by id (get_account <id>)",
                   [this](const auto& args) { return HandleGetAccount(args); });
   RegisterCommand(
-      "list_accounts", "List all accounts",
+      "list_accounts",
+      "List accounts by name (list_accounts [limit] [after_name])",
       [this](const auto& args) { return HandleListAccounts(args); });
   RegisterCommand(
       "delete_account", "Delete account (delete_account <id>)",
@@ -34,7 +80,43 @@ Response DemoController::HandleRequest(const Request& request) {
     return Response{false, "Unknown command: " + request.command};
   }
 
-  return it->second.handler(request.arguments);
+  // Timed and traced under the registered name
+  TRACE_SPAN("controller", it->first.c_str());
+  ScopedCommandTimer timer(metrics_.get(), it->first);
+  Response response = it->second.handler(request.arguments);
+  timer.Succeeded(response.success);
+  return response;
+}
+
+Response DemoController::HandleRequestStreamed(const RequestView& request,
+                                              const ResponseSink& sink) {
+  if (request.command != "list_accounts") {
+    return RequestResponseInterface::HandleRequestStreamed(request, sink);
+  }
+  TRACE_SPAN("controller", "list_accounts");
+  ScopedCommandTimer timer(metrics_.get(), "list_accounts");
+  Response response = StreamListAccounts(ToRequest(request).arguments, sink);
+  timer.Succeeded(response.success);
+  return response;
+}
+
+void DemoController::SetTimeSeries(
+    std::shared_ptr<UseCases::ITimeSeriesService> service,
+    const std::string& unit_id) {
+  time_series_ = std::move(service);
+  unit_id_ = unit_id;
+  RegisterCommand(
+      "ingest", "Fetch new points (ingest <instrument> [instrument...])",
+      [this](const auto& args) { return HandleIngest(args); });
+  RegisterCommand(
+      "range",
+      "Aggregate a series (range <asset> <from_ms> <to_ms> [bucket_ms])",
+      [this](const auto& args) { return HandleRange(args); });
+  RegisterCommand("latest", "Newest points (latest <asset> [asset...])",
+                  [this](const auto& args) { return HandleLatest(args); });
+  RegisterCommand(
+      "convert", "Convert values (convert <from_unit> <to_unit> <value...>)",
+      [this](const auto& args) { return HandleConvert(args); });
 }
 
 std::vector<std::string> DemoController::GetAvailableCommands() const {
@@ -57,10 +139,6 @@ Response DemoController::HandleCreateAccount(
     return Response{false, "Usage: create_account <id> <name>"};
   }
 
-  if (repository_.accountExists(args[0])) {
-    return Response{false, "Account already exists: " + args[0]};
-  }
-
   Entities::Account account;
   account.id = args[0];
   account.name = args[1];
@@ -68,7 +146,14 @@ Response DemoController::HandleCreateAccount(
                            std::chrono::system_clock::now().time_since_epoch())
                            .count();
 
-  repository_.createAccount(account);
+  switch (repository_.tryCreateAccount(account)) {
+    case Entities::AccountConflict::Id:
+      return Response{false, "Account already exists: " + account.id};
+    case Entities::AccountConflict::Name:
+      return Response{false, "Account name already exists: " + account.name};
+    case Entities::AccountConflict::None:
+      break;
+  }
 
   return Response{
       true, "Account created: id=" + account.id + ", name=" + account.name};
@@ -86,12 +171,42 @@ Response DemoController::HandleGetAccount(
     return Response{false, "Account not found: " + args[0]};
   }
 
-  return Response{true, "id=" + account->id + ", name=" + account->name};
+  ResponseData data;
+  data.columns = {"id", "name"};
+  data.rows.push_back({account->id, account->name});
+  return Response{true, "id=" + account->id + ", name=" + account->name,
+                  std::move(data)};
+}
+
+std::optional<Response> DemoController::ParseListArgs(
+    const std::vector<std::string>& args, std::optional<size_t>& limit,
+    std::optional<std::string>& after_name) {
+  if (!args.empty()) {
+    const std::string& text = args[0];
+    if (text.empty() || text.size() > 9 ||
+        text.find_first_not_of("0123456789") != std::string::npos ||
+        std::stoul(text) == 0) {
+      return Response{false,
+                      "Usage: list_accounts [limit] [after_name], limit > 0"};
+    }
+    limit = std::stoul(text);
+  }
+  if (args.size() > 1) {
+    after_name = args[1];
+  }
+  return std::nullopt;
 }
 
 Response DemoController::HandleListAccounts(
     const std::vector<std::string>& args) {
-  auto accounts = repository_.getAllAccounts();
+  std::optional<size_t> requested;
+  std::optional<std::string> after_name;
+  if (auto error = ParseListArgs(args, requested, after_name)) {
+    return *error;
+  }
+  const size_t limit = requested.value_or(kListPageSize);
+
+  auto accounts = repository_.listAccounts(after_name, limit);
 
   if (accounts.empty()) {
     return Response{true, "No accounts"};
@@ -99,12 +214,61 @@ Response DemoController::HandleListAccounts(
 
   std::ostringstream oss;
   oss << "Accounts (" << accounts.size() << "):\n";
+  ResponseData data;
+  data.columns = {"id", "name"};
+  data.rows.reserve(accounts.size());
   for (size_t i = 0; i < accounts.size(); ++i) {
     oss << "  " << (i + 1) << ". " << accounts[i].id << " - "
         << accounts[i].name << "\n";
+    data.rows.push_back({accounts[i].id, accounts[i].name});
+  }
+  // A full page may have more after it
+  if (accounts.size() == limit) {
+    oss << "More: list_accounts " << limit << " " << accounts.back().name
+        << "\n";
   }
 
-  return Response{true, oss.str()};
+  return Response{true, oss.str(), std::move(data)};
+}
+
+Response DemoController::StreamListAccounts(
+    const std::vector<std::string>& args, const ResponseSink& sink) {
+  // Without a limit every account is listed; memory stays at one page
+  std::optional<size_t> limit;
+  std::optional<std::string> after_name;
+  if (auto error = ParseListArgs(args, limit, after_name)) {
+    sink(error->message);
+    return Response{false, ""};
+  }
+
+  std::string part;  // reused for every page
+  size_t listed = 0;
+  while (!limit || listed < *limit) {
+    const size_t want =
+        limit ? std::min(kListPageSize, *limit - listed) : kListPageSize;
+    auto accounts = repository_.listAccounts(after_name, want);
+    part.clear();
+    if (listed == 0) {
+      part = accounts.empty() ? "No accounts" : "Accounts:\n";
+    }
+    for (const auto& account : accounts) {
+      part += "  " + std::to_string(++listed) + ". " + account.id + " - " +
+              account.name + "\n";
+    }
+    const bool last_page = accounts.size() < want;
+    if (!accounts.empty()) {
+      after_name = accounts.back().name;
+    }
+    if (limit && listed == *limit && !last_page) {
+      // As for a whole page, more may follow
+      part += "More: list_accounts " + std::to_string(*limit) + " " +
+              *after_name + "\n";
+    }
+    if ((!part.empty() && !sink(part)) || last_page) {
+      break;
+    }
+  }
+  return Response{true, ""};
 }
 
 Response DemoController::HandleDeleteAccount(
@@ -154,4 +318,125 @@ Response DemoController::HandleGetProperty(
   return Response{true, args[1] + "=" + value.value()};
 }
 
+Response DemoController::HandleIngest(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    return Response{false, "Usage: ingest <instrument> [instrument...]"};
+  }
+
+  const auto start = Clock::now();
+  auto results = time_series_->ingest(args, unit_id_);
+
+  size_t fetched = 0;
+  size_t written = 0;
+  bool failed = false;
+  std::ostringstream oss;
+  for (const auto& result : results) {
+    fetched += result.fetched;
+    written += result.written;
+    if (result.error) {
+      oss << "  " << result.instrument_id << ": " << *result.error << "\n";
+      failed = true;
+    }
+  }
+  oss << "Ingested " << results.size() << " instruments, " << written
+      << " of " << fetched << " points new: " << Handled(written, start);
+  return Response{!failed, oss.str()};
+}
+
+Response DemoController::HandleRange(const std::vector<std::string>& args) {
+  int64_t from_ms = 0;
+  int64_t to_ms = 0;
+  int64_t bucket_ms = 0;
+  const bool bucketed = args.size() > 3;
+  if (args.size() < 3 || !ParseInt64(args[1], from_ms) ||
+      !ParseInt64(args[2], to_ms) || from_ms > to_ms ||
+      (bucketed && (!ParseInt64(args[3], bucket_ms) || bucket_ms <= 0))) {
+    return Response{false,
+                    "Usage: range <asset> <from_ms> <to_ms> [bucket_ms], "
+                    "from_ms <= to_ms, bucket_ms > 0"};
+  }
+  if (!bucketed) {
+    // Buckets align to the epoch, so the widest holds any range after it
+    bucket_ms = std::numeric_limits<int64_t>::max();
+  }
+
+  // The store downsamples, so only the buckets come back
+  const auto start = Clock::now();
+  auto buckets =
+      time_series_->aggregate(args[0], unit_id_, from_ms, to_ms, bucket_ms);
+
+  size_t points = 0;
+  std::ostringstream oss;
+  oss << args[0] << " (" << buckets.size() << " buckets):\n";
+  ResponseData data;
+  data.columns = {"bucket_start_ms", "open", "high", "low",
+                  "close",           "avg",  "count"};
+  data.rows.reserve(buckets.size());
+  for (const auto& bucket : buckets) {
+    points += static_cast<size_t>(bucket.count);
+    oss << "  " << bucket.bucket_start_ms << " open=" << bucket.open
+        << " high=" << bucket.high << " low=" << bucket.low
+        << " close=" << bucket.close << " avg=" << bucket.avg
+        << " count=" << bucket.count << "\n";
+    data.rows.push_back({bucket.bucket_start_ms, bucket.open, bucket.high,
+                         bucket.low, bucket.close, bucket.avg, bucket.count});
+  }
+  oss << Handled(points, start);
+  return Response{true, oss.str(), std::move(data)};
+}
+
+Response DemoController::HandleLatest(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    return Response{false, "Usage: latest <asset> [asset...]"};
+  }
+
+  // All assets in one batch: cached ones cost no query
+  const auto start = Clock::now();
+  auto points = time_series_->getLatestPoints(args, unit_id_);
+
+  size_t found = 0;
+  std::ostringstream oss;
+  ResponseData data;
+  data.columns = {"asset_id", "timestamp_ms", "value"};
+  for (size_t i = 0; i < args.size() && i < points.size(); ++i) {
+    oss << "  " << args[i] << ": ";
+    if (points[i]) {
+      oss << points[i]->value << " at " << points[i]->timestamp_ms << "\n";
+      data.rows.push_back(
+          {args[i], points[i]->timestamp_ms, points[i]->value});
+      ++found;
+    } else {
+      oss << "no points\n";
+      data.rows.push_back({args[i], Value{}, Value{}});
+    }
+  }
+  oss << Handled(found, start);
+  return Response{true, oss.str(), std::move(data)};
+}
+
+Response DemoController::HandleConvert(const std::vector<std::string>& args) {
+  std::vector<double> values(args.size() > 2 ? args.size() - 2 : 0);
+  bool parsed = args.size() > 2;
+  for (size_t i = 0; parsed && i < values.size(); ++i) {
+    parsed = ParseDouble(args[i + 2], values[i]);
+  }
+  if (!parsed) {
+    return Response{false,
+                    "Usage: convert <from_unit> <to_unit> <value> [value...]"};
+  }
+
+  const auto start = Clock::now();
+  if (!time_series_->convert(values, args[0], args[1])) {
+    return Response{false, "No conversion from " + args[0] + " to " + args[1]};
+  }
+
+  std::ostringstream oss;
+  for (size_t i = 0; i < values.size(); ++i) {
+    oss << "  " << args[i + 2] << " " << args[0] << " = " << values[i] << " "
+        << args[1] << "\n";
+  }
+  oss << Handled(values.size(), start);
+  return Response{true, oss.str()};
+}
+
 }  // namespace presenter
@@ -2,13 +2,18 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "qx_controller.h"
 
 using ::testing::_;
+using ::testing::Eq;
 using ::testing::HasSubstr;
+using ::testing::Not;
 using ::testing::Return;
 
 // --- Mock repository ---
@@ -16,11 +21,19 @@ using ::testing::Return;
 class MockAccountRepository : public UseCases::IAccountRepository {
  public:
   MOCK_METHOD(void, createAccount, (const Entities::Account&), (override));
+  MOCK_METHOD(Entities::AccountConflict, tryCreateAccount,
+              (const Entities::Account&), (override));
+  MOCK_METHOD(void, createAccounts, (const std::vector<Entities::Account>&),
+              (override));
+  MOCK_METHOD(std::vector<Entities::AccountConflict>, findAccountConflicts,
+              (const std::vector<Entities::Account>&), (override));
   MOCK_METHOD(std::optional<Entities::Account>, getAccount,
               (const std::string&), (override));
   MOCK_METHOD(std::optional<Entities::Account>, getAccountByName,
               (const std::string&), (override));
   MOCK_METHOD(std::vector<Entities::Account>, getAllAccounts, (), (override));
+  MOCK_METHOD(std::vector<Entities::AccountSummary>, listAccounts,
+              (const std::optional<std::string>&, size_t), (override));
   MOCK_METHOD(void, updateAccount, (const Entities::Account&), (override));
   MOCK_METHOD(void, deleteAccount, (const std::string&), (override));
   MOCK_METHOD(bool, accountExists, (const std::string&), (override));
@@ -40,6 +53,15 @@ class MockAccountRepository : public UseCases::IAccountRepository {
               (const std::string&), (override));
   MOCK_METHOD(std::vector<Entities::AccountProperty>, getPropertiesByPrefix,
               (const std::string&, const std::string&), (override));
+  MOCK_METHOD(std::vector<Entities::AccountProperty>, listProperties,
+              (const std::string&, const std::optional<std::string>&, size_t),
+              (override));
+  MOCK_METHOD(std::vector<std::vector<Entities::AccountProperty>>,
+              getPropertiesForAccounts, (const std::vector<std::string>&),
+              (override));
+  MOCK_METHOD(std::vector<Entities::AccountWithProperties>,
+              getAccountsWithProperties,
+              (const std::optional<std::string>&, size_t), (override));
   MOCK_METHOD(bool, propertyExists, (const std::string&, const std::string&),
               (override));
   MOCK_METHOD(void, removeProperty, (const std::string&, const std::string&),
@@ -132,7 +154,8 @@ TEST_F(DemoControllerTest, CreateAccount_OneArg_Fails) {
 }
 
 TEST_F(DemoControllerTest, CreateAccount_AlreadyExists_Fails) {
-  EXPECT_CALL(mock_repo_, accountExists("acc_1")).WillOnce(Return(true));
+  EXPECT_CALL(mock_repo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::Id));
 
   auto r = controller_->HandleRequest(
       MakeRequest("create_account", {"acc_1", "Alice"}));
@@ -141,9 +164,20 @@ TEST_F(DemoControllerTest, CreateAccount_AlreadyExists_Fails) {
   EXPECT_THAT(r.message, HasSubstr("already exists"));
 }
 
+TEST_F(DemoControllerTest, CreateAccount_NameTaken_Fails) {
+  EXPECT_CALL(mock_repo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::Name));
+
+  auto r = controller_->HandleRequest(
+      MakeRequest("create_account", {"acc_2", "Alice"}));
+
+  EXPECT_FALSE(r.success);
+  EXPECT_THAT(r.message, HasSubstr("name already exists: Alice"));
+}
+
 TEST_F(DemoControllerTest, CreateAccount_Success) {
-  EXPECT_CALL(mock_repo_, accountExists("acc_1")).WillOnce(Return(false));
-  EXPECT_CALL(mock_repo_, createAccount(_)).Times(1);
+  EXPECT_CALL(mock_repo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::None));
 
   auto r = controller_->HandleRequest(
       MakeRequest("create_account", {"acc_1", "Alice"}));
@@ -156,9 +190,11 @@ TEST_F(DemoControllerTest, CreateAccount_Success) {
 TEST_F(DemoControllerTest, CreateAccount_PassesCorrectFields) {
   Entities::Account captured;
 
-  EXPECT_CALL(mock_repo_, accountExists("x")).WillOnce(Return(false));
-  EXPECT_CALL(mock_repo_, createAccount(_))
-      .WillOnce([&captured](const Entities::Account& a) { captured = a; });
+  EXPECT_CALL(mock_repo_, tryCreateAccount(_))
+      .WillOnce([&captured](const Entities::Account& a) {
+        captured = a;
+        return Entities::AccountConflict::None;
+      });
 
   controller_->HandleRequest(MakeRequest("create_account", {"x", "Y"}));
 
@@ -196,6 +232,12 @@ TEST_F(DemoControllerTest, GetAccount_Found_ReturnsDetails) {
   EXPECT_TRUE(r.success);
   EXPECT_THAT(r.message, HasSubstr("acc_1"));
   EXPECT_THAT(r.message, HasSubstr("Alice"));
+  // The same, typed
+  EXPECT_EQ(r.data.columns, (std::vector<std::string>{"id", "name"}));
+  ASSERT_EQ(r.data.rows.size(), 1u);
+  EXPECT_EQ(r.data.rows[0],
+            (std::vector<presenter::Value>{std::string("acc_1"),
+                                           std::string("Alice")}));
 }
 
 // =====================================================================
@@ -203,8 +245,9 @@ TEST_F(DemoControllerTest, GetAccount_Found_ReturnsDetails) {
 // =====================================================================
 
 TEST_F(DemoControllerTest, ListAccounts_Empty) {
-  EXPECT_CALL(mock_repo_, getAllAccounts())
-      .WillOnce(Return(std::vector<Entities::Account>{}));
+  constexpr size_t kPage = presenter::DemoController::kListPageSize;
+  EXPECT_CALL(mock_repo_, listAccounts(Eq(std::nullopt), kPage))
+      .WillOnce(Return(std::vector<Entities::AccountSummary>{}));
 
   auto r = controller_->HandleRequest(MakeRequest("list_accounts"));
 
@@ -213,12 +256,12 @@ TEST_F(DemoControllerTest, ListAccounts_Empty) {
 }
 
 TEST_F(DemoControllerTest, ListAccounts_WithAccounts) {
-  std::vector<Entities::Account> accounts = {
-      MakeAccount("a1", "Alice"),
-      MakeAccount("a2", "Bob"),
+  std::vector<Entities::AccountSummary> accounts = {
+      {"a1", "Alice", 1000},
+      {"a2", "Bob", 1000},
   };
 
-  EXPECT_CALL(mock_repo_, getAllAccounts()).WillOnce(Return(accounts));
+  EXPECT_CALL(mock_repo_, listAccounts(_, _)).WillOnce(Return(accounts));
 
   auto r = controller_->HandleRequest(MakeRequest("list_accounts"));
 
@@ -228,6 +271,140 @@ TEST_F(DemoControllerTest, ListAccounts_WithAccounts) {
   EXPECT_THAT(r.message, HasSubstr("Alice"));
   EXPECT_THAT(r.message, HasSubstr("a2"));
   EXPECT_THAT(r.message, HasSubstr("Bob"));
+  EXPECT_THAT(r.message, Not(HasSubstr("More:")));
+}
+
+TEST_F(DemoControllerTest, ListAccounts_FullPageOffersNext) {
+  std::vector<Entities::AccountSummary> accounts = {
+      {"a2", "Bob", 1000},
+      {"a3", "Carol", 1000},
+  };
+
+  EXPECT_CALL(mock_repo_, listAccounts(Eq(std::optional<std::string>("Alice")),
+                                       2u))
+      .WillOnce(Return(accounts));
+
+  auto r = controller_->HandleRequest(
+      MakeRequest("list_accounts", {"2", "Alice"}));
+
+  EXPECT_TRUE(r.success);
+  EXPECT_THAT(r.message, HasSubstr("Bob"));
+  EXPECT_THAT(r.message, HasSubstr("More: list_accounts 2 Carol"));
+}
+
+TEST_F(DemoControllerTest, ListAccounts_BadLimit_Fails) {
+  EXPECT_CALL(mock_repo_, listAccounts(_, _)).Times(0);
+
+  for (const char* limit : {"0", "-1", "ten", "99999999999"}) {
+    auto r = controller_->HandleRequest(MakeRequest("list_accounts", {limit}));
+    EXPECT_FALSE(r.success) << limit;
+    EXPECT_THAT(r.message, HasSubstr("Usage"));
+  }
+}
+
+// Streamed list_accounts pages through the repository
+
+class StreamedListTest : public DemoControllerTest {
+ protected:
+  presenter::Response Stream(const std::vector<std::string>& args = {},
+                             size_t stop_after = 1000) {
+    parts_.clear();
+    presenter::Request request = MakeRequest("list_accounts", args);
+    presenter::RequestView view{request.command, {}};
+    view.arguments.assign(request.arguments.begin(), request.arguments.end());
+    return controller_->HandleRequestStreamed(
+        view, [&](std::string_view part) {
+          parts_.emplace_back(part);
+          return parts_.size() < stop_after;
+        });
+  }
+
+  static std::vector<Entities::AccountSummary> Page(int first, int count) {
+    std::vector<Entities::AccountSummary> page;
+    for (int i = first; i < first + count; ++i) {
+      page.push_back({"id" + std::to_string(i), Name(i), 1000});
+    }
+    return page;
+  }
+
+  static std::string Name(int i) {
+    std::string name = std::to_string(i);
+    return "n" + std::string(6 - name.size(), '0') + name;
+  }
+
+  std::vector<std::string> parts_;
+};
+
+TEST_F(StreamedListTest, ListsEveryAccountOnePagePerPart) {
+  constexpr size_t kPage = presenter::DemoController::kListPageSize;
+  ::testing::InSequence pages;
+  EXPECT_CALL(mock_repo_, listAccounts(Eq(std::nullopt), kPage))
+      .WillOnce(Return(Page(0, kPage)));
+  EXPECT_CALL(mock_repo_,
+              listAccounts(Eq(std::optional<std::string>(Name(kPage - 1))),
+                           kPage))
+      .WillOnce(Return(Page(kPage, 3)));
+
+  auto r = Stream();
+
+  EXPECT_TRUE(r.success);
+  EXPECT_TRUE(r.message.empty());
+  ASSERT_EQ(parts_.size(), 2u);
+  EXPECT_THAT(parts_[0], HasSubstr("Accounts:\n  1. id0 - n000000\n"));
+  EXPECT_THAT(parts_[1], HasSubstr("103. id102 - n000102\n"));
+  EXPECT_THAT(parts_[1], Not(HasSubstr("More:")));
+}
+
+TEST_F(StreamedListTest, LimitCapsTheListingAndOffersTheNextPage) {
+  constexpr size_t kPage = presenter::DemoController::kListPageSize;
+  ::testing::InSequence pages;
+  EXPECT_CALL(mock_repo_, listAccounts(Eq(std::optional<std::string>("a")),
+                                       kPage))
+      .WillOnce(Return(Page(0, kPage)));
+  EXPECT_CALL(mock_repo_, listAccounts(_, 50u))
+      .WillOnce(Return(Page(kPage, 50)));
+
+  Stream({"150", "a"});
+
+  ASSERT_EQ(parts_.size(), 2u);
+  EXPECT_THAT(parts_[1], HasSubstr("150. id149"));
+  EXPECT_THAT(parts_[1], HasSubstr("More: list_accounts 150 " + Name(149)));
+}
+
+TEST_F(StreamedListTest, StopsQueryingWhenTheSinkStops) {
+  constexpr size_t kPage = presenter::DemoController::kListPageSize;
+  EXPECT_CALL(mock_repo_, listAccounts(_, kPage))
+      .WillOnce(Return(Page(0, kPage)));
+
+  Stream({}, 1);
+
+  EXPECT_EQ(parts_.size(), 1u);
+}
+
+TEST_F(StreamedListTest, EmptyAndMalformedListings) {
+  EXPECT_CALL(mock_repo_, listAccounts(_, _))
+      .WillOnce(Return(std::vector<Entities::AccountSummary>{}));
+  EXPECT_TRUE(Stream().success);
+  EXPECT_EQ(parts_, (std::vector<std::string>{"No accounts"}));
+
+  auto r = Stream({"0"});
+  EXPECT_FALSE(r.success);
+  ASSERT_EQ(parts_.size(), 1u);
+  EXPECT_THAT(parts_[0], HasSubstr("Usage"));
+}
+
+TEST_F(StreamedListTest, OtherCommandsAnswerInOnePart) {
+  EXPECT_CALL(mock_repo_, getAccount("x")).WillOnce(Return(std::nullopt));
+  presenter::RequestView view{"get_account", {"x"}};
+
+  auto r = controller_->HandleRequestStreamed(
+      view, [&](std::string_view part) {
+        parts_.emplace_back(part);
+        return true;
+      });
+
+  EXPECT_FALSE(r.success);
+  EXPECT_EQ(parts_, (std::vector<std::string>{"Account not found: x"}));
 }
 
 // =====================================================================
@@ -330,16 +507,182 @@ TEST_F(DemoControllerTest, GetProperty_Found_ReturnsValue) {
   EXPECT_THAT(r.message, HasSubstr("blue"));
 }
 
+// =====================================================================
+// Metrics
+// =====================================================================
+
+TEST_F(DemoControllerTest, Metrics_RecordWholeAndStreamedCommands) {
+  auto metrics = std::make_shared<presenter::CommandMetrics>();
+  controller_->SetMetrics(metrics);
+  EXPECT_CALL(mock_repo_, getAccount("x")).WillOnce(Return(std::nullopt));
+  EXPECT_CALL(mock_repo_, listAccounts(_, _))
+      .WillRepeatedly(Return(std::vector<Entities::AccountSummary>{}));
+
+  controller_->HandleRequest(MakeRequest("get_account", {"x"}));
+  controller_->HandleRequest(MakeRequest("list_accounts"));
+  controller_->HandleRequestStreamed({"list_accounts", {}},
+                                     [](std::string_view) { return true; });
+
+  const auto commands = metrics->Commands();
+  EXPECT_EQ(commands.at("get_account").calls, 1u);
+  EXPECT_EQ(commands.at("get_account").errors, 1u);
+  EXPECT_EQ(commands.at("list_accounts").calls, 2u);
+  EXPECT_EQ(commands.at("list_accounts").errors, 0u);
+}
+
+// =====================================================================
+// Time-series commands
+// =====================================================================
+
+class MockTimeSeriesService : public UseCases::ITimeSeriesService {
+ public:
+  MOCK_METHOD(std::vector<UseCases::TimeSeriesIngestResult>, ingest,
+              (const std::vector<std::string>&, const std::string&),
+              (override));
+  MOCK_METHOD(std::vector<UseCases::TimeSeriesBucket>, aggregate,
+              (const std::string&, const std::string&, int64_t, int64_t,
+               int64_t),
+              (override));
+  MOCK_METHOD(std::vector<std::optional<Entities::TimeSeriesPoint>>,
+              getLatestPoints,
+              (const std::vector<std::string>&, const std::string&),
+              (override));
+  MOCK_METHOD(bool, convert,
+              (std::vector<double>&, const std::string&, const std::string&),
+              (override));
+};
+
+class TimeSeriesCommandsTest : public DemoControllerTest {
+ protected:
+  void SetUp() override {
+    DemoControllerTest::SetUp();
+    controller_->SetTimeSeries(service_, "EUR");
+  }
+
+  std::shared_ptr<::testing::StrictMock<MockTimeSeriesService>> service_ =
+      std::make_shared<::testing::StrictMock<MockTimeSeriesService>>();
+};
+
+TEST_F(TimeSeriesCommandsTest, CommandsAreListedOnlyOnceConfigured) {
+  EXPECT_EQ(controller_->GetAvailableCommands().size(), 10u);
+  presenter::DemoController plain(mock_repo_);
+  EXPECT_EQ(plain.GetAvailableCommands().size(), 6u);
+  EXPECT_FALSE(plain.HandleRequest(MakeRequest("latest", {"A"})).success);
+}
+
+TEST_F(TimeSeriesCommandsTest, IngestReportsNewPointsAndFailures) {
+  EXPECT_CALL(*service_, ingest(std::vector<std::string>{"A", "B"}, "EUR"))
+      .WillOnce(Return(std::vector<UseCases::TimeSeriesIngestResult>{
+          {"A", 10, 4, std::nullopt}, {"B", 0, 0, "HTTP 503"}}));
+
+  auto r = controller_->HandleRequest(MakeRequest("ingest", {"A", "B"}));
+
+  EXPECT_FALSE(r.success);  // B failed
+  EXPECT_THAT(r.message, HasSubstr("B: HTTP 503"));
+  EXPECT_THAT(r.message, HasSubstr("Ingested 2 instruments, 4 of 10 points"));
+  EXPECT_THAT(r.message, ::testing::ContainsRegex("4 rows in [0-9.]+ ms$"));
+  EXPECT_FALSE(controller_->HandleRequest(MakeRequest("ingest")).success);
+}
+
+TEST_F(TimeSeriesCommandsTest, RangeAggregatesInTheStore) {
+  EXPECT_CALL(*service_, aggregate("A", "EUR", 0, 5999, 3000))
+      .WillOnce(Return(std::vector<UseCases::TimeSeriesBucket>{
+          {0, 1, 3, 1, 2, 2, 3}, {3000, 5, 5, 5, 5, 5, 1}}));
+
+  auto r = controller_->HandleRequest(
+      MakeRequest("range", {"A", "0", "5999", "3000"}));
+
+  ASSERT_TRUE(r.success);
+  EXPECT_THAT(r.message, HasSubstr("A (2 buckets)"));
+  EXPECT_THAT(r.message, HasSubstr("3000 open=5 high=5"));
+  EXPECT_THAT(r.message, ::testing::ContainsRegex("4 rows in [0-9.]+ ms$"));
+}
+
+TEST_F(TimeSeriesCommandsTest, RangeWithoutBucketIsOneBucket) {
+  EXPECT_CALL(*service_, aggregate("A", "EUR", 100, 200,
+                                   std::numeric_limits<int64_t>::max()))
+      .WillOnce(Return(std::vector<UseCases::TimeSeriesBucket>{}));
+
+  auto r =
+      controller_->HandleRequest(MakeRequest("range", {"A", "100", "200"}));
+
+  ASSERT_TRUE(r.success);
+  EXPECT_THAT(r.message, HasSubstr("0 rows in"));
+}
+
+TEST_F(TimeSeriesCommandsTest, RangeRejectsMalformedBounds) {
+  for (const auto& args : std::vector<std::vector<std::string>>{
+           {"A", "0"},
+           {"A", "x", "10"},
+           {"A", "10", "5"},
+           {"A", "0", "10", "0"},
+           {"A", "0", "10", "1s"}}) {
+    auto r = controller_->HandleRequest(MakeRequest("range", args));
+    EXPECT_FALSE(r.success);
+    EXPECT_THAT(r.message, HasSubstr("Usage: range"));
+  }
+}
+
+TEST_F(TimeSeriesCommandsTest, LatestAsksForAllAssetsAtOnce) {
+  Entities::TimeSeriesPoint point{"A", 5000, "EUR", 1.5};
+  EXPECT_CALL(*service_,
+              getLatestPoints(std::vector<std::string>{"A", "B"}, "EUR"))
+      .WillOnce(Return(std::vector<std::optional<Entities::TimeSeriesPoint>>{
+          point, std::nullopt}));
+
+  auto r = controller_->HandleRequest(MakeRequest("latest", {"A", "B"}));
+
+  ASSERT_TRUE(r.success);
+  EXPECT_THAT(r.message, HasSubstr("A: 1.5 at 5000"));
+  EXPECT_THAT(r.message, HasSubstr("B: no points"));
+  EXPECT_THAT(r.message, HasSubstr("1 row in"));
+  ASSERT_EQ(r.data.rows.size(), 2u);
+  EXPECT_EQ(r.data.rows[0][1], presenter::Value(int64_t{5000}));
+  EXPECT_EQ(r.data.rows[0][2], presenter::Value(1.5));
+  EXPECT_EQ(r.data.rows[1][1], presenter::Value{});
+}
+
+TEST_F(TimeSeriesCommandsTest, ConvertConvertsEveryValue) {
+  EXPECT_CALL(*service_, convert(_, "EUR", "USD"))
+      .WillOnce([](std::vector<double>& values, const std::string&,
+                   const std::string&) {
+        for (double& value : values) value *= 2;
+        return true;
+      });
+
+  auto r = controller_->HandleRequest(
+      MakeRequest("convert", {"EUR", "USD", "1", "2.5"}));
+
+  ASSERT_TRUE(r.success);
+  EXPECT_THAT(r.message, HasSubstr("2.5 EUR = 5 USD"));
+  EXPECT_THAT(r.message, HasSubstr("2 rows in"));
+}
+
+TEST_F(TimeSeriesCommandsTest, ConvertFailsForUnconnectedOrBadValues) {
+  EXPECT_CALL(*service_, convert(_, "EUR", "kg")).WillOnce(Return(false));
+
+  auto r =
+      controller_->HandleRequest(MakeRequest("convert", {"EUR", "kg", "1"}));
+  EXPECT_FALSE(r.success);
+  EXPECT_THAT(r.message, HasSubstr("No conversion from EUR to kg"));
+
+  EXPECT_FALSE(
+      controller_->HandleRequest(MakeRequest("convert", {"EUR", "USD"}))
+          .success);
+  EXPECT_FALSE(
+      controller_->HandleRequest(MakeRequest("convert", {"EUR", "USD", "1x"}))
+          .success);
+}
+
 // =====================================================================
 // Skeleton workflow - simulates app behavior through mocked repository
 // =====================================================================
 
 TEST_F(DemoControllerTest, Workflow_CreateThenGetThenDelete) {
   // Create
-  EXPECT_CALL(mock_repo_, accountExists("w1"))
-      .WillOnce(Return(false))  // create check
-      .WillOnce(Return(true));  // delete check
-  EXPECT_CALL(mock_repo_, createAccount(_)).Times(1);
+  EXPECT_CALL(mock_repo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::None));
+  EXPECT_CALL(mock_repo_, accountExists("w1")).WillOnce(Return(true));
 
   auto r1 = controller_->HandleRequest(
       MakeRequest("create_account", {"w1", "Workflow"}));
@@ -1,11 +1,129 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
 #include <memory>
 
+#include "async_controller.h"
 #include "cli_shell.h"
 #include "demo_controller.h"
+#include "tcp_server.h"
+#include "tracing.h"
 
-int main() {
-  presenter::CliShell shell;
-  presenter::DemoController ctl;  // Create on stack
-  shell.SetController(std::make_shared<presenter::DemoController>());
-  return shell.Run();
+// MainApp                   interactive shell
+// MainApp --batch [FILE]    runs the commands in FILE, or stdin if FILE is
+//                           omitted or "-"; exits 1 if one failed
+// MainApp --batch --stop-on-error [FILE]
+//                           stops at the first failed command
+// MainApp --jobs N ...      runs up to N commands at once; output keeps
+//                           the input order
+// MainApp --format json|binary ...
+//                           prints responses as JSON lines or binary
+//                           frames (see presenters/cli/response_encoder.h)
+// MainApp --serve PORT      serves the commands over TCP on localhost
+//                           instead (see presenters/tcp); --jobs sets
+//                           the workers
+// MainApp --trace FILE ...  records trace spans and writes them to FILE
+//                           as Chrome trace JSON on exit (ui.perfetto.dev)
+namespace {
+
+// Called while the controllers are alive: spans name their commands
+// by the controllers' strings
+void WriteTrace(const char* path) {
+  if (!path) return;
+  Tracing::Tracer::instance().stop();
+  std::ofstream out(path);
+  Tracing::Tracer::instance().writeChromeTrace(out);
+  if (!out) std::cerr << "Cannot write " << path << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  presenter::CliShellOptions options;
+  const char* script = nullptr;
+  const char* serve = nullptr;
+  const char* trace = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--batch") == 0) {
+      options.batch = true;
+    } else if (std::strcmp(argv[i], "--stop-on-error") == 0) {
+      options.stop_on_error = true;
+    } else if (std::strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+      serve = argv[++i];
+    } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      trace = argv[++i];
+    } else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+      options.max_in_flight = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc &&
+               std::strcmp(argv[i + 1], "json") == 0) {
+      options.output_format = presenter::OutputFormat::kJsonLines;
+      ++i;
+    } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc &&
+               std::strcmp(argv[i + 1], "binary") == 0) {
+      options.output_format = presenter::OutputFormat::kBinary;
+      ++i;
+    } else if (!script) {
+      script = argv[i];
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--jobs N] [--format json|binary] [--trace FILE]"
+                << " [--batch [--stop-on-error] [FILE]]\n"
+                << "       " << argv[0] << " --serve PORT [--jobs N]\n";
+      return 2;
+    }
+  }
+  if (trace) {
+    Tracing::Tracer::instance().start();
+  }
+  if (serve) {
+    // The store is not thread-safe, so writes run alone
+    presenter::TcpServerOptions server_options;
+    server_options.port =
+        static_cast<uint16_t>(std::strtoul(serve, nullptr, 10));
+    if (options.max_in_flight > 0) {
+      server_options.workers = options.max_in_flight;
+    }
+    server_options.exclusive_commands = {"add", "delete"};
+    auto controller = std::make_shared<presenter::DemoController>();
+    controller->SetMetrics(std::make_shared<presenter::CommandMetrics>());
+    presenter::TcpServer server(controller, server_options);
+    server.Listen();
+    std::cout << "Listening on port " << server.Port() << std::endl;
+    server.Run();
+    WriteTrace(trace);
+    return 0;
+  }
+  if (script && !options.batch) {
+    options.batch = true;  // a script file is never interactive
+  }
+
+  std::ifstream file;
+  if (script && std::strcmp(script, "-") != 0) {
+    file.open(script);
+    if (!file) {
+      std::cerr << "Cannot open " << script << "\n";
+      return 2;
+    }
+  }
+  if (options.batch) {
+    // Nothing reads stdio alongside the streams, so skip the syncing
+    std::ios::sync_with_stdio(false);
+  }
+
+  presenter::CliShell shell(file.is_open() ? file : std::cin, std::cout,
+                            options);
+  auto controller = std::make_shared<presenter::DemoController>();
+  controller->SetMetrics(std::make_shared<presenter::CommandMetrics>());
+  if (options.max_in_flight > 0) {
+    // The store is not thread-safe, so writes run alone
+    shell.SetController(std::make_shared<presenter::AsyncController>(
+        controller, options.max_in_flight,
+        std::set<std::string>{"add", "delete"}));
+  } else {
+    shell.SetController(controller);
+  }
+  const int status = shell.Run();
+  WriteTrace(trace);
+  return status;
 }
@@ -0,0 +1,88 @@
+// Worker pool in front of a controller
+#ifndef PRESENTER_CLI_ASYNC_CONTROLLER_H_
+#define PRESENTER_CLI_ASYNC_CONTROLLER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "executor.h"
+#include "req_response_interface.h"
+
+namespace presenter {
+
+// Runs HandleRequestAsync() requests of another controller on up to
+// `workers` executor tasks, so a slow command does not hold up the ones
+// after it. Requests start in submission order and run concurrently,
+// which the wrapped controller must allow, except commands named
+// exclusive: one of these waits for the commands before it to finish and
+// runs alone, for commands that change state the others read.
+// HandleRequest() is passed through on the calling thread.
+class AsyncController : public RequestResponseInterface {
+ public:
+  // Without an executor it starts its own of `workers` threads, so
+  // commands that block do not hold the shared pool's workers. Throws
+  // std::invalid_argument if inner is null or workers is 0.
+  AsyncController(std::shared_ptr<RequestResponseInterface> inner,
+                  size_t workers,
+                  std::set<std::string> exclusive_commands = {},
+                  Concurrency::Executor* executor = nullptr);
+  // Waits for the queued requests to finish
+  ~AsyncController() override;
+
+  // Disable copy and move
+  AsyncController(const AsyncController&) = delete;
+  AsyncController& operator=(const AsyncController&) = delete;
+  AsyncController(AsyncController&&) = delete;
+  AsyncController& operator=(AsyncController&&) = delete;
+
+  Response HandleRequest(const Request& request) override;
+  std::future<Response> HandleRequestAsync(const Request& request) override;
+  std::vector<std::string> GetAvailableCommands() const override;
+  const CommandMetrics* GetMetrics() const override;
+
+  // HandleRequestAsync() that also calls on_ready on the worker once the
+  // future is ready, for callers that cannot block on it
+  std::future<Response> Submit(const Request& request,
+                               std::function<void()> on_ready);
+
+ private:
+  struct Task {
+    Request request;
+    std::promise<Response> promise;
+    std::function<void()> on_ready;
+  };
+
+  // Starts a runner if the front task may start and none is free to
+  // take it
+  void Dispatch();
+  // An executor task running queued requests while they may start
+  void Run();
+  bool IsExclusive(const Request& request) const;
+  // The front task may start; under mutex_
+  bool CanStart() const;
+
+  std::shared_ptr<RequestResponseInterface> inner_;
+  const std::set<std::string> exclusive_commands_;
+  const size_t workers_;
+  std::unique_ptr<Concurrency::Executor> own_executor_;
+  Concurrency::Executor& executor_;
+
+  std::mutex mutex_;
+  std::condition_variable idle_;
+  std::deque<Task> tasks_;
+  size_t runners_ = 0;  // executor tasks started and not yet returned
+  size_t running_ = 0;  // requests being handled
+  bool exclusive_running_ = false;
+};
+
+}  // namespace presenter
+
+#endif  // PRESENTER_CLI_ASYNC_CONTROLLER_H_
@@ -2,20 +2,51 @@
 #ifndef PRESENTER_CLI_CLI_SHELL_H_
 #define PRESENTER_CLI_CLI_SHELL_H_
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "line_tokenizer.h"
 #include "req_response_interface.h"
+#include "response_encoder.h"
 
 namespace presenter {
 
+// Options for running commands from a script or pipe
+struct CliShellOptions {
+  // No banner, prompt or goodbye; output is buffered and '#' lines are
+  // comments. Run() returns 1 if any command failed.
+  bool batch = false;
+  // Batch output is written out after this many commands, so a long
+  // script shows progress without a flush per line; 0 writes it all at
+  // the end
+  size_t flush_every = 1024;
+  // Batch mode stops reading at the first failed command
+  bool stop_on_error = false;
+  // Above 0, commands go to the controller's HandleRequestAsync() and up
+  // to this many run at once while input is read on; a writer thread
+  // prints the responses in submission order
+  size_t max_in_flight = 0;
+  // Prefix every response with "[<n>] ", n counting commands from 1
+  bool tag_responses = false;
+  // kJsonLines or kBinary encode every response, built-ins included, for
+  // programs (see ResponseEncoder); tag_responses applies to kText only
+  OutputFormat output_format = OutputFormat::kText;
+};
+
 // Interactive command-line shell
 class CliShell {
  public:
   // Constructor with custom streams (for testing)
   explicit CliShell(std::istream& input = std::cin,
                     std::ostream& output = std::cout);
+  CliShell(std::istream& input, std::ostream& output,
+           const CliShellOptions& options);
 
   // Disable copy and move
   CliShell(const CliShell&) = delete;
@@ -28,19 +59,53 @@ class CliShell {
   // Set the controller for handling custom commands
   void SetController(std::shared_ptr<RequestResponseInterface> controller);
 
-  // Run the interactive shell (returns exit code)
+  // Run the shell (returns exit code: 0, or in batch mode 1 if a
+  // command failed)
   int Run();
 
  private:
   std::istream& input_;
   std::ostream& output_;
   std::shared_ptr<RequestResponseInterface> controller_;
+  const CliShellOptions options_;
+  const ResponseEncoder encoder_;
+
+  // Batch output not yet written to output_
+  std::string pending_;
+  // Async mode writes from its writer thread while the prompt is shown
+  std::mutex output_mutex_;
+  std::atomic<bool> failed_{false};
+
+  // The current line's words, reused so parsing does not allocate
+  LineTokenizer tokenizer_;
+  std::vector<std::string_view> tokens_;
+  RequestView request_;
 
   // Built-in command handlers
   void ShowPrompt();
   void ShowHelp();
+  std::string HelpText() const;
+  // The controller's metrics, for request_ "stats [json]"
+  std::string StatsText() const;
   bool ProcessCommand(const std::string& line);
-  Request ParseLine(const std::string& line);
+  // Splits line into request_ (command empty for a blank line); false
+  // for an unterminated quote
+  bool ParseLine(std::string_view line);
+  // Run() with max_in_flight set
+  int RunAsync();
+  // Strips a CR; false for a line batch mode skips
+  bool PrepareLine(std::string& line) const;
+
+  // Writes a response in a structured output_format
+  void WriteEncoded(std::string_view command, const Response& response);
+  bool Structured() const {
+    return options_.output_format != OutputFormat::kText;
+  }
+
+  // Output goes through here: straight to output_ interactively,
+  // into pending_ in batch mode
+  void Write(std::string_view text);
+  void Flush();
 };
 
 }  // namespace presenter
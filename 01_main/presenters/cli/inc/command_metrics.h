@@ -0,0 +1,252 @@
+// Per-command call counts and latency histograms
+#ifndef PRESENTER_CLI_COMMAND_METRICS_H_
+#define PRESENTER_CLI_COMMAND_METRICS_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace presenter {
+
+// HDR-style latency histogram in microseconds: values below 16 us get a
+// bucket each, and every power of two above is split into 16 buckets,
+// so a quantile is within about 6% of the true value at any scale.
+// Fixed size and no allocation; recording is a few integer operations.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBits = 4;
+  static constexpr int64_t kSub = int64_t{1} << kSubBits;
+  // Up to 2^36 us (about 19 hours); longer lands in the last bucket
+  static constexpr size_t kBuckets = kSub + (36 - kSubBits) * kSub;
+
+  void Record(std::chrono::microseconds duration) {
+    const int64_t us = std::max<int64_t>(duration.count(), 0);
+    ++buckets_[BucketOf(us)];
+    if (count_ == 0 || us < min_us_) min_us_ = us;
+    if (count_ == 0 || us > max_us_) max_us_ = us;
+    ++count_;
+    total_us_ += us;
+  }
+
+  uint64_t Count() const { return count_; }
+  int64_t MinUs() const { return min_us_; }
+  int64_t MaxUs() const { return max_us_; }
+  int64_t MeanUs() const {
+    return count_ == 0 ? 0 : total_us_ / static_cast<int64_t>(count_);
+  }
+
+  // q in [0, 1]: the highest value of the bucket holding that rank,
+  // within what was actually seen; zero when empty
+  int64_t QuantileUs(double q) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    const auto rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += buckets_[i];
+      if (seen >= rank) {
+        return std::clamp(UpperBound(i), min_us_, max_us_);
+      }
+    }
+    return max_us_;
+  }
+
+  // Non-empty buckets, as (highest value, count)
+  void ForEachBucket(
+      const std::function<void(int64_t upper_us, uint64_t count)>& visit)
+      const {
+    for (size_t i = 0; i < kBuckets; ++i) {
+      if (buckets_[i] > 0) visit(UpperBound(i), buckets_[i]);
+    }
+  }
+
+  static size_t BucketOf(int64_t us) {
+    if (us < kSub) {
+      return static_cast<size_t>(us);
+    }
+    int exponent = 0;  // of the highest set bit
+    for (int64_t v = us; v > 1; v >>= 1) ++exponent;
+    const size_t bucket =
+        static_cast<size_t>(kSub + (exponent - kSubBits) * kSub +
+                            ((us >> (exponent - kSubBits)) & (kSub - 1)));
+    return std::min(bucket, kBuckets - 1);
+  }
+
+  static int64_t UpperBound(size_t bucket) {
+    if (bucket < static_cast<size_t>(kSub)) {
+      return static_cast<int64_t>(bucket);
+    }
+    const int64_t exponent = static_cast<int64_t>(bucket) / kSub - 1 + kSubBits;
+    const int64_t sub = static_cast<int64_t>(bucket) % kSub;
+    const int64_t width = int64_t{1} << (exponent - kSubBits);
+    return ((kSub + sub) << (exponent - kSubBits)) + width - 1;
+  }
+
+ private:
+  std::array<uint64_t, kBuckets> buckets_{};
+  uint64_t count_ = 0;
+  int64_t total_us_ = 0;
+  int64_t min_us_ = 0;
+  int64_t max_us_ = 0;
+};
+
+struct CommandStats {
+  uint64_t calls = 0;
+  uint64_t errors = 0;  // failed responses and exceptions
+  LatencyHistogram latency;
+};
+
+// Counts, errors and latencies by command name, as the controllers
+// record them around each dispatch. Thread-safe; recording takes a
+// short lock. A controller without one does not read the clock at all.
+class CommandMetrics {
+ public:
+  void Record(std::string_view command, std::chrono::microseconds duration,
+              bool success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = commands_.find(command);
+    if (it == commands_.end()) {
+      it = commands_.emplace(std::string(command), CommandStats{}).first;
+    }
+    ++it->second.calls;
+    if (!success) ++it->second.errors;
+    it->second.latency.Record(duration);
+  }
+
+  // Copies, by command
+  std::map<std::string, CommandStats, std::less<>> Commands() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commands_;
+  }
+
+  // One line per command: calls, errors and latency quantiles in us
+  std::string ToText() const {
+    const auto commands = Commands();
+    if (commands.empty()) {
+      return "No commands run";
+    }
+    std::string text;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-20s %8s %8s %10s %10s %10s %10s",
+                  "command", "calls", "errors", "p50_us", "p90_us", "p99_us",
+                  "max_us");
+    text += line;
+    for (const auto& [name, stats] : commands) {
+      std::snprintf(line, sizeof(line),
+                    "\n%-20s %8llu %8llu %10lld %10lld %10lld %10lld",
+                    name.c_str(), static_cast<unsigned long long>(stats.calls),
+                    static_cast<unsigned long long>(stats.errors),
+                    static_cast<long long>(stats.latency.QuantileUs(0.5)),
+                    static_cast<long long>(stats.latency.QuantileUs(0.9)),
+                    static_cast<long long>(stats.latency.QuantileUs(0.99)),
+                    static_cast<long long>(stats.latency.MaxUs()));
+      text += line;
+    }
+    return text;
+  }
+
+  // {"commands": {"<name>": {"calls": ..., "errors": ..., "latency_us":
+  // {"mean", "min", "max", "p50", "p90", "p99", "p999", "buckets":
+  // {"<highest value>": count, ...}}}}}
+  std::string ToJson() const {
+    const auto commands = Commands();
+    std::string out = "{\"commands\":{";
+    bool first = true;
+    for (const auto& [name, stats] : commands) {
+      if (!first) out += ',';
+      first = false;
+      AppendString(out, name);
+      out += ":{\"calls\":" + std::to_string(stats.calls);
+      out += ",\"errors\":" + std::to_string(stats.errors);
+      const LatencyHistogram& latency = stats.latency;
+      out += ",\"latency_us\":{\"mean\":" + std::to_string(latency.MeanUs());
+      out += ",\"min\":" + std::to_string(latency.MinUs());
+      out += ",\"max\":" + std::to_string(latency.MaxUs());
+      out += ",\"p50\":" + std::to_string(latency.QuantileUs(0.5));
+      out += ",\"p90\":" + std::to_string(latency.QuantileUs(0.9));
+      out += ",\"p99\":" + std::to_string(latency.QuantileUs(0.99));
+      out += ",\"p999\":" + std::to_string(latency.QuantileUs(0.999));
+      out += ",\"buckets\":{";
+      bool first_bucket = true;
+      latency.ForEachBucket([&](int64_t upper_us, uint64_t count) {
+        if (!first_bucket) out += ',';
+        first_bucket = false;
+        out += '"' + std::to_string(upper_us) + "\":" + std::to_string(count);
+      });
+      out += "}}}";
+    }
+    out += "}}";
+    return out;
+  }
+
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    commands_.clear();
+  }
+
+ private:
+  static void AppendString(std::string& out, std::string_view value) {
+    out += '"';
+    for (char c : value) {
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        out += escaped;
+      } else {
+        out += c;
+      }
+    }
+    out += '"';
+  }
+
+  mutable std::mutex mutex_;
+  std::map<std::string, CommandStats, std::less<>> commands_;
+};
+
+// Times one dispatch into metrics, if there are any
+class ScopedCommandTimer {
+ public:
+  ScopedCommandTimer(CommandMetrics* metrics, std::string_view command)
+      : metrics_(metrics), command_(command) {
+    if (metrics_) start_ = std::chrono::steady_clock::now();
+  }
+  ~ScopedCommandTimer() {
+    if (metrics_) {
+      metrics_->Record(command_,
+                       std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start_),
+                       success_);
+    }
+  }
+
+  ScopedCommandTimer(const ScopedCommandTimer&) = delete;
+  ScopedCommandTimer& operator=(const ScopedCommandTimer&) = delete;
+
+  // Unless called, as when the command throws, the call is an error
+  void Succeeded(bool success) { success_ = success; }
+
+ private:
+  CommandMetrics* metrics_;
+  std::string_view command_;
+  std::chrono::steady_clock::time_point start_;
+  bool success_ = false;
+};
+
+}  // namespace presenter
+
+#endif  // PRESENTER_CLI_COMMAND_METRICS_H_
@@ -0,0 +1,32 @@
+// Command line tokenizer
+#ifndef PRESENTER_CLI_LINE_TOKENIZER_H_
+#define PRESENTER_CLI_LINE_TOKENIZER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace presenter {
+
+// Splits a command line into words without allocating once warmed up.
+// Words are separated by spaces or tabs. "..." and '...' keep blanks
+// inside a word; outside quotes a backslash takes the next character
+// literally, inside double quotes only before '"' or '\', and inside
+// single quotes never. So: add "two words" it\'s 'C:\dir'
+class LineTokenizer {
+ public:
+  // Replaces tokens with the words of line. A plain word is a view into
+  // line; one with quotes or escapes is decoded into the tokenizer's
+  // arena. Views stay valid until the next call or until line changes.
+  // Returns false, leaving tokens empty, for an unterminated quote.
+  bool Tokenize(std::string_view line, std::vector<std::string_view>& tokens);
+
+ private:
+  // Reused between lines; a line never decodes longer than itself, so
+  // sized up front it does not move while views into it are handed out
+  std::string arena_;
+};
+
+}  // namespace presenter
+
+#endif  // PRESENTER_CLI_LINE_TOKENIZER_H_
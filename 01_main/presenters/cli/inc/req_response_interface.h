@@ -5,9 +5,18 @@ Request-Response Interface for command handling
 #ifndef PRESENTER_CLI_REQUEST_RESPONSE_INTERFACE_H_
 #define PRESENTER_CLI_REQUEST_RESPONSE_INTERFACE_H_
 
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "command_metrics.h"
+
 namespace presenter {
 
 // Request structure for commands
@@ -16,12 +25,49 @@ struct Request {
   std::vector<std::string> arguments;
 };
 
-// Response structure from command execution
+// A request borrowing its words, as the shell parses them; valid only
+// for the call it is passed to
+struct RequestView {
+  std::string_view command;
+  std::vector<std::string_view> arguments;
+};
+
+inline Request ToRequest(const RequestView& view) {
+  Request request;
+  request.command.assign(view.command);
+  request.arguments.reserve(view.arguments.size());
+  for (std::string_view argument : view.arguments) {
+    request.arguments.emplace_back(argument);
+  }
+  return request;
+}
+
+// One typed value of a structured response; monostate is null
+using Value = std::variant<std::monostate, bool, int64_t, double, std::string>;
+
+// The rows behind a message, for machine-readable output (see
+// ResponseEncoder); every row holds one value per column
+struct ResponseData {
+  std::vector<std::string> columns;
+  std::vector<std::vector<Value>> rows;
+};
+
+// Response structure from command execution. Not an aggregate, so the
+// many Response{success, message} replies need not spell out data.
 struct Response {
+  Response() = default;
+  Response(bool success, std::string message, ResponseData data = {})
+      : success(success), message(std::move(message)), data(std::move(data)) {}
+
   bool success = false;
-  std::string message;
+  std::string message;  // for people
+  ResponseData data;    // for programs; empty if the command has none
 };
 
+// Takes a response message part by part as it is produced; returning
+// false asks the command to stop early
+using ResponseSink = std::function<bool(std::string_view part)>;
+
 // Virtual interface for command controllers
 class RequestResponseInterface {
  public:
@@ -30,8 +76,43 @@ class RequestResponseInterface {
   // Handle a command request
   virtual Response HandleRequest(const Request& request) = 0;
 
+  // Handle a borrowed request. The default copies it for
+  // HandleRequest(); controllers that can work on the views override it.
+  virtual Response HandleRequestView(const RequestView& request) {
+    return HandleRequest(ToRequest(request));
+  }
+
+  // Handle a request, passing its message to sink in parts as it is
+  // produced, so output starts at once and need not be held whole; the
+  // Response returned carries no message. The default hands over the
+  // whole message of HandleRequestView() as one part.
+  virtual Response HandleRequestStreamed(const RequestView& request,
+                                         const ResponseSink& sink) {
+    Response response = HandleRequestView(request);
+    sink(response.message);
+    response.message.clear();
+    return response;
+  }
+
+  // Start a command request; the future gets its response or exception.
+  // The default runs HandleRequest() at once on the calling thread, so
+  // requests still complete in order. Controllers that can overlap
+  // requests override it (see AsyncController).
+  virtual std::future<Response> HandleRequestAsync(const Request& request) {
+    std::promise<Response> promise;
+    try {
+      promise.set_value(HandleRequest(request));
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+    return promise.get_future();
+  }
+
   // Get list of available commands
   virtual std::vector<std::string> GetAvailableCommands() const = 0;
+
+  // What the controller recorded about its commands, if anything
+  virtual const CommandMetrics* GetMetrics() const { return nullptr; }
 };
 
 }  // namespace presenter
@@ -0,0 +1,57 @@
+// Machine-readable response encodings
+#ifndef PRESENTER_CLI_RESPONSE_ENCODER_H_
+#define PRESENTER_CLI_RESPONSE_ENCODER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "req_response_interface.h"
+
+namespace presenter {
+
+enum class OutputFormat {
+  kText,       // the message, for people
+  kJsonLines,  // one JSON object per response, each on its own line
+  kBinary,     // length-prefixed frames, see ResponseEncoder
+};
+
+// Encodes a response with its command, typed rows and all, so tools
+// read the output without scraping the message.
+//
+// JSON lines:
+//   {"command":"list","success":true,"message":"...",
+//    "columns":["index","item"],"rows":[[1,"a"],[2,"b"]]}
+// Doubles that JSON cannot hold (NaN, infinities) are null.
+//
+// Binary frame, all integers little-endian:
+//   u32 length of what follows
+//   u8  success; str command; str message    (str: u32 length, bytes)
+//   u32 column count, then a str per column
+//   u32 row count, then per row one value per column:
+//       u8 type, 0 null | 1 bool (u8) | 2 int64 (8 bytes)
+//                | 3 double (8 bytes IEEE 754) | 4 str
+// A row shorter than the columns is padded with nulls, a longer one cut.
+class ResponseEncoder {
+ public:
+  explicit ResponseEncoder(OutputFormat format) : format_(format) {}
+
+  OutputFormat format() const { return format_; }
+
+  // Appends the encoded response to out. kText appends the message and a
+  // newline.
+  void Encode(std::string_view command, const Response& response,
+              std::string& out) const;
+
+ private:
+  OutputFormat format_;
+
+  static void EncodeJsonLine(std::string_view command,
+                             const Response& response, std::string& out);
+  static void EncodeBinaryFrame(std::string_view command,
+                                const Response& response, std::string& out);
+};
+
+}  // namespace presenter
+
+#endif  // PRESENTER_CLI_RESPONSE_ENCODER_H_
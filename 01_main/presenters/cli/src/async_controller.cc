@@ -0,0 +1,137 @@
+#include "async_controller.h"
+
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace presenter {
+
+namespace {
+
+std::unique_ptr<Concurrency::Executor> OwnExecutor(
+    Concurrency::Executor* executor, size_t workers) {
+  if (executor || workers == 0) {
+    return nullptr;
+  }
+  Concurrency::ExecutorOptions options;
+  options.threads = workers;
+  return std::make_unique<Concurrency::Executor>(options);
+}
+
+}  // namespace
+
+AsyncController::AsyncController(
+    std::shared_ptr<RequestResponseInterface> inner, size_t workers,
+    std::set<std::string> exclusive_commands, Concurrency::Executor* executor)
+    : inner_(std::move(inner)),
+      exclusive_commands_(std::move(exclusive_commands)),
+      workers_(workers),
+      own_executor_(OwnExecutor(executor, workers)),
+      executor_(executor ? *executor : *own_executor_) {
+  if (!inner_) {
+    throw std::invalid_argument("AsyncController needs a controller");
+  }
+  if (workers == 0) {
+    throw std::invalid_argument("AsyncController needs a worker");
+  }
+}
+
+AsyncController::~AsyncController() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return tasks_.empty() && runners_ == 0; });
+}
+
+Response AsyncController::HandleRequest(const Request& request) {
+  return inner_->HandleRequest(request);
+}
+
+std::future<Response> AsyncController::HandleRequestAsync(
+    const Request& request) {
+  return Submit(request, {});
+}
+
+const CommandMetrics* AsyncController::GetMetrics() const {
+  return inner_->GetMetrics();
+}
+
+std::future<Response> AsyncController::Submit(const Request& request,
+                                              std::function<void()> on_ready) {
+  Task task{request, {}, std::move(on_ready)};
+  auto future = task.promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  Dispatch();
+  return future;
+}
+
+std::vector<std::string> AsyncController::GetAvailableCommands() const {
+  return inner_->GetAvailableCommands();
+}
+
+void AsyncController::Dispatch() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (runners_ == workers_ || runners_ > running_ || !CanStart()) {
+      return;
+    }
+    ++runners_;
+  }
+  executor_.post([this] { Run(); });
+}
+
+void AsyncController::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (CanStart()) {
+    Task task = std::move(tasks_.front());
+    tasks_.pop_front();
+    const bool exclusive = IsExclusive(task.request);
+    ++running_;
+    exclusive_running_ = exclusive;
+    lock.unlock();
+    // The task behind this one may run alongside it
+    Dispatch();
+
+    try {
+      task.promise.set_value(inner_->HandleRequest(task.request));
+    } catch (...) {
+      task.promise.set_exception(std::current_exception());
+    }
+    // Let go of the result before saying it is ready, so the caller
+    // is left the only owner of it
+    auto on_ready = std::move(task.on_ready);
+    task = Task{};
+    if (on_ready) {
+      on_ready();
+    }
+
+    lock.lock();
+    --running_;
+    if (exclusive) exclusive_running_ = false;
+    if (exclusive && !tasks_.empty()) {
+      // Several tasks may start after an exclusive one
+      lock.unlock();
+      Dispatch();
+      lock.lock();
+    }
+  }
+  --runners_;
+  if (runners_ == 0) {
+    idle_.notify_all();
+  }
+}
+
+bool AsyncController::IsExclusive(const Request& request) const {
+  return exclusive_commands_.count(request.command) != 0;
+}
+
+bool AsyncController::CanStart() const {
+  if (tasks_.empty() || exclusive_running_) {
+    return false;
+  }
+  return running_ == 0 || !IsExclusive(tasks_.front().request);
+}
+
+}  // namespace presenter
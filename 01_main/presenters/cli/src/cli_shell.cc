@@ -1,14 +1,34 @@
 #include "cli_shell.h"
 
-#include <sstream>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "tracing.h"
 
 namespace presenter {
 
+namespace {
+
+constexpr char kUnterminatedQuote[] = "Error: unterminated quote\n";
+constexpr size_t kMaxPendingBytes = 64 * 1024;
+
+}  // namespace
+
 // Constructor: Takes input/output streams
 // Default = std::cin/cout for normal use
 // Custom streams for testing (inject stringstreams)
 CliShell::CliShell(std::istream& input, std::ostream& output)
-    : input_(input), output_(output), controller_(nullptr) {
+    : CliShell(input, output, CliShellOptions{}) {}
+
+CliShell::CliShell(std::istream& input, std::ostream& output,
+                   const CliShellOptions& options)
+    : input_(input), output_(output), controller_(nullptr),
+      options_(options), encoder_(options.output_format) {
   // Member initializer list - efficient initialization
   // controller_ starts as nullptr (no controller yet)
 }
@@ -21,90 +41,354 @@ void CliShell::SetController(
 
 // Main REPL loop
 int CliShell::Run() {
-  output_ << "Welcome to Presenter CLI!\n";
-  output_ << "Type 'help' for commands.\n\n";
+  if (options_.max_in_flight > 0) {
+    return RunAsync();
+  }
+  if (!options_.batch) {
+    output_ << "Welcome to Presenter CLI!\n";
+    output_ << "Type 'help' for commands.\n\n";
+  }
 
+  size_t since_flush = 0;
+  std::string line;  // reused, so long scripts do not allocate per line
   while (true) {
-    ShowPrompt();
+    if (!options_.batch) {
+      ShowPrompt();
+    }
 
-    std::string line;
     if (!std::getline(input_, line)) {
       break;  // EOF or error
     }
 
+    if (!PrepareLine(line)) {
+      continue;
+    }
+
     if (!ProcessCommand(line)) {
       break;  // User typed quit/exit
     }
+    if (options_.batch) {
+      if (failed_ && options_.stop_on_error) break;
+      if (options_.flush_every > 0 && ++since_flush >= options_.flush_every) {
+        Flush();
+        since_flush = 0;
+      }
+    }
   }
 
+  if (options_.batch) {
+    Flush();
+    return failed_ ? 1 : 0;
+  }
   output_ << "Goodbye!\n";
   return 0;
 }
 
+// Async REPL loop: this thread reads, parses and dispatches; a writer
+// thread waits for each response in turn and prints it
+int CliShell::RunAsync() {
+  if (!options_.batch) {
+    output_ << "Welcome to Presenter CLI!\n";
+    output_ << "Type 'help' for commands.\n\n";
+  }
+
+  struct Pending {
+    size_t id = 0;
+    std::future<Response> response;  // not valid for built-in output
+    std::string text;
+    std::string command;  // for a structured output_format
+  };
+  std::mutex queue_mutex;
+  std::condition_variable queue_changed;
+  std::deque<Pending> queue;  // in flight, in submission order
+  bool closed = false;
+
+  std::thread writer([&] {
+    size_t since_flush = 0;
+    while (true) {
+      Pending pending;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_changed.wait(lock, [&] { return closed || !queue.empty(); });
+        if (queue.empty()) {
+          return;
+        }
+        pending = std::move(queue.front());
+        queue.pop_front();
+      }
+      queue_changed.notify_all();
+
+      std::string text = std::move(pending.text);
+      if (pending.response.valid()) {
+        Response response;
+        try {
+          response = pending.response.get();
+        } catch (const std::exception& e) {
+          response = Response{false, std::string("Error: ") + e.what()};
+        }
+        if (!response.success) failed_ = true;
+        text.clear();
+        encoder_.Encode(pending.command, response, text);
+      }
+      if (options_.tag_responses && !Structured()) {
+        text = "[" + std::to_string(pending.id) + "] " + text;
+      }
+      Write(text);
+      if (options_.batch && options_.flush_every > 0 &&
+          ++since_flush >= options_.flush_every) {
+        Flush();
+        since_flush = 0;
+      }
+    }
+  });
+
+  size_t next_id = 0;
+  std::string line;
+  while (true) {
+    if (!options_.batch) {
+      ShowPrompt();
+    }
+    if (!std::getline(input_, line)) {
+      break;  // EOF or error
+    }
+    if (!PrepareLine(line)) {
+      continue;
+    }
+    if (options_.batch && options_.stop_on_error && failed_) {
+      break;  // the commands in flight still finish
+    }
+
+    const bool parsed = ParseLine(line);
+    if (parsed && request_.command.empty()) {
+      continue;
+    }
+    if (request_.command == "quit" || request_.command == "exit") {
+      break;
+    }
+
+    Pending pending;
+    pending.id = ++next_id;
+    pending.command.assign(request_.command);
+    if (!parsed) {
+      pending.text = kUnterminatedQuote;
+      failed_ = true;
+    } else if (request_.command == "help") {
+      pending.text = HelpText();
+    } else if (request_.command == "stats") {
+      pending.text = StatsText();
+    } else if (controller_) {
+      TRACE_SPAN("cli", "CliShell::Submit");
+      try {
+        // The request outlives this line, so it owns its words
+        pending.response =
+            controller_->HandleRequestAsync(ToRequest(request_));
+      } catch (const std::exception& e) {
+        pending.text = std::string("Error: ") + e.what() + "\n";
+        failed_ = true;
+      }
+    } else {
+      pending.text =
+          "Command not implemented: " + std::string(request_.command) + "\n";
+      failed_ = true;
+    }
+    if (Structured() && !pending.response.valid()) {
+      // Built-in output, encoded as a response of its own
+      std::string message = std::move(pending.text);
+      if (!message.empty() && message.back() == '\n') message.pop_back();
+      const bool success =
+          parsed && (request_.command == "help" ||
+                     request_.command == "stats");
+      encoder_.Encode(pending.command, Response{success, std::move(message)},
+                      pending.text);
+    }
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    queue_changed.wait(
+        lock, [&] { return queue.size() < options_.max_in_flight; });
+    queue.push_back(std::move(pending));
+    lock.unlock();
+    queue_changed.notify_all();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    closed = true;
+  }
+  queue_changed.notify_all();
+  writer.join();
+
+  if (options_.batch) {
+    Flush();
+    return failed_ ? 1 : 0;
+  }
+  output_ << "Goodbye!\n";
+  return 0;
+}
+
+bool CliShell::PrepareLine(std::string& line) const {
+  // Scripts may carry CRLF line ends and comments
+  if (options_.batch) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!line.empty() && line.front() == '#') return false;
+  }
+  return true;
+}
+
+void CliShell::Write(std::string_view text) {
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  if (options_.batch) {
+    pending_ += text;
+    // Bounds the buffer however much one command prints
+    if (pending_.size() >= kMaxPendingBytes) {
+      output_ << pending_;
+      pending_.clear();
+    }
+  } else {
+    output_ << text;
+  }
+}
+
+void CliShell::Flush() {
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  output_ << pending_;
+  output_.flush();
+  pending_.clear();
+}
+
 void CliShell::ShowPrompt() {
+  std::lock_guard<std::mutex> lock(output_mutex_);
   output_ << ">> ";
   output_.flush();  // Force output immediately
 }
 
 // Returns false = exit loop, true = continue
 bool CliShell::ProcessCommand(const std::string& line) {
-  // Ignore empty lines
-  if (line.empty()) {
+  TRACE_SPAN("cli", "CliShell::ProcessCommand");
+  // Parse command and arguments
+  if (!ParseLine(line)) {
+    if (Structured()) {
+      WriteEncoded({}, Response{false, "Error: unterminated quote"});
+    } else {
+      Write(kUnterminatedQuote);
+    }
+    failed_ = true;
     return true;
   }
 
-  // Parse command and arguments
-  Request request = ParseLine(line);
+  // Ignore empty lines
+  if (request_.command.empty()) {
+    return true;
+  }
 
   // Built-in commands
-  if (request.command == "quit" || request.command == "exit") {
+  if (request_.command == "quit" || request_.command == "exit") {
     return false;  // Stop loop
   }
 
-  if (request.command == "help") {
+  if (request_.command == "help") {
     ShowHelp();
     return true;
   }
 
+  if (request_.command == "stats") {
+    if (Structured()) {
+      std::string text = StatsText();
+      text.pop_back();
+      WriteEncoded(request_.command, Response{true, std::move(text)});
+    } else {
+      Write(StatsText());
+    }
+    return true;
+  }
+
+  if (controller_ && Structured()) {
+    // Whole, as the typed rows come with the response
+    Response response = controller_->HandleRequestView(request_);
+    WriteEncoded(request_.command, response);
+    failed_ = failed_ || !response.success;
+    return true;
+  }
+
   // Custom commands via controller
   if (controller_) {
-    Response response = controller_->HandleRequest(request);
-    output_ << response.message << "\n";
+    // Parts go out as they come, so a long listing starts at once
+    Response response = controller_->HandleRequestStreamed(
+        request_, [this](std::string_view part) {
+          Write(part);
+          return true;
+        });
+    Write("\n");
+    failed_ = failed_ || !response.success;
+  } else if (Structured()) {
+    WriteEncoded(request_.command,
+                 Response{false, "Command not implemented: " +
+                                     std::string(request_.command)});
+    failed_ = true;
   } else {
-    output_ << "Command not implemented: " << request.command << "\n";
+    Write("Command not implemented: " + std::string(request_.command) + "\n");
+    failed_ = true;
   }
 
   return true;
 }
 
-Request CliShell::ParseLine(const std::string& line) {
-  Request req;
-  std::istringstream iss(line);
-
-  // First word = command
-  iss >> req.command;
+bool CliShell::ParseLine(std::string_view line) {
+  request_.command = {};
+  request_.arguments.clear();
+  if (!tokenizer_.Tokenize(line, tokens_)) {
+    return false;
+  }
 
-  // Rest = arguments
-  std::string arg;
-  while (iss >> arg) {
-    req.arguments.push_back(arg);
+  // First word = command, rest = arguments
+  if (!tokens_.empty()) {
+    request_.command = tokens_.front();
+    request_.arguments.assign(tokens_.begin() + 1, tokens_.end());
   }
+  return true;
+}
 
-  return req;
+void CliShell::WriteEncoded(std::string_view command,
+                            const Response& response) {
+  std::string text;
+  encoder_.Encode(command, response, text);
+  Write(text);
 }
 
 void CliShell::ShowHelp() {
-  output_ << "Available commands:\n";
-  output_ << "  help - Show this message\n";
-  output_ << "  quit - Exit shell\n";
-  output_ << "  exit - Exit shell\n";
+  if (Structured()) {
+    std::string text = HelpText();
+    text.pop_back();
+    WriteEncoded("help", Response{true, std::move(text)});
+  } else {
+    Write(HelpText());
+  }
+}
+
+std::string CliShell::HelpText() const {
+  std::string text = "Available commands:\n";
+  text += "  help - Show this message\n";
+  text += "  quit - Exit shell\n";
+  text += "  exit - Exit shell\n";
+  text += "  stats - Show command timings (stats json: as JSON)\n";
 
   if (controller_) {
     auto commands = controller_->GetAvailableCommands();
     for (const auto& cmd : commands) {
-      output_ << "  " << cmd << "\n";
+      text += "  " + cmd + "\n";
     }
   }
+  return text;
+}
+
+std::string CliShell::StatsText() const {
+  const CommandMetrics* metrics =
+      controller_ ? controller_->GetMetrics() : nullptr;
+  if (!metrics) {
+    return "No metrics recorded\n";
+  }
+  const bool json =
+      !request_.arguments.empty() && request_.arguments[0] == "json";
+  return (json ? metrics->ToJson() : metrics->ToText()) + "\n";
 }
 
 }  // namespace presenter
@@ -0,0 +1,74 @@
+#include "line_tokenizer.h"
+
+namespace presenter {
+
+namespace {
+
+bool IsBlank(char c) { return c == ' ' || c == '\t'; }
+
+bool IsSpecial(char c) { return c == '"' || c == '\'' || c == '\\'; }
+
+}  // namespace
+
+bool LineTokenizer::Tokenize(std::string_view line,
+                             std::vector<std::string_view>& tokens) {
+  tokens.clear();
+  arena_.clear();
+  if (arena_.capacity() < line.size()) {
+    arena_.reserve(line.size());
+  }
+
+  size_t i = 0;
+  const size_t n = line.size();
+  while (true) {
+    while (i < n && IsBlank(line[i])) ++i;
+    if (i == n) {
+      return true;
+    }
+
+    // Fast path: a plain word is handed out as a view into line
+    const size_t start = i;
+    while (i < n && !IsBlank(line[i]) && !IsSpecial(line[i])) ++i;
+    if (i == n || IsBlank(line[i])) {
+      tokens.push_back(line.substr(start, i - start));
+      continue;
+    }
+
+    // Otherwise decode the word into the arena
+    const size_t begin = arena_.size();
+    arena_.append(line.data() + start, i - start);
+    char quote = 0;
+    for (; i < n && (quote || !IsBlank(line[i])); ++i) {
+      const char c = line[i];
+      if (quote == '\'') {
+        if (c == '\'') {
+          quote = 0;
+        } else {
+          arena_ += c;
+        }
+      } else if (quote == '"') {
+        if (c == '"') {
+          quote = 0;
+        } else if (c == '\\' && i + 1 < n &&
+                   (line[i + 1] == '"' || line[i + 1] == '\\')) {
+          arena_ += line[++i];
+        } else {
+          arena_ += c;
+        }
+      } else if (c == '"' || c == '\'') {
+        quote = c;
+      } else if (c == '\\' && i + 1 < n) {
+        arena_ += line[++i];
+      } else {
+        arena_ += c;  // includes a backslash ending the line
+      }
+    }
+    if (quote) {
+      tokens.clear();
+      return false;
+    }
+    tokens.push_back(std::string_view(arena_).substr(begin));
+  }
+}
+
+}  // namespace presenter
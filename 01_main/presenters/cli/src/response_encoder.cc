@@ -0,0 +1,186 @@
+#include "response_encoder.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace presenter {
+
+namespace {
+
+constexpr char kHex[] = "0123456789abcdef";
+
+void AppendJsonString(std::string_view text, std::string& out) {
+  out += '"';
+  for (const char c : text) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out += "\\u00";
+          out += kHex[(c >> 4) & 0xf];
+          out += kHex[c & 0xf];
+        } else {
+          out += c;  // UTF-8 passes through as is
+        }
+    }
+  }
+  out += '"';
+}
+
+void AppendJsonValue(const Value& value, std::string& out) {
+  std::visit(
+      [&out](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+          out += "null";
+        } else if constexpr (std::is_same_v<T, bool>) {
+          out += v ? "true" : "false";
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+          out += std::to_string(v);
+        } else if constexpr (std::is_same_v<T, double>) {
+          if (!std::isfinite(v)) {
+            out += "null";
+            return;
+          }
+          char buffer[32];
+          // Enough digits to read back the same double
+          const int length =
+              std::snprintf(buffer, sizeof(buffer), "%.17g", v);
+          out.append(buffer, static_cast<size_t>(length));
+        } else {
+          AppendJsonString(v, out);
+        }
+      },
+      value);
+}
+
+template <typename T>
+void AppendLittleEndian(T value, std::string& out) {
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void AppendU32(size_t value, std::string& out) {
+  AppendLittleEndian(static_cast<uint32_t>(value), out);
+}
+
+void AppendBinaryString(std::string_view text, std::string& out) {
+  AppendU32(text.size(), out);
+  out.append(text);
+}
+
+void AppendBinaryValue(const Value& value, std::string& out) {
+  // The type byte is the variant index
+  out += static_cast<char>(value.index());
+  std::visit(
+      [&out](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, bool>) {
+          out += static_cast<char>(v ? 1 : 0);
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+          AppendLittleEndian(static_cast<uint64_t>(v), out);
+        } else if constexpr (std::is_same_v<T, double>) {
+          uint64_t bits;
+          std::memcpy(&bits, &v, sizeof(bits));
+          AppendLittleEndian(bits, out);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+          AppendBinaryString(v, out);
+        }
+      },
+      value);
+}
+
+}  // namespace
+
+void ResponseEncoder::Encode(std::string_view command,
+                             const Response& response,
+                             std::string& out) const {
+  switch (format_) {
+    case OutputFormat::kText:
+      out += response.message;
+      out += '\n';
+      break;
+    case OutputFormat::kJsonLines:
+      EncodeJsonLine(command, response, out);
+      break;
+    case OutputFormat::kBinary:
+      EncodeBinaryFrame(command, response, out);
+      break;
+  }
+}
+
+void ResponseEncoder::EncodeJsonLine(std::string_view command,
+                                     const Response& response,
+                                     std::string& out) {
+  out += "{\"command\":";
+  AppendJsonString(command, out);
+  out += ",\"success\":";
+  out += response.success ? "true" : "false";
+  out += ",\"message\":";
+  AppendJsonString(response.message, out);
+  out += ",\"columns\":[";
+  const auto& columns = response.data.columns;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (i > 0) out += ',';
+    AppendJsonString(columns[i], out);
+  }
+  out += "],\"rows\":[";
+  const auto& rows = response.data.rows;
+  for (size_t r = 0; r < rows.size(); ++r) {
+    if (r > 0) out += ',';
+    out += '[';
+    for (size_t i = 0; i < columns.size(); ++i) {
+      if (i > 0) out += ',';
+      AppendJsonValue(i < rows[r].size() ? rows[r][i] : Value{}, out);
+    }
+    out += ']';
+  }
+  out += "]}\n";
+}
+
+void ResponseEncoder::EncodeBinaryFrame(std::string_view command,
+                                        const Response& response,
+                                        std::string& out) {
+  const size_t frame = out.size();
+  AppendU32(0, out);  // length, filled in at the end
+
+  out += static_cast<char>(response.success ? 1 : 0);
+  AppendBinaryString(command, out);
+  AppendBinaryString(response.message, out);
+  const auto& columns = response.data.columns;
+  AppendU32(columns.size(), out);
+  for (const auto& column : columns) {
+    AppendBinaryString(column, out);
+  }
+  const auto& rows = response.data.rows;
+  AppendU32(rows.size(), out);
+  for (const auto& row : rows) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+      AppendBinaryValue(i < row.size() ? row[i] : Value{}, out);
+    }
+  }
+
+  const size_t length = out.size() - frame - sizeof(uint32_t);
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    out[frame + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+  }
+}
+
+}  // namespace presenter
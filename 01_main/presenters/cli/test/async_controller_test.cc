@@ -0,0 +1,135 @@
+// Tests for the worker pool controller
+// Following Google C++ Style Guide
+
+#include "async_controller.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "req_response_interface.h"
+
+namespace presenter {
+namespace {
+
+// "sleep <ms>" sleeps, "fail" throws, anything else answers its name.
+// Records the most commands seen running at once and the start order.
+class SlowController : public RequestResponseInterface {
+ public:
+  Response HandleRequest(const Request& request) override {
+    const int now = ++running_;
+    int seen = max_running_.load();
+    while (now > seen && !max_running_.compare_exchange_weak(seen, now)) {
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      started_.push_back(request.command);
+    }
+    if (request.command == "sleep") {
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(std::stoi(request.arguments.at(0))));
+    }
+    --running_;
+    if (request.command == "fail") {
+      throw std::runtime_error("command failed");
+    }
+    return {true, request.command};
+  }
+
+  std::vector<std::string> GetAvailableCommands() const override {
+    return {"sleep", "fail"};
+  }
+
+  int MaxRunning() const { return max_running_; }
+  std::vector<std::string> Started() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return started_;
+  }
+
+ private:
+  std::atomic<int> running_{0};
+  std::atomic<int> max_running_{0};
+  std::mutex mutex_;
+  std::vector<std::string> started_;
+};
+
+TEST(AsyncControllerTest, RunsRequestsConcurrently) {
+  auto inner = std::make_shared<SlowController>();
+  AsyncController controller(inner, 4);
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::future<Response>> responses;
+  for (int i = 0; i < 4; ++i) {
+    responses.push_back(controller.HandleRequestAsync({"sleep", {"50"}}));
+  }
+  for (auto& response : responses) {
+    EXPECT_TRUE(response.get().success);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(inner->MaxRunning(), 4);
+  EXPECT_LT(elapsed, std::chrono::milliseconds(150));
+}
+
+TEST(AsyncControllerTest, ExclusiveCommandsRunAloneAndInOrder) {
+  auto inner = std::make_shared<SlowController>();
+  AsyncController controller(inner, 4, {"write"});
+
+  auto first = controller.HandleRequestAsync({"sleep", {"30"}});
+  auto write = controller.HandleRequestAsync({"write", {}});
+  auto after = controller.HandleRequestAsync({"read", {}});
+  first.get();
+  write.get();
+  after.get();
+
+  EXPECT_EQ(inner->Started(),
+            (std::vector<std::string>{"sleep", "write", "read"}));
+  EXPECT_EQ(inner->MaxRunning(), 1);
+}
+
+TEST(AsyncControllerTest, ExceptionsReachTheFuture) {
+  AsyncController controller(std::make_shared<SlowController>(), 1);
+  auto response = controller.HandleRequestAsync({"fail", {}});
+  EXPECT_THROW(response.get(), std::runtime_error);
+}
+
+TEST(AsyncControllerTest, SubmitCallsBackOnceTheResponseIsReady) {
+  AsyncController controller(std::make_shared<SlowController>(), 2);
+  std::promise<void> called;
+  std::future<Response> response;
+  response = controller.Submit({"sleep", {"10"}}, [&] { called.set_value(); });
+
+  called.get_future().get();
+  EXPECT_EQ(response.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  EXPECT_EQ(response.get().message, "sleep");
+}
+
+TEST(AsyncControllerTest, DestructorFinishesQueuedRequests) {
+  auto inner = std::make_shared<SlowController>();
+  std::future<Response> last;
+  {
+    AsyncController controller(inner, 1);
+    for (int i = 0; i < 5; ++i) {
+      last = controller.HandleRequestAsync({"sleep", {"5"}});
+    }
+  }
+  EXPECT_TRUE(last.get().success);
+  EXPECT_EQ(inner->Started().size(), 5u);
+}
+
+TEST(AsyncControllerTest, RejectsBadArguments) {
+  EXPECT_THROW(AsyncController(nullptr, 1), std::invalid_argument);
+  EXPECT_THROW(AsyncController(std::make_shared<SlowController>(), 0),
+               std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace presenter
@@ -6,9 +6,14 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "async_controller.h"
 #include "req_response_interface.h"
 
 namespace presenter {
@@ -152,5 +157,351 @@ TEST_F(CliShellTest, HelpShowsControllerCommands) {
   EXPECT_TRUE(output.find("test") != std::string::npos);
 }
 
+// Reports the metrics it is given
+class MeteredController : public MockController {
+ public:
+  const CommandMetrics* GetMetrics() const override { return &metrics; }
+
+  CommandMetrics metrics;
+};
+
+TEST_F(CliShellTest, StatsShowsTheControllerMetrics) {
+  auto controller = std::make_shared<MeteredController>();
+  controller->metrics.Record("test", std::chrono::microseconds(7), true);
+  input_stream_.str("stats\nstats json\nquit\n");
+  CliShell shell(input_stream_, output_stream_);
+  shell.SetController(controller);
+  shell.Run();
+
+  const std::string output = output_stream_.str();
+  EXPECT_NE(output.find("p99_us"), std::string::npos);
+  EXPECT_NE(output.find("{\"commands\":{\"test\":{\"calls\":1"),
+            std::string::npos);
+}
+
+TEST_F(CliShellTest, StatsWithoutMetrics) {
+  input_stream_.str("stats\nquit\n");
+  CliShell shell(input_stream_, output_stream_);
+  shell.SetController(std::make_shared<MockController>());
+  shell.Run();
+
+  EXPECT_NE(output_stream_.str().find("No metrics recorded"),
+            std::string::npos);
+}
+
+// ============================================================================
+// Batch Mode Tests
+// ============================================================================
+
+class BatchCliShellTest : public CliShellTest {
+ protected:
+  int RunBatch(const std::string& script, CliShellOptions options = {}) {
+    options.batch = true;
+    input_stream_.str(script);
+    CliShell shell(input_stream_, output_stream_, options);
+    shell.SetController(std::make_shared<MockController>());
+    return shell.Run();
+  }
+};
+
+TEST_F(BatchCliShellTest, PrintsOnlyCommandOutput) {
+  int exit_code = RunBatch("test\ntest\n");
+
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output_stream_.str(),
+            "Test command executed\nTest command executed\n");
+}
+
+TEST_F(BatchCliShellTest, SkipsCommentsAndCarriageReturns) {
+  int exit_code = RunBatch("# setup\r\ntest\r\n\r\n");
+
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output_stream_.str(), "Test command executed\n");
+}
+
+TEST_F(BatchCliShellTest, ExitCodeReflectsAFailureAndRunsTheRest) {
+  int exit_code = RunBatch("test\nbroken\ntest\n");
+
+  EXPECT_EQ(exit_code, 1);
+  EXPECT_EQ(output_stream_.str(),
+            "Test command executed\nCommand not implemented\n"
+            "Test command executed\n");
+}
+
+TEST_F(BatchCliShellTest, StopOnErrorStopsAtTheFirstFailure) {
+  CliShellOptions options;
+  options.stop_on_error = true;
+  int exit_code = RunBatch("test\nbroken\ntest\n", options);
+
+  EXPECT_EQ(exit_code, 1);
+  EXPECT_EQ(output_stream_.str(),
+            "Test command executed\nCommand not implemented\n");
+}
+
+TEST_F(BatchCliShellTest, QuitEndsTheScript) {
+  int exit_code = RunBatch("test\nquit\nbroken\n");
+
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output_stream_.str(), "Test command executed\n");
+}
+
+// Keeps the arguments of the last request, read through the views
+class RecordingController : public MockController {
+ public:
+  Response HandleRequestView(const RequestView& request) override {
+    arguments.assign(request.arguments.begin(), request.arguments.end());
+    return {true, "ok"};
+  }
+
+  std::vector<std::string> arguments;
+};
+
+TEST_F(BatchCliShellTest, QuotedArgumentsReachTheControllerWhole) {
+  auto controller = std::make_shared<RecordingController>();
+  CliShellOptions options;
+  options.batch = true;
+  input_stream_.str("add \"two words\" 'it''s'\nadd \"open\n");
+  CliShell shell(input_stream_, output_stream_, options);
+  shell.SetController(controller);
+
+  EXPECT_EQ(shell.Run(), 1);
+  EXPECT_EQ(controller->arguments,
+            (std::vector<std::string>{"two words", "its"}));
+  EXPECT_EQ(output_stream_.str(), "ok\nError: unterminated quote\n");
+}
+
+// Prints "part0".."part<n-1>" through the sink, noting what had reached
+// the output stream before each part
+class StreamingController : public MockController {
+ public:
+  StreamingController(std::ostringstream& output, int parts)
+      : output_(output), parts_(parts) {}
+
+  Response HandleRequestStreamed(const RequestView&,
+                                 const ResponseSink& sink) override {
+    for (int i = 0; i < parts_; ++i) {
+      seen.push_back(output_.str().size());
+      if (!sink("part" + std::to_string(i))) break;
+    }
+    return {true, ""};
+  }
+
+  std::vector<size_t> seen;
+
+ private:
+  std::ostringstream& output_;
+  int parts_;
+};
+
+TEST_F(CliShellTest, StreamedPartsAreWrittenAsTheyCome) {
+  input_stream_.str("stream\nquit\n");
+  auto controller = std::make_shared<StreamingController>(output_stream_, 3);
+  CliShell shell(input_stream_, output_stream_);
+  shell.SetController(controller);
+  shell.Run();
+
+  EXPECT_NE(output_stream_.str().find("part0part1part2\n"), std::string::npos);
+  ASSERT_EQ(controller->seen.size(), 3u);
+  EXPECT_LT(controller->seen[0], controller->seen[1]);
+  EXPECT_LT(controller->seen[1], controller->seen[2]);
+}
+
+TEST_F(BatchCliShellTest, LongStreamedOutputIsNotHeldWhole) {
+  CliShellOptions options;
+  options.batch = true;
+  options.flush_every = 0;  // only the size bound writes early
+  input_stream_.str("stream\n");
+  auto controller =
+      std::make_shared<StreamingController>(output_stream_, 50000);
+  CliShell shell(input_stream_, output_stream_, options);
+  shell.SetController(controller);
+  shell.Run();
+
+  EXPECT_GT(controller->seen.back(), 0u);  // written before the end
+  EXPECT_EQ(output_stream_.str().substr(0, 10), "part0part1");
+  EXPECT_EQ(output_stream_.str().back(), '\n');
+}
+
+// Counts flushes of the stream it wraps
+class CountingBuffer : public std::stringbuf {
+ public:
+  int syncs = 0;
+
+ protected:
+  int sync() override {
+    ++syncs;
+    return std::stringbuf::sync();
+  }
+};
+
+TEST_F(BatchCliShellTest, FlushesPeriodically) {
+  CountingBuffer buffer;
+  std::ostream counted(&buffer);
+  std::string script;
+  for (int i = 0; i < 10; ++i) script += "test\n";
+  input_stream_.str(script);
+
+  CliShellOptions options;
+  options.batch = true;
+  options.flush_every = 4;
+  CliShell shell(input_stream_, counted, options);
+  shell.SetController(std::make_shared<MockController>());
+  shell.Run();
+
+  EXPECT_EQ(buffer.syncs, 3);  // after 4 and 8 commands, then at the end
+  const std::string line = "Test command executed\n";
+  EXPECT_EQ(buffer.str().size(), 10 * line.size());
+}
+
+// Answers "rows" with typed rows behind its message
+class TableController : public MockController {
+ public:
+  Response HandleRequest(const Request& request) override {
+    if (request.command != "rows") {
+      return MockController::HandleRequest(request);
+    }
+    ResponseData data;
+    data.columns = {"index", "item"};
+    data.rows = {{int64_t{1}, std::string("a")},
+                 {int64_t{2}, std::string("b")}};
+    return Response{true, "Stored items (2)", std::move(data)};
+  }
+};
+
+TEST_F(BatchCliShellTest, JsonLinesEncodeEveryResponse) {
+  CliShellOptions options;
+  options.batch = true;
+  options.output_format = OutputFormat::kJsonLines;
+  input_stream_.str("rows\nbroken\n\"open\n");
+  CliShell shell(input_stream_, output_stream_, options);
+  shell.SetController(std::make_shared<TableController>());
+
+  EXPECT_EQ(shell.Run(), 1);
+  EXPECT_EQ(output_stream_.str(),
+            "{\"command\":\"rows\",\"success\":true,"
+            "\"message\":\"Stored items (2)\","
+            "\"columns\":[\"index\",\"item\"],"
+            "\"rows\":[[1,\"a\"],[2,\"b\"]]}\n"
+            "{\"command\":\"broken\",\"success\":false,"
+            "\"message\":\"Command not implemented\",\"columns\":[],"
+            "\"rows\":[]}\n"
+            "{\"command\":\"\",\"success\":false,"
+            "\"message\":\"Error: unterminated quote\",\"columns\":[],"
+            "\"rows\":[]}\n");
+}
+
+TEST_F(BatchCliShellTest, BinaryFramesOneResponseEach) {
+  CliShellOptions options;
+  options.batch = true;
+  options.output_format = OutputFormat::kBinary;
+  input_stream_.str("rows\nhelp\n");
+  CliShell shell(input_stream_, output_stream_, options);
+  shell.SetController(std::make_shared<TableController>());
+
+  EXPECT_EQ(shell.Run(), 0);
+  std::string expected;
+  ResponseEncoder encoder(OutputFormat::kBinary);
+  encoder.Encode("rows", TableController().HandleRequest({"rows", {}}),
+                 expected);
+  const std::string output = output_stream_.str();
+  ASSERT_GT(output.size(), expected.size());
+  EXPECT_EQ(output.substr(0, expected.size()), expected);
+  EXPECT_NE(output.find("Available commands:"), std::string::npos);
+}
+
+// ============================================================================
+// Async Mode Tests
+// ============================================================================
+
+// "slow" answers late, so a pipelined shell must still hold its output
+// back until it is that command's turn
+class SlowController : public MockController {
+ public:
+  Response HandleRequest(const Request& request) override {
+    if (request.command == "slow") {
+      std::this_thread::sleep_for(std::chrono::milliseconds(30));
+      return {true, "slow done"};
+    }
+    return MockController::HandleRequest(request);
+  }
+};
+
+class AsyncCliShellTest : public CliShellTest {
+ protected:
+  int RunAsync(const std::string& script, CliShellOptions options = {}) {
+    options.batch = true;
+    options.max_in_flight = 8;
+    input_stream_.str(script);
+    CliShell shell(input_stream_, output_stream_, options);
+    shell.SetController(
+        std::make_shared<AsyncController>(std::make_shared<SlowController>(),
+                                          4));
+    return shell.Run();
+  }
+};
+
+TEST_F(AsyncCliShellTest, PrintsResponsesInSubmissionOrder) {
+  int exit_code = RunAsync("slow\ntest\nhelp\n");
+
+  EXPECT_EQ(exit_code, 0);
+  const std::string output = output_stream_.str();
+  const size_t slow = output.find("slow done");
+  const size_t test = output.find("Test command executed");
+  const size_t help = output.find("Available commands:");
+  ASSERT_NE(slow, std::string::npos);
+  EXPECT_LT(slow, test);
+  EXPECT_LT(test, help);
+}
+
+TEST_F(AsyncCliShellTest, TagsResponsesWithTheirCommandNumber) {
+  CliShellOptions options;
+  options.tag_responses = true;
+  RunAsync("# numbered from the first command\nslow\ntest\n", options);
+
+  EXPECT_EQ(output_stream_.str(),
+            "[1] slow done\n[2] Test command executed\n");
+}
+
+TEST_F(AsyncCliShellTest, ExitCodeReflectsAFailure) {
+  EXPECT_EQ(RunAsync("slow\nbroken\ntest\n"), 1);
+  EXPECT_EQ(output_stream_.str(),
+            "slow done\nCommand not implemented\nTest command executed\n");
+}
+
+TEST_F(AsyncCliShellTest, QuitWaitsForCommandsInFlight) {
+  EXPECT_EQ(RunAsync("slow\nquit\nbroken\n"), 0);
+  EXPECT_EQ(output_stream_.str(), "slow done\n");
+}
+
+TEST_F(AsyncCliShellTest, JsonLinesKeepSubmissionOrder) {
+  CliShellOptions options;
+  options.output_format = OutputFormat::kJsonLines;
+  options.tag_responses = true;  // text only
+  RunAsync("slow\nbroken\nstats\n", options);
+
+  EXPECT_EQ(output_stream_.str(),
+            "{\"command\":\"slow\",\"success\":true,"
+            "\"message\":\"slow done\",\"columns\":[],\"rows\":[]}\n"
+            "{\"command\":\"broken\",\"success\":false,"
+            "\"message\":\"Command not implemented\",\"columns\":[],"
+            "\"rows\":[]}\n"
+            "{\"command\":\"stats\",\"success\":true,"
+            "\"message\":\"No metrics recorded\",\"columns\":[],"
+            "\"rows\":[]}\n");
+}
+
+TEST_F(AsyncCliShellTest, WorksWithASynchronousController) {
+  CliShellOptions options;
+  options.batch = true;
+  options.max_in_flight = 2;
+  input_stream_.str("test\ntest\ntest\n");
+  CliShell shell(input_stream_, output_stream_, options);
+  shell.SetController(std::make_shared<MockController>());
+
+  EXPECT_EQ(shell.Run(), 0);
+  const std::string line = "Test command executed\n";
+  EXPECT_EQ(output_stream_.str(), line + line + line);
+}
+
 }  // namespace
 }  // namespace presenter
@@ -0,0 +1,119 @@
+// Tests for per-command metrics
+// Following Google C++ Style Guide
+
+#include "command_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace presenter {
+namespace {
+
+using std::chrono::microseconds;
+
+TEST(LatencyHistogramTest, BucketsAreExactBelowSixteenThenRelative) {
+  for (int64_t us = 0; us < 16; ++us) {
+    EXPECT_EQ(LatencyHistogram::BucketOf(us), static_cast<size_t>(us));
+  }
+  // Every value lies in its bucket, and a bucket spans at most 1/16th
+  for (int64_t us : {16, 17, 31, 32, 33, 1000, 123456, 99999999}) {
+    const size_t bucket = LatencyHistogram::BucketOf(us);
+    const int64_t upper = LatencyHistogram::UpperBound(bucket);
+    const int64_t lower =
+        bucket == 0 ? 0 : LatencyHistogram::UpperBound(bucket - 1) + 1;
+    EXPECT_LE(lower, us);
+    EXPECT_GE(upper, us);
+    EXPECT_LE(upper - lower, us / 16) << us;
+  }
+  EXPECT_EQ(LatencyHistogram::BucketOf(int64_t{1} << 50),
+            LatencyHistogram::kBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, QuantilesAreWithinTheBucketPrecision) {
+  LatencyHistogram histogram;
+  for (int64_t us = 1; us <= 10000; ++us) {
+    histogram.Record(microseconds(us));
+  }
+
+  EXPECT_EQ(histogram.Count(), 10000u);
+  EXPECT_EQ(histogram.MinUs(), 1);
+  EXPECT_EQ(histogram.MaxUs(), 10000);
+  EXPECT_EQ(histogram.MeanUs(), 5000);
+  EXPECT_NEAR(histogram.QuantileUs(0.5), 5000, 5000 / 16);
+  EXPECT_NEAR(histogram.QuantileUs(0.99), 9900, 9900 / 16);
+  EXPECT_EQ(histogram.QuantileUs(1.0), 10000);
+  EXPECT_EQ(LatencyHistogram().QuantileUs(0.5), 0);
+}
+
+TEST(CommandMetricsTest, CountsCallsAndErrorsByCommand) {
+  CommandMetrics metrics;
+  metrics.Record("add", microseconds(10), true);
+  metrics.Record("add", microseconds(30), false);
+  metrics.Record("list", microseconds(5), true);
+
+  const auto commands = metrics.Commands();
+  ASSERT_EQ(commands.size(), 2u);
+  EXPECT_EQ(commands.at("add").calls, 2u);
+  EXPECT_EQ(commands.at("add").errors, 1u);
+  EXPECT_EQ(commands.at("add").latency.MaxUs(), 30);
+  EXPECT_EQ(commands.at("list").errors, 0u);
+
+  metrics.Reset();
+  EXPECT_TRUE(metrics.Commands().empty());
+  EXPECT_EQ(metrics.ToText(), "No commands run");
+}
+
+TEST(CommandMetricsTest, FormatsTextAndJson) {
+  CommandMetrics metrics;
+  metrics.Record("say \"hi\"", microseconds(20), true);
+
+  const std::string text = metrics.ToText();
+  EXPECT_EQ(text.find("command"), 0u);
+  EXPECT_NE(text.find("\nsay \"hi\""), std::string::npos);
+
+  EXPECT_EQ(metrics.ToJson(),
+            "{\"commands\":{\"say \\\"hi\\\"\":{\"calls\":1,\"errors\":0,"
+            "\"latency_us\":{\"mean\":20,\"min\":20,\"max\":20,\"p50\":20,"
+            "\"p90\":20,\"p99\":20,\"p999\":20,\"buckets\":{\"20\":1}}}}}");
+}
+
+TEST(CommandMetricsTest, ScopedTimerRecordsAThrowAsAnError) {
+  CommandMetrics metrics;
+  {
+    ScopedCommandTimer timer(&metrics, "ok");
+    timer.Succeeded(true);
+  }
+  try {
+    ScopedCommandTimer timer(&metrics, "throws");
+    throw 1;
+  } catch (int) {
+  }
+  { ScopedCommandTimer timer(nullptr, "unmetered"); }
+
+  const auto commands = metrics.Commands();
+  EXPECT_EQ(commands.size(), 2u);
+  EXPECT_EQ(commands.at("ok").errors, 0u);
+  EXPECT_EQ(commands.at("throws").errors, 1u);
+}
+
+TEST(CommandMetricsTest, RecordsFromManyThreads) {
+  CommandMetrics metrics;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 1000; ++i) {
+        metrics.Record("cmd", microseconds(i), true);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(metrics.Commands().at("cmd").calls, 4000u);
+}
+
+}  // namespace
+}  // namespace presenter
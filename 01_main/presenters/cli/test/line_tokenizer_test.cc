@@ -0,0 +1,80 @@
+// Tests for the command line tokenizer
+// Following Google C++ Style Guide
+
+#include "line_tokenizer.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace presenter {
+namespace {
+
+class LineTokenizerTest : public ::testing::Test {
+ protected:
+  std::vector<std::string> Split(std::string_view line) {
+    EXPECT_TRUE(tokenizer_.Tokenize(line, tokens_)) << line;
+    return std::vector<std::string>(tokens_.begin(), tokens_.end());
+  }
+
+  LineTokenizer tokenizer_;
+  std::vector<std::string_view> tokens_;
+};
+
+TEST_F(LineTokenizerTest, SplitsOnSpacesAndTabs) {
+  EXPECT_EQ(Split("  add\tone  two "),
+            (std::vector<std::string>{"add", "one", "two"}));
+  EXPECT_TRUE(Split("").empty());
+  EXPECT_TRUE(Split(" \t ").empty());
+}
+
+TEST_F(LineTokenizerTest, QuotesKeepBlanksInsideAWord) {
+  EXPECT_EQ(Split("add \"two words\" 'and  three' x\" y\"z"),
+            (std::vector<std::string>{"add", "two words", "and  three",
+                                      "x yz"}));
+  EXPECT_EQ(Split("add \"\" ''"), (std::vector<std::string>{"add", "", ""}));
+}
+
+TEST_F(LineTokenizerTest, BackslashEscapesOutsideAndInsideDoubleQuotes) {
+  EXPECT_EQ(Split(R"(it\'s two\ words \"x\" trailing\)"),
+            (std::vector<std::string>{"it's", "two words", "\"x\"",
+                                      "trailing\\"}));
+  EXPECT_EQ(Split(R"("say \"hi\" \\ C:\dir")"),
+            (std::vector<std::string>{R"(say "hi" \ C:\dir)"}));
+  EXPECT_EQ(Split(R"('C:\dir\' x)"),
+            (std::vector<std::string>{R"(C:\dir\)", "x"}));
+}
+
+TEST_F(LineTokenizerTest, RejectsAnUnterminatedQuote) {
+  EXPECT_FALSE(tokenizer_.Tokenize("add \"open", tokens_));
+  EXPECT_TRUE(tokens_.empty());
+  EXPECT_FALSE(tokenizer_.Tokenize("add 'open", tokens_));
+}
+
+TEST_F(LineTokenizerTest, PlainWordsViewTheLine) {
+  const std::string line = "add plain \"quoted word\"";
+  ASSERT_TRUE(tokenizer_.Tokenize(line, tokens_));
+  ASSERT_EQ(tokens_.size(), 3u);
+  EXPECT_EQ(tokens_[1].data(), line.data() + 4);
+  EXPECT_EQ(tokens_[2], "quoted word");
+}
+
+TEST_F(LineTokenizerTest, ReusedBuffersStopGrowing) {
+  const std::string line = "add \"a b\" 'c d' e\\ f";
+  ASSERT_TRUE(tokenizer_.Tokenize(line, tokens_));
+  const std::string_view first = tokens_[1];
+  const size_t capacity = tokens_.capacity();
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(tokenizer_.Tokenize(line, tokens_));
+  }
+  // Same arena storage, same token storage
+  EXPECT_EQ(tokens_[1].data(), first.data());
+  EXPECT_EQ(tokens_.capacity(), capacity);
+  EXPECT_EQ(tokens_[3], "e f");
+}
+
+}  // namespace
+}  // namespace presenter
@@ -0,0 +1,111 @@
+// Tests for the machine-readable response encodings
+// Following Google C++ Style Guide
+
+#include "response_encoder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace presenter {
+namespace {
+
+Response TableResponse() {
+  ResponseData data;
+  data.columns = {"id", "name", "score", "active", "note"};
+  data.rows = {{int64_t{1}, std::string("a\"b"), 0.5, true, Value{}},
+               {int64_t{-2}, std::string("tab\there")}};
+  return Response{true, "2 rows\n", std::move(data)};
+}
+
+// Reads the little-endian integer at pos and moves past it
+template <typename T>
+T Read(const std::string& bytes, size_t& pos) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    value |= uint64_t{static_cast<unsigned char>(bytes[pos + i])} << (8 * i);
+  }
+  pos += sizeof(T);
+  return static_cast<T>(value);
+}
+
+std::string ReadString(const std::string& bytes, size_t& pos) {
+  const uint32_t length = Read<uint32_t>(bytes, pos);
+  std::string text = bytes.substr(pos, length);
+  pos += length;
+  return text;
+}
+
+TEST(ResponseEncoderTest, TextIsTheMessageOnALine) {
+  std::string out;
+  ResponseEncoder(OutputFormat::kText).Encode("x", Response{true, "hi"}, out);
+  EXPECT_EQ(out, "hi\n");
+}
+
+TEST(ResponseEncoderTest, JsonLineCarriesTypedRows) {
+  std::string out;
+  ResponseEncoder(OutputFormat::kJsonLines).Encode("list", TableResponse(),
+                                                   out);
+  EXPECT_EQ(out,
+            "{\"command\":\"list\",\"success\":true,\"message\":\"2 rows\\n\","
+            "\"columns\":[\"id\",\"name\",\"score\",\"active\",\"note\"],"
+            "\"rows\":[[1,\"a\\\"b\",0.5,true,null],"
+            "[-2,\"tab\\there\",null,null,null]]}\n");
+}
+
+TEST(ResponseEncoderTest, JsonEscapesControlsAndNullsNonFiniteDoubles) {
+  ResponseData data;
+  data.columns = {"v"};
+  data.rows = {{std::numeric_limits<double>::infinity()}};
+  std::string out;
+  ResponseEncoder(OutputFormat::kJsonLines)
+      .Encode("c", Response{false, std::string("\x01", 1), data}, out);
+  EXPECT_NE(out.find("\"message\":\"\\u0001\""), std::string::npos);
+  EXPECT_NE(out.find("\"rows\":[[null]]"), std::string::npos);
+  EXPECT_NE(out.find("\"success\":false"), std::string::npos);
+}
+
+TEST(ResponseEncoderTest, BinaryFrameRoundTrips) {
+  std::string out = "prefix";
+  ResponseEncoder(OutputFormat::kBinary).Encode("list", TableResponse(), out);
+
+  size_t pos = 6;
+  const uint32_t length = Read<uint32_t>(out, pos);
+  EXPECT_EQ(length, out.size() - pos);
+  EXPECT_EQ(out[pos++], 1);  // success
+  EXPECT_EQ(ReadString(out, pos), "list");
+  EXPECT_EQ(ReadString(out, pos), "2 rows\n");
+  ASSERT_EQ(Read<uint32_t>(out, pos), 5u);
+  for (const char* column : {"id", "name", "score", "active", "note"}) {
+    EXPECT_EQ(ReadString(out, pos), column);
+  }
+  ASSERT_EQ(Read<uint32_t>(out, pos), 2u);
+
+  EXPECT_EQ(out[pos++], 2);
+  EXPECT_EQ(Read<int64_t>(out, pos), 1);
+  EXPECT_EQ(out[pos++], 4);
+  EXPECT_EQ(ReadString(out, pos), "a\"b");
+  EXPECT_EQ(out[pos++], 3);
+  const uint64_t bits = Read<uint64_t>(out, pos);
+  double score;
+  std::memcpy(&score, &bits, sizeof(score));
+  EXPECT_EQ(score, 0.5);
+  EXPECT_EQ(out[pos++], 1);
+  EXPECT_EQ(out[pos++], 1);  // true
+  EXPECT_EQ(out[pos++], 0);  // null
+
+  EXPECT_EQ(out[pos++], 2);
+  EXPECT_EQ(Read<int64_t>(out, pos), -2);
+  EXPECT_EQ(out[pos++], 4);
+  EXPECT_EQ(ReadString(out, pos), "tab\there");
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(out[pos++], 0);  // padded
+  }
+  EXPECT_EQ(pos, out.size());
+}
+
+}  // namespace
+}  // namespace presenter
@@ -0,0 +1,139 @@
+// Line protocol server for RequestResponseInterface
+#ifndef PRESENTER_TCP_TCP_SERVER_H_
+#define PRESENTER_TCP_TCP_SERVER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "async_controller.h"
+#include "line_tokenizer.h"
+#include "req_response_interface.h"
+
+namespace presenter {
+
+struct TcpServerOptions {
+  // Address to listen on; port 0 picks a free one (see Port())
+  std::string host = "127.0.0.1";
+  uint16_t port = 0;
+  // Commands run on this many worker threads. Commands named exclusive
+  // run alone and in order, as with AsyncController.
+  size_t workers = 4;
+  std::set<std::string> exclusive_commands;
+  // A connection stops being read while this many of its commands are
+  // unanswered or this much output is unsent
+  size_t max_pipeline = 64;
+  size_t max_output_bytes = 1 << 20;
+  // A longer request line is answered with an error and the connection
+  // closed
+  size_t max_line_bytes = 64 * 1024;
+};
+
+// Serves a controller to many clients over TCP, one epoll loop thread
+// handling every socket and a worker pool running the commands.
+//
+// A request is a command line, as typed into CliShell, ended by "\n".
+// Each gets "OK <n>\n" or "ERR <n>\n", then the n bytes of the message
+// and "\n". Connections stay open for any number of requests, and
+// requests may be pipelined: responses come back in request order.
+// "help" lists the commands, "stats [json]" shows the controller's
+// metrics and "quit" closes the connection once the requests before it
+// are answered.
+class TcpServer {
+ public:
+  // Throws std::invalid_argument if controller is null or workers is 0
+  TcpServer(std::shared_ptr<RequestResponseInterface> controller,
+            const TcpServerOptions& options = {});
+  ~TcpServer();
+
+  // Disable copy and move
+  TcpServer(const TcpServer&) = delete;
+  TcpServer& operator=(const TcpServer&) = delete;
+  TcpServer(TcpServer&&) = delete;
+  TcpServer& operator=(TcpServer&&) = delete;
+
+  // Binds and listens; throws std::system_error on failure
+  void Listen();
+  // The port listened on, once Listen() returned
+  uint16_t Port() const { return port_; }
+  // Serves until Stop(); calls Listen() first if needed
+  void Run();
+  // Makes Run() return; safe from any thread, including before Run()
+  void Stop();
+
+  // Connections open right now
+  size_t ConnectionCount() const;
+
+ private:
+  struct Pending {
+    std::future<Response> response;  // not valid for built-in output
+    std::string text;                // built-in output, already framed
+  };
+
+  struct Connection {
+    int fd = -1;
+    std::string input;   // not yet parsed
+    std::string output;  // not yet sent
+    size_t sent = 0;     // bytes of output already sent
+    std::deque<Pending> pending;
+    bool read_closed = false;  // peer done sending, or quit; no reads
+    bool quit = false;         // the rest of input is ignored
+    uint32_t events = 0;       // epoll interest
+  };
+
+  void Accept();
+  // False if the connection broke
+  bool Read(Connection& connection);
+  void ParseRequests(uint64_t id, Connection& connection);
+  void Dispatch(uint64_t id, Connection& connection, std::string_view line);
+  // Frames the ready responses at the front of the pipeline
+  void Collect(Connection& connection);
+  // False once the peer is gone
+  bool Send(Connection& connection);
+  // Sends what it can, updates the epoll interest, closes when done
+  void Update(uint64_t id, Connection& connection);
+  void Close(uint64_t id);
+  void Watch(int fd, uint32_t events, uint64_t id, bool add);
+  void Wake();
+
+  std::string HelpText() const;
+
+  static std::string Frame(bool success, std::string_view message);
+  static size_t Unsent(const Connection& connection);
+
+  const TcpServerOptions options_;
+  std::shared_ptr<RequestResponseInterface> controller_;
+
+  int listen_fd_ = -1;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  uint16_t port_ = 0;
+
+  // Loop thread only
+  std::unordered_map<uint64_t, Connection> connections_;
+  uint64_t next_id_ = 2;  // 0 and 1 tag the listen and wake fds
+  LineTokenizer tokenizer_;
+  std::vector<std::string_view> tokens_;
+
+  // Shared with the workers and Stop()
+  mutable std::mutex mutex_;
+  std::vector<uint64_t> ready_;  // connections with a response ready
+  bool stopping_ = false;
+  size_t connection_count_ = 0;
+
+  // Declared last: its workers call back into the members above, so it
+  // has to stop first
+  std::unique_ptr<AsyncController> pool_;
+};
+
+}  // namespace presenter
+
+#endif  // PRESENTER_TCP_TCP_SERVER_H_
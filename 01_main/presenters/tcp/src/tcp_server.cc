@@ -0,0 +1,399 @@
+#include "tcp_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace presenter {
+
+namespace {
+
+constexpr uint64_t kListenId = 0;
+constexpr uint64_t kWakeId = 1;
+constexpr size_t kReadChunk = 16 * 1024;
+
+[[noreturn]] void ThrowErrno(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+}  // namespace
+
+TcpServer::TcpServer(std::shared_ptr<RequestResponseInterface> controller,
+                     const TcpServerOptions& options)
+    : options_(options), controller_(std::move(controller)) {
+  if (!controller_) {
+    throw std::invalid_argument("TcpServer needs a controller");
+  }
+  if (options_.max_pipeline == 0) {
+    throw std::invalid_argument("TcpServer needs max_pipeline > 0");
+  }
+  pool_ = std::make_unique<AsyncController>(controller_, options_.workers,
+                                            options_.exclusive_commands);
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd_ < 0 || wake_fd_ < 0) {
+    const int error = errno;
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    throw std::system_error(error, std::generic_category(), "TcpServer");
+  }
+  Watch(wake_fd_, EPOLLIN, kWakeId, true);
+}
+
+TcpServer::~TcpServer() {
+  // Lets the queued commands finish while the wake fd is still open
+  pool_.reset();
+  for (auto& [id, connection] : connections_) {
+    close(connection.fd);
+  }
+  if (listen_fd_ >= 0) close(listen_fd_);
+  close(wake_fd_);
+  close(epoll_fd_);
+}
+
+void TcpServer::Listen() {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(options_.port);
+  if (inet_pton(AF_INET, options_.host.c_str(), &address.sin_addr) != 1) {
+    throw std::system_error(EINVAL, std::generic_category(),
+                            "Bad listen address " + options_.host);
+  }
+
+  listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    ThrowErrno("socket");
+  }
+  const int on = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) < 0) {
+    ThrowErrno("bind " + options_.host + ":" + std::to_string(options_.port));
+  }
+  if (listen(listen_fd_, SOMAXCONN) < 0) {
+    ThrowErrno("listen");
+  }
+  socklen_t length = sizeof(address);
+  getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+  port_ = ntohs(address.sin_port);
+  Watch(listen_fd_, EPOLLIN, kListenId, true);
+}
+
+void TcpServer::Run() {
+  if (listen_fd_ < 0) {
+    Listen();
+  }
+
+  std::vector<epoll_event> events(64);
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) break;
+    }
+    const int count = epoll_wait(epoll_fd_, events.data(),
+                                 static_cast<int>(events.size()), -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      ThrowErrno("epoll_wait");
+    }
+
+    for (int i = 0; i < count; ++i) {
+      const uint64_t id = events[i].data.u64;
+      const uint32_t happened = events[i].events;
+      if (id == kListenId) {
+        Accept();
+        continue;
+      }
+      if (id == kWakeId) {
+        uint64_t ignored;
+        while (read(wake_fd_, &ignored, sizeof(ignored)) > 0) {
+        }
+        std::vector<uint64_t> ready;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          ready.swap(ready_);
+        }
+        for (uint64_t ready_id : ready) {
+          auto it = connections_.find(ready_id);
+          if (it != connections_.end()) Update(ready_id, it->second);
+        }
+        continue;
+      }
+
+      auto it = connections_.find(id);
+      if (it == connections_.end()) {
+        continue;  // closed earlier in this batch
+      }
+      if (happened & (EPOLLERR | EPOLLHUP)) {
+        Close(id);
+        continue;
+      }
+      if ((happened & EPOLLIN) && !Read(it->second)) {
+        Close(id);
+        continue;
+      }
+      Update(id, it->second);
+    }
+  }
+
+  while (!connections_.empty()) {
+    Close(connections_.begin()->first);
+  }
+}
+
+void TcpServer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  Wake();
+}
+
+size_t TcpServer::ConnectionCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return connection_count_;
+}
+
+void TcpServer::Accept() {
+  while (true) {
+    const int fd =
+        accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      return;  // EAGAIN, or out of fds until a client leaves
+    }
+    // Responses are small and pipelined; do not hold them back
+    const int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    const uint64_t id = next_id_++;
+    Connection& connection = connections_[id];
+    connection.fd = fd;
+    connection.events = EPOLLIN;
+    Watch(fd, connection.events, id, true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++connection_count_;
+  }
+}
+
+bool TcpServer::Read(Connection& connection) {
+  char buffer[kReadChunk];
+  // Level-triggered, so stopping early only defers the rest
+  while (!connection.read_closed &&
+         connection.input.size() < options_.max_line_bytes) {
+    const ssize_t n = recv(connection.fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      connection.input.append(buffer, static_cast<size_t>(n));
+    } else if (n == 0) {
+      connection.read_closed = true;  // answer what was sent, then close
+    } else if (errno == EINTR) {
+      continue;
+    } else {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+  }
+  return true;
+}
+
+void TcpServer::ParseRequests(uint64_t id, Connection& connection) {
+  size_t begin = 0;
+  while (!connection.quit &&
+         connection.pending.size() < options_.max_pipeline &&
+         Unsent(connection) < options_.max_output_bytes) {
+    const size_t end = connection.input.find('\n', begin);
+    if (end == std::string::npos) {
+      if (connection.input.size() - begin >= options_.max_line_bytes) {
+        connection.pending.push_back(
+            {{}, Frame(false, "Request line too long")});
+        connection.quit = connection.read_closed = true;
+      }
+      break;
+    }
+    std::string_view line(connection.input.data() + begin, end - begin);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    begin = end + 1;
+    Dispatch(id, connection, line);
+  }
+  if (connection.quit) {
+    connection.input.clear();
+  } else {
+    connection.input.erase(0, begin);
+  }
+}
+
+void TcpServer::Dispatch(uint64_t id, Connection& connection,
+                         std::string_view line) {
+  Pending pending;
+  if (!tokenizer_.Tokenize(line, tokens_)) {
+    pending.text = Frame(false, "Unterminated quote");
+  } else if (tokens_.empty()) {
+    return;
+  } else if (tokens_[0] == "quit" || tokens_[0] == "exit") {
+    connection.quit = connection.read_closed = true;
+    return;
+  } else if (tokens_[0] == "help") {
+    pending.text = Frame(true, HelpText());
+  } else if (tokens_[0] == "stats") {
+    const CommandMetrics* metrics = controller_->GetMetrics();
+    const bool json = tokens_.size() > 1 && tokens_[1] == "json";
+    pending.text = metrics ? Frame(true, json ? metrics->ToJson()
+                                              : metrics->ToText())
+                           : Frame(false, "No metrics recorded");
+  } else {
+    Request request;
+    request.command.assign(tokens_[0]);
+    request.arguments.reserve(tokens_.size() - 1);
+    for (size_t i = 1; i < tokens_.size(); ++i) {
+      request.arguments.emplace_back(tokens_[i]);
+    }
+    pending.response = pool_->Submit(request, [this, id] {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(id);
+      }
+      Wake();
+    });
+  }
+  connection.pending.push_back(std::move(pending));
+}
+
+void TcpServer::Collect(Connection& connection) {
+  while (!connection.pending.empty()) {
+    Pending& front = connection.pending.front();
+    if (!front.response.valid()) {
+      connection.output += front.text;
+    } else if (front.response.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready) {
+      try {
+        Response response = front.response.get();
+        connection.output += Frame(response.success, response.message);
+      } catch (const std::exception& e) {
+        connection.output += Frame(false, std::string("Error: ") + e.what());
+      }
+    } else {
+      return;  // responses go out in request order
+    }
+    connection.pending.pop_front();
+  }
+}
+
+bool TcpServer::Send(Connection& connection) {
+  while (connection.sent < connection.output.size()) {
+    const ssize_t n =
+        send(connection.fd, connection.output.data() + connection.sent,
+             connection.output.size() - connection.sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      connection.sent += static_cast<size_t>(n);
+    } else if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else {
+      return false;
+    }
+  }
+  if (connection.sent == connection.output.size()) {
+    connection.output.clear();
+    connection.sent = 0;
+  } else if (connection.sent >= kReadChunk) {
+    connection.output.erase(0, connection.sent);
+    connection.sent = 0;
+  }
+  return true;
+}
+
+void TcpServer::Update(uint64_t id, Connection& connection) {
+  Collect(connection);
+  ParseRequests(id, connection);  // room may have opened
+  Collect(connection);
+  if (!Send(connection)) {
+    Close(id);
+    return;
+  }
+  if (connection.read_closed && connection.pending.empty() &&
+      connection.output.empty()) {
+    Close(id);
+    return;
+  }
+
+  uint32_t events = 0;
+  if (!connection.read_closed &&
+      connection.pending.size() < options_.max_pipeline &&
+      Unsent(connection) < options_.max_output_bytes) {
+    events |= EPOLLIN;
+  }
+  if (!connection.output.empty()) {
+    events |= EPOLLOUT;
+  }
+  if (events != connection.events) {
+    Watch(connection.fd, events, id, false);
+    connection.events = events;
+  }
+}
+
+void TcpServer::Close(uint64_t id) {
+  auto it = connections_.find(id);
+  if (it == connections_.end()) {
+    return;
+  }
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+  close(it->second.fd);
+  // Responses still being worked on are dropped with the connection
+  connections_.erase(it);
+  std::lock_guard<std::mutex> lock(mutex_);
+  --connection_count_;
+}
+
+void TcpServer::Watch(int fd, uint32_t events, uint64_t id, bool add) {
+  epoll_event event{};
+  event.events = events;
+  event.data.u64 = id;
+  if (epoll_ctl(epoll_fd_, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) <
+      0) {
+    ThrowErrno("epoll_ctl");
+  }
+}
+
+void TcpServer::Wake() {
+  const uint64_t one = 1;
+  // Only fails with the counter saturated, when a wake-up is due anyway
+  [[maybe_unused]] const ssize_t written = write(wake_fd_, &one, sizeof(one));
+}
+
+std::string TcpServer::HelpText() const {
+  std::string text = "Available commands:\n";
+  text += "  help - Show this message\n";
+  text += "  quit - Close the connection\n";
+  text += "  stats - Show command timings (stats json: as JSON)\n";
+  for (const auto& cmd : controller_->GetAvailableCommands()) {
+    text += "  " + cmd + "\n";
+  }
+  return text;
+}
+
+std::string TcpServer::Frame(bool success, std::string_view message) {
+  std::string frame = success ? "OK " : "ERR ";
+  frame += std::to_string(message.size());
+  frame += '\n';
+  frame.append(message);
+  frame += '\n';
+  return frame;
+}
+
+size_t TcpServer::Unsent(const Connection& connection) {
+  return connection.output.size() - connection.sent;
+}
+
+}  // namespace presenter
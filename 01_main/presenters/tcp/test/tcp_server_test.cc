@@ -0,0 +1,287 @@
+// Tests for the TCP server presenter
+// Following Google C++ Style Guide
+
+#include "tcp_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "req_response_interface.h"
+
+namespace presenter {
+namespace {
+
+// "sleep <ms>" answers late, "fail" fails, "throw" throws, anything
+// else echoes its words
+class EchoController : public RequestResponseInterface {
+ public:
+  Response HandleRequest(const Request& request) override {
+    if (request.command == "sleep") {
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(std::stoi(request.arguments.at(0))));
+    }
+    if (request.command == "fail") {
+      return {false, "failed"};
+    }
+    if (request.command == "throw") {
+      throw std::runtime_error("boom");
+    }
+    std::string message = request.command;
+    for (const auto& argument : request.arguments) {
+      message += "|" + argument;
+    }
+    return {true, message};
+  }
+
+  std::vector<std::string> GetAvailableCommands() const override {
+    return {"echo - Echo the words"};
+  }
+
+  const CommandMetrics* GetMetrics() const override { return &metrics; }
+
+  CommandMetrics metrics;
+};
+
+// A blocking client that reads whole frames
+class Client {
+ public:
+  explicit Client(uint16_t port) {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    timeval timeout{5, 0};
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd_, reinterpret_cast<sockaddr*>(&address),
+                sizeof(address)) < 0) {
+      throw std::runtime_error("connect failed");
+    }
+  }
+  ~Client() { close(fd_); }
+
+  void Send(const std::string& text) {
+    ASSERT_EQ(send(fd_, text.data(), text.size(), MSG_NOSIGNAL),
+              static_cast<ssize_t>(text.size()));
+  }
+
+  // "OK <message>" or "ERR <message>"; "" once the server closed
+  std::string Receive() {
+    size_t header_end;
+    while ((header_end = buffer_.find('\n')) == std::string::npos) {
+      if (!Fill()) return "";
+    }
+    const std::string header = buffer_.substr(0, header_end);
+    const size_t space = header.find(' ');
+    const size_t length = std::stoul(header.substr(space + 1));
+    while (buffer_.size() < header_end + 1 + length + 1) {
+      if (!Fill()) return "";
+    }
+    std::string result =
+        header.substr(0, space) + " " + buffer_.substr(header_end + 1, length);
+    buffer_.erase(0, header_end + 1 + length + 1);
+    return result;
+  }
+
+  // Stops sending; the server may still answer
+  void ShutdownWrite() { shutdown(fd_, SHUT_WR); }
+
+  // True once the server closed the connection
+  bool Closed() { return buffer_.empty() && !Fill(); }
+
+ private:
+  bool Fill() {
+    char chunk[4096];
+    const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+    if (n <= 0) return false;
+    buffer_.append(chunk, static_cast<size_t>(n));
+    return true;
+  }
+
+  int fd_ = -1;
+  std::string buffer_;
+};
+
+class TcpServerTest : public ::testing::Test {
+ protected:
+  void Start(TcpServerOptions options = {}) {
+    server_ = std::make_unique<TcpServer>(std::make_shared<EchoController>(),
+                                          options);
+    server_->Listen();
+    thread_ = std::thread([this] { server_->Run(); });
+  }
+
+  void TearDown() override {
+    if (server_) {
+      server_->Stop();
+      thread_.join();
+    }
+  }
+
+  std::unique_ptr<TcpServer> server_;
+  std::thread thread_;
+};
+
+TEST_F(TcpServerTest, AnswersRequestsOnAKeptAliveConnection) {
+  Start();
+  Client client(server_->Port());
+
+  client.Send("echo a \"b c\"\n");
+  EXPECT_EQ(client.Receive(), "OK echo|a|b c");
+  client.Send("fail\r\n\n");
+  EXPECT_EQ(client.Receive(), "ERR failed");
+  client.Send("throw\n");
+  EXPECT_EQ(client.Receive(), "ERR Error: boom");
+  client.Send("echo \"open\n");
+  EXPECT_EQ(client.Receive(), "ERR Unterminated quote");
+}
+
+TEST_F(TcpServerTest, AnswersPipelinedRequestsInOrder) {
+  Start();
+  Client client(server_->Port());
+
+  client.Send("sleep 50\necho second\nhelp\necho fourth\n");
+
+  EXPECT_EQ(client.Receive(), "OK sleep|50");
+  EXPECT_EQ(client.Receive(), "OK echo|second");
+  const std::string help = client.Receive();
+  EXPECT_NE(help.find("echo - Echo the words"), std::string::npos) << help;
+  EXPECT_EQ(client.Receive(), "OK echo|fourth");
+}
+
+TEST_F(TcpServerTest, ServesClientsConcurrently) {
+  TcpServerOptions options;
+  options.workers = 4;
+  Start(options);
+
+  std::vector<std::unique_ptr<Client>> clients;
+  for (int i = 0; i < 4; ++i) {
+    clients.push_back(std::make_unique<Client>(server_->Port()));
+  }
+  const auto start = std::chrono::steady_clock::now();
+  for (auto& client : clients) client->Send("sleep 100\n");
+  for (auto& client : clients) EXPECT_EQ(client->Receive(), "OK sleep|100");
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_LT(elapsed, std::chrono::milliseconds(300));
+  EXPECT_EQ(server_->ConnectionCount(), 4u);
+}
+
+TEST_F(TcpServerTest, ExclusiveCommandsRunAlone) {
+  TcpServerOptions options;
+  options.workers = 4;
+  options.exclusive_commands = {"sleep"};
+  Start(options);
+  Client first(server_->Port());
+  Client second(server_->Port());
+
+  const auto start = std::chrono::steady_clock::now();
+  first.Send("sleep 60\n");
+  second.Send("sleep 60\n");
+  EXPECT_EQ(first.Receive(), "OK sleep|60");
+  EXPECT_EQ(second.Receive(), "OK sleep|60");
+
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(120));
+}
+
+TEST_F(TcpServerTest, QuitAnswersEarlierRequestsThenCloses) {
+  Start();
+  Client client(server_->Port());
+
+  client.Send("sleep 30\nquit\necho ignored\n");
+
+  EXPECT_EQ(client.Receive(), "OK sleep|30");
+  EXPECT_TRUE(client.Closed());
+}
+
+TEST_F(TcpServerTest, HalfClosedClientStillGetsItsAnswers) {
+  Start();
+  Client client(server_->Port());
+
+  client.Send("sleep 30\necho two\n");
+  client.ShutdownWrite();
+
+  EXPECT_EQ(client.Receive(), "OK sleep|30");
+  EXPECT_EQ(client.Receive(), "OK echo|two");
+  EXPECT_TRUE(client.Closed());
+}
+
+TEST_F(TcpServerTest, BoundsThePipelineWithoutLosingRequests) {
+  TcpServerOptions options;
+  options.max_pipeline = 2;
+  Start(options);
+  Client client(server_->Port());
+
+  std::string script;
+  for (int i = 0; i < 50; ++i) script += "echo " + std::to_string(i) + "\n";
+  client.Send(script);
+
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_EQ(client.Receive(), "OK echo|" + std::to_string(i));
+  }
+}
+
+TEST_F(TcpServerTest, RejectsAnOverlongLine) {
+  TcpServerOptions options;
+  options.max_line_bytes = 16;
+  Start(options);
+  Client client(server_->Port());
+
+  client.Send(std::string(64, 'x'));
+
+  EXPECT_EQ(client.Receive(), "ERR Request line too long");
+  EXPECT_TRUE(client.Closed());
+}
+
+TEST_F(TcpServerTest, StatsShowsTheControllerMetrics) {
+  Start();
+  Client client(server_->Port());
+
+  client.Send("stats json\n");
+
+  EXPECT_EQ(client.Receive(), "OK {\"commands\":{}}");
+}
+
+TEST_F(TcpServerTest, StopEndsRun) {
+  Start();
+  Client client(server_->Port());
+  client.Send("echo x\n");
+  EXPECT_EQ(client.Receive(), "OK echo|x");
+
+  server_->Stop();
+  thread_.join();
+  server_.reset();
+
+  EXPECT_TRUE(client.Closed());
+}
+
+TEST(TcpServerOptionsTest, RejectsBadArguments) {
+  EXPECT_THROW(TcpServer(nullptr), std::invalid_argument);
+  TcpServerOptions options;
+  options.workers = 0;
+  EXPECT_THROW(TcpServer(std::make_shared<EchoController>(), options),
+               std::invalid_argument);
+  options = {};
+  options.host = "not an address";
+  TcpServer server(std::make_shared<EchoController>(), options);
+  EXPECT_THROW(server.Listen(), std::system_error);
+}
+
+}  // namespace
+}  // namespace presenter
@@ -0,0 +1,69 @@
+#ifndef USE_CASES_BULK_CREATE_ACCOUNTS_H_
+#define USE_CASES_BULK_CREATE_ACCOUNTS_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "create_account.h"
+#include "entities.h"
+#include "executor.h"
+#include "i_account_repository.h"
+#include "i_password_hasher.h"
+
+namespace UseCases {
+
+struct BulkCreateAccountsRequest {
+  std::vector<CreateAccountRequest> accounts;
+};
+
+struct BulkCreateAccountsFailure {
+  size_t index;  // into the request's accounts
+  std::string reason;
+};
+
+struct BulkCreateAccountsResponse {
+  size_t created = 0;
+  std::vector<BulkCreateAccountsFailure> failures;  // by index
+};
+
+struct BulkCreateAccountsOptions {
+  // Accounts per createAccounts() call. Passwords are hashed at most one
+  // window ahead of the insert, which bounds the hashes held in memory.
+  size_t window = 4096;
+  // Executor tasks hashing plaintext passwords at once; 0 is one per
+  // worker
+  size_t hashThreads = 0;
+  // Where they run; nullptr is Concurrency::Executor::shared()
+  Concurrency::Executor* executor = nullptr;
+};
+
+// Imports a batch in a fixed number of repository calls per window: rows
+// are validated and checked for duplicates within the batch in memory,
+// checked against the store as a set in one call, and the rest inserted
+// a window per transaction. Plaintext passwords are hashed on the
+// executor while the previous window is inserted. A rejected row, including
+// one whose password fails to hash, is reported and does not stop the
+// others; within the batch the first row to use an id or name wins.
+// Rows taken by someone else between the check and the insert fail
+// their window's insert, and the repository's exception propagates with
+// the windows before it committed.
+class BulkCreateAccountsInteractor {
+ public:
+  // hasher is only needed for rows with a password, and must outlive the
+  // interactor. Throws std::invalid_argument if options.window is 0.
+  explicit BulkCreateAccountsInteractor(
+      IAccountRepository& repository, IPasswordHasher* hasher = nullptr,
+      const BulkCreateAccountsOptions& options = {});
+
+  BulkCreateAccountsResponse execute(const BulkCreateAccountsRequest& request);
+
+ private:
+  IAccountRepository& m_repository;
+  IPasswordHasher* m_hasher;
+  const BulkCreateAccountsOptions m_options;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_BULK_CREATE_ACCOUNTS_H_
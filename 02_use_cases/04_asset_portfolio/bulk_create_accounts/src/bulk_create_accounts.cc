@@ -0,0 +1,285 @@
+#include "bulk_create_accounts.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+namespace UseCases {
+
+namespace {
+
+struct HashJob {
+  size_t account;  // index into the accounts being created
+  const std::string* password;
+  std::optional<std::vector<uint8_t>> hash;
+  std::string error;  // set if hashing threw
+};
+
+// Hashes jobs in order, but only those the inserter has released, so the
+// hashing runs a bounded distance ahead of it. Up to `tasks` executor
+// tasks take the released jobs one by one and return when none are left;
+// a waiting inserter hashes too, so a busy pool only slows it down.
+// Destruction waits for the tasks still running.
+class HashPipeline {
+ public:
+  HashPipeline(IPasswordHasher& hasher, std::vector<HashJob>& jobs,
+               Concurrency::Executor& executor, size_t tasks)
+      : m_hasher(hasher),
+        m_jobs(jobs),
+        m_executor(executor),
+        m_tasks(std::min(tasks, jobs.size())),
+        m_done(jobs.size(), 0) {}
+
+  ~HashPipeline() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stopping = true;
+    m_idle.wait(lock, [this] { return m_running == 0; });
+  }
+
+  HashPipeline(const HashPipeline&) = delete;
+  HashPipeline& operator=(const HashPipeline&) = delete;
+
+  // Lets jobs before end be hashed, starting tasks for them
+  void release(size_t end) {
+    size_t start = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_end = std::max(m_end, end);
+      const size_t pending = m_end - m_next;
+      if (m_running < m_tasks && pending > m_running) {
+        start = std::min(m_tasks - m_running, pending - m_running);
+        m_running += start;
+      }
+    }
+    for (size_t t = 0; t < start; ++t) {
+      // A task the pool has no room for is left to waitFor()
+      if (!m_executor.tryPost([this] { work(); })) {
+        finishTasks(start - t);
+        break;
+      }
+    }
+  }
+
+  // Blocks until every job before end is hashed, hashing those no task
+  // has taken yet; end must be released
+  void waitFor(size_t end) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_prefix < end) {
+      if (m_next < end) {
+        hashNext(lock);
+      } else {
+        m_finished.wait(lock);
+      }
+    }
+  }
+
+ private:
+  void work() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping && m_next < m_end) {
+      hashNext(lock);
+    }
+    lock.unlock();
+    finishTasks(1);
+  }
+
+  // Hashes m_next without holding the lock
+  void hashNext(std::unique_lock<std::mutex>& lock) {
+    HashJob& job = m_jobs[m_next++];
+    lock.unlock();
+    try {
+      job.hash = m_hasher.hash(*job.password);
+    } catch (const std::exception& e) {
+      job.error = std::string("Password hashing failed: ") + e.what();
+    } catch (...) {
+      job.error = "Password hashing failed";
+    }
+    lock.lock();
+
+    m_done[static_cast<size_t>(&job - m_jobs.data())] = 1;
+    while (m_prefix < m_done.size() && m_done[m_prefix]) {
+      ++m_prefix;
+    }
+    m_finished.notify_all();
+  }
+
+  void finishTasks(size_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running -= count;
+    if (m_running == 0) {
+      m_idle.notify_all();
+    }
+  }
+
+  IPasswordHasher& m_hasher;
+  std::vector<HashJob>& m_jobs;
+  Concurrency::Executor& m_executor;
+  const size_t m_tasks;
+
+  std::mutex m_mutex;
+  std::condition_variable m_finished;
+  std::condition_variable m_idle;
+  size_t m_next = 0;
+  size_t m_end = 0;
+  std::vector<char> m_done;  // jobs finish out of order
+  size_t m_prefix = 0;       // jobs before it are all done
+  size_t m_running = 0;      // tasks started and not yet returned
+  bool m_stopping = false;
+};
+
+}  // namespace
+
+BulkCreateAccountsInteractor::BulkCreateAccountsInteractor(
+    IAccountRepository& repository, IPasswordHasher* hasher,
+    const BulkCreateAccountsOptions& options)
+    : m_repository(repository), m_hasher(hasher), m_options(options) {
+  if (options.window == 0) {
+    throw std::invalid_argument("Bulk create window must be positive");
+  }
+}
+
+BulkCreateAccountsResponse BulkCreateAccountsInteractor::execute(
+    const BulkCreateAccountsRequest& request) {
+  const auto& rows = request.accounts;
+  BulkCreateAccountsResponse response;
+
+  // Views into the request, which outlives them
+  std::unordered_set<std::string_view> ids;
+  std::unordered_set<std::string_view> names;
+  ids.reserve(rows.size());
+  names.reserve(rows.size());
+
+  std::vector<Entities::Account> accounts;
+  std::vector<size_t> indices;  // accounts[i] is rows[indices[i]]
+  accounts.reserve(rows.size());
+  indices.reserve(rows.size());
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const auto& row = rows[i];
+    const char* reason = validateCreateAccountRequest(row, m_hasher);
+    if (!reason && ids.count(row.id) != 0) {
+      reason = "Duplicate account ID in batch";
+    } else if (!reason && names.count(row.name) != 0) {
+      reason = "Duplicate account name in batch";
+    }
+    if (reason) {
+      response.failures.push_back({i, reason});
+      continue;
+    }
+
+    ids.insert(row.id);
+    names.insert(row.name);
+    Entities::Account account;
+    account.id = row.id;
+    account.name = row.name;
+    account.password_hash = row.password_hash;
+    account.created_at = row.created_at;
+    accounts.push_back(std::move(account));
+    indices.push_back(i);
+  }
+
+  if (!accounts.empty()) {
+    const auto conflicts = m_repository.findAccountConflicts(accounts);
+    size_t kept = 0;
+    for (size_t i = 0; i < accounts.size(); ++i) {
+      switch (conflicts[i]) {
+        case Entities::AccountConflict::Id:
+          response.failures.push_back(
+              {indices[i], "Account with this ID already exists"});
+          continue;
+        case Entities::AccountConflict::Name:
+          response.failures.push_back(
+              {indices[i], "Account with this name already exists"});
+          continue;
+        case Entities::AccountConflict::None:
+          break;
+      }
+      if (kept != i) {
+        accounts[kept] = std::move(accounts[i]);
+        indices[kept] = indices[i];
+      }
+      ++kept;
+    }
+    accounts.resize(kept);
+    indices.resize(kept);
+  }
+
+  // Only accounts that can still be created are hashed
+  std::vector<HashJob> jobs;
+  for (size_t i = 0; i < accounts.size(); ++i) {
+    if (rows[indices[i]].password) {
+      jobs.push_back({i, &*rows[indices[i]].password, std::nullopt, {}});
+    }
+  }
+  std::optional<HashPipeline> hashing;
+  if (!jobs.empty()) {
+    Concurrency::Executor& executor = m_options.executor
+                                          ? *m_options.executor
+                                          : Concurrency::Executor::shared();
+    size_t tasks = m_options.hashThreads;
+    if (tasks == 0) {
+      tasks = executor.threadCount();
+    }
+    hashing.emplace(*m_hasher, jobs, executor, tasks);
+  }
+
+  // First job of the window starting at account first
+  auto jobsBefore = [&jobs](size_t first) {
+    return static_cast<size_t>(
+        std::lower_bound(jobs.begin(), jobs.end(), first,
+                         [](const HashJob& job, size_t account) {
+                           return job.account < account;
+                         }) -
+        jobs.begin());
+  };
+
+  const size_t window = m_options.window;
+  if (hashing) {
+    hashing->release(jobsBefore(std::min(window, accounts.size())));
+  }
+  std::vector<Entities::Account> batch;
+  for (size_t first = 0; first < accounts.size(); first += window) {
+    const size_t last = std::min(first + window, accounts.size());
+    const size_t jobBegin = jobsBefore(first);
+    const size_t jobEnd = jobsBefore(last);
+    if (hashing) {
+      hashing->release(jobsBefore(std::min(last + window, accounts.size())));
+      hashing->waitFor(jobEnd);
+    }
+    for (size_t j = jobBegin; j < jobEnd; ++j) {
+      accounts[jobs[j].account].password_hash = std::move(jobs[j].hash);
+    }
+
+    batch.clear();
+    size_t job = jobBegin;
+    for (size_t i = first; i < last; ++i) {
+      if (job < jobEnd && jobs[job].account == i) {
+        if (!jobs[job].error.empty()) {
+          response.failures.push_back(
+              {indices[i], std::move(jobs[job].error)});
+          ++job;
+          continue;
+        }
+        ++job;
+      }
+      batch.push_back(std::move(accounts[i]));
+    }
+
+    if (!batch.empty()) {
+      m_repository.createAccounts(batch);
+      response.created += batch.size();
+    }
+  }
+
+  std::sort(response.failures.begin(), response.failures.end(),
+            [](const auto& a, const auto& b) { return a.index < b.index; });
+  return response;
+}
+
+}  // namespace UseCases
@@ -1,6 +1,7 @@
 #ifndef USE_CASES_I_ACCOUNT_REPOSITORY_H_
 #define USE_CASES_I_ACCOUNT_REPOSITORY_H_
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <vector>
@@ -17,11 +18,26 @@ class IAccountRepository {
 
   // Account operations
   virtual void createAccount(const Entities::Account& account) = 0;
+  // One statement: the insert itself detects a taken id or name, so
+  // there is no window between checking and creating
+  virtual Entities::AccountConflict tryCreateAccount(
+      const Entities::Account& account) = 0;
+  // Bulk import: every account is inserted or none is
+  virtual void createAccounts(
+      const std::vector<Entities::Account>& accounts) = 0;
+  // The stored accounts a batch collides with, checked as a set;
+  // result[i] belongs to accounts[i]
+  virtual std::vector<Entities::AccountConflict> findAccountConflicts(
+      const std::vector<Entities::Account>& accounts) = 0;
   virtual std::optional<Entities::Account> getAccount(
       const std::string& id) = 0;
   virtual std::optional<Entities::Account> getAccountByName(
       const std::string& name) = 0;
   virtual std::vector<Entities::Account> getAllAccounts() = 0;
+  // Keyset pages by name: up to limit accounts named after after_name
+  // (from the first with nullopt); pass the last name back for the next
+  virtual std::vector<Entities::AccountSummary> listAccounts(
+      const std::optional<std::string>& after_name, size_t limit) = 0;
   virtual void updateAccount(const Entities::Account& account) = 0;
   virtual void deleteAccount(const std::string& id) = 0;
 
@@ -44,6 +60,19 @@ class IAccountRepository {
       const std::string& account_id) = 0;
   virtual std::vector<Entities::AccountProperty> getPropertiesByPrefix(
       const std::string& account_id, const std::string& prefix) = 0;
+  // Keyset pages by key, as listAccounts()
+  virtual std::vector<Entities::AccountProperty> listProperties(
+      const std::string& account_id,
+      const std::optional<std::string>& after_key, size_t limit) = 0;
+
+  // One query for all accounts rather than one each; result[i] holds
+  // the properties of account_ids[i], ordered by key
+  virtual std::vector<std::vector<Entities::AccountProperty>>
+  getPropertiesForAccounts(const std::vector<std::string>& account_ids) = 0;
+  // The listAccounts() page with each account's properties, in one query
+  virtual std::vector<Entities::AccountWithProperties>
+  getAccountsWithProperties(const std::optional<std::string>& after_name,
+                            size_t limit) = 0;
 
   virtual bool propertyExists(const std::string& account_id,
                               const std::string& key) = 0;
@@ -0,0 +1,37 @@
+// i_network_data_repository.h
+#ifndef I_NETWORK_DATA_REPOSITORY_H_
+#define I_NETWORK_DATA_REPOSITORY_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+
+namespace UseCases {
+
+class INetworkDataRepository {
+ public:
+  virtual ~INetworkDataRepository() = default;
+
+  // Fetch time series data for an asset from a network source
+  virtual std::vector<Entities::TimeSeriesPoint> fetchTimeSeriesData(
+      const std::string& instrument_id) = 0;
+
+  // Fetches up to max_concurrency instruments at a time and calls
+  // on_result with each as it completes, one call at a time, so handling
+  // overlaps with the fetches still in flight. A failed instrument is
+  // reported through its error and does not stop the others.
+  virtual void fetchMany(
+      const std::vector<std::string>& instrument_ids, size_t max_concurrency,
+      const std::function<void(Entities::InstrumentFetch)>& on_result) = 0;
+  // As above, collected; result[i] belongs to instrument_ids[i]
+  virtual std::vector<Entities::InstrumentFetch> fetchMany(
+      const std::vector<std::string>& instrument_ids,
+      size_t max_concurrency) = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // I_NETWORK_DATA_REPOSITORY_H_
@@ -0,0 +1,23 @@
+#ifndef USE_CASES_I_PASSWORD_HASHER_H_
+#define USE_CASES_I_PASSWORD_HASHER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UseCases {
+
+// Password hashing defined by use cases, so they can take plaintext
+// credentials. Implementations must be safe to call from several threads
+// at once: bulk imports hash on a worker pool.
+class IPasswordHasher {
+ public:
+  virtual ~IPasswordHasher() = default;
+
+  // The stored form of password; throws on failure
+  virtual std::vector<uint8_t> hash(const std::string& password) = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_I_PASSWORD_HASHER_H_
@@ -0,0 +1,31 @@
+#ifndef USE_CASES_I_PRICE_HISTORY_REPOSITORY_H_
+#define USE_CASES_I_PRICE_HISTORY_REPOSITORY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UseCases {
+
+// One series as parallel arrays, ordered by timestamp
+struct PriceHistory {
+  std::vector<int64_t> timestamps;
+  std::vector<double> values;
+};
+
+// The part of the time-series store the correlation use case needs, in
+// the columnar shape of TimeSeriesRepository::getPointColumns().
+// Gateways implement this interface.
+class IPriceHistoryRepository {
+ public:
+  virtual ~IPriceHistoryRepository() = default;
+
+  // Points of the series in [from_ms, to_ms]; empty if it has none
+  virtual PriceHistory getPriceHistory(const std::string& asset_id,
+                                       const std::string& unit_id,
+                                       int64_t from_ms, int64_t to_ms) = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_I_PRICE_HISTORY_REPOSITORY_H_
@@ -0,0 +1,30 @@
+#ifndef USE_CASES_I_PRICE_REPOSITORY_H_
+#define USE_CASES_I_PRICE_REPOSITORY_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+
+namespace UseCases {
+
+// The part of the time-series store the portfolio valuation needs.
+// Gateways implement this interface.
+class IPriceRepository {
+ public:
+  virtual ~IPriceRepository() = default;
+
+  // Newest point of each asset in whatever unit it is quoted in, in one
+  // call; result[i] is for asset_ids[i], nullopt if it has none
+  virtual std::vector<std::optional<Entities::TimeSeriesPoint>>
+  getLatestPoints(const std::vector<std::string>& asset_ids) = 0;
+  // Factor that turns a from_unit_id amount into to_unit_id; 1 for the
+  // same unit, nullopt if the units are not connected
+  virtual std::optional<double> conversionFactor(
+      const std::string& from_unit_id, const std::string& to_unit_id) = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_I_PRICE_REPOSITORY_H_
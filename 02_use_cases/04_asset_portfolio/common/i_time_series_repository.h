@@ -0,0 +1,29 @@
+#ifndef USE_CASES_I_TIME_SERIES_REPOSITORY_H_
+#define USE_CASES_I_TIME_SERIES_REPOSITORY_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+
+namespace UseCases {
+
+// The part of the time-series store the ingest use case needs.
+// Gateways implement this interface.
+class ITimeSeriesRepository {
+ public:
+  virtual ~ITimeSeriesRepository() = default;
+
+  // Newest stored point of the series, nullopt if it has none
+  virtual std::optional<Entities::TimeSeriesPoint> getLatestPoint(
+      const std::string& asset_id, const std::string& unit_id) = 0;
+  // One batch write; a point replaces any other of its series at the
+  // same timestamp
+  virtual void addPoints(
+      const std::vector<Entities::TimeSeriesPoint>& points) = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_I_TIME_SERIES_REPOSITORY_H_
@@ -0,0 +1,81 @@
+#ifndef USE_CASES_SPSC_QUEUE_H_
+#define USE_CASES_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace UseCases {
+
+// Bounded lock-free queue for exactly one producer thread and one
+// consumer thread: a ring of slots with an atomic index per side, so a
+// hand-off is a slot move and one release store, and neither side ever
+// blocks the other. Each side caches the other's index and rereads it
+// only when the ring looks full or empty, and the indices sit on lines
+// of their own, so the two threads do not share a cache line per item.
+template <typename T>
+class SpscQueue {
+ public:
+  // Rounded up to a power of two. Throws std::invalid_argument if 0.
+  explicit SpscQueue(size_t capacity) {
+    if (capacity == 0) {
+      throw std::invalid_argument("SpscQueue capacity must be positive");
+    }
+    size_t slots = 1;
+    while (slots < capacity) slots <<= 1;
+    m_slots.resize(slots);
+    m_mask = slots - 1;
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Producer only. False if the queue is full; item is left as it was.
+  bool tryPush(T& item) {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_headCache == m_slots.size()) {
+      m_headCache = m_head.load(std::memory_order_acquire);
+      if (tail - m_headCache == m_slots.size()) {
+        return false;
+      }
+    }
+    m_slots[tail & m_mask] = std::move(item);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. False if the queue is empty.
+  bool tryPop(T& item) {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tailCache) {
+      m_tailCache = m_tail.load(std::memory_order_acquire);
+      if (head == m_tailCache) {
+        return false;
+      }
+    }
+    item = std::move(m_slots[head & m_mask]);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return m_slots.size(); }
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  std::vector<T> m_slots;
+  size_t m_mask = 0;
+
+  // Consumer side
+  alignas(kCacheLine) std::atomic<size_t> m_head{0};
+  size_t m_tailCache = 0;
+  // Producer side
+  alignas(kCacheLine) std::atomic<size_t> m_tail{0};
+  size_t m_headCache = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_SPSC_QUEUE_H_
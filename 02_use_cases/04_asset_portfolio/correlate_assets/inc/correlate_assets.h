@@ -0,0 +1,75 @@
+#ifndef USE_CASES_CORRELATE_ASSETS_H_
+#define USE_CASES_CORRELATE_ASSETS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "executor.h"
+#include "i_price_history_repository.h"
+#include "series_covariance.h"
+
+namespace UseCases {
+
+class CorrelateAssetsError : public std::runtime_error {
+ public:
+  explicit CorrelateAssetsError(const std::string& msg)
+      : std::runtime_error(msg) {}
+};
+
+struct CorrelateAssetsRequest {
+  std::vector<std::string> asset_ids;
+  std::string unit_id;
+  int64_t from_ms = 0;
+  int64_t to_ms = 0;
+  // Grid spacing: each series is sampled as of from_ms, from_ms +
+  // step_ms, ... up to to_ms
+  int64_t step_ms = 0;
+  Analytics::ReturnMethod returns = Analytics::ReturnMethod::Log;
+};
+
+// Matrices are row-major, in the order of asset_ids
+struct CorrelateAssetsResponse {
+  std::vector<std::string> asset_ids;
+  size_t observations = 0;  // returns behind every entry
+  std::vector<double> means;
+  std::vector<double> covariance;
+  // NaN in the rows and columns of a series with zero variance
+  std::vector<double> correlation;
+};
+
+struct CorrelateAssetsOptions {
+  // Threads on one matrix, the caller's included; 0 is every worker plus
+  // the caller
+  size_t maxParallelism = 0;
+  // Where they run; nullptr is Concurrency::Executor::shared()
+  Concurrency::Executor* executor = nullptr;
+};
+
+// Covariance and correlation of the returns of many assets. Each series
+// is read once, the series are aligned on a fixed grid with as-of fill,
+// and Analytics::covarianceMatrix() computes the returns once and the
+// N x N product in tiles on the executor. Grid times before an asset's
+// first point in range drop out for all assets. For a matrix kept
+// current tick by tick, seed an Analytics::IncrementalCovariance with
+// the same aligned frame instead.
+class CorrelateAssetsInteractor {
+ public:
+  explicit CorrelateAssetsInteractor(
+      IPriceHistoryRepository& repository,
+      const CorrelateAssetsOptions& options = {});
+
+  // Throws CorrelateAssetsError for fewer than two assets, a step_ms
+  // that is not positive, or to_ms before from_ms
+  CorrelateAssetsResponse execute(const CorrelateAssetsRequest& request);
+
+ private:
+  IPriceHistoryRepository& m_repository;
+  const CorrelateAssetsOptions m_options;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_CORRELATE_ASSETS_H_
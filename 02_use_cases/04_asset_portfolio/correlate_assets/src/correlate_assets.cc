@@ -0,0 +1,60 @@
+#include "correlate_assets.h"
+
+#include <utility>
+
+#include "series_align.h"
+
+namespace UseCases {
+
+CorrelateAssetsInteractor::CorrelateAssetsInteractor(
+    IPriceHistoryRepository& repository, const CorrelateAssetsOptions& options)
+    : m_repository(repository), m_options(options) {}
+
+CorrelateAssetsResponse CorrelateAssetsInteractor::execute(
+    const CorrelateAssetsRequest& request) {
+  if (request.asset_ids.size() < 2) {
+    throw CorrelateAssetsError("At least two assets are needed");
+  }
+  if (request.step_ms <= 0) {
+    throw CorrelateAssetsError("Step must be positive");
+  }
+  if (request.to_ms < request.from_ms) {
+    throw CorrelateAssetsError("Time range ends before it starts");
+  }
+
+  std::vector<PriceHistory> histories;
+  histories.reserve(request.asset_ids.size());
+  for (const auto& asset_id : request.asset_ids) {
+    histories.push_back(m_repository.getPriceHistory(
+        asset_id, request.unit_id, request.from_ms, request.to_ms));
+  }
+  std::vector<Analytics::SeriesSpan> series;
+  series.reserve(histories.size());
+  for (const auto& history : histories) {
+    series.emplace_back(history.timestamps, history.values);
+  }
+
+  Analytics::AlignOptions align;
+  align.fill = Analytics::FillMethod::AsOf;
+  align.step_ms = request.step_ms;
+  align.from_ms = request.from_ms;
+  align.to_ms = request.to_ms;
+  const auto frame =
+      Analytics::align(std::as_const(series), align);  // spans, not cursors
+
+  Analytics::CovarianceOptions options;
+  options.returns = request.returns;
+  options.executor = m_options.executor;
+  options.max_parallelism = m_options.maxParallelism;
+  auto matrix = Analytics::covarianceMatrix(frame, options);
+
+  CorrelateAssetsResponse response;
+  response.asset_ids = request.asset_ids;
+  response.observations = matrix.observations;
+  response.correlation = matrix.correlation();
+  response.means = std::move(matrix.means);
+  response.covariance = std::move(matrix.values);
+  return response;
+}
+
+}  // namespace UseCases
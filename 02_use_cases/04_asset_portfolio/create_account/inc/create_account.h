@@ -1,11 +1,15 @@
 #ifndef USE_CASES_CREATE_ACCOUNT_H_
 #define USE_CASES_CREATE_ACCOUNT_H_
 
+#include <cstdint>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "entities.h"
 #include "i_account_repository.h"
+#include "i_password_hasher.h"
 
 namespace UseCases {
 
@@ -20,6 +24,9 @@ struct CreateAccountRequest {
   std::string name;
   std::optional<std::vector<uint8_t>> password_hash;
   int64_t created_at;
+  // Plaintext, hashed by the interactor's hasher; instead of
+  // password_hash
+  std::optional<std::string> password;
 };
 
 struct CreateAccountResponse {
@@ -30,14 +37,23 @@ struct CreateAccountResponse {
 
 class CreateAccountInteractor {
  public:
-  explicit CreateAccountInteractor(IAccountRepository& repository);
+  // hasher is only needed for requests with a password, and must
+  // outlive the interactor
+  explicit CreateAccountInteractor(IAccountRepository& repository,
+                                   IPasswordHasher* hasher = nullptr);
 
   CreateAccountResponse execute(const CreateAccountRequest& request);
 
  private:
   IAccountRepository& m_repository;
+  IPasswordHasher* m_hasher;
 };
 
+// Why a request cannot become an account before the store is asked, or
+// nullptr. Shared by the single and bulk create use cases.
+const char* validateCreateAccountRequest(const CreateAccountRequest& request,
+                                         const IPasswordHasher* hasher);
+
 }  // namespace UseCases
 
 #endif  // USE_CASES_CREATE_ACCOUNT_H_
@@ -1,35 +1,57 @@
 #include "create_account.h"
 
-namespace UseCases {
+#include "tracing.h"
 
-CreateAccountInteractor::CreateAccountInteractor(IAccountRepository& repository)
-    : m_repository(repository) {}
+namespace UseCases {
 
-CreateAccountResponse CreateAccountInteractor::execute(
-    const CreateAccountRequest& request) {
+const char* validateCreateAccountRequest(const CreateAccountRequest& request,
+                                         const IPasswordHasher* hasher) {
   if (request.id.empty()) {
-    throw CreateAccountError("Account ID cannot be empty");
+    return "Account ID cannot be empty";
   }
-
   if (request.name.empty()) {
-    throw CreateAccountError("Account name cannot be empty");
+    return "Account name cannot be empty";
   }
-
-  if (m_repository.accountExists(request.id)) {
-    throw CreateAccountError("Account with this ID already exists");
+  if (request.password) {
+    if (request.password_hash) {
+      return "Give a password or a password hash, not both";
+    }
+    if (!hasher) {
+      return "No password hasher configured";
+    }
   }
+  return nullptr;
+}
+
+CreateAccountInteractor::CreateAccountInteractor(IAccountRepository& repository,
+                                                 IPasswordHasher* hasher)
+    : m_repository(repository), m_hasher(hasher) {}
 
-  if (m_repository.accountExistsByName(request.name)) {
-    throw CreateAccountError("Account with this name already exists");
+CreateAccountResponse CreateAccountInteractor::execute(
+    const CreateAccountRequest& request) {
+  TRACE_SPAN("use_case", "CreateAccountInteractor::execute");
+  if (const char* reason = validateCreateAccountRequest(request, m_hasher)) {
+    throw CreateAccountError(reason);
   }
 
   Entities::Account account;
   account.id = request.id;
   account.name = request.name;
-  account.password_hash = request.password_hash;
+  account.password_hash = request.password
+                              ? m_hasher->hash(*request.password)
+                              : request.password_hash;
   account.created_at = request.created_at;
 
-  m_repository.createAccount(account);
+  // The repository's constraints decide, so concurrent creates cannot
+  // both pass a check
+  switch (m_repository.tryCreateAccount(account)) {
+    case Entities::AccountConflict::Id:
+      throw CreateAccountError("Account with this ID already exists");
+    case Entities::AccountConflict::Name:
+      throw CreateAccountError("Account with this name already exists");
+    case Entities::AccountConflict::None:
+      break;
+  }
 
   return CreateAccountResponse{
       .id = account.id,
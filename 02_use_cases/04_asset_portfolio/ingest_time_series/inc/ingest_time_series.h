@@ -0,0 +1,74 @@
+#ifndef USE_CASES_INGEST_TIME_SERIES_H_
+#define USE_CASES_INGEST_TIME_SERIES_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+#include "i_network_data_repository.h"
+#include "i_time_series_repository.h"
+
+namespace UseCases {
+
+struct IngestTimeSeriesRequest {
+  std::vector<std::string> instrument_ids;  // asset ids; repeats ignored
+  // Unit the fetched points are stored under
+  std::string unit_id;
+};
+
+struct IngestTimeSeriesResult {
+  std::string instrument_id;
+  size_t fetched = 0;  // points the source returned
+  size_t written = 0;  // of those, newer than the stored series
+  std::optional<std::string> error;  // the fetch failed; nothing written
+};
+
+struct IngestTimeSeriesResponse {
+  // One per distinct instrument, in request order
+  std::vector<IngestTimeSeriesResult> instruments;
+  size_t written = 0;
+};
+
+struct IngestTimeSeriesOptions {
+  // Instruments fetched at once
+  size_t fetchConcurrency = 4;
+  // Items each queue between stages holds before its producer blocks
+  size_t queueDepth = 16;
+  // Points per addPoints() call; new points of several instruments share
+  // a batch
+  size_t batchPoints = 10000;
+};
+
+// Incremental ingest from a network source into the time-series store.
+// The newest stored timestamp of every series (its watermark) is read
+// up front; then three stages run at once, joined by bounded queues:
+// fetching on the network repository's workers, filtering each series
+// to the points past its watermark on a thread of its own, and writing
+// the batches on the calling thread. A series with nothing new is not
+// written at all, and every written point is past its series' newest,
+// which is what the store's append path takes. The store is only used
+// from the calling thread.
+//
+// A failed fetch is reported in its result and does not stop the
+// others. If a write throws, the other stages are stopped and the
+// exception propagates, with the batches before it written.
+class IngestTimeSeriesInteractor {
+ public:
+  // Throws std::invalid_argument if an option is 0
+  IngestTimeSeriesInteractor(INetworkDataRepository& network,
+                             ITimeSeriesRepository& timeSeries,
+                             const IngestTimeSeriesOptions& options = {});
+
+  IngestTimeSeriesResponse execute(const IngestTimeSeriesRequest& request);
+
+ private:
+  INetworkDataRepository& m_network;
+  ITimeSeriesRepository& m_timeSeries;
+  const IngestTimeSeriesOptions m_options;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_INGEST_TIME_SERIES_H_
@@ -0,0 +1,208 @@
+#include "ingest_time_series.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace UseCases {
+
+namespace {
+
+// Hand-off between two stages. push() blocks while the queue is full, so
+// a stage can run at most capacity items ahead of the next one.
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity) : m_capacity(capacity) {}
+
+  // False once the queue is cancelled; the item is dropped
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [&] {
+      return m_cancelled || m_items.size() < m_capacity;
+    });
+    if (m_cancelled) {
+      return false;
+    }
+    m_items.push_back(std::move(item));
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  // nullopt once the queue is closed and drained, or cancelled
+  std::optional<T> pop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [&] {
+      return m_cancelled || m_closed || !m_items.empty();
+    });
+    if (m_cancelled || m_items.empty()) {
+      return std::nullopt;
+    }
+    T item = std::move(m_items.front());
+    m_items.pop_front();
+    m_notFull.notify_one();
+    return item;
+  }
+
+  // The producer is done
+  void close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_notEmpty.notify_all();
+  }
+
+  // The consumer gave up: drops the items and wakes both sides
+  void cancel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cancelled = true;
+    m_items.clear();
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+  }
+
+ private:
+  const size_t m_capacity;
+  std::mutex m_mutex;
+  std::condition_variable m_notFull;
+  std::condition_variable m_notEmpty;
+  std::deque<T> m_items;
+  bool m_closed = false;
+  bool m_cancelled = false;
+};
+
+// Thrown from the fetch callback to stop fetchMany() once the filter
+// stage is gone
+struct StageCancelled {};
+
+}  // namespace
+
+IngestTimeSeriesInteractor::IngestTimeSeriesInteractor(
+    INetworkDataRepository& network, ITimeSeriesRepository& timeSeries,
+    const IngestTimeSeriesOptions& options)
+    : m_network(network), m_timeSeries(timeSeries), m_options(options) {
+  if (options.fetchConcurrency == 0 || options.queueDepth == 0 ||
+      options.batchPoints == 0) {
+    throw std::invalid_argument("Ingest options must be positive");
+  }
+}
+
+IngestTimeSeriesResponse IngestTimeSeriesInteractor::execute(
+    const IngestTimeSeriesRequest& request) {
+  IngestTimeSeriesResponse response;
+  std::vector<std::string> ids;
+  // Views into ids' strings, which are not moved once reserved
+  std::unordered_map<std::string_view, size_t> slots;
+  ids.reserve(request.instrument_ids.size());
+  for (const auto& id : request.instrument_ids) {
+    if (slots.count(id) == 0) {
+      ids.push_back(id);
+      slots.emplace(ids.back(), ids.size() - 1);
+    }
+  }
+  if (ids.empty()) {
+    return response;
+  }
+
+  response.instruments.resize(ids.size());
+  std::vector<std::optional<int64_t>> watermarks(ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    response.instruments[i].instrument_id = ids[i];
+    auto latest = m_timeSeries.getLatestPoint(ids[i], request.unit_id);
+    if (latest) {
+      watermarks[i] = latest->timestamp_ms;
+    }
+  }
+
+  BoundedQueue<Entities::InstrumentFetch> fetched(m_options.queueDepth);
+  BoundedQueue<std::vector<Entities::TimeSeriesPoint>> batches(
+      m_options.queueDepth);
+  std::exception_ptr fetchError;
+  std::exception_ptr filterError;
+
+  std::thread fetcher([&] {
+    try {
+      m_network.fetchMany(ids, m_options.fetchConcurrency,
+                          [&](Entities::InstrumentFetch fetch) {
+                            if (!fetched.push(std::move(fetch))) {
+                              throw StageCancelled{};
+                            }
+                          });
+    } catch (const StageCancelled&) {
+    } catch (...) {
+      fetchError = std::current_exception();
+    }
+    fetched.close();
+  });
+
+  // Results are only written here until the thread is joined
+  std::thread filter([&] {
+    try {
+      std::vector<Entities::TimeSeriesPoint> batch;
+      while (auto fetch = fetched.pop()) {
+        auto slot = slots.find(fetch->instrument_id);
+        if (slot == slots.end()) {
+          continue;  // not asked for
+        }
+        auto& result = response.instruments[slot->second];
+        if (fetch->error) {
+          result.error = std::move(fetch->error);
+          continue;
+        }
+        const auto& watermark = watermarks[slot->second];
+        result.fetched = fetch->points.size();
+        for (auto& point : fetch->points) {
+          if (watermark && point.timestamp_ms <= *watermark) {
+            continue;
+          }
+          point.unit_id = request.unit_id;
+          batch.push_back(std::move(point));
+          ++result.written;
+          if (batch.size() == m_options.batchPoints) {
+            if (!batches.push(std::move(batch))) {
+              fetched.cancel();
+              return;
+            }
+            batch.clear();
+          }
+        }
+      }
+      if (!batch.empty()) {
+        batches.push(std::move(batch));
+      }
+    } catch (...) {
+      filterError = std::current_exception();
+      fetched.cancel();
+    }
+    batches.close();
+  });
+
+  std::exception_ptr writeError;
+  try {
+    while (auto batch = batches.pop()) {
+      m_timeSeries.addPoints(*batch);
+      response.written += batch->size();
+    }
+  } catch (...) {
+    writeError = std::current_exception();
+    batches.cancel();
+    fetched.cancel();
+  }
+
+  filter.join();
+  fetcher.join();
+  for (const auto& error : {writeError, filterError, fetchError}) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return response;
+}
+
+}  // namespace UseCases
@@ -0,0 +1,78 @@
+#ifndef USE_CASES_STREAM_TIME_SERIES_H_
+#define USE_CASES_STREAM_TIME_SERIES_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+#include "i_quote_stream.h"
+#include "i_time_series_repository.h"
+
+namespace UseCases {
+
+struct StreamTimeSeriesRequest {
+  std::vector<std::string> instrument_ids;  // asset ids; repeats ignored
+  // Unit the ticks are stored under
+  std::string unit_id;
+};
+
+struct StreamTimeSeriesResponse {
+  size_t received = 0;  // ticks the stream delivered
+  size_t written = 0;
+  // At or before their series' newest point, e.g. repeated after a
+  // reconnect, or of an instrument not asked for; not written
+  size_t stale = 0;
+  // Longest time from a tick's arrival to its batch being written
+  std::chrono::microseconds maxDelay{0};
+};
+
+struct StreamTimeSeriesOptions {
+  // Ticks the stream may run ahead of the writer before it waits
+  size_t queueDepth = 4096;
+  // Points per addPoints() call at most
+  size_t batchPoints = 1000;
+  // A batch is written once its first tick is this old, full or not
+  std::chrono::milliseconds flushInterval{10};
+};
+
+// Live ingest from a push source into the time-series store: the
+// streaming counterpart of IngestTimeSeriesInteractor. Watermarks are
+// read up front; then the stream runs on a thread of its own and hands
+// each tick through a lock-free queue to the calling thread, which
+// drops ticks at or before their series' watermark and writes the rest
+// in batches. A batch goes out when full or flushInterval after its
+// first tick, so with the defaults a tick reaches the store within
+// about 10 ms plus the write, well under the 50 ms a live view needs.
+// The store is only used from the calling thread.
+//
+// If a write throws, the stream is stopped and the exception
+// propagates; if the stream throws, the ticks before it are written
+// first.
+class StreamTimeSeriesInteractor {
+ public:
+  // Throws std::invalid_argument if queueDepth or batchPoints is 0 or
+  // flushInterval is negative
+  StreamTimeSeriesInteractor(IQuoteStream& stream,
+                             ITimeSeriesRepository& timeSeries,
+                             const StreamTimeSeriesOptions& options = {});
+
+  // Blocks until the stream ends or stop() is called
+  StreamTimeSeriesResponse execute(const StreamTimeSeriesRequest& request);
+
+  // Ends execute() once the ticks received so far are written, and any
+  // later call at once; callable from any thread
+  void stop();
+
+ private:
+  IQuoteStream& m_stream;
+  ITimeSeriesRepository& m_timeSeries;
+  const StreamTimeSeriesOptions m_options;
+  std::atomic<bool> m_stopping{false};
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_STREAM_TIME_SERIES_H_
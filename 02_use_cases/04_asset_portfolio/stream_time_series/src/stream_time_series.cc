@@ -0,0 +1,149 @@
+#include "stream_time_series.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "spsc_queue.h"
+
+namespace UseCases {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Tick {
+  Entities::TimeSeriesPoint point;
+  Clock::time_point arrived;
+};
+
+// How long a side with nothing to do sleeps before looking again: short
+// against the flush interval, long enough not to burn a core
+constexpr auto kIdlePoll = std::chrono::microseconds(200);
+
+}  // namespace
+
+StreamTimeSeriesInteractor::StreamTimeSeriesInteractor(
+    IQuoteStream& stream, ITimeSeriesRepository& timeSeries,
+    const StreamTimeSeriesOptions& options)
+    : m_stream(stream), m_timeSeries(timeSeries), m_options(options) {
+  if (options.queueDepth == 0 || options.batchPoints == 0) {
+    throw std::invalid_argument(
+        "queueDepth and batchPoints must be positive");
+  }
+  if (options.flushInterval.count() < 0) {
+    throw std::invalid_argument("flushInterval must not be negative");
+  }
+}
+
+StreamTimeSeriesResponse StreamTimeSeriesInteractor::execute(
+    const StreamTimeSeriesRequest& request) {
+  // Watermarks up front, on this thread like every other store call
+  std::vector<std::string> instrumentIds;
+  std::unordered_map<std::string, int64_t> watermarks;
+  for (const auto& id : request.instrument_ids) {
+    if (watermarks.count(id) != 0) continue;
+    auto latest = m_timeSeries.getLatestPoint(id, request.unit_id);
+    watermarks[id] = latest ? latest->timestamp_ms
+                            : std::numeric_limits<int64_t>::min();
+    instrumentIds.push_back(id);
+  }
+
+  SpscQueue<Tick> queue(m_options.queueDepth);
+  std::atomic<bool> streamDone{false};
+  std::atomic<bool> writerFailed{false};
+  std::exception_ptr streamError;
+
+  std::thread streamer([&] {
+    try {
+      if (!m_stopping) {
+        m_stream.stream(instrumentIds, [&](Entities::TimeSeriesPoint point) {
+          Tick tick{std::move(point), Clock::now()};
+          // A full queue holds the stream back rather than drop ticks
+          while (!queue.tryPush(tick)) {
+            if (m_stopping || writerFailed) return false;
+            std::this_thread::sleep_for(kIdlePoll);
+          }
+          return !m_stopping;
+        });
+      }
+    } catch (...) {
+      streamError = std::current_exception();
+    }
+    streamDone.store(true, std::memory_order_release);
+  });
+
+  StreamTimeSeriesResponse response;
+  std::vector<Entities::TimeSeriesPoint> batch;
+  batch.reserve(m_options.batchPoints);
+  Clock::time_point batchStarted;  // arrival of its first tick
+  auto flush = [&] {
+    if (batch.empty()) return;
+    m_timeSeries.addPoints(batch);
+    const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - batchStarted);
+    response.maxDelay = std::max(response.maxDelay, delay);
+    response.written += batch.size();
+    batch.clear();
+  };
+
+  try {
+    for (;;) {
+      // Read before draining: every tick pushed before the stream ended
+      // is then seen by this pass
+      const bool done = streamDone.load(std::memory_order_acquire);
+      bool drained = true;
+      Tick tick;
+      while (batch.size() < m_options.batchPoints && queue.tryPop(tick)) {
+        drained = false;
+        ++response.received;
+        auto watermark = watermarks.find(tick.point.asset_id);
+        if (watermark == watermarks.end() ||
+            tick.point.timestamp_ms <= watermark->second) {
+          ++response.stale;
+          continue;
+        }
+        watermark->second = tick.point.timestamp_ms;
+        tick.point.unit_id = request.unit_id;
+        if (batch.empty()) batchStarted = tick.arrived;
+        batch.push_back(std::move(tick.point));
+      }
+
+      if (batch.size() >= m_options.batchPoints ||
+          (!batch.empty() &&
+           Clock::now() - batchStarted >= m_options.flushInterval)) {
+        flush();
+      }
+      if (done && drained) {
+        flush();
+        break;
+      }
+      if (drained) {
+        std::this_thread::sleep_for(kIdlePoll);
+      }
+    }
+  } catch (...) {
+    writerFailed = true;
+    m_stream.stop();
+    streamer.join();
+    throw;
+  }
+
+  streamer.join();
+  if (streamError) {
+    std::rethrow_exception(streamError);
+  }
+  return response;
+}
+
+void StreamTimeSeriesInteractor::stop() {
+  m_stopping = true;
+  m_stream.stop();
+}
+
+}  // namespace UseCases
@@ -0,0 +1,276 @@
+#include "bulk_create_accounts.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+#include "mock_account_repository.h"
+
+namespace UseCases {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+// Stores the password's bytes; safe across threads
+class FakeHasher : public IPasswordHasher {
+ public:
+  std::vector<uint8_t> hash(const std::string& password) override {
+    ++calls;
+    if (password == "bad") {
+      throw std::runtime_error("weak password");
+    }
+    return std::vector<uint8_t>(password.begin(), password.end());
+  }
+
+  std::atomic<int> calls{0};
+};
+
+class BulkCreateAccountsInteractorTest : public ::testing::Test {
+ protected:
+  static CreateAccountRequest row(const std::string& id,
+                                  const std::string& name) {
+    CreateAccountRequest request;
+    request.id = id;
+    request.name = name;
+    request.created_at = 1704067200000;
+    return request;
+  }
+
+  MockAccountRepository mockRepo_;
+  BulkCreateAccountsInteractor interactor_{mockRepo_};
+};
+
+// ============================================================
+// Success Cases
+// ============================================================
+
+TEST_F(BulkCreateAccountsInteractorTest, CreatesBatchInTwoCalls) {
+  BulkCreateAccountsRequest request{{row("a1", "Alice"), row("a2", "Bob")}};
+  std::vector<Entities::Account> inserted;
+
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_)).Times(0);
+  EXPECT_CALL(mockRepo_, accountExists(_)).Times(0);
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce(Return(std::vector<Entities::AccountConflict>(
+          2, Entities::AccountConflict::None)));
+  EXPECT_CALL(mockRepo_, createAccounts(_)).WillOnce(SaveArg<0>(&inserted));
+
+  auto response = interactor_.execute(request);
+
+  EXPECT_EQ(response.created, 2u);
+  EXPECT_TRUE(response.failures.empty());
+  ASSERT_EQ(inserted.size(), 2u);
+  EXPECT_EQ(inserted[0].id, "a1");
+  EXPECT_EQ(inserted[1].name, "Bob");
+  EXPECT_EQ(inserted[1].created_at, 1704067200000);
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, EmptyBatchSkipsRepository) {
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_)).Times(0);
+  EXPECT_CALL(mockRepo_, createAccounts(_)).Times(0);
+
+  auto response = interactor_.execute({});
+
+  EXPECT_EQ(response.created, 0u);
+  EXPECT_TRUE(response.failures.empty());
+}
+
+// ============================================================
+// Per-row Failures
+// ============================================================
+
+TEST_F(BulkCreateAccountsInteractorTest, InvalidRowsFailInMemory) {
+  BulkCreateAccountsRequest request{
+      {row("", "Alice"), row("a2", ""), row("a3", "Carol")}};
+  std::vector<Entities::Account> checked;
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce([&checked](const std::vector<Entities::Account>& accounts) {
+        checked = accounts;
+        return std::vector<Entities::AccountConflict>(
+            accounts.size(), Entities::AccountConflict::None);
+      });
+  EXPECT_CALL(mockRepo_, createAccounts(_)).Times(1);
+
+  auto response = interactor_.execute(request);
+
+  EXPECT_EQ(response.created, 1u);
+  ASSERT_EQ(checked.size(), 1u);
+  EXPECT_EQ(checked[0].id, "a3");
+  ASSERT_EQ(response.failures.size(), 2u);
+  EXPECT_EQ(response.failures[0].index, 0u);
+  EXPECT_EQ(response.failures[0].reason, "Account ID cannot be empty");
+  EXPECT_EQ(response.failures[1].index, 1u);
+  EXPECT_EQ(response.failures[1].reason, "Account name cannot be empty");
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, FirstRowWinsWithinBatch) {
+  BulkCreateAccountsRequest request{
+      {row("a1", "Alice"), row("a1", "Bob"), row("a2", "Alice")}};
+  std::vector<Entities::Account> inserted;
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce(Return(std::vector<Entities::AccountConflict>(
+          1, Entities::AccountConflict::None)));
+  EXPECT_CALL(mockRepo_, createAccounts(_)).WillOnce(SaveArg<0>(&inserted));
+
+  auto response = interactor_.execute(request);
+
+  EXPECT_EQ(response.created, 1u);
+  ASSERT_EQ(inserted.size(), 1u);
+  EXPECT_EQ(inserted[0].name, "Alice");
+  ASSERT_EQ(response.failures.size(), 2u);
+  EXPECT_EQ(response.failures[0].reason, "Duplicate account ID in batch");
+  EXPECT_EQ(response.failures[1].reason, "Duplicate account name in batch");
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, StoredConflictsAreReportedByRow) {
+  BulkCreateAccountsRequest request{
+      {row("", "Nobody"), row("a1", "Alice"), row("a2", "Bob"),
+       row("a3", "Carol")}};
+  std::vector<Entities::Account> inserted;
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce(Return(std::vector<Entities::AccountConflict>{
+          Entities::AccountConflict::Id, Entities::AccountConflict::None,
+          Entities::AccountConflict::Name}));
+  EXPECT_CALL(mockRepo_, createAccounts(_)).WillOnce(SaveArg<0>(&inserted));
+
+  auto response = interactor_.execute(request);
+
+  EXPECT_EQ(response.created, 1u);
+  ASSERT_EQ(inserted.size(), 1u);
+  EXPECT_EQ(inserted[0].id, "a2");
+  ASSERT_EQ(response.failures.size(), 3u);
+  EXPECT_EQ(response.failures[0].index, 0u);
+  EXPECT_EQ(response.failures[1].index, 1u);
+  EXPECT_EQ(response.failures[1].reason, "Account with this ID already exists");
+  EXPECT_EQ(response.failures[2].index, 3u);
+  EXPECT_EQ(response.failures[2].reason,
+            "Account with this name already exists");
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, AllRowsRejectedSkipsInsert) {
+  BulkCreateAccountsRequest request{{row("a1", "Alice")}};
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce(Return(std::vector<Entities::AccountConflict>{
+          Entities::AccountConflict::Id}));
+  EXPECT_CALL(mockRepo_, createAccounts(_)).Times(0);
+
+  auto response = interactor_.execute(request);
+
+  EXPECT_EQ(response.created, 0u);
+  ASSERT_EQ(response.failures.size(), 1u);
+}
+
+// ============================================================
+// Password Hashing
+// ============================================================
+
+TEST_F(BulkCreateAccountsInteractorTest, HashesPasswordsAcrossWindows) {
+  FakeHasher hasher;
+  BulkCreateAccountsOptions options;
+  options.window = 2;
+  options.hashThreads = 3;
+  BulkCreateAccountsInteractor interactor(mockRepo_, &hasher, options);
+  BulkCreateAccountsRequest request;
+  for (int i = 0; i < 5; ++i) {
+    auto r = row("a" + std::to_string(i), "n" + std::to_string(i));
+    r.password = "pw" + std::to_string(i);
+    request.accounts.push_back(r);
+  }
+  request.accounts[1].password.reset();
+  request.accounts[1].password_hash = std::vector<uint8_t>{7};
+  std::vector<Entities::Account> inserted;
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce(Return(std::vector<Entities::AccountConflict>(
+          5, Entities::AccountConflict::None)));
+  EXPECT_CALL(mockRepo_, createAccounts(_))
+      .Times(3)
+      .WillRepeatedly([&inserted](const std::vector<Entities::Account>& a) {
+        inserted.insert(inserted.end(), a.begin(), a.end());
+      });
+
+  auto response = interactor.execute(request);
+
+  EXPECT_EQ(response.created, 5u);
+  EXPECT_EQ(hasher.calls, 4);
+  ASSERT_EQ(inserted.size(), 5u);
+  EXPECT_EQ(inserted[1].password_hash, (std::vector<uint8_t>{7}));
+  for (size_t i : {0u, 2u, 3u, 4u}) {
+    const std::string password = "pw" + std::to_string(i);
+    EXPECT_EQ(inserted[i].id, "a" + std::to_string(i));
+    EXPECT_EQ(inserted[i].password_hash,
+              std::vector<uint8_t>(password.begin(), password.end()));
+  }
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, HashFailuresAreReportedByRow) {
+  FakeHasher hasher;
+  BulkCreateAccountsInteractor interactor(mockRepo_, &hasher);
+  auto good = row("a1", "Alice");
+  good.password = "secret";
+  auto bad = row("a2", "Bob");
+  bad.password = "bad";
+  std::vector<Entities::Account> inserted;
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce(Return(std::vector<Entities::AccountConflict>(
+          2, Entities::AccountConflict::None)));
+  EXPECT_CALL(mockRepo_, createAccounts(_)).WillOnce(SaveArg<0>(&inserted));
+
+  auto response = interactor.execute({{good, bad}});
+
+  EXPECT_EQ(response.created, 1u);
+  ASSERT_EQ(inserted.size(), 1u);
+  EXPECT_EQ(inserted[0].id, "a1");
+  ASSERT_EQ(response.failures.size(), 1u);
+  EXPECT_EQ(response.failures[0].index, 1u);
+  EXPECT_EQ(response.failures[0].reason,
+            "Password hashing failed: weak password");
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, ConflictingRowsAreNotHashed) {
+  FakeHasher hasher;
+  BulkCreateAccountsInteractor interactor(mockRepo_, &hasher);
+  auto taken = row("a1", "Alice");
+  taken.password = "secret";
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_))
+      .WillOnce(Return(std::vector<Entities::AccountConflict>{
+          Entities::AccountConflict::Id}));
+  EXPECT_CALL(mockRepo_, createAccounts(_)).Times(0);
+
+  auto response = interactor.execute({{taken}});
+
+  EXPECT_EQ(response.created, 0u);
+  EXPECT_EQ(hasher.calls, 0);
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, PasswordWithoutHasherFails) {
+  auto r = row("a1", "Alice");
+  r.password = "secret";
+
+  EXPECT_CALL(mockRepo_, findAccountConflicts(_)).Times(0);
+
+  auto response = interactor_.execute({{r}});
+
+  ASSERT_EQ(response.failures.size(), 1u);
+  EXPECT_EQ(response.failures[0].reason, "No password hasher configured");
+}
+
+TEST_F(BulkCreateAccountsInteractorTest, ZeroWindowThrows) {
+  BulkCreateAccountsOptions options;
+  options.window = 0;
+  EXPECT_THROW(BulkCreateAccountsInteractor(mockRepo_, nullptr, options),
+               std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace UseCases
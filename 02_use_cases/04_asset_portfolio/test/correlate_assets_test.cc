@@ -0,0 +1,148 @@
+#include "correlate_assets.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "series_stats.h"
+
+namespace UseCases {
+namespace {
+
+// Histories from a map, recording each read
+class FakePriceHistoryRepository : public IPriceHistoryRepository {
+ public:
+  struct Read {
+    std::string asset_id;
+    std::string unit_id;
+    int64_t from_ms;
+    int64_t to_ms;
+  };
+
+  PriceHistory getPriceHistory(const std::string& asset_id,
+                               const std::string& unit_id, int64_t from_ms,
+                               int64_t to_ms) override {
+    reads.push_back({asset_id, unit_id, from_ms, to_ms});
+    auto it = histories.find(asset_id);
+    return it == histories.end() ? PriceHistory{} : it->second;
+  }
+
+  std::map<std::string, PriceHistory> histories;
+  std::vector<Read> reads;
+};
+
+class CorrelateAssetsInteractorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // On the 10 ms grid up to 30: A is 100, 110, 99, 99 and B, quoted
+    // off the grid, 10, 10, 10.5, 11.55
+    repo_.histories["A"] = {{0, 10, 20, 30}, {100.0, 110.0, 99.0, 99.0}};
+    repo_.histories["B"] = {{0, 15, 30}, {10.0, 10.5, 11.55}};
+  }
+
+  CorrelateAssetsRequest request() {
+    CorrelateAssetsRequest request;
+    request.asset_ids = {"A", "B"};
+    request.unit_id = "USD";
+    request.from_ms = 0;
+    request.to_ms = 30;
+    request.step_ms = 10;
+    request.returns = Analytics::ReturnMethod::Simple;
+    return request;
+  }
+
+  FakePriceHistoryRepository repo_;
+  CorrelateAssetsInteractor interactor_{repo_};
+};
+
+// ============================================================
+// Matrices
+// ============================================================
+TEST_F(CorrelateAssetsInteractorTest, CovarianceOfAlignedReturns) {
+  auto response = interactor_.execute(request());
+
+  const std::vector<double> a = {0.1, -0.1, 0.0};
+  const std::vector<double> b = {0.0, 0.05, 0.1};
+  EXPECT_EQ(response.asset_ids, (std::vector<std::string>{"A", "B"}));
+  EXPECT_EQ(response.observations, 3u);
+  ASSERT_EQ(response.covariance.size(), 4u);
+  EXPECT_NEAR(response.covariance[0], Analytics::variance(a), 1e-12);
+  EXPECT_NEAR(response.covariance[1], Analytics::covariance(a, b), 1e-12);
+  EXPECT_NEAR(response.covariance[2], Analytics::covariance(a, b), 1e-12);
+  EXPECT_NEAR(response.covariance[3], Analytics::variance(b), 1e-12);
+  EXPECT_NEAR(response.means[1], Analytics::mean(b), 1e-12);
+  EXPECT_DOUBLE_EQ(response.correlation[0], 1.0);
+  EXPECT_NEAR(response.correlation[1],
+              Analytics::covariance(a, b) /
+                  std::sqrt(Analytics::variance(a) * Analytics::variance(b)),
+              1e-12);
+}
+
+TEST_F(CorrelateAssetsInteractorTest, ReadsEachSeriesOnceOverTheRange) {
+  interactor_.execute(request());
+
+  ASSERT_EQ(repo_.reads.size(), 2u);
+  EXPECT_EQ(repo_.reads[0].asset_id, "A");
+  EXPECT_EQ(repo_.reads[1].asset_id, "B");
+  EXPECT_EQ(repo_.reads[1].unit_id, "USD");
+  EXPECT_EQ(repo_.reads[1].from_ms, 0);
+  EXPECT_EQ(repo_.reads[1].to_ms, 30);
+}
+
+TEST_F(CorrelateAssetsInteractorTest, LateStartDropsEarlierGridTimes) {
+  repo_.histories["B"] = {{15, 30}, {10.5, 11.55}};
+
+  auto response = interactor_.execute(request());
+
+  // Grid times 20 and 30 only: one return each
+  EXPECT_EQ(response.observations, 1u);
+  EXPECT_NEAR(response.means[0], 0.0, 1e-12);
+  EXPECT_NEAR(response.means[1], 0.1, 1e-12);
+}
+
+TEST_F(CorrelateAssetsInteractorTest, AssetWithoutPricesLeavesNoReturns) {
+  auto req = request();
+  req.asset_ids.push_back("UNKNOWN");
+
+  auto response = interactor_.execute(req);
+
+  EXPECT_EQ(response.observations, 0u);
+  EXPECT_EQ(response.covariance, std::vector<double>(9, 0.0));
+  EXPECT_TRUE(std::isnan(response.correlation[0]));
+}
+
+TEST_F(CorrelateAssetsInteractorTest, RunsOnTheGivenExecutor) {
+  Concurrency::Executor executor(Concurrency::ExecutorOptions{2, 16});
+  CorrelateAssetsOptions options;
+  options.executor = &executor;
+  options.maxParallelism = 2;
+  CorrelateAssetsInteractor interactor(repo_, options);
+
+  EXPECT_EQ(interactor.execute(request()).covariance,
+            interactor_.execute(request()).covariance);
+}
+
+// ============================================================
+// Failure Cases
+// ============================================================
+TEST_F(CorrelateAssetsInteractorTest, RejectsBadRequests) {
+  auto one = request();
+  one.asset_ids = {"A"};
+  EXPECT_THROW(interactor_.execute(one), CorrelateAssetsError);
+
+  auto no_step = request();
+  no_step.step_ms = 0;
+  EXPECT_THROW(interactor_.execute(no_step), CorrelateAssetsError);
+
+  auto backwards = request();
+  backwards.from_ms = 40;
+  EXPECT_THROW(interactor_.execute(backwards), CorrelateAssetsError);
+
+  EXPECT_TRUE(repo_.reads.empty());
+}
+
+}  // namespace
+}  // namespace UseCases
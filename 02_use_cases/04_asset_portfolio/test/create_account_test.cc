@@ -3,7 +3,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
-#include "i_account_repository.h"
+#include "mock_account_repository.h"
 
 namespace UseCases {
 namespace {
@@ -11,44 +11,6 @@ namespace {
 using ::testing::_;
 using ::testing::Return;
 
-// Mock repository for testing interactor in isolation
-class MockAccountRepository : public IAccountRepository {
- public:
-  MOCK_METHOD(void, createAccount, (const Entities::Account&), (override));
-  MOCK_METHOD(std::optional<Entities::Account>, getAccount,
-              (const std::string&), (override));
-  MOCK_METHOD(std::optional<Entities::Account>, getAccountByName,
-              (const std::string&), (override));
-  MOCK_METHOD(std::vector<Entities::Account>, getAllAccounts, (), (override));
-  MOCK_METHOD(void, updateAccount, (const Entities::Account&), (override));
-  MOCK_METHOD(void, deleteAccount, (const std::string&), (override));
-  MOCK_METHOD(bool, accountExists, (const std::string&), (override));
-  MOCK_METHOD(bool, accountExistsByName, (const std::string&), (override));
-  MOCK_METHOD(void, setProperty,
-              (const std::string&, const std::string&, const std::string&,
-               const std::optional<std::string>&),
-              (override));
-  MOCK_METHOD(void, setProperty, (const Entities::AccountProperty&),
-              (override));
-  MOCK_METHOD(std::optional<Entities::AccountProperty>, getProperty,
-              (const std::string&, const std::string&), (override));
-  MOCK_METHOD(std::optional<std::string>, getPropertyValue,
-              (const std::string&, const std::string&), (override));
-  MOCK_METHOD(std::vector<Entities::AccountProperty>, getProperties,
-              (const std::string&), (override));
-  MOCK_METHOD(std::vector<Entities::AccountProperty>, getPropertiesByPrefix,
-              (const std::string&, const std::string&), (override));
-  MOCK_METHOD(bool, propertyExists, (const std::string&, const std::string&),
-              (override));
-  MOCK_METHOD(void, removeProperty, (const std::string&, const std::string&),
-              (override));
-  MOCK_METHOD(void, removePropertiesByPrefix,
-              (const std::string&, const std::string&), (override));
-  MOCK_METHOD(void, clearProperties, (const std::string&), (override));
-  MOCK_METHOD(int64_t, countAccounts, (), (override));
-  MOCK_METHOD(int64_t, countProperties, (const std::string&), (override));
-};
-
 class CreateAccountInteractorTest : public ::testing::Test {
  protected:
   MockAccountRepository mockRepo_;
@@ -59,17 +21,13 @@ class CreateAccountInteractorTest : public ::testing::Test {
 // Success Cases
 // ============================================================
 TEST_F(CreateAccountInteractorTest, CreateAccountSuccess) {
-  UseCases::CreateAccountRequest request{
-      .id = "acc-123",
-      .name = "John Doe",
-      .password_hash = std::nullopt,
-      .created_at = 1704067200000,
-  };
-
-  EXPECT_CALL(mockRepo_, accountExists("acc-123")).WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, accountExistsByName("John Doe"))
-      .WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, createAccount(_)).Times(1);
+  UseCases::CreateAccountRequest request;
+  request.id = "acc-123";
+  request.name = "John Doe";
+  request.created_at = 1704067200000;
+
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::None));
 
   auto response = interactor_.execute(request);
 
@@ -81,43 +39,52 @@ TEST_F(CreateAccountInteractorTest, CreateAccountSuccess) {
 TEST_F(CreateAccountInteractorTest, CreateAccountWithPassword) {
   std::vector<uint8_t> hash = {0x01, 0x02, 0x03};
 
-  UseCases::CreateAccountRequest request{
-      .id = "acc-123",
-      .name = "John Doe",
-      .password_hash = hash,
-      .created_at = 1704067200000,
-  };
+  UseCases::CreateAccountRequest request;
+  request.id = "acc-123";
+  request.name = "John Doe";
+  request.password_hash = hash;
+  request.created_at = 1704067200000;
 
-  EXPECT_CALL(mockRepo_, accountExists(_)).WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, accountExistsByName(_)).WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, createAccount(_)).Times(1);
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::None));
 
   auto response = interactor_.execute(request);
 
   EXPECT_EQ(response.id, "acc-123");
 }
 
+TEST_F(CreateAccountInteractorTest, CreateAccountIsOneRepositoryCall) {
+  UseCases::CreateAccountRequest request;
+  request.id = "acc-123";
+  request.name = "John Doe";
+  request.created_at = 0;
+
+  EXPECT_CALL(mockRepo_, accountExists(_)).Times(0);
+  EXPECT_CALL(mockRepo_, accountExistsByName(_)).Times(0);
+  EXPECT_CALL(mockRepo_, createAccount(_)).Times(0);
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::None));
+
+  interactor_.execute(request);
+}
+
 // ============================================================
 // Validation Errors
 // ============================================================
 TEST_F(CreateAccountInteractorTest, EmptyIdThrows) {
-  UseCases::CreateAccountRequest request{
-      .id = "",
-      .name = "John Doe",
-      .password_hash = std::nullopt,
-      .created_at = 1704067200000,
-  };
+  UseCases::CreateAccountRequest request;
+  request.id = "";
+  request.name = "John Doe";
+  request.created_at = 1704067200000;
 
   EXPECT_THROW(interactor_.execute(request), UseCases::CreateAccountError);
 }
 
 TEST_F(CreateAccountInteractorTest, EmptyNameThrows) {
-  UseCases::CreateAccountRequest request{
-      .id = "acc-123",
-      .name = "",
-      .password_hash = std::nullopt,
-      .created_at = 1704067200000,
-  };
+  UseCases::CreateAccountRequest request;
+  request.id = "acc-123";
+  request.name = "";
+  request.created_at = 1704067200000;
 
   EXPECT_THROW(interactor_.execute(request), UseCases::CreateAccountError);
 }
@@ -126,29 +93,25 @@ TEST_F(CreateAccountInteractorTest, EmptyNameThrows) {
 // Duplicate Errors
 // ============================================================
 TEST_F(CreateAccountInteractorTest, DuplicateIdThrows) {
-  UseCases::CreateAccountRequest request{
-      .id = "acc-123",
-      .name = "John Doe",
-      .password_hash = std::nullopt,
-      .created_at = 1704067200000,
-  };
+  UseCases::CreateAccountRequest request;
+  request.id = "acc-123";
+  request.name = "John Doe";
+  request.created_at = 1704067200000;
 
-  EXPECT_CALL(mockRepo_, accountExists("acc-123")).WillOnce(Return(true));
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::Id));
 
   EXPECT_THROW(interactor_.execute(request), UseCases::CreateAccountError);
 }
 
 TEST_F(CreateAccountInteractorTest, DuplicateNameThrows) {
-  UseCases::CreateAccountRequest request{
-      .id = "acc-123",
-      .name = "John Doe",
-      .password_hash = std::nullopt,
-      .created_at = 1704067200000,
-  };
+  UseCases::CreateAccountRequest request;
+  request.id = "acc-123";
+  request.name = "John Doe";
+  request.created_at = 1704067200000;
 
-  EXPECT_CALL(mockRepo_, accountExists("acc-123")).WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, accountExistsByName("John Doe"))
-      .WillOnce(Return(true));
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::Name));
 
   EXPECT_THROW(interactor_.execute(request), UseCases::CreateAccountError);
 }
@@ -157,8 +120,10 @@ TEST_F(CreateAccountInteractorTest, DuplicateNameThrows) {
 // Error Message Verification
 // ============================================================
 TEST_F(CreateAccountInteractorTest, EmptyIdErrorMessage) {
-  UseCases::CreateAccountRequest request{
-      .id = "", .name = "John", .created_at = 0};
+  UseCases::CreateAccountRequest request;
+  request.id = "";
+  request.name = "John";
+  request.created_at = 0;
 
   try {
     interactor_.execute(request);
@@ -169,8 +134,10 @@ TEST_F(CreateAccountInteractorTest, EmptyIdErrorMessage) {
 }
 
 TEST_F(CreateAccountInteractorTest, EmptyNameErrorMessage) {
-  UseCases::CreateAccountRequest request{
-      .id = "123", .name = "", .created_at = 0};
+  UseCases::CreateAccountRequest request;
+  request.id = "123";
+  request.name = "";
+  request.created_at = 0;
 
   try {
     interactor_.execute(request);
@@ -181,10 +148,13 @@ TEST_F(CreateAccountInteractorTest, EmptyNameErrorMessage) {
 }
 
 TEST_F(CreateAccountInteractorTest, DuplicateIdErrorMessage) {
-  UseCases::CreateAccountRequest request{
-      .id = "123", .name = "John", .created_at = 0};
+  UseCases::CreateAccountRequest request;
+  request.id = "123";
+  request.name = "John";
+  request.created_at = 0;
 
-  EXPECT_CALL(mockRepo_, accountExists("123")).WillOnce(Return(true));
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::Id));
 
   try {
     interactor_.execute(request);
@@ -195,11 +165,13 @@ TEST_F(CreateAccountInteractorTest, DuplicateIdErrorMessage) {
 }
 
 TEST_F(CreateAccountInteractorTest, DuplicateNameErrorMessage) {
-  UseCases::CreateAccountRequest request{
-      .id = "123", .name = "John", .created_at = 0};
+  UseCases::CreateAccountRequest request;
+  request.id = "123";
+  request.name = "John";
+  request.created_at = 0;
 
-  EXPECT_CALL(mockRepo_, accountExists(_)).WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, accountExistsByName("John")).WillOnce(Return(true));
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce(Return(Entities::AccountConflict::Name));
 
   try {
     interactor_.execute(request);
@@ -215,20 +187,18 @@ TEST_F(CreateAccountInteractorTest, DuplicateNameErrorMessage) {
 TEST_F(CreateAccountInteractorTest, RepositoryReceivesCorrectData) {
   std::vector<uint8_t> hash = {0xAB, 0xCD};
 
-  UseCases::CreateAccountRequest request{
-      .id = "test-id",
-      .name = "Test Name",
-      .password_hash = hash,
-      .created_at = 999,
-  };
+  UseCases::CreateAccountRequest request;
+  request.id = "test-id";
+  request.name = "Test Name";
+  request.password_hash = hash;
+  request.created_at = 999;
 
   Entities::Account capturedAccount;
 
-  EXPECT_CALL(mockRepo_, accountExists(_)).WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, accountExistsByName(_)).WillOnce(Return(false));
-  EXPECT_CALL(mockRepo_, createAccount(_))
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
       .WillOnce([&capturedAccount](const Entities::Account& acc) {
         capturedAccount = acc;
+        return Entities::AccountConflict::None;
       });
 
   interactor_.execute(request);
@@ -240,5 +210,65 @@ TEST_F(CreateAccountInteractorTest, RepositoryReceivesCorrectData) {
   EXPECT_EQ(capturedAccount.created_at, 999);
 }
 
+TEST_F(CreateAccountInteractorTest, PasswordIsHashed) {
+  class PrefixHasher : public IPasswordHasher {
+   public:
+    std::vector<uint8_t> hash(const std::string& password) override {
+      return {0x01, static_cast<uint8_t>(password.size())};
+    }
+  } hasher;
+  UseCases::CreateAccountInteractor interactor(mockRepo_, &hasher);
+  UseCases::CreateAccountRequest request;
+  request.id = "test-id";
+  request.name = "Test Name";
+  request.created_at = 0;
+  request.password = "secret";
+
+  Entities::Account capturedAccount;
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_))
+      .WillOnce([&capturedAccount](const Entities::Account& acc) {
+        capturedAccount = acc;
+        return Entities::AccountConflict::None;
+      });
+
+  interactor.execute(request);
+
+  EXPECT_EQ(capturedAccount.password_hash, (std::vector<uint8_t>{0x01, 6}));
+}
+
+TEST_F(CreateAccountInteractorTest, PasswordNeedsHasher) {
+  UseCases::CreateAccountRequest request;
+  request.id = "test-id";
+  request.name = "Test Name";
+  request.created_at = 0;
+  request.password = "secret";
+
+  EXPECT_CALL(mockRepo_, tryCreateAccount(_)).Times(0);
+
+  EXPECT_THROW(interactor_.execute(request), UseCases::CreateAccountError);
+}
+
+TEST_F(CreateAccountInteractorTest, PasswordAndHashAreExclusive) {
+  UseCases::CreateAccountInteractor interactor(mockRepo_, nullptr);
+  UseCases::CreateAccountRequest request;
+  request.id = "test-id";
+  request.name = "Test Name";
+  request.password_hash = std::vector<uint8_t>{1};
+  request.created_at = 0;
+  request.password = "secret";
+
+  EXPECT_THROW(
+      {
+        try {
+          interactor.execute(request);
+        } catch (const UseCases::CreateAccountError& e) {
+          EXPECT_STREQ(e.what(),
+                       "Give a password or a password hash, not both");
+          throw;
+        }
+      },
+      UseCases::CreateAccountError);
+}
+
 }  // namespace
 }  // namespace UseCases
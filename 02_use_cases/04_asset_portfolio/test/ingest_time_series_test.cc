@@ -0,0 +1,224 @@
+#include "ingest_time_series.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+namespace UseCases {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+// Serves canned series; fetchMany() runs the callback on one thread, as
+// the interface allows
+class FakeNetworkDataRepository : public INetworkDataRepository {
+ public:
+  std::vector<Entities::TimeSeriesPoint> fetchTimeSeriesData(
+      const std::string& instrument_id) override {
+    if (failing.count(instrument_id) != 0) {
+      throw std::runtime_error("Upstream unavailable");
+    }
+    return series[instrument_id];
+  }
+
+  void fetchMany(
+      const std::vector<std::string>& instrument_ids, size_t max_concurrency,
+      const std::function<void(Entities::InstrumentFetch)>& on_result)
+      override {
+    lastConcurrency = max_concurrency;
+    for (const auto& id : instrument_ids) {
+      Entities::InstrumentFetch fetch;
+      fetch.instrument_id = id;
+      try {
+        fetch.points = fetchTimeSeriesData(id);
+      } catch (const std::exception& e) {
+        fetch.error = e.what();
+      }
+      on_result(std::move(fetch));
+    }
+  }
+
+  std::vector<Entities::InstrumentFetch> fetchMany(
+      const std::vector<std::string>& instrument_ids,
+      size_t max_concurrency) override {
+    std::vector<Entities::InstrumentFetch> results;
+    fetchMany(instrument_ids, max_concurrency,
+              [&](Entities::InstrumentFetch f) { results.push_back(f); });
+    return results;
+  }
+
+  std::map<std::string, std::vector<Entities::TimeSeriesPoint>> series;
+  std::set<std::string> failing;
+  size_t lastConcurrency = 0;
+};
+
+class MockTimeSeriesRepository : public ITimeSeriesRepository {
+ public:
+  MOCK_METHOD(std::optional<Entities::TimeSeriesPoint>, getLatestPoint,
+              (const std::string&, const std::string&), (override));
+  MOCK_METHOD(void, addPoints,
+              (const std::vector<Entities::TimeSeriesPoint>&), (override));
+};
+
+Entities::TimeSeriesPoint point(const std::string& asset_id,
+                                int64_t timestamp_ms, double value) {
+  return {asset_id, timestamp_ms, "", value};
+}
+
+class IngestTimeSeriesInteractorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    network_.series["A"] = {point("A", 1000, 1.0), point("A", 2000, 2.0),
+                            point("A", 3000, 3.0)};
+    network_.series["B"] = {point("B", 1000, 5.0)};
+    // New series unless a test says otherwise
+    EXPECT_CALL(mockRepo_, getLatestPoint(_, _))
+        .WillRepeatedly(Return(std::nullopt));
+  }
+
+  // Every addPoints() batch, concatenated
+  void captureWrites() {
+    EXPECT_CALL(mockRepo_, addPoints(_))
+        .WillRepeatedly(
+            [this](const std::vector<Entities::TimeSeriesPoint>& points) {
+              ++writes_;
+              written_.insert(written_.end(), points.begin(), points.end());
+            });
+  }
+
+  FakeNetworkDataRepository network_;
+  ::testing::NiceMock<MockTimeSeriesRepository> mockRepo_;
+  IngestTimeSeriesInteractor interactor_{network_, mockRepo_};
+  std::vector<Entities::TimeSeriesPoint> written_;
+  int writes_ = 0;
+};
+
+// ============================================================
+// Watermarks
+// ============================================================
+
+TEST_F(IngestTimeSeriesInteractorTest, WritesOnlyPointsPastTheWatermark) {
+  EXPECT_CALL(mockRepo_, getLatestPoint("A", "EUR"))
+      .WillOnce(Return(point("A", 2000, 2.0)));
+  captureWrites();
+
+  auto response = interactor_.execute({{"A", "B"}, "EUR"});
+
+  ASSERT_EQ(written_.size(), 2u);
+  EXPECT_EQ(written_[0].asset_id, "A");
+  EXPECT_EQ(written_[0].timestamp_ms, 3000);
+  EXPECT_EQ(written_[0].unit_id, "EUR");
+  EXPECT_EQ(written_[1].asset_id, "B");
+  EXPECT_EQ(writes_, 1);  // both series in one batch
+  EXPECT_EQ(response.written, 2u);
+  ASSERT_EQ(response.instruments.size(), 2u);
+  EXPECT_EQ(response.instruments[0].fetched, 3u);
+  EXPECT_EQ(response.instruments[0].written, 1u);
+  EXPECT_EQ(response.instruments[1].written, 1u);
+}
+
+TEST_F(IngestTimeSeriesInteractorTest, UnchangedSeriesAreNotWritten) {
+  EXPECT_CALL(mockRepo_, getLatestPoint("A", "EUR"))
+      .WillOnce(Return(point("A", 3000, 3.0)));
+  EXPECT_CALL(mockRepo_, addPoints(_)).Times(0);
+
+  auto response = interactor_.execute({{"A"}, "EUR"});
+
+  EXPECT_EQ(response.written, 0u);
+  ASSERT_EQ(response.instruments.size(), 1u);
+  EXPECT_EQ(response.instruments[0].fetched, 3u);
+  EXPECT_EQ(response.instruments[0].written, 0u);
+  EXPECT_FALSE(response.instruments[0].error.has_value());
+}
+
+TEST_F(IngestTimeSeriesInteractorTest, RepeatedIdsAreFetchedOnce) {
+  EXPECT_CALL(mockRepo_, getLatestPoint("A", _)).Times(1);
+  captureWrites();
+
+  auto response = interactor_.execute({{"A", "A"}, "EUR"});
+
+  EXPECT_EQ(written_.size(), 3u);
+  EXPECT_EQ(response.instruments.size(), 1u);
+}
+
+TEST_F(IngestTimeSeriesInteractorTest, EmptyRequestSkipsRepositories) {
+  EXPECT_CALL(mockRepo_, getLatestPoint(_, _)).Times(0);
+  EXPECT_CALL(mockRepo_, addPoints(_)).Times(0);
+
+  auto response = interactor_.execute({});
+
+  EXPECT_TRUE(response.instruments.empty());
+  EXPECT_EQ(network_.lastConcurrency, 0u);
+}
+
+// ============================================================
+// Batching
+// ============================================================
+
+TEST_F(IngestTimeSeriesInteractorTest, SplitsWritesIntoBatches) {
+  IngestTimeSeriesOptions options;
+  options.fetchConcurrency = 8;
+  options.queueDepth = 1;
+  options.batchPoints = 2;
+  IngestTimeSeriesInteractor interactor(network_, mockRepo_, options);
+  captureWrites();
+
+  auto response = interactor.execute({{"A", "B"}, "EUR"});
+
+  EXPECT_EQ(writes_, 2);
+  EXPECT_EQ(written_.size(), 4u);
+  EXPECT_EQ(response.written, 4u);
+  EXPECT_EQ(network_.lastConcurrency, 8u);
+}
+
+// ============================================================
+// Failures
+// ============================================================
+
+TEST_F(IngestTimeSeriesInteractorTest, FetchFailureIsReportedPerInstrument) {
+  network_.failing.insert("A");
+  captureWrites();
+
+  auto response = interactor_.execute({{"A", "B"}, "EUR"});
+
+  ASSERT_EQ(response.instruments.size(), 2u);
+  ASSERT_TRUE(response.instruments[0].error.has_value());
+  EXPECT_EQ(*response.instruments[0].error, "Upstream unavailable");
+  EXPECT_EQ(response.instruments[0].written, 0u);
+  EXPECT_FALSE(response.instruments[1].error.has_value());
+  EXPECT_EQ(written_.size(), 1u);
+}
+
+TEST_F(IngestTimeSeriesInteractorTest, WriteFailurePropagates) {
+  IngestTimeSeriesOptions options;
+  options.fetchConcurrency = 1;
+  options.queueDepth = 1;
+  options.batchPoints = 1;
+  IngestTimeSeriesInteractor interactor(network_, mockRepo_, options);
+  EXPECT_CALL(mockRepo_, addPoints(_))
+      .WillOnce(Return())
+      .WillOnce([](const std::vector<Entities::TimeSeriesPoint>&) {
+        throw std::runtime_error("disk full");
+      });
+
+  EXPECT_THROW(interactor.execute({{"A", "B"}, "EUR"}), std::runtime_error);
+}
+
+TEST_F(IngestTimeSeriesInteractorTest, RejectsZeroOptions) {
+  IngestTimeSeriesOptions no_fetchers;
+  no_fetchers.fetchConcurrency = 0;
+  EXPECT_THROW(IngestTimeSeriesInteractor(network_, mockRepo_, no_fetchers),
+               std::invalid_argument);
+  IngestTimeSeriesOptions no_batches;
+  no_batches.batchPoints = 0;
+  EXPECT_THROW(IngestTimeSeriesInteractor(network_, mockRepo_, no_batches),
+               std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace UseCases
@@ -0,0 +1,71 @@
+#ifndef USE_CASES_TEST_MOCK_ACCOUNT_REPOSITORY_H_
+#define USE_CASES_TEST_MOCK_ACCOUNT_REPOSITORY_H_
+
+#include <gmock/gmock.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "i_account_repository.h"
+
+namespace UseCases {
+
+// Mock repository for testing interactor in isolation
+class MockAccountRepository : public IAccountRepository {
+ public:
+  MOCK_METHOD(void, createAccount, (const Entities::Account&), (override));
+  MOCK_METHOD(Entities::AccountConflict, tryCreateAccount,
+              (const Entities::Account&), (override));
+  MOCK_METHOD(void, createAccounts, (const std::vector<Entities::Account>&),
+              (override));
+  MOCK_METHOD(std::vector<Entities::AccountConflict>, findAccountConflicts,
+              (const std::vector<Entities::Account>&), (override));
+  MOCK_METHOD(std::optional<Entities::Account>, getAccount,
+              (const std::string&), (override));
+  MOCK_METHOD(std::optional<Entities::Account>, getAccountByName,
+              (const std::string&), (override));
+  MOCK_METHOD(std::vector<Entities::Account>, getAllAccounts, (), (override));
+  MOCK_METHOD(std::vector<Entities::AccountSummary>, listAccounts,
+              (const std::optional<std::string>&, size_t), (override));
+  MOCK_METHOD(void, updateAccount, (const Entities::Account&), (override));
+  MOCK_METHOD(void, deleteAccount, (const std::string&), (override));
+  MOCK_METHOD(bool, accountExists, (const std::string&), (override));
+  MOCK_METHOD(bool, accountExistsByName, (const std::string&), (override));
+  MOCK_METHOD(void, setProperty,
+              (const std::string&, const std::string&, const std::string&,
+               const std::optional<std::string>&),
+              (override));
+  MOCK_METHOD(void, setProperty, (const Entities::AccountProperty&),
+              (override));
+  MOCK_METHOD(std::optional<Entities::AccountProperty>, getProperty,
+              (const std::string&, const std::string&), (override));
+  MOCK_METHOD(std::optional<std::string>, getPropertyValue,
+              (const std::string&, const std::string&), (override));
+  MOCK_METHOD(std::vector<Entities::AccountProperty>, getProperties,
+              (const std::string&), (override));
+  MOCK_METHOD(std::vector<Entities::AccountProperty>, getPropertiesByPrefix,
+              (const std::string&, const std::string&), (override));
+  MOCK_METHOD(std::vector<Entities::AccountProperty>, listProperties,
+              (const std::string&, const std::optional<std::string>&, size_t),
+              (override));
+  MOCK_METHOD(std::vector<std::vector<Entities::AccountProperty>>,
+              getPropertiesForAccounts, (const std::vector<std::string>&),
+              (override));
+  MOCK_METHOD(std::vector<Entities::AccountWithProperties>,
+              getAccountsWithProperties,
+              (const std::optional<std::string>&, size_t), (override));
+  MOCK_METHOD(bool, propertyExists, (const std::string&, const std::string&),
+              (override));
+  MOCK_METHOD(void, removeProperty, (const std::string&, const std::string&),
+              (override));
+  MOCK_METHOD(void, removePropertiesByPrefix,
+              (const std::string&, const std::string&), (override));
+  MOCK_METHOD(void, clearProperties, (const std::string&), (override));
+  MOCK_METHOD(int64_t, countAccounts, (), (override));
+  MOCK_METHOD(int64_t, countProperties, (const std::string&), (override));
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_TEST_MOCK_ACCOUNT_REPOSITORY_H_
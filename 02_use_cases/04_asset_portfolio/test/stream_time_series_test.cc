@@ -0,0 +1,270 @@
+#include "stream_time_series.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "spsc_queue.h"
+
+namespace UseCases {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+Entities::TimeSeriesPoint point(const std::string& asset_id,
+                                int64_t timestamp_ms, double value) {
+  return {asset_id, timestamp_ms, "", value};
+}
+
+// Replays scripted ticks, gap apart, then ends the stream, or with
+// holdOpen waits for stop() as a live source would
+class FakeQuoteStream : public IQuoteStream {
+ public:
+  void stream(const std::vector<std::string>& instrument_ids,
+              const std::function<bool(Entities::TimeSeriesPoint)>& on_tick)
+      override {
+    requested = instrument_ids;
+    for (const auto& tick : ticks) {
+      if (gap.count() > 0) std::this_thread::sleep_for(gap);
+      if (stopped() || !on_tick(tick)) return;
+    }
+    if (failAtEnd) {
+      throw std::runtime_error("Subscription refused");
+    }
+    if (holdOpen) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_stopped.wait(lock, [&] { return m_stop; });
+    }
+  }
+
+  void stop() override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    m_stopped.notify_all();
+  }
+
+  bool stopped() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stop;
+  }
+
+  std::vector<Entities::TimeSeriesPoint> ticks;
+  std::chrono::milliseconds gap{0};
+  bool holdOpen = false;
+  bool failAtEnd = false;
+  std::vector<std::string> requested;
+
+ private:
+  std::mutex m_mutex;
+  std::condition_variable m_stopped;
+  bool m_stop = false;
+};
+
+class MockTimeSeriesRepository : public ITimeSeriesRepository {
+ public:
+  MOCK_METHOD(std::optional<Entities::TimeSeriesPoint>, getLatestPoint,
+              (const std::string&, const std::string&), (override));
+  MOCK_METHOD(void, addPoints,
+              (const std::vector<Entities::TimeSeriesPoint>&), (override));
+};
+
+class StreamTimeSeriesInteractorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    EXPECT_CALL(mockRepo_, getLatestPoint(_, _))
+        .WillRepeatedly(Return(std::nullopt));
+  }
+
+  // Every addPoints() batch, concatenated
+  void captureWrites() {
+    EXPECT_CALL(mockRepo_, addPoints(_))
+        .WillRepeatedly(
+            [this](const std::vector<Entities::TimeSeriesPoint>& points) {
+              ++writes_;
+              written_.insert(written_.end(), points.begin(), points.end());
+            });
+  }
+
+  FakeQuoteStream stream_;
+  ::testing::NiceMock<MockTimeSeriesRepository> mockRepo_;
+  std::vector<Entities::TimeSeriesPoint> written_;
+  int writes_ = 0;
+};
+
+// ============================================================
+// SpscQueue
+// ============================================================
+
+TEST(SpscQueueTest, RoundsCapacityUpAndRefusesWhenFull) {
+  SpscQueue<int> queue(3);
+  EXPECT_EQ(queue.capacity(), 4u);
+
+  for (int i = 0; i < 4; ++i) {
+    int item = i;
+    EXPECT_TRUE(queue.tryPush(item));
+  }
+  int extra = 9;
+  EXPECT_FALSE(queue.tryPush(extra));
+  EXPECT_EQ(extra, 9);
+
+  int item = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.tryPop(item));
+    EXPECT_EQ(item, i);
+  }
+  EXPECT_FALSE(queue.tryPop(item));
+  EXPECT_THROW(SpscQueue<int>(0), std::invalid_argument);
+}
+
+TEST(SpscQueueTest, HandsItemsAcrossThreadsInOrder) {
+  constexpr int kItems = 100000;
+  SpscQueue<int> queue(64);
+
+  std::thread producer([&] {
+    for (int i = 0; i < kItems; ++i) {
+      int item = i;
+      while (!queue.tryPush(item)) std::this_thread::yield();
+    }
+  });
+  int expected = 0;
+  while (expected < kItems) {
+    int item;
+    if (queue.tryPop(item)) {
+      ASSERT_EQ(item, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+
+// ============================================================
+// StreamTimeSeriesInteractor
+// ============================================================
+
+TEST_F(StreamTimeSeriesInteractorTest, WritesTicksPastTheWatermark) {
+  EXPECT_CALL(mockRepo_, getLatestPoint("A", "EUR"))
+      .WillOnce(Return(point("A", 2000, 2.0)));
+  stream_.ticks = {point("A", 1000, 1.0), point("B", 1500, 5.0),
+                   point("A", 3000, 3.0)};
+  captureWrites();
+  StreamTimeSeriesInteractor interactor(stream_, mockRepo_);
+
+  auto response = interactor.execute({{"A", "B", "A"}, "EUR"});
+
+  EXPECT_EQ(stream_.requested, (std::vector<std::string>{"A", "B"}));
+  ASSERT_EQ(written_.size(), 2u);
+  EXPECT_EQ(written_[0].asset_id, "B");
+  EXPECT_EQ(written_[0].unit_id, "EUR");
+  EXPECT_EQ(written_[1].timestamp_ms, 3000);
+  EXPECT_EQ(response.received, 3u);
+  EXPECT_EQ(response.written, 2u);
+  EXPECT_EQ(response.stale, 1u);
+}
+
+TEST_F(StreamTimeSeriesInteractorTest, DropsRepeatsAndUnrequestedTicks) {
+  // As a reconnect without resume would replay them
+  stream_.ticks = {point("A", 1000, 1.0), point("A", 2000, 2.0),
+                   point("A", 1000, 1.0), point("A", 2000, 2.0),
+                   point("Z", 5000, 9.0)};
+  captureWrites();
+  StreamTimeSeriesInteractor interactor(stream_, mockRepo_);
+
+  auto response = interactor.execute({{"A"}, "EUR"});
+
+  EXPECT_EQ(written_.size(), 2u);
+  EXPECT_EQ(response.stale, 3u);
+}
+
+TEST_F(StreamTimeSeriesInteractorTest, SplitsWritesIntoBatches) {
+  for (int i = 1; i <= 10; ++i) {
+    stream_.ticks.push_back(point("A", i * 1000, i));
+  }
+  captureWrites();
+  StreamTimeSeriesOptions options;
+  options.batchPoints = 4;
+  options.flushInterval = std::chrono::seconds(10);
+  StreamTimeSeriesInteractor interactor(stream_, mockRepo_, options);
+
+  auto response = interactor.execute({{"A"}, "EUR"});
+
+  EXPECT_EQ(writes_, 3);  // 4 + 4 + 2
+  EXPECT_EQ(response.written, 10u);
+}
+
+TEST_F(StreamTimeSeriesInteractorTest, SlowTicksAreWrittenWithinTheInterval) {
+  for (int i = 1; i <= 10; ++i) {
+    stream_.ticks.push_back(point("A", i * 1000, i));
+  }
+  stream_.gap = std::chrono::milliseconds(15);
+  captureWrites();
+  StreamTimeSeriesInteractor interactor(stream_, mockRepo_);
+
+  auto response = interactor.execute({{"A"}, "EUR"});
+
+  EXPECT_EQ(response.written, 10u);
+  EXPECT_GT(writes_, 1);  // not held back for a full batch
+  EXPECT_LT(response.maxDelay, std::chrono::milliseconds(50));
+}
+
+TEST_F(StreamTimeSeriesInteractorTest, StopEndsALiveStream) {
+  stream_.ticks = {point("A", 1000, 1.0), point("A", 2000, 2.0)};
+  stream_.holdOpen = true;
+  captureWrites();
+  StreamTimeSeriesInteractor interactor(stream_, mockRepo_);
+
+  std::thread stopper([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    interactor.stop();
+  });
+  auto response = interactor.execute({{"A"}, "EUR"});
+  stopper.join();
+
+  EXPECT_EQ(response.written, 2u);
+  EXPECT_TRUE(stream_.stopped());
+}
+
+TEST_F(StreamTimeSeriesInteractorTest, StreamFailurePropagatesAfterWrites) {
+  stream_.ticks = {point("A", 1000, 1.0)};
+  stream_.failAtEnd = true;
+  captureWrites();
+  StreamTimeSeriesInteractor interactor(stream_, mockRepo_);
+
+  EXPECT_THROW(interactor.execute({{"A"}, "EUR"}), std::runtime_error);
+  EXPECT_EQ(written_.size(), 1u);
+}
+
+TEST_F(StreamTimeSeriesInteractorTest, WriteFailureStopsTheStream) {
+  stream_.ticks = {point("A", 1000, 1.0)};
+  stream_.holdOpen = true;
+  EXPECT_CALL(mockRepo_, addPoints(_))
+      .WillOnce(::testing::Throw(std::runtime_error("Disk full")));
+  StreamTimeSeriesInteractor interactor(stream_, mockRepo_);
+
+  EXPECT_THROW(interactor.execute({{"A"}, "EUR"}), std::runtime_error);
+  EXPECT_TRUE(stream_.stopped());
+}
+
+TEST_F(StreamTimeSeriesInteractorTest, RejectsBadOptions) {
+  StreamTimeSeriesOptions options;
+  options.queueDepth = 0;
+  EXPECT_THROW(StreamTimeSeriesInteractor(stream_, mockRepo_, options),
+               std::invalid_argument);
+  options = {};
+  options.batchPoints = 0;
+  EXPECT_THROW(StreamTimeSeriesInteractor(stream_, mockRepo_, options),
+               std::invalid_argument);
+  options = {};
+  options.flushInterval = std::chrono::milliseconds(-1);
+  EXPECT_THROW(StreamTimeSeriesInteractor(stream_, mockRepo_, options),
+               std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace UseCases
@@ -0,0 +1,202 @@
+#include "value_portfolio.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <utility>
+
+#include "mock_account_repository.h"
+
+namespace UseCases {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+// Latest prices and unit factors from maps, counting the calls
+class FakePriceRepository : public IPriceRepository {
+ public:
+  std::vector<std::optional<Entities::TimeSeriesPoint>> getLatestPoints(
+      const std::vector<std::string>& asset_ids) override {
+    ++latestCalls;
+    std::vector<std::optional<Entities::TimeSeriesPoint>> points;
+    for (const auto& asset_id : asset_ids) {
+      auto it = prices.find(asset_id);
+      if (it == prices.end()) {
+        points.push_back(std::nullopt);
+      } else {
+        points.push_back(Entities::TimeSeriesPoint{
+            asset_id, 1000, it->second.first, it->second.second});
+      }
+    }
+    return points;
+  }
+
+  std::optional<double> conversionFactor(
+      const std::string& from_unit_id,
+      const std::string& to_unit_id) override {
+    ++factorCalls;
+    if (from_unit_id == to_unit_id) {
+      return 1.0;
+    }
+    auto it = factors.find({from_unit_id, to_unit_id});
+    if (it == factors.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  std::map<std::string, std::pair<std::string, double>> prices;  // unit, px
+  std::map<std::pair<std::string, std::string>, double> factors;
+  int latestCalls = 0;
+  int factorCalls = 0;
+};
+
+Entities::AccountProperty property(const std::string& key,
+                                   const std::string& value) {
+  return {"acc-1", key, value, std::nullopt};
+}
+
+class ValuePortfolioInteractorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    prices_.prices["AAPL"] = {"USD", 200.0};
+    prices_.prices["SAP"] = {"EUR", 150.0};
+    prices_.prices["BASF"] = {"EUR", 50.0};
+    prices_.factors[{"USD", "EUR"}] = 0.5;
+  }
+
+  void holdings(std::vector<Entities::AccountProperty> properties) {
+    EXPECT_CALL(mockRepo_, getProperties("acc-1"))
+        .WillOnce(Return(std::move(properties)));
+  }
+
+  MockAccountRepository mockRepo_;
+  FakePriceRepository prices_;
+  ValuePortfolioInteractor interactor_{mockRepo_, prices_};
+};
+
+// ============================================================
+// Valuation
+// ============================================================
+TEST_F(ValuePortfolioInteractorTest, ValuesHoldingsInAccountCurrency) {
+  holdings({property("currency", "EUR"), property("holding.AAPL", "10"),
+            property("holding.BASF", "4"), property("holding.SAP", "2"),
+            property("nickname", "main")});
+
+  auto response = interactor_.execute({"acc-1"});
+
+  EXPECT_EQ(response.currency, "EUR");
+  ASSERT_EQ(response.positions.size(), 3u);
+  EXPECT_EQ(response.positions[0].asset_id, "AAPL");
+  EXPECT_EQ(response.positions[0].price_unit_id, "USD");
+  EXPECT_DOUBLE_EQ(response.positions[0].price, 200.0);
+  // 10 * 200 USD at 0.5
+  EXPECT_DOUBLE_EQ(response.positions[0].value, 1000.0);
+  EXPECT_DOUBLE_EQ(response.positions[1].value, 200.0);
+  EXPECT_DOUBLE_EQ(response.positions[2].value, 300.0);
+  EXPECT_DOUBLE_EQ(response.total_value, 1500.0);
+  EXPECT_DOUBLE_EQ(response.positions[0].weight, 1000.0 / 1500.0);
+  EXPECT_TRUE(response.unpriced.empty());
+}
+
+TEST_F(ValuePortfolioInteractorTest, ExposuresByPriceUnit) {
+  holdings({property("currency", "EUR"), property("holding.AAPL", "10"),
+            property("holding.BASF", "4"), property("holding.SAP", "2")});
+
+  auto response = interactor_.execute({"acc-1"});
+
+  ASSERT_EQ(response.exposures.size(), 2u);
+  EXPECT_EQ(response.exposures[0].unit_id, "EUR");
+  EXPECT_DOUBLE_EQ(response.exposures[0].value, 500.0);
+  EXPECT_EQ(response.exposures[1].unit_id, "USD");
+  EXPECT_DOUBLE_EQ(response.exposures[1].value, 1000.0);
+  EXPECT_DOUBLE_EQ(response.exposures[0].weight + response.exposures[1].weight,
+                   1.0);
+}
+
+TEST_F(ValuePortfolioInteractorTest, OneBatchOfPricesAndOneFactorPerUnit) {
+  std::vector<Entities::AccountProperty> properties = {
+      property("currency", "EUR")};
+  for (int i = 0; i < 500; ++i) {
+    const std::string asset = "A" + std::to_string(i);
+    prices_.prices[asset] = {i % 2 == 0 ? "USD" : "EUR", 1.0 + i};
+    properties.push_back(property("holding." + asset, "1.5"));
+  }
+  holdings(properties);
+
+  auto response = interactor_.execute({"acc-1"});
+
+  EXPECT_EQ(prices_.latestCalls, 1);
+  EXPECT_EQ(prices_.factorCalls, 2);
+  ASSERT_EQ(response.positions.size(), 500u);
+  double expected = 0.0;
+  for (int i = 0; i < 500; ++i) {
+    expected += 1.5 * (1.0 + i) * (i % 2 == 0 ? 0.5 : 1.0);
+  }
+  EXPECT_NEAR(response.total_value, expected, 1e-9 * expected);
+}
+
+TEST_F(ValuePortfolioInteractorTest, UnpricedHoldingsAreLeftOut) {
+  prices_.prices["GOLD"] = {"oz", 2000.0};  // no path to EUR
+  holdings({property("currency", "EUR"), property("holding.GOLD", "1"),
+            property("holding.MISSING", "3"), property("holding.SAP", "2")});
+
+  auto response = interactor_.execute({"acc-1"});
+
+  ASSERT_EQ(response.positions.size(), 1u);
+  EXPECT_EQ(response.positions[0].asset_id, "SAP");
+  EXPECT_DOUBLE_EQ(response.positions[0].weight, 1.0);
+  EXPECT_DOUBLE_EQ(response.total_value, 300.0);
+  EXPECT_EQ(response.unpriced,
+            (std::vector<std::string>{"GOLD", "MISSING"}));
+}
+
+TEST_F(ValuePortfolioInteractorTest, NoHoldings) {
+  holdings({property("currency", "EUR")});
+
+  auto response = interactor_.execute({"acc-1"});
+
+  EXPECT_DOUBLE_EQ(response.total_value, 0.0);
+  EXPECT_TRUE(response.positions.empty());
+  EXPECT_EQ(prices_.latestCalls, 0);
+}
+
+TEST_F(ValuePortfolioInteractorTest, ZeroTotalHasZeroWeights) {
+  holdings({property("currency", "EUR"), property("holding.SAP", "0")});
+
+  auto response = interactor_.execute({"acc-1"});
+
+  ASSERT_EQ(response.positions.size(), 1u);
+  EXPECT_DOUBLE_EQ(response.positions[0].weight, 0.0);
+  EXPECT_DOUBLE_EQ(response.exposures[0].weight, 0.0);
+}
+
+// ============================================================
+// Failure Cases
+// ============================================================
+TEST_F(ValuePortfolioInteractorTest, UnknownAccountThrows) {
+  holdings({});
+  EXPECT_CALL(mockRepo_, accountExists("acc-1")).WillOnce(Return(false));
+
+  EXPECT_THROW(interactor_.execute({"acc-1"}), ValuePortfolioError);
+}
+
+TEST_F(ValuePortfolioInteractorTest, AccountWithoutCurrencyThrows) {
+  holdings({property("holding.SAP", "2")});
+  EXPECT_CALL(mockRepo_, accountExists("acc-1")).WillOnce(Return(true));
+
+  EXPECT_THROW(interactor_.execute({"acc-1"}), ValuePortfolioError);
+}
+
+TEST_F(ValuePortfolioInteractorTest, MalformedQuantityThrows) {
+  for (const char* quantity : {"", "ten", "1.5x", "inf", "nan"}) {
+    holdings({property("currency", "EUR"), property("holding.SAP", quantity)});
+    EXPECT_THROW(interactor_.execute({"acc-1"}), ValuePortfolioError)
+        << quantity;
+  }
+}
+
+}  // namespace
+}  // namespace UseCases
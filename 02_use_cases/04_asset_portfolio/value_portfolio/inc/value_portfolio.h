@@ -0,0 +1,78 @@
+#ifndef USE_CASES_VALUE_PORTFOLIO_H_
+#define USE_CASES_VALUE_PORTFOLIO_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+#include "i_account_repository.h"
+#include "i_price_repository.h"
+
+namespace UseCases {
+
+class ValuePortfolioError : public std::runtime_error {
+ public:
+  explicit ValuePortfolioError(const std::string& msg)
+      : std::runtime_error(msg) {}
+};
+
+struct ValuePortfolioRequest {
+  std::string account_id;
+};
+
+struct PortfolioPosition {
+  std::string asset_id;
+  double quantity;
+  double price;  // latest, in price_unit_id
+  std::string price_unit_id;
+  int64_t price_timestamp_ms;
+  double value;   // quantity * price, in the account currency
+  double weight;  // value / total_value; 0 if the total is 0
+};
+
+// Share of the portfolio quoted in one unit, before conversion
+struct PortfolioExposure {
+  std::string unit_id;
+  double value;  // in the account currency
+  double weight;
+};
+
+struct ValuePortfolioResponse {
+  std::string account_id;
+  std::string currency;
+  double total_value = 0.0;
+  std::vector<PortfolioPosition> positions;  // by asset id
+  std::vector<PortfolioExposure> exposures;  // by unit id
+  // Holdings left out of the total: no price, or a price in a unit that
+  // does not convert into the currency
+  std::vector<std::string> unpriced;
+};
+
+// Values an account's holdings in its currency. Holdings and currency
+// are account properties: "holding.<asset_id>" with the quantity, and
+// "currency" with the unit id to value in. One call reads the
+// properties, one fetches the latest prices, and each distinct price
+// unit resolves one factor; the values, total and weights then run
+// through the Analytics SIMD kernels over the positions as arrays.
+class ValuePortfolioInteractor {
+ public:
+  static constexpr const char* kCurrencyProperty = "currency";
+  static constexpr const char* kHoldingPrefix = "holding.";
+
+  ValuePortfolioInteractor(IAccountRepository& accounts,
+                           IPriceRepository& prices);
+
+  // Throws ValuePortfolioError for an unknown account, one without a
+  // currency, or a quantity that is not a finite number
+  ValuePortfolioResponse execute(const ValuePortfolioRequest& request);
+
+ private:
+  IAccountRepository& m_accounts;
+  IPriceRepository& m_prices;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_VALUE_PORTFOLIO_H_
@@ -0,0 +1,134 @@
+#include "value_portfolio.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "series_stats.h"
+
+namespace UseCases {
+
+namespace {
+
+std::optional<double> parseQuantity(const std::string& text) {
+  if (text.empty()) {
+    return std::nullopt;
+  }
+  char* end = nullptr;
+  errno = 0;
+  const double quantity = std::strtod(text.c_str(), &end);
+  if (errno != 0 || end != text.c_str() + text.size() ||
+      !std::isfinite(quantity)) {
+    return std::nullopt;
+  }
+  return quantity;
+}
+
+}  // namespace
+
+ValuePortfolioInteractor::ValuePortfolioInteractor(
+    IAccountRepository& accounts, IPriceRepository& prices)
+    : m_accounts(accounts), m_prices(prices) {}
+
+ValuePortfolioResponse ValuePortfolioInteractor::execute(
+    const ValuePortfolioRequest& request) {
+  // One query for the currency and the holdings, ordered by key
+  const auto properties = m_accounts.getProperties(request.account_id);
+
+  ValuePortfolioResponse response;
+  response.account_id = request.account_id;
+  std::vector<std::string> asset_ids;
+  std::vector<double> quantities;
+  const std::string_view prefix = kHoldingPrefix;
+  bool has_currency = false;
+  for (const auto& property : properties) {
+    if (property.key == kCurrencyProperty) {
+      response.currency = property.value;
+      has_currency = true;
+    } else if (std::string_view(property.key).substr(0, prefix.size()) ==
+               prefix) {
+      auto quantity = parseQuantity(property.value);
+      if (!quantity) {
+        throw ValuePortfolioError("Quantity of " + property.key +
+                                  " is not a number: " + property.value);
+      }
+      asset_ids.push_back(property.key.substr(prefix.size()));
+      quantities.push_back(*quantity);
+    }
+  }
+  if (!has_currency) {
+    if (!m_accounts.accountExists(request.account_id)) {
+      throw ValuePortfolioError("Account not found: " + request.account_id);
+    }
+    throw ValuePortfolioError("Account has no currency: " +
+                              request.account_id);
+  }
+  if (asset_ids.empty()) {
+    return response;
+  }
+
+  // Positions that have a price and a path into the currency, as arrays
+  // for the kernels; factors resolved once per unit
+  auto latest = m_prices.getLatestPoints(asset_ids);
+  std::unordered_map<std::string, std::optional<double>> factors;
+  std::vector<double> held;
+  std::vector<double> prices;
+  std::vector<double> rates;
+  held.reserve(asset_ids.size());
+  prices.reserve(asset_ids.size());
+  rates.reserve(asset_ids.size());
+  for (size_t i = 0; i < asset_ids.size(); ++i) {
+    if (!latest[i]) {
+      response.unpriced.push_back(std::move(asset_ids[i]));
+      continue;
+    }
+    auto factor = factors.find(latest[i]->unit_id);
+    if (factor == factors.end()) {
+      factor = factors
+                   .emplace(latest[i]->unit_id,
+                            m_prices.conversionFactor(latest[i]->unit_id,
+                                                      response.currency))
+                   .first;
+    }
+    if (!factor->second) {
+      response.unpriced.push_back(std::move(asset_ids[i]));
+      continue;
+    }
+    held.push_back(quantities[i]);
+    prices.push_back(latest[i]->value);
+    rates.push_back(*factor->second);
+    response.positions.push_back({std::move(asset_ids[i]), quantities[i],
+                                  latest[i]->value,
+                                  std::move(latest[i]->unit_id),
+                                  latest[i]->timestamp_ms, 0.0, 0.0});
+  }
+
+  const auto values =
+      Analytics::multiply(Analytics::multiply(held, prices), rates);
+  response.total_value = Analytics::sum(values);
+  const auto weights =
+      response.total_value == 0.0
+          ? std::vector<double>(values.size(), 0.0)
+          : Analytics::scale(values, 1.0 / response.total_value);
+
+  std::map<std::string, double> by_unit;
+  for (size_t i = 0; i < response.positions.size(); ++i) {
+    auto& position = response.positions[i];
+    position.value = values[i];
+    position.weight = weights[i];
+    by_unit[position.price_unit_id] += values[i];
+  }
+  for (const auto& [unit_id, value] : by_unit) {
+    response.exposures.push_back(
+        {unit_id, value,
+         response.total_value == 0.0 ? 0.0 : value / response.total_value});
+  }
+  return response;
+}
+
+}  // namespace UseCases
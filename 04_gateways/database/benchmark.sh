@@ -0,0 +1,74 @@
+#!/bin/bash
+# =============================================================================
+# benchmark.sh - Build and run the benchmarks, results as JSON
+#
+# Writes build-bench/benchmarks.json; extra arguments go to the benchmark
+# binary, e.g. ./benchmark.sh --benchmark_filter=BM_AddPoints
+# =============================================================================
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+IMAGE_NAME="gtest-dev:latest"
+
+# -----------------------------------------------------------------------------
+# Configuration
+# -----------------------------------------------------------------------------
+
+# Resolve absolute path for source to prevent relative path errors
+# Assumption: 'vendored' is 2 levels up from this script location
+SOURCE_DB_PATH="${SCRIPT_DIR}/../../90_vendored/database/sqlite3"
+
+# Destination relative to where the script is executed (CWD)
+# This matches the Docker volume mount logic (-v $(pwd):/project)
+DEST_PARENT_DIR="./integration"
+DEST_DB_PATH="${DEST_PARENT_DIR}/sqlite3"
+
+# -----------------------------------------------------------------------------
+# Setup & Cleanup
+# -----------------------------------------------------------------------------
+
+# 1. Validation: Ensure source exists
+if [[ ! -d "${SOURCE_DB_PATH}" ]]; then
+    echo "Error: Source database not found at: ${SOURCE_DB_PATH}"
+    exit 1
+fi
+
+# 2. Setup: Copy folder
+echo "📂 Copying database to integration folder..."
+cp -r "${SOURCE_DB_PATH}" "${DEST_PARENT_DIR}/"
+
+# 3. Cleanup: Define function to remove the folder on exit
+cleanup() {
+    echo "🧹 Cleaning up integration artifacts..."
+    # Only remove the specific 'database' folder we copied, not the whole integration dir
+    rm -rf "${DEST_DB_PATH}"
+}
+
+# Register the trap to run on EXIT (happens on success, error, or interrupt)
+trap cleanup EXIT
+
+# -----------------------------------------------------------------------------
+# Main Execution
+# -----------------------------------------------------------------------------
+
+# Build image if it doesn't exist
+if [[ "$(docker images -q ${IMAGE_NAME} 2> /dev/null)" == "" ]]; then
+    echo "Image not found. Building..."
+    "${SCRIPT_DIR}/build.sh"
+fi
+
+echo "Running benchmarks..."
+docker run --rm \
+    -v "$(pwd):/project" \
+    -w /project \
+    "${IMAGE_NAME}" \
+    bash -c "
+        mkdir -p build-bench &&
+        cd build-bench &&
+        cmake .. -DCMAKE_BUILD_TYPE=Release -DENABLE_TESTING=OFF \\
+            -DENABLE_COVERAGE=OFF -DENABLE_BENCHMARKS=ON &&
+        make -j\$(nproc) sqlite3_connector_benchmarks &&
+        ./sqlite3_connector_benchmarks --benchmark_out=benchmarks.json \\
+            --benchmark_out_format=json $*
+    "
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Database {
+namespace {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+// Rows shaped like the timeseries table: asset_id, timestamp_ms,
+// unit_id, value
+std::vector<std::vector<DbValue>> makeTicks(int64_t count) {
+  std::vector<std::vector<DbValue>> rows;
+  rows.reserve(static_cast<size_t>(count));
+  for (int64_t i = 0; i < count; ++i) {
+    rows.push_back({std::string("BTC"), i, std::string("USD"),
+                    static_cast<double>(i) * 0.5});
+  }
+  return rows;
+}
+
+// ============================================================
+// bulkInsert: single-row steps vs multi-row VALUES chunks
+// ============================================================
+
+// range(0): rows to insert, range(1): rows per statement (0 = auto)
+void BM_BulkInsert(benchmark::State& state) {
+  const auto rows = makeTicks(state.range(0));
+  const std::vector<std::string> columns = {"asset_id", "timestamp_ms",
+                                            "unit_id", "value"};
+
+  SqliteDatabase db(":memory:");
+  db.setBulkInsertChunkRows(static_cast<size_t>(state.range(1)));
+  db.execute(
+      "CREATE TABLE timeseries (asset_id TEXT NOT NULL, "
+      "timestamp_ms INTEGER NOT NULL, unit_id TEXT NOT NULL, "
+      "value REAL NOT NULL)");
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    db.execute("DELETE FROM timeseries");
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(db.bulkInsert("timeseries", columns, rows));
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["chunk_rows"] =
+      static_cast<double>(db.bulkInsertChunkRows(columns.size()));
+}
+
+BENCHMARK(BM_BulkInsert)
+    ->ArgNames({"rows", "chunk"})
+    ->ArgsProduct({{10000, 100000}, {1, 16, 64, 256, 0}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace Gateways::Database
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Database {
+namespace {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+constexpr const char* kRangeQuery =
+    "SELECT asset_id, timestamp_ms, unit_id, value FROM timeseries";
+
+// In-memory timeseries table holding count rows
+void fillTicks(SqliteDatabase& db, int64_t count) {
+  db.execute(
+      "CREATE TABLE timeseries (asset_id TEXT NOT NULL, "
+      "timestamp_ms INTEGER NOT NULL, unit_id TEXT NOT NULL, "
+      "value REAL NOT NULL)");
+
+  std::vector<std::vector<DbValue>> rows;
+  rows.reserve(static_cast<size_t>(count));
+  for (int64_t i = 0; i < count; ++i) {
+    rows.push_back({std::string("asset_with_a_long_identifier"), i,
+                    std::string("unit_with_a_long_identifier"),
+                    static_cast<double>(i) * 0.5});
+  }
+  db.bulkInsert("timeseries", {"asset_id", "timestamp_ms", "unit_id", "value"},
+                rows);
+}
+
+// ============================================================
+// Range read: DbResult vs ArenaResult
+// ============================================================
+
+// range(0): rows read per iteration
+void BM_QueryDbResult(benchmark::State& state) {
+  SqliteDatabase db(":memory:");
+  fillTicks(db, state.range(0));
+
+  for (auto _ : state) {
+    DbResult result = db.query(kRangeQuery);
+    benchmark::DoNotOptimize(result.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_QueryArenaResult(benchmark::State& state) {
+  SqliteDatabase db(":memory:");
+  fillTicks(db, state.range(0));
+
+  for (auto _ : state) {
+    ArenaResult result;
+    benchmark::DoNotOptimize(db.queryInto(kRangeQuery, result));
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_QueryDbResult)
+    ->ArgName("rows")
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_QueryArenaResult)
+    ->ArgName("rows")
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace Gateways::Database
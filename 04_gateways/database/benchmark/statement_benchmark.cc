@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Database {
+namespace {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+void createTicks(SqliteDatabase& db) {
+  db.execute(
+      "CREATE TABLE timeseries (asset_id TEXT NOT NULL, "
+      "timestamp_ms INTEGER NOT NULL, unit_id TEXT NOT NULL, "
+      "value REAL NOT NULL, PRIMARY KEY (asset_id, timestamp_ms))");
+}
+
+std::vector<std::vector<DbValue>> makeTicks(int64_t count) {
+  std::vector<std::vector<DbValue>> rows;
+  rows.reserve(static_cast<size_t>(count));
+  for (int64_t i = 0; i < count; ++i) {
+    rows.push_back({std::string("BTC"), i, std::string("USD"),
+                    static_cast<double>(i) * 0.5});
+  }
+  return rows;
+}
+
+constexpr const char* kInsertTick =
+    "INSERT INTO timeseries (asset_id, timestamp_ms, unit_id, value) "
+    "VALUES (?, ?, ?, ?)";
+
+// ============================================================
+// SqliteStatement::execute: one prepared point lookup, rebound
+// ============================================================
+
+// range(0): rows in the table; each iteration finds one by key
+void BM_StatementExecutePointLookup(benchmark::State& state) {
+  SqliteDatabase db(":memory:");
+  createTicks(db);
+  db.bulkInsert("timeseries", {"asset_id", "timestamp_ms", "unit_id", "value"},
+                makeTicks(state.range(0)));
+  auto stmt = db.prepare(
+      "SELECT value FROM timeseries WHERE asset_id = ? AND timestamp_ms = ?");
+
+  int64_t key = 0;
+  for (auto _ : state) {
+    stmt->reset();
+    stmt->bind(1, std::string("BTC")).bind(2, key++ % state.range(0));
+    benchmark::DoNotOptimize(stmt->execute());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// range(0): rows one execute() returns
+void BM_StatementExecuteRange(benchmark::State& state) {
+  SqliteDatabase db(":memory:");
+  createTicks(db);
+  db.bulkInsert("timeseries", {"asset_id", "timestamp_ms", "unit_id", "value"},
+                makeTicks(state.range(0)));
+  auto stmt = db.prepare(
+      "SELECT asset_id, timestamp_ms, unit_id, value FROM timeseries "
+      "WHERE asset_id = ? ORDER BY timestamp_ms");
+
+  for (auto _ : state) {
+    stmt->reset();
+    stmt->bind(1, std::string("BTC"));
+    benchmark::DoNotOptimize(stmt->execute());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_StatementExecutePointLookup)
+    ->ArgName("rows")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000);
+BENCHMARK(BM_StatementExecuteRange)
+    ->ArgName("rows")
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+// ============================================================
+// executeBatch vs a bind/execute loop, in one transaction
+// ============================================================
+
+// range(0): rows to insert
+void BM_InsertLoop(benchmark::State& state) {
+  const auto rows = makeTicks(state.range(0));
+  SqliteDatabase db(":memory:");
+  createTicks(db);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    db.execute("DELETE FROM timeseries");
+    state.ResumeTiming();
+
+    db.beginTransaction();
+    auto stmt = db.prepare(kInsertTick);
+    auto* sqliteStmt = static_cast<SqliteStatement*>(stmt.get());
+    for (const auto& row : rows) {
+      sqliteStmt->reset();
+      for (size_t i = 0; i < row.size(); ++i) {
+        sqliteStmt->bindValue(static_cast<int>(i + 1), row[i]);
+      }
+      sqliteStmt->execute();
+    }
+    db.commit();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ExecuteBatch(benchmark::State& state) {
+  const auto rows = makeTicks(state.range(0));
+  SqliteDatabase db(":memory:");
+  createTicks(db);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    db.execute("DELETE FROM timeseries");
+    state.ResumeTiming();
+
+    db.beginTransaction();
+    auto stmt = db.prepare(kInsertTick);
+    benchmark::DoNotOptimize(
+        static_cast<SqliteStatement*>(stmt.get())->executeBatch(rows));
+    db.commit();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_InsertLoop)
+    ->ArgName("rows")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExecuteBatch)
+    ->ArgName("rows")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace Gateways::Database
@@ -1,10 +1,19 @@
 #ifndef GATEWAYS_DATABASE_DATABASE_CONNECTOR_H_
 #define GATEWAYS_DATABASE_DATABASE_CONNECTOR_H_
 
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -19,6 +28,56 @@ using DbValue = std::variant<std::nullptr_t, int64_t, double, std::string,
 using DbRow = std::vector<DbValue>;
 using DbResult = std::vector<DbRow>;
 
+// Non-owning view over a contiguous byte buffer
+class BlobView {
+ public:
+  constexpr BlobView() = default;
+  constexpr BlobView(const uint8_t* data, size_t size)
+      : m_data(data), m_size(size) {}
+  BlobView(const std::vector<uint8_t>& blob)  // NOLINT: implicit by design
+      : m_data(blob.data()), m_size(blob.size()) {}
+
+  constexpr const uint8_t* data() const { return m_data; }
+  constexpr size_t size() const { return m_size; }
+  constexpr bool empty() const { return m_size == 0; }
+  constexpr const uint8_t* begin() const { return m_data; }
+  constexpr const uint8_t* end() const { return m_data + m_size; }
+
+ private:
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+// ============================================================
+// Columnar Results
+// ============================================================
+
+enum class ColumnKind { Int64, Double };
+
+// One numeric result column stored contiguously. Only the vector matching
+// kind is filled; NULL cells hold 0 and have their bit set in nullBits
+// (bit i % 64 of word i / 64 for row i).
+struct NumericColumn {
+  ColumnKind kind = ColumnKind::Int64;
+  std::vector<int64_t> int64s;
+  std::vector<double> doubles;
+  std::vector<uint64_t> nullBits;
+  size_t nullCount = 0;
+
+  size_t size() const {
+    return kind == ColumnKind::Int64 ? int64s.size() : doubles.size();
+  }
+  bool isNull(size_t row) const {
+    return (nullBits[row / 64] >> (row % 64)) & 1u;
+  }
+};
+
+// Column-major result of a numeric query, one column per result column
+struct ColumnarResult {
+  std::vector<NumericColumn> columns;
+  size_t rowCount = 0;
+};
+
 // ============================================================
 // Exceptions
 // ============================================================
@@ -41,10 +100,28 @@ class QueryException : public DatabaseException {
       : DatabaseException("Query error: " + msg) {}
 };
 
+// A write rejected by a PRIMARY KEY, UNIQUE, NOT NULL, CHECK or FOREIGN
+// KEY constraint. what() carries the driver's message, which names the
+// constraint, e.g. "UNIQUE constraint failed: accounts.name".
+class ConstraintException : public QueryException {
+ public:
+  explicit ConstraintException(const std::string& msg) : QueryException(msg) {}
+};
+
 // ============================================================
 // IStatement Interface
 // ============================================================
 
+class RowView;
+class RowRange;
+
+// Invoked once per row by the streaming query APIs. The row and any
+// text/blob views taken from it are only valid during the call.
+using RowCallback = std::function<void(const RowView&)>;
+
+// Told whether the transaction it was queued in committed
+using TransactionEndAction = std::function<void(bool committed)>;
+
 class IStatement {
  public:
   virtual ~IStatement() = default;
@@ -56,13 +133,411 @@ class IStatement {
   virtual IStatement& bind(int index, const std::string& value) = 0;
   virtual IStatement& bind(int index, const std::vector<uint8_t>& blob) = 0;
 
+  // Zero-copy binds: the bytes are borrowed, not copied. The caller must
+  // keep them alive and unchanged until the parameter is rebound or the
+  // statement is destroyed.
+  virtual IStatement& bindStatic(int index, std::string_view value) = 0;
+  virtual IStatement& bindStatic(int index, BlobView blob) = 0;
+
   // Execution
   virtual DbResult execute() = 0;
   virtual int64_t executeInsert() = 0;
   virtual int executeUpdate() = 0;
   virtual void reset() = 0;
+
+  // Forward-only cursor: advances to the next row, false when exhausted.
+  // Column accessors (0-based) read the current row in place; text and
+  // blob views stay valid until the next step() or reset().
+  virtual bool step() = 0;
+  virtual int columnCount() const = 0;
+  virtual bool columnIsNull(int col) const = 0;
+  virtual int64_t columnInt64(int col) const = 0;
+  virtual double columnDouble(int col) const = 0;
+  virtual std::string_view columnText(int col) const = 0;
+  virtual BlobView columnBlob(int col) const = 0;
+  virtual DbValue columnValue(int col) const = 0;
+
+  // Range over the remaining rows: for (const RowView& row : stmt->rows())
+  RowRange rows();
+
+  // Steps through all remaining rows. Returns the number of rows visited.
+  size_t forEachRow(const RowCallback& callback);
+
+  // Typed extraction (no DbValue variants). Columns are decoded in order
+  // through ColumnReader<T>; e.g. fetch<std::string, int64_t, double>().
+  template <typename... Ts>
+  std::vector<std::tuple<Ts...>> fetch();
+  template <typename... Ts>
+  std::optional<std::tuple<Ts...>> fetchOne();
+  template <typename T>
+  std::optional<T> fetchScalar();
+
+  // Row mapping: mapper(const RowView&) builds one T per row, so entities
+  // are filled straight from the statement.
+  template <typename T, typename Mapper>
+  std::vector<T> mapRows(Mapper&& mapper);
+  template <typename T, typename Mapper>
+  std::optional<T> mapOne(Mapper&& mapper);
+
+  // Columnar extraction for numeric queries. kinds sets each column's
+  // starting kind (default Int64); an Int64 column that yields a REAL
+  // value converts to Double. Throws QueryException on text or blobs.
+  ColumnarResult fetchColumns(const std::vector<ColumnKind>& kinds = {});
+};
+
+// ============================================================
+// Row Cursor
+// ============================================================
+
+// Lightweight handle on the current row of a stepping statement
+class RowView {
+ public:
+  explicit RowView(const IStatement* stmt) : m_stmt(stmt) {}
+
+  int columnCount() const { return m_stmt->columnCount(); }
+  bool isNull(int col) const { return m_stmt->columnIsNull(col); }
+  int64_t getInt64(int col) const { return m_stmt->columnInt64(col); }
+  double getDouble(int col) const { return m_stmt->columnDouble(col); }
+  std::string_view getText(int col) const { return m_stmt->columnText(col); }
+  BlobView getBlob(int col) const { return m_stmt->columnBlob(col); }
+  DbValue getValue(int col) const { return m_stmt->columnValue(col); }
+
+  // Typed access through ColumnReader<T>
+  template <typename T>
+  T get(int col) const;
+
+  // Decodes the first sizeof...(Ts) columns into a tuple
+  template <typename... Ts>
+  std::tuple<Ts...> as() const {
+    return asImpl<Ts...>(std::index_sequence_for<Ts...>{});
+  }
+
+ private:
+  template <typename... Ts, size_t... Is>
+  std::tuple<Ts...> asImpl(std::index_sequence<Is...>) const {
+    return std::tuple<Ts...>(get<Ts>(static_cast<int>(Is))...);
+  }
+
+  const IStatement* m_stmt;
+};
+
+// ============================================================
+// Column Readers
+// ============================================================
+
+// Decodes one column of the current row into T. NULL reads as the
+// empty/zero value unless T is std::optional.
+template <typename T>
+struct ColumnReader;
+
+template <>
+struct ColumnReader<int64_t> {
+  static int64_t read(const RowView& row, int col) {
+    return row.getInt64(col);
+  }
+};
+
+template <>
+struct ColumnReader<int> {
+  static int read(const RowView& row, int col) {
+    return static_cast<int>(row.getInt64(col));
+  }
+};
+
+template <>
+struct ColumnReader<bool> {
+  static bool read(const RowView& row, int col) {
+    return row.getInt64(col) != 0;
+  }
+};
+
+template <>
+struct ColumnReader<double> {
+  static double read(const RowView& row, int col) {
+    return row.getDouble(col);
+  }
+};
+
+template <>
+struct ColumnReader<std::string> {
+  static std::string read(const RowView& row, int col) {
+    return std::string(row.getText(col));
+  }
+};
+
+// Borrowed: valid until the statement steps again
+template <>
+struct ColumnReader<std::string_view> {
+  static std::string_view read(const RowView& row, int col) {
+    return row.getText(col);
+  }
+};
+
+template <>
+struct ColumnReader<std::vector<uint8_t>> {
+  static std::vector<uint8_t> read(const RowView& row, int col) {
+    BlobView blob = row.getBlob(col);
+    return std::vector<uint8_t>(blob.begin(), blob.end());
+  }
+};
+
+// Borrowed: valid until the statement steps again
+template <>
+struct ColumnReader<BlobView> {
+  static BlobView read(const RowView& row, int col) {
+    return row.getBlob(col);
+  }
+};
+
+template <>
+struct ColumnReader<DbValue> {
+  static DbValue read(const RowView& row, int col) {
+    return row.getValue(col);
+  }
 };
 
+template <typename T>
+struct ColumnReader<std::optional<T>> {
+  static std::optional<T> read(const RowView& row, int col) {
+    if (row.isNull(col)) {
+      return std::nullopt;
+    }
+    return ColumnReader<T>::read(row, col);
+  }
+};
+
+template <typename T>
+T RowView::get(int col) const {
+  return ColumnReader<T>::read(*this, col);
+}
+
+// Single-pass input iterator; each increment calls IStatement::step()
+class RowIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = RowView;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const RowView*;
+  using reference = const RowView&;
+
+  RowIterator() : m_stmt(nullptr), m_row(nullptr) {}
+  explicit RowIterator(IStatement* stmt) : m_stmt(stmt), m_row(stmt) {
+    advance();
+  }
+
+  reference operator*() const { return m_row; }
+  pointer operator->() const { return &m_row; }
+
+  RowIterator& operator++() {
+    advance();
+    return *this;
+  }
+
+  bool operator==(const RowIterator& other) const {
+    return m_stmt == other.m_stmt;
+  }
+  bool operator!=(const RowIterator& other) const { return !(*this == other); }
+
+ private:
+  void advance() {
+    if (m_stmt && !m_stmt->step()) {
+      m_stmt = nullptr;
+    }
+  }
+
+  IStatement* m_stmt;
+  RowView m_row;
+};
+
+class RowRange {
+ public:
+  explicit RowRange(IStatement* stmt) : m_stmt(stmt) {}
+
+  RowIterator begin() { return RowIterator(m_stmt); }
+  RowIterator end() { return RowIterator(); }
+
+ private:
+  IStatement* m_stmt;
+};
+
+inline RowRange IStatement::rows() { return RowRange(this); }
+
+inline size_t IStatement::forEachRow(const RowCallback& callback) {
+  size_t count = 0;
+  RowView row(this);
+  while (step()) {
+    callback(row);
+    ++count;
+  }
+  return count;
+}
+
+template <typename... Ts>
+std::vector<std::tuple<Ts...>> IStatement::fetch() {
+  std::vector<std::tuple<Ts...>> result;
+  RowView row(this);
+  while (step()) {
+    result.push_back(row.as<Ts...>());
+  }
+  return result;
+}
+
+template <typename... Ts>
+std::optional<std::tuple<Ts...>> IStatement::fetchOne() {
+  if (!step()) {
+    return std::nullopt;
+  }
+  return RowView(this).as<Ts...>();
+}
+
+template <typename T>
+std::optional<T> IStatement::fetchScalar() {
+  if (!step()) {
+    return std::nullopt;
+  }
+  return RowView(this).get<T>(0);
+}
+
+template <typename T, typename Mapper>
+std::vector<T> IStatement::mapRows(Mapper&& mapper) {
+  std::vector<T> result;
+  RowView row(this);
+  while (step()) {
+    result.push_back(mapper(row));
+  }
+  return result;
+}
+
+template <typename T, typename Mapper>
+std::optional<T> IStatement::mapOne(Mapper&& mapper) {
+  if (!step()) {
+    return std::nullopt;
+  }
+  return mapper(RowView(this));
+}
+
+inline ColumnarResult IStatement::fetchColumns(
+    const std::vector<ColumnKind>& kinds) {
+  ColumnarResult result;
+  result.columns.resize(static_cast<size_t>(columnCount()));
+  for (size_t col = 0; col < kinds.size() && col < result.columns.size();
+       ++col) {
+    result.columns[col].kind = kinds[col];
+  }
+
+  while (step()) {
+    const size_t row = result.rowCount++;
+    if (row % 64 == 0) {
+      for (auto& column : result.columns) {
+        column.nullBits.push_back(0);
+      }
+    }
+
+    for (size_t col = 0; col < result.columns.size(); ++col) {
+      NumericColumn& column = result.columns[col];
+      DbValue value = columnValue(static_cast<int>(col));
+
+      if (std::holds_alternative<std::nullptr_t>(value)) {
+        column.nullBits[row / 64] |= uint64_t{1} << (row % 64);
+        ++column.nullCount;
+      } else if (std::holds_alternative<double>(value) &&
+                 column.kind == ColumnKind::Int64) {
+        column.doubles.assign(column.int64s.begin(), column.int64s.end());
+        column.int64s.clear();
+        column.int64s.shrink_to_fit();
+        column.kind = ColumnKind::Double;
+      } else if (!std::holds_alternative<int64_t>(value) &&
+                 !std::holds_alternative<double>(value)) {
+        throw QueryException("Non-numeric value in column " +
+                             std::to_string(col));
+      }
+
+      if (column.kind == ColumnKind::Int64) {
+        const int64_t* number = std::get_if<int64_t>(&value);
+        column.int64s.push_back(number ? *number : 0);
+      } else if (const double* real = std::get_if<double>(&value)) {
+        column.doubles.push_back(*real);
+      } else {
+        const int64_t* number = std::get_if<int64_t>(&value);
+        column.doubles.push_back(number ? static_cast<double>(*number) : 0.0);
+      }
+    }
+  }
+  return result;
+}
+
+// ============================================================
+// Key Sets
+// ============================================================
+
+// Set-based lookups bind all keys as one JSON array and join against
+// json_each(?), whose key column is the array index:
+//   SELECT k.key, t.* FROM json_each(?) AS k JOIN t ON t.id = k.value
+inline void appendJsonString(std::string& out, std::string_view text) {
+  out.push_back('"');
+  for (char ch : text) {
+    switch (ch) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(ch) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                        static_cast<unsigned>(ch));
+          out += escaped;
+        } else {
+          out.push_back(ch);
+        }
+    }
+  }
+  out.push_back('"');
+}
+
+// Throws QueryException for blobs and non-finite reals
+inline std::string toJsonArray(const std::vector<DbValue>& values) {
+  std::string out = "[";
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i > 0) {
+      out.push_back(',');
+    }
+    const DbValue& value = values[i];
+    if (const auto* number = std::get_if<int64_t>(&value)) {
+      out += std::to_string(*number);
+    } else if (const auto* real = std::get_if<double>(&value)) {
+      if (!std::isfinite(*real)) {
+        throw QueryException("Key set cannot hold a non-finite real");
+      }
+      char buffer[32];
+      std::snprintf(buffer, sizeof(buffer), "%.17g", *real);
+      out += buffer;
+    } else if (const auto* text = std::get_if<std::string>(&value)) {
+      appendJsonString(out, *text);
+    } else if (std::holds_alternative<std::nullptr_t>(value)) {
+      out += "null";
+    } else {
+      throw QueryException("Key set cannot hold a blob");
+    }
+  }
+  out.push_back(']');
+  return out;
+}
+
+inline std::string toJsonArray(const std::vector<std::string>& values) {
+  std::string out = "[";
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i > 0) {
+      out.push_back(',');
+    }
+    appendJsonString(out, values[i]);
+  }
+  out.push_back(']');
+  return out;
+}
+
 // ============================================================
 // IDatabase Interface
 // ============================================================
@@ -83,16 +558,102 @@ class IDatabase {
   virtual void execute(const std::string& sql) = 0;
   virtual DbResult query(const std::string& sql) = 0;
 
+  // Streaming query: rows are stepped lazily and passed to callback
+  // without materializing a DbResult. Returns the number of rows.
+  virtual size_t query(const std::string& sql, const RowCallback& callback) = 0;
+
   // Transaction control
   virtual void beginTransaction() = 0;
   virtual void commit() = 0;
   virtual void rollback() = 0;
 
+  // Calls action(true) once the outermost transaction open on the
+  // calling thread commits, or action(false) once the transaction or
+  // savepoint open now rolls back; outside a transaction, action(true)
+  // at once. For state that must only see committed rows, such as
+  // caches. The default knows of no transactions.
+  virtual void onTransactionEnd(TransactionEndAction action) { action(true); }
+
   // Metadata
   virtual int64_t lastInsertRowId() const = 0;
   virtual int changesCount() const = 0;
 };
 
+// ============================================================
+// Schema Migrations
+// ============================================================
+
+// Step i of a schema's migrations takes it from version i to i + 1
+using Migration = std::function<void(IDatabase&)>;
+
+// Version recorded for schema by migrateSchema(); 0 if none
+inline int64_t schemaVersion(IDatabase& db, const std::string& schema) {
+  // Finalized before the next prepare(), so a pool lends one connection
+  // at a time
+  {
+    auto table = db.prepare(
+        "SELECT 1 FROM sqlite_master WHERE type = 'table' "
+        "AND name = 'schema_versions'");
+    if (!table->fetchScalar<int64_t>()) {
+      return 0;
+    }
+  }
+  auto stmt =
+      db.prepare("SELECT version FROM schema_versions WHERE schema = ?");
+  stmt->bind(1, schema);
+  return stmt->fetchScalar<int64_t>().value_or(0);
+}
+
+// Brings schema up to version migrations.size(): the steps past the
+// recorded version run in one transaction, which also records the new
+// version, so a failing step leaves the schema as it was. A current
+// schema costs two reads and no transaction. Versions are kept per
+// schema in schema_versions rather than in PRAGMA user_version, because
+// several repositories share a database file. Returns the number of
+// steps applied; throws DatabaseException if the database is at a
+// version newer than migrations knows.
+inline size_t migrateSchema(IDatabase& db, const std::string& schema,
+                            const std::vector<Migration>& migrations) {
+  const auto target = static_cast<int64_t>(migrations.size());
+  if (schemaVersion(db, schema) == target) {
+    return 0;
+  }
+
+  db.beginTransaction();
+  try {
+    db.execute(
+        "CREATE TABLE IF NOT EXISTS schema_versions ("
+        "schema TEXT PRIMARY KEY, version INTEGER NOT NULL)");
+    // A write first, so a second process migrating at the same time
+    // waits here and then sees this one's version
+    auto claim = db.prepare(
+        "INSERT OR IGNORE INTO schema_versions (schema, version) "
+        "VALUES (?, 0)");
+    claim->bind(1, schema);
+    claim->executeInsert();
+
+    const int64_t version = schemaVersion(db, schema);
+    if (version > target) {
+      throw DatabaseException("Schema " + schema + " is at version " +
+                              std::to_string(version) + ", newer than " +
+                              std::to_string(target));
+    }
+    for (int64_t step = version; step < target; ++step) {
+      migrations[static_cast<size_t>(step)](db);
+    }
+
+    auto record =
+        db.prepare("UPDATE schema_versions SET version = ? WHERE schema = ?");
+    record->bind(1, target).bind(2, schema);
+    record->executeUpdate();
+    db.commit();
+    return static_cast<size_t>(target - version);
+  } catch (...) {
+    db.rollback();
+    throw;
+  }
+}
+
 }  // namespace Gateways::Database
 
 #endif  // GATEWAYS_DATABASE_DATABASE_CONNECTOR_H_
@@ -0,0 +1,138 @@
+#ifndef GATEWAYS_DATABASE_MEMORY_PRIMARY_DATABASE_H_
+#define GATEWAYS_DATABASE_MEMORY_PRIMARY_DATABASE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "database_connector.h"
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Database {
+
+// ============================================================
+// MemoryPrimaryOptions
+// ============================================================
+
+// The durability window: committed changes reach the file at most
+// flushInterval after they were made, or sooner once dirtyChangeThreshold
+// rows have changed since the last checkpoint.
+struct MemoryPrimaryOptions {
+  std::chrono::milliseconds flushInterval{1000};
+  // Changed rows (sqlite3_total_changes) that force an early checkpoint;
+  // 0 flushes on the interval only
+  uint64_t dirtyChangeThreshold = 10000;
+  // How often the flusher checks the change counter
+  std::chrono::milliseconds pollInterval{20};
+  // Pages per step when writing the snapshot to disk
+  int pagesPerStep = 1024;
+};
+
+struct MemoryPrimaryStats {
+  uint64_t checkpoints = 0;
+  uint64_t failedCheckpoints = 0;
+  uint64_t skippedCheckpoints = 0;  // deferred by an open transaction
+  uint64_t pendingChanges = 0;      // changed rows not yet on disk
+  std::chrono::microseconds lastSnapshotTime{0};  // primary blocked
+  std::chrono::microseconds lastWriteTime{0};     // snapshot to disk
+  std::string lastError;
+};
+
+// ============================================================
+// MemoryPrimaryDatabase - :memory: primary with durable checkpoints
+// ============================================================
+
+// Loads the on-disk database into an in-memory connection at open() and
+// serves every IDatabase call from memory. A background thread checkpoints
+// to the file: it copies the primary into a second in-memory snapshot in
+// one backup step (the only time the primary is blocked), then writes the
+// snapshot to disk in batches. The file is only ever rewritten inside a
+// backup transaction, so a crash leaves the previous checkpoint intact.
+//
+// A checkpoint never captures an open transaction; it is deferred until
+// the transaction ends. Schema-only changes do not move the change
+// counter and are persisted by the next checkpoint, data change or
+// close(). close() always writes a final checkpoint.
+class MemoryPrimaryDatabase : public IDatabase {
+ public:
+  MemoryPrimaryDatabase() = default;
+  explicit MemoryPrimaryDatabase(const std::string& path,
+                                 const MemoryPrimaryOptions& options = {});
+  ~MemoryPrimaryDatabase() override;
+
+  MemoryPrimaryDatabase(const MemoryPrimaryDatabase&) = delete;
+  MemoryPrimaryDatabase& operator=(const MemoryPrimaryDatabase&) = delete;
+  MemoryPrimaryDatabase(MemoryPrimaryDatabase&&) = delete;
+  MemoryPrimaryDatabase& operator=(MemoryPrimaryDatabase&&) = delete;
+
+  // Connection
+  void open(const std::string& path) override;
+  void close() override;
+  bool isOpen() const override;
+
+  // Takes effect at the next open()
+  void setOptions(const MemoryPrimaryOptions& options);
+
+  // Statement preparation
+  std::unique_ptr<IStatement> prepare(const std::string& sql) override;
+
+  // Direct execution
+  void execute(const std::string& sql) override;
+  DbResult query(const std::string& sql) override;
+  size_t query(const std::string& sql, const RowCallback& callback) override;
+
+  // Transaction control
+  void beginTransaction() override;
+  void commit() override;
+  void rollback() override;
+  void onTransactionEnd(TransactionEndAction action) override;
+
+  // Metadata
+  int64_t lastInsertRowId() const override;
+  int changesCount() const override;
+
+  // Writes a checkpoint now. Returns false if it was deferred by an open
+  // transaction. Throws DatabaseException if the write fails.
+  bool checkpoint();
+
+  MemoryPrimaryStats stats() const;
+  const std::string& path() const { return m_path; }
+
+  // The in-memory connection, for SqliteDatabase-only features. Calls on
+  // it bypass the checkpoint coordination.
+  SqliteDatabase& primary() { return m_primary; }
+
+ private:
+  void requireOpen() const;
+  void startFlusher();
+  void stopFlusher();
+  void runFlusher();
+  bool writeCheckpoint();
+  uint64_t totalChanges() const;
+
+  MemoryPrimaryOptions m_options;
+  std::string m_path;
+  SqliteDatabase m_primary;
+
+  // Held by transaction calls and by the snapshot step, so a snapshot
+  // never starts inside a transaction boundary
+  mutable std::recursive_mutex m_primaryMutex;
+  // Serializes checkpoints (flusher thread vs checkpoint())
+  std::mutex m_checkpointMutex;
+
+  mutable std::mutex m_stateMutex;
+  std::condition_variable m_wake;
+  bool m_stopping = false;
+  uint64_t m_flushedChanges = 0;  // totalChanges() at the last snapshot
+  MemoryPrimaryStats m_stats;
+  std::thread m_flusher;
+};
+
+}  // namespace Gateways::Database
+
+#endif  // GATEWAYS_DATABASE_MEMORY_PRIMARY_DATABASE_H_
@@ -1,8 +1,20 @@
 #ifndef GATEWAYS_DATABASE_SQLITE3_DATABASE_CONNECTOR_H_
 #define GATEWAYS_DATABASE_SQLITE3_DATABASE_CONNECTOR_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <random>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "database_connector.h"
@@ -10,6 +22,300 @@
 
 namespace Gateways::Database {
 
+// ============================================================
+// StatementCache - LRU cache of prepared statements
+// ============================================================
+
+struct StatementCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t size = 0;
+  size_t capacity = 0;
+};
+
+// Keeps idle sqlite3_stmt handles keyed by SQL text so repeated
+// prepare() calls skip sqlite3_prepare_v2. A statement is removed from
+// the cache while checked out and handed back (reset, bindings cleared)
+// when its SqliteStatement is destroyed. Capacity 0 disables caching.
+class StatementCache {
+ public:
+  explicit StatementCache(size_t capacity);
+  ~StatementCache();
+
+  StatementCache(const StatementCache&) = delete;
+  StatementCache& operator=(const StatementCache&) = delete;
+
+  // Returns an idle statement for sql, or nullptr on a miss
+  sqlite3_stmt* acquire(const std::string& sql);
+
+  // Returns a statement to the cache; finalizes it if it cannot be kept
+  void release(const std::string& sql, sqlite3_stmt* stmt);
+
+  void setCapacity(size_t capacity);
+  void clear();
+  StatementCacheStats stats() const;
+
+ private:
+  struct Entry {
+    std::string sql;
+    sqlite3_stmt* stmt;
+  };
+
+  void evictOverflow();
+
+  mutable std::mutex m_mutex;
+  std::list<Entry> m_lru;  // front = most recently released
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  size_t m_capacity;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+  uint64_t m_evictions = 0;
+};
+
+// ============================================================
+// QueryProfiler - per-SQL latency and planner counters
+// ============================================================
+
+// Aggregate for one SQL text. Latencies are wall-clock time from the
+// first step to completion (SQLITE_DONE, reset or finalize); p50/p99 come
+// from a bounded reservoir sample. Planner counters are the
+// sqlite3_stmt_status() deltas summed over all runs.
+struct QueryProfile {
+  std::string sql;
+  uint64_t calls = 0;
+  uint64_t rows = 0;  // result rows returned
+  std::chrono::nanoseconds totalTime{0};
+  std::chrono::nanoseconds maxTime{0};
+  std::chrono::nanoseconds p50{0};
+  std::chrono::nanoseconds p99{0};
+  uint64_t fullscanSteps = 0;
+  uint64_t sorts = 0;
+  uint64_t autoindexes = 0;
+  uint64_t vmSteps = 0;
+};
+
+// One run that took at least the slow-query threshold
+struct SlowQuery {
+  std::string sql;
+  std::chrono::nanoseconds elapsed{0};
+  uint64_t rows = 0;
+  uint64_t fullscanSteps = 0;
+  uint64_t sorts = 0;
+  uint64_t autoindexes = 0;
+};
+
+using SlowQueryCallback = std::function<void(const SlowQuery&)>;
+
+// Collects QueryProfile entries from sqlite3_trace_v2 events on attached
+// connections. Keys are the SQL as prepared, so bound values never reach
+// the profile or the slow-query log. The slow-query callback runs on the
+// thread that finished the statement and must not use that connection.
+class QueryProfiler {
+ public:
+  static constexpr size_t kLatencySamples = 1024;
+  static constexpr size_t kSlowQueryLogCapacity = 128;
+
+  QueryProfiler() = default;
+  ~QueryProfiler() = default;
+
+  QueryProfiler(const QueryProfiler&) = delete;
+  QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+  void attach(sqlite3* db);
+  void detach(sqlite3* db);
+
+  // Runs at or above threshold are kept (last kSlowQueryLogCapacity) and
+  // passed to callback. A threshold of zero disables the log.
+  void setSlowQueryLog(std::chrono::nanoseconds threshold,
+                       SlowQueryCallback callback = nullptr);
+
+  // Sorted by total time, most expensive first
+  std::vector<QueryProfile> snapshot() const;
+  std::vector<SlowQuery> slowQueries() const;
+  void reset();
+
+ private:
+  struct Running {
+    std::chrono::steady_clock::time_point start;
+    uint64_t rows = 0;
+  };
+
+  struct Entry {
+    QueryProfile profile;
+    std::vector<int64_t> samples;  // nanoseconds
+  };
+
+  static int onTrace(unsigned type, void* context, void* p, void* x);
+  void onStart(sqlite3_stmt* stmt);
+  void onRow(sqlite3_stmt* stmt);
+  void onProfile(sqlite3_stmt* stmt, int64_t sqliteNanos);
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<sqlite3_stmt*, Running> m_running;
+  std::unordered_map<std::string, Entry> m_entries;
+  std::list<SlowQuery> m_slowQueries;  // front = oldest
+  std::chrono::nanoseconds m_slowThreshold{0};
+  SlowQueryCallback m_slowCallback;
+  std::minstd_rand m_random;
+};
+
+// ============================================================
+// ChangeNotifier - committed row changes, batched per transaction
+// ============================================================
+
+enum class ChangeOp { Insert, Update, Delete };
+
+struct ChangeEvent {
+  ChangeOp op;
+  std::string database;  // "main", "temp" or an attached schema
+  std::string table;
+  int64_t rowid;
+};
+
+// One committed transaction's changes, each (op, table, rowid) once, in
+// the order first seen
+using ChangeCallback = std::function<void(const std::vector<ChangeEvent>&)>;
+
+// Records rows changed through sqlite3_update_hook while a transaction is
+// open and hands them to subscribers once it has committed; rolled back
+// work (including ROLLBACK TO a savepoint issued by SqliteDatabase) is
+// dropped. The hooks are only installed while someone is subscribed.
+// Delivery runs on the thread whose statement or execute() committed,
+// after that call's commit has finished, so callbacks may use the
+// connection; their own commits are delivered after the current batch.
+//
+// SQLite reports nothing for WITHOUT ROWID tables, for rows removed by
+// the DELETE-without-WHERE truncate optimization and for rows an ON
+// CONFLICT REPLACE deletes; the replacing insert is still reported.
+class ChangeNotifier {
+ public:
+  ChangeNotifier() = default;
+  ~ChangeNotifier() = default;
+
+  ChangeNotifier(const ChangeNotifier&) = delete;
+  ChangeNotifier& operator=(const ChangeNotifier&) = delete;
+
+  void attach(sqlite3* db);
+  // Drops changes not yet delivered
+  void detach(sqlite3* db);
+
+  size_t subscribe(ChangeCallback callback);
+  void unsubscribe(size_t id);
+
+  // Savepoint bookkeeping, as ROLLBACK TO fires no hook. level is the
+  // savepoint's nesting level, 1 for the first inside a transaction.
+  void savepoint(int level);
+  void releaseSavepoint(int level);
+  void rollbackToSavepoint(int level);
+
+  // Runs the callbacks for every committed batch; cheap when there are
+  // none, and a no-op when called from inside a callback
+  void deliver();
+
+ private:
+  static void onUpdate(void* context, int op, const char* database,
+                       const char* table, sqlite3_int64 rowid);
+  static int onCommit(void* context);
+  static void onRollback(void* context);
+  void installHooks(bool install);
+
+  std::mutex m_hookMutex;  // orders hook installs; never taken by hooks
+  sqlite3* m_db = nullptr;
+  bool m_hooked = false;
+
+  mutable std::mutex m_mutex;
+  std::map<size_t, ChangeCallback> m_subscribers;
+  size_t m_nextSubscriber = 0;
+  std::vector<ChangeEvent> m_pending;  // of the open transaction
+  std::vector<size_t> m_savepoints;    // m_pending size at each level
+  std::vector<std::vector<ChangeEvent>> m_committed;
+  // Leading m_committed batches seen outside a transaction since
+  size_t m_confirmed = 0;
+  std::atomic<bool> m_hasCommitted{false};
+  bool m_delivering = false;
+};
+
+// ============================================================
+// ArenaResult - row-major result in one monotonic arena
+// ============================================================
+
+// Result set whose cells, text and blob bytes all come from a single
+// std::pmr::monotonic_buffer_resource: filling it costs a handful of
+// arena blocks instead of one allocation per row, string and blob, and
+// destroying or clearing it releases everything at once. Text and blob
+// accessors return views into the arena, valid until clear().
+class ArenaResult {
+ public:
+  static constexpr size_t kDefaultInitialBytes = 16 * 1024;
+
+  explicit ArenaResult(size_t initialBytes = kDefaultInitialBytes);
+
+  ArenaResult(ArenaResult&&) noexcept = default;
+  ArenaResult& operator=(ArenaResult&&) noexcept = default;
+
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  int columnCount() const;
+
+  // Cell access (0-based). Numeric getters convert between integer and
+  // real and read other cells as 0; getText()/getBlob() return the bytes
+  // of text and blob cells and an empty view otherwise.
+  bool isNull(size_t row, int col) const;
+  int64_t getInt64(size_t row, int col) const;
+  double getDouble(size_t row, int col) const;
+  std::string_view getText(size_t row, int col) const;
+  BlobView getBlob(size_t row, int col) const;
+  DbValue getValue(size_t row, int col) const;
+
+  // Copies out into the heap-backed representation
+  DbRow row(size_t row) const;
+  DbResult toDbResult() const;
+
+  // Building. Rows are appended cell by cell; every row has columnCount()
+  // cells, fixed by the first setColumnCount() since the last clear().
+  void setColumnCount(int columns);
+  void appendNull();
+  void appendInt64(int64_t value);
+  void appendDouble(double value);
+  void appendText(std::string_view text);
+  void appendBlob(BlobView blob);
+
+  // Drops all rows and releases the arena in one call
+  void clear();
+
+ private:
+  enum class CellType : uint8_t { Null, Int64, Double, Text, Blob };
+
+  struct Cell {
+    CellType type;
+    union {
+      int64_t int64;
+      double real;
+      struct {
+        const void* data;
+        size_t size;
+      } bytes;
+    };
+  };
+
+  // Neither the resource nor a vector using it can move, so both live
+  // behind one pointer
+  struct Storage {
+    explicit Storage(size_t initialBytes);
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<Cell> cells;
+    int columns = -1;
+  };
+
+  Storage& storage();
+  const Cell& cell(size_t row, int col) const;
+  void appendBytes(CellType type, const void* data, size_t size);
+
+  size_t m_initialBytes;
+  std::unique_ptr<Storage> m_storage;
+};
+
 // ============================================================
 // SqliteStatement
 // ============================================================
@@ -17,6 +323,14 @@ namespace Gateways::Database {
 class SqliteStatement : public IStatement {
  public:
   SqliteStatement(sqlite3* db, const std::string& sql);
+  // Prepares through the cache: reuses an idle statement on a hit and
+  // hands the statement back to the cache on destruction.
+  SqliteStatement(sqlite3* db, const std::string& sql,
+                  const std::shared_ptr<StatementCache>& cache);
+  // As above, delivering committed changes to notifier after each run
+  SqliteStatement(sqlite3* db, const std::string& sql,
+                  const std::shared_ptr<StatementCache>& cache,
+                  const std::shared_ptr<ChangeNotifier>& notifier);
   ~SqliteStatement() override;
 
   SqliteStatement(const SqliteStatement&) = delete;
@@ -30,6 +344,11 @@ class SqliteStatement : public IStatement {
   IStatement& bind(int index, double value) override;
   IStatement& bind(int index, const std::string& value) override;
   IStatement& bind(int index, const std::vector<uint8_t>& blob) override;
+  IStatement& bindStatic(int index, std::string_view value) override;
+  IStatement& bindStatic(int index, BlobView blob) override;
+  // Binds a blob of size zero bytes without materializing it, to be
+  // filled later through a BlobStream (SQL: zeroblob(?))
+  SqliteStatement& bindZeroBlob(int index, size_t size);
 
   // Execution
   DbResult execute() override;
@@ -37,20 +356,109 @@ class SqliteStatement : public IStatement {
   int executeUpdate() override;
   void reset() override;
 
+  // Appends all remaining rows to result; returns the rows appended.
+  // Throws QueryException if result already holds a different shape.
+  size_t execute(ArenaResult& result);
+
+  // Cursor
+  bool step() override;
+  int columnCount() const override;
+  bool columnIsNull(int col) const override;
+  int64_t columnInt64(int col) const override;
+  double columnDouble(int col) const override;
+  std::string_view columnText(int col) const override;
+  BlobView columnBlob(int col) const override;
+  DbValue columnValue(int col) const override;
+
   // Batch execution: runs statement for each parameter set.
   // Each inner vector contains values for one execution (bound in order).
-  // Returns total affected rows.
+  // Text and blob values are borrowed from paramSets, and bindings are
+  // cleared before returning. Returns total affected rows.
   int executeBatch(const std::vector<std::vector<DbValue>>& paramSets);
 
-  // Bind a DbValue variant (1-based index)
+  // Multi-row batch for statements holding rowsPerStep parameter groups,
+  // e.g. INSERT ... VALUES (?, ?), (?, ?). Runs paramSets[first, first +
+  // count) with each step binding the next rowsPerStep sets back to back;
+  // count must be a multiple of rowsPerStep.
+  int executeBatch(const std::vector<std::vector<DbValue>>& paramSets,
+                   size_t first, size_t count, size_t rowsPerStep);
+
+  // Bind a DbValue variant (1-based index). bindValueStatic() borrows
+  // text and blob values under the bindStatic() lifetime contract.
   void bindValue(int index, const DbValue& value);
+  void bindValueStatic(int index, const DbValue& value);
+
+  // True if the statement makes no direct changes to the database file
+  bool isReadOnly() const;
 
  private:
   void checkError(int result, const std::string& context);
-  DbValue extractColumn(int col);
+  DbValue extractColumn(int col) const;
+  void releaseStatement();
+  // After a run: an autocommit write has committed by now
+  void deliverChanges();
 
   sqlite3* m_db;
   sqlite3_stmt* m_stmt;
+  std::weak_ptr<StatementCache> m_cache;
+  std::weak_ptr<ChangeNotifier> m_notifier;
+  std::string m_sql;  // cache key, only set for cached statements
+};
+
+// ============================================================
+// BlobStream - incremental blob I/O
+// ============================================================
+
+// Handle on one blob cell (sqlite3_blob_open) that reads and writes in
+// place, positionally or sequentially from a cursor, so large payloads
+// never need to be materialized whole. Writes cannot change the blob's
+// size: preallocate with zeroblob first. A change to the row from
+// elsewhere expires the handle and later calls throw QueryException.
+// Must be destroyed before its database is closed.
+class BlobStream {
+ public:
+  BlobStream(sqlite3* db, const std::string& table, const std::string& column,
+             int64_t rowid, bool writable);
+  ~BlobStream();
+
+  BlobStream(const BlobStream&) = delete;
+  BlobStream& operator=(const BlobStream&) = delete;
+  BlobStream(BlobStream&& other) noexcept;
+  BlobStream& operator=(BlobStream&& other) noexcept;
+
+  size_t size() const;
+  bool isWritable() const { return m_writable; }
+
+  // Positional I/O; [offset, offset + n) must lie inside the blob
+  void readAt(size_t offset, uint8_t* out, size_t n) const;
+  std::vector<uint8_t> readAt(size_t offset, size_t n) const;
+  void writeAt(size_t offset, BlobView data);
+
+  // Sequential I/O from the cursor. read() returns the bytes copied,
+  // 0 at the end; write() throws if data does not fit.
+  size_t read(uint8_t* out, size_t maxBytes);
+  std::vector<uint8_t> readChunk(size_t maxBytes);
+  void write(BlobView data);
+
+  size_t position() const { return m_position; }
+  size_t remaining() const { return size() - m_position; }
+  void seek(size_t position);
+
+  // Moves the handle to another row of the same column (cheaper than
+  // reopening) and rewinds the cursor
+  void reopen(int64_t rowid);
+
+  void close();
+
+ private:
+  void requireOpen() const;
+  void checkRange(size_t offset, size_t n) const;
+  void checkError(int result, const std::string& context) const;
+
+  sqlite3* m_db;
+  sqlite3_blob* m_blob;
+  bool m_writable;
+  size_t m_position = 0;
 };
 
 // ============================================================
@@ -59,6 +467,19 @@ class SqliteStatement : public IStatement {
 
 class SqliteDatabase;
 
+// Count of transaction statements issued by one connection. Nested
+// begin/commit/rollback map to SAVEPOINT / RELEASE / ROLLBACK TO.
+struct TransactionStats {
+  uint64_t begins = 0;     // physical BEGIN
+  uint64_t commits = 0;    // physical COMMIT
+  uint64_t rollbacks = 0;  // physical ROLLBACK
+  uint64_t savepoints = 0;
+  uint64_t releases = 0;
+  uint64_t savepointRollbacks = 0;
+  uint64_t groupedCommits = 0;  // logical commits absorbed by a group
+};
+
+// Nests: inside an open transaction it becomes a savepoint
 class TransactionScope {
  public:
   explicit TransactionScope(SqliteDatabase& db);
@@ -77,6 +498,150 @@ class TransactionScope {
   bool m_finished;
 };
 
+// ============================================================
+// GroupCommitScope - many logical commits, one physical COMMIT
+// ============================================================
+
+// Opens a transaction in which every nested transaction that commits back
+// to the group's level counts as a logical commit. With flushEvery > 0, a
+// top-level group issues a physical COMMIT after that many logical commits
+// and carries on in a fresh transaction. Work not yet flushed is rolled
+// back if the scope ends without commit().
+class GroupCommitScope {
+ public:
+  GroupCommitScope(SqliteDatabase& db, size_t flushEvery);
+  ~GroupCommitScope();
+
+  GroupCommitScope(const GroupCommitScope&) = delete;
+  GroupCommitScope& operator=(const GroupCommitScope&) = delete;
+  GroupCommitScope(GroupCommitScope&&) = delete;
+  GroupCommitScope& operator=(GroupCommitScope&&) = delete;
+
+  void commit();
+  void rollback();
+
+ private:
+  void finish();
+
+  SqliteDatabase& m_db;
+  bool m_finished;
+  bool m_ownsGroup;
+};
+
+// ============================================================
+// Backup
+// ============================================================
+
+struct BackupProgress {
+  int remainingPages = 0;
+  int totalPages = 0;
+};
+
+// Online backup settings. Each step copies pagesPerStep pages (-1 copies
+// everything in one step) and the source is unlocked between steps, so
+// other connections can keep writing; their commits restart the copy,
+// while writes through the source connection itself are carried along.
+struct BackupOptions {
+  int pagesPerStep = 256;
+  // Throttle: pause between steps
+  std::chrono::milliseconds sleepBetweenSteps{0};
+  // Consecutive SQLITE_BUSY/LOCKED steps tolerated before giving up
+  int maxBusyRetries = 1000;
+  // Called after every step; returning false cancels the backup
+  std::function<bool(const BackupProgress&)> onProgress = nullptr;
+};
+
+// ============================================================
+// SQL Functions - application-defined functions
+// ============================================================
+
+// Arguments of one call, read in place. Text and blob views are valid
+// until the call returns.
+class SqlFunctionArgs {
+ public:
+  SqlFunctionArgs(int count, sqlite3_value** values)
+      : m_count(count), m_values(values) {}
+
+  int size() const { return m_count; }
+  bool isNull(int i) const;
+  int64_t getInt64(int i) const;
+  double getDouble(int i) const;
+  std::string_view getText(int i) const;
+  BlobView getBlob(int i) const;
+
+ private:
+  int m_count;
+  sqlite3_value** m_values;
+};
+
+// A scalar function: one result per call. Exceptions become SQL errors,
+// so the statement running it throws QueryException.
+using ScalarFunction = std::function<DbValue(const SqlFunctionArgs&)>;
+
+// State of one aggregate: a group, or a partition when called with
+// OVER (...). step() adds a row, value() gives the result so far.
+// inverse() removes the oldest row of a sliding window frame; the
+// default throws, so the function can only be used as a window function
+// with frames that start at UNBOUNDED PRECEDING.
+class SqlAggregate {
+ public:
+  virtual ~SqlAggregate() = default;
+  virtual void step(const SqlFunctionArgs& args) = 0;
+  virtual void inverse(const SqlFunctionArgs& args);
+  virtual DbValue value() const = 0;
+};
+
+// Called once per group or partition, and for the result of an empty one
+using AggregateFactory = std::function<std::unique_ptr<SqlAggregate>()>;
+
+struct SqlFunctionOptions {
+  // The same arguments always give the same result, so SQLite may factor
+  // calls out and use the function in indexes and CHECK constraints
+  bool deterministic = true;
+  // Aggregates only: also usable as a window function, OVER (...)
+  bool window = false;
+};
+
+// ============================================================
+// Virtual Tables - application-defined read-only tables
+// ============================================================
+
+enum class ScanOp { Eq, Lt, Le, Gt, Ge };
+
+// A WHERE term handed to VirtualTable::scan(): column op value, with
+// column an index into the declared columns
+struct ScanConstraint {
+  int column;
+  ScanOp op;
+  DbValue value;
+};
+
+// One scan of a virtual table. next() moves to the first row on its first
+// call and to the following one after; false once past the last row.
+// column() reads the current row.
+class VirtualTableCursor {
+ public:
+  virtual ~VirtualTableCursor() = default;
+  virtual bool next() = 0;
+  virtual DbValue column(int i) const = 0;
+};
+
+// Rows that come from the application instead of a B-tree. schema() is
+// the CREATE TABLE statement declaring the columns; its table name is
+// ignored. filters() tells the planner which terms scan() applies itself:
+// those are handed to it and not checked again, the rest are checked by
+// SQLite on every row, and plans that hand over more terms (equality
+// above ranges) are preferred. scan() runs on the thread stepping the
+// statement; exceptions become the statement's error.
+class VirtualTable {
+ public:
+  virtual ~VirtualTable() = default;
+  virtual std::string schema() const = 0;
+  virtual bool filters(int column, ScanOp op) const = 0;
+  virtual std::unique_ptr<VirtualTableCursor> scan(
+      const std::vector<ScanConstraint>& constraints) = 0;
+};
+
 // ============================================================
 // SqliteDatabase
 // ============================================================
@@ -94,6 +659,8 @@ class SqliteDatabase : public IDatabase {
 
   // Connection
   void open(const std::string& path) override;
+  // Opens an existing database without write access
+  void openReadOnly(const std::string& path);
   void close() override;
   bool isOpen() const override;
 
@@ -103,29 +670,124 @@ class SqliteDatabase : public IDatabase {
   // Direct execution
   void execute(const std::string& sql) override;
   DbResult query(const std::string& sql) override;
-
-  // Transaction control
+  size_t query(const std::string& sql, const RowCallback& callback) override;
+
+  // Online backup of the main database into target, or into the file at
+  // path (created or overwritten). Throws DatabaseException if cancelled.
+  void backupTo(SqliteDatabase& target, const BackupOptions& options = {});
+  void backupTo(const std::string& path, const BackupOptions& options = {});
+  // Replaces this connection's main database with the file at path
+  void restoreFrom(const std::string& path,
+                   const BackupOptions& options = {});
+  // In-memory copy of the file at path, e.g. for test fixtures
+  static SqliteDatabase openInMemoryCopy(const std::string& path);
+
+  // Incremental blob I/O on table.column of rowid (main schema)
+  BlobStream openBlobReader(const std::string& table,
+                            const std::string& column, int64_t rowid);
+  BlobStream openBlobWriter(const std::string& table,
+                            const std::string& column, int64_t rowid);
+
+  // Arena-backed query: appends rows to result, returns the rows appended
+  size_t queryInto(const std::string& sql, ArenaResult& result);
+
+  // Columnar numeric query; params are bound in order. See
+  // IStatement::fetchColumns().
+  ColumnarResult queryColumns(const std::string& sql,
+                              const std::vector<DbValue>& params = {},
+                              const std::vector<ColumnKind>& kinds = {});
+
+  // Transaction control. Calls nest: inside an open transaction, begin,
+  // commit and rollback use SAVEPOINT, RELEASE and ROLLBACK TO.
   void beginTransaction() override;
   void commit() override;
   void rollback() override;
+  // Tracks savepoints: a released one's actions wait for the enclosing
+  // transaction. A COMMIT or ROLLBACK run through execute() is not seen
+  // until the next transaction call, which counts it as a rollback.
+  void onTransactionEnd(TransactionEndAction action) override;
 
   // RAII transaction scope
   TransactionScope transaction();
+  GroupCommitScope groupCommit(size_t flushEvery = 0);
+
+  // True while an explicit transaction is open on this connection
+  bool inTransaction() const;
+  int transactionDepth() const;
+  TransactionStats transactionStats() const;
+  void resetTransactionStats();
 
   // Metadata
   int64_t lastInsertRowId() const override;
   int changesCount() const override;
+  // Rows inserted, updated or deleted since the connection was opened
+  int64_t totalChanges() const;
 
   // SQLite-specific settings
   void enableForeignKeys(bool enable);
   void setJournalMode(const std::string& mode);
-
-  // Bulk insert: inserts multiple rows into a table.
-  // Returns total rows inserted.
+  void setBusyTimeout(int milliseconds);
+
+  // Prepared-statement cache (enabled by default).
+  // A capacity of 0 disables caching and finalizes idle statements.
+  static constexpr size_t kDefaultStatementCacheCapacity = 64;
+  void setStatementCacheCapacity(size_t capacity);
+  void clearStatementCache();
+  StatementCacheStats statementCacheStats() const;
+
+  // Query profiling (off by default). Profiles and the slow-query log
+  // outlive close() and reopen; see QueryProfiler.
+  void enableProfiling(bool enable);
+  bool profilingEnabled() const;
+  void setSlowQueryLog(std::chrono::nanoseconds threshold,
+                       SlowQueryCallback callback = nullptr);
+  std::vector<QueryProfile> queryProfile() const;
+  std::vector<SlowQuery> slowQueries() const;
+  void resetQueryProfile();
+
+  // Change notification; see ChangeNotifier. Subscriptions outlive
+  // close() and reopen. Changes made before subscribing, or while
+  // nobody is subscribed, are not reported.
+  size_t subscribeChanges(ChangeCallback callback);
+  void unsubscribeChanges(size_t id);
+
+  // Application-defined SQL functions (sqlite3_create_function_v2, and
+  // sqlite3_create_window_function for window aggregates). argCount -1
+  // takes any number of arguments. Registering a name and argCount again
+  // replaces the function. Functions outlive close() and reopen; register
+  // them while no statement is running. Throws DatabaseException if
+  // SQLite rejects the function.
+  void createFunction(const std::string& name, int argCount,
+                      ScalarFunction function,
+                      const SqlFunctionOptions& options = {});
+  void createAggregate(const std::string& name, int argCount,
+                       AggregateFactory factory,
+                       const SqlFunctionOptions& options = {});
+
+  // Virtual table `name`, queried like any table with no CREATE VIRTUAL
+  // TABLE (an eponymous-only module), and usable from views. Registering
+  // a name again replaces the table for statements prepared after.
+  // Tables outlive close() and reopen, like functions. Throws
+  // DatabaseException if SQLite rejects the module.
+  void createVirtualTable(const std::string& name,
+                          std::shared_ptr<VirtualTable> table);
+
+  // Bulk insert: inserts multiple rows into a table using multi-row
+  // INSERT ... VALUES statements of bulkInsertChunkRows() rows each; the
+  // remainder runs through one smaller statement. Every row must have one
+  // value per column. Returns total rows inserted.
   int bulkInsert(const std::string& table,
                  const std::vector<std::string>& columns,
                  const std::vector<std::vector<DbValue>>& rows);
 
+  // Rows per multi-row INSERT used by bulkInsert(). 0 (the default) picks
+  // SQLITE_LIMIT_VARIABLE_NUMBER / columns, capped at kMaxAutoChunkRows;
+  // 1 inserts one row per step. Explicit values are clamped to the limit.
+  static constexpr size_t kAutoChunkRows = 0;
+  static constexpr size_t kMaxAutoChunkRows = 512;
+  void setBulkInsertChunkRows(size_t rows);
+  size_t bulkInsertChunkRows(size_t columnCount) const;
+
   // Bulk execute: runs parameterized SQL with multiple parameter sets.
   // Returns total affected rows.
   int bulkExecute(const std::string& sql,
@@ -135,9 +797,62 @@ class SqliteDatabase : public IDatabase {
   // Returns combined results from all executions.
   DbResult bulkSelect(const std::string& sql,
                       const std::vector<std::vector<DbValue>>& paramSets);
+  // Set-based lookup: one statement joining table to the keys through
+  // json_each() instead of one execution per key. Each row is the index
+  // of the matching key followed by columns; rows come in key order.
+  // Keys must not be blobs.
+  DbResult selectByKeys(const std::string& table,
+                        const std::vector<std::string>& columns,
+                        const std::string& keyColumn,
+                        const std::vector<DbValue>& keys);
+
+  // bulkSelect(), appending every execution's rows to one arena result
+  size_t bulkSelectInto(const std::string& sql,
+                        const std::vector<std::vector<DbValue>>& paramSets,
+                        ArenaResult& result);
 
  private:
+  friend class GroupCommitScope;
+
+  struct TransactionState {
+    int depth = 0;
+    int groupDepth = 0;  // 0 when no group commit is active
+    size_t groupFlushEvery = 0;
+    size_t groupPending = 0;
+    TransactionStats stats;
+  };
+
+  void openWithFlags(const std::string& path, int flags);
+  QueryProfiler& profiler();
+  ChangeNotifier& notifier();
+  void syncTransactionState();
+  void onGroupedCommit();
+  // Runs and drops the actions queued above depth
+  void endTransactionActions(int depth, bool committed);
+
+  struct SqlFunction;
+  void addFunction(std::shared_ptr<const SqlFunction> function);
+  void registerFunction(const std::shared_ptr<const SqlFunction>& function);
+  struct VirtualTableModule;
+  void registerVirtualTable(
+      const std::shared_ptr<const VirtualTableModule>& module);
+
   sqlite3* m_db = nullptr;
+  // Bound to the open connection: created by open(), dropped by close()
+  std::shared_ptr<StatementCache> m_statementCache;
+  size_t m_statementCacheCapacity = kDefaultStatementCacheCapacity;
+  size_t m_bulkInsertChunkRows = kAutoChunkRows;
+  TransactionState m_txn;
+  // onTransactionEnd() actions with the depth they belong to
+  std::vector<std::pair<int, TransactionEndAction>> m_endActions;
+  // Heap-allocated so the trace context survives moves
+  std::unique_ptr<QueryProfiler> m_profiler;
+  bool m_profilingEnabled = false;
+  // Shared with statements, which deliver after autocommit writes
+  std::shared_ptr<ChangeNotifier> m_notifier;
+  // Registered again by every open()
+  std::vector<std::shared_ptr<const SqlFunction>> m_functions;
+  std::vector<std::shared_ptr<const VirtualTableModule>> m_virtualTables;
 };
 
 }  // namespace Gateways::Database
@@ -0,0 +1,186 @@
+#ifndef GATEWAYS_DATABASE_SQLITE3_POOL_H_
+#define GATEWAYS_DATABASE_SQLITE3_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "database_connector.h"
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Database {
+
+// ============================================================
+// SqlitePoolOptions
+// ============================================================
+
+struct SqlitePoolOptions {
+  // Read-only connections. In-memory databases cannot share state across
+  // connections, so they always run on the writer alone.
+  size_t readerCount = 4;
+  int busyTimeoutMs = 5000;
+  size_t statementCacheCapacity =
+      SqliteDatabase::kDefaultStatementCacheCapacity;
+};
+
+class SqlitePool;
+
+// ============================================================
+// ConnectionLease - RAII handle on one pooled connection
+// ============================================================
+
+class ConnectionLease {
+ public:
+  ConnectionLease() = default;
+  ~ConnectionLease();
+
+  ConnectionLease(const ConnectionLease&) = delete;
+  ConnectionLease& operator=(const ConnectionLease&) = delete;
+  ConnectionLease(ConnectionLease&& other) noexcept;
+  ConnectionLease& operator=(ConnectionLease&& other) noexcept;
+
+  SqliteDatabase& operator*() const { return *m_db; }
+  SqliteDatabase* operator->() const { return m_db; }
+  SqliteDatabase* get() const { return m_db; }
+  explicit operator bool() const { return m_db != nullptr; }
+
+  bool isWriter() const { return m_writer; }
+
+  // Returns the connection to the pool early
+  void release();
+
+ private:
+  friend class SqlitePool;
+  ConnectionLease(SqlitePool* pool, SqliteDatabase* db, bool writer);
+
+  SqlitePool* m_pool = nullptr;
+  SqliteDatabase* m_db = nullptr;
+  bool m_writer = false;
+};
+
+// ============================================================
+// SqlitePool - WAL readers plus a single writer behind IDatabase
+// ============================================================
+
+// Read-only statements run on one of the reader connections; everything
+// else (writes, DDL, execute(), transactions) runs on the writer. A thread
+// that holds the writer (open transaction or live write statement) keeps
+// using it for reads too, so it sees its own uncommitted changes.
+//
+// Statements returned by prepare() keep their connection leased until they
+// are destroyed. A thread that already holds a reader is given the same
+// reader again, so a read nested in another (iterating one statement
+// while preparing the next) never waits for a second connection.
+class SqlitePool : public IDatabase {
+ public:
+  SqlitePool() = default;
+  explicit SqlitePool(const std::string& path,
+                      const SqlitePoolOptions& options = {});
+  ~SqlitePool() override;
+
+  SqlitePool(const SqlitePool&) = delete;
+  SqlitePool& operator=(const SqlitePool&) = delete;
+  SqlitePool(SqlitePool&&) = delete;
+  SqlitePool& operator=(SqlitePool&&) = delete;
+
+  // Connection. close() waits for outstanding leases to be returned.
+  void open(const std::string& path) override;
+  void close() override;
+  bool isOpen() const override;
+
+  void setOptions(const SqlitePoolOptions& options);
+  const SqlitePoolOptions& options() const { return m_options; }
+
+  // Explicit leases. Both are reentrant on the owning thread;
+  // acquireReader() falls back to the writer when there are no readers.
+  ConnectionLease acquireReader();
+  ConnectionLease acquireWriter();
+
+  size_t readerCount() const;
+  size_t idleReaderCount() const;
+
+  // Statement preparation
+  std::unique_ptr<IStatement> prepare(const std::string& sql) override;
+
+  // Direct execution (execute() always runs on the writer)
+  void execute(const std::string& sql) override;
+  DbResult query(const std::string& sql) override;
+  size_t query(const std::string& sql, const RowCallback& callback) override;
+
+  // Transaction control: the calling thread holds the writer from
+  // beginTransaction() until commit() or rollback()
+  void beginTransaction() override;
+  void commit() override;
+  void rollback() override;
+  // On the writer while the calling thread holds it, else at once
+  void onTransactionEnd(TransactionEndAction action) override;
+
+  // Metadata of the calling thread's last write: the writer's own while
+  // the thread holds it, else as it was when the thread last released it
+  int64_t lastInsertRowId() const override;
+  int changesCount() const override;
+
+  // SqliteDatabase::createFunction() / createAggregate() on the writer and
+  // every reader, now and after each open(). Functions are called on
+  // whichever thread runs the statement, so scalar functions must be
+  // safe to call concurrently; each aggregate instance is used by one.
+  void createFunction(const std::string& name, int argCount,
+                      ScalarFunction function,
+                      const SqlFunctionOptions& options = {});
+  void createAggregate(const std::string& name, int argCount,
+                       AggregateFactory factory,
+                       const SqlFunctionOptions& options = {});
+  // SqliteDatabase::createVirtualTable() the same way; every connection
+  // shares table, so its scan() must be safe to call concurrently
+  void createVirtualTable(const std::string& name,
+                          std::shared_ptr<VirtualTable> table);
+
+ private:
+  friend class ConnectionLease;
+
+  void requireOpen() const;
+  bool ownsWriter() const;
+  void releaseLease(SqliteDatabase* db, bool writer);
+  void finishTransaction();
+  void addFunction(std::function<void(SqliteDatabase&)> registration);
+
+  SqlitePoolOptions m_options;
+  // Replayed on the connections of every open()
+  std::vector<std::function<void(SqliteDatabase&)>> m_functions;
+
+  std::unique_ptr<SqliteDatabase> m_writer;
+  std::vector<std::unique_ptr<SqliteDatabase>> m_readers;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_released;
+  std::vector<SqliteDatabase*> m_idleReaders;
+  // Readers out on a lease, with the thread holding them
+  struct LeasedReader {
+    SqliteDatabase* db;
+    std::thread::id owner;
+    size_t depth;
+  };
+  std::vector<LeasedReader> m_leasedReaders;
+  // What lastInsertRowId() and changesCount() report per thread
+  struct WriteResult {
+    int64_t lastInsertRowId = 0;
+    int changes = 0;
+  };
+  std::unordered_map<std::thread::id, WriteResult> m_writeResults;
+  std::thread::id m_writerOwner;
+  size_t m_writerDepth = 0;
+
+  // Held by the thread that called beginTransaction()
+  ConnectionLease m_transactionLease;
+};
+
+}  // namespace Gateways::Database
+
+#endif  // GATEWAYS_DATABASE_SQLITE3_POOL_H_
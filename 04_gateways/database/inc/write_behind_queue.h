@@ -0,0 +1,107 @@
+#ifndef GATEWAYS_DATABASE_WRITE_BEHIND_QUEUE_H_
+#define GATEWAYS_DATABASE_WRITE_BEHIND_QUEUE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "database_connector.h"
+
+namespace Gateways::Database {
+
+// ============================================================
+// WriteBehindOptions
+// ============================================================
+
+struct WriteBehindOptions {
+  // Queued operations before submit() blocks (trySubmit() fails)
+  size_t capacity = 4096;
+  // Operations per transaction
+  size_t maxBatchSize = 256;
+  // How long the writer waits for a batch to fill after the first op
+  std::chrono::milliseconds maxDelay{5};
+};
+
+struct WriteBehindStats {
+  uint64_t submitted = 0;
+  uint64_t completed = 0;  // committed operations
+  uint64_t failed = 0;     // operations that threw or lost their commit
+  uint64_t rejected = 0;   // trySubmit() calls on a full queue
+  uint64_t commits = 0;    // physical transactions
+  size_t queued = 0;
+};
+
+// ============================================================
+// WriteBehindQueue - group-committed async writes
+// ============================================================
+
+// Producers enqueue write operations; a dedicated writer thread drains them
+// into transactions of up to maxBatchSize operations. Each operation runs
+// inside its own SAVEPOINT, so one failure rolls back only that operation.
+// Futures resolve once the enclosing COMMIT has succeeded.
+//
+// The writer thread owns the database while the queue runs. The database
+// must nest transactions (SqliteDatabase, SqlitePool); operations may open
+// their own as long as they leave them balanced.
+class WriteBehindQueue {
+ public:
+  using WriteOp = std::function<void(IDatabase&)>;
+
+  explicit WriteBehindQueue(IDatabase& db,
+                            const WriteBehindOptions& options = {});
+  ~WriteBehindQueue();
+
+  WriteBehindQueue(const WriteBehindQueue&) = delete;
+  WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+  WriteBehindQueue(WriteBehindQueue&&) = delete;
+  WriteBehindQueue& operator=(WriteBehindQueue&&) = delete;
+
+  // Blocks while the queue is full (backpressure).
+  // Throws DatabaseException after stop().
+  std::future<void> submit(WriteOp op);
+
+  // Never blocks; returns std::nullopt if the queue is full
+  std::optional<std::future<void>> trySubmit(WriteOp op);
+
+  // Waits until everything submitted so far has been committed or failed
+  void flush();
+
+  // Drains the queue and joins the writer thread. Idempotent.
+  void stop();
+
+  WriteBehindStats stats() const;
+
+ private:
+  struct Pending {
+    WriteOp op;
+    std::promise<void> done;
+  };
+
+  std::future<void> enqueue(WriteOp op, std::unique_lock<std::mutex>& lock);
+  void run();
+  void commitBatch(std::deque<Pending>& batch);
+
+  IDatabase& m_db;
+  const WriteBehindOptions m_options;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+  std::condition_variable m_drained;
+  std::deque<Pending> m_queue;
+  bool m_stopping = false;
+  WriteBehindStats m_stats;
+
+  std::thread m_writer;
+};
+
+}  // namespace Gateways::Database
+
+#endif  // GATEWAYS_DATABASE_WRITE_BEHIND_QUEUE_H_
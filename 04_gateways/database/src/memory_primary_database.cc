@@ -0,0 +1,251 @@
+#include "memory_primary_database.h"
+
+#include <filesystem>
+#include <utility>
+
+namespace Gateways::Database {
+
+namespace {
+
+std::chrono::microseconds elapsedSince(
+    std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+}
+
+}  // namespace
+
+// ============================================================
+// MemoryPrimaryDatabase Implementation
+// ============================================================
+
+MemoryPrimaryDatabase::MemoryPrimaryDatabase(
+    const std::string& path, const MemoryPrimaryOptions& options)
+    : m_options(options) {
+  open(path);
+}
+
+MemoryPrimaryDatabase::~MemoryPrimaryDatabase() {
+  try {
+    close();
+  } catch (const DatabaseException&) {
+    // Final checkpoint failed; nothing left to report it to
+  }
+}
+
+void MemoryPrimaryDatabase::open(const std::string& path) {
+  if (path.empty() || path == ":memory:") {
+    throw ConnectionException("Memory primary needs a file path");
+  }
+  close();
+
+  if (std::filesystem::exists(path)) {
+    m_primary = SqliteDatabase::openInMemoryCopy(path);
+  } else {
+    m_primary.open(":memory:");
+  }
+  m_path = path;
+
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_flushedChanges = static_cast<uint64_t>(m_primary.totalChanges());
+    m_stats = {};
+  }
+  startFlusher();
+}
+
+void MemoryPrimaryDatabase::close() {
+  if (!isOpen()) {
+    return;
+  }
+  stopFlusher();
+
+  // Closing discards an open transaction, so the checkpoint must too
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_primaryMutex);
+    while (m_primary.inTransaction()) {
+      m_primary.rollback();
+    }
+  }
+
+  try {
+    writeCheckpoint();
+  } catch (const DatabaseException&) {
+    // Stay open so the caller can retry; the flusher resumes meanwhile
+    startFlusher();
+    throw;
+  }
+  m_primary.close();
+}
+
+bool MemoryPrimaryDatabase::isOpen() const { return m_primary.isOpen(); }
+
+void MemoryPrimaryDatabase::setOptions(const MemoryPrimaryOptions& options) {
+  m_options = options;
+}
+
+std::unique_ptr<IStatement> MemoryPrimaryDatabase::prepare(
+    const std::string& sql) {
+  return m_primary.prepare(sql);
+}
+
+void MemoryPrimaryDatabase::execute(const std::string& sql) {
+  // sql may open or close a transaction
+  std::lock_guard<std::recursive_mutex> lock(m_primaryMutex);
+  m_primary.execute(sql);
+}
+
+DbResult MemoryPrimaryDatabase::query(const std::string& sql) {
+  return m_primary.query(sql);
+}
+
+size_t MemoryPrimaryDatabase::query(const std::string& sql,
+                                    const RowCallback& callback) {
+  return m_primary.query(sql, callback);
+}
+
+void MemoryPrimaryDatabase::beginTransaction() {
+  std::lock_guard<std::recursive_mutex> lock(m_primaryMutex);
+  m_primary.beginTransaction();
+}
+
+void MemoryPrimaryDatabase::commit() {
+  std::lock_guard<std::recursive_mutex> lock(m_primaryMutex);
+  m_primary.commit();
+}
+
+void MemoryPrimaryDatabase::rollback() {
+  std::lock_guard<std::recursive_mutex> lock(m_primaryMutex);
+  m_primary.rollback();
+}
+
+void MemoryPrimaryDatabase::onTransactionEnd(TransactionEndAction action) {
+  std::lock_guard<std::recursive_mutex> lock(m_primaryMutex);
+  m_primary.onTransactionEnd(std::move(action));
+}
+
+int64_t MemoryPrimaryDatabase::lastInsertRowId() const {
+  return m_primary.lastInsertRowId();
+}
+
+int MemoryPrimaryDatabase::changesCount() const {
+  return m_primary.changesCount();
+}
+
+bool MemoryPrimaryDatabase::checkpoint() {
+  requireOpen();
+  return writeCheckpoint();
+}
+
+MemoryPrimaryStats MemoryPrimaryDatabase::stats() const {
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  MemoryPrimaryStats stats = m_stats;
+  stats.pendingChanges = totalChanges() - m_flushedChanges;
+  return stats;
+}
+
+void MemoryPrimaryDatabase::requireOpen() const {
+  if (!isOpen()) {
+    throw ConnectionException("Database not open");
+  }
+}
+
+void MemoryPrimaryDatabase::startFlusher() {
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_stopping = false;
+  }
+  m_flusher = std::thread(&MemoryPrimaryDatabase::runFlusher, this);
+}
+
+void MemoryPrimaryDatabase::stopFlusher() {
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+
+  if (m_flusher.joinable()) {
+    m_flusher.join();
+  }
+}
+
+void MemoryPrimaryDatabase::runFlusher() {
+  auto lastCheckpoint = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+
+  while (true) {
+    m_wake.wait_for(lock, m_options.pollInterval,
+                    [this] { return m_stopping; });
+    if (m_stopping) {
+      break;
+    }
+
+    const uint64_t pending = totalChanges() - m_flushedChanges;
+    const bool intervalElapsed = std::chrono::steady_clock::now() -
+                                     lastCheckpoint >=
+                                 m_options.flushInterval;
+    const bool overThreshold = m_options.dirtyChangeThreshold > 0 &&
+                               pending >= m_options.dirtyChangeThreshold;
+    if (pending == 0 || (!intervalElapsed && !overThreshold)) {
+      continue;
+    }
+
+    lock.unlock();
+    try {
+      if (writeCheckpoint()) {
+        lastCheckpoint = std::chrono::steady_clock::now();
+      }
+    } catch (const DatabaseException&) {
+      // Recorded in stats; wait a full interval before retrying
+      lastCheckpoint = std::chrono::steady_clock::now();
+    }
+    lock.lock();
+  }
+}
+
+bool MemoryPrimaryDatabase::writeCheckpoint() {
+  std::lock_guard<std::mutex> checkpointLock(m_checkpointMutex);
+
+  SqliteDatabase snapshot(":memory:");
+  uint64_t changes = 0;
+  auto snapshotStart = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_primaryMutex);
+    if (m_primary.inTransaction()) {
+      std::lock_guard<std::mutex> stateLock(m_stateMutex);
+      ++m_stats.skippedCheckpoints;
+      return false;
+    }
+    BackupOptions wholeCopy;
+    wholeCopy.pagesPerStep = -1;
+    m_primary.backupTo(snapshot, wholeCopy);
+    changes = static_cast<uint64_t>(m_primary.totalChanges());
+  }
+  auto snapshotTime = elapsedSince(snapshotStart);
+
+  auto writeStart = std::chrono::steady_clock::now();
+  try {
+    BackupOptions steppedCopy;
+    steppedCopy.pagesPerStep = m_options.pagesPerStep;
+    snapshot.backupTo(m_path, steppedCopy);
+  } catch (const DatabaseException& e) {
+    std::lock_guard<std::mutex> stateLock(m_stateMutex);
+    ++m_stats.failedCheckpoints;
+    m_stats.lastError = e.what();
+    throw;
+  }
+
+  std::lock_guard<std::mutex> stateLock(m_stateMutex);
+  ++m_stats.checkpoints;
+  m_stats.lastSnapshotTime = snapshotTime;
+  m_stats.lastWriteTime = elapsedSince(writeStart);
+  m_flushedChanges = changes;
+  return true;
+}
+
+uint64_t MemoryPrimaryDatabase::totalChanges() const {
+  return static_cast<uint64_t>(m_primary.totalChanges());
+}
+
+}  // namespace Gateways::Database
@@ -1,10 +1,657 @@
 #include "sqlite3_database_connector.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <set>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
+#include "tracing.h"
+
 namespace Gateways::Database {
 
+// ============================================================
+// StatementCache Implementation
+// ============================================================
+
+StatementCache::StatementCache(size_t capacity) : m_capacity(capacity) {}
+
+StatementCache::~StatementCache() { clear(); }
+
+sqlite3_stmt* StatementCache::acquire(const std::string& sql) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_index.find(sql);
+  if (it == m_index.end()) {
+    ++m_misses;
+    return nullptr;
+  }
+
+  sqlite3_stmt* stmt = it->second->stmt;
+  m_lru.erase(it->second);
+  m_index.erase(it);
+  ++m_hits;
+  return stmt;
+}
+
+void StatementCache::release(const std::string& sql, sqlite3_stmt* stmt) {
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // Keep one idle statement per SQL text; duplicates are finalized
+  if (m_capacity == 0 || m_index.count(sql) > 0) {
+    sqlite3_finalize(stmt);
+    return;
+  }
+
+  m_lru.push_front({sql, stmt});
+  m_index.emplace(sql, m_lru.begin());
+  evictOverflow();
+}
+
+void StatementCache::setCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_capacity = capacity;
+  evictOverflow();
+}
+
+void StatementCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& entry : m_lru) {
+    sqlite3_finalize(entry.stmt);
+  }
+  m_lru.clear();
+  m_index.clear();
+}
+
+StatementCacheStats StatementCache::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return StatementCacheStats{m_hits, m_misses, m_evictions, m_lru.size(),
+                             m_capacity};
+}
+
+void StatementCache::evictOverflow() {
+  while (m_lru.size() > m_capacity) {
+    auto& oldest = m_lru.back();
+    sqlite3_finalize(oldest.stmt);
+    m_index.erase(oldest.sql);
+    m_lru.pop_back();
+    ++m_evictions;
+  }
+}
+
+// ============================================================
+// QueryProfiler Implementation
+// ============================================================
+
+namespace {
+
+constexpr unsigned kProfilerTraceMask =
+    SQLITE_TRACE_STMT | SQLITE_TRACE_ROW | SQLITE_TRACE_PROFILE;
+
+uint64_t takeStmtStatus(sqlite3_stmt* stmt, int counter) {
+  return static_cast<uint64_t>(sqlite3_stmt_status(stmt, counter, 1));
+}
+
+std::chrono::nanoseconds percentile(std::vector<int64_t> samples,
+                                    double fraction) {
+  if (samples.empty()) {
+    return std::chrono::nanoseconds(0);
+  }
+  size_t rank = static_cast<size_t>(fraction * (samples.size() - 1) + 0.5);
+  std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+  return std::chrono::nanoseconds(samples[rank]);
+}
+
+}  // namespace
+
+void QueryProfiler::attach(sqlite3* db) {
+  sqlite3_trace_v2(db, kProfilerTraceMask, &QueryProfiler::onTrace, this);
+}
+
+void QueryProfiler::detach(sqlite3* db) {
+  sqlite3_trace_v2(db, 0, nullptr, nullptr);
+
+  // Statements of this connection that never finished
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_running.begin(); it != m_running.end();) {
+    if (sqlite3_db_handle(it->first) == db) {
+      it = m_running.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void QueryProfiler::setSlowQueryLog(std::chrono::nanoseconds threshold,
+                                    SlowQueryCallback callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_slowThreshold = threshold;
+  m_slowCallback = std::move(callback);
+}
+
+std::vector<QueryProfile> QueryProfiler::snapshot() const {
+  std::vector<QueryProfile> profiles;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    profiles.reserve(m_entries.size());
+    for (const auto& [sql, entry] : m_entries) {
+      QueryProfile profile = entry.profile;
+      profile.p50 = percentile(entry.samples, 0.50);
+      profile.p99 = percentile(entry.samples, 0.99);
+      profiles.push_back(std::move(profile));
+    }
+  }
+
+  std::sort(profiles.begin(), profiles.end(),
+            [](const QueryProfile& a, const QueryProfile& b) {
+              return a.totalTime > b.totalTime;
+            });
+  return profiles;
+}
+
+std::vector<SlowQuery> QueryProfiler::slowQueries() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_slowQueries.begin(), m_slowQueries.end()};
+}
+
+void QueryProfiler::reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_slowQueries.clear();
+}
+
+int QueryProfiler::onTrace(unsigned type, void* context, void* p, void* x) {
+  auto* profiler = static_cast<QueryProfiler*>(context);
+  auto* stmt = static_cast<sqlite3_stmt*>(p);
+
+  switch (type) {
+    case SQLITE_TRACE_STMT:
+      profiler->onStart(stmt);
+      break;
+    case SQLITE_TRACE_ROW:
+      profiler->onRow(stmt);
+      break;
+    case SQLITE_TRACE_PROFILE:
+      profiler->onProfile(stmt, *static_cast<sqlite3_int64*>(x));
+      break;
+    default:
+      break;
+  }
+  return 0;
+}
+
+void QueryProfiler::onStart(sqlite3_stmt* stmt) {
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Also fired for each trigger program; keep the first start
+  m_running.try_emplace(stmt, Running{now, 0});
+}
+
+void QueryProfiler::onRow(sqlite3_stmt* stmt) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_running.find(stmt);
+  if (it != m_running.end()) {
+    ++it->second.rows;
+  }
+}
+
+void QueryProfiler::onProfile(sqlite3_stmt* stmt, int64_t sqliteNanos) {
+  auto now = std::chrono::steady_clock::now();
+  const char* text = sqlite3_sql(stmt);
+
+  SlowQuery run;
+  run.sql = text ? text : "";
+  run.elapsed = std::chrono::nanoseconds(sqliteNanos);
+  run.fullscanSteps = takeStmtStatus(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP);
+  run.sorts = takeStmtStatus(stmt, SQLITE_STMTSTATUS_SORT);
+  run.autoindexes = takeStmtStatus(stmt, SQLITE_STMTSTATUS_AUTOINDEX);
+  uint64_t vmSteps = takeStmtStatus(stmt, SQLITE_STMTSTATUS_VM_STEP);
+
+  SlowQueryCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // SQLite's own figure is millisecond-grained; prefer the steady clock
+    auto running = m_running.find(stmt);
+    if (running != m_running.end()) {
+      run.elapsed = now - running->second.start;
+      run.rows = running->second.rows;
+      m_running.erase(running);
+    }
+
+    Entry& entry = m_entries[run.sql];
+    QueryProfile& profile = entry.profile;
+    if (profile.calls == 0) {
+      profile.sql = run.sql;
+    }
+    ++profile.calls;
+    profile.rows += run.rows;
+    profile.totalTime += run.elapsed;
+    profile.maxTime = std::max(profile.maxTime, run.elapsed);
+    profile.fullscanSteps += run.fullscanSteps;
+    profile.sorts += run.sorts;
+    profile.autoindexes += run.autoindexes;
+    profile.vmSteps += vmSteps;
+
+    // Reservoir sampling keeps percentiles bounded in memory
+    if (entry.samples.size() < kLatencySamples) {
+      entry.samples.push_back(run.elapsed.count());
+    } else {
+      std::uniform_int_distribution<uint64_t> pick(0, profile.calls - 1);
+      uint64_t slot = pick(m_random);
+      if (slot < kLatencySamples) {
+        entry.samples[slot] = run.elapsed.count();
+      }
+    }
+
+    if (m_slowThreshold.count() > 0 && run.elapsed >= m_slowThreshold) {
+      m_slowQueries.push_back(run);
+      if (m_slowQueries.size() > kSlowQueryLogCapacity) {
+        m_slowQueries.pop_front();
+      }
+      callback = m_slowCallback;
+    }
+  }
+
+  if (callback) {
+    callback(run);
+  }
+}
+
+// ============================================================
+// ChangeNotifier Implementation
+// ============================================================
+
+namespace {
+
+// Each (op, database, table, rowid) once, in the order first seen
+std::vector<ChangeEvent> coalesce(std::vector<ChangeEvent> events) {
+  using Key = std::tuple<int, std::string_view, std::string_view, int64_t>;
+  auto key = [](const ChangeEvent& event) {
+    return Key(static_cast<int>(event.op), event.database, event.table,
+               event.rowid);
+  };
+
+  // Keys view into out, which is reserved so it never reallocates
+  std::set<Key> seen;
+  std::vector<ChangeEvent> out;
+  out.reserve(events.size());
+  for (auto& event : events) {
+    if (seen.count(key(event)) == 0) {
+      out.push_back(std::move(event));
+      seen.insert(key(out.back()));
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+void ChangeNotifier::attach(sqlite3* db) {
+  std::lock_guard<std::mutex> hookLock(m_hookMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_db = db;
+  }
+  installHooks(true);
+}
+
+void ChangeNotifier::detach(sqlite3* db) {
+  std::lock_guard<std::mutex> hookLock(m_hookMutex);
+  if (m_db != db) {
+    return;
+  }
+  installHooks(false);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_db = nullptr;
+  m_committed.clear();
+  m_confirmed = 0;
+  m_hasCommitted.store(false, std::memory_order_release);
+}
+
+size_t ChangeNotifier::subscribe(ChangeCallback callback) {
+  size_t id = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    id = m_nextSubscriber++;
+    m_subscribers.emplace(id, std::move(callback));
+  }
+  std::lock_guard<std::mutex> hookLock(m_hookMutex);
+  installHooks(true);
+  return id;
+}
+
+void ChangeNotifier::unsubscribe(size_t id) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_subscribers.erase(id);
+  }
+  std::lock_guard<std::mutex> hookLock(m_hookMutex);
+  installHooks(false);
+}
+
+void ChangeNotifier::installHooks(bool install) {
+  bool wanted = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    wanted = install && m_db && !m_subscribers.empty();
+    if (wanted == m_hooked) {
+      return;
+    }
+    if (!wanted) {
+      m_pending.clear();
+      m_savepoints.clear();
+    }
+  }
+
+  if (m_db) {
+    void* context = wanted ? this : nullptr;
+    sqlite3_update_hook(m_db, wanted ? &ChangeNotifier::onUpdate : nullptr,
+                        context);
+    sqlite3_commit_hook(m_db, wanted ? &ChangeNotifier::onCommit : nullptr,
+                        context);
+    sqlite3_rollback_hook(m_db, wanted ? &ChangeNotifier::onRollback : nullptr,
+                          context);
+  }
+  m_hooked = wanted;
+}
+
+void ChangeNotifier::savepoint(int level) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_savepoints.resize(static_cast<size_t>(level - 1), m_pending.size());
+  m_savepoints.push_back(m_pending.size());
+}
+
+void ChangeNotifier::releaseSavepoint(int level) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_savepoints.resize(
+      std::min(m_savepoints.size(), static_cast<size_t>(level - 1)));
+}
+
+void ChangeNotifier::rollbackToSavepoint(int level) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const size_t index = static_cast<size_t>(level - 1);
+  if (index < m_savepoints.size()) {
+    // Subscribing mid-transaction can leave the mark past the end
+    m_pending.resize(std::min(m_pending.size(), m_savepoints[index]));
+    m_savepoints.resize(index);
+  }
+}
+
+void ChangeNotifier::deliver() {
+  if (!m_hasCommitted.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  // A COMMIT that fails after its hook (e.g. SQLITE_BUSY) leaves the
+  // transaction open; its batch waits until the connection is out of it
+  auto confirm = [&] {
+    if (m_db && sqlite3_get_autocommit(m_db) != 0) {
+      m_confirmed = m_committed.size();
+    }
+  };
+  confirm();
+  if (m_delivering) {
+    return;
+  }
+
+  m_delivering = true;
+  while (m_confirmed > 0) {
+    std::vector<std::vector<ChangeEvent>> batches(
+        std::make_move_iterator(m_committed.begin()),
+        std::make_move_iterator(m_committed.begin() + m_confirmed));
+    m_committed.erase(m_committed.begin(),
+                      m_committed.begin() + m_confirmed);
+    m_confirmed = 0;
+    m_hasCommitted.store(!m_committed.empty(), std::memory_order_release);
+
+    std::vector<ChangeCallback> callbacks;
+    callbacks.reserve(m_subscribers.size());
+    for (const auto& [id, callback] : m_subscribers) {
+      callbacks.push_back(callback);
+    }
+
+    lock.unlock();
+    try {
+      for (const auto& batch : batches) {
+        for (const auto& callback : callbacks) {
+          callback(batch);
+        }
+      }
+    } catch (...) {
+      lock.lock();
+      m_delivering = false;
+      throw;
+    }
+    lock.lock();
+    confirm();
+  }
+  m_delivering = false;
+}
+
+void ChangeNotifier::onUpdate(void* context, int op, const char* database,
+                              const char* table, sqlite3_int64 rowid) {
+  auto* self = static_cast<ChangeNotifier*>(context);
+  ChangeOp change = ChangeOp::Update;
+  if (op == SQLITE_INSERT) {
+    change = ChangeOp::Insert;
+  } else if (op == SQLITE_DELETE) {
+    change = ChangeOp::Delete;
+  }
+
+  std::lock_guard<std::mutex> lock(self->m_mutex);
+  self->m_pending.push_back({change, database, table, rowid});
+}
+
+int ChangeNotifier::onCommit(void* context) {
+  auto* self = static_cast<ChangeNotifier*>(context);
+  std::lock_guard<std::mutex> lock(self->m_mutex);
+  self->m_savepoints.clear();
+  if (!self->m_pending.empty()) {
+    self->m_committed.push_back(coalesce(std::move(self->m_pending)));
+    self->m_pending.clear();
+    self->m_hasCommitted.store(true, std::memory_order_release);
+  }
+  return 0;  // let the commit proceed
+}
+
+void ChangeNotifier::onRollback(void* context) {
+  auto* self = static_cast<ChangeNotifier*>(context);
+  std::lock_guard<std::mutex> lock(self->m_mutex);
+  self->m_pending.clear();
+  self->m_savepoints.clear();
+  // Batches whose COMMIT failed after the hook
+  self->m_committed.resize(self->m_confirmed);
+  self->m_hasCommitted.store(!self->m_committed.empty(),
+                             std::memory_order_release);
+}
+
+// ============================================================
+// ArenaResult Implementation
+// ============================================================
+
+ArenaResult::Storage::Storage(size_t initialBytes)
+    : arena(initialBytes), cells(&arena) {}
+
+ArenaResult::ArenaResult(size_t initialBytes)
+    : m_initialBytes(std::max<size_t>(1, initialBytes)),
+      m_storage(std::make_unique<Storage>(m_initialBytes)) {}
+
+size_t ArenaResult::size() const {
+  if (!m_storage || m_storage->columns <= 0) {
+    return 0;
+  }
+  return m_storage->cells.size() / static_cast<size_t>(m_storage->columns);
+}
+
+int ArenaResult::columnCount() const {
+  return m_storage ? std::max(0, m_storage->columns) : 0;
+}
+
+bool ArenaResult::isNull(size_t row, int col) const {
+  return cell(row, col).type == CellType::Null;
+}
+
+int64_t ArenaResult::getInt64(size_t row, int col) const {
+  const Cell& c = cell(row, col);
+  switch (c.type) {
+    case CellType::Int64:
+      return c.int64;
+    case CellType::Double:
+      return static_cast<int64_t>(c.real);
+    default:
+      return 0;
+  }
+}
+
+double ArenaResult::getDouble(size_t row, int col) const {
+  const Cell& c = cell(row, col);
+  switch (c.type) {
+    case CellType::Int64:
+      return static_cast<double>(c.int64);
+    case CellType::Double:
+      return c.real;
+    default:
+      return 0.0;
+  }
+}
+
+std::string_view ArenaResult::getText(size_t row, int col) const {
+  const Cell& c = cell(row, col);
+  if (c.type != CellType::Text && c.type != CellType::Blob) {
+    return {};
+  }
+  return {static_cast<const char*>(c.bytes.data), c.bytes.size};
+}
+
+BlobView ArenaResult::getBlob(size_t row, int col) const {
+  const Cell& c = cell(row, col);
+  if (c.type != CellType::Text && c.type != CellType::Blob) {
+    return {};
+  }
+  return {static_cast<const uint8_t*>(c.bytes.data), c.bytes.size};
+}
+
+DbValue ArenaResult::getValue(size_t row, int col) const {
+  const Cell& c = cell(row, col);
+  switch (c.type) {
+    case CellType::Int64:
+      return c.int64;
+    case CellType::Double:
+      return c.real;
+    case CellType::Text:
+      return std::string(getText(row, col));
+    case CellType::Blob: {
+      BlobView blob = getBlob(row, col);
+      return std::vector<uint8_t>(blob.begin(), blob.end());
+    }
+    default:
+      return nullptr;
+  }
+}
+
+DbRow ArenaResult::row(size_t row) const {
+  DbRow values;
+  values.reserve(columnCount());
+  for (int col = 0; col < columnCount(); ++col) {
+    values.push_back(getValue(row, col));
+  }
+  return values;
+}
+
+DbResult ArenaResult::toDbResult() const {
+  DbResult result;
+  result.reserve(size());
+  for (size_t i = 0; i < size(); ++i) {
+    result.push_back(row(i));
+  }
+  return result;
+}
+
+void ArenaResult::setColumnCount(int columns) {
+  Storage& s = storage();
+  if (s.columns < 0) {
+    s.columns = columns;
+  } else if (s.columns != columns) {
+    throw QueryException("Result has " + std::to_string(s.columns) +
+                         " columns, statement returns " +
+                         std::to_string(columns));
+  }
+}
+
+void ArenaResult::appendNull() {
+  Cell c;
+  c.type = CellType::Null;
+  c.int64 = 0;
+  storage().cells.push_back(c);
+}
+
+void ArenaResult::appendInt64(int64_t value) {
+  Cell c;
+  c.type = CellType::Int64;
+  c.int64 = value;
+  storage().cells.push_back(c);
+}
+
+void ArenaResult::appendDouble(double value) {
+  Cell c;
+  c.type = CellType::Double;
+  c.real = value;
+  storage().cells.push_back(c);
+}
+
+void ArenaResult::appendText(std::string_view text) {
+  appendBytes(CellType::Text, text.data(), text.size());
+}
+
+void ArenaResult::appendBlob(BlobView blob) {
+  appendBytes(CellType::Blob, blob.data(), blob.size());
+}
+
+void ArenaResult::clear() {
+  m_storage = std::make_unique<Storage>(m_initialBytes);
+}
+
+ArenaResult::Storage& ArenaResult::storage() {
+  if (!m_storage) {
+    m_storage = std::make_unique<Storage>(m_initialBytes);
+  }
+  return *m_storage;
+}
+
+const ArenaResult::Cell& ArenaResult::cell(size_t row, int col) const {
+  if (row >= size() || col < 0 || col >= columnCount()) {
+    throw std::out_of_range("ArenaResult cell out of range");
+  }
+  return m_storage->cells[row * m_storage->columns + col];
+}
+
+void ArenaResult::appendBytes(CellType type, const void* data, size_t size) {
+  Storage& s = storage();
+  Cell c;
+  c.type = type;
+  c.bytes.data = nullptr;
+  c.bytes.size = size;
+  if (size > 0) {
+    void* copy = s.arena.allocate(size, 1);
+    std::memcpy(copy, data, size);
+    c.bytes.data = copy;
+  }
+  s.cells.push_back(c);
+}
+
 // ============================================================
 // SqliteStatement Implementation
 // ============================================================
@@ -15,29 +662,61 @@ SqliteStatement::SqliteStatement(sqlite3* db, const std::string& sql)
   checkError(result, "prepare statement");
 }
 
-SqliteStatement::~SqliteStatement() {
-  if (m_stmt) {
-    sqlite3_finalize(m_stmt);
+SqliteStatement::SqliteStatement(sqlite3* db, const std::string& sql,
+                                 const std::shared_ptr<StatementCache>& cache)
+    : m_db(db), m_stmt(cache->acquire(sql)), m_cache(cache), m_sql(sql) {
+  if (!m_stmt) {
+    int result = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &m_stmt, nullptr);
+    checkError(result, "prepare statement");
   }
 }
 
+SqliteStatement::SqliteStatement(
+    sqlite3* db, const std::string& sql,
+    const std::shared_ptr<StatementCache>& cache,
+    const std::shared_ptr<ChangeNotifier>& notifier)
+    : SqliteStatement(db, sql, cache) {
+  m_notifier = notifier;
+}
+
+SqliteStatement::~SqliteStatement() { releaseStatement(); }
+
 SqliteStatement::SqliteStatement(SqliteStatement&& other) noexcept
-    : m_db(other.m_db), m_stmt(other.m_stmt) {
+    : m_db(other.m_db),
+      m_stmt(other.m_stmt),
+      m_cache(std::move(other.m_cache)),
+      m_notifier(std::move(other.m_notifier)),
+      m_sql(std::move(other.m_sql)) {
   other.m_stmt = nullptr;
 }
 
 SqliteStatement& SqliteStatement::operator=(SqliteStatement&& other) noexcept {
   if (this != &other) {
-    if (m_stmt) {
-      sqlite3_finalize(m_stmt);
-    }
+    releaseStatement();
     m_db = other.m_db;
     m_stmt = other.m_stmt;
+    m_cache = std::move(other.m_cache);
+    m_notifier = std::move(other.m_notifier);
+    m_sql = std::move(other.m_sql);
     other.m_stmt = nullptr;
   }
   return *this;
 }
 
+void SqliteStatement::releaseStatement() {
+  if (!m_stmt) {
+    return;
+  }
+
+  // The cache expires when the connection closes; finalize in that case
+  if (auto cache = m_cache.lock()) {
+    cache->release(m_sql, m_stmt);
+  } else {
+    sqlite3_finalize(m_stmt);
+  }
+  m_stmt = nullptr;
+}
+
 IStatement& SqliteStatement::bind(int index, std::nullptr_t) {
   checkError(sqlite3_bind_null(m_stmt, index), "bind null");
   return *this;
@@ -67,6 +746,29 @@ IStatement& SqliteStatement::bind(int index, const std::vector<uint8_t>& blob) {
   return *this;
 }
 
+IStatement& SqliteStatement::bindStatic(int index, std::string_view value) {
+  // A null pointer would bind NULL instead of an empty string
+  const char* data = value.data() ? value.data() : "";
+  checkError(sqlite3_bind_text(m_stmt, index, data,
+                               static_cast<int>(value.size()), SQLITE_STATIC),
+             "bind text");
+  return *this;
+}
+
+IStatement& SqliteStatement::bindStatic(int index, BlobView blob) {
+  checkError(sqlite3_bind_blob(m_stmt, index, blob.data(),
+                               static_cast<int>(blob.size()), SQLITE_STATIC),
+             "bind blob");
+  return *this;
+}
+
+SqliteStatement& SqliteStatement::bindZeroBlob(int index, size_t size) {
+  checkError(sqlite3_bind_zeroblob64(m_stmt, index,
+                                     static_cast<sqlite3_uint64>(size)),
+             "bind zeroblob");
+  return *this;
+}
+
 void SqliteStatement::bindValue(int index, const DbValue& value) {
   std::visit(
       [this, index](auto&& arg) {
@@ -86,12 +788,33 @@ void SqliteStatement::bindValue(int index, const DbValue& value) {
       value);
 }
 
+void SqliteStatement::bindValueStatic(int index, const DbValue& value) {
+  if (const auto* text = std::get_if<std::string>(&value)) {
+    bindStatic(index, std::string_view(*text));
+  } else if (const auto* blob = std::get_if<std::vector<uint8_t>>(&value)) {
+    bindStatic(index, BlobView(*blob));
+  } else {
+    bindValue(index, value);
+  }
+}
+
+bool SqliteStatement::isReadOnly() const {
+  return sqlite3_stmt_readonly(m_stmt) != 0;
+}
+
 DbResult SqliteStatement::execute() {
+  TRACE_SPAN("database", "SqliteStatement::execute");
   DbResult results;
-  int columnCount = sqlite3_column_count(m_stmt);
+  int columnCount = -1;
 
   int result;
   while ((result = sqlite3_step(m_stmt)) == SQLITE_ROW) {
+    // Read after stepping: a cached statement re-prepared for a schema
+    // change may report a different column count than before
+    if (columnCount < 0) {
+      columnCount = sqlite3_column_count(m_stmt);
+    }
+
     DbRow row;
     row.reserve(columnCount);
 
@@ -106,23 +829,81 @@ DbResult SqliteStatement::execute() {
     checkError(result, "execute");
   }
 
+  deliverChanges();
   return results;
 }
 
+size_t SqliteStatement::execute(ArenaResult& results) {
+  TRACE_SPAN("database", "SqliteStatement::execute");
+  size_t rows = 0;
+  int columnCount = -1;
+
+  int result;
+  while ((result = sqlite3_step(m_stmt)) == SQLITE_ROW) {
+    if (columnCount < 0) {
+      columnCount = sqlite3_column_count(m_stmt);
+      results.setColumnCount(columnCount);
+    }
+
+    for (int i = 0; i < columnCount; ++i) {
+      switch (sqlite3_column_type(m_stmt, i)) {
+        case SQLITE_INTEGER:
+          results.appendInt64(sqlite3_column_int64(m_stmt, i));
+          break;
+        case SQLITE_FLOAT:
+          results.appendDouble(sqlite3_column_double(m_stmt, i));
+          break;
+        case SQLITE_TEXT: {
+          const char* text =
+              reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, i));
+          int size = sqlite3_column_bytes(m_stmt, i);
+          results.appendText(std::string_view(text ? text : "", size));
+          break;
+        }
+        case SQLITE_BLOB: {
+          const uint8_t* data =
+              static_cast<const uint8_t*>(sqlite3_column_blob(m_stmt, i));
+          int size = sqlite3_column_bytes(m_stmt, i);
+          results.appendBlob(BlobView(data, size));
+          break;
+        }
+        default:
+          results.appendNull();
+          break;
+      }
+    }
+    ++rows;
+  }
+
+  if (result != SQLITE_DONE) {
+    checkError(result, "execute");
+  }
+
+  deliverChanges();
+  return rows;
+}
+
 int64_t SqliteStatement::executeInsert() {
+  TRACE_SPAN("database", "SqliteStatement::executeInsert");
   int result = sqlite3_step(m_stmt);
   if (result != SQLITE_DONE) {
     checkError(result, "executeInsert");
   }
-  return sqlite3_last_insert_rowid(m_db);
+  // Read before a change callback can insert
+  const int64_t rowid = sqlite3_last_insert_rowid(m_db);
+  deliverChanges();
+  return rowid;
 }
 
 int SqliteStatement::executeUpdate() {
+  TRACE_SPAN("database", "SqliteStatement::executeUpdate");
   int result = sqlite3_step(m_stmt);
   if (result != SQLITE_DONE) {
     checkError(result, "executeUpdate");
   }
-  return sqlite3_changes(m_db);
+  const int changes = sqlite3_changes(m_db);
+  deliverChanges();
+  return changes;
 }
 
 void SqliteStatement::reset() {
@@ -130,35 +911,112 @@ void SqliteStatement::reset() {
   sqlite3_clear_bindings(m_stmt);
 }
 
+bool SqliteStatement::step() {
+  int result = sqlite3_step(m_stmt);
+  if (result == SQLITE_ROW) {
+    return true;
+  }
+  if (result != SQLITE_DONE) {
+    checkError(result, "step");
+  }
+  deliverChanges();
+  return false;
+}
+
+int SqliteStatement::columnCount() const {
+  return sqlite3_column_count(m_stmt);
+}
+
+bool SqliteStatement::columnIsNull(int col) const {
+  return sqlite3_column_type(m_stmt, col) == SQLITE_NULL;
+}
+
+int64_t SqliteStatement::columnInt64(int col) const {
+  return static_cast<int64_t>(sqlite3_column_int64(m_stmt, col));
+}
+
+double SqliteStatement::columnDouble(int col) const {
+  return sqlite3_column_double(m_stmt, col);
+}
+
+std::string_view SqliteStatement::columnText(int col) const {
+  // sqlite3_column_bytes must follow sqlite3_column_text
+  const char* text =
+      reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, col));
+  int size = sqlite3_column_bytes(m_stmt, col);
+  if (!text) {
+    return {};
+  }
+  return std::string_view(text, static_cast<size_t>(size));
+}
+
+BlobView SqliteStatement::columnBlob(int col) const {
+  const uint8_t* data =
+      static_cast<const uint8_t*>(sqlite3_column_blob(m_stmt, col));
+  int size = sqlite3_column_bytes(m_stmt, col);
+  return BlobView(data, static_cast<size_t>(size));
+}
+
+DbValue SqliteStatement::columnValue(int col) const {
+  return extractColumn(col);
+}
+
 int SqliteStatement::executeBatch(
     const std::vector<std::vector<DbValue>>& paramSets) {
+  return executeBatch(paramSets, 0, paramSets.size(), 1);
+}
+
+int SqliteStatement::executeBatch(
+    const std::vector<std::vector<DbValue>>& paramSets, size_t first,
+    size_t count, size_t rowsPerStep) {
+  TRACE_SPAN("database", "SqliteStatement::executeBatch");
   int totalChanges = 0;
 
-  for (const auto& params : paramSets) {
-    reset();
+  try {
+    for (size_t row = first; row < first + count; row += rowsPerStep) {
+      reset();
 
-    for (size_t i = 0; i < params.size(); ++i) {
-      bindValue(static_cast<int>(i + 1), params[i]);
-    }
+      int index = 1;
+      for (size_t r = row; r < row + rowsPerStep; ++r) {
+        for (const auto& value : paramSets[r]) {
+          bindValueStatic(index++, value);
+        }
+      }
 
-    int result = sqlite3_step(m_stmt);
-    if (result != SQLITE_DONE) {
-      checkError(result, "executeBatch");
-    }
+      int result = sqlite3_step(m_stmt);
+      if (result != SQLITE_DONE) {
+        checkError(result, "executeBatch");
+      }
 
-    totalChanges += sqlite3_changes(m_db);
+      totalChanges += sqlite3_changes(m_db);
+    }
+  } catch (...) {
+    sqlite3_clear_bindings(m_stmt);
+    throw;
   }
 
+  // Drop the borrowed pointers before paramSets can go away
+  sqlite3_clear_bindings(m_stmt);
+  deliverChanges();
   return totalChanges;
 }
 
+void SqliteStatement::deliverChanges() {
+  if (auto notifier = m_notifier.lock()) {
+    notifier->deliver();
+  }
+}
+
 void SqliteStatement::checkError(int result, const std::string& context) {
   if (result != SQLITE_OK && result != SQLITE_ROW && result != SQLITE_DONE) {
+    if ((result & 0xff) == SQLITE_CONSTRAINT) {
+      throw ConstraintException(context + ": " + sqlite3_errmsg(m_db));
+    }
     throw QueryException(context + ": " + sqlite3_errmsg(m_db));
   }
 }
 
-DbValue SqliteStatement::extractColumn(int col) {
+DbValue SqliteStatement::extractColumn(int col) const {
   int type = sqlite3_column_type(m_stmt, col);
 
   switch (type) {
@@ -189,6 +1047,137 @@ DbValue SqliteStatement::extractColumn(int col) {
   }
 }
 
+// ============================================================
+// BlobStream Implementation
+// ============================================================
+
+BlobStream::BlobStream(sqlite3* db, const std::string& table,
+                       const std::string& column, int64_t rowid,
+                       bool writable)
+    : m_db(db), m_blob(nullptr), m_writable(writable) {
+  int result = sqlite3_blob_open(m_db, "main", table.c_str(), column.c_str(),
+                                 rowid, writable ? 1 : 0, &m_blob);
+  if (result != SQLITE_OK) {
+    // sqlite3_blob_open sets the handle to null on failure
+    throw QueryException("open blob: " + std::string(sqlite3_errmsg(m_db)));
+  }
+}
+
+BlobStream::~BlobStream() { close(); }
+
+BlobStream::BlobStream(BlobStream&& other) noexcept
+    : m_db(other.m_db),
+      m_blob(other.m_blob),
+      m_writable(other.m_writable),
+      m_position(other.m_position) {
+  other.m_blob = nullptr;
+}
+
+BlobStream& BlobStream::operator=(BlobStream&& other) noexcept {
+  if (this != &other) {
+    close();
+    m_db = other.m_db;
+    m_blob = other.m_blob;
+    m_writable = other.m_writable;
+    m_position = other.m_position;
+    other.m_blob = nullptr;
+  }
+  return *this;
+}
+
+size_t BlobStream::size() const {
+  return m_blob ? static_cast<size_t>(sqlite3_blob_bytes(m_blob)) : 0;
+}
+
+void BlobStream::readAt(size_t offset, uint8_t* out, size_t n) const {
+  requireOpen();
+  checkRange(offset, n);
+  if (n == 0) {
+    return;
+  }
+  checkError(sqlite3_blob_read(m_blob, out, static_cast<int>(n),
+                               static_cast<int>(offset)),
+             "read blob");
+}
+
+std::vector<uint8_t> BlobStream::readAt(size_t offset, size_t n) const {
+  std::vector<uint8_t> bytes(n);
+  readAt(offset, bytes.data(), n);
+  return bytes;
+}
+
+void BlobStream::writeAt(size_t offset, BlobView data) {
+  requireOpen();
+  if (!m_writable) {
+    throw QueryException("write blob: stream is read-only");
+  }
+  checkRange(offset, data.size());
+  if (data.empty()) {
+    return;
+  }
+  checkError(sqlite3_blob_write(m_blob, data.data(),
+                                static_cast<int>(data.size()),
+                                static_cast<int>(offset)),
+             "write blob");
+}
+
+size_t BlobStream::read(uint8_t* out, size_t maxBytes) {
+  size_t n = std::min(maxBytes, remaining());
+  readAt(m_position, out, n);
+  m_position += n;
+  return n;
+}
+
+std::vector<uint8_t> BlobStream::readChunk(size_t maxBytes) {
+  std::vector<uint8_t> bytes(std::min(maxBytes, remaining()));
+  read(bytes.data(), bytes.size());
+  return bytes;
+}
+
+void BlobStream::write(BlobView data) {
+  writeAt(m_position, data);
+  m_position += data.size();
+}
+
+void BlobStream::seek(size_t position) {
+  checkRange(position, 0);
+  m_position = position;
+}
+
+void BlobStream::reopen(int64_t rowid) {
+  requireOpen();
+  checkError(sqlite3_blob_reopen(m_blob, rowid), "reopen blob");
+  m_position = 0;
+}
+
+void BlobStream::close() {
+  if (m_blob) {
+    sqlite3_blob_close(m_blob);
+    m_blob = nullptr;
+  }
+  m_position = 0;
+}
+
+void BlobStream::requireOpen() const {
+  if (!m_blob) {
+    throw QueryException("blob stream is closed");
+  }
+}
+
+void BlobStream::checkRange(size_t offset, size_t n) const {
+  if (offset > size() || n > size() - offset) {
+    throw QueryException("blob range [" + std::to_string(offset) + ", " +
+                         std::to_string(offset + n) + ") exceeds size " +
+                         std::to_string(size()));
+  }
+}
+
+void BlobStream::checkError(int result, const std::string& context) const {
+  if (result != SQLITE_OK) {
+    throw QueryException(context + ": " + sqlite3_errmsg(m_db));
+  }
+}
+
 // ============================================================
 // TransactionScope Implementation
 // ============================================================
@@ -198,25 +1187,453 @@ TransactionScope::TransactionScope(SqliteDatabase& db)
   m_db.beginTransaction();
 }
 
-TransactionScope::~TransactionScope() {
-  if (!m_finished) {
-    try {
-      m_db.rollback();
-    } catch (...) {
-      // Suppress exceptions in destructor
-    }
+TransactionScope::~TransactionScope() {
+  if (!m_finished) {
+    try {
+      m_db.rollback();
+    } catch (...) {
+      // Suppress exceptions in destructor
+    }
+  }
+}
+
+void TransactionScope::commit() {
+  m_db.commit();
+  m_finished = true;
+}
+
+void TransactionScope::rollback() {
+  m_db.rollback();
+  m_finished = true;
+}
+
+// ============================================================
+// GroupCommitScope Implementation
+// ============================================================
+
+GroupCommitScope::GroupCommitScope(SqliteDatabase& db, size_t flushEvery)
+    : m_db(db), m_finished(false), m_ownsGroup(false) {
+  m_db.beginTransaction();
+
+  // An enclosing group keeps its own settings; this one is plain nesting
+  if (m_db.m_txn.groupDepth == 0) {
+    m_db.m_txn.groupDepth = m_db.m_txn.depth;
+    m_db.m_txn.groupFlushEvery = flushEvery;
+    m_db.m_txn.groupPending = 0;
+    m_ownsGroup = true;
+  }
+}
+
+GroupCommitScope::~GroupCommitScope() {
+  if (!m_finished) {
+    try {
+      m_db.rollback();
+    } catch (...) {
+      // Suppress exceptions in destructor
+    }
+    finish();
+  }
+}
+
+void GroupCommitScope::commit() {
+  m_db.commit();
+  finish();
+}
+
+void GroupCommitScope::rollback() {
+  m_db.rollback();
+  finish();
+}
+
+void GroupCommitScope::finish() {
+  m_finished = true;
+  if (m_ownsGroup) {
+    m_db.m_txn.groupDepth = 0;
+    m_db.m_txn.groupFlushEvery = 0;
+    m_db.m_txn.groupPending = 0;
+  }
+}
+
+// ============================================================
+// SQL Functions Implementation
+// ============================================================
+
+bool SqlFunctionArgs::isNull(int i) const {
+  return sqlite3_value_type(m_values[i]) == SQLITE_NULL;
+}
+
+int64_t SqlFunctionArgs::getInt64(int i) const {
+  return sqlite3_value_int64(m_values[i]);
+}
+
+double SqlFunctionArgs::getDouble(int i) const {
+  return sqlite3_value_double(m_values[i]);
+}
+
+std::string_view SqlFunctionArgs::getText(int i) const {
+  const auto* text =
+      reinterpret_cast<const char*>(sqlite3_value_text(m_values[i]));
+  if (!text) {
+    return {};
+  }
+  return {text, static_cast<size_t>(sqlite3_value_bytes(m_values[i]))};
+}
+
+BlobView SqlFunctionArgs::getBlob(int i) const {
+  const auto* data =
+      static_cast<const uint8_t*>(sqlite3_value_blob(m_values[i]));
+  return {data, static_cast<size_t>(sqlite3_value_bytes(m_values[i]))};
+}
+
+void SqlAggregate::inverse(const SqlFunctionArgs&) {
+  throw std::logic_error("sliding window frames are not supported");
+}
+
+struct SqliteDatabase::SqlFunction {
+  std::string name;
+  int argCount;
+  SqlFunctionOptions options;
+  ScalarFunction scalar;     // set for scalar functions
+  AggregateFactory factory;  // set for aggregates
+};
+
+namespace {
+
+void setResult(sqlite3_context* context, const DbValue& value) {
+  std::visit(
+      [context](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::nullptr_t>) {
+          sqlite3_result_null(context);
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+          sqlite3_result_int64(context, v);
+        } else if constexpr (std::is_same_v<T, double>) {
+          sqlite3_result_double(context, v);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+          sqlite3_result_text(context, v.data(), static_cast<int>(v.size()),
+                              SQLITE_TRANSIENT);
+        } else {
+          sqlite3_result_blob(context, v.data(), static_cast<int>(v.size()),
+                              SQLITE_TRANSIENT);
+        }
+      },
+      value);
+}
+
+// Runs body, turning an exception into the statement's error
+template <typename Function, typename Body>
+void guarded(sqlite3_context* context, const Function& function, Body body) {
+  try {
+    body();
+  } catch (const std::bad_alloc&) {
+    sqlite3_result_error_nomem(context);
+  } catch (const std::exception& e) {
+    const std::string message = function.name + "(): " + e.what();
+    sqlite3_result_error(context, message.c_str(), -1);
+  }
+}
+
+template <typename Function>
+const Function& functionOf(sqlite3_context* context) {
+  return *static_cast<const std::shared_ptr<const Function>*>(
+              sqlite3_user_data(context))
+              ->get();
+}
+
+// An aggregate's SqlAggregate, owned through a pointer in SQLite's
+// per-group context: zeroed, so null, until the first step(), and freed
+// by xFinal, which SQLite also calls when the statement is abandoned
+SqlAggregate** stateOf(sqlite3_context* context, bool create) {
+  return static_cast<SqlAggregate**>(
+      sqlite3_aggregate_context(context, create ? sizeof(SqlAggregate*) : 0));
+}
+
+template <typename Function>
+struct Trampolines {
+  static void call(sqlite3_context* context, int argc, sqlite3_value** argv) {
+    const Function& function = functionOf<Function>(context);
+    guarded(context, function, [&] {
+      setResult(context, function.scalar(SqlFunctionArgs(argc, argv)));
+    });
+  }
+
+  static void step(sqlite3_context* context, int argc, sqlite3_value** argv) {
+    const Function& function = functionOf<Function>(context);
+    guarded(context, function, [&] {
+      SqlAggregate** state = stateOf(context, true);
+      if (!state) {
+        throw std::bad_alloc();
+      }
+      if (!*state) {
+        *state = function.factory().release();
+      }
+      (*state)->step(SqlFunctionArgs(argc, argv));
+    });
+  }
+
+  static void inverse(sqlite3_context* context, int argc,
+                      sqlite3_value** argv) {
+    const Function& function = functionOf<Function>(context);
+    guarded(context, function, [&] {
+      (*stateOf(context, true))->inverse(SqlFunctionArgs(argc, argv));
+    });
+  }
+
+  static void value(sqlite3_context* context) {
+    const Function& function = functionOf<Function>(context);
+    guarded(context, function, [&] {
+      SqlAggregate** state = stateOf(context, false);
+      if (state && *state) {
+        setResult(context, (*state)->value());
+      } else {
+        setResult(context, function.factory()->value());  // no rows
+      }
+    });
+  }
+
+  static void finish(sqlite3_context* context) {
+    value(context);
+    if (SqlAggregate** state = stateOf(context, false)) {
+      delete *state;
+      *state = nullptr;
+    }
+  }
+
+  static void destroy(void* user_data) {
+    delete static_cast<std::shared_ptr<const Function>*>(user_data);
+  }
+};
+
+}  // namespace
+
+// ============================================================
+// Virtual Tables Implementation
+// ============================================================
+
+struct SqliteDatabase::VirtualTableModule {
+  std::string name;
+  std::shared_ptr<VirtualTable> table;
+};
+
+namespace {
+
+DbValue valueOf(sqlite3_value* value) {
+  switch (sqlite3_value_type(value)) {
+    case SQLITE_INTEGER:
+      return static_cast<int64_t>(sqlite3_value_int64(value));
+    case SQLITE_FLOAT:
+      return sqlite3_value_double(value);
+    case SQLITE_TEXT:
+      return std::string(
+          reinterpret_cast<const char*>(sqlite3_value_text(value)),
+          static_cast<size_t>(sqlite3_value_bytes(value)));
+    case SQLITE_BLOB: {
+      const auto* data = static_cast<const uint8_t*>(sqlite3_value_blob(value));
+      return std::vector<uint8_t>(
+          data, data + static_cast<size_t>(sqlite3_value_bytes(value)));
+    }
+    default:
+      return nullptr;
+  }
+}
+
+std::optional<ScanOp> scanOpOf(unsigned char op) {
+  switch (op) {
+    case SQLITE_INDEX_CONSTRAINT_EQ:
+      return ScanOp::Eq;
+    case SQLITE_INDEX_CONSTRAINT_LT:
+      return ScanOp::Lt;
+    case SQLITE_INDEX_CONSTRAINT_LE:
+      return ScanOp::Le;
+    case SQLITE_INDEX_CONSTRAINT_GT:
+      return ScanOp::Gt;
+    case SQLITE_INDEX_CONSTRAINT_GE:
+      return ScanOp::Ge;
+    default:
+      return std::nullopt;
+  }
+}
+
+// Reports the exception as the virtual table's error message
+template <typename Body>
+int guardedVtab(sqlite3_vtab* vtab, Body body) {
+  try {
+    return body();
+  } catch (const std::bad_alloc&) {
+    return SQLITE_NOMEM;
+  } catch (const std::exception& e) {
+    sqlite3_free(vtab->zErrMsg);
+    vtab->zErrMsg = sqlite3_mprintf("%s", e.what());
+    return SQLITE_ERROR;
+  }
+}
+
+// The planner's choice travels from xBestIndex to xFilter as idxStr:
+// "column:op," per handed-over term, in argv order
+template <typename Module>
+struct VtabTrampolines {
+  struct Table {
+    sqlite3_vtab base;  // first, so SQLite's pointer is ours
+    std::shared_ptr<VirtualTable> table;
+  };
+
+  struct Cursor {
+    sqlite3_vtab_cursor base;
+    std::unique_ptr<VirtualTableCursor> rows;
+    bool eof = true;
+    int64_t rowid = 0;
+  };
+
+  static const Module& moduleOf(void* aux) {
+    return **static_cast<const std::shared_ptr<const Module>*>(aux);
+  }
+
+  static int connect(sqlite3* db, void* aux, int, const char* const*,
+                     sqlite3_vtab** out, char** error) {
+    try {
+      const Module& module = moduleOf(aux);
+      const std::string schema = module.table->schema();
+      if (sqlite3_declare_vtab(db, schema.c_str()) != SQLITE_OK) {
+        *error = sqlite3_mprintf("%s", sqlite3_errmsg(db));
+        return SQLITE_ERROR;
+      }
+      auto* table = new Table{};
+      table->table = module.table;
+      *out = &table->base;
+      return SQLITE_OK;
+    } catch (const std::exception& e) {
+      *error = sqlite3_mprintf("%s", e.what());
+      return SQLITE_ERROR;
+    }
+  }
+
+  static int disconnect(sqlite3_vtab* vtab) {
+    delete reinterpret_cast<Table*>(vtab);
+    return SQLITE_OK;
+  }
+
+  static int bestIndex(sqlite3_vtab* vtab, sqlite3_index_info* info) {
+    return guardedVtab(vtab, [&] {
+      const auto& table = *reinterpret_cast<Table*>(vtab)->table;
+      std::string plan;
+      int argc = 0;
+      double rows = 1e6;
+      for (int i = 0; i < info->nConstraint; ++i) {
+        const auto& constraint = info->aConstraint[i];
+        const auto op = scanOpOf(constraint.op);
+        if (!constraint.usable || !op || constraint.iColumn < 0 ||
+            !table.filters(constraint.iColumn, *op)) {
+          continue;
+        }
+        info->aConstraintUsage[i].argvIndex = ++argc;
+        info->aConstraintUsage[i].omit = 1;
+        plan += std::to_string(constraint.iColumn) + ":" +
+                std::to_string(static_cast<int>(*op)) + ",";
+        rows /= *op == ScanOp::Eq ? 100.0 : 4.0;
+      }
+      info->estimatedRows = static_cast<sqlite3_int64>(std::max(rows, 1.0));
+      info->estimatedCost = std::max(rows, 1.0);
+      info->idxStr = sqlite3_mprintf("%s", plan.c_str());
+      if (!info->idxStr) {
+        return SQLITE_NOMEM;
+      }
+      info->needToFreeIdxStr = 1;
+      return SQLITE_OK;
+    });
+  }
+
+  static int open(sqlite3_vtab*, sqlite3_vtab_cursor** out) {
+    auto* cursor = new (std::nothrow) Cursor{};
+    if (!cursor) {
+      return SQLITE_NOMEM;
+    }
+    *out = &cursor->base;
+    return SQLITE_OK;
+  }
+
+  static int close(sqlite3_vtab_cursor* cursor) {
+    delete reinterpret_cast<Cursor*>(cursor);
+    return SQLITE_OK;
+  }
+
+  static int filter(sqlite3_vtab_cursor* base, int, const char* plan, int argc,
+                    sqlite3_value** argv) {
+    auto* cursor = reinterpret_cast<Cursor*>(base);
+    cursor->rows.reset();
+    cursor->eof = true;
+    return guardedVtab(base->pVtab, [&] {
+      std::vector<ScanConstraint> constraints;
+      constraints.reserve(static_cast<size_t>(argc));
+      const char* p = plan ? plan : "";
+      for (int i = 0; i < argc && *p; ++i) {
+        char* end = nullptr;
+        const auto column = static_cast<int>(std::strtol(p, &end, 10));
+        const auto op = static_cast<ScanOp>(std::strtol(end + 1, &end, 10));
+        constraints.push_back({column, op, valueOf(argv[i])});
+        p = end + 1;
+      }
+      auto& table = *reinterpret_cast<Table*>(base->pVtab)->table;
+      cursor->rows = table.scan(constraints);
+      cursor->rowid = 0;
+      cursor->eof = !cursor->rows || !cursor->rows->next();
+      return SQLITE_OK;
+    });
+  }
+
+  static int next(sqlite3_vtab_cursor* base) {
+    auto* cursor = reinterpret_cast<Cursor*>(base);
+    return guardedVtab(base->pVtab, [&] {
+      cursor->eof = !cursor->rows->next();
+      ++cursor->rowid;
+      return SQLITE_OK;
+    });
+  }
+
+  static int eof(sqlite3_vtab_cursor* cursor) {
+    return reinterpret_cast<Cursor*>(cursor)->eof ? 1 : 0;
+  }
+
+  static int column(sqlite3_vtab_cursor* base, sqlite3_context* context,
+                    int i) {
+    auto* cursor = reinterpret_cast<Cursor*>(base);
+    return guardedVtab(base->pVtab, [&] {
+      setResult(context, cursor->rows->column(i));
+      return SQLITE_OK;
+    });
+  }
+
+  static int rowid(sqlite3_vtab_cursor* cursor, sqlite3_int64* out) {
+    *out = reinterpret_cast<Cursor*>(cursor)->rowid;
+    return SQLITE_OK;
+  }
+
+  static void destroy(void* aux) {
+    delete static_cast<std::shared_ptr<const Module>*>(aux);
   }
-}
 
-void TransactionScope::commit() {
-  m_db.commit();
-  m_finished = true;
-}
+  // No xCreate: eponymous-only, so the table exists on every connection
+  // the module is registered on, without a schema entry
+  static const sqlite3_module* module() {
+    static const sqlite3_module instance = [] {
+      sqlite3_module m{};
+      m.xConnect = &connect;
+      m.xBestIndex = &bestIndex;
+      m.xDisconnect = &disconnect;
+      m.xDestroy = &disconnect;
+      m.xOpen = &open;
+      m.xClose = &close;
+      m.xFilter = &filter;
+      m.xNext = &next;
+      m.xEof = &eof;
+      m.xColumn = &column;
+      m.xRowid = &rowid;
+      return m;
+    }();
+    return &instance;
+  }
+};
 
-void TransactionScope::rollback() {
-  m_db.rollback();
-  m_finished = true;
-}
+}  // namespace
 
 // ============================================================
 // SqliteDatabase Implementation
@@ -227,25 +1644,55 @@ SqliteDatabase::SqliteDatabase(const std::string& path) { open(path); }
 SqliteDatabase::~SqliteDatabase() { close(); }
 
 SqliteDatabase::SqliteDatabase(SqliteDatabase&& other) noexcept
-    : m_db(other.m_db) {
+    : m_db(other.m_db),
+      m_statementCache(std::move(other.m_statementCache)),
+      m_statementCacheCapacity(other.m_statementCacheCapacity),
+      m_bulkInsertChunkRows(other.m_bulkInsertChunkRows),
+      m_txn(other.m_txn),
+      m_profiler(std::move(other.m_profiler)),
+      m_profilingEnabled(other.m_profilingEnabled),
+      m_notifier(std::move(other.m_notifier)),
+      m_functions(std::move(other.m_functions)),
+      m_virtualTables(std::move(other.m_virtualTables)) {
   other.m_db = nullptr;
+  other.m_profilingEnabled = false;
+  other.m_txn = {};
 }
 
 SqliteDatabase& SqliteDatabase::operator=(SqliteDatabase&& other) noexcept {
   if (this != &other) {
     close();
     m_db = other.m_db;
+    m_statementCache = std::move(other.m_statementCache);
+    m_statementCacheCapacity = other.m_statementCacheCapacity;
+    m_bulkInsertChunkRows = other.m_bulkInsertChunkRows;
+    m_txn = other.m_txn;
+    m_profiler = std::move(other.m_profiler);
+    m_profilingEnabled = other.m_profilingEnabled;
+    m_notifier = std::move(other.m_notifier);
+    m_functions = std::move(other.m_functions);
+    m_virtualTables = std::move(other.m_virtualTables);
     other.m_db = nullptr;
+    other.m_txn = {};
+    other.m_profilingEnabled = false;
   }
   return *this;
 }
 
 void SqliteDatabase::open(const std::string& path) {
+  openWithFlags(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+}
+
+void SqliteDatabase::openReadOnly(const std::string& path) {
+  openWithFlags(path, SQLITE_OPEN_READONLY);
+}
+
+void SqliteDatabase::openWithFlags(const std::string& path, int flags) {
   if (m_db) {
     close();
   }
 
-  int result = sqlite3_open(path.c_str(), &m_db);
+  int result = sqlite3_open_v2(path.c_str(), &m_db, flags, nullptr);
   if (result != SQLITE_OK) {
     std::string error = m_db ? sqlite3_errmsg(m_db) : "Unknown error";
     if (m_db) {
@@ -255,26 +1702,55 @@ void SqliteDatabase::open(const std::string& path) {
     throw ConnectionException(error);
   }
 
+  m_statementCache = std::make_shared<StatementCache>(m_statementCacheCapacity);
+  if (m_profilingEnabled) {
+    profiler().attach(m_db);
+  }
+  notifier().attach(m_db);
   enableForeignKeys(true);
+  for (const auto& function : m_functions) {
+    registerFunction(function);
+  }
+  for (const auto& module : m_virtualTables) {
+    registerVirtualTable(module);
+  }
 }
 
 void SqliteDatabase::close() {
+  // Finalize idle cached statements before closing the connection
+  m_statementCache.reset();
+
   if (m_db) {
+    if (m_profiler) {
+      m_profiler->detach(m_db);
+    }
+    if (m_notifier) {
+      m_notifier->detach(m_db);
+    }
     sqlite3_close(m_db);
     m_db = nullptr;
   }
+  m_txn = TransactionState{0, 0, 0, 0, m_txn.stats};
+  // Closing rolled back any open transaction
+  endTransactionActions(0, false);
 }
 
 bool SqliteDatabase::isOpen() const { return m_db != nullptr; }
 
 std::unique_ptr<IStatement> SqliteDatabase::prepare(const std::string& sql) {
+  TRACE_SPAN("database", "SqliteDatabase::prepare");
   if (!m_db) {
     throw ConnectionException("Database not open");
   }
+  if (m_statementCache) {
+    return std::make_unique<SqliteStatement>(m_db, sql, m_statementCache,
+                                             m_notifier);
+  }
   return std::make_unique<SqliteStatement>(m_db, sql);
 }
 
 void SqliteDatabase::execute(const std::string& sql) {
+  TRACE_SPAN("database", "SqliteDatabase::execute");
   if (!m_db) {
     throw ConnectionException("Database not open");
   }
@@ -285,8 +1761,15 @@ void SqliteDatabase::execute(const std::string& sql) {
   if (result != SQLITE_OK) {
     std::string error = errorMsg ? errorMsg : "Unknown error";
     sqlite3_free(errorMsg);
+    if ((result & 0xff) == SQLITE_CONSTRAINT) {
+      throw ConstraintException(error);
+    }
     throw QueryException(error);
   }
+
+  if (m_notifier) {
+    m_notifier->deliver();
+  }
 }
 
 DbResult SqliteDatabase::query(const std::string& sql) {
@@ -294,16 +1777,294 @@ DbResult SqliteDatabase::query(const std::string& sql) {
   return stmt->execute();
 }
 
-void SqliteDatabase::beginTransaction() { execute("BEGIN TRANSACTION"); }
+size_t SqliteDatabase::query(const std::string& sql,
+                             const RowCallback& callback) {
+  auto stmt = prepare(sql);
+  return stmt->forEachRow(callback);
+}
+
+namespace {
+
+std::string savepointName(int depth) { return "sp_" + std::to_string(depth); }
+
+}  // namespace
+
+ColumnarResult SqliteDatabase::queryColumns(
+    const std::string& sql, const std::vector<DbValue>& params,
+    const std::vector<ColumnKind>& kinds) {
+  if (!m_db) {
+    throw ConnectionException("Database not open");
+  }
+
+  SqliteStatement stmt(m_db, sql, m_statementCache);
+  for (size_t i = 0; i < params.size(); ++i) {
+    stmt.bindValueStatic(static_cast<int>(i + 1), params[i]);
+  }
+  return stmt.fetchColumns(kinds);
+}
+
+namespace {
+
+// Copies src's main database into dest's page by page
+void runBackup(sqlite3* dest, sqlite3* src, const BackupOptions& options) {
+  sqlite3_backup* backup = sqlite3_backup_init(dest, "main", src, "main");
+  if (!backup) {
+    throw QueryException("backup: " + std::string(sqlite3_errmsg(dest)));
+  }
+
+  const int pagesPerStep = options.pagesPerStep == 0 ? -1
+                                                     : options.pagesPerStep;
+  const auto busyDelay =
+      std::max(options.sleepBetweenSteps, std::chrono::milliseconds(1));
+  int busyRetries = 0;
+  bool cancelled = false;
+
+  int result;
+  do {
+    result = sqlite3_backup_step(backup, pagesPerStep);
+
+    if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+      if (++busyRetries > options.maxBusyRetries) {
+        break;
+      }
+      std::this_thread::sleep_for(busyDelay);
+      continue;
+    }
+    busyRetries = 0;
+
+    if ((result == SQLITE_OK || result == SQLITE_DONE) &&
+        options.onProgress) {
+      BackupProgress progress{sqlite3_backup_remaining(backup),
+                              sqlite3_backup_pagecount(backup)};
+      if (!options.onProgress(progress)) {
+        cancelled = true;
+        break;
+      }
+    }
+
+    if (result == SQLITE_OK && options.sleepBetweenSteps.count() > 0) {
+      std::this_thread::sleep_for(options.sleepBetweenSteps);
+    }
+  } while (result == SQLITE_OK || result == SQLITE_BUSY ||
+           result == SQLITE_LOCKED);
+
+  sqlite3_backup_finish(backup);
+
+  if (cancelled && result != SQLITE_DONE) {
+    throw DatabaseException("Backup cancelled");
+  }
+  if (result != SQLITE_DONE) {
+    throw QueryException("backup: " + std::string(sqlite3_errstr(result)));
+  }
+}
+
+}  // namespace
+
+void SqliteDatabase::backupTo(SqliteDatabase& target,
+                              const BackupOptions& options) {
+  if (!m_db || !target.m_db) {
+    throw ConnectionException("Database not open");
+  }
+  if (target.m_db == m_db) {
+    throw QueryException("backup: source and target are the same");
+  }
+
+  // Idle cached statements would keep the target's schema pinned
+  target.clearStatementCache();
+  runBackup(target.m_db, m_db, options);
+}
+
+void SqliteDatabase::backupTo(const std::string& path,
+                              const BackupOptions& options) {
+  SqliteDatabase target(path);
+  backupTo(target, options);
+}
+
+void SqliteDatabase::restoreFrom(const std::string& path,
+                                 const BackupOptions& options) {
+  if (!m_db) {
+    throw ConnectionException("Database not open");
+  }
+
+  SqliteDatabase source;
+  source.openReadOnly(path);
+  source.backupTo(*this, options);
+  syncTransactionState();
+}
+
+SqliteDatabase SqliteDatabase::openInMemoryCopy(const std::string& path) {
+  SqliteDatabase copy(":memory:");
+  BackupOptions options;
+  options.pagesPerStep = -1;
+  copy.restoreFrom(path, options);
+  return copy;
+}
+
+BlobStream SqliteDatabase::openBlobReader(const std::string& table,
+                                          const std::string& column,
+                                          int64_t rowid) {
+  if (!m_db) {
+    throw ConnectionException("Database not open");
+  }
+  return BlobStream(m_db, table, column, rowid, false);
+}
+
+BlobStream SqliteDatabase::openBlobWriter(const std::string& table,
+                                          const std::string& column,
+                                          int64_t rowid) {
+  if (!m_db) {
+    throw ConnectionException("Database not open");
+  }
+  return BlobStream(m_db, table, column, rowid, true);
+}
+
+size_t SqliteDatabase::queryInto(const std::string& sql,
+                                 ArenaResult& result) {
+  if (!m_db) {
+    throw ConnectionException("Database not open");
+  }
+
+  SqliteStatement stmt(m_db, sql, m_statementCache, m_notifier);
+  return stmt.execute(result);
+}
+
+void SqliteDatabase::beginTransaction() {
+  syncTransactionState();
+
+  if (m_txn.depth == 0) {
+    execute("BEGIN TRANSACTION");
+    ++m_txn.stats.begins;
+  } else {
+    execute("SAVEPOINT " + savepointName(m_txn.depth));
+    ++m_txn.stats.savepoints;
+    notifier().savepoint(m_txn.depth);
+  }
+  ++m_txn.depth;
+}
+
+void SqliteDatabase::commit() {
+  TRACE_SPAN("database", "SqliteDatabase::commit");
+  syncTransactionState();
+
+  // Depth 0 still issues COMMIT so the "no transaction" error surfaces
+  if (m_txn.depth <= 1) {
+    execute("COMMIT");
+    ++m_txn.stats.commits;
+    m_txn = TransactionState{0, 0, 0, 0, m_txn.stats};
+    endTransactionActions(0, true);
+    return;
+  }
+
+  execute("RELEASE " + savepointName(m_txn.depth - 1));
+  ++m_txn.stats.releases;
+  --m_txn.depth;
+  notifier().releaseSavepoint(m_txn.depth);
+  // The released savepoint's work now belongs to the enclosing level
+  for (auto& entry : m_endActions) {
+    entry.first = std::min(entry.first, m_txn.depth);
+  }
+
+  if (m_txn.depth == m_txn.groupDepth) {
+    onGroupedCommit();
+  }
+}
+
+void SqliteDatabase::rollback() {
+  syncTransactionState();
+
+  if (m_txn.depth <= 1) {
+    execute("ROLLBACK");
+    ++m_txn.stats.rollbacks;
+    m_txn = TransactionState{0, 0, 0, 0, m_txn.stats};
+    endTransactionActions(0, false);
+    return;
+  }
 
-void SqliteDatabase::commit() { execute("COMMIT"); }
+  // ROLLBACK TO keeps the savepoint open, so release it afterwards
+  std::string name = savepointName(m_txn.depth - 1);
+  execute("ROLLBACK TO " + name);
+  execute("RELEASE " + name);
+  ++m_txn.stats.savepointRollbacks;
+  --m_txn.depth;
+  notifier().rollbackToSavepoint(m_txn.depth);
+  endTransactionActions(m_txn.depth, false);
+}
 
-void SqliteDatabase::rollback() { execute("ROLLBACK"); }
+void SqliteDatabase::onTransactionEnd(TransactionEndAction action) {
+  syncTransactionState();
+  if (m_txn.depth == 0) {
+    action(true);
+    return;
+  }
+  m_endActions.emplace_back(m_txn.depth, std::move(action));
+}
 
 TransactionScope SqliteDatabase::transaction() {
   return TransactionScope(*this);
 }
 
+GroupCommitScope SqliteDatabase::groupCommit(size_t flushEvery) {
+  return GroupCommitScope(*this, flushEvery);
+}
+
+bool SqliteDatabase::inTransaction() const {
+  return m_db && sqlite3_get_autocommit(m_db) == 0;
+}
+
+int SqliteDatabase::transactionDepth() const {
+  return inTransaction() ? m_txn.depth : 0;
+}
+
+TransactionStats SqliteDatabase::transactionStats() const {
+  return m_txn.stats;
+}
+
+void SqliteDatabase::resetTransactionStats() { m_txn.stats = {}; }
+
+void SqliteDatabase::syncTransactionState() {
+  // SQLite can end a transaction on its own (e.g. ROLLBACK on SQLITE_FULL)
+  if (!inTransaction()) {
+    m_txn = TransactionState{0, 0, 0, 0, m_txn.stats};
+    endTransactionActions(0, false);
+  }
+}
+
+void SqliteDatabase::onGroupedCommit() {
+  ++m_txn.stats.groupedCommits;
+  ++m_txn.groupPending;
+
+  // Only a top-level group can commit physically part-way through
+  if (m_txn.groupFlushEvery > 0 && m_txn.groupDepth == 1 &&
+      m_txn.groupPending >= m_txn.groupFlushEvery) {
+    execute("COMMIT");
+    ++m_txn.stats.commits;
+    endTransactionActions(0, true);
+    execute("BEGIN TRANSACTION");
+    ++m_txn.stats.begins;
+    m_txn.groupPending = 0;
+  }
+}
+
+void SqliteDatabase::endTransactionActions(int depth, bool committed) {
+  if (m_endActions.empty()) {
+    return;
+  }
+  std::vector<TransactionEndAction> due;
+  std::vector<std::pair<int, TransactionEndAction>> kept;
+  for (auto& entry : m_endActions) {
+    if (entry.first > depth) {
+      due.push_back(std::move(entry.second));
+    } else {
+      kept.push_back(std::move(entry));
+    }
+  }
+  // An action may start the next transaction
+  m_endActions = std::move(kept);
+  for (auto& action : due) {
+    action(committed);
+  }
+}
+
 int64_t SqliteDatabase::lastInsertRowId() const {
   return m_db ? sqlite3_last_insert_rowid(m_db) : 0;
 }
@@ -312,6 +2073,10 @@ int SqliteDatabase::changesCount() const {
   return m_db ? sqlite3_changes(m_db) : 0;
 }
 
+int64_t SqliteDatabase::totalChanges() const {
+  return m_db ? static_cast<int64_t>(sqlite3_total_changes(m_db)) : 0;
+}
+
 void SqliteDatabase::enableForeignKeys(bool enable) {
   execute(enable ? "PRAGMA foreign_keys = ON" : "PRAGMA foreign_keys = OFF");
 }
@@ -320,14 +2085,224 @@ void SqliteDatabase::setJournalMode(const std::string& mode) {
   execute("PRAGMA journal_mode = " + mode);
 }
 
-int SqliteDatabase::bulkInsert(const std::string& table,
-                               const std::vector<std::string>& columns,
-                               const std::vector<std::vector<DbValue>>& rows) {
-  if (rows.empty()) {
-    return 0;
+void SqliteDatabase::setBusyTimeout(int milliseconds) {
+  if (!m_db) {
+    throw ConnectionException("Database not open");
+  }
+  sqlite3_busy_timeout(m_db, milliseconds);
+}
+
+void SqliteDatabase::setStatementCacheCapacity(size_t capacity) {
+  m_statementCacheCapacity = capacity;
+  if (m_statementCache) {
+    m_statementCache->setCapacity(capacity);
+  }
+}
+
+void SqliteDatabase::clearStatementCache() {
+  if (m_statementCache) {
+    m_statementCache->clear();
+  }
+}
+
+StatementCacheStats SqliteDatabase::statementCacheStats() const {
+  if (!m_statementCache) {
+    StatementCacheStats stats;
+    stats.capacity = m_statementCacheCapacity;
+    return stats;
+  }
+  return m_statementCache->stats();
+}
+
+void SqliteDatabase::enableProfiling(bool enable) {
+  m_profilingEnabled = enable;
+  if (!m_db) {
+    return;
+  }
+  if (enable) {
+    profiler().attach(m_db);
+  } else if (m_profiler) {
+    m_profiler->detach(m_db);
+  }
+}
+
+bool SqliteDatabase::profilingEnabled() const { return m_profilingEnabled; }
+
+void SqliteDatabase::setSlowQueryLog(std::chrono::nanoseconds threshold,
+                                     SlowQueryCallback callback) {
+  profiler().setSlowQueryLog(threshold, std::move(callback));
+}
+
+std::vector<QueryProfile> SqliteDatabase::queryProfile() const {
+  return m_profiler ? m_profiler->snapshot() : std::vector<QueryProfile>();
+}
+
+std::vector<SlowQuery> SqliteDatabase::slowQueries() const {
+  return m_profiler ? m_profiler->slowQueries() : std::vector<SlowQuery>();
+}
+
+void SqliteDatabase::resetQueryProfile() {
+  if (m_profiler) {
+    m_profiler->reset();
+  }
+}
+
+size_t SqliteDatabase::subscribeChanges(ChangeCallback callback) {
+  return notifier().subscribe(std::move(callback));
+}
+
+void SqliteDatabase::unsubscribeChanges(size_t id) {
+  if (m_notifier) {
+    m_notifier->unsubscribe(id);
+  }
+}
+
+void SqliteDatabase::createFunction(const std::string& name, int argCount,
+                                    ScalarFunction function,
+                                    const SqlFunctionOptions& options) {
+  if (!function) {
+    throw std::invalid_argument("SQL function needs a body");
+  }
+  auto definition = std::make_shared<SqlFunction>(
+      SqlFunction{name, argCount, options, std::move(function), nullptr});
+  definition->options.window = false;
+  addFunction(std::move(definition));
+}
+
+void SqliteDatabase::createAggregate(const std::string& name, int argCount,
+                                     AggregateFactory factory,
+                                     const SqlFunctionOptions& options) {
+  if (!factory) {
+    throw std::invalid_argument("SQL aggregate needs a factory");
+  }
+  auto definition = std::make_shared<SqlFunction>(
+      SqlFunction{name, argCount, options, nullptr, std::move(factory)});
+  addFunction(std::move(definition));
+}
+
+void SqliteDatabase::addFunction(std::shared_ptr<const SqlFunction> function) {
+  registerFunction(function);
+  // A registration with the same name and argCount is replaced
+  m_functions.erase(
+      std::remove_if(m_functions.begin(), m_functions.end(),
+                     [&function](const auto& other) {
+                       return other->argCount == function->argCount &&
+                              sqlite3_stricmp(other->name.c_str(),
+                                              function->name.c_str()) == 0;
+                     }),
+      m_functions.end());
+  m_functions.push_back(std::move(function));
+}
+
+void SqliteDatabase::registerFunction(
+    const std::shared_ptr<const SqlFunction>& function) {
+  if (!m_db) {
+    return;  // registered by open()
+  }
+  using Calls = Trampolines<SqlFunction>;
+  const int flags = SQLITE_UTF8 | (function->options.deterministic
+                                       ? SQLITE_DETERMINISTIC
+                                       : 0);
+  // SQLite owns a reference and drops it through destroy(), also when
+  // the function is replaced or the call fails
+  auto* user_data = new std::shared_ptr<const SqlFunction>(function);
+  int result;
+  if (function->scalar) {
+    result = sqlite3_create_function_v2(
+        m_db, function->name.c_str(), function->argCount, flags, user_data,
+        &Calls::call, nullptr, nullptr, &Calls::destroy);
+  } else if (function->options.window) {
+    result = sqlite3_create_window_function(
+        m_db, function->name.c_str(), function->argCount, flags, user_data,
+        &Calls::step, &Calls::finish, &Calls::value, &Calls::inverse,
+        &Calls::destroy);
+  } else {
+    result = sqlite3_create_function_v2(
+        m_db, function->name.c_str(), function->argCount, flags, user_data,
+        nullptr, &Calls::step, &Calls::finish, &Calls::destroy);
+  }
+  if (result != SQLITE_OK) {
+    throw DatabaseException("Cannot register SQL function " +
+                            function->name + ": " + sqlite3_errmsg(m_db));
+  }
+}
+
+void SqliteDatabase::createVirtualTable(const std::string& name,
+                                        std::shared_ptr<VirtualTable> table) {
+  if (!table) {
+    throw std::invalid_argument("Virtual table needs an implementation");
+  }
+  auto module = std::make_shared<VirtualTableModule>(
+      VirtualTableModule{name, std::move(table)});
+  // Cached statements still read the table they were prepared with
+  clearStatementCache();
+  registerVirtualTable(module);
+  m_virtualTables.erase(
+      std::remove_if(m_virtualTables.begin(), m_virtualTables.end(),
+                     [&name](const auto& other) {
+                       return sqlite3_stricmp(other->name.c_str(),
+                                              name.c_str()) == 0;
+                     }),
+      m_virtualTables.end());
+  m_virtualTables.push_back(std::move(module));
+}
+
+void SqliteDatabase::registerVirtualTable(
+    const std::shared_ptr<const VirtualTableModule>& module) {
+  if (!m_db) {
+    return;  // registered by open()
   }
+  using Calls = VtabTrampolines<VirtualTableModule>;
+  // As for functions, SQLite frees its reference through destroy()
+  auto* aux = new std::shared_ptr<const VirtualTableModule>(module);
+  if (sqlite3_create_module_v2(m_db, module->name.c_str(), Calls::module(),
+                               aux, &Calls::destroy) != SQLITE_OK) {
+    throw DatabaseException("Cannot register virtual table " + module->name +
+                            ": " + sqlite3_errmsg(m_db));
+  }
+}
+
+ChangeNotifier& SqliteDatabase::notifier() {
+  if (!m_notifier) {
+    m_notifier = std::make_shared<ChangeNotifier>();
+  }
+  return *m_notifier;
+}
+
+QueryProfiler& SqliteDatabase::profiler() {
+  if (!m_profiler) {
+    m_profiler = std::make_unique<QueryProfiler>();
+  }
+  return *m_profiler;
+}
+
+void SqliteDatabase::setBulkInsertChunkRows(size_t rows) {
+  m_bulkInsertChunkRows = rows;
+}
+
+size_t SqliteDatabase::bulkInsertChunkRows(size_t columnCount) const {
+  if (columnCount == 0) {
+    return 1;
+  }
+
+  // 999 is the lowest limit any SQLite build has shipped with
+  int limit =
+      m_db ? sqlite3_limit(m_db, SQLITE_LIMIT_VARIABLE_NUMBER, -1) : 999;
+  size_t maxRows =
+      std::max<size_t>(1, static_cast<size_t>(limit) / columnCount);
+
+  if (m_bulkInsertChunkRows == kAutoChunkRows) {
+    return std::min(maxRows, kMaxAutoChunkRows);
+  }
+  return std::min(maxRows, m_bulkInsertChunkRows);
+}
 
-  // Build: INSERT INTO table (c1, c2, ...) VALUES (?, ?, ...)
+namespace {
+
+// Builds: INSERT INTO table (c1, c2, ...) VALUES (?, ?, ...), (?, ?, ...)
+std::string buildInsertSql(const std::string& table,
+                           const std::vector<std::string>& columns,
+                           size_t rowCount) {
   std::ostringstream sql;
   sql << "INSERT INTO " << table << " (";
 
@@ -336,19 +2311,61 @@ int SqliteDatabase::bulkInsert(const std::string& table,
     sql << columns[i];
   }
 
-  sql << ") VALUES (";
+  sql << ") VALUES ";
 
-  for (size_t i = 0; i < columns.size(); ++i) {
-    if (i > 0) sql << ", ";
-    sql << "?";
+  for (size_t row = 0; row < rowCount; ++row) {
+    if (row > 0) sql << ", ";
+    sql << "(";
+    for (size_t i = 0; i < columns.size(); ++i) {
+      if (i > 0) sql << ", ";
+      sql << "?";
+    }
+    sql << ")";
   }
-  sql << ")";
 
-  auto stmt = prepare(sql.str());
-  auto* sqliteStmt = dynamic_cast<SqliteStatement*>(stmt.get());
+  return sql.str();
+}
+
+}  // namespace
+
+int SqliteDatabase::bulkInsert(const std::string& table,
+                               const std::vector<std::string>& columns,
+                               const std::vector<std::vector<DbValue>>& rows) {
+  if (rows.empty()) {
+    return 0;
+  }
+
+  // Rows are bound back to back, so a short row would shift the next one
+  for (const auto& row : rows) {
+    if (row.size() != columns.size()) {
+      throw QueryException("bulkInsert: expected " +
+                           std::to_string(columns.size()) +
+                           " values per row, got " +
+                           std::to_string(row.size()));
+    }
+  }
+
+  const size_t chunkRows =
+      std::min(bulkInsertChunkRows(columns.size()), rows.size());
+  const size_t chunkedCount = rows.size() - rows.size() % chunkRows;
+  const size_t tailCount = rows.size() - chunkedCount;
 
   auto txn = transaction();
-  int totalInserted = sqliteStmt->executeBatch(rows);
+  int totalInserted = 0;
+
+  if (chunkedCount > 0) {
+    auto stmt = prepare(buildInsertSql(table, columns, chunkRows));
+    auto* sqliteStmt = dynamic_cast<SqliteStatement*>(stmt.get());
+    totalInserted += sqliteStmt->executeBatch(rows, 0, chunkedCount, chunkRows);
+  }
+
+  if (tailCount > 0) {
+    auto stmt = prepare(buildInsertSql(table, columns, tailCount));
+    auto* sqliteStmt = dynamic_cast<SqliteStatement*>(stmt.get());
+    totalInserted +=
+        sqliteStmt->executeBatch(rows, chunkedCount, tailCount, tailCount);
+  }
+
   txn.commit();
 
   return totalInserted;
@@ -383,11 +2400,13 @@ DbResult SqliteDatabase::bulkSelect(
 
   DbResult combinedResults;
 
+  // The statement is destroyed (and its bindings cleared) before
+  // paramSets goes out of scope, so values can be borrowed
   for (const auto& params : paramSets) {
     stmt->reset();
 
     for (size_t i = 0; i < params.size(); ++i) {
-      sqliteStmt->bindValue(static_cast<int>(i + 1), params[i]);
+      sqliteStmt->bindValueStatic(static_cast<int>(i + 1), params[i]);
     }
 
     DbResult rows = stmt->execute();
@@ -399,4 +2418,48 @@ DbResult SqliteDatabase::bulkSelect(
   return combinedResults;
 }
 
+DbResult SqliteDatabase::selectByKeys(const std::string& table,
+                                      const std::vector<std::string>& columns,
+                                      const std::string& keyColumn,
+                                      const std::vector<DbValue>& keys) {
+  if (keys.empty()) {
+    return {};
+  }
+
+  std::ostringstream sql;
+  sql << "SELECT k.key";
+  for (const auto& column : columns) {
+    sql << ", t." << column;
+  }
+  sql << " FROM json_each(?) AS k JOIN " << table << " AS t ON t."
+      << keyColumn << " = k.value ORDER BY k.key";
+
+  auto stmt = prepare(sql.str());
+  stmt->bind(1, toJsonArray(keys));
+  return stmt->execute();
+}
+
+size_t SqliteDatabase::bulkSelectInto(
+    const std::string& sql, const std::vector<std::vector<DbValue>>& paramSets,
+    ArenaResult& result) {
+  if (paramSets.empty()) {
+    return 0;
+  }
+  if (!m_db) {
+    throw ConnectionException("Database not open");
+  }
+
+  SqliteStatement stmt(m_db, sql, m_statementCache, m_notifier);
+
+  size_t rows = 0;
+  for (const auto& params : paramSets) {
+    stmt.reset();
+    for (size_t i = 0; i < params.size(); ++i) {
+      stmt.bindValueStatic(static_cast<int>(i + 1), params[i]);
+    }
+    rows += stmt.execute(result);
+  }
+  return rows;
+}
+
 }  // namespace Gateways::Database
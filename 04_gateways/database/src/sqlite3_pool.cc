@@ -0,0 +1,410 @@
+#include "sqlite3_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Gateways::Database {
+
+namespace {
+
+// Connections to these paths never share data, so readers are useless
+bool isSharedFile(const std::string& path) {
+  return !path.empty() && path != ":memory:" &&
+         path.find("mode=memory") == std::string::npos;
+}
+
+// ============================================================
+// PooledStatement - keeps the lease alive for the statement
+// ============================================================
+
+class PooledStatement : public IStatement {
+ public:
+  PooledStatement(ConnectionLease lease, std::unique_ptr<IStatement> stmt)
+      : m_lease(std::move(lease)), m_stmt(std::move(stmt)) {}
+
+  IStatement& bind(int index, std::nullptr_t) override {
+    m_stmt->bind(index, nullptr);
+    return *this;
+  }
+  IStatement& bind(int index, int64_t value) override {
+    m_stmt->bind(index, value);
+    return *this;
+  }
+  IStatement& bind(int index, double value) override {
+    m_stmt->bind(index, value);
+    return *this;
+  }
+  IStatement& bind(int index, const std::string& value) override {
+    m_stmt->bind(index, value);
+    return *this;
+  }
+  IStatement& bind(int index, const std::vector<uint8_t>& blob) override {
+    m_stmt->bind(index, blob);
+    return *this;
+  }
+  IStatement& bindStatic(int index, std::string_view value) override {
+    m_stmt->bindStatic(index, value);
+    return *this;
+  }
+  IStatement& bindStatic(int index, BlobView blob) override {
+    m_stmt->bindStatic(index, blob);
+    return *this;
+  }
+
+  DbResult execute() override { return m_stmt->execute(); }
+  int64_t executeInsert() override { return m_stmt->executeInsert(); }
+  int executeUpdate() override { return m_stmt->executeUpdate(); }
+  void reset() override { m_stmt->reset(); }
+
+  bool step() override { return m_stmt->step(); }
+  int columnCount() const override { return m_stmt->columnCount(); }
+  bool columnIsNull(int col) const override {
+    return m_stmt->columnIsNull(col);
+  }
+  int64_t columnInt64(int col) const override {
+    return m_stmt->columnInt64(col);
+  }
+  double columnDouble(int col) const override {
+    return m_stmt->columnDouble(col);
+  }
+  std::string_view columnText(int col) const override {
+    return m_stmt->columnText(col);
+  }
+  BlobView columnBlob(int col) const override {
+    return m_stmt->columnBlob(col);
+  }
+  DbValue columnValue(int col) const override {
+    return m_stmt->columnValue(col);
+  }
+
+ private:
+  // Declared first so the statement is finalized before the lease ends
+  ConnectionLease m_lease;
+  std::unique_ptr<IStatement> m_stmt;
+};
+
+}  // namespace
+
+// ============================================================
+// ConnectionLease Implementation
+// ============================================================
+
+ConnectionLease::ConnectionLease(SqlitePool* pool, SqliteDatabase* db,
+                                 bool writer)
+    : m_pool(pool), m_db(db), m_writer(writer) {}
+
+ConnectionLease::~ConnectionLease() { release(); }
+
+ConnectionLease::ConnectionLease(ConnectionLease&& other) noexcept
+    : m_pool(other.m_pool), m_db(other.m_db), m_writer(other.m_writer) {
+  other.m_pool = nullptr;
+  other.m_db = nullptr;
+}
+
+ConnectionLease& ConnectionLease::operator=(ConnectionLease&& other) noexcept {
+  if (this != &other) {
+    release();
+    m_pool = other.m_pool;
+    m_db = other.m_db;
+    m_writer = other.m_writer;
+    other.m_pool = nullptr;
+    other.m_db = nullptr;
+  }
+  return *this;
+}
+
+void ConnectionLease::release() {
+  if (m_pool && m_db) {
+    m_pool->releaseLease(m_db, m_writer);
+  }
+  m_pool = nullptr;
+  m_db = nullptr;
+  m_writer = false;
+}
+
+// ============================================================
+// SqlitePool Implementation
+// ============================================================
+
+SqlitePool::SqlitePool(const std::string& path,
+                       const SqlitePoolOptions& options)
+    : m_options(options) {
+  open(path);
+}
+
+SqlitePool::~SqlitePool() { close(); }
+
+void SqlitePool::open(const std::string& path) {
+  close();
+
+  // The writer creates the file and switches it to WAL before any
+  // read-only connection attaches
+  auto writer = std::make_unique<SqliteDatabase>();
+  writer->setStatementCacheCapacity(m_options.statementCacheCapacity);
+  writer->open(path);
+  writer->setBusyTimeout(m_options.busyTimeoutMs);
+  for (const auto& registration : m_functions) {
+    registration(*writer);
+  }
+
+  std::vector<std::unique_ptr<SqliteDatabase>> readers;
+  if (m_options.readerCount > 0 && isSharedFile(path)) {
+    writer->setJournalMode("WAL");
+    readers.reserve(m_options.readerCount);
+    for (size_t i = 0; i < m_options.readerCount; ++i) {
+      auto reader = std::make_unique<SqliteDatabase>();
+      reader->setStatementCacheCapacity(m_options.statementCacheCapacity);
+      reader->openReadOnly(path);
+      reader->setBusyTimeout(m_options.busyTimeoutMs);
+      for (const auto& registration : m_functions) {
+        registration(*reader);
+      }
+      readers.push_back(std::move(reader));
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_writer = std::move(writer);
+  m_readers = std::move(readers);
+  m_idleReaders.clear();
+  for (const auto& reader : m_readers) {
+    m_idleReaders.push_back(reader.get());
+  }
+  m_leasedReaders.clear();
+  m_writeResults.clear();
+  m_writerOwner = std::thread::id();
+  m_writerDepth = 0;
+}
+
+void SqlitePool::close() {
+  // An open transaction is rolled back when the writer closes
+  m_transactionLease.release();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_released.wait(lock, [this] {
+    return m_writerDepth == 0 && m_idleReaders.size() == m_readers.size();
+  });
+
+  m_idleReaders.clear();
+  m_readers.clear();
+  m_writer.reset();
+}
+
+bool SqlitePool::isOpen() const { return m_writer && m_writer->isOpen(); }
+
+void SqlitePool::setOptions(const SqlitePoolOptions& options) {
+  m_options = options;
+}
+
+ConnectionLease SqlitePool::acquireReader() {
+  requireOpen();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_readers.empty()) {
+    lock.unlock();
+    return acquireWriter();
+  }
+
+  const std::thread::id self = std::this_thread::get_id();
+  for (auto& leased : m_leasedReaders) {
+    if (leased.owner == self) {
+      ++leased.depth;
+      return ConnectionLease(this, leased.db, false);
+    }
+  }
+
+  m_released.wait(lock, [this] { return !m_idleReaders.empty(); });
+  SqliteDatabase* reader = m_idleReaders.back();
+  m_idleReaders.pop_back();
+  m_leasedReaders.push_back({reader, self, 1});
+  return ConnectionLease(this, reader, false);
+}
+
+ConnectionLease SqlitePool::acquireWriter() {
+  requireOpen();
+
+  const std::thread::id self = std::this_thread::get_id();
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_released.wait(lock, [this, self] {
+    return m_writerDepth == 0 || m_writerOwner == self;
+  });
+
+  m_writerOwner = self;
+  ++m_writerDepth;
+  return ConnectionLease(this, m_writer.get(), true);
+}
+
+size_t SqlitePool::readerCount() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_readers.size();
+}
+
+size_t SqlitePool::idleReaderCount() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_idleReaders.size();
+}
+
+std::unique_ptr<IStatement> SqlitePool::prepare(const std::string& sql) {
+  requireOpen();
+
+  if (!ownsWriter()) {
+    ConnectionLease lease = acquireReader();
+    auto stmt = lease->prepare(sql);
+    // SqliteDatabase only hands out SqliteStatement
+    if (lease.isWriter() ||
+        static_cast<const SqliteStatement&>(*stmt).isReadOnly()) {
+      return std::make_unique<PooledStatement>(std::move(lease),
+                                               std::move(stmt));
+    }
+  }
+
+  ConnectionLease lease = acquireWriter();
+  auto stmt = lease->prepare(sql);
+  return std::make_unique<PooledStatement>(std::move(lease), std::move(stmt));
+}
+
+void SqlitePool::execute(const std::string& sql) {
+  ConnectionLease lease = acquireWriter();
+  lease->execute(sql);
+}
+
+DbResult SqlitePool::query(const std::string& sql) {
+  auto stmt = prepare(sql);
+  return stmt->execute();
+}
+
+size_t SqlitePool::query(const std::string& sql, const RowCallback& callback) {
+  auto stmt = prepare(sql);
+  return stmt->forEachRow(callback);
+}
+
+void SqlitePool::beginTransaction() {
+  ConnectionLease lease = acquireWriter();
+  lease->beginTransaction();
+  if (!m_transactionLease) {
+    m_transactionLease = std::move(lease);
+  }
+}
+
+void SqlitePool::commit() {
+  ConnectionLease lease = acquireWriter();
+  // A failed COMMIT leaves the transaction open, so keep the writer
+  lease->commit();
+  finishTransaction();
+}
+
+void SqlitePool::rollback() {
+  ConnectionLease lease = acquireWriter();
+  try {
+    lease->rollback();
+  } catch (...) {
+    finishTransaction();
+    throw;
+  }
+  finishTransaction();
+}
+
+void SqlitePool::onTransactionEnd(TransactionEndAction action) {
+  if (ownsWriter()) {
+    ConnectionLease lease = acquireWriter();
+    lease->onTransactionEnd(std::move(action));
+    return;
+  }
+  action(true);
+}
+
+int64_t SqlitePool::lastInsertRowId() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const std::thread::id self = std::this_thread::get_id();
+  if (m_writerDepth > 0 && m_writerOwner == self) {
+    return m_writer->lastInsertRowId();
+  }
+  auto it = m_writeResults.find(self);
+  return it == m_writeResults.end() ? 0 : it->second.lastInsertRowId;
+}
+
+int SqlitePool::changesCount() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const std::thread::id self = std::this_thread::get_id();
+  if (m_writerDepth > 0 && m_writerOwner == self) {
+    return m_writer->changesCount();
+  }
+  auto it = m_writeResults.find(self);
+  return it == m_writeResults.end() ? 0 : it->second.changes;
+}
+
+void SqlitePool::createFunction(const std::string& name, int argCount,
+                                ScalarFunction function,
+                                const SqlFunctionOptions& options) {
+  addFunction([=](SqliteDatabase& db) {
+    db.createFunction(name, argCount, function, options);
+  });
+}
+
+void SqlitePool::createAggregate(const std::string& name, int argCount,
+                                 AggregateFactory factory,
+                                 const SqlFunctionOptions& options) {
+  addFunction([=](SqliteDatabase& db) {
+    db.createAggregate(name, argCount, factory, options);
+  });
+}
+
+void SqlitePool::createVirtualTable(const std::string& name,
+                                    std::shared_ptr<VirtualTable> table) {
+  addFunction([=](SqliteDatabase& db) { db.createVirtualTable(name, table); });
+}
+
+void SqlitePool::addFunction(
+    std::function<void(SqliteDatabase&)> registration) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_writer) {
+    registration(*m_writer);
+  }
+  for (const auto& reader : m_readers) {
+    registration(*reader);
+  }
+  m_functions.push_back(std::move(registration));
+}
+
+void SqlitePool::requireOpen() const {
+  if (!isOpen()) {
+    throw ConnectionException("Database not open");
+  }
+}
+
+bool SqlitePool::ownsWriter() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_writerDepth > 0 && m_writerOwner == std::this_thread::get_id();
+}
+
+void SqlitePool::releaseLease(SqliteDatabase* db, bool writer) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (writer) {
+      if (--m_writerDepth == 0) {
+        // Still this thread's writer until the owner is cleared
+        m_writeResults[m_writerOwner] = {db->lastInsertRowId(),
+                                         db->changesCount()};
+        m_writerOwner = std::thread::id();
+      }
+    } else {
+      auto leased = std::find_if(
+          m_leasedReaders.begin(), m_leasedReaders.end(),
+          [db](const LeasedReader& entry) { return entry.db == db; });
+      if (--leased->depth == 0) {
+        m_leasedReaders.erase(leased);
+        m_idleReaders.push_back(db);
+      }
+    }
+  }
+  m_released.notify_all();
+}
+
+// Only called by the thread that holds the writer
+void SqlitePool::finishTransaction() {
+  if (!m_writer->inTransaction()) {
+    m_transactionLease.release();
+  }
+}
+
+}  // namespace Gateways::Database
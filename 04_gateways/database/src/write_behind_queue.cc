@@ -0,0 +1,181 @@
+#include "write_behind_queue.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+#include <vector>
+
+namespace Gateways::Database {
+
+namespace {
+
+WriteBehindOptions normalized(WriteBehindOptions options) {
+  options.capacity = std::max<size_t>(1, options.capacity);
+  options.maxBatchSize = std::max<size_t>(1, options.maxBatchSize);
+  return options;
+}
+
+}  // namespace
+
+// ============================================================
+// WriteBehindQueue Implementation
+// ============================================================
+
+WriteBehindQueue::WriteBehindQueue(IDatabase& db,
+                                   const WriteBehindOptions& options)
+    : m_db(db), m_options(normalized(options)) {
+  m_writer = std::thread(&WriteBehindQueue::run, this);
+}
+
+WriteBehindQueue::~WriteBehindQueue() { stop(); }
+
+std::future<void> WriteBehindQueue::submit(WriteOp op) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_notFull.wait(lock, [this] {
+    return m_stopping || m_queue.size() < m_options.capacity;
+  });
+  return enqueue(std::move(op), lock);
+}
+
+std::optional<std::future<void>> WriteBehindQueue::trySubmit(WriteOp op) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (!m_stopping && m_queue.size() >= m_options.capacity) {
+    ++m_stats.rejected;
+    return std::nullopt;
+  }
+  return enqueue(std::move(op), lock);
+}
+
+std::future<void> WriteBehindQueue::enqueue(
+    WriteOp op, std::unique_lock<std::mutex>& lock) {
+  if (m_stopping) {
+    throw DatabaseException("Write-behind queue stopped");
+  }
+
+  Pending pending{std::move(op), std::promise<void>()};
+  std::future<void> future = pending.done.get_future();
+  m_queue.push_back(std::move(pending));
+  ++m_stats.submitted;
+
+  lock.unlock();
+  m_notEmpty.notify_one();
+  return future;
+}
+
+void WriteBehindQueue::flush() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const uint64_t target = m_stats.submitted;
+  m_drained.wait(lock, [this, target] {
+    return m_stats.completed + m_stats.failed >= target;
+  });
+}
+
+void WriteBehindQueue::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_notEmpty.notify_all();
+  m_notFull.notify_all();
+
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+}
+
+WriteBehindStats WriteBehindQueue::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  WriteBehindStats stats = m_stats;
+  stats.queued = m_queue.size();
+  return stats;
+}
+
+void WriteBehindQueue::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (true) {
+    m_notEmpty.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+    if (m_queue.empty()) {
+      break;  // stopping and drained
+    }
+
+    // Group window: let producers fill the batch before committing
+    if (!m_stopping && m_queue.size() < m_options.maxBatchSize &&
+        m_options.maxDelay.count() > 0) {
+      auto deadline = std::chrono::steady_clock::now() + m_options.maxDelay;
+      m_notEmpty.wait_until(lock, deadline, [this] {
+        return m_stopping || m_queue.size() >= m_options.maxBatchSize;
+      });
+    }
+
+    std::deque<Pending> batch;
+    size_t count = std::min(m_queue.size(), m_options.maxBatchSize);
+    for (size_t i = 0; i < count; ++i) {
+      batch.push_back(std::move(m_queue.front()));
+      m_queue.pop_front();
+    }
+
+    lock.unlock();
+    m_notFull.notify_all();
+    commitBatch(batch);
+    lock.lock();
+  }
+}
+
+void WriteBehindQueue::commitBatch(std::deque<Pending>& batch) {
+  std::vector<std::exception_ptr> errors(batch.size());
+  std::exception_ptr commitError;
+
+  try {
+    m_db.beginTransaction();
+    for (size_t i = 0; i < batch.size(); ++i) {
+      // Nested: a savepoint inside the batch transaction
+      m_db.beginTransaction();
+      try {
+        batch[i].op(m_db);
+        m_db.commit();
+      } catch (...) {
+        errors[i] = std::current_exception();
+        m_db.rollback();
+      }
+    }
+    m_db.commit();
+  } catch (...) {
+    commitError = std::current_exception();
+    try {
+      m_db.rollback();
+    } catch (...) {
+      // No transaction left to roll back
+    }
+  }
+
+  uint64_t failed = 0;
+  for (const auto& error : errors) {
+    if (commitError || error) {
+      ++failed;
+    }
+  }
+
+  // Stats first, so a caller woken by its future sees them
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.completed += batch.size() - failed;
+    m_stats.failed += failed;
+    if (!commitError) {
+      ++m_stats.commits;
+    }
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (commitError) {
+      batch[i].done.set_exception(commitError);
+    } else if (errors[i]) {
+      batch[i].done.set_exception(errors[i]);
+    } else {
+      batch[i].done.set_value();
+    }
+  }
+  m_drained.notify_all();
+}
+
+}  // namespace Gateways::Database
@@ -0,0 +1,199 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "memory_primary_database.h"
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Database {
+namespace {
+
+using namespace std::chrono_literals;
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class MemoryPrimaryDatabaseTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    test_db_path_ = std::filesystem::temp_directory_path() /
+                    ("test_memprimary_" +
+                     std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db");
+  }
+
+  void TearDown() override { std::filesystem::remove(test_db_path_); }
+
+  // Rows in the file, read through a separate connection
+  int64_t countRowsOnDisk() {
+    if (!std::filesystem::exists(test_db_path_)) {
+      return -1;
+    }
+    SqliteDatabase disk;
+    disk.openReadOnly(test_db_path_.string());
+    auto stmt = disk.prepare(
+        "SELECT COUNT(*) FROM sqlite_master WHERE name = 'test'");
+    if (stmt->fetchScalar<int64_t>().value_or(0) == 0) {
+      return -1;
+    }
+    return disk.prepare("SELECT COUNT(*) FROM test")
+        ->fetchScalar<int64_t>()
+        .value_or(-1);
+  }
+
+  // Polls until pred holds or the timeout expires
+  template <typename Pred>
+  static bool waitFor(Pred pred, std::chrono::milliseconds timeout = 5s) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(5ms);
+    }
+    return true;
+  }
+
+  std::filesystem::path test_db_path_;
+};
+
+// ============================================================
+// Open and Close
+// ============================================================
+TEST_F(MemoryPrimaryDatabaseTest, RequiresFilePath) {
+  MemoryPrimaryDatabase db;
+  EXPECT_FALSE(db.isOpen());
+  EXPECT_THROW(db.open(":memory:"), ConnectionException);
+  EXPECT_THROW(db.checkpoint(), ConnectionException);
+}
+
+TEST_F(MemoryPrimaryDatabaseTest, LoadsExistingFileIntoMemory) {
+  {
+    SqliteDatabase disk(test_db_path_.string());
+    disk.execute("CREATE TABLE test (id INTEGER)");
+    disk.execute("INSERT INTO test VALUES (1), (2)");
+  }
+
+  MemoryPrimaryDatabase db(test_db_path_.string());
+  auto stmt = db.prepare("SELECT COUNT(*) FROM test");
+  EXPECT_EQ(stmt->fetchScalar<int64_t>(), 2);
+}
+
+TEST_F(MemoryPrimaryDatabaseTest, CloseWritesFinalCheckpoint) {
+  MemoryPrimaryOptions options;
+  options.flushInterval = 1h;
+  MemoryPrimaryDatabase db(test_db_path_.string(), options);
+  db.execute("CREATE TABLE test (id INTEGER)");
+  db.execute("INSERT INTO test VALUES (1)");
+  EXPECT_EQ(countRowsOnDisk(), -1);
+
+  db.close();
+  EXPECT_FALSE(db.isOpen());
+  EXPECT_EQ(countRowsOnDisk(), 1);
+}
+
+TEST_F(MemoryPrimaryDatabaseTest, CloseDiscardsOpenTransaction) {
+  MemoryPrimaryOptions options;
+  options.flushInterval = 1h;
+  MemoryPrimaryDatabase db(test_db_path_.string(), options);
+  db.execute("CREATE TABLE test (id INTEGER)");
+  db.execute("INSERT INTO test VALUES (1)");
+  db.beginTransaction();
+  db.execute("INSERT INTO test VALUES (2)");
+
+  db.close();
+  EXPECT_EQ(countRowsOnDisk(), 1);
+}
+
+// ============================================================
+// Checkpoints
+// ============================================================
+TEST_F(MemoryPrimaryDatabaseTest, CheckpointWritesNow) {
+  MemoryPrimaryOptions options;
+  options.flushInterval = 1h;
+  MemoryPrimaryDatabase db(test_db_path_.string(), options);
+  db.execute("CREATE TABLE test (id INTEGER)");
+  db.execute("INSERT INTO test VALUES (1)");
+  EXPECT_EQ(db.stats().pendingChanges, 1u);
+
+  EXPECT_TRUE(db.checkpoint());
+  EXPECT_EQ(countRowsOnDisk(), 1);
+
+  auto stats = db.stats();
+  EXPECT_EQ(stats.checkpoints, 1u);
+  EXPECT_EQ(stats.pendingChanges, 0u);
+}
+
+TEST_F(MemoryPrimaryDatabaseTest, CheckpointDeferredByTransaction) {
+  MemoryPrimaryOptions options;
+  options.flushInterval = 1h;
+  MemoryPrimaryDatabase db(test_db_path_.string(), options);
+  db.execute("CREATE TABLE test (id INTEGER)");
+  db.checkpoint();
+
+  db.beginTransaction();
+  db.execute("INSERT INTO test VALUES (1)");
+  EXPECT_FALSE(db.checkpoint());
+  EXPECT_EQ(db.stats().skippedCheckpoints, 1u);
+  EXPECT_EQ(countRowsOnDisk(), 0);
+
+  db.commit();
+  EXPECT_TRUE(db.checkpoint());
+  EXPECT_EQ(countRowsOnDisk(), 1);
+}
+
+TEST_F(MemoryPrimaryDatabaseTest, FlushesOnInterval) {
+  MemoryPrimaryOptions options;
+  options.flushInterval = 30ms;
+  options.pollInterval = 5ms;
+  MemoryPrimaryDatabase db(test_db_path_.string(), options);
+  db.execute("CREATE TABLE test (id INTEGER)");
+  db.execute("INSERT INTO test VALUES (1)");
+
+  EXPECT_TRUE(waitFor([&db] { return db.stats().checkpoints > 0; }));
+  EXPECT_EQ(countRowsOnDisk(), 1);
+}
+
+TEST_F(MemoryPrimaryDatabaseTest, FlushesOnDirtyThreshold) {
+  MemoryPrimaryOptions options;
+  options.flushInterval = 1h;
+  options.dirtyChangeThreshold = 50;
+  options.pollInterval = 5ms;
+  MemoryPrimaryDatabase db(test_db_path_.string(), options);
+  db.execute("CREATE TABLE test (id INTEGER)");
+
+  db.beginTransaction();
+  for (int64_t i = 0; i < 49; ++i) {
+    db.prepare("INSERT INTO test VALUES (?)")->bind(1, i).executeInsert();
+  }
+  db.commit();
+  std::this_thread::sleep_for(30ms);
+  EXPECT_EQ(db.stats().checkpoints, 0u);
+
+  db.execute("INSERT INTO test VALUES (49)");
+  EXPECT_TRUE(waitFor([&db] { return db.stats().checkpoints > 0; }));
+  EXPECT_EQ(countRowsOnDisk(), 50);
+}
+
+TEST_F(MemoryPrimaryDatabaseTest, ServesReadsWhileFlushing) {
+  MemoryPrimaryOptions options;
+  options.flushInterval = 1ms;
+  options.pollInterval = 1ms;
+  MemoryPrimaryDatabase db(test_db_path_.string(), options);
+  db.execute("CREATE TABLE test (id INTEGER)");
+
+  for (int64_t i = 0; i < 200; ++i) {
+    db.prepare("INSERT INTO test VALUES (?)")->bind(1, i).executeInsert();
+    auto stmt = db.prepare("SELECT COUNT(*) FROM test");
+    ASSERT_EQ(stmt->fetchScalar<int64_t>(), i + 1);
+  }
+  db.close();
+
+  EXPECT_EQ(countRowsOnDisk(), 200);
+}
+
+}  // namespace
+}  // namespace Gateways::Database
@@ -0,0 +1,423 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "database_connector.h"
+#include "sqlite3_pool.h"
+
+namespace Gateways::Database {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class SqlitePoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    test_db_path_ = std::filesystem::temp_directory_path() /
+                    ("test_pool_" +
+                     std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db");
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(test_db_path_);
+    std::filesystem::remove(test_db_path_.string() + "-wal");
+    std::filesystem::remove(test_db_path_.string() + "-shm");
+  }
+
+  static int64_t countRows(IDatabase& db) {
+    auto stmt = db.prepare("SELECT COUNT(*) FROM test");
+    return stmt->fetchScalar<int64_t>().value_or(-1);
+  }
+
+  std::filesystem::path test_db_path_;
+};
+
+// ============================================================
+// Connection Management
+// ============================================================
+TEST_F(SqlitePoolTest, DefaultConstructor) {
+  SqlitePool pool;
+  EXPECT_FALSE(pool.isOpen());
+  EXPECT_THROW(pool.prepare("SELECT 1"), ConnectionException);
+  EXPECT_THROW(pool.acquireWriter(), ConnectionException);
+}
+
+TEST_F(SqlitePoolTest, OpensReadersInWalMode) {
+  SqlitePoolOptions options;
+  options.readerCount = 3;
+  SqlitePool pool(test_db_path_.string(), options);
+
+  EXPECT_TRUE(pool.isOpen());
+  EXPECT_EQ(pool.readerCount(), 3u);
+  EXPECT_EQ(pool.idleReaderCount(), 3u);
+
+  auto stmt = pool.prepare("PRAGMA journal_mode");
+  EXPECT_EQ(stmt->fetchScalar<std::string>(), "wal");
+}
+
+TEST_F(SqlitePoolTest, InMemoryRunsOnWriterOnly) {
+  SqlitePool pool(":memory:");
+  EXPECT_EQ(pool.readerCount(), 0u);
+
+  pool.execute("CREATE TABLE test (id INTEGER)");
+  pool.execute("INSERT INTO test VALUES (1)");
+  EXPECT_EQ(countRows(pool), 1);
+
+  ConnectionLease lease = pool.acquireReader();
+  EXPECT_TRUE(lease.isWriter());
+}
+
+TEST_F(SqlitePoolTest, CloseReleasesConnections) {
+  SqlitePool pool(test_db_path_.string());
+  pool.close();
+
+  EXPECT_FALSE(pool.isOpen());
+  EXPECT_EQ(pool.readerCount(), 0u);
+}
+
+// ============================================================
+// Routing
+// ============================================================
+TEST_F(SqlitePoolTest, ReadsLeaseReader) {
+  SqlitePoolOptions options;
+  options.readerCount = 2;
+  SqlitePool pool(test_db_path_.string(), options);
+  pool.execute("CREATE TABLE test (id INTEGER)");
+
+  {
+    auto stmt = pool.prepare("SELECT id FROM test");
+    EXPECT_EQ(pool.idleReaderCount(), 1u);
+  }
+  EXPECT_EQ(pool.idleReaderCount(), 2u);
+}
+
+TEST_F(SqlitePoolTest, WritesRunOnWriter) {
+  SqlitePoolOptions options;
+  options.readerCount = 2;
+  SqlitePool pool(test_db_path_.string(), options);
+  pool.execute("CREATE TABLE test (id INTEGER)");
+
+  auto stmt = pool.prepare("INSERT INTO test VALUES (?)");
+  EXPECT_EQ(pool.idleReaderCount(), 2u);
+  stmt->bind(1, int64_t{5});
+  EXPECT_EQ(stmt->executeInsert(), 1);
+  stmt.reset();
+
+  EXPECT_EQ(countRows(pool), 1);
+  EXPECT_EQ(pool.lastInsertRowId(), 1);
+}
+
+TEST_F(SqlitePoolTest, StreamingQueryOnReader) {
+  SqlitePool pool(test_db_path_.string());
+  pool.execute("CREATE TABLE test (value INTEGER)");
+  pool.execute("INSERT INTO test VALUES (1), (2), (3)");
+
+  int64_t total = 0;
+  size_t rows = pool.query("SELECT value FROM test",
+                           [&total](const RowView& row) {
+                             total += row.getInt64(0);
+                           });
+  EXPECT_EQ(rows, 3u);
+  EXPECT_EQ(total, 6);
+  EXPECT_EQ(pool.query("SELECT value FROM test").size(), 3u);
+}
+
+// ============================================================
+// Leases
+// ============================================================
+TEST_F(SqlitePoolTest, LeaseReturnsOnRelease) {
+  SqlitePoolOptions options;
+  options.readerCount = 1;
+  SqlitePool pool(test_db_path_.string(), options);
+
+  ConnectionLease lease = pool.acquireReader();
+  EXPECT_TRUE(lease);
+  EXPECT_FALSE(lease.isWriter());
+  EXPECT_EQ(pool.idleReaderCount(), 0u);
+
+  ConnectionLease moved = std::move(lease);
+  EXPECT_FALSE(lease);
+  EXPECT_EQ(pool.idleReaderCount(), 0u);
+
+  moved.release();
+  EXPECT_FALSE(moved);
+  EXPECT_EQ(pool.idleReaderCount(), 1u);
+}
+
+TEST_F(SqlitePoolTest, ReaderLeaseIsReentrantPerThread) {
+  SqlitePoolOptions options;
+  options.readerCount = 1;
+  SqlitePool pool(test_db_path_.string(), options);
+  pool.execute("CREATE TABLE test (id INTEGER)");
+  pool.execute("INSERT INTO test VALUES (1), (2), (3)");
+
+  // A read nested in another on the only reader
+  int64_t total = 0;
+  auto outer = pool.prepare("SELECT id FROM test ORDER BY id");
+  while (outer->step()) {
+    auto inner = pool.prepare("SELECT COUNT(*) FROM test WHERE id <= ?");
+    inner->bind(1, outer->columnInt64(0));
+    total += inner->fetchScalar<int64_t>().value_or(0);
+  }
+  EXPECT_EQ(total, 1 + 2 + 3);
+  EXPECT_EQ(pool.idleReaderCount(), 0u);
+
+  // Another thread still waits for the reader
+  std::atomic<bool> read{false};
+  std::thread other([&pool, &read] {
+    countRows(pool);
+    read = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(read.load());
+  outer.reset();
+  other.join();
+  EXPECT_TRUE(read.load());
+  EXPECT_EQ(pool.idleReaderCount(), 1u);
+}
+
+TEST_F(SqlitePoolTest, WriteMetadataIsPerThread) {
+  SqlitePool pool(test_db_path_.string());
+  pool.execute("CREATE TABLE test (id INTEGER)");
+  pool.prepare("INSERT INTO test VALUES (1)")->executeInsert();
+  EXPECT_EQ(pool.lastInsertRowId(), 1);
+
+  std::thread other([&pool] {
+    pool.prepare("INSERT INTO test VALUES (2), (3)")->executeUpdate();
+    EXPECT_EQ(pool.lastInsertRowId(), 3);
+    EXPECT_EQ(pool.changesCount(), 2);
+  });
+  other.join();
+
+  EXPECT_EQ(pool.lastInsertRowId(), 1);
+  EXPECT_EQ(pool.changesCount(), 1);
+}
+
+TEST_F(SqlitePoolTest, WriterLeaseIsReentrant) {
+  SqlitePool pool(test_db_path_.string());
+
+  ConnectionLease outer = pool.acquireWriter();
+  ConnectionLease inner = pool.acquireWriter();
+  EXPECT_EQ(outer.get(), inner.get());
+}
+
+TEST_F(SqlitePoolTest, ReadersAreReadOnly) {
+  SqlitePoolOptions options;
+  options.readerCount = 1;
+  SqlitePool pool(test_db_path_.string(), options);
+  pool.execute("CREATE TABLE test (id INTEGER)");
+
+  ConnectionLease reader = pool.acquireReader();
+  EXPECT_THROW(reader->execute("INSERT INTO test VALUES (1)"),
+               QueryException);
+}
+
+// ============================================================
+// Transactions
+// ============================================================
+TEST_F(SqlitePoolTest, TransactionReadsOwnWrites) {
+  SqlitePool pool(test_db_path_.string());
+  pool.execute("CREATE TABLE test (id INTEGER)");
+
+  pool.beginTransaction();
+  pool.execute("INSERT INTO test VALUES (1)");
+  EXPECT_EQ(countRows(pool), 1);
+
+  // Other threads read the last committed snapshot from a reader
+  int64_t seen = -1;
+  std::thread reader([&pool, &seen] { seen = countRows(pool); });
+  reader.join();
+  EXPECT_EQ(seen, 0);
+
+  pool.commit();
+  EXPECT_EQ(countRows(pool), 1);
+}
+
+TEST_F(SqlitePoolTest, TransactionRollback) {
+  SqlitePool pool(test_db_path_.string());
+  pool.execute("CREATE TABLE test (id INTEGER)");
+
+  pool.beginTransaction();
+  pool.execute("INSERT INTO test VALUES (1)");
+  pool.rollback();
+
+  EXPECT_EQ(countRows(pool), 0);
+}
+
+TEST_F(SqlitePoolTest, TransactionEndRunsOnWriterOwner) {
+  SqlitePool pool(test_db_path_.string());
+  std::vector<bool> ended;
+  auto record = [&ended](bool committed) { ended.push_back(committed); };
+
+  pool.beginTransaction();
+  pool.onTransactionEnd(record);
+  // Another thread is outside this transaction
+  std::thread other([&pool, &record] { pool.onTransactionEnd(record); });
+  other.join();
+  EXPECT_EQ(ended, std::vector<bool>{true});
+  pool.rollback();
+  EXPECT_EQ(ended, (std::vector<bool>{true, false}));
+}
+
+TEST_F(SqlitePoolTest, CommitWithoutTransactionThrows) {
+  SqlitePool pool(test_db_path_.string());
+  EXPECT_THROW(pool.commit(), QueryException);
+
+  // The writer must still be available afterwards
+  pool.execute("CREATE TABLE test (id INTEGER)");
+  EXPECT_EQ(countRows(pool), 0);
+}
+
+TEST_F(SqlitePoolTest, ReopensMigratedFileOnOneReader) {
+  const std::vector<Migration> migrations = {[](IDatabase& db) {
+    db.execute("CREATE TABLE test (id INTEGER)");
+  }};
+  SqlitePoolOptions options;
+  options.readerCount = 1;
+  {
+    SqlitePool pool(test_db_path_.string(), options);
+    EXPECT_EQ(migrateSchema(pool, "test", migrations), 1u);
+  }
+
+  SqlitePool pool(test_db_path_.string(), options);
+  EXPECT_EQ(migrateSchema(pool, "test", migrations), 0u);
+  EXPECT_EQ(schemaVersion(pool, "test"), 1);
+  EXPECT_EQ(pool.idleReaderCount(), 1u);
+}
+
+// ============================================================
+// Concurrency
+// ============================================================
+TEST_F(SqlitePoolTest, ConcurrentWritersSerialize) {
+  SqlitePool pool(test_db_path_.string());
+  pool.execute("CREATE TABLE test (id INTEGER)");
+
+  constexpr int kThreads = 4;
+  constexpr int kRowsPerThread = 50;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&pool] {
+      pool.beginTransaction();
+      for (int i = 0; i < kRowsPerThread; ++i) {
+        auto stmt = pool.prepare("INSERT INTO test VALUES (?)");
+        stmt->bind(1, int64_t{i}).executeInsert();
+      }
+      pool.commit();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(countRows(pool), kThreads * kRowsPerThread);
+}
+
+TEST_F(SqlitePoolTest, ConcurrentReadsDuringWrite) {
+  SqlitePoolOptions options;
+  options.readerCount = 4;
+  SqlitePool pool(test_db_path_.string(), options);
+  pool.execute("CREATE TABLE test (id INTEGER)");
+  pool.execute("INSERT INTO test VALUES (1), (2)");
+
+  // Readers are not blocked by a transaction holding the writer
+  pool.beginTransaction();
+  pool.execute("INSERT INTO test VALUES (3)");
+
+  std::atomic<int> matches{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 8; ++t) {
+    readers.emplace_back([&pool, &matches] {
+      if (countRows(pool) == 2) {
+        ++matches;
+      }
+    });
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  pool.commit();
+
+  EXPECT_EQ(matches.load(), 8);
+  EXPECT_EQ(countRows(pool), 3);
+}
+
+// ============================================================
+// SQL Functions
+// ============================================================
+TEST_F(SqlitePoolTest, FunctionsReachReadersAndOutliveReopen) {
+  SqlitePoolOptions options;
+  options.readerCount = 2;
+  SqlitePool pool(test_db_path_.string(), options);
+  pool.createFunction("twice", 1, [](const SqlFunctionArgs& args) {
+    return DbValue(args.getInt64(0) * 2);
+  });
+  pool.execute("CREATE TABLE test (x INTEGER)");
+  pool.execute("INSERT INTO test VALUES (21)");
+
+  // Every reader (one per thread), and the writer inside a transaction
+  {
+    ConnectionLease held = pool.acquireReader();
+    EXPECT_EQ(held->prepare("SELECT twice(x) FROM test")
+                  ->fetchScalar<int64_t>(),
+              42);
+    std::thread other([&pool] {
+      EXPECT_EQ(
+          pool.prepare("SELECT twice(x) FROM test")->fetchScalar<int64_t>(),
+          42);
+    });
+    other.join();
+  }
+  pool.beginTransaction();
+  EXPECT_EQ(pool.prepare("SELECT twice(x) FROM test")->fetchScalar<int64_t>(),
+            42);
+  pool.commit();
+
+  pool.close();
+  pool.open(test_db_path_.string());
+  EXPECT_EQ(pool.prepare("SELECT twice(x) FROM test")->fetchScalar<int64_t>(),
+            42);
+}
+
+TEST_F(SqlitePoolTest, VirtualTablesReachReaders) {
+  class CountTable : public VirtualTable {
+   public:
+    std::string schema() const override { return "CREATE TABLE x(n)"; }
+    bool filters(int, ScanOp) const override { return false; }
+    std::unique_ptr<VirtualTableCursor> scan(
+        const std::vector<ScanConstraint>&) override {
+      class Cursor : public VirtualTableCursor {
+       public:
+        bool next() override { return ++n_ <= 3; }
+        DbValue column(int) const override { return n_; }
+
+       private:
+        int64_t n_ = 0;
+      };
+      return std::make_unique<Cursor>();
+    }
+  };
+
+  SqlitePoolOptions options;
+  options.readerCount = 2;
+  SqlitePool pool(test_db_path_.string(), options);
+  pool.createVirtualTable("numbers", std::make_shared<CountTable>());
+  ConnectionLease held = pool.acquireReader();
+  EXPECT_EQ(held->prepare("SELECT sum(n) FROM numbers")->fetchScalar<int64_t>(),
+            6);
+  std::thread other([&pool] {
+    EXPECT_EQ(
+        pool.prepare("SELECT sum(n) FROM numbers")->fetchScalar<int64_t>(), 6);
+  });
+  other.join();
+}
+
+}  // namespace
+}  // namespace Gateways::Database
@@ -0,0 +1,216 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+#include "write_behind_queue.h"
+
+namespace Gateways::Database {
+namespace {
+
+using namespace std::chrono_literals;
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class WriteBehindQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    test_db_path_ = std::filesystem::temp_directory_path() /
+                    ("test_wbq_" +
+                     std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db");
+    db_.open(test_db_path_.string());
+    db_.execute("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+  }
+
+  void TearDown() override {
+    db_.close();
+    std::filesystem::remove(test_db_path_);
+  }
+
+  static WriteBehindQueue::WriteOp insertOp(int64_t id) {
+    return [id](IDatabase& db) {
+      auto stmt = db.prepare("INSERT INTO test (id, value) VALUES (?, ?)");
+      stmt->bind(1, id).bind(2, "v" + std::to_string(id));
+      stmt->executeInsert();
+    };
+  }
+
+  int64_t countRows() {
+    auto stmt = db_.prepare("SELECT COUNT(*) FROM test");
+    return stmt->fetchScalar<int64_t>().value_or(-1);
+  }
+
+  std::filesystem::path test_db_path_;
+  SqliteDatabase db_;
+};
+
+// ============================================================
+// Basic Operations
+// ============================================================
+TEST_F(WriteBehindQueueTest, SubmitResolvesAfterCommit) {
+  WriteBehindQueue queue(db_);
+
+  auto done = queue.submit(insertOp(1));
+  done.get();
+
+  EXPECT_EQ(countRows(), 1);
+  EXPECT_EQ(queue.stats().completed, 1u);
+  EXPECT_EQ(queue.stats().commits, 1u);
+}
+
+TEST_F(WriteBehindQueueTest, FlushWaitsForAllSubmitted) {
+  WriteBehindQueue queue(db_);
+
+  for (int64_t i = 0; i < 100; ++i) {
+    queue.submit(insertOp(i));
+  }
+  queue.flush();
+
+  EXPECT_EQ(countRows(), 100);
+  EXPECT_EQ(queue.stats().queued, 0u);
+}
+
+TEST_F(WriteBehindQueueTest, GroupsWritesIntoFewCommits) {
+  WriteBehindOptions options;
+  options.maxBatchSize = 1000;
+  options.maxDelay = 200ms;
+  WriteBehindQueue queue(db_, options);
+
+  for (int64_t i = 0; i < 500; ++i) {
+    queue.submit(insertOp(i));
+  }
+  queue.flush();
+
+  auto stats = queue.stats();
+  EXPECT_EQ(stats.completed, 500u);
+  EXPECT_LT(stats.commits, 10u);
+}
+
+TEST_F(WriteBehindQueueTest, BatchSizeBoundsTransaction) {
+  WriteBehindOptions options;
+  options.maxBatchSize = 10;
+  options.maxDelay = 50ms;
+  WriteBehindQueue queue(db_, options);
+
+  for (int64_t i = 0; i < 100; ++i) {
+    queue.submit(insertOp(i));
+  }
+  queue.flush();
+
+  EXPECT_GE(queue.stats().commits, 10u);
+  EXPECT_EQ(countRows(), 100);
+}
+
+TEST_F(WriteBehindQueueTest, ConcurrentProducers) {
+  WriteBehindQueue queue(db_);
+
+  std::vector<std::thread> producers;
+  for (int t = 0; t < 4; ++t) {
+    producers.emplace_back([&queue, t] {
+      for (int64_t i = 0; i < 250; ++i) {
+        queue.submit(insertOp(t * 1000 + i));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  queue.flush();
+
+  EXPECT_EQ(countRows(), 1000);
+}
+
+// ============================================================
+// Failures
+// ============================================================
+TEST_F(WriteBehindQueueTest, FailedOperationRollsBackAlone) {
+  WriteBehindOptions options;
+  options.maxDelay = 50ms;
+  WriteBehindQueue queue(db_, options);
+
+  auto first = queue.submit(insertOp(1));
+  auto duplicate = queue.submit(insertOp(1));
+  auto second = queue.submit(insertOp(2));
+
+  EXPECT_NO_THROW(first.get());
+  EXPECT_THROW(duplicate.get(), QueryException);
+  EXPECT_NO_THROW(second.get());
+
+  EXPECT_EQ(countRows(), 2);
+  EXPECT_EQ(queue.stats().failed, 1u);
+}
+
+TEST_F(WriteBehindQueueTest, ExceptionFromOperationPropagates) {
+  WriteBehindQueue queue(db_);
+
+  auto done = queue.submit(
+      [](IDatabase&) { throw std::runtime_error("application error"); });
+  EXPECT_THROW(done.get(), std::runtime_error);
+}
+
+// ============================================================
+// Backpressure and Shutdown
+// ============================================================
+TEST_F(WriteBehindQueueTest, TrySubmitRejectsWhenFull) {
+  WriteBehindOptions options;
+  options.capacity = 1;
+  options.maxDelay = 0ms;
+  WriteBehindQueue queue(db_, options);
+
+  // Park the writer inside an operation so the queue cannot drain
+  std::promise<void> started;
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  auto blocker = queue.submit([&started, gate](IDatabase&) {
+    started.set_value();
+    gate.wait();
+  });
+  started.get_future().wait();
+
+  auto queued = queue.trySubmit(insertOp(1));
+  ASSERT_TRUE(queued.has_value());
+  EXPECT_FALSE(queue.trySubmit(insertOp(2)).has_value());
+  EXPECT_EQ(queue.stats().rejected, 1u);
+
+  release.set_value();
+  blocker.get();
+  queued->get();
+  EXPECT_EQ(countRows(), 1);
+}
+
+TEST_F(WriteBehindQueueTest, StopDrainsQueue) {
+  WriteBehindOptions options;
+  options.maxDelay = 1000ms;
+  WriteBehindQueue queue(db_, options);
+
+  std::vector<std::future<void>> pending;
+  for (int64_t i = 0; i < 20; ++i) {
+    pending.push_back(queue.submit(insertOp(i)));
+  }
+  queue.stop();
+
+  for (auto& done : pending) {
+    EXPECT_NO_THROW(done.get());
+  }
+  EXPECT_EQ(countRows(), 20);
+}
+
+TEST_F(WriteBehindQueueTest, SubmitAfterStopThrows) {
+  WriteBehindQueue queue(db_);
+  queue.stop();
+  queue.stop();
+
+  EXPECT_THROW(queue.submit(insertOp(1)), DatabaseException);
+  EXPECT_THROW(queue.trySubmit(insertOp(1)), DatabaseException);
+}
+
+}  // namespace
+}  // namespace Gateways::Database
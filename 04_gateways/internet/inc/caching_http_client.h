@@ -0,0 +1,143 @@
+// caching_http_client.h
+#ifndef GATEWAYS_NETWORK_CACHING_HTTP_CLIENT_H_
+#define GATEWAYS_NETWORK_CACHING_HTTP_CLIENT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "i_http_cache_store.h"
+#include "network_connector.h"
+
+namespace Gateways::Network {
+
+// ============================================================
+// CachedHttpResponse
+// ============================================================
+
+// Shares its body with the cache entry it came from; takeBody() copies
+class CachedHttpResponse : public IHttpResponse {
+ public:
+  CachedHttpResponse(int status_code, std::shared_ptr<const std::string> body,
+                     ResponseHeaders headers);
+
+  int statusCode() const override;
+  std::string body() const override;
+  std::string_view bodyView() const override;
+  std::string takeBody() override;
+  const ResponseHeaders& headers() const override;
+  std::string header(const std::string& name) const override;
+
+ private:
+  int status_code_;
+  std::shared_ptr<const std::string> body_;
+  ResponseHeaders headers_;
+};
+
+// ============================================================
+// CachingHttpClient
+// ============================================================
+
+struct HttpCacheOptions {
+  // Responses kept in memory, least recently used evicted first
+  size_t max_entries = 256;
+};
+
+struct HttpCacheStats {
+  uint64_t hits = 0;            // fresh, served without a request
+  uint64_t misses = 0;          // downloaded in full
+  uint64_t revalidations = 0;   // 304, served from the cache
+  uint64_t store_failures = 0;  // store calls that threw; ignored
+};
+
+// IHttpClient decorator caching get() responses by URL plus query
+// params. A response is kept if it carries an ETag, a Last-Modified or
+// a Cache-Control max-age, and not no-store. Within max-age it is served
+// without a request; past it, or with no-cache, the next get() sends
+// If-None-Match / If-Modified-Since and a 304 is answered from the
+// cache. A 304 may arrive as a response or as the HttpException that
+// HttplibClient throws for it. With a store, entries also persist
+// there and are read back on a memory miss. post() is passed through.
+// Thread-safe if the wrapped client is; requests run outside the lock.
+class CachingHttpClient : public IHttpClient {
+ public:
+  // inner and store must outlive the cache; store may be null.
+  // Throws std::invalid_argument if options.max_entries is 0.
+  explicit CachingHttpClient(IHttpClient& inner,
+                             const HttpCacheOptions& options = {},
+                             IHttpCacheStore* store = nullptr);
+
+  CachingHttpClient(const CachingHttpClient&) = delete;
+  CachingHttpClient& operator=(const CachingHttpClient&) = delete;
+
+  // Configuration, forwarded
+  void setDefaultHeaders(const Headers& headers) override;
+  void setConnectTimeout(int seconds) override;
+  void setReadTimeout(int seconds) override;
+
+  // HTTP methods
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params = {}) override;
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
+
+  std::unique_ptr<IHttpResponse> post(
+      const std::string& url, const std::string& body,
+      const std::string& content_type = "application/json") override;
+
+  HttpCacheStats stats() const;
+  // Drops the in-memory entries; the store keeps its own
+  void clear();
+
+ private:
+  struct Entry {
+    int status_code = 0;
+    ResponseHeaders headers;
+    std::shared_ptr<const std::string> body;
+    std::string etag;
+    std::string last_modified;
+    std::chrono::system_clock::time_point stored_at;
+    std::optional<std::chrono::seconds> max_age;
+  };
+  using EntryPtr = std::shared_ptr<const Entry>;
+  using Lru = std::list<std::pair<std::string, EntryPtr>>;
+
+  static std::string cacheKey(const std::string& url,
+                              const QueryParams& params);
+  static std::string encode(const Entry& entry);
+  static std::optional<Entry> decode(std::string_view value);
+  static std::unique_ptr<IHttpResponse> respond(const EntryPtr& entry);
+
+  // Memory first, then the store
+  EntryPtr find(const std::string& key);
+  // Into memory and, with persist, the store
+  void put(const std::string& key, const EntryPtr& entry, bool persist);
+  void forget(const std::string& key);
+  // Caches a downloaded response that may be kept, or forgets the key
+  std::unique_ptr<IHttpResponse> storeResponse(
+      const std::string& key, std::unique_ptr<IHttpResponse> response);
+  std::unique_ptr<IHttpResponse> revalidated(const std::string& key,
+                                             const EntryPtr& entry);
+
+  IHttpClient& inner_;
+  const HttpCacheOptions options_;
+  IHttpCacheStore* store_;
+
+  mutable std::mutex mutex_;
+  Lru lru_;  // most recently used first
+  std::unordered_map<std::string, Lru::iterator> index_;
+  HttpCacheStats stats_;
+};
+
+}  // namespace Gateways::Network
+
+#endif  // GATEWAYS_NETWORK_CACHING_HTTP_CLIENT_H_
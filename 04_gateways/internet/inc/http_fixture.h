@@ -0,0 +1,168 @@
+// http_fixture.h
+#ifndef GATEWAYS_NETWORK_HTTP_FIXTURE_H_
+#define GATEWAYS_NETWORK_HTTP_FIXTURE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "network_connector.h"
+
+namespace Gateways::Network {
+
+// ============================================================
+// HttpFixtureStore - recorded exchanges on disk
+// ============================================================
+
+struct RecordedResponse {
+  int status_code = 0;
+  ResponseHeaders headers;
+  std::string body;
+};
+
+// One file per request in a directory, named by a hash of the request
+// key, so a capture can be committed and diffed:
+//
+//   GET https://host/path?a=1&b=2     the key, checked on load
+//   200                               status
+//   Content-Type: application/json    header fields
+//                                     blank line
+//   <body bytes to the end of the file>
+//
+// Files are written to a temporary name and renamed into place, so
+// concurrent recorders never leave a torn fixture. I/O errors throw
+// NetworkException.
+class HttpFixtureStore {
+ public:
+  // The directory must exist
+  explicit HttpFixtureStore(std::string directory);
+
+  // Query params are ordered, so equal requests give equal keys
+  static std::string getKey(const std::string& url,
+                            const QueryParams& params);
+  // A hash stands in for the body
+  static std::string postKey(const std::string& url, const std::string& body,
+                             const std::string& content_type);
+
+  void save(const std::string& key, const RecordedResponse& response);
+  // nullopt if nothing was recorded for key
+  std::optional<RecordedResponse> load(const std::string& key) const;
+
+ private:
+  std::string pathFor(const std::string& key) const;
+
+  std::string directory_;
+};
+
+// ============================================================
+// RecordingHttpClient - captures what another client returns
+// ============================================================
+
+// Passes every request to inner and saves its response, or the status
+// and message of the HttpException it threw, before handing it back.
+// Timeouts and connection errors are not recorded. Thread-safe if inner
+// is.
+class RecordingHttpClient : public IHttpClient {
+ public:
+  // inner and store must outlive this client
+  RecordingHttpClient(IHttpClient& inner, HttpFixtureStore& store);
+
+  RecordingHttpClient(const RecordingHttpClient&) = delete;
+  RecordingHttpClient& operator=(const RecordingHttpClient&) = delete;
+
+  // Configuration, forwarded
+  void setDefaultHeaders(const Headers& headers) override;
+  void setConnectTimeout(int seconds) override;
+  void setReadTimeout(int seconds) override;
+
+  // HTTP methods
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params = {}) override;
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
+
+  std::unique_ptr<IHttpResponse> post(
+      const std::string& url, const std::string& body,
+      const std::string& content_type = "application/json") override;
+
+ private:
+  template <typename Send>
+  std::unique_ptr<IHttpResponse> record(const std::string& key,
+                                        const Send& send);
+
+  IHttpClient& inner_;
+  HttpFixtureStore& store_;
+};
+
+// ============================================================
+// ReplayHttpClient - serves recorded exchanges
+// ============================================================
+
+struct ReplayOptions {
+  // Added to every request, as a round trip would be
+  std::chrono::microseconds latency{0};
+  // Body transfer speed; 0 delivers bodies at once
+  uint64_t bytes_per_second = 0;
+  // Requests served at a time, as a server's connection limit would;
+  // 0 for no limit
+  size_t max_concurrency = 0;
+};
+
+// Answers requests from a fixture store, like HttplibClient would have:
+// a recorded non-2xx status throws HttpException, and a request without
+// a fixture throws NetworkException. Each fixture is read from disk once
+// and then shared, so repeated runs measure the caller, not the disk.
+// Latency and transfer time are slept per request, so concurrent
+// requests overlap as they would on the network. Thread-safe;
+// configuration calls are accepted and ignored.
+class ReplayHttpClient : public IHttpClient {
+ public:
+  // store must outlive this client
+  explicit ReplayHttpClient(const HttpFixtureStore& store,
+                            const ReplayOptions& options = {});
+
+  ReplayHttpClient(const ReplayHttpClient&) = delete;
+  ReplayHttpClient& operator=(const ReplayHttpClient&) = delete;
+
+  // Configuration, ignored
+  void setDefaultHeaders(const Headers& headers) override;
+  void setConnectTimeout(int seconds) override;
+  void setReadTimeout(int seconds) override;
+
+  // HTTP methods
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params = {}) override;
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
+
+  std::unique_ptr<IHttpResponse> post(
+      const std::string& url, const std::string& body,
+      const std::string& content_type = "application/json") override;
+
+  uint64_t requests() const;
+
+ private:
+  std::unique_ptr<IHttpResponse> replay(const std::string& key);
+  std::shared_ptr<const RecordedResponse> find(const std::string& key);
+
+  const HttpFixtureStore& store_;
+  const ReplayOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable slot_freed_;
+  std::map<std::string, std::shared_ptr<const RecordedResponse>> loaded_;
+  size_t in_flight_ = 0;
+  uint64_t requests_ = 0;
+};
+
+}  // namespace Gateways::Network
+
+#endif  // GATEWAYS_NETWORK_HTTP_FIXTURE_H_
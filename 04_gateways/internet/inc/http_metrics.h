@@ -0,0 +1,113 @@
+// http_metrics.h
+#ifndef GATEWAYS_NETWORK_HTTP_METRICS_H_
+#define GATEWAYS_NETWORK_HTTP_METRICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace Gateways::Network {
+
+// ============================================================
+// LatencyHistogram
+// ============================================================
+
+// Durations in power-of-two microsecond buckets: bucket 0 holds [0, 2)
+// us, bucket i [2^i, 2^(i+1)), and the last one everything above. Fixed
+// size, so recording is a few integer operations and hosts can be
+// merged; quantiles are the upper bound of their bucket.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kBuckets = 32;  // the last from ~36 minutes
+
+  void record(std::chrono::microseconds duration);
+
+  uint64_t count() const { return count_; }
+  std::chrono::microseconds total() const;
+  std::chrono::microseconds min() const;
+  std::chrono::microseconds max() const;
+  std::chrono::microseconds mean() const;
+  // q in [0, 1]; zero when empty
+  std::chrono::microseconds quantile(double q) const;
+  const std::array<uint64_t, kBuckets>& buckets() const { return buckets_; }
+
+ private:
+  std::array<uint64_t, kBuckets> buckets_{};
+  uint64_t count_ = 0;
+  int64_t total_us_ = 0;
+  int64_t min_us_ = 0;
+  int64_t max_us_ = 0;
+};
+
+// ============================================================
+// HttpMetrics
+// ============================================================
+
+// One request as HttplibClient saw it. httplib has no hook between name
+// resolution, TCP connect and the TLS handshake, so they are not timed
+// apart: on a new connection all three are inside first_byte, and the
+// gap to first_byte on reused connections is their cost.
+struct HttpRequestTiming {
+  std::string scheme_host;
+  int status = 0;  // 0: no response (timeout or connection error)
+  bool new_connection = false;
+  std::chrono::microseconds pool_wait{0};  // for a pooled connection
+  // Connection in hand to the first body byte; GETs with a body only
+  std::optional<std::chrono::microseconds> first_byte;
+  std::chrono::microseconds transfer{0};  // first body byte to the last
+  std::chrono::microseconds total{0};     // pool wait included
+  // Header fields and body as the application sees them: before
+  // request compression and after response decoding
+  uint64_t bytes_out = 0;
+  uint64_t bytes_in = 0;
+};
+
+struct HostMetrics {
+  uint64_t requests = 0;
+  uint64_t failures = 0;  // no response
+  uint64_t retries = 0;   // reported by RetryingHttpClient
+  uint64_t new_connections = 0;
+  uint64_t bytes_out = 0;
+  uint64_t bytes_in = 0;
+  std::map<int, uint64_t> statuses;
+
+  LatencyHistogram pool_wait;
+  LatencyHistogram first_byte_new;     // on new connections
+  LatencyHistogram first_byte_reused;  // on pooled ones
+  LatencyHistogram transfer;
+  LatencyHistogram total;
+};
+
+// Per-host aggregates of the requests HttplibClient records into it
+// (HttplibClientOptions::metrics) and the retries RetryingHttpClient
+// reports (RetryOptions::metrics). Thread-safe; recording takes a short
+// lock. Clients without one do not read the clock at all.
+class HttpMetrics {
+ public:
+  void record(const HttpRequestTiming& timing);
+  void recordRetry(const std::string& scheme_host);
+
+  // Copies, by scheme + host
+  std::map<std::string, HostMetrics> hosts() const;
+  std::optional<HostMetrics> host(const std::string& scheme_host) const;
+
+  // {"hosts": {"<scheme+host>": {"requests": ..., "statuses": {...},
+  // "latency_us": {"total": {"count", "mean", "min", "max", "p50",
+  // "p90", "p99", "buckets": [...]}, ...}}}}
+  std::string toJson() const;
+
+  void reset();
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, HostMetrics> hosts_;
+};
+
+}  // namespace Gateways::Network
+
+#endif  // GATEWAYS_NETWORK_HTTP_METRICS_H_
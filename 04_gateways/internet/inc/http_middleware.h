@@ -0,0 +1,270 @@
+// http_middleware.h
+#ifndef GATEWAYS_NETWORK_HTTP_MIDDLEWARE_H_
+#define GATEWAYS_NETWORK_HTTP_MIDDLEWARE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include "http_metrics.h"
+#include "network_connector.h"
+
+namespace Gateways::Network {
+
+// IHttpClient decorators meant to be stacked in front of HttplibClient,
+// outermost first:
+//
+//   CoalescingHttpClient -> RetryingHttpClient -> RateLimitedHttpClient
+//
+// so identical requests become one, and every attempt of it, retries
+// included, takes a token of its host. ResilientHttpClient builds that
+// stack. Each forwards configuration to the client it wraps, and each is
+// thread-safe if that client is.
+
+// ============================================================
+// CoalescingHttpClient - single-flight GETs
+// ============================================================
+
+// A get() while an identical one (URL, query params and per-request
+// headers) is in flight waits for it instead of sending its own request,
+// and gets a response sharing the first one's body, or the exception it
+// threw. Only concurrent callers share; every get() after the response
+// arrived sends again. post() is passed through.
+class CoalescingHttpClient : public IHttpClient {
+ public:
+  // inner must outlive this client
+  explicit CoalescingHttpClient(IHttpClient& inner);
+
+  CoalescingHttpClient(const CoalescingHttpClient&) = delete;
+  CoalescingHttpClient& operator=(const CoalescingHttpClient&) = delete;
+
+  // Configuration, forwarded
+  void setDefaultHeaders(const Headers& headers) override;
+  void setConnectTimeout(int seconds) override;
+  void setReadTimeout(int seconds) override;
+
+  // HTTP methods
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params = {}) override;
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
+
+  std::unique_ptr<IHttpResponse> post(
+      const std::string& url, const std::string& body,
+      const std::string& content_type = "application/json") override;
+
+  // get() calls answered by another caller's request
+  uint64_t coalesced() const { return coalesced_; }
+
+ private:
+  struct Flight {
+    bool done = false;
+    int status_code = 0;
+    ResponseHeaders headers;
+    std::shared_ptr<const std::string> body;
+    std::exception_ptr error;
+  };
+
+  static std::unique_ptr<IHttpResponse> respond(const Flight& flight);
+
+  IHttpClient& inner_;
+
+  std::mutex mutex_;
+  std::condition_variable landed_;
+  std::map<std::string, std::shared_ptr<Flight>> flights_;
+  std::atomic<uint64_t> coalesced_{0};
+};
+
+// ============================================================
+// RateLimitedHttpClient - per-host token bucket
+// ============================================================
+
+struct RateLimitOptions {
+  // Sustained requests per second to each scheme + host
+  double requests_per_second = 10.0;
+  // Requests a host may take at once after being idle
+  double burst = 10.0;
+};
+
+// Every request takes a token from its host's bucket, which refills at
+// requests_per_second up to burst. Without one the caller sleeps until
+// its token is due; tokens are handed out in call order, so waiting
+// callers are not starved by new ones. Hosts are limited independently.
+class RateLimitedHttpClient : public IHttpClient {
+ public:
+  // inner must outlive this client. Throws std::invalid_argument if
+  // requests_per_second is not positive or burst is below 1.
+  explicit RateLimitedHttpClient(IHttpClient& inner,
+                                 const RateLimitOptions& options = {});
+
+  RateLimitedHttpClient(const RateLimitedHttpClient&) = delete;
+  RateLimitedHttpClient& operator=(const RateLimitedHttpClient&) = delete;
+
+  // Configuration, forwarded
+  void setDefaultHeaders(const Headers& headers) override;
+  void setConnectTimeout(int seconds) override;
+  void setReadTimeout(int seconds) override;
+
+  // HTTP methods
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params = {}) override;
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
+
+  std::unique_ptr<IHttpResponse> post(
+      const std::string& url, const std::string& body,
+      const std::string& content_type = "application/json") override;
+
+  // Requests that had to wait for a token
+  uint64_t delayed() const { return delayed_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Bucket {
+    double tokens;  // negative while callers wait for theirs
+    Clock::time_point refilled_at;
+  };
+
+  // Takes a token of the URL's host, sleeping until it is due
+  void acquire(const std::string& url);
+
+  IHttpClient& inner_;
+  const RateLimitOptions options_;
+
+  std::mutex mutex_;
+  std::map<std::string, Bucket> buckets_;  // by scheme + host
+  std::atomic<uint64_t> delayed_{0};
+};
+
+// ============================================================
+// RetryingHttpClient - jittered exponential backoff
+// ============================================================
+
+struct RetryOptions {
+  // Attempts per request, the first included
+  int max_attempts = 4;
+  // Before the first retry; doubled for each further one, up to max
+  std::chrono::milliseconds initial_backoff{200};
+  std::chrono::milliseconds max_backoff{10000};
+  // post() is not idempotent in general, so it is sent once by default
+  bool retry_posts = false;
+  // Counts each retry against its host; must outlive the client
+  HttpMetrics* metrics = nullptr;
+};
+
+// Retries a request that timed out or was answered 429 or 5xx, thrown as
+// HttpException or returned as a response. Each wait is drawn uniformly
+// from [0, backoff] ("full jitter"), so callers throttled together do
+// not come back together; a returned response's Retry-After seconds
+// raise the wait, still capped at max_backoff. After the last attempt
+// its exception or response is passed on. Connection errors and other
+// statuses are not retried.
+class RetryingHttpClient : public IHttpClient {
+ public:
+  // inner must outlive this client. Throws std::invalid_argument if
+  // max_attempts is below 1 or a backoff is negative.
+  explicit RetryingHttpClient(IHttpClient& inner,
+                              const RetryOptions& options = {});
+
+  RetryingHttpClient(const RetryingHttpClient&) = delete;
+  RetryingHttpClient& operator=(const RetryingHttpClient&) = delete;
+
+  // Configuration, forwarded
+  void setDefaultHeaders(const Headers& headers) override;
+  void setConnectTimeout(int seconds) override;
+  void setReadTimeout(int seconds) override;
+
+  // HTTP methods
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params = {}) override;
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
+
+  std::unique_ptr<IHttpResponse> post(
+      const std::string& url, const std::string& body,
+      const std::string& content_type = "application/json") override;
+
+  // Attempts after the first
+  uint64_t retries() const { return retries_; }
+
+ private:
+  static bool retryableStatus(int status_code);
+
+  template <typename Send>
+  std::unique_ptr<IHttpResponse> withRetries(const std::string& url,
+                                             int max_attempts,
+                                             const Send& send);
+  // Sleeps before retry number attempt (1-based)
+  void backoff(int attempt, std::chrono::milliseconds at_least);
+
+  IHttpClient& inner_;
+  const RetryOptions options_;
+
+  std::mutex random_mutex_;
+  std::mt19937_64 random_;
+  std::atomic<uint64_t> retries_{0};
+};
+
+// ============================================================
+// ResilientHttpClient - the stack in one client
+// ============================================================
+
+struct ResilientHttpOptions {
+  bool coalesce = true;
+  RateLimitOptions rate_limit;
+  RetryOptions retry;
+};
+
+// CoalescingHttpClient -> RetryingHttpClient -> RateLimitedHttpClient in
+// front of inner. Throws std::invalid_argument on bad options.
+class ResilientHttpClient : public IHttpClient {
+ public:
+  // inner must outlive this client
+  explicit ResilientHttpClient(IHttpClient& inner,
+                               const ResilientHttpOptions& options = {});
+
+  ResilientHttpClient(const ResilientHttpClient&) = delete;
+  ResilientHttpClient& operator=(const ResilientHttpClient&) = delete;
+
+  // Configuration, forwarded
+  void setDefaultHeaders(const Headers& headers) override;
+  void setConnectTimeout(int seconds) override;
+  void setReadTimeout(int seconds) override;
+
+  // HTTP methods
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params = {}) override;
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
+
+  std::unique_ptr<IHttpResponse> post(
+      const std::string& url, const std::string& body,
+      const std::string& content_type = "application/json") override;
+
+  const CoalescingHttpClient* coalescing() const { return coalescing_.get(); }
+  const RetryingHttpClient& retrying() const { return retrying_; }
+  const RateLimitedHttpClient& rateLimited() const { return rate_limited_; }
+
+ private:
+  RateLimitedHttpClient rate_limited_;
+  RetryingHttpClient retrying_;
+  std::unique_ptr<CoalescingHttpClient> coalescing_;  // null if disabled
+  IHttpClient& outermost_;
+};
+
+}  // namespace Gateways::Network
+
+#endif  // GATEWAYS_NETWORK_HTTP_MIDDLEWARE_H_
@@ -2,11 +2,20 @@
 #ifndef GATEWAYS_NETWORK_HTTPLIB_NETWORK_CONNECTOR_H_
 #define GATEWAYS_NETWORK_HTTPLIB_NETWORK_CONNECTOR_H_
 
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 // #define CPPHTTPLIB_OPENSSL_SUPPORT
 
+#include "http_metrics.h"
 #include "httplib.h"
 #include "network_connector.h"
 
@@ -18,29 +27,57 @@ namespace Gateways::Network {
 
 class HttplibResponse : public IHttpResponse {
  public:
-  HttplibResponse(int status_code, std::string body, Headers headers);
+  HttplibResponse(int status_code, std::string body, ResponseHeaders headers);
   ~HttplibResponse() override = default;
 
   int statusCode() const override;
   std::string body() const override;
-  Headers headers() const override;
+  std::string_view bodyView() const override;
+  std::string takeBody() override;
+  const ResponseHeaders& headers() const override;
   std::string header(const std::string& name) const override;
 
  private:
   int status_code_;
   std::string body_;
-  Headers headers_;
+  ResponseHeaders headers_;
 };
 
 // ============================================================
 // HttplibClient
 // ============================================================
 
+struct HttplibClientOptions {
+  // Connections open to one scheme+host at a time; requests beyond it
+  // wait for one to come back
+  size_t max_connections_per_host = 4;
+  // Idle connections older than this are closed rather than reused
+  std::chrono::seconds idle_timeout{30};
+  // Advertise the compiled-in encodings and decode responses in them;
+  // otherwise responses are requested as identity
+  bool accept_compressed = false;
+  // gzip post() bodies; needs ENABLE_ZLIB
+  bool compress_requests = false;
+  // Receives a timing of every request; must outlive the client. Null
+  // turns the instrumentation off.
+  HttpMetrics* metrics = nullptr;
+};
+
+// Keeps a pool of keep-alive connections per scheme+host, so repeated
+// requests to a host skip DNS, TCP and TLS setup. A connection that
+// failed is closed instead of going back to the pool. Thread-safe;
+// configuration changes apply to the next request.
 class HttplibClient : public IHttpClient {
  public:
-  HttplibClient() = default;
+  // Throws std::invalid_argument if options ask for compression that was
+  // not compiled in (ENABLE_ZLIB / ENABLE_BROTLI)
+  explicit HttplibClient(const HttplibClientOptions& options = {});
   ~HttplibClient() override = default;
 
+  // Transfer encodings compiled in, e.g. "br, gzip, deflate"; empty
+  // without ENABLE_ZLIB and ENABLE_BROTLI
+  static std::string supportedEncodings();
+
   HttplibClient(const HttplibClient&) = delete;
   HttplibClient& operator=(const HttplibClient&) = delete;
   HttplibClient(HttplibClient&&) = delete;
@@ -54,11 +91,20 @@ class HttplibClient : public IHttpClient {
   // HTTP methods
   std::unique_ptr<IHttpResponse> get(const std::string& url,
                                      const QueryParams& params = {}) override;
+  // Non-2xx statuses, 304 included, throw HttpException
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers& headers) override;
 
   std::unique_ptr<IHttpResponse> post(
       const std::string& url, const std::string& body,
       const std::string& content_type = "application/json") override;
 
+  // Pooled connections not in use, across hosts
+  size_t idleConnections() const;
+  // Closes every idle connection
+  void closeIdleConnections();
+
  private:
   // Parse URL into scheme+host and path components
   struct ParsedUrl {
@@ -66,11 +112,53 @@ class HttplibClient : public IHttpClient {
     std::string path;         // e.g., "/_rpc/json/instrument/chart/data"
   };
 
+  struct IdleConnection {
+    std::unique_ptr<httplib::Client> client;
+    std::chrono::steady_clock::time_point last_used;
+  };
+
+  struct HostPool {
+    std::vector<IdleConnection> idle;  // most recently used last
+    size_t open = 0;                   // idle and in use
+  };
+
+  // progress is set when the request is timed; GETs pass it to httplib,
+  // which calls it as body bytes arrive
+  using Request = std::function<httplib::Result(
+      httplib::Client&, const httplib::Headers&, const httplib::Progress&)>;
+
   static ParsedUrl parseUrl(const std::string& url);
   static std::string buildQueryString(const QueryParams& params);
-  httplib::Headers toHttplibHeaders() const;
 
-  Headers default_headers_;
+  // Runs request on a pooled connection to scheme_host and maps the
+  // result to a response or exception; with options_.metrics, records
+  // its timing. body_bytes is the request body's size.
+  std::unique_ptr<IHttpResponse> send(const std::string& url,
+                                      const std::string& scheme_host,
+                                      const Request& request,
+                                      const Headers& extra_headers = {},
+                                      size_t body_bytes = 0);
+  // An idle connection, or a new one once the host is under the limit;
+  // configured with the current timeouts. headers gets the defaults;
+  // created tells which of the two it was.
+  std::unique_ptr<httplib::Client> acquire(
+      const std::string& scheme_host,
+      std::shared_ptr<const httplib::Headers>& headers, bool& created);
+  void release(const std::string& scheme_host,
+               std::unique_ptr<httplib::Client> client, bool reusable);
+  // Moves idle connections past the timeout out of the pool, to be
+  // closed outside the lock
+  void evictIdle(std::chrono::steady_clock::time_point now,
+                 std::vector<std::unique_ptr<httplib::Client>>& closed);
+
+  const HttplibClientOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable released_;
+  std::map<std::string, HostPool> pools_;
+  // Converted once per setDefaultHeaders(); requests share the snapshot
+  std::shared_ptr<const httplib::Headers> default_headers_ =
+      std::make_shared<const httplib::Headers>();
   int connect_timeout_sec_ = 10;
   int read_timeout_sec_ = 30;
 };
@@ -0,0 +1,24 @@
+// i_http_cache_store.h
+#ifndef GATEWAYS_NETWORK_I_HTTP_CACHE_STORE_H_
+#define GATEWAYS_NETWORK_I_HTTP_CACHE_STORE_H_
+
+#include <optional>
+#include <string>
+
+namespace Gateways::Network {
+
+// Persistent second level for CachingHttpClient. Values are opaque
+// encoded responses; implementations only need to keep them by key.
+// Called from several threads at once.
+class IHttpCacheStore {
+ public:
+  virtual ~IHttpCacheStore() = default;
+
+  virtual std::optional<std::string> load(const std::string& key) = 0;
+  virtual void save(const std::string& key, const std::string& value) = 0;
+  virtual void remove(const std::string& key) = 0;
+};
+
+}  // namespace Gateways::Network
+
+#endif  // GATEWAYS_NETWORK_I_HTTP_CACHE_STORE_H_
@@ -2,11 +2,16 @@
 #ifndef GATEWAYS_NETWORK_NETWORK_CONNECTOR_H_
 #define GATEWAYS_NETWORK_NETWORK_CONNECTOR_H_
 
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace Gateways::Network {
@@ -18,6 +23,47 @@ namespace Gateways::Network {
 using Headers = std::map<std::string, std::string>;
 using QueryParams = std::map<std::string, std::string>;
 
+// Response header fields as received, in a flat vector: built once per
+// response by moving the fields in, and looked up case-insensitively as
+// HTTP field names are. A linear scan beats a tree for the dozen or so
+// fields a response carries.
+class ResponseHeaders {
+ public:
+  using Field = std::pair<std::string, std::string>;
+  using const_iterator = std::vector<Field>::const_iterator;
+
+  void reserve(size_t count) { fields_.reserve(count); }
+  void add(std::string name, std::string value) {
+    fields_.emplace_back(std::move(name), std::move(value));
+  }
+
+  // First value of the field, or nullptr
+  const std::string* find(std::string_view name) const {
+    for (const auto& field : fields_) {
+      if (equalsIgnoreCase(field.first, name)) {
+        return &field.second;
+      }
+    }
+    return nullptr;
+  }
+
+  size_t size() const { return fields_.size(); }
+  bool empty() const { return fields_.empty(); }
+  const_iterator begin() const { return fields_.begin(); }
+  const_iterator end() const { return fields_.end(); }
+
+ private:
+  static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+             return std::tolower(static_cast<unsigned char>(x)) ==
+                    std::tolower(static_cast<unsigned char>(y));
+           });
+  }
+
+  std::vector<Field> fields_;
+};
+
 // ============================================================
 // Exceptions
 // ============================================================
@@ -60,8 +106,14 @@ class IHttpResponse {
   virtual ~IHttpResponse() = default;
 
   virtual int statusCode() const = 0;
+  // A copy; prefer bodyView() or takeBody() for large payloads
   virtual std::string body() const = 0;
-  virtual Headers headers() const = 0;
+  // Valid while the response lives and until takeBody()
+  virtual std::string_view bodyView() const = 0;
+  // Moves the body out, leaving it empty
+  virtual std::string takeBody() = 0;
+  virtual const ResponseHeaders& headers() const = 0;
+  // Case-insensitive; empty if absent
   virtual std::string header(const std::string& name) const = 0;
 };
 
@@ -81,6 +133,10 @@ class IHttpClient {
   // HTTP methods
   virtual std::unique_ptr<IHttpResponse> get(
       const std::string& url, const QueryParams& params = {}) = 0;
+  // As above, with headers added to the defaults for this request only
+  virtual std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                             const QueryParams& params,
+                                             const Headers& headers) = 0;
 
   virtual std::unique_ptr<IHttpResponse> post(
       const std::string& url, const std::string& body,
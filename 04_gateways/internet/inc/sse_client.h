@@ -0,0 +1,129 @@
+// sse_client.h
+#ifndef GATEWAYS_NETWORK_SSE_CLIENT_H_
+#define GATEWAYS_NETWORK_SSE_CLIENT_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "network_connector.h"
+
+namespace httplib {
+class Client;
+}
+
+namespace Gateways::Network {
+
+// ============================================================
+// SseParser - text/event-stream framing
+// ============================================================
+
+struct SseEvent {
+  std::string id;  // the stream's last event id when this one arrived
+  std::string type = "message";
+  std::string data;  // data lines joined by '\n'
+};
+
+// Splits a server-sent event stream into events as its bytes arrive, in
+// chunks cut anywhere. Follows the WHATWG framing: "field: value" lines,
+// CRLF, LF or CR line ends, ':' comments (keep-alives), and an event per
+// blank line that follows data.
+class SseParser {
+ public:
+  using OnEvent = std::function<bool(const SseEvent&)>;
+
+  // On reconnect, resume after last_event_id
+  explicit SseParser(std::string last_event_id = "");
+
+  // Calls on_event with each event completed by chunk. Returns false as
+  // soon as on_event does, with the rest of chunk unread.
+  bool feed(std::string_view chunk, const OnEvent& on_event);
+
+  // Drops a partly received event, as a dropped connection does; the
+  // last event id and retry time are kept
+  void reset();
+
+  const std::string& lastEventId() const { return last_event_id_; }
+  // Reconnection time the server asked for with "retry:"
+  std::optional<std::chrono::milliseconds> retry() const { return retry_; }
+
+ private:
+  // false if on_event asked to stop
+  bool line(std::string_view text, const OnEvent& on_event);
+
+  std::string last_event_id_;
+  std::optional<std::chrono::milliseconds> retry_;
+
+  std::string line_;  // bytes of the line being received
+  bool after_cr_ = false;  // a CR ended the last line; skip a LF after it
+  bool at_start_ = true;  // a BOM may still come
+  std::string type_;
+  std::string data_;
+  bool has_data_ = false;
+};
+
+// ============================================================
+// SseClient - a reconnecting event stream
+// ============================================================
+
+struct SseClientOptions {
+  // Wait before reconnecting, until the server sends its own with
+  // "retry:"; doubled after each attempt that delivers nothing
+  std::chrono::milliseconds reconnect_delay{1000};
+  std::chrono::milliseconds max_reconnect_delay{30000};
+  int connect_timeout_sec = 10;
+  // A stream silent for longer is taken as dropped; servers keep it
+  // warm with comment lines
+  int read_timeout_sec = 60;
+};
+
+// Holds one event stream open over httplib and reconnects whenever it
+// drops, sending Last-Event-ID so the server resumes after the last
+// event delivered. HTTP has no push other than a long response, so
+// this is SSE rather than WebSocket. Thread-safe: stop() may be called
+// from any thread while stream() blocks in another.
+class SseClient {
+ public:
+  explicit SseClient(const SseClientOptions& options = {});
+  ~SseClient();
+
+  SseClient(const SseClient&) = delete;
+  SseClient& operator=(const SseClient&) = delete;
+
+  // Blocks, calling on_event with each event in order, until on_event
+  // returns false, stop() is called, or the server answers 204 (its
+  // "do not reconnect"). Returns the last event id, to resume from in
+  // a later call. Connection errors, timeouts, 408, 429 and 5xx are
+  // retried; other statuses throw HttpException.
+  std::string stream(const std::string& url, const Headers& headers,
+                     const SseParser::OnEvent& on_event,
+                     const std::string& last_event_id = "");
+
+  // Ends stream(), now and for any later call
+  void stop();
+
+  // Connections opened after the first, across calls
+  uint64_t reconnects() const;
+
+ private:
+  bool stopped() const;
+  // Sleeps for delay, or until stop(); false if stopped
+  bool waitToReconnect(std::chrono::milliseconds delay);
+
+  const SseClientOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable stopping_;
+  bool stopped_ = false;
+  httplib::Client* active_ = nullptr;  // the connection stream() reads
+  uint64_t reconnects_ = 0;
+};
+
+}  // namespace Gateways::Network
+
+#endif  // GATEWAYS_NETWORK_SSE_CLIENT_H_
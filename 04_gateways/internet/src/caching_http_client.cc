@@ -0,0 +1,439 @@
+// caching_http_client.cc
+#include "caching_http_client.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace Gateways::Network {
+
+namespace {
+
+const std::shared_ptr<const std::string>& emptyBody() {
+  static const auto kEmpty = std::make_shared<const std::string>();
+  return kEmpty;
+}
+
+std::string_view trim(std::string_view text) {
+  while (!text.empty() && std::isspace(static_cast<unsigned char>(text[0]))) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() &&
+         std::isspace(static_cast<unsigned char>(text.back()))) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+struct CacheControl {
+  bool no_store = false;
+  std::optional<std::chrono::seconds> max_age;
+};
+
+// Only the directives a client cache acts on
+CacheControl parseCacheControl(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(), [](char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  });
+
+  CacheControl control;
+  std::string_view rest = value;
+  while (!rest.empty()) {
+    const size_t comma = rest.find(',');
+    const std::string_view directive = trim(rest.substr(0, comma));
+    rest = comma == std::string_view::npos ? std::string_view()
+                                           : rest.substr(comma + 1);
+
+    if (directive == "no-store") {
+      control.no_store = true;
+    } else if (directive == "no-cache") {
+      control.max_age = std::chrono::seconds(0);
+    } else if (directive.substr(0, 8) == "max-age=" && !control.max_age) {
+      try {
+        control.max_age = std::chrono::seconds(
+            std::stoll(std::string(directive.substr(8))));
+      } catch (const std::exception&) {
+        control.max_age = std::chrono::seconds(0);
+      }
+    }
+  }
+  return control;
+}
+
+// Length-prefixed fields: "<size>:<bytes>"
+void appendField(std::string& out, std::string_view field) {
+  out += std::to_string(field.size());
+  out += ':';
+  out += field;
+}
+
+bool readField(std::string_view& in, std::string_view& field) {
+  const size_t colon = in.find(':');
+  if (colon == std::string_view::npos || colon == 0) {
+    return false;
+  }
+  size_t size = 0;
+  for (char c : in.substr(0, colon)) {
+    if (!std::isdigit(static_cast<unsigned char>(c))) {
+      return false;
+    }
+    size = size * 10 + static_cast<size_t>(c - '0');
+  }
+  if (in.size() - colon - 1 < size) {
+    return false;
+  }
+  field = in.substr(colon + 1, size);
+  in.remove_prefix(colon + 1 + size);
+  return true;
+}
+
+bool readNumber(std::string_view& in, int64_t& number) {
+  std::string_view field;
+  if (!readField(in, field) || field.empty()) {
+    return false;
+  }
+  try {
+    size_t used = 0;
+    number = std::stoll(std::string(field), &used);
+    return used == field.size();
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+constexpr int64_t kFormatVersion = 1;
+
+}  // namespace
+
+// ============================================================
+// CachedHttpResponse
+// ============================================================
+
+CachedHttpResponse::CachedHttpResponse(int status_code,
+                                       std::shared_ptr<const std::string> body,
+                                       ResponseHeaders headers)
+    : status_code_(status_code),
+      body_(std::move(body)),
+      headers_(std::move(headers)) {}
+
+int CachedHttpResponse::statusCode() const { return status_code_; }
+
+std::string CachedHttpResponse::body() const { return *body_; }
+
+std::string_view CachedHttpResponse::bodyView() const { return *body_; }
+
+std::string CachedHttpResponse::takeBody() {
+  std::string body = *body_;
+  body_ = emptyBody();
+  return body;
+}
+
+const ResponseHeaders& CachedHttpResponse::headers() const {
+  return headers_;
+}
+
+std::string CachedHttpResponse::header(const std::string& name) const {
+  const std::string* value = headers_.find(name);
+  if (!value) return "";
+  return *value;
+}
+
+// ============================================================
+// CachingHttpClient
+// ============================================================
+
+CachingHttpClient::CachingHttpClient(IHttpClient& inner,
+                                     const HttpCacheOptions& options,
+                                     IHttpCacheStore* store)
+    : inner_(inner), options_(options), store_(store) {
+  if (options.max_entries == 0) {
+    throw std::invalid_argument("max_entries must be positive");
+  }
+}
+
+void CachingHttpClient::setDefaultHeaders(const Headers& headers) {
+  inner_.setDefaultHeaders(headers);
+}
+
+void CachingHttpClient::setConnectTimeout(int seconds) {
+  inner_.setConnectTimeout(seconds);
+}
+
+void CachingHttpClient::setReadTimeout(int seconds) {
+  inner_.setReadTimeout(seconds);
+}
+
+std::unique_ptr<IHttpResponse> CachingHttpClient::get(
+    const std::string& url, const QueryParams& params) {
+  return get(url, params, {});
+}
+
+std::unique_ptr<IHttpResponse> CachingHttpClient::get(
+    const std::string& url, const QueryParams& params,
+    const Headers& headers) {
+  const std::string key = cacheKey(url, params);
+  EntryPtr entry = find(key);
+
+  if (entry && entry->max_age &&
+      std::chrono::system_clock::now() - entry->stored_at < *entry->max_age) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.hits;
+    return respond(entry);
+  }
+
+  Headers request_headers = headers;
+  if (entry && !entry->etag.empty()) {
+    request_headers["If-None-Match"] = entry->etag;
+  }
+  if (entry && !entry->last_modified.empty()) {
+    request_headers["If-Modified-Since"] = entry->last_modified;
+  }
+
+  std::unique_ptr<IHttpResponse> response;
+  try {
+    response = inner_.get(url, params, request_headers);
+  } catch (const HttpException& e) {
+    if (entry && e.statusCode() == 304) {
+      return revalidated(key, entry);
+    }
+    throw;
+  }
+  if (entry && response->statusCode() == 304) {
+    return revalidated(key, entry);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.misses;
+  }
+  return storeResponse(key, std::move(response));
+}
+
+std::unique_ptr<IHttpResponse> CachingHttpClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  return inner_.post(url, body, content_type);
+}
+
+HttpCacheStats CachingHttpClient::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void CachingHttpClient::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_.clear();
+  index_.clear();
+}
+
+std::string CachingHttpClient::cacheKey(const std::string& url,
+                                        const QueryParams& params) {
+  // QueryParams is ordered, so equal params give equal keys
+  std::string key = url;
+  char separator = '?';
+  for (const auto& [name, value] : params) {
+    key += separator;
+    key += name;
+    key += '=';
+    key += value;
+    separator = '&';
+  }
+  return key;
+}
+
+std::string CachingHttpClient::encode(const Entry& entry) {
+  std::string out;
+  out.reserve(entry.body->size() + 256);
+  appendField(out, std::to_string(kFormatVersion));
+  appendField(out, std::to_string(entry.status_code));
+  const auto stored_at_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          entry.stored_at.time_since_epoch());
+  appendField(out, std::to_string(stored_at_ms.count()));
+  appendField(out,
+              std::to_string(entry.max_age ? entry.max_age->count() : -1));
+  appendField(out, entry.etag);
+  appendField(out, entry.last_modified);
+  appendField(out, std::to_string(entry.headers.size()));
+  for (const auto& [name, value] : entry.headers) {
+    appendField(out, name);
+    appendField(out, value);
+  }
+  appendField(out, *entry.body);
+  return out;
+}
+
+std::optional<CachingHttpClient::Entry> CachingHttpClient::decode(
+    std::string_view value) {
+  Entry entry;
+  int64_t version = 0;
+  int64_t status_code = 0;
+  int64_t stored_at_ms = 0;
+  int64_t max_age = 0;
+  int64_t header_count = 0;
+  std::string_view field;
+
+  if (!readNumber(value, version) || version != kFormatVersion ||
+      !readNumber(value, status_code) || !readNumber(value, stored_at_ms) ||
+      !readNumber(value, max_age)) {
+    return std::nullopt;
+  }
+  entry.status_code = static_cast<int>(status_code);
+  entry.stored_at = std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::milliseconds(stored_at_ms)));
+  if (max_age >= 0) {
+    entry.max_age = std::chrono::seconds(max_age);
+  }
+
+  if (!readField(value, field)) return std::nullopt;
+  entry.etag = field;
+  if (!readField(value, field)) return std::nullopt;
+  entry.last_modified = field;
+
+  if (!readNumber(value, header_count) || header_count < 0) {
+    return std::nullopt;
+  }
+  for (int64_t i = 0; i < header_count; ++i) {
+    std::string_view name;
+    if (!readField(value, name) || !readField(value, field)) {
+      return std::nullopt;
+    }
+    entry.headers.add(std::string(name), std::string(field));
+  }
+
+  if (!readField(value, field) || !value.empty()) return std::nullopt;
+  entry.body = std::make_shared<const std::string>(field);
+  return entry;
+}
+
+std::unique_ptr<IHttpResponse> CachingHttpClient::respond(
+    const EntryPtr& entry) {
+  return std::make_unique<CachedHttpResponse>(entry->status_code, entry->body,
+                                              entry->headers);
+}
+
+CachingHttpClient::EntryPtr CachingHttpClient::find(const std::string& key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->second;
+    }
+  }
+  if (!store_) {
+    return nullptr;
+  }
+
+  std::optional<std::string> value;
+  try {
+    value = store_->load(key);
+  } catch (const std::exception&) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.store_failures;
+    return nullptr;
+  }
+  if (!value) {
+    return nullptr;
+  }
+  auto entry = decode(*value);
+  if (!entry) {
+    return nullptr;  // written by another format; replaced on the next fetch
+  }
+  auto shared = std::make_shared<const Entry>(std::move(*entry));
+  put(key, shared, false);
+  return shared;
+}
+
+void CachingHttpClient::put(const std::string& key, const EntryPtr& entry,
+                            bool persist) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      it->second->second = entry;
+      lru_.splice(lru_.begin(), lru_, it->second);
+    } else {
+      lru_.emplace_front(key, entry);
+      index_.emplace(key, lru_.begin());
+      if (lru_.size() > options_.max_entries) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+      }
+    }
+  }
+
+  if (persist && store_) {
+    try {
+      store_->save(key, encode(*entry));
+    } catch (const std::exception&) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.store_failures;
+    }
+  }
+}
+
+void CachingHttpClient::forget(const std::string& key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      lru_.erase(it->second);
+      index_.erase(it);
+    }
+  }
+  if (store_) {
+    try {
+      store_->remove(key);
+    } catch (const std::exception&) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.store_failures;
+    }
+  }
+}
+
+std::unique_ptr<IHttpResponse> CachingHttpClient::storeResponse(
+    const std::string& key, std::unique_ptr<IHttpResponse> response) {
+  const CacheControl control =
+      parseCacheControl(response->header("Cache-Control"));
+  std::string etag = response->header("ETag");
+  std::string last_modified = response->header("Last-Modified");
+
+  if (control.no_store ||
+      (!control.max_age && etag.empty() && last_modified.empty())) {
+    forget(key);
+    return response;
+  }
+
+  auto entry = std::make_shared<Entry>();
+  entry->status_code = response->statusCode();
+  entry->headers = response->headers();
+  entry->body = std::make_shared<const std::string>(response->takeBody());
+  entry->etag = std::move(etag);
+  entry->last_modified = std::move(last_modified);
+  entry->stored_at = std::chrono::system_clock::now();
+  entry->max_age = control.max_age;
+
+  EntryPtr shared = entry;
+  put(key, shared, true);
+  return respond(shared);
+}
+
+std::unique_ptr<IHttpResponse> CachingHttpClient::revalidated(
+    const std::string& key, const EntryPtr& entry) {
+  // The 304's own headers may not reach us through an exception, so the
+  // entry keeps its max-age and only its age is reset
+  auto refreshed = std::make_shared<Entry>(*entry);
+  refreshed->stored_at = std::chrono::system_clock::now();
+
+  EntryPtr shared = refreshed;
+  put(key, shared, true);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.revalidations;
+  }
+  return respond(shared);
+}
+
+}  // namespace Gateways::Network
@@ -0,0 +1,281 @@
+// http_fixture.cc
+#include "http_fixture.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "caching_http_client.h"
+
+namespace Gateways::Network {
+
+namespace {
+
+uint64_t fnv1a(const std::string& text) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string hex(uint64_t value) {
+  char out[17];
+  std::snprintf(out, sizeof(out), "%016llx",
+                static_cast<unsigned long long>(value));
+  return out;
+}
+
+// The message HttpException was built with, without its "HTTP <code>: "
+std::string httpMessage(const HttpException& e) {
+  const std::string what = e.what();
+  const std::string prefix = "HTTP " + std::to_string(e.statusCode()) + ": ";
+  return what.compare(0, prefix.size(), prefix) == 0
+             ? what.substr(prefix.size())
+             : what;
+}
+
+}  // namespace
+
+// ============================================================
+// HttpFixtureStore
+// ============================================================
+
+HttpFixtureStore::HttpFixtureStore(std::string directory)
+    : directory_(std::move(directory)) {}
+
+std::string HttpFixtureStore::getKey(const std::string& url,
+                                     const QueryParams& params) {
+  std::string key = "GET " + url;
+  char separator = '?';
+  for (const auto& [name, value] : params) {
+    key += separator;
+    key += name;
+    key += '=';
+    key += value;
+    separator = '&';
+  }
+  return key;
+}
+
+std::string HttpFixtureStore::postKey(const std::string& url,
+                                      const std::string& body,
+                                      const std::string& content_type) {
+  return "POST " + url + " " + content_type + " " + hex(fnv1a(body));
+}
+
+void HttpFixtureStore::save(const std::string& key,
+                            const RecordedResponse& response) {
+  const std::string path = pathFor(key);
+  // Unique per thread, so concurrent savers of one key do not collide
+  static std::atomic<uint64_t> sequence{0};
+  const std::string temporary = path + ".tmp" + std::to_string(++sequence);
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out << key << '\n' << response.status_code << '\n';
+    for (const auto& [name, value] : response.headers) {
+      out << name << ": " << value << '\n';
+    }
+    out << '\n';
+    out.write(response.body.data(),
+              static_cast<std::streamsize>(response.body.size()));
+    if (!out) {
+      std::remove(temporary.c_str());
+      throw NetworkException("HTTP fixture: cannot write " + temporary);
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    throw NetworkException("HTTP fixture: cannot write " + path);
+  }
+}
+
+std::optional<RecordedResponse> HttpFixtureStore::load(
+    const std::string& key) const {
+  const std::string path = pathFor(key);
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::nullopt;
+  }
+
+  std::string line;
+  if (!std::getline(in, line) || line != key) {
+    return std::nullopt;  // another key with the same hash
+  }
+  RecordedResponse response;
+  if (!std::getline(in, line)) {
+    throw NetworkException("HTTP fixture: truncated " + path);
+  }
+  try {
+    response.status_code = std::stoi(line);
+  } catch (const std::exception&) {
+    throw NetworkException("HTTP fixture: bad status in " + path);
+  }
+  while (std::getline(in, line) && !line.empty()) {
+    const size_t colon = line.find(": ");
+    if (colon == std::string::npos) {
+      throw NetworkException("HTTP fixture: bad header in " + path);
+    }
+    response.headers.add(line.substr(0, colon), line.substr(colon + 2));
+  }
+  std::ostringstream body;
+  body << in.rdbuf();
+  response.body = std::move(body).str();
+  return response;
+}
+
+std::string HttpFixtureStore::pathFor(const std::string& key) const {
+  return directory_ + "/" + hex(fnv1a(key)) + ".http";
+}
+
+// ============================================================
+// RecordingHttpClient
+// ============================================================
+
+RecordingHttpClient::RecordingHttpClient(IHttpClient& inner,
+                                         HttpFixtureStore& store)
+    : inner_(inner), store_(store) {}
+
+void RecordingHttpClient::setDefaultHeaders(const Headers& headers) {
+  inner_.setDefaultHeaders(headers);
+}
+
+void RecordingHttpClient::setConnectTimeout(int seconds) {
+  inner_.setConnectTimeout(seconds);
+}
+
+void RecordingHttpClient::setReadTimeout(int seconds) {
+  inner_.setReadTimeout(seconds);
+}
+
+std::unique_ptr<IHttpResponse> RecordingHttpClient::get(
+    const std::string& url, const QueryParams& params) {
+  return get(url, params, {});
+}
+
+std::unique_ptr<IHttpResponse> RecordingHttpClient::get(
+    const std::string& url, const QueryParams& params,
+    const Headers& headers) {
+  return record(HttpFixtureStore::getKey(url, params),
+                [&] { return inner_.get(url, params, headers); });
+}
+
+std::unique_ptr<IHttpResponse> RecordingHttpClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  return record(HttpFixtureStore::postKey(url, body, content_type),
+                [&] { return inner_.post(url, body, content_type); });
+}
+
+template <typename Send>
+std::unique_ptr<IHttpResponse> RecordingHttpClient::record(
+    const std::string& key, const Send& send) {
+  std::unique_ptr<IHttpResponse> response;
+  try {
+    response = send();
+  } catch (const HttpException& e) {
+    store_.save(key, {e.statusCode(), {}, httpMessage(e)});
+    throw;
+  }
+  RecordedResponse recorded{response->statusCode(), response->headers(),
+                            std::string(response->bodyView())};
+  store_.save(key, recorded);
+  return response;
+}
+
+// ============================================================
+// ReplayHttpClient
+// ============================================================
+
+ReplayHttpClient::ReplayHttpClient(const HttpFixtureStore& store,
+                                   const ReplayOptions& options)
+    : store_(store), options_(options) {}
+
+void ReplayHttpClient::setDefaultHeaders(const Headers&) {}
+
+void ReplayHttpClient::setConnectTimeout(int) {}
+
+void ReplayHttpClient::setReadTimeout(int) {}
+
+std::unique_ptr<IHttpResponse> ReplayHttpClient::get(
+    const std::string& url, const QueryParams& params) {
+  return replay(HttpFixtureStore::getKey(url, params));
+}
+
+std::unique_ptr<IHttpResponse> ReplayHttpClient::get(
+    const std::string& url, const QueryParams& params, const Headers&) {
+  return replay(HttpFixtureStore::getKey(url, params));
+}
+
+std::unique_ptr<IHttpResponse> ReplayHttpClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  return replay(HttpFixtureStore::postKey(url, body, content_type));
+}
+
+uint64_t ReplayHttpClient::requests() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return requests_;
+}
+
+std::unique_ptr<IHttpResponse> ReplayHttpClient::replay(
+    const std::string& key) {
+  auto recorded = find(key);
+  if (!recorded) {
+    throw NetworkException("HTTP fixture: nothing recorded for " + key);
+  }
+
+  if (options_.max_concurrency > 0) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    slot_freed_.wait(lock,
+                     [&] { return in_flight_ < options_.max_concurrency; });
+    ++in_flight_;
+  }
+  auto delay = options_.latency;
+  if (options_.bytes_per_second > 0) {
+    delay += std::chrono::microseconds(recorded->body.size() * 1000000 /
+                                       options_.bytes_per_second);
+  }
+  std::this_thread::sleep_for(delay);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++requests_;
+    if (options_.max_concurrency > 0) {
+      --in_flight_;
+    }
+  }
+  slot_freed_.notify_one();
+
+  if (recorded->status_code < 200 || recorded->status_code >= 300) {
+    throw HttpException(recorded->status_code, recorded->body);
+  }
+  // Aliases the loaded fixture, so the body is not copied
+  return std::make_unique<CachedHttpResponse>(
+      recorded->status_code,
+      std::shared_ptr<const std::string>(recorded, &recorded->body),
+      recorded->headers);
+}
+
+std::shared_ptr<const RecordedResponse> ReplayHttpClient::find(
+    const std::string& key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = loaded_.find(key);
+    if (it != loaded_.end()) {
+      return it->second;
+    }
+  }
+  auto response = store_.load(key);
+  if (!response) {
+    return nullptr;
+  }
+  auto shared = std::make_shared<const RecordedResponse>(std::move(*response));
+  std::lock_guard<std::mutex> lock(mutex_);
+  return loaded_.emplace(key, std::move(shared)).first->second;
+}
+
+}  // namespace Gateways::Network
@@ -0,0 +1,225 @@
+// http_metrics.cc
+#include "http_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace Gateways::Network {
+
+namespace {
+
+size_t bucketOf(int64_t us) {
+  size_t bucket = 0;
+  while (bucket + 1 < LatencyHistogram::kBuckets && us >= 2) {
+    us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void appendString(std::string& out, const std::string& value) {
+  out += '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+void appendField(std::string& out, const char* name, uint64_t value) {
+  out += '"';
+  out += name;
+  out += "\":";
+  out += std::to_string(value);
+}
+
+void appendHistogram(std::string& out, const char* name,
+                     const LatencyHistogram& histogram) {
+  out += '"';
+  out += name;
+  out += "\":{";
+  appendField(out, "count", histogram.count());
+  out += ',';
+  appendField(out, "mean", histogram.mean().count());
+  out += ',';
+  appendField(out, "min", histogram.min().count());
+  out += ',';
+  appendField(out, "max", histogram.max().count());
+  out += ',';
+  appendField(out, "p50", histogram.quantile(0.5).count());
+  out += ',';
+  appendField(out, "p90", histogram.quantile(0.9).count());
+  out += ',';
+  appendField(out, "p99", histogram.quantile(0.99).count());
+  out += ",\"buckets\":[";
+  const auto& buckets = histogram.buckets();
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    if (i > 0) out += ',';
+    out += std::to_string(buckets[i]);
+  }
+  out += "]}";
+}
+
+}  // namespace
+
+// ============================================================
+// LatencyHistogram
+// ============================================================
+
+void LatencyHistogram::record(std::chrono::microseconds duration) {
+  const int64_t us = std::max<int64_t>(duration.count(), 0);
+  ++buckets_[bucketOf(us)];
+  if (count_ == 0 || us < min_us_) min_us_ = us;
+  if (count_ == 0 || us > max_us_) max_us_ = us;
+  ++count_;
+  total_us_ += us;
+}
+
+std::chrono::microseconds LatencyHistogram::total() const {
+  return std::chrono::microseconds(total_us_);
+}
+
+std::chrono::microseconds LatencyHistogram::min() const {
+  return std::chrono::microseconds(min_us_);
+}
+
+std::chrono::microseconds LatencyHistogram::max() const {
+  return std::chrono::microseconds(max_us_);
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const {
+  if (count_ == 0) {
+    return std::chrono::microseconds(0);
+  }
+  return std::chrono::microseconds(total_us_ /
+                                   static_cast<int64_t>(count_));
+}
+
+std::chrono::microseconds LatencyHistogram::quantile(double q) const {
+  if (count_ == 0) {
+    return std::chrono::microseconds(0);
+  }
+  q = std::clamp(q, 0.0, 1.0);
+  const auto rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // The bucket's upper bound, within what was actually seen
+      const int64_t upper = i + 1 < kBuckets ? int64_t{2} << i : max_us_;
+      return std::chrono::microseconds(
+          std::clamp(upper, min_us_, max_us_));
+    }
+  }
+  return std::chrono::microseconds(max_us_);
+}
+
+// ============================================================
+// HttpMetrics
+// ============================================================
+
+void HttpMetrics::record(const HttpRequestTiming& timing) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& host = hosts_[timing.scheme_host];
+  ++host.requests;
+  if (timing.status == 0) {
+    ++host.failures;
+  } else {
+    ++host.statuses[timing.status];
+  }
+  if (timing.new_connection) {
+    ++host.new_connections;
+  }
+  host.bytes_out += timing.bytes_out;
+  host.bytes_in += timing.bytes_in;
+
+  host.pool_wait.record(timing.pool_wait);
+  if (timing.first_byte) {
+    (timing.new_connection ? host.first_byte_new : host.first_byte_reused)
+        .record(*timing.first_byte);
+    host.transfer.record(timing.transfer);
+  }
+  host.total.record(timing.total);
+}
+
+void HttpMetrics::recordRetry(const std::string& scheme_host) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++hosts_[scheme_host].retries;
+}
+
+std::map<std::string, HostMetrics> HttpMetrics::hosts() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hosts_;
+}
+
+std::optional<HostMetrics> HttpMetrics::host(
+    const std::string& scheme_host) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = hosts_.find(scheme_host);
+  if (it == hosts_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::string HttpMetrics::toJson() const {
+  const auto snapshot = hosts();
+
+  std::string out = "{\"hosts\":{";
+  bool first_host = true;
+  for (const auto& [scheme_host, host] : snapshot) {
+    if (!first_host) out += ',';
+    first_host = false;
+    appendString(out, scheme_host);
+    out += ":{";
+    appendField(out, "requests", host.requests);
+    out += ',';
+    appendField(out, "failures", host.failures);
+    out += ',';
+    appendField(out, "retries", host.retries);
+    out += ',';
+    appendField(out, "new_connections", host.new_connections);
+    out += ',';
+    appendField(out, "bytes_out", host.bytes_out);
+    out += ',';
+    appendField(out, "bytes_in", host.bytes_in);
+
+    out += ",\"statuses\":{";
+    bool first_status = true;
+    for (const auto& [status, count] : host.statuses) {
+      if (!first_status) out += ',';
+      first_status = false;
+      out += '"' + std::to_string(status) + "\":" + std::to_string(count);
+    }
+    out += "},\"latency_us\":{";
+    appendHistogram(out, "pool_wait", host.pool_wait);
+    out += ',';
+    appendHistogram(out, "first_byte_new", host.first_byte_new);
+    out += ',';
+    appendHistogram(out, "first_byte_reused", host.first_byte_reused);
+    out += ',';
+    appendHistogram(out, "transfer", host.transfer);
+    out += ',';
+    appendHistogram(out, "total", host.total);
+    out += "}}";
+  }
+  out += "}}";
+  return out;
+}
+
+void HttpMetrics::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  hosts_.clear();
+}
+
+}  // namespace Gateways::Network
@@ -0,0 +1,352 @@
+// http_middleware.cc
+#include "http_middleware.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "caching_http_client.h"
+
+namespace Gateways::Network {
+
+namespace {
+
+// Scheme and authority, e.g. "https://www.ls-tc.de"
+std::string hostOf(const std::string& url) {
+  const size_t scheme = url.find("://");
+  const size_t start = scheme == std::string::npos ? 0 : scheme + 3;
+  return url.substr(0, url.find_first_of("/?#", start));
+}
+
+// Delta-seconds only; an HTTP-date gives nothing
+std::chrono::milliseconds parseRetryAfter(const std::string& value) {
+  if (value.empty() ||
+      !std::all_of(value.begin(), value.end(), [](char c) {
+        return std::isdigit(static_cast<unsigned char>(c));
+      })) {
+    return std::chrono::milliseconds(0);
+  }
+  try {
+    return std::chrono::seconds(std::stoll(value));
+  } catch (const std::exception&) {
+    return std::chrono::milliseconds(0);
+  }
+}
+
+}  // namespace
+
+// ============================================================
+// CoalescingHttpClient
+// ============================================================
+
+CoalescingHttpClient::CoalescingHttpClient(IHttpClient& inner)
+    : inner_(inner) {}
+
+void CoalescingHttpClient::setDefaultHeaders(const Headers& headers) {
+  inner_.setDefaultHeaders(headers);
+}
+
+void CoalescingHttpClient::setConnectTimeout(int seconds) {
+  inner_.setConnectTimeout(seconds);
+}
+
+void CoalescingHttpClient::setReadTimeout(int seconds) {
+  inner_.setReadTimeout(seconds);
+}
+
+std::unique_ptr<IHttpResponse> CoalescingHttpClient::get(
+    const std::string& url, const QueryParams& params) {
+  return get(url, params, {});
+}
+
+std::unique_ptr<IHttpResponse> CoalescingHttpClient::get(
+    const std::string& url, const QueryParams& params,
+    const Headers& headers) {
+  // Both maps are ordered, so equal requests give equal keys
+  std::string key = url;
+  for (const auto& [name, value] : params) {
+    key += '\n' + name + '=' + value;
+  }
+  key += '\n';
+  for (const auto& [name, value] : headers) {
+    key += '\n' + name + ':' + value;
+  }
+
+  std::shared_ptr<Flight> flight;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = flights_.find(key);
+    if (it != flights_.end()) {
+      flight = it->second;
+      landed_.wait(lock, [&] { return flight->done; });
+      ++coalesced_;
+      if (flight->error) {
+        std::rethrow_exception(flight->error);
+      }
+      return respond(*flight);
+    }
+    flight = std::make_shared<Flight>();
+    flights_.emplace(key, flight);
+  }
+
+  std::unique_ptr<IHttpResponse> response;
+  std::exception_ptr error;
+  try {
+    response = inner_.get(url, params, headers);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error) {
+      flight->error = error;
+    } else {
+      flight->status_code = response->statusCode();
+      flight->headers = response->headers();
+      flight->body = std::make_shared<const std::string>(response->takeBody());
+    }
+    flight->done = true;
+    flights_.erase(key);
+  }
+  landed_.notify_all();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return respond(*flight);
+}
+
+std::unique_ptr<IHttpResponse> CoalescingHttpClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  return inner_.post(url, body, content_type);
+}
+
+std::unique_ptr<IHttpResponse> CoalescingHttpClient::respond(
+    const Flight& flight) {
+  // A landed flight is no longer written, so no lock is needed
+  return std::make_unique<CachedHttpResponse>(flight.status_code, flight.body,
+                                              flight.headers);
+}
+
+// ============================================================
+// RateLimitedHttpClient
+// ============================================================
+
+RateLimitedHttpClient::RateLimitedHttpClient(IHttpClient& inner,
+                                             const RateLimitOptions& options)
+    : inner_(inner), options_(options) {
+  if (!(options.requests_per_second > 0.0)) {
+    throw std::invalid_argument("requests_per_second must be positive");
+  }
+  if (!(options.burst >= 1.0)) {
+    throw std::invalid_argument("burst must be at least 1");
+  }
+}
+
+void RateLimitedHttpClient::setDefaultHeaders(const Headers& headers) {
+  inner_.setDefaultHeaders(headers);
+}
+
+void RateLimitedHttpClient::setConnectTimeout(int seconds) {
+  inner_.setConnectTimeout(seconds);
+}
+
+void RateLimitedHttpClient::setReadTimeout(int seconds) {
+  inner_.setReadTimeout(seconds);
+}
+
+std::unique_ptr<IHttpResponse> RateLimitedHttpClient::get(
+    const std::string& url, const QueryParams& params) {
+  acquire(url);
+  return inner_.get(url, params);
+}
+
+std::unique_ptr<IHttpResponse> RateLimitedHttpClient::get(
+    const std::string& url, const QueryParams& params,
+    const Headers& headers) {
+  acquire(url);
+  return inner_.get(url, params, headers);
+}
+
+std::unique_ptr<IHttpResponse> RateLimitedHttpClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  acquire(url);
+  return inner_.post(url, body, content_type);
+}
+
+void RateLimitedHttpClient::acquire(const std::string& url) {
+  Clock::duration wait{0};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Clock::time_point now = Clock::now();
+    auto [it, inserted] =
+        buckets_.try_emplace(hostOf(url), Bucket{options_.burst, now});
+    Bucket& bucket = it->second;
+    if (!inserted) {
+      const double elapsed =
+          std::chrono::duration<double>(now - bucket.refilled_at).count();
+      bucket.tokens =
+          std::min(options_.burst,
+                   bucket.tokens + elapsed * options_.requests_per_second);
+      bucket.refilled_at = now;
+    }
+    // Taken now even if not there yet: the debt orders the waiters
+    bucket.tokens -= 1.0;
+    if (bucket.tokens < 0.0) {
+      wait = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(-bucket.tokens /
+                                        options_.requests_per_second));
+    }
+  }
+  if (wait > Clock::duration::zero()) {
+    ++delayed_;
+    std::this_thread::sleep_for(wait);
+  }
+}
+
+// ============================================================
+// RetryingHttpClient
+// ============================================================
+
+RetryingHttpClient::RetryingHttpClient(IHttpClient& inner,
+                                       const RetryOptions& options)
+    : inner_(inner), options_(options), random_(std::random_device{}()) {
+  if (options.max_attempts < 1) {
+    throw std::invalid_argument("max_attempts must be at least 1");
+  }
+  if (options.initial_backoff.count() < 0 ||
+      options.max_backoff.count() < 0) {
+    throw std::invalid_argument("Backoff must not be negative");
+  }
+}
+
+void RetryingHttpClient::setDefaultHeaders(const Headers& headers) {
+  inner_.setDefaultHeaders(headers);
+}
+
+void RetryingHttpClient::setConnectTimeout(int seconds) {
+  inner_.setConnectTimeout(seconds);
+}
+
+void RetryingHttpClient::setReadTimeout(int seconds) {
+  inner_.setReadTimeout(seconds);
+}
+
+std::unique_ptr<IHttpResponse> RetryingHttpClient::get(
+    const std::string& url, const QueryParams& params) {
+  return withRetries(url, options_.max_attempts,
+                     [&] { return inner_.get(url, params); });
+}
+
+std::unique_ptr<IHttpResponse> RetryingHttpClient::get(
+    const std::string& url, const QueryParams& params,
+    const Headers& headers) {
+  return withRetries(url, options_.max_attempts,
+                     [&] { return inner_.get(url, params, headers); });
+}
+
+std::unique_ptr<IHttpResponse> RetryingHttpClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  return withRetries(url, options_.retry_posts ? options_.max_attempts : 1,
+                     [&] { return inner_.post(url, body, content_type); });
+}
+
+bool RetryingHttpClient::retryableStatus(int status_code) {
+  return status_code == 429 || (status_code >= 500 && status_code < 600);
+}
+
+template <typename Send>
+std::unique_ptr<IHttpResponse> RetryingHttpClient::withRetries(
+    const std::string& url, int max_attempts, const Send& send) {
+  for (int attempt = 1;; ++attempt) {
+    const bool last = attempt >= max_attempts;
+    std::chrono::milliseconds at_least(0);
+    try {
+      auto response = send();
+      if (last || !retryableStatus(response->statusCode())) {
+        return response;
+      }
+      at_least = parseRetryAfter(response->header("Retry-After"));
+    } catch (const TimeoutException&) {
+      if (last) throw;
+    } catch (const HttpException& e) {
+      if (last || !retryableStatus(e.statusCode())) throw;
+    }
+    ++retries_;
+    if (options_.metrics) {
+      options_.metrics->recordRetry(hostOf(url));
+    }
+    backoff(attempt, at_least);
+  }
+}
+
+void RetryingHttpClient::backoff(int attempt,
+                                 std::chrono::milliseconds at_least) {
+  // Doubling in double cannot overflow before the cap applies
+  const double ceiling =
+      std::min(static_cast<double>(options_.max_backoff.count()),
+               static_cast<double>(options_.initial_backoff.count()) *
+                   static_cast<double>(1ULL << std::min(attempt - 1, 62)));
+
+  double wait_ms = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(random_mutex_);
+    wait_ms = std::uniform_real_distribution<double>(0.0, ceiling)(random_);
+  }
+  wait_ms = std::max(wait_ms, static_cast<double>(at_least.count()));
+  wait_ms =
+      std::min(wait_ms, static_cast<double>(options_.max_backoff.count()));
+  std::this_thread::sleep_for(
+      std::chrono::duration<double, std::milli>(wait_ms));
+}
+
+// ============================================================
+// ResilientHttpClient
+// ============================================================
+
+ResilientHttpClient::ResilientHttpClient(IHttpClient& inner,
+                                         const ResilientHttpOptions& options)
+    : rate_limited_(inner, options.rate_limit),
+      retrying_(rate_limited_, options.retry),
+      coalescing_(options.coalesce
+                      ? std::make_unique<CoalescingHttpClient>(retrying_)
+                      : nullptr),
+      outermost_(coalescing_ ? static_cast<IHttpClient&>(*coalescing_)
+                             : static_cast<IHttpClient&>(retrying_)) {}
+
+void ResilientHttpClient::setDefaultHeaders(const Headers& headers) {
+  outermost_.setDefaultHeaders(headers);
+}
+
+void ResilientHttpClient::setConnectTimeout(int seconds) {
+  outermost_.setConnectTimeout(seconds);
+}
+
+void ResilientHttpClient::setReadTimeout(int seconds) {
+  outermost_.setReadTimeout(seconds);
+}
+
+std::unique_ptr<IHttpResponse> ResilientHttpClient::get(
+    const std::string& url, const QueryParams& params) {
+  return outermost_.get(url, params);
+}
+
+std::unique_ptr<IHttpResponse> ResilientHttpClient::get(
+    const std::string& url, const QueryParams& params,
+    const Headers& headers) {
+  return outermost_.get(url, params, headers);
+}
+
+std::unique_ptr<IHttpResponse> ResilientHttpClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  return outermost_.post(url, body, content_type);
+}
+
+}  // namespace Gateways::Network
@@ -1,7 +1,13 @@
 // httplib_network_connector.cc
 #include "httplib_network_connector.h"
 
+#include <iterator>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "tracing.h"
 
 namespace Gateways::Network {
 
@@ -10,7 +16,7 @@ namespace Gateways::Network {
 // ============================================================
 
 HttplibResponse::HttplibResponse(int status_code, std::string body,
-                                 Headers headers)
+                                 ResponseHeaders headers)
     : status_code_(status_code),
       body_(std::move(body)),
       headers_(std::move(headers)) {}
@@ -19,46 +25,218 @@ int HttplibResponse::statusCode() const { return status_code_; }
 
 std::string HttplibResponse::body() const { return body_; }
 
-Headers HttplibResponse::headers() const { return headers_; }
+std::string_view HttplibResponse::bodyView() const { return body_; }
+
+std::string HttplibResponse::takeBody() { return std::move(body_); }
+
+const ResponseHeaders& HttplibResponse::headers() const { return headers_; }
 
 std::string HttplibResponse::header(const std::string& name) const {
-  auto it = headers_.find(name);
-  if (it == headers_.end()) return "";
-  return it->second;
+  const std::string* value = headers_.find(name);
+  if (!value) return "";
+  return *value;
 }
 
 // ============================================================
 // HttplibClient
 // ============================================================
 
+HttplibClient::HttplibClient(const HttplibClientOptions& options)
+    : options_(options) {
+  if (options.max_connections_per_host == 0) {
+    throw std::invalid_argument("max_connections_per_host must be positive");
+  }
+  if (options.accept_compressed && supportedEncodings().empty()) {
+    throw std::invalid_argument(
+        "accept_compressed needs ENABLE_ZLIB or ENABLE_BROTLI");
+  }
+#ifndef CPPHTTPLIB_ZLIB_SUPPORT
+  if (options.compress_requests) {
+    throw std::invalid_argument("compress_requests needs ENABLE_ZLIB");
+  }
+#endif
+  setDefaultHeaders({});
+}
+
+std::string HttplibClient::supportedEncodings() {
+  std::string encodings;
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+  encodings = "br";
+#endif
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+  if (!encodings.empty()) encodings += ", ";
+  encodings += "gzip, deflate";
+#endif
+  return encodings;
+}
+
 void HttplibClient::setDefaultHeaders(const Headers& headers) {
-  default_headers_ = headers;
+  auto converted = std::make_shared<httplib::Headers>();
+  for (const auto& [key, value] : headers) {
+    converted->emplace(key, value);
+  }
+  // Explicit either way: httplib advertises every codec compiled in
+  // unless the request names its own
+  if (converted->find("Accept-Encoding") == converted->end()) {
+    converted->emplace("Accept-Encoding", options_.accept_compressed
+                                              ? supportedEncodings()
+                                              : std::string("identity"));
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  default_headers_ = std::move(converted);
 }
 
 void HttplibClient::setConnectTimeout(int seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
   connect_timeout_sec_ = seconds;
 }
 
-void HttplibClient::setReadTimeout(int seconds) { read_timeout_sec_ = seconds; }
+void HttplibClient::setReadTimeout(int seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  read_timeout_sec_ = seconds;
+}
 
 std::unique_ptr<IHttpResponse> HttplibClient::get(const std::string& url,
                                                   const QueryParams& params) {
-  auto parsed = parseUrl(url);
-
-  httplib::Client client(parsed.scheme_host);
-  client.set_connection_timeout(connect_timeout_sec_, 0);
-  client.set_read_timeout(read_timeout_sec_, 0);
+  return get(url, params, {});
+}
 
-  auto hdrs = toHttplibHeaders();
+std::unique_ptr<IHttpResponse> HttplibClient::get(const std::string& url,
+                                                  const QueryParams& params,
+                                                  const Headers& headers) {
+  auto parsed = parseUrl(url);
 
   std::string path = parsed.path;
   if (!params.empty()) {
     path += "?" + buildQueryString(params);
   }
 
-  auto result = client.Get(path, hdrs);
+  return send(url, parsed.scheme_host,
+              [&path](httplib::Client& client, const httplib::Headers& hdrs,
+                      const httplib::Progress& progress) {
+                if (progress) {
+                  return client.Get(path, hdrs, progress);
+                }
+                return client.Get(path, hdrs);
+              },
+              headers);
+}
+
+std::unique_ptr<IHttpResponse> HttplibClient::post(
+    const std::string& url, const std::string& body,
+    const std::string& content_type) {
+  auto parsed = parseUrl(url);
+
+  return send(url, parsed.scheme_host,
+              [&](httplib::Client& client, const httplib::Headers& hdrs,
+                  const httplib::Progress&) {
+                return client.Post(parsed.path, hdrs, body, content_type);
+              },
+              {}, body.size());
+}
+
+size_t HttplibClient::idleConnections() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t idle = 0;
+  for (const auto& [scheme_host, pool] : pools_) {
+    idle += pool.idle.size();
+  }
+  return idle;
+}
+
+void HttplibClient::closeIdleConnections() {
+  std::vector<std::unique_ptr<httplib::Client>> closed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = pools_.begin(); it != pools_.end();) {
+      auto& pool = it->second;
+      for (auto& idle : pool.idle) {
+        closed.push_back(std::move(idle.client));
+      }
+      pool.open -= pool.idle.size();
+      pool.idle.clear();
+      it = pool.open == 0 ? pools_.erase(it) : std::next(it);
+    }
+  }
+  released_.notify_all();
+}
+
+std::unique_ptr<IHttpResponse> HttplibClient::send(
+    const std::string& url, const std::string& scheme_host,
+    const Request& request, const Headers& extra_headers,
+    size_t body_bytes) {
+  TRACE_SPAN("network", "HttplibClient::send");
+  using Clock = std::chrono::steady_clock;
+  // Untimed requests never read the clock
+  const bool timed = options_.metrics != nullptr;
+  const Clock::time_point start = timed ? Clock::now() : Clock::time_point();
+
+  std::shared_ptr<const httplib::Headers> hdrs;
+  bool created = false;
+  auto client = acquire(scheme_host, hdrs, created);
+
+  HttpRequestTiming timing;
+  Clock::time_point acquired;
+  std::optional<Clock::time_point> first_byte;
+  httplib::Progress progress;
+  if (timed) {
+    acquired = Clock::now();
+    progress = [&first_byte](uint64_t, uint64_t) {
+      if (!first_byte) first_byte = Clock::now();
+      return true;
+    };
+  }
+  // Records the timing once the outcome is known
+  auto finish = [&](int status, const httplib::Response* response) {
+    if (!timed) return;
+    const Clock::time_point end = Clock::now();
+    auto us = [](Clock::duration d) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(d);
+    };
+    timing.scheme_host = scheme_host;
+    timing.status = status;
+    timing.new_connection = created;
+    timing.pool_wait = us(acquired - start);
+    if (first_byte) {
+      timing.first_byte = us(*first_byte - acquired);
+      timing.transfer = us(end - *first_byte);
+    }
+    timing.total = us(end - start);
+    timing.bytes_out = body_bytes;
+    for (const auto& [key, value] : *hdrs) {
+      timing.bytes_out += key.size() + value.size() + 4;  // ": ", CRLF
+    }
+    if (response) {
+      timing.bytes_in = response->body.size();
+      for (const auto& [key, value] : response->headers) {
+        timing.bytes_in += key.size() + value.size() + 4;
+      }
+    }
+    options_.metrics->record(timing);
+  };
+
+  httplib::Result result;
+  try {
+    if (!extra_headers.empty()) {
+      // Copy the shared defaults only for requests that add to them
+      auto merged = std::make_shared<httplib::Headers>(*hdrs);
+      for (const auto& [key, value] : extra_headers) {
+        merged->erase(key);
+        merged->emplace(key, value);
+      }
+      hdrs = std::move(merged);
+    }
+    result = request(*client, *hdrs, progress);
+  } catch (...) {
+    release(scheme_host, std::move(client), false);
+    finish(0, nullptr);
+    throw;
+  }
 
   if (!result) {
+    // The connection may be half-open; do not hand it out again
+    release(scheme_host, std::move(client), false);
+    finish(0, nullptr);
     auto err = result.error();
     if (err == httplib::Error::ConnectionTimeout ||
         err == httplib::Error::Timeout) {
@@ -66,53 +244,108 @@ std::unique_ptr<IHttpResponse> HttplibClient::get(const std::string& url,
     }
     throw ConnectionException("Failed to connect: " + url);
   }
+  release(scheme_host, std::move(client), true);
+  finish(result->status, &*result);
 
   if (result->status < 200 || result->status >= 300) {
     throw HttpException(result->status, result->body);
   }
 
-  Headers response_headers;
-  for (const auto& [key, value] : result->headers) {
-    response_headers[key] = value;
+  // Node extraction moves the field names out of the multimap as well
+  auto& fields = result->headers;
+  ResponseHeaders response_headers;
+  response_headers.reserve(fields.size());
+  while (!fields.empty()) {
+    auto node = fields.extract(fields.begin());
+    response_headers.add(std::move(node.key()), std::move(node.mapped()));
   }
 
-  return std::make_unique<HttplibResponse>(result->status, result->body,
-                                           std::move(response_headers));
+  return std::make_unique<HttplibResponse>(
+      result->status, std::move(result->body), std::move(response_headers));
 }
 
-std::unique_ptr<IHttpResponse> HttplibClient::post(
-    const std::string& url, const std::string& body,
-    const std::string& content_type) {
-  auto parsed = parseUrl(url);
-
-  httplib::Client client(parsed.scheme_host);
-  client.set_connection_timeout(connect_timeout_sec_, 0);
-  client.set_read_timeout(read_timeout_sec_, 0);
-
-  auto hdrs = toHttplibHeaders();
+std::unique_ptr<httplib::Client> HttplibClient::acquire(
+    const std::string& scheme_host,
+    std::shared_ptr<const httplib::Headers>& headers, bool& created) {
+  TRACE_SPAN("network", "HttplibClient::acquire");
+  std::vector<std::unique_ptr<httplib::Client>> closed;
+  std::unique_ptr<httplib::Client> client;
+  int connect_timeout_sec = 0;
+  int read_timeout_sec = 0;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    evictIdle(std::chrono::steady_clock::now(), closed);
+
+    // Looked up again on every wake: an emptied pool is erased meanwhile
+    released_.wait(lock, [&] {
+      const auto& pool = pools_[scheme_host];
+      return !pool.idle.empty() ||
+             pool.open < options_.max_connections_per_host;
+    });
+    auto& pool = pools_[scheme_host];
+    if (!pool.idle.empty()) {
+      client = std::move(pool.idle.back().client);
+      pool.idle.pop_back();
+    } else {
+      ++pool.open;
+    }
 
-  auto result = client.Post(parsed.path, hdrs, body, content_type);
+    connect_timeout_sec = connect_timeout_sec_;
+    read_timeout_sec = read_timeout_sec_;
+    headers = default_headers_;
+  }
 
-  if (!result) {
-    auto err = result.error();
-    if (err == httplib::Error::ConnectionTimeout ||
-        err == httplib::Error::Timeout) {
-      throw TimeoutException("Request timed out: " + url);
+  created = !client;
+  if (!client) {
+    try {
+      client = std::make_unique<httplib::Client>(scheme_host);
+    } catch (...) {
+      release(scheme_host, nullptr, false);
+      throw;
     }
-    throw ConnectionException("Failed to connect: " + url);
+    client->set_keep_alive(true);
+    client->set_decompress(options_.accept_compressed);
+    client->set_compress(options_.compress_requests);
   }
+  client->set_connection_timeout(connect_timeout_sec, 0);
+  client->set_read_timeout(read_timeout_sec, 0);
+  return client;
+}
 
-  if (result->status < 200 || result->status >= 300) {
-    throw HttpException(result->status, result->body);
+void HttplibClient::release(const std::string& scheme_host,
+                            std::unique_ptr<httplib::Client> client,
+                            bool reusable) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& pool = pools_[scheme_host];
+    if (reusable && client) {
+      pool.idle.push_back(
+          {std::move(client), std::chrono::steady_clock::now()});
+    } else {
+      --pool.open;
+    }
   }
+  // A dropped client closes its socket here, outside the lock
+  client.reset();
+  released_.notify_all();
+}
 
-  Headers response_headers;
-  for (const auto& [key, value] : result->headers) {
-    response_headers[key] = value;
+void HttplibClient::evictIdle(
+    std::chrono::steady_clock::time_point now,
+    std::vector<std::unique_ptr<httplib::Client>>& closed) {
+  for (auto it = pools_.begin(); it != pools_.end();) {
+    auto& idle = it->second.idle;
+    // Ordered by last use, so the stale ones are at the front
+    auto fresh = idle.begin();
+    while (fresh != idle.end() &&
+           now - fresh->last_used >= options_.idle_timeout) {
+      closed.push_back(std::move(fresh->client));
+      ++fresh;
+    }
+    it->second.open -= static_cast<size_t>(fresh - idle.begin());
+    idle.erase(idle.begin(), fresh);
+    it = it->second.open == 0 ? pools_.erase(it) : std::next(it);
   }
-
-  return std::make_unique<HttplibResponse>(result->status, result->body,
-                                           std::move(response_headers));
 }
 
 HttplibClient::ParsedUrl HttplibClient::parseUrl(const std::string& url) {
@@ -148,12 +381,4 @@ std::string HttplibClient::buildQueryString(const QueryParams& params) {
   return oss.str();
 }
 
-httplib::Headers HttplibClient::toHttplibHeaders() const {
-  httplib::Headers hdrs;
-  for (const auto& [key, value] : default_headers_) {
-    hdrs.emplace(key, value);
-  }
-  return hdrs;
-}
-
 }  // namespace Gateways::Network
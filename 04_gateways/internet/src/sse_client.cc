@@ -0,0 +1,247 @@
+// sse_client.cc
+#include "sse_client.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "httplib.h"
+
+namespace Gateways::Network {
+
+namespace {
+
+constexpr std::string_view kBom = "\xEF\xBB\xBF";
+
+struct StreamUrl {
+  std::string scheme_host;
+  std::string path;
+};
+
+StreamUrl parseStreamUrl(const std::string& url) {
+  auto scheme_end = url.find("://");
+  if (scheme_end == std::string::npos) {
+    throw NetworkException("Invalid URL (missing scheme): " + url);
+  }
+  auto path_start = url.find('/', scheme_end + 3);
+  if (path_start == std::string::npos) {
+    return {url, "/"};
+  }
+  return {url.substr(0, path_start), url.substr(path_start)};
+}
+
+bool retryableStatus(int status) {
+  return status == 408 || status == 429 || status >= 500;
+}
+
+}  // namespace
+
+// ============================================================
+// SseParser
+// ============================================================
+
+SseParser::SseParser(std::string last_event_id)
+    : last_event_id_(std::move(last_event_id)) {}
+
+bool SseParser::feed(std::string_view chunk, const OnEvent& on_event) {
+  if (at_start_ && !chunk.empty()) {
+    // The BOM may itself arrive split
+    const size_t more = std::min(kBom.size() - line_.size(), chunk.size());
+    const std::string head = line_ + std::string(chunk.substr(0, more));
+    if (kBom.compare(0, head.size(), head) == 0) {
+      if (head.size() < kBom.size()) {
+        line_ = head;
+        return true;
+      }
+      chunk.remove_prefix(kBom.size() - line_.size());
+      line_.clear();
+    }
+    at_start_ = false;
+  }
+
+  size_t begin = 0;
+  for (size_t i = 0; i < chunk.size(); ++i) {
+    const char c = chunk[i];
+    if (c != '\r' && c != '\n') {
+      after_cr_ = false;
+      continue;
+    }
+    if (c == '\n' && after_cr_ && i == begin && line_.empty()) {
+      // The LF of a CRLF split from its CR, or right after it
+      after_cr_ = false;
+      begin = i + 1;
+      continue;
+    }
+    after_cr_ = c == '\r';
+    bool keep_going;
+    if (line_.empty()) {
+      keep_going = line(chunk.substr(begin, i - begin), on_event);
+    } else {
+      line_.append(chunk.data() + begin, i - begin);
+      keep_going = line(line_, on_event);
+      line_.clear();
+    }
+    begin = i + 1;
+    if (!keep_going) {
+      return false;
+    }
+  }
+  line_.append(chunk.data() + begin, chunk.size() - begin);
+  return true;
+}
+
+void SseParser::reset() {
+  line_.clear();
+  after_cr_ = false;
+  type_.clear();
+  data_.clear();
+  has_data_ = false;
+}
+
+bool SseParser::line(std::string_view text, const OnEvent& on_event) {
+  if (text.empty()) {
+    // Dispatch; an event without data lines is none
+    const bool had_data = has_data_;
+    SseEvent event;
+    if (had_data) {
+      event.id = last_event_id_;
+      if (!type_.empty()) event.type = std::move(type_);
+      event.data = std::move(data_);
+    }
+    type_.clear();
+    data_.clear();
+    has_data_ = false;
+    return !had_data || on_event(event);
+  }
+  if (text.front() == ':') {
+    return true;  // comment
+  }
+
+  const size_t colon = text.find(':');
+  std::string_view field = text.substr(0, colon);
+  std::string_view value;
+  if (colon != std::string_view::npos) {
+    value = text.substr(colon + 1);
+    if (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+  }
+
+  if (field == "data") {
+    if (has_data_) data_ += '\n';
+    data_.append(value);
+    has_data_ = true;
+  } else if (field == "event") {
+    type_.assign(value);
+  } else if (field == "id") {
+    if (value.find('\0') == std::string_view::npos) {
+      last_event_id_.assign(value);
+    }
+  } else if (field == "retry") {
+    if (!value.empty() && value.size() <= 9 &&
+        std::all_of(value.begin(), value.end(),
+                    [](char c) { return c >= '0' && c <= '9'; })) {
+      retry_ = std::chrono::milliseconds(std::stoll(std::string(value)));
+    }
+  }
+  return true;
+}
+
+// ============================================================
+// SseClient
+// ============================================================
+
+SseClient::SseClient(const SseClientOptions& options) : options_(options) {}
+
+SseClient::~SseClient() { stop(); }
+
+std::string SseClient::stream(const std::string& url, const Headers& headers,
+                              const SseParser::OnEvent& on_event,
+                              const std::string& last_event_id) {
+  const StreamUrl parsed = parseStreamUrl(url);
+  SseParser parser(last_event_id);
+  int failures = 0;  // attempts in a row that delivered nothing
+
+  for (bool first = true; !stopped(); first = false) {
+    if (!first) {
+      const auto base = parser.retry().value_or(options_.reconnect_delay);
+      const auto backoff = base * (int64_t{1} << std::min(failures, 16));
+      const auto delay = std::min(backoff, options_.max_reconnect_delay);
+      if (!waitToReconnect(delay)) break;
+    }
+
+    httplib::Headers hdrs(headers.begin(), headers.end());
+    hdrs.emplace("Accept", "text/event-stream");
+    hdrs.emplace("Cache-Control", "no-cache");
+    if (!parser.lastEventId().empty()) {
+      hdrs.emplace("Last-Event-ID", parser.lastEventId());
+    }
+
+    httplib::Client client(parsed.scheme_host);
+    client.set_keep_alive(false);
+    client.set_connection_timeout(options_.connect_timeout_sec, 0);
+    client.set_read_timeout(options_.read_timeout_sec, 0);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopped_) break;
+      if (!first) ++reconnects_;
+      active_ = &client;
+    }
+
+    int status = 0;
+    bool delivered = false;
+    bool finished = false;  // on_event asked to stop
+    parser.reset();
+    client.Get(
+        parsed.path, hdrs,
+        [&](const httplib::Response& response) {
+          status = response.status;
+          return status == 200;
+        },
+        [&](const char* data, size_t length) {
+          const bool more = parser.feed(
+              std::string_view(data, length), [&](const SseEvent& event) {
+                delivered = true;
+                finished = !on_event(event);
+                return !finished;
+              });
+          return more && !stopped();
+        });
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      active_ = nullptr;
+    }
+
+    if (finished || status == 204) break;
+    if (status != 0 && status != 200 && !retryableStatus(status)) {
+      throw HttpException(status, "Event stream refused: " + url);
+    }
+    failures = delivered ? 0 : failures + 1;
+  }
+  return parser.lastEventId();
+}
+
+void SseClient::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    // Shuts the socket, so a blocked read returns at once
+    if (active_) active_->stop();
+  }
+  stopping_.notify_all();
+}
+
+uint64_t SseClient::reconnects() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return reconnects_;
+}
+
+bool SseClient::stopped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stopped_;
+}
+
+bool SseClient::waitToReconnect(std::chrono::milliseconds delay) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return !stopping_.wait_for(lock, delay, [this] { return stopped_; });
+}
+
+}  // namespace Gateways::Network
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "caching_http_client.h"
+#include "http_fixture.h"
+
+namespace Gateways::Network {
+namespace {
+
+// Answers every request with body "<method> <url>"; urls containing
+// "missing" get a 404 and urls containing "slow" a timeout
+class FakeHttpClient : public IHttpClient {
+ public:
+  void setDefaultHeaders(const Headers&) override {}
+  void setConnectTimeout(int seconds) override { connectTimeout = seconds; }
+  void setReadTimeout(int) override {}
+
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params) override {
+    return get(url, params, {});
+  }
+  std::unique_ptr<IHttpResponse> get(const std::string& url,
+                                     const QueryParams& params,
+                                     const Headers&) override {
+    std::string query;
+    for (const auto& [name, value] : params) {
+      query += " " + name + "=" + value;
+    }
+    return respond("GET " + url + query, url);
+  }
+  std::unique_ptr<IHttpResponse> post(const std::string& url,
+                                      const std::string& body,
+                                      const std::string&) override {
+    return respond("POST " + url + " " + body, url);
+  }
+
+  std::atomic<int> calls{0};
+  int connectTimeout = 0;
+
+ private:
+  std::unique_ptr<IHttpResponse> respond(std::string body,
+                                         const std::string& url) {
+    ++calls;
+    if (url.find("missing") != std::string::npos) {
+      throw HttpException(404, "Not Found");
+    }
+    if (url.find("slow") != std::string::npos) {
+      throw TimeoutException("Timed out");
+    }
+    ResponseHeaders headers;
+    headers.add("Content-Type", "application/json");
+    headers.add("ETag", "\"v1\"");
+    return std::make_unique<CachedHttpResponse>(
+        200, std::make_shared<const std::string>(std::move(body)), headers);
+  }
+};
+
+class HttpFixtureTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string pattern =
+        (std::filesystem::temp_directory_path() / "http_fixture_XXXXXX")
+            .string();
+    ASSERT_NE(mkdtemp(pattern.data()), nullptr);
+    directory = pattern;
+    store = std::make_unique<HttpFixtureStore>(directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory); }
+
+  std::string directory;
+  std::unique_ptr<HttpFixtureStore> store;
+  FakeHttpClient inner;
+};
+
+// ============================================================
+// HttpFixtureStore
+// ============================================================
+
+TEST_F(HttpFixtureTest, LoadReturnsWhatWasSaved) {
+  RecordedResponse response;
+  response.status_code = 201;
+  response.headers.add("X-Id", "7");
+  response.body = std::string("line one\n\nline three\0binary", 28);
+
+  store->save("GET https://example.com/a", response);
+  auto loaded = store->load("GET https://example.com/a");
+
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->status_code, 201);
+  ASSERT_NE(loaded->headers.find("x-id"), nullptr);
+  EXPECT_EQ(*loaded->headers.find("x-id"), "7");
+  EXPECT_EQ(loaded->body, response.body);
+}
+
+TEST_F(HttpFixtureTest, LoadOfUnrecordedKeyIsEmpty) {
+  EXPECT_FALSE(store->load("GET https://example.com/none").has_value());
+}
+
+TEST_F(HttpFixtureTest, KeysDistinguishParamsAndBodies) {
+  EXPECT_NE(HttpFixtureStore::getKey("https://h/p", {{"a", "1"}}),
+            HttpFixtureStore::getKey("https://h/p", {{"a", "2"}}));
+  EXPECT_EQ(HttpFixtureStore::getKey("https://h/p", {{"b", "2"}, {"a", "1"}}),
+            HttpFixtureStore::getKey("https://h/p", {{"a", "1"}, {"b", "2"}}));
+  EXPECT_NE(HttpFixtureStore::postKey("https://h/p", "{}", "application/json"),
+            HttpFixtureStore::postKey("https://h/p", "[]", "application/json"));
+}
+
+TEST_F(HttpFixtureTest, SaveIntoMissingDirectoryThrows) {
+  HttpFixtureStore missing(directory + "/does/not/exist");
+  EXPECT_THROW(missing.save("GET https://h/p", {}), NetworkException);
+}
+
+// ============================================================
+// RecordingHttpClient
+// ============================================================
+
+TEST_F(HttpFixtureTest, RecordingPassesResponsesThroughAndSavesThem) {
+  RecordingHttpClient recording(inner, *store);
+
+  auto response = recording.get("https://h/chart", {{"id", "42"}});
+
+  EXPECT_EQ(response->bodyView(), "GET https://h/chart id=42");
+  auto saved =
+      store->load(HttpFixtureStore::getKey("https://h/chart", {{"id", "42"}}));
+  ASSERT_TRUE(saved.has_value());
+  EXPECT_EQ(saved->status_code, 200);
+  EXPECT_EQ(saved->body, "GET https://h/chart id=42");
+  ASSERT_NE(saved->headers.find("ETag"), nullptr);
+}
+
+TEST_F(HttpFixtureTest, RecordingSavesHttpErrorsAndRethrows) {
+  RecordingHttpClient recording(inner, *store);
+
+  EXPECT_THROW(recording.get("https://h/missing"), HttpException);
+
+  auto saved = store->load(HttpFixtureStore::getKey("https://h/missing", {}));
+  ASSERT_TRUE(saved.has_value());
+  EXPECT_EQ(saved->status_code, 404);
+  EXPECT_EQ(saved->body, "Not Found");
+}
+
+TEST_F(HttpFixtureTest, RecordingDoesNotSaveTimeouts) {
+  RecordingHttpClient recording(inner, *store);
+
+  EXPECT_THROW(recording.get("https://h/slow"), TimeoutException);
+  EXPECT_FALSE(
+      store->load(HttpFixtureStore::getKey("https://h/slow", {})).has_value());
+}
+
+TEST_F(HttpFixtureTest, RecordingForwardsConfiguration) {
+  RecordingHttpClient recording(inner, *store);
+  recording.setConnectTimeout(3);
+  EXPECT_EQ(inner.connectTimeout, 3);
+}
+
+// ============================================================
+// ReplayHttpClient
+// ============================================================
+
+TEST_F(HttpFixtureTest, ReplayServesRecordedExchanges) {
+  RecordingHttpClient recording(inner, *store);
+  recording.get("https://h/chart", {{"id", "42"}});
+  recording.post("https://h/search", "{\"q\":1}");
+
+  ReplayHttpClient replay(*store);
+  auto get = replay.get("https://h/chart", {{"id", "42"}});
+  auto post = replay.post("https://h/search", "{\"q\":1}");
+
+  EXPECT_EQ(get->statusCode(), 200);
+  EXPECT_EQ(get->bodyView(), "GET https://h/chart id=42");
+  EXPECT_EQ(get->header("Content-Type"), "application/json");
+  EXPECT_EQ(post->bodyView(), "POST https://h/search {\"q\":1}");
+  EXPECT_EQ(replay.requests(), 2u);
+  EXPECT_EQ(inner.calls, 2);
+}
+
+TEST_F(HttpFixtureTest, ReplayThrowsRecordedHttpErrors) {
+  RecordingHttpClient recording(inner, *store);
+  EXPECT_THROW(recording.get("https://h/missing"), HttpException);
+
+  ReplayHttpClient replay(*store);
+  try {
+    replay.get("https://h/missing");
+    FAIL() << "expected HttpException";
+  } catch (const HttpException& e) {
+    EXPECT_EQ(e.statusCode(), 404);
+    EXPECT_STREQ(e.what(), "HTTP 404: Not Found");
+  }
+}
+
+TEST_F(HttpFixtureTest, ReplayOfUnrecordedRequestThrows) {
+  ReplayHttpClient replay(*store);
+  EXPECT_THROW(replay.get("https://h/none"), NetworkException);
+}
+
+TEST_F(HttpFixtureTest, ReplayInjectsLatencyAndTransferTime) {
+  store->save(HttpFixtureStore::getKey("https://h/big", {}),
+              {200, {}, std::string(10000, 'x')});
+  ReplayOptions options;
+  options.latency = std::chrono::milliseconds(20);
+  options.bytes_per_second = 500000;  // 10000 bytes: another 20 ms
+  ReplayHttpClient replay(*store, options);
+
+  const auto started = std::chrono::steady_clock::now();
+  replay.get("https://h/big");
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+
+  EXPECT_GE(elapsed, std::chrono::milliseconds(40));
+}
+
+TEST_F(HttpFixtureTest, ReplayOverlapsConcurrentRequestsUpToTheLimit) {
+  store->save(HttpFixtureStore::getKey("https://h/a", {}), {200, {}, "a"});
+  ReplayOptions options;
+  options.latency = std::chrono::milliseconds(50);
+  options.max_concurrency = 2;
+  ReplayHttpClient replay(*store, options);
+
+  const auto started = std::chrono::steady_clock::now();
+  std::vector<std::thread> callers;
+  for (int i = 0; i < 4; ++i) {
+    callers.emplace_back([&] { replay.get("https://h/a"); });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+
+  // Two rounds of two, not four in a row and not all at once
+  EXPECT_GE(elapsed, std::chrono::milliseconds(100));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+  EXPECT_EQ(replay.requests(), 4u);
+}
+
+}  // namespace
+}  // namespace Gateways::Network
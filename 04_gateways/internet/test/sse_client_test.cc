@@ -0,0 +1,102 @@
+#include "sse_client.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace Gateways::Network {
+namespace {
+
+class SseParserTest : public ::testing::Test {
+ protected:
+  // Feeds chunks in order, collecting every event
+  bool feed(const std::vector<std::string>& chunks) {
+    for (const auto& chunk : chunks) {
+      if (!parser.feed(chunk, [&](const SseEvent& event) {
+            events.push_back(event);
+            return events.size() < stopAfter;
+          })) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  SseParser parser;
+  std::vector<SseEvent> events;
+  size_t stopAfter = 1000;
+};
+
+TEST_F(SseParserTest, ParsesFieldsOfAnEvent) {
+  feed({"id: 7\nevent: quote\ndata: {\"p\":1}\n\n"});
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].id, "7");
+  EXPECT_EQ(events[0].type, "quote");
+  EXPECT_EQ(events[0].data, "{\"p\":1}");
+  EXPECT_EQ(parser.lastEventId(), "7");
+}
+
+TEST_F(SseParserTest, JoinsDataLinesAndDefaultsTheType) {
+  feed({"data: one\ndata:two\ndata\n\n"});
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].type, "message");
+  EXPECT_EQ(events[0].data, "one\ntwo\n");
+}
+
+TEST_F(SseParserTest, HandlesEveryLineEndingAndSplitChunks) {
+  feed({"data: a\r", "\n\r", "\ndata: b\rdata: c\r\r", "da", "ta: d\n", "\n"});
+
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].data, "a");
+  EXPECT_EQ(events[1].data, "b\nc");
+  EXPECT_EQ(events[2].data, "d");
+}
+
+TEST_F(SseParserTest, IgnoresCommentsAndEventsWithoutData) {
+  feed({": keep-alive\n\nevent: ping\n\nid: 3\n\ndata: x\n\n"});
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].type, "message");
+  EXPECT_EQ(events[0].id, "3");  // the id outlives its empty event
+}
+
+TEST_F(SseParserTest, SkipsALeadingByteOrderMarkEvenWhenSplit) {
+  feed({"\xEF\xBB", "\xBF" "data: x\n\n"});
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "x");
+}
+
+TEST_F(SseParserTest, ReadsRetryAndIgnoresAMalformedOne) {
+  feed({"retry: 2500\n", "retry: soon\n"});
+  ASSERT_TRUE(parser.retry().has_value());
+  EXPECT_EQ(parser.retry()->count(), 2500);
+}
+
+TEST_F(SseParserTest, StopsWhenTheHandlerReturnsFalse) {
+  stopAfter = 1;
+  EXPECT_FALSE(feed({"data: a\n\ndata: b\n\n"}));
+  EXPECT_EQ(events.size(), 1u);
+}
+
+TEST_F(SseParserTest, ResetDropsThePartialEventButKeepsTheId) {
+  SseParser resumed("41");
+  std::vector<SseEvent> seen;
+  auto collect = [&](const SseEvent& event) {
+    seen.push_back(event);
+    return true;
+  };
+  resumed.feed("id: 42\ndata: torn", collect);
+  resumed.reset();
+  resumed.feed("data: whole\n\n", collect);
+
+  ASSERT_EQ(seen.size(), 1u);
+  EXPECT_EQ(seen[0].data, "whole");
+  EXPECT_EQ(seen[0].id, "42");
+}
+
+}  // namespace
+}  // namespace Gateways::Network
@@ -0,0 +1,33 @@
+// chart_payload.h
+#ifndef REPOSITORIES_NETWORK_BENCHMARK_CHART_PAYLOAD_H_
+#define REPOSITORIES_NETWORK_BENCHMARK_CHART_PAYLOAD_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace Gateways::Repositories::Network {
+
+// Shaped like a dataForInstrument response: some instrument info, the
+// intraday series and count [seconds, price] pairs in history.data
+inline std::string makeChartPayload(int64_t count) {
+  std::string body =
+      R"({"info":{"instrumentId":43763,"name":"Example AG","isin":)"
+      R"("DE0000000000","currency":"EUR"},"series":{"intraday":)"
+      R"({"data":[[1700000000,101.25],[1700000060,101.3]]},)"
+      R"("history":{"data":[)";
+  char pair[64];
+  double price = 100.0;
+  for (int64_t i = 0; i < count; ++i) {
+    price += (i % 7 == 0 ? -0.0375 : 0.025);
+    std::snprintf(pair, sizeof(pair), "%s[%lld,%.4f]", i == 0 ? "" : ",",
+                  static_cast<long long>(1600000000 + i * 60), price);
+    body += pair;
+  }
+  body += "]}}}";
+  return body;
+}
+
+}  // namespace Gateways::Repositories::Network
+
+#endif  // REPOSITORIES_NETWORK_BENCHMARK_CHART_PAYLOAD_H_
@@ -0,0 +1,192 @@
+#include <benchmark/benchmark.h>
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "caching_http_client.h"
+#include "chart_payload.h"
+#include "http_fixture.h"
+#include "httplib_network_connector.h"
+#include "network_data_repository.h"
+
+namespace Gateways::Repositories::Network {
+namespace {
+
+using Gateways::Network::HttpFixtureStore;
+using Gateways::Network::ReplayHttpClient;
+using Gateways::Network::ReplayOptions;
+
+constexpr int kInstruments = 64;
+constexpr int64_t kPointsPerInstrument = 2000;
+
+// ============================================================
+// Fixtures
+// ============================================================
+
+// Serves makeChartPayload() for every instrument, standing in for the
+// live API while the synthetic fixtures are recorded
+class SyntheticChartClient : public Gateways::Network::IHttpClient {
+ public:
+  void setDefaultHeaders(const Gateways::Network::Headers&) override {}
+  void setConnectTimeout(int) override {}
+  void setReadTimeout(int) override {}
+
+  std::unique_ptr<Gateways::Network::IHttpResponse> get(
+      const std::string& url,
+      const Gateways::Network::QueryParams& params) override {
+    return get(url, params, {});
+  }
+  std::unique_ptr<Gateways::Network::IHttpResponse> get(
+      const std::string&, const Gateways::Network::QueryParams&,
+      const Gateways::Network::Headers&) override {
+    return std::make_unique<Gateways::Network::CachedHttpResponse>(
+        200,
+        std::make_shared<const std::string>(
+            makeChartPayload(kPointsPerInstrument)),
+        Gateways::Network::ResponseHeaders{});
+  }
+  std::unique_ptr<Gateways::Network::IHttpResponse> post(
+      const std::string&, const std::string&, const std::string&) override {
+    throw Gateways::Network::NetworkException("Not supported");
+  }
+};
+
+// Instruments recorded into a fixture directory, kept for the whole run
+struct Capture {
+  std::string directory;
+  std::vector<std::string> instrument_ids;
+};
+
+// kInstruments synthetic instruments, recorded once into a temporary
+// directory through LsTcRepository, so the keys are the ones it asks for
+const Capture& syntheticCapture() {
+  static const Capture capture = [] {
+    std::string pattern =
+        (std::filesystem::temp_directory_path() / "lstc_fixture_XXXXXX")
+            .string();
+    if (mkdtemp(pattern.data()) == nullptr) {
+      return Capture{};
+    }
+    Capture recorded{pattern, {}};
+    HttpFixtureStore store(recorded.directory);
+    SyntheticChartClient upstream;
+    Gateways::Network::RecordingHttpClient recording(upstream, store);
+    LsTcRepository repository(recording);
+    for (int i = 0; i < kInstruments; ++i) {
+      recorded.instrument_ids.push_back(std::to_string(40000 + i));
+      repository.fetchTimeSeriesData(recorded.instrument_ids.back());
+    }
+    return recorded;
+  }();
+  // Removes the directory when the benchmarks exit
+  static const struct Cleanup {
+    ~Cleanup() {
+      if (!capture.directory.empty()) {
+        std::filesystem::remove_all(capture.directory);
+      }
+    }
+  } cleanup;
+  return capture;
+}
+
+// LSTC_FIXTURE_DIR with the comma-separated LSTC_INSTRUMENTS. Instruments
+// not recorded there yet are fetched from the live API and recorded
+// first, so the first run captures and later ones replay.
+const Capture& liveCapture() {
+  static const Capture capture = [] {
+    const char* directory = std::getenv("LSTC_FIXTURE_DIR");
+    const char* instruments = std::getenv("LSTC_INSTRUMENTS");
+    if (!directory || !instruments) {
+      return Capture{};
+    }
+    Capture recorded{directory, {}};
+    std::istringstream ids(instruments);
+    for (std::string id; std::getline(ids, id, ',');) {
+      if (!id.empty()) recorded.instrument_ids.push_back(id);
+    }
+
+    HttpFixtureStore store(recorded.directory);
+    Gateways::Network::HttplibClient live;
+    Gateways::Network::RecordingHttpClient recording(live, store);
+    ReplayHttpClient replay(store);
+    LsTcRepository recorder(recording);
+    LsTcRepository replayer(replay);
+    for (const auto& id : recorded.instrument_ids) {
+      try {
+        replayer.fetchTimeSeriesData(id);
+      } catch (const Gateways::Network::NetworkException&) {
+        recorder.fetchTimeSeriesData(id);
+      }
+    }
+    return recorded;
+  }();
+  return capture;
+}
+
+// ============================================================
+// fetchMany() against replayed responses
+// ============================================================
+
+// range(0): max_concurrency; range(1): injected round trip, ms. Wall
+// time, since the workers mostly sleep.
+void fetchReplayed(benchmark::State& state, const Capture& capture) {
+  if (capture.instrument_ids.empty()) {
+    state.SkipWithError("no fixtures recorded");
+    return;
+  }
+  HttpFixtureStore store(capture.directory);
+  ReplayOptions options;
+  options.latency = std::chrono::milliseconds(state.range(1));
+  ReplayHttpClient replay(store, options);
+  LsTcRepository repository(replay);
+
+  size_t points = 0;
+  for (auto _ : state) {
+    points = 0;
+    for (const auto& fetch : repository.fetchMany(
+             capture.instrument_ids, static_cast<size_t>(state.range(0)))) {
+      if (fetch.error) {
+        state.SkipWithError(fetch.error->c_str());
+        return;
+      }
+      points += fetch.points.size();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(capture.instrument_ids.size()));
+  state.counters["points"] = static_cast<double>(points);
+}
+
+void BM_FetchManySynthetic(benchmark::State& state) {
+  fetchReplayed(state, syntheticCapture());
+}
+
+BENCHMARK(BM_FetchManySynthetic)
+    ->ArgNames({"concurrency", "latency_ms"})
+    ->ArgsProduct({{1, 4, 16}, {0, 20}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Skipped unless LSTC_FIXTURE_DIR and LSTC_INSTRUMENTS are set
+void BM_FetchManyCaptured(benchmark::State& state) {
+  fetchReplayed(state, liveCapture());
+}
+
+BENCHMARK(BM_FetchManyCaptured)
+    ->ArgNames({"concurrency", "latency_ms"})
+    ->ArgsProduct({{1, 4, 16}, {0, 20}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace Gateways::Repositories::Network
+
+BENCHMARK_MAIN();
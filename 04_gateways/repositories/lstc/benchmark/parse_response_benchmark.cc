@@ -0,0 +1,130 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chart_payload.h"
+#include "json.hpp"
+#include "network_data_repository.h"
+
+namespace Gateways::Repositories::Network {
+namespace {
+
+// ============================================================
+// Payloads
+// ============================================================
+
+// A response saved from the live API, if LSTC_CHART_PAYLOAD names one
+std::string capturedPayload() {
+  const char* path = std::getenv("LSTC_CHART_PAYLOAD");
+  if (!path) {
+    return "";
+  }
+  std::ifstream in(path, std::ios::binary);
+  std::ostringstream body;
+  body << in.rdbuf();
+  return body.str();
+}
+
+// What parseResponse() did before: a DOM of the whole body, then a sort
+std::vector<Entities::TimeSeriesPoint> parseWithDom(
+    const std::string& instrument_id, const std::string& json_body) {
+  auto json = nlohmann::json::parse(json_body);
+  auto& data = json.at("series").at("history").at("data");
+
+  std::vector<Entities::TimeSeriesPoint> points;
+  points.reserve(data.size());
+  for (const auto& data_point : data) {
+    if (data_point.size() < 2) continue;
+    Entities::TimeSeriesPoint point;
+    point.asset_id = instrument_id;
+    point.timestamp_ms = data_point[0].get<int64_t>() * 1000;
+    point.value = data_point[1].get<double>();
+    points.push_back(std::move(point));
+  }
+  std::sort(points.begin(), points.end(),
+            [](const Entities::TimeSeriesPoint& a,
+               const Entities::TimeSeriesPoint& b) {
+              return a.timestamp_ms < b.timestamp_ms;
+            });
+  return points;
+}
+
+// ============================================================
+// Synthetic payloads: DOM vs SAX
+// ============================================================
+
+void BM_ParseDom(benchmark::State& state) {
+  const std::string body = makeChartPayload(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parseWithDom("43763", body));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(body.size()));
+}
+
+BENCHMARK(BM_ParseDom)
+    ->ArgName("points")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000);
+
+void BM_ParseSax(benchmark::State& state) {
+  const std::string body = makeChartPayload(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LsTcRepository::parseResponse("43763", body));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(body.size()));
+}
+
+BENCHMARK(BM_ParseSax)
+    ->ArgName("points")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000);
+
+// ============================================================
+// Captured payload: DOM vs SAX
+// ============================================================
+
+// Skipped unless LSTC_CHART_PAYLOAD is set
+template <typename Parse>
+void parseCaptured(benchmark::State& state, const Parse& parse) {
+  const std::string body = capturedPayload();
+  if (body.empty()) {
+    state.SkipWithError("LSTC_CHART_PAYLOAD not set or empty");
+    return;
+  }
+  size_t points = 0;
+  for (auto _ : state) {
+    auto parsed = parse("43763", body);
+    points = parsed.size();
+    benchmark::DoNotOptimize(parsed);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(points));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(body.size()));
+}
+
+void BM_ParseCapturedDom(benchmark::State& state) {
+  parseCaptured(state, parseWithDom);
+}
+
+BENCHMARK(BM_ParseCapturedDom);
+
+void BM_ParseCapturedSax(benchmark::State& state) {
+  parseCaptured(state, LsTcRepository::parseResponse);
+}
+
+BENCHMARK(BM_ParseCapturedSax);
+
+}  // namespace
+}  // namespace Gateways::Repositories::Network
+
+BENCHMARK_MAIN();
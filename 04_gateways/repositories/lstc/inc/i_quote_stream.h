@@ -0,0 +1,35 @@
+// i_quote_stream.h
+#ifndef USE_CASES_I_QUOTE_STREAM_H_
+#define USE_CASES_I_QUOTE_STREAM_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+
+namespace UseCases {
+
+// Price updates pushed by a network source as they happen, instead of
+// whole series fetched on request. Gateways implement this interface.
+class IQuoteStream {
+ public:
+  virtual ~IQuoteStream() = default;
+
+  // Blocks, calling on_tick with each update of the instruments (asset
+  // ids, as for INetworkDataRepository) as it arrives, one call at a
+  // time, until on_tick returns false, stop() is called or the source
+  // ends the stream. Reconnects on its own after a drop, resuming where
+  // it left off where the source allows; ticks may still repeat across
+  // a reconnect. Throws if the source refuses the subscription.
+  virtual void stream(
+      const std::vector<std::string>& instrument_ids,
+      const std::function<bool(Entities::TimeSeriesPoint)>& on_tick) = 0;
+
+  // Ends stream(); callable from any thread
+  virtual void stop() = 0;
+};
+
+}  // namespace UseCases
+
+#endif  // USE_CASES_I_QUOTE_STREAM_H_
@@ -2,10 +2,13 @@
 #ifndef REPOSITORIES_NETWORK_DATA_REPOSITORY_H_
 #define REPOSITORIES_NETWORK_DATA_REPOSITORY_H_
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
 #include "entities.h"
+#include "executor.h"
 #include "network_connector.h"
 #ifndef UNIT_TEST
 #include "i_network_data_repository.h"
@@ -18,23 +21,54 @@
 
 namespace Gateways::Repositories::Network {
 
+// fetchMany() calls the client from several threads at once, which
+// HttplibClient allows; its connection pool caps the connections per host.
+// The threads are the caller and workers of the executor, the shared one
+// unless another is given.
+// Behind a ResilientHttpClient, concurrent fetches of one instrument share
+// a request and throttled ones are retried.
 class LsTcRepository USE_CASE {
  public:
-  explicit LsTcRepository(Gateways::Network::IHttpClient& client);
+  explicit LsTcRepository(
+      Gateways::Network::IHttpClient& client,
+      Concurrency::Executor& executor = Concurrency::Executor::shared());
 
   std::vector<Entities::TimeSeriesPoint> fetchTimeSeriesData(
       const std::string& instrument_id) OVERRIDE;
 
+  // The caller and up to max_concurrency - 1 executor workers fetch and
+  // parse; on_result runs on them, serialized. Throws
+  // std::invalid_argument if max_concurrency is 0. If on_result throws,
+  // no further fetches start and the first exception is rethrown once
+  // the others have stopped.
+  void fetchMany(
+      const std::vector<std::string>& instrument_ids, size_t max_concurrency,
+      const std::function<void(Entities::InstrumentFetch)>& on_result)
+      OVERRIDE;
+  std::vector<Entities::InstrumentFetch> fetchMany(
+      const std::vector<std::string>& instrument_ids,
+      size_t max_concurrency) OVERRIDE;
+
+  // Points of series.history.data, sorted by timestamp. A SAX pass
+  // collects the [timestamp, price] pairs as they stream by, without
+  // building a DOM of the body; the sort is skipped when the pairs
+  // arrive in order, as upstream sends them. Pairs with fewer than two
+  // elements are skipped. Throws on malformed JSON, a missing array or a
+  // pair whose first two elements are not numbers.
+  static std::vector<Entities::TimeSeriesPoint> parseResponse(
+      const std::string& instrument_id, const std::string& json_body);
+  // The same points in the compact form: the instrument id once, and no
+  // allocation per point
+  static Entities::CompactSeries parseCompactResponse(
+      const std::string& instrument_id, const std::string& json_body);
+
  private:
   // Build query params for the ls-tc.de API
   Gateways::Network::QueryParams buildQueryParams(
       const std::string& instrument_id) const;
 
-  // Parse JSON response body into entities
-  std::vector<Entities::TimeSeriesPoint> parseResponse(
-      const std::string& instrument_id, const std::string& json_body) const;
-
   Gateways::Network::IHttpClient& m_client;
+  Concurrency::Executor& m_executor;
 
   static constexpr const char* kBaseUrl =
       "https://www.ls-tc.de/_rpc/json/instrument/chart/dataForInstrument";
@@ -0,0 +1,68 @@
+// quote_stream.h
+#ifndef REPOSITORIES_QUOTE_STREAM_H_
+#define REPOSITORIES_QUOTE_STREAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+#include "sse_client.h"
+#ifndef UNIT_TEST
+#include "i_quote_stream.h"
+#define STREAM_OVERRIDE override
+#define STREAM_USE_CASE : public UseCases::IQuoteStream
+#else
+#define STREAM_OVERRIDE
+#define STREAM_USE_CASE
+#endif
+
+namespace Gateways::Repositories::Network {
+
+struct LsTcQuoteStreamOptions {
+  // Server-sent event endpoint pushing ls-tc quotes; required
+  std::string url;
+  Gateways::Network::SseClientOptions sse;
+};
+
+// Push counterpart of LsTcRepository: one event stream carries every
+// subscribed instrument's ticks, so an update costs a few dozen bytes
+// instead of a poll re-sending the whole intraday series. Instruments
+// go in the instrumentIds query parameter, comma-separated, with the
+// ids LsTcRepository takes. Each "quote" (or untyped) event's data is
+//
+//   {"instrumentId": "43763", "time": 1700000000123, "price": 101.25}
+//
+// with time in Unix milliseconds. The last event id is kept across
+// stream() calls, so a restarted stream resumes too. Malformed events
+// are skipped and counted.
+class LsTcQuoteStream STREAM_USE_CASE {
+ public:
+  // Throws std::invalid_argument if options.url is empty
+  explicit LsTcQuoteStream(const LsTcQuoteStreamOptions& options);
+
+  void stream(const std::vector<std::string>& instrument_ids,
+              const std::function<bool(Entities::TimeSeriesPoint)>& on_tick)
+      STREAM_OVERRIDE;
+  void stop() STREAM_OVERRIDE;
+
+  // nullopt unless data is a tick as above
+  static std::optional<Entities::TimeSeriesPoint> parseTick(
+      const std::string& data);
+
+  uint64_t malformed() const { return m_malformed; }
+  uint64_t reconnects() const { return m_client.reconnects(); }
+
+ private:
+  const std::string m_url;
+  Gateways::Network::SseClient m_client;
+  std::string m_lastEventId;
+  std::atomic<uint64_t> m_malformed{0};
+};
+
+}  // namespace Gateways::Repositories::Network
+
+#endif  // REPOSITORIES_QUOTE_STREAM_H_
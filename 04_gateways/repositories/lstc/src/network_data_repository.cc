@@ -2,14 +2,191 @@
 #include "network_data_repository.h"
 
 #include <algorithm>
+#include <array>
+#include <exception>
+#include <map>
+#include <mutex>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
 
 #include "json.hpp"
+#include "tracing.h"
 
 namespace Gateways::Repositories::Network {
 
-LsTcRepository::LsTcRepository(Gateways::Network::IHttpClient& client)
-    : m_client(client) {
+namespace {
+
+// "[1700000000,123.4567]," - reserving by it avoids most regrowth without
+// holding much more than the series needs
+constexpr size_t kTypicalPairBytes = 22;
+
+// One parsed pair as either point type. The API sends no unit.
+void appendPoint(std::vector<Entities::TimeSeriesPoint>& points,
+                 const std::string& instrument_id, int64_t timestamp_ms,
+                 double value) {
+  points.push_back({instrument_id, timestamp_ms, "", value});
+}
+
+void appendPoint(std::vector<Entities::CompactPoint>& points,
+                 const std::string&, int64_t timestamp_ms, double value) {
+  points.push_back({timestamp_ms, value, {}});
+}
+
+// SAX handler collecting the [timestamp, price] pairs of the root's
+// series.history.data array into Points. Depth counts the open
+// containers; the path depth is how far down series -> history -> data
+// the open objects follow. The rest of the document is still read, so a
+// truncated body fails as it did with the DOM.
+template <typename Point>
+class ChartDataHandler : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  ChartDataHandler(const std::string& instrument_id,
+                   std::vector<Point>& points)
+      : m_instrumentId(instrument_id), m_points(points) {}
+
+  // The first data array only; a repeated key is ignored
+  bool found() const { return m_dataDepth != 0; }
+  bool sorted() const { return m_sorted; }
+
+  bool null() override { return other(); }
+  bool boolean(bool) override { return other(); }
+  bool number_integer(number_integer_t value) override {
+    return number(static_cast<int64_t>(value), static_cast<double>(value));
+  }
+  bool number_unsigned(number_unsigned_t value) override {
+    return number(static_cast<int64_t>(value), static_cast<double>(value));
+  }
+  bool number_float(number_float_t value, const string_t&) override {
+    return number(static_cast<int64_t>(value), value);
+  }
+  bool string(string_t&) override { return other(); }
+  bool binary(binary_t&) override { return other(); }
+
+  bool start_object(size_t) override { return open(false); }
+  bool key(string_t& key) override {
+    m_keyOnPath = m_pathDepth == m_depth && m_depth <= kPath.size() &&
+                  key == kPath[m_depth - 1];
+    return true;
+  }
+  bool end_object() override { return close(); }
+  bool start_array(size_t) override { return open(true); }
+  bool end_array() override { return close(); }
+
+  bool parse_error(size_t, const std::string&,
+                   const nlohmann::detail::exception& e) override {
+    throw std::runtime_error(e.what());
+  }
+
+ private:
+  static constexpr std::array<std::string_view, 3> kPath = {
+      "series", "history", "data"};
+
+  bool inPair() const { return m_inPair && m_depth == m_dataDepth + 1; }
+
+  // A scalar other than a number: fine anywhere but in a pair's first two
+  bool other() {
+    if (inPair() && m_field++ < 2) {
+      throw std::runtime_error("Data point is not [timestamp, price]");
+    }
+    return true;
+  }
+
+  bool number(int64_t as_integer, double as_double) {
+    if (inPair()) {
+      if (m_field == 0) {
+        m_timestamp = as_integer;
+      } else if (m_field == 1) {
+        m_value = as_double;
+      }
+      ++m_field;
+    }
+    return true;
+  }
+
+  bool open(bool array) {
+    if (m_depth == 0) {
+      m_pathDepth = array ? 0 : 1;
+    } else if (m_keyOnPath && m_pathDepth == m_depth) {
+      m_keyOnPath = false;
+      if (!array && m_depth < kPath.size()) {
+        m_pathDepth = m_depth + 1;
+      } else if (array && m_depth == kPath.size() && m_dataDepth == 0) {
+        m_dataDepth = m_depth + 1;
+        m_inData = true;
+      }
+    } else if (m_inData && m_depth == m_dataDepth) {
+      m_inPair = array;
+      m_field = 0;
+    } else {
+      other();
+    }
+    ++m_depth;
+    return true;
+  }
+
+  bool close() {
+    if (inPair()) {
+      m_inPair = false;
+      if (m_field >= 2) {
+        const int64_t timestamp_ms = m_timestamp * 1000;  // s -> ms
+        if (!m_points.empty() && timestamp_ms < m_points.back().timestamp_ms) {
+          m_sorted = false;
+        }
+        appendPoint(m_points, m_instrumentId, timestamp_ms, m_value);
+      }
+    } else if (m_inData && m_depth == m_dataDepth) {
+      m_inData = false;
+    }
+    if (m_pathDepth == m_depth) {
+      --m_pathDepth;
+    }
+    --m_depth;
+    return true;
+  }
+
+  const std::string& m_instrumentId;
+  std::vector<Point>& m_points;
+
+  size_t m_depth = 0;
+  size_t m_pathDepth = 0;
+  bool m_keyOnPath = false;
+  size_t m_dataDepth = 0;  // 0 until the data array opens
+  bool m_inData = false;
+
+  bool m_inPair = false;
+  size_t m_field = 0;  // elements of the pair so far
+  int64_t m_timestamp = 0;
+  double m_value = 0.0;
+  bool m_sorted = true;
+};
+
+template <typename Point>
+std::vector<Point> parsePoints(const std::string& instrument_id,
+                               const std::string& json_body) {
+  std::vector<Point> points;
+  points.reserve(json_body.size() / kTypicalPairBytes);
+
+  ChartDataHandler<Point> handler(instrument_id, points);
+  nlohmann::json::sax_parse(json_body, &handler);
+  if (!handler.found()) {
+    throw std::runtime_error("Response has no series.history.data");
+  }
+
+  if (!handler.sorted()) {
+    std::sort(points.begin(), points.end(),
+              [](const Point& a, const Point& b) {
+                return a.timestamp_ms < b.timestamp_ms;
+              });
+  }
+  return points;
+}
+
+}  // namespace
+
+LsTcRepository::LsTcRepository(Gateways::Network::IHttpClient& client,
+                               Concurrency::Executor& executor)
+    : m_client(client), m_executor(executor) {
   m_client.setDefaultHeaders({
       {"User-Agent",
        "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36"},
@@ -22,11 +199,12 @@ LsTcRepository::LsTcRepository(Gateways::Network::IHttpClient& client)
 
 std::vector<Entities::TimeSeriesPoint> LsTcRepository::fetchTimeSeriesData(
     const std::string& instrument_id) {
+  TRACE_SPAN("network", "LsTcRepository::fetchTimeSeriesData");
   auto params = buildQueryParams(instrument_id);
 
   try {
     auto response = m_client.get(kBaseUrl, params);
-    return parseResponse(instrument_id, response->body());
+    return parseResponse(instrument_id, response->takeBody());
   } catch (const Gateways::Network::NetworkException&) {
     throw;  // Let network exceptions propagate as-is
   } catch (const std::exception& e) {
@@ -36,6 +214,59 @@ std::vector<Entities::TimeSeriesPoint> LsTcRepository::fetchTimeSeriesData(
   }
 }
 
+void LsTcRepository::fetchMany(
+    const std::vector<std::string>& instrument_ids, size_t max_concurrency,
+    const std::function<void(Entities::InstrumentFetch)>& on_result) {
+  TRACE_SPAN("network", "LsTcRepository::fetchMany");
+  if (max_concurrency == 0) {
+    throw std::invalid_argument("max_concurrency must be positive");
+  }
+
+  std::mutex result_mutex;
+  bool failed = false;  // under result_mutex
+
+  // A failed fetch is a result; only on_result's exceptions stop the loop
+  auto fetch_one = [&](size_t i) {
+    Entities::InstrumentFetch fetch;
+    fetch.instrument_id = instrument_ids[i];
+    try {
+      fetch.points = fetchTimeSeriesData(fetch.instrument_id);
+    } catch (const std::exception& e) {
+      fetch.error = e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(result_mutex);
+    if (failed) {
+      return;  // fetched while on_result threw
+    }
+    try {
+      on_result(std::move(fetch));
+    } catch (...) {
+      failed = true;
+      throw;
+    }
+  };
+  m_executor.parallelFor(instrument_ids.size(), max_concurrency, fetch_one);
+}
+
+std::vector<Entities::InstrumentFetch> LsTcRepository::fetchMany(
+    const std::vector<std::string>& instrument_ids, size_t max_concurrency) {
+  std::vector<Entities::InstrumentFetch> results(instrument_ids.size());
+  // Ids may repeat, so each result goes to the next slot of its id
+  std::multimap<std::string, size_t> slots;
+  for (size_t i = 0; i < instrument_ids.size(); ++i) {
+    slots.emplace(instrument_ids[i], i);
+  }
+  fetchMany(instrument_ids, max_concurrency,
+            [&](Entities::InstrumentFetch fetch) {
+              auto it = slots.find(fetch.instrument_id);
+              const size_t slot = it->second;
+              slots.erase(it);
+              results[slot] = std::move(fetch);
+            });
+  return results;
+}
+
 Gateways::Network::QueryParams LsTcRepository::buildQueryParams(
     const std::string& instrument_id) const {
   return {
@@ -46,34 +277,16 @@ Gateways::Network::QueryParams LsTcRepository::buildQueryParams(
 }
 
 std::vector<Entities::TimeSeriesPoint> LsTcRepository::parseResponse(
-    const std::string& instrument_id, const std::string& json_body) const {
-  auto json = nlohmann::json::parse(json_body);
-
-  auto& data = json.at("series").at("history").at("data");
-
-  std::vector<Entities::TimeSeriesPoint> points;
-  points.reserve(data.size());
-
-  for (const auto& data_point : data) {
-    // Each data_point is [timestamp, price]
-    if (data_point.size() < 2) continue;
-
-    Entities::TimeSeriesPoint point;
-    point.asset_id = instrument_id;
-    point.timestamp_ms = data_point[0].get<int64_t>() * 1000;  // s -> ms
-    point.unit_id = "";  // Not provided by this API
-    point.value = data_point[1].get<double>();
-
-    points.push_back(std::move(point));
-  }
-
-  std::sort(points.begin(), points.end(),
-            [](const Entities::TimeSeriesPoint& a,
-               const Entities::TimeSeriesPoint& b) {
-              return a.timestamp_ms < b.timestamp_ms;
-            });
+    const std::string& instrument_id, const std::string& json_body) {
+  TRACE_SPAN("network", "LsTcRepository::parseResponse");
+  return parsePoints<Entities::TimeSeriesPoint>(instrument_id, json_body);
+}
 
-  return points;
+Entities::CompactSeries LsTcRepository::parseCompactResponse(
+    const std::string& instrument_id, const std::string& json_body) {
+  TRACE_SPAN("network", "LsTcRepository::parseCompactResponse");
+  return {instrument_id,
+          parsePoints<Entities::CompactPoint>(instrument_id, json_body)};
 }
 
 }  // namespace Gateways::Repositories::Network
@@ -0,0 +1,74 @@
+// quote_stream.cc
+#include "quote_stream.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "json.hpp"
+
+namespace Gateways::Repositories::Network {
+
+LsTcQuoteStream::LsTcQuoteStream(const LsTcQuoteStreamOptions& options)
+    : m_url(options.url), m_client(options.sse) {
+  if (m_url.empty()) {
+    throw std::invalid_argument("LsTcQuoteStream needs a url");
+  }
+}
+
+void LsTcQuoteStream::stream(
+    const std::vector<std::string>& instrument_ids,
+    const std::function<bool(Entities::TimeSeriesPoint)>& on_tick) {
+  std::string url = m_url;
+  url += m_url.find('?') == std::string::npos ? '?' : '&';
+  url += "instrumentIds=";
+  for (size_t i = 0; i < instrument_ids.size(); ++i) {
+    if (i > 0) url += ',';
+    url += instrument_ids[i];
+  }
+
+  m_lastEventId = m_client.stream(
+      url, {},
+      [&](const Gateways::Network::SseEvent& event) {
+        if (event.type != "quote" && event.type != "message") {
+          return true;
+        }
+        auto tick = parseTick(event.data);
+        if (!tick) {
+          ++m_malformed;
+          return true;
+        }
+        return on_tick(std::move(*tick));
+      },
+      m_lastEventId);
+}
+
+void LsTcQuoteStream::stop() { m_client.stop(); }
+
+std::optional<Entities::TimeSeriesPoint> LsTcQuoteStream::parseTick(
+    const std::string& data) {
+  const auto json = nlohmann::json::parse(data, nullptr, false);
+  if (json.is_discarded() || !json.is_object()) {
+    return std::nullopt;
+  }
+  auto id = json.find("instrumentId");
+  auto time = json.find("time");
+  auto price = json.find("price");
+  if (id == json.end() || time == json.end() || price == json.end() ||
+      !time->is_number_integer() || !price->is_number()) {
+    return std::nullopt;
+  }
+
+  Entities::TimeSeriesPoint point;
+  if (id->is_string()) {
+    point.asset_id = id->get<std::string>();
+  } else if (id->is_number_integer()) {
+    point.asset_id = std::to_string(id->get<int64_t>());
+  } else {
+    return std::nullopt;
+  }
+  point.timestamp_ms = time->get<int64_t>();
+  point.value = price->get<double>();
+  return point;
+}
+
+}  // namespace Gateways::Repositories::Network
@@ -22,6 +22,10 @@ DEST_NET_PATH="${DEST_PARENT_DIR}/network"
 I_HPP_PATH="${SCRIPT_DIR}/../../internet/inc/network_connector.h"
 C_HPP_PATH="${SCRIPT_DIR}/../../internet/inc/httplib_network_connector.h"
 C_CPP_PATH="${SCRIPT_DIR}/../../internet/src/httplib_network_connector.cc"
+# Trace spans, used by the repository and the connector
+T_HPP_PATH="${SCRIPT_DIR}/../../../06_tracing/inc/tracing.h"
+# The executor fetchMany() runs on
+E_HPP_PATH="${SCRIPT_DIR}/../../../07_executor/inc/executor.h"
 
 # -----------------------------------------------------------------------------
 # Setup & Cleanup
@@ -42,6 +46,8 @@ echo "📂 Copying required header files..."
 cp -r "${I_HPP_PATH}" "${DEST_PARENT_DIR}/"
 cp -r "${C_HPP_PATH}" "${DEST_PARENT_DIR}/"
 cp -r "${C_CPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${T_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${E_HPP_PATH}" "${DEST_PARENT_DIR}/"
 
 # 3. Cleanup: Define function to remove the folder on exit
 cleanup() {
@@ -50,6 +56,8 @@ cleanup() {
     rm -rf "${DEST_PARENT_DIR}/network_connector.h"
     rm -rf "${DEST_PARENT_DIR}/httplib_network_connector.h"
     rm -rf "${DEST_PARENT_DIR}/httplib_network_connector.cc"
+    rm -rf "${DEST_PARENT_DIR}/tracing.h"
+    rm -rf "${DEST_PARENT_DIR}/executor.h"
 }
 
 # Register the trap to run on EXIT (happens on success, error, or interrupt)
@@ -0,0 +1,49 @@
+#include "quote_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace Gateways::Repositories::Network {
+namespace {
+
+TEST(LsTcQuoteStreamTest, ParsesATick) {
+  auto tick = LsTcQuoteStream::parseTick(
+      R"({"instrumentId":"43763","time":1700000000123,"price":101.25})");
+
+  ASSERT_TRUE(tick.has_value());
+  EXPECT_EQ(tick->asset_id, "43763");
+  EXPECT_EQ(tick->timestamp_ms, 1700000000123);
+  EXPECT_DOUBLE_EQ(tick->value, 101.25);
+}
+
+TEST(LsTcQuoteStreamTest, AcceptsNumericIdsAndIntegerPrices) {
+  auto tick = LsTcQuoteStream::parseTick(
+      R"({"instrumentId":43763,"time":1700000000000,"price":101})");
+
+  ASSERT_TRUE(tick.has_value());
+  EXPECT_EQ(tick->asset_id, "43763");
+  EXPECT_DOUBLE_EQ(tick->value, 101.0);
+}
+
+TEST(LsTcQuoteStreamTest, RejectsMalformedTicks) {
+  EXPECT_FALSE(LsTcQuoteStream::parseTick("not json").has_value());
+  EXPECT_FALSE(LsTcQuoteStream::parseTick("[1,2]").has_value());
+  EXPECT_FALSE(
+      LsTcQuoteStream::parseTick(R"({"instrumentId":"1","time":5})")
+          .has_value());
+  EXPECT_FALSE(LsTcQuoteStream::parseTick(
+                   R"({"instrumentId":"1","time":"5","price":1.0})")
+                   .has_value());
+  EXPECT_FALSE(LsTcQuoteStream::parseTick(
+                   R"({"instrumentId":null,"time":5,"price":1.0})")
+                   .has_value());
+}
+
+TEST(LsTcQuoteStreamTest, RequiresAUrl) {
+  EXPECT_THROW(LsTcQuoteStream(LsTcQuoteStreamOptions{}),
+               std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Network
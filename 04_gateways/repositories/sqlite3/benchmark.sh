@@ -0,0 +1,106 @@
+#!/bin/bash
+# =============================================================================
+# benchmark.sh - Build and run the benchmarks, results as JSON
+#
+# Writes build-bench/benchmarks.json; extra arguments go to the benchmark
+# binary, e.g. ./benchmark.sh --benchmark_filter=BM_AddPoints
+# =============================================================================
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+IMAGE_NAME="gtest-dev:latest"
+
+# -----------------------------------------------------------------------------
+# Configuration
+# -----------------------------------------------------------------------------
+
+# Resolve absolute path for source to prevent relative path errors
+SOURCE_DB_PATH="${SCRIPT_DIR}/../../../90_vendored/database/sqlite3"
+
+# Destination relative to where the script is executed (CWD)
+# This matches the Docker volume mount logic (-v $(pwd):/project)
+DEST_PARENT_DIR="./integration"
+DEST_DB_PATH="${DEST_PARENT_DIR}/sqlite3"
+
+# Resolve absolute path for Interface Contracts
+I_HPP_PATH="${SCRIPT_DIR}/../../database/inc/database_connector.h"
+C_HPP_PATH="${SCRIPT_DIR}/../../database/inc/sqlite3_database_connector.h"
+C_CPP_PATH="${SCRIPT_DIR}/../../database/src/sqlite3_database_connector.cc"
+# The connection pool the repositories share
+P_HPP_PATH="${SCRIPT_DIR}/../../database/inc/sqlite3_pool.h"
+P_CPP_PATH="${SCRIPT_DIR}/../../database/src/sqlite3_pool.cc"
+# Trace spans, used by the repository and the connector
+T_HPP_PATH="${SCRIPT_DIR}/../../../06_tracing/inc/tracing.h"
+# The executor getPointsMulti() reads on
+E_HPP_PATH="${SCRIPT_DIR}/../../../07_executor/inc/executor.h"
+# The ring buffer behind the indicator windows
+R_HPP_PATH="${SCRIPT_DIR}/../../../09_ring_buffer/inc/ring_buffer.h"
+
+# -----------------------------------------------------------------------------
+# Setup & Cleanup
+# -----------------------------------------------------------------------------
+
+# 1. Validation: Ensure source exists
+if [[ ! -d "${SOURCE_DB_PATH}" ]]; then
+    echo "Error: Source database not found at: ${SOURCE_DB_PATH}"
+    exit 1
+fi
+
+# 2.a Setup: Copy folder
+echo "📂 Copying database to integration folder..."
+cp -r "${SOURCE_DB_PATH}" "${DEST_PARENT_DIR}/"
+
+# 2.b Setup: Copy interface contracts
+echo "📂 Copying required header files..."
+cp -r "${I_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${C_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${C_CPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${P_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${P_CPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${T_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${E_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${R_HPP_PATH}" "${DEST_PARENT_DIR}/"
+
+# 3. Cleanup: Define function to remove the folder on exit
+cleanup() {
+    echo "🧹 Cleaning up integration artifacts..."
+    rm -rf "${DEST_DB_PATH}"
+    rm -rf "${DEST_DB_PATH}"
+    rm -rf "${DEST_PARENT_DIR}/database_connector.h"
+    rm -rf "${DEST_PARENT_DIR}/sqlite3_database_connector.h"
+    rm -rf "${DEST_PARENT_DIR}/sqlite3_database_connector.cc"
+    rm -rf "${DEST_PARENT_DIR}/sqlite3_pool.h"
+    rm -rf "${DEST_PARENT_DIR}/sqlite3_pool.cc"
+    rm -rf "${DEST_PARENT_DIR}/tracing.h"
+    rm -rf "${DEST_PARENT_DIR}/executor.h"
+    rm -rf "${DEST_PARENT_DIR}/ring_buffer.h"
+}
+
+# Register the trap to run on EXIT (happens on success, error, or interrupt)
+trap cleanup EXIT
+
+# -----------------------------------------------------------------------------
+# Main Execution
+# -----------------------------------------------------------------------------
+
+# Build image if it doesn't exist
+if [[ "$(docker images -q ${IMAGE_NAME} 2> /dev/null)" == "" ]]; then
+    echo "Image not found. Building..."
+    "${SCRIPT_DIR}/build.sh"
+fi
+
+echo "Running benchmarks..."
+docker run --rm \
+    -v "$(pwd):/project" \
+    -w /project \
+    "${IMAGE_NAME}" \
+    bash -c "
+        mkdir -p build-bench &&
+        cd build-bench &&
+        cmake .. -DCMAKE_BUILD_TYPE=Release -DENABLE_TESTING=OFF \\
+            -DENABLE_COVERAGE=OFF -DENABLE_BENCHMARKS=ON &&
+        make -j\$(nproc) sqlite3_repo_benchmarks &&
+        ./sqlite3_repo_benchmarks --benchmark_out=benchmarks.json \\
+            --benchmark_out_format=json $*
+    "
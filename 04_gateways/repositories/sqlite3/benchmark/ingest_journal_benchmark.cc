@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "ingest_journal.h"
+#include "sqlite3_database_connector.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+// A fresh directory, removed with the object
+class ScratchDirectory {
+ public:
+  explicit ScratchDirectory(const std::string& name)
+      : m_path(std::filesystem::temp_directory_path() / name) {
+    std::filesystem::remove_all(m_path);
+    std::filesystem::create_directories(m_path);
+  }
+  ~ScratchDirectory() { std::filesystem::remove_all(m_path); }
+
+  std::string path(const std::string& name = "") const {
+    return (m_path / name).string();
+  }
+
+ private:
+  std::filesystem::path m_path;
+};
+
+std::vector<Entities::TimeSeriesPoint> makeTicks(int64_t first_ms,
+                                                 int64_t count) {
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < count; ++i) {
+    points.push_back({"a0", first_ms + i, "USD", 100.0 + i % 97});
+  }
+  return points;
+}
+
+// ============================================================
+// Acknowledging a batch: journal append against addPoints()
+// ============================================================
+
+// range(0): points per call; range(1): JournalSync
+void BM_JournalAppend(benchmark::State& state) {
+  ScratchDirectory dir("bench_ingest_journal");
+  JournalOptions options;
+  options.sync = static_cast<JournalSync>(state.range(1));
+  IngestJournal journal(dir.path(), options);
+
+  int64_t next_ms = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    const auto points = makeTicks(next_ms, state.range(0));
+    next_ms += state.range(0);
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(journal.append(points));
+    if (next_ms % (1 << 20) < state.range(0)) {
+      state.PauseTiming();
+      journal.release(journal.end());  // keep the disk use bounded
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The same batches written straight to a database file
+void BM_DatabaseAppend(benchmark::State& state) {
+  ScratchDirectory dir("bench_ingest_database");
+  Gateways::Database::SqliteDatabase db(dir.path("ticks.db"));
+  TimeSeriesRepository repo(db);
+  repo.initSchema();
+  repo.createUnit({"USD", "$", "US Dollar"});
+  repo.createAsset({"a0", "Asset", "", ""});
+
+  int64_t next_ms = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    const auto points = makeTicks(next_ms, state.range(0));
+    next_ms += state.range(0);
+    state.ResumeTiming();
+
+    repo.addPoints(points);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_JournalAppend)
+    ->ArgNames({"points", "sync"})
+    ->ArgsProduct({{1, 100},
+                   {static_cast<int64_t>(JournalSync::None),
+                    static_cast<int64_t>(JournalSync::Periodic),
+                    static_cast<int64_t>(JournalSync::EveryAppend)}});
+BENCHMARK(BM_DatabaseAppend)->ArgName("points")->Arg(1)->Arg(100);
+
+// ============================================================
+// Applying: journal to database in large batches
+// ============================================================
+
+// range(0): points in the journal, applied in 50000-point transactions
+void BM_JournalApply(benchmark::State& state) {
+  ScratchDirectory dir("bench_ingest_apply");
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::filesystem::remove_all(dir.path("journal"));
+    std::filesystem::remove(dir.path("ticks.db"));
+    Gateways::Database::SqliteDatabase db(dir.path("ticks.db"));
+    TimeSeriesRepository repo(db);
+    repo.initSchema();
+    repo.createUnit({"USD", "$", "US Dollar"});
+    repo.createAsset({"a0", "Asset", "", ""});
+    JournalOptions options;
+    options.sync = JournalSync::None;
+    IngestJournal journal(dir.path("journal"), options);
+    for (int64_t ms = 0; ms < state.range(0); ms += 100) {
+      journal.append(makeTicks(ms, 100));
+    }
+    IngestJournalApplier applier(db, repo, journal);
+    applier.initSchema();
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(applier.applyPending());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_JournalApply)->ArgName("points")->Arg(100000);
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
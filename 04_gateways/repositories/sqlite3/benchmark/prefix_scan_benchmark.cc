@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "account_repository.h"
+#include "keyvalue_repository.h"
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+// 10 keys per group, so every prefix scan returns k = 10 rows whatever N
+std::string groupKey(int64_t group, int64_t item) {
+  char key[32];
+  std::snprintf(key, sizeof(key), "group.%06lld.%02lld",
+                static_cast<long long>(group), static_cast<long long>(item));
+  return key;
+}
+
+std::string groupPrefix(int64_t group) {
+  char prefix[32];
+  std::snprintf(prefix, sizeof(prefix), "group.%06lld.",
+                static_cast<long long>(group));
+  return prefix;
+}
+
+void fillSettings(Gateways::Database::IDatabase& db, int64_t count) {
+  db.beginTransaction();
+  auto stmt =
+      db.prepare("INSERT INTO settings (key, value) VALUES (?, 'value')");
+  for (int64_t i = 0; i < count; ++i) {
+    stmt->reset();
+    stmt->bind(1, groupKey(i / 10, i % 10));
+    stmt->executeInsert();
+  }
+  db.commit();
+}
+
+// ============================================================
+// Settings: LIKE pattern vs key range
+// ============================================================
+
+// The query getByPrefix() ran before: LIKE cannot use the key index
+// under the default case-insensitive LIKE, so it visits all N rows
+void BM_SettingsPrefixLike(benchmark::State& state) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  KeyValueRepository repo(db);
+  repo.initSchema();
+  fillSettings(db, state.range(0));
+  const int64_t groups = state.range(0) / 10;
+
+  int64_t group = 0;
+  for (auto _ : state) {
+    auto stmt = db.prepare(
+        "SELECT key, value, description FROM settings "
+        "WHERE key LIKE ? ORDER BY key");
+    stmt->bind(1, groupPrefix(group++ % groups) + "%");
+    benchmark::DoNotOptimize(stmt->execute());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// O(log N + k): a seek on the key index, then the matching rows
+void BM_SettingsPrefixRange(benchmark::State& state) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  KeyValueRepository repo(db);
+  repo.initSchema();
+  fillSettings(db, state.range(0));
+  const int64_t groups = state.range(0) / 10;
+
+  int64_t group = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(repo.getByPrefix(groupPrefix(group++ % groups)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SettingsPrefixLike)
+    ->ArgName("keys")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000);
+BENCHMARK(BM_SettingsPrefixRange)
+    ->ArgName("keys")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000);
+
+// ============================================================
+// Account properties: key range within one account
+// ============================================================
+
+void BM_PropertiesPrefixRange(benchmark::State& state) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  AccountRepository repo(db);
+  repo.initSchema();
+  repo.createAccount({"a1", "User", std::nullopt, 0});
+  db.beginTransaction();
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    repo.setProperty("a1", groupKey(i / 10, i % 10), "value");
+  }
+  db.commit();
+  const int64_t groups = state.range(0) / 10;
+
+  int64_t group = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        repo.getPropertiesByPrefix("a1", groupPrefix(group++ % groups)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PropertiesPrefixRange)
+    ->ArgName("keys")
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000);
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
+
+BENCHMARK_MAIN();
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+constexpr int64_t kStepMs = 1000;
+
+// count points of asset from first_ms on, one a second
+std::vector<Entities::TimeSeriesPoint> makePoints(const std::string& asset,
+                                                  int64_t first_ms,
+                                                  int64_t count) {
+  std::vector<Entities::TimeSeriesPoint> points;
+  points.reserve(static_cast<size_t>(count));
+  for (int64_t i = 0; i < count; ++i) {
+    points.push_back({asset, first_ms + i * kStepMs, "USD",
+                      100.0 + static_cast<double>(i % 97) * 0.25});
+  }
+  return points;
+}
+
+// Schema plus the USD unit and assets a0..a<assets-1>
+void initRepository(TimeSeriesRepository& repo, int64_t assets) {
+  repo.initSchema();
+  repo.createUnit({"USD", "$", "US Dollar"});
+  for (int64_t i = 0; i < assets; ++i) {
+    repo.createAsset({"a" + std::to_string(i), "Asset", "", ""});
+  }
+}
+
+// ============================================================
+// addPoints: one batch appended past the newest point
+// ============================================================
+
+// range(0): points per addPoints() call
+void BM_AddPoints(benchmark::State& state) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesRepository repo(db);
+  initRepository(repo, 1);
+
+  int64_t next_ms = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    const auto points = makePoints("a0", next_ms, state.range(0));
+    next_ms += state.range(0) * kStepMs;
+    state.ResumeTiming();
+
+    repo.addPoints(points);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_AddPoints)
+    ->ArgName("points")
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+// ============================================================
+// getPoints: a range read of one series
+// ============================================================
+
+// range(0): points stored, range(1): points read per call
+void BM_GetPoints(benchmark::State& state) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesRepository repo(db);
+  initRepository(repo, 1);
+  repo.addPoints(makePoints("a0", 0, state.range(0)));
+  const int64_t width = state.range(1);
+  const int64_t windows = state.range(0) / width;
+
+  int64_t window = 0;
+  for (auto _ : state) {
+    const int64_t from_ms = (window++ % windows) * width * kStepMs;
+    benchmark::DoNotOptimize(
+        repo.getPoints("a0", "USD", from_ms, from_ms + (width - 1) * kStepMs));
+  }
+  state.SetItemsProcessed(state.iterations() * width);
+}
+
+BENCHMARK(BM_GetPoints)
+    ->ArgNames({"stored", "read"})
+    ->ArgsProduct({{100000, 1000000}, {100, 10000}})
+    ->Unit(benchmark::kMicrosecond);
+
+// ============================================================
+// getLatestPoint: cached vs from the store
+// ============================================================
+
+// range(0): assets, each holding 100 points
+void BM_GetLatestPointCached(benchmark::State& state) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesRepository repo(db);
+  initRepository(repo, state.range(0));
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    repo.addPoints(makePoints("a" + std::to_string(i), 0, 100));
+  }
+
+  int64_t asset = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(repo.getLatestPoint(
+        "a" + std::to_string(asset++ % state.range(0)), "USD"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_GetLatestPointUncached(benchmark::State& state) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesRepository repo(db);
+  initRepository(repo, state.range(0));
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    repo.addPoints(makePoints("a" + std::to_string(i), 0, 100));
+  }
+
+  int64_t asset = 0;
+  for (auto _ : state) {
+    repo.invalidateLatestCache();
+    benchmark::DoNotOptimize(repo.getLatestPoint(
+        "a" + std::to_string(asset++ % state.range(0)), "USD"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_GetLatestPointCached)
+    ->ArgName("assets")
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+BENCHMARK(BM_GetLatestPointUncached)
+    ->ArgName("assets")
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
@@ -24,6 +24,15 @@ DEST_DB_PATH="${DEST_PARENT_DIR}/sqlite3"
 I_HPP_PATH="${SCRIPT_DIR}/../../database/inc/database_connector.h"
 C_HPP_PATH="${SCRIPT_DIR}/../../database/inc/sqlite3_database_connector.h"
 C_CPP_PATH="${SCRIPT_DIR}/../../database/src/sqlite3_database_connector.cc"
+# The connection pool the repositories share
+P_HPP_PATH="${SCRIPT_DIR}/../../database/inc/sqlite3_pool.h"
+P_CPP_PATH="${SCRIPT_DIR}/../../database/src/sqlite3_pool.cc"
+# Trace spans, used by the repository and the connector
+T_HPP_PATH="${SCRIPT_DIR}/../../../06_tracing/inc/tracing.h"
+# The executor getPointsMulti() reads on
+E_HPP_PATH="${SCRIPT_DIR}/../../../07_executor/inc/executor.h"
+# The ring buffer behind the indicator windows
+R_HPP_PATH="${SCRIPT_DIR}/../../../09_ring_buffer/inc/ring_buffer.h"
 
 # -----------------------------------------------------------------------------
 # Setup & Cleanup
@@ -44,6 +53,11 @@ echo "📂 Copying required header files..."
 cp -r "${I_HPP_PATH}" "${DEST_PARENT_DIR}/"
 cp -r "${C_HPP_PATH}" "${DEST_PARENT_DIR}/"
 cp -r "${C_CPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${P_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${P_CPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${T_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${E_HPP_PATH}" "${DEST_PARENT_DIR}/"
+cp -r "${R_HPP_PATH}" "${DEST_PARENT_DIR}/"
 
 # 3. Cleanup: Define function to remove the folder on exit
 cleanup() {
@@ -53,6 +67,11 @@ cleanup() {
     rm -rf "${DEST_PARENT_DIR}/database_connector.h"
     rm -rf "${DEST_PARENT_DIR}/sqlite3_database_connector.h"
     rm -rf "${DEST_PARENT_DIR}/sqlite3_database_connector.cc"
+    rm -rf "${DEST_PARENT_DIR}/sqlite3_pool.h"
+    rm -rf "${DEST_PARENT_DIR}/sqlite3_pool.cc"
+    rm -rf "${DEST_PARENT_DIR}/tracing.h"
+    rm -rf "${DEST_PARENT_DIR}/executor.h"
+    rm -rf "${DEST_PARENT_DIR}/ring_buffer.h"
 }
 
 # Register the trap to run on EXIT (happens on success, error, or interrupt)
@@ -1,10 +1,15 @@
 #ifndef REPOSITORIES_ACCOUNT_REPOSITORY_H_
 #define REPOSITORIES_ACCOUNT_REPOSITORY_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "bloom_filter.h"
 #include "database_connector.h"
 #include "entities.h"
 #ifndef UNIT_TEST
@@ -18,19 +23,66 @@
 
 namespace Gateways::Repositories::Sqlite3 {
 
+struct AccountOptions {
+  // Bloom filters over ids and names, so accountExists() and
+  // accountExistsByName() answer most misses without a query; off by
+  // default
+  bool existenceFilter = false;
+  // Accounts the filters are sized for; grown to twice the stored count
+  // when they load
+  size_t filterCapacity = 100000;
+  double filterFalsePositiveRate = 0.01;
+};
+
+struct AccountFilterStats {
+  uint64_t checks = 0;
+  uint64_t skipped = 0;         // answered "absent" without a query
+  uint64_t falsePositives = 0;  // queried, and absent after all
+};
+
+// With options.existenceFilter the filters load every id and name on the
+// first existence check and learn each account created or renamed
+// through the repository afterwards. Deleted accounts stay in them, which
+// only costs a query. Accounts written by other means are missed until
+// rebuildExistenceFilters(). The filters are safe to share across
+// threads.
 class AccountRepository USE_CASE {
  public:
-  explicit AccountRepository(Gateways::Database::IDatabase& db);
+  // At four parameters a row, statements stay under 999 variables, the
+  // lowest limit SQLite builds have shipped with
+  static constexpr size_t kAccountsPerInsert = 200;
+
+  explicit AccountRepository(Gateways::Database::IDatabase& db,
+                             const AccountOptions& options = {});
 
   // Schema management
   void initSchema();
 
   // Account CRUD
   void createAccount(const Entities::Account& account) OVERRIDE;
+  // One INSERT; a PRIMARY KEY or UNIQUE violation is reported rather
+  // than thrown. A taken name costs one more query.
+  Entities::AccountConflict tryCreateAccount(
+      const Entities::Account& account) OVERRIDE;
+  // One transaction of multi-row INSERTs, kAccountsPerInsert rows each;
+  // all or nothing
+  void createAccounts(const std::vector<Entities::Account>& accounts)
+      OVERRIDE;
+  // One query for the whole batch; result[i] is the stored account
+  // accounts[i] collides with, the id checked first
+  std::vector<Entities::AccountConflict> findAccountConflicts(
+      const std::vector<Entities::Account>& accounts) OVERRIDE;
   std::optional<Entities::Account> getAccount(const std::string& id) OVERRIDE;
   std::optional<Entities::Account> getAccountByName(
       const std::string& name) OVERRIDE;
   std::vector<Entities::Account> getAllAccounts() OVERRIDE;
+  // Keyset pages by name over the name index, without password hashes.
+  // Each page is one index seek, however deep into the listing it is.
+  std::vector<Entities::AccountSummary> listAccounts(
+      const std::optional<std::string>& after_name, size_t limit) OVERRIDE;
+  // Multi-get in one statement; result[i] is the account for ids[i]
+  std::vector<std::optional<Entities::Account>> getAccounts(
+      const std::vector<std::string>& ids);
   void updateAccount(const Entities::Account& account) OVERRIDE;
   void deleteAccount(const std::string& id) OVERRIDE;
 
@@ -51,8 +103,20 @@ class AccountRepository USE_CASE {
 
   std::vector<Entities::AccountProperty> getProperties(
       const std::string& account_id) OVERRIDE;
+  // Prefixes match byte for byte, as an index range on (account_id, key)
   std::vector<Entities::AccountProperty> getPropertiesByPrefix(
       const std::string& account_id, const std::string& prefix) OVERRIDE;
+  // Keyset pages by key over the (account_id, key) primary key
+  std::vector<Entities::AccountProperty> listProperties(
+      const std::string& account_id,
+      const std::optional<std::string>& after_key, size_t limit) OVERRIDE;
+
+  // Set-based reads grouped in one pass over key-ordered rows, in place
+  // of a getProperties() call per account
+  std::vector<std::vector<Entities::AccountProperty>> getPropertiesForAccounts(
+      const std::vector<std::string>& account_ids) OVERRIDE;
+  std::vector<Entities::AccountWithProperties> getAccountsWithProperties(
+      const std::optional<std::string>& after_name, size_t limit) OVERRIDE;
 
   bool propertyExists(const std::string& account_id,
                       const std::string& key) OVERRIDE;
@@ -66,8 +130,28 @@ class AccountRepository USE_CASE {
   int64_t countAccounts() OVERRIDE;
   int64_t countProperties(const std::string& account_id) OVERRIDE;
 
+  // Existence filters. Zero stats when they are off.
+  AccountFilterStats existenceFilterStats() const;
+  // Reloads the filters on the next check
+  void rebuildExistenceFilters();
+
  private:
+  struct ExistenceFilters {
+    std::mutex mutex;
+    bool loaded = false;
+    std::unique_ptr<BloomFilter> ids;
+    std::unique_ptr<BloomFilter> names;
+    AccountFilterStats stats;
+  };
+
+  // False if the filter rules the key out
+  bool mayExist(bool byName, const std::string& key);
+  void notePossibleFalsePositive();
+  void remember(const Entities::Account& account);
+
   Gateways::Database::IDatabase& m_db;
+  const AccountOptions m_options;
+  std::unique_ptr<ExistenceFilters> m_filters;  // null if off
 };
 
 }  // namespace Gateways::Repositories::Sqlite3
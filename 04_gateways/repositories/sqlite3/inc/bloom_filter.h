@@ -0,0 +1,43 @@
+#ifndef REPOSITORIES_BLOOM_FILTER_H_
+#define REPOSITORIES_BLOOM_FILTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// BloomFilter - approximate set of strings
+// ============================================================
+
+// Answers "definitely absent" or "maybe present": never a false
+// negative, and false positives at about the configured rate until more
+// than capacity keys have been added. Keys cannot be removed. Not
+// thread-safe.
+class BloomFilter {
+ public:
+  // Throws std::invalid_argument unless capacity > 0 and the rate is in
+  // (0, 1)
+  BloomFilter(size_t capacity, double false_positive_rate);
+
+  void add(std::string_view key);
+  bool mayContain(std::string_view key) const;
+  void clear();
+
+  size_t bitCount() const { return m_bits; }
+  size_t hashCount() const { return m_hashes; }
+
+ private:
+  // Double hashing: probe i is (h1 + i * h2) mod bitCount()
+  static void hash(std::string_view key, uint64_t& h1, uint64_t& h2);
+
+  std::vector<uint64_t> m_words;
+  size_t m_bits;
+  size_t m_hashes;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_BLOOM_FILTER_H_
@@ -0,0 +1,38 @@
+#ifndef REPOSITORIES_GORILLA_CODEC_H_
+#define REPOSITORIES_GORILLA_CODEC_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using Gateways::Database::BlobView;
+
+// ============================================================
+// Gorilla Codec - compressed (timestamp, value) blocks
+// ============================================================
+
+// Encoding from "Gorilla: A Fast, Scalable, In-Memory Time Series
+// Database" (Pelkonen et al., VLDB 2015). Timestamps are stored as
+// delta-of-delta in prefix-coded buckets (one bit for a regular interval);
+// values are XORed with their predecessor and only the meaningful bits are
+// kept (one bit for a repeated value). Layout, MSB first: 32-bit count,
+// first timestamp and value raw, then one timestamp and one value code per
+// further sample.
+struct GorillaSample {
+  int64_t timestamp_ms;
+  double value;
+};
+
+// samples must be ordered by strictly increasing timestamp; throws
+// std::invalid_argument otherwise
+std::vector<uint8_t> gorillaEncode(const std::vector<GorillaSample>& samples);
+
+// Throws QueryException if data is truncated or malformed
+std::vector<GorillaSample> gorillaDecode(BlobView data);
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_GORILLA_CODEC_H_
@@ -0,0 +1,304 @@
+#ifndef REPOSITORIES_INGEST_JOURNAL_H_
+#define REPOSITORIES_INGEST_JOURNAL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "database_connector.h"
+#include "entities.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+// ============================================================
+// Journal Format (version 1)
+// ============================================================
+
+// A directory of segment files, <segment number>.journal, each of a
+// fixed size set when it was created and mapped read-write. Integers are
+// in host byte order, which byte_order records:
+//
+//   JournalSegmentHeader                  32 bytes
+//   records, each 8-byte aligned:
+//     JournalRecordHeader                 8 bytes
+//     payload: uint32 point count, then per point int64 timestamp_ms,
+//              double value, uint16 asset id size, uint16 unit id size
+//              and the id bytes
+//     zero padding
+//
+// The rest of a segment is zero, so a size of 0 ends it. A record is
+// valid only if its payload matches its CRC-32C.
+inline constexpr char kJournalMagic[8] = {'T', 'S', 'J', 'O',
+                                          'U', 'R', 'N', 'L'};
+inline constexpr uint32_t kJournalVersion = 1;
+inline constexpr uint32_t kJournalByteOrder = 0x01020304;
+
+struct JournalSegmentHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t segment;
+  uint64_t segment_bytes;  // file size, header included
+};
+static_assert(sizeof(JournalSegmentHeader) == 32,
+              "JournalSegmentHeader layout");
+
+struct JournalRecordHeader {
+  uint32_t size;      // payload bytes, without padding
+  uint32_t checksum;  // CRC-32C of the payload
+};
+static_assert(sizeof(JournalRecordHeader) == 8, "JournalRecordHeader layout");
+
+class IngestJournalException : public std::runtime_error {
+ public:
+  explicit IngestJournalException(const std::string& msg)
+      : std::runtime_error("Ingest journal: " + msg) {}
+};
+
+// A record boundary: byte offset into a segment. Positions order by
+// segment, then offset.
+struct JournalPosition {
+  uint64_t segment = 0;
+  uint64_t offset = 0;
+
+  friend bool operator==(const JournalPosition& a, const JournalPosition& b) {
+    return a.segment == b.segment && a.offset == b.offset;
+  }
+  friend bool operator!=(const JournalPosition& a, const JournalPosition& b) {
+    return !(a == b);
+  }
+  friend bool operator<(const JournalPosition& a, const JournalPosition& b) {
+    return std::tie(a.segment, a.offset) < std::tie(b.segment, b.offset);
+  }
+  friend bool operator<=(const JournalPosition& a, const JournalPosition& b) {
+    return !(b < a);
+  }
+};
+
+// ============================================================
+// JournalOptions
+// ============================================================
+
+// When written pages are flushed to the file with msync(). Records are in
+// the page cache once append() returns, so they survive the process
+// crashing either way; the policy decides what a power loss can take.
+enum class JournalSync {
+  None,         // whenever the kernel writes the pages back
+  Periodic,     // by a background thread every syncInterval
+  EveryAppend,  // before append() returns; acknowledges at disk speed
+};
+
+struct JournalOptions {
+  // Size of new segment files; a record must fit in one
+  size_t segmentBytes = 64 << 20;
+  JournalSync sync = JournalSync::Periodic;
+  std::chrono::milliseconds syncInterval{100};
+};
+
+struct JournalStats {
+  uint64_t records = 0;  // appended since open
+  uint64_t points = 0;
+  uint64_t bytes = 0;  // record bytes appended, headers and padding too
+  uint64_t syncs = 0;  // msync() calls
+  uint64_t segmentsCreated = 0;
+  uint64_t segmentsReleased = 0;
+  uint64_t recoveredRecords = 0;  // valid records found at open
+  uint64_t tornTails = 0;  // segments whose scan at open hit a bad record
+};
+
+// ============================================================
+// IngestJournal - mmap-backed write-ahead log of points
+// ============================================================
+
+// Acknowledges ticks before they reach SQLite: append() encodes a batch
+// into a reused buffer, checksums it and copies it into the mapped
+// segment with one memcpy, so it returns in microseconds unless the sync
+// policy is EveryAppend. IngestJournalApplier replays the records into a
+// TimeSeriesRepository. When a record does not fit in the current
+// segment, the journal moves on to a new one; release() deletes the
+// segments before a position once their points are stored.
+//
+// Opening a directory scans its segments and resumes appending after the
+// last valid record. A record torn by a crash fails its checksum; the
+// scan stops there, and the rest of that segment is zeroed.
+//
+// append() may be called from any thread. read() and release() are for
+// one consumer at a time, such as the applier.
+class IngestJournal {
+ public:
+  // Creates the directory if needed. Throws IngestJournalException on I/O
+  // errors and on segments of another format.
+  explicit IngestJournal(const std::string& directory,
+                         const JournalOptions& options = {});
+  ~IngestJournal();
+
+  IngestJournal(const IngestJournal&) = delete;
+  IngestJournal& operator=(const IngestJournal&) = delete;
+  IngestJournal(IngestJournal&&) = delete;
+  IngestJournal& operator=(IngestJournal&&) = delete;
+
+  // Appends the points as one record and returns the position after it;
+  // an empty batch writes nothing. Throws std::invalid_argument if an id
+  // is over 65535 bytes or the record does not fit in a segment.
+  JournalPosition append(const std::vector<Entities::TimeSeriesPoint>& points);
+  JournalPosition append(const Entities::TimeSeriesPoint& point);
+
+  // msync()s everything appended so far
+  void sync();
+
+  // Start of the oldest segment kept, and the position after the newest
+  // record
+  JournalPosition begin() const;
+  JournalPosition end() const;
+
+  // Appends the points of whole records from `from`, a position returned
+  // by this journal, to out until at least maxPoints were read or end()
+  // is reached. Returns the position after the last record read.
+  JournalPosition read(JournalPosition from, size_t maxPoints,
+                       std::vector<Entities::TimeSeriesPoint>& out) const;
+
+  // Deletes the segments before upto's; returns how many
+  size_t release(JournalPosition upto);
+
+  JournalStats stats() const;
+  const std::string& directory() const;
+
+ private:
+  struct Segment;
+
+  void recover();
+  std::shared_ptr<Segment> createSegment(uint64_t number);
+  std::shared_ptr<Segment> openSegment(uint64_t number);
+  std::string segmentPath(uint64_t number) const;
+  void encode(const std::vector<Entities::TimeSeriesPoint>& points);
+  void syncLoop();
+
+  const std::string m_directory;
+  const JournalOptions m_options;
+
+  mutable std::mutex m_mutex;  // appends, the segment list and stats
+  std::map<uint64_t, std::shared_ptr<Segment>> m_segments;
+  std::shared_ptr<Segment> m_current;
+  std::vector<uint8_t> m_record;  // encode() buffer, reused
+  JournalStats m_stats;
+
+  std::mutex m_syncMutex;  // one sync() at a time
+
+  std::mutex m_syncerMutex;
+  std::condition_variable m_syncerWake;
+  bool m_stopping = false;
+  std::thread m_syncer;  // JournalSync::Periodic only
+};
+
+// ============================================================
+// JournalApplierOptions
+// ============================================================
+
+struct JournalApplierOptions {
+  // Points per transaction; whole records, so a batch may be larger
+  size_t batchPoints = 50000;
+  // How long the background applier sleeps once the journal is drained
+  std::chrono::milliseconds pollInterval{10};
+  // Checkpoint row, one per journal applied into the database
+  std::string name = "default";
+};
+
+struct JournalApplierStats {
+  uint64_t batches = 0;  // committed transactions
+  uint64_t points = 0;
+  uint64_t segmentsReleased = 0;
+  uint64_t failures = 0;  // background batches that threw
+};
+
+// ============================================================
+// IngestJournalApplier - replays the journal into SQLite
+// ============================================================
+
+// Reads the journal from its checkpoint and writes each batch with
+// TimeSeriesRepository::addPoints() in one transaction that also moves
+// the checkpoint in ingest_journal_checkpoints, so after a crash the next
+// applier resumes exactly after the last committed batch. Segments before
+// the checkpoint are then released.
+//
+// applyPending() works on the calling thread; start() applies on a
+// background thread until stop(). Batches never overlap. The database
+// must nest transactions and allow use from the background thread
+// (SqlitePool, or a SqliteDatabase no other thread uses meanwhile).
+class IngestJournalApplier {
+ public:
+  IngestJournalApplier(IDatabase& db, TimeSeriesRepository& repository,
+                       IngestJournal& journal,
+                       const JournalApplierOptions& options = {});
+  ~IngestJournalApplier();
+
+  IngestJournalApplier(const IngestJournalApplier&) = delete;
+  IngestJournalApplier& operator=(const IngestJournalApplier&) = delete;
+  IngestJournalApplier(IngestJournalApplier&&) = delete;
+  IngestJournalApplier& operator=(IngestJournalApplier&&) = delete;
+
+  // The checkpoint table, versioned as "ingest_journal" with
+  // migrateSchema()
+  void initSchema();
+
+  // Where applying resumes: the stored checkpoint, or the journal's
+  // begin() before the first batch. Throws IngestJournalException if the
+  // stored one is outside the journal, e.g. for another directory.
+  JournalPosition checkpoint();
+
+  // Applies everything appended so far, in batches; returns the points
+  // applied. Exceptions propagate after rolling back the failed batch.
+  size_t applyPending();
+
+  // stop() finishes the batch in progress and joins; it is idempotent
+  void start();
+  void stop();
+  bool isRunning() const;
+
+  // Waits until everything appended before the call is applied: on the
+  // calling thread when stopped, else by the background applier, which
+  // retries failed batches every pollInterval
+  void flush();
+
+  JournalApplierStats stats() const;
+
+ private:
+  void run();
+  // One transaction; false once the journal is drained
+  bool applyBatch();
+  void saveCheckpoint(const JournalPosition& position);
+
+  IDatabase& m_db;
+  TimeSeriesRepository& m_repository;
+  IngestJournal& m_journal;
+  const JournalApplierOptions m_options;
+
+  std::mutex m_batchMutex;  // applyBatch() and m_position
+  JournalPosition m_position;
+  bool m_loaded = false;  // m_position read from the database
+  std::vector<Entities::TimeSeriesPoint> m_batch;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_applied;
+  JournalPosition m_committed;  // for flush()
+  bool m_stopping = false;
+  JournalApplierStats m_stats;
+
+  std::thread m_worker;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_INGEST_JOURNAL_H_
@@ -0,0 +1,35 @@
+#ifndef REPOSITORIES_KEYVALUE_HTTP_CACHE_STORE_H_
+#define REPOSITORIES_KEYVALUE_HTTP_CACHE_STORE_H_
+
+#include <optional>
+#include <string>
+
+#include "i_http_cache_store.h"
+#include "keyvalue_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// Persists the internet gateway's HTTP cache as settings under a key
+// prefix, so cached responses survive restarts. Entries are written as
+// text, which suits the JSON bodies the gateway fetches. Safe across
+// threads as far as the repository's database is.
+class KeyValueHttpCacheStore : public Gateways::Network::IHttpCacheStore {
+ public:
+  explicit KeyValueHttpCacheStore(KeyValueRepository& repository,
+                                  std::string prefix = "http_cache/");
+
+  std::optional<std::string> load(const std::string& key) override;
+  void save(const std::string& key, const std::string& value) override;
+  void remove(const std::string& key) override;
+
+  // Removes every cached response
+  void clear();
+
+ private:
+  KeyValueRepository& m_repository;
+  const std::string m_prefix;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_KEYVALUE_HTTP_CACHE_STORE_H_
@@ -1,8 +1,15 @@
 #ifndef REPOSITORIES_KEYVALUE_REPOSITORY_H_
 #define REPOSITORIES_KEYVALUE_REPOSITORY_H_
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "database_connector.h"
@@ -10,9 +17,38 @@
 
 namespace Gateways::Repositories::Sqlite3 {
 
+struct KeyValueOptions {
+  // Read-through cache for get(), getValue() and exists(), off by default
+  bool cache = false;
+  // Lock stripes; a key's shard is picked by its hash
+  size_t cacheShards = 16;
+  // Across all shards; a full shard evicts an arbitrary entry
+  size_t cacheCapacity = 4096;
+};
+
+struct KeyValueCacheStats {
+  uint64_t hits = 0;  // negative hits included
+  uint64_t negativeHits = 0;
+  uint64_t misses = 0;
+  size_t entries = 0;
+
+  double hitRate() const {
+    const uint64_t lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+  }
+};
+
+// With options.cache the single-key reads are served from an in-process
+// cache of settings and of keys known to be absent, filled on a miss.
+// set() and remove() invalidate their key, removeByPrefix() the keys with
+// that prefix, and clear() everything. A read that raced a
+// write does not fill the cache, so it never returns a value older than
+// the last write through the repository. The cache is sharded with one
+// mutex per shard and is safe to share across threads.
 class KeyValueRepository {
  public:
-  explicit KeyValueRepository(Gateways::Database::IDatabase& db);
+  explicit KeyValueRepository(Gateways::Database::IDatabase& db,
+                              const KeyValueOptions& options = {});
 
   // Schema management
   void initSchema();
@@ -28,7 +64,8 @@ class KeyValueRepository {
   bool exists(const std::string& key);
   void remove(const std::string& key);
 
-  // Bulk operations
+  // Bulk operations. Prefixes match byte for byte, case and '%' / '_'
+  // included, as an index range on key (see prefix_range.h).
   std::vector<Entities::Setting> getAll();
   std::vector<Entities::Setting> getByPrefix(const std::string& prefix);
   std::vector<std::string> getKeys();
@@ -37,12 +74,52 @@ class KeyValueRepository {
   void removeByPrefix(const std::string& prefix);
   void clear();
 
+  // Batches. getMany() reads every key in one statement, serving cached
+  // keys from the cache when it is on; absent keys are left out of the
+  // map. setMany() writes all settings in one transaction, or none; for
+  // a repeated key the last one wins.
+  std::map<std::string, Entities::Setting> getMany(
+      const std::vector<std::string>& keys);
+  void setMany(const std::vector<Entities::Setting>& settings);
+
   // Count
   int64_t count();
   int64_t countByPrefix(const std::string& prefix);
 
+  // Cache. Zero stats when the cache is off. invalidateCache() is for
+  // settings changed without the repository, or undone by rolling back an
+  // enclosing transaction.
+  KeyValueCacheStats cacheStats() const;
+  void invalidateCache();
+
  private:
+  struct CacheShard {
+    std::mutex mutex;
+    // nullopt: the key is known to be absent
+    std::unordered_map<std::string, std::optional<Entities::Setting>> entries;
+    uint64_t epoch = 0;  // bumped by every invalidation of the shard
+  };
+
+  std::optional<Entities::Setting> load(const std::string& key);
+  // Through the cache when it is on
+  std::optional<Entities::Setting> lookup(const std::string& key);
+  // False on a miss, with epoch set for fill()
+  bool cached(const std::string& key, std::optional<Entities::Setting>& setting,
+              uint64_t& epoch);
+  // Unless the key's shard was invalidated since epoch
+  void fill(const std::string& key, uint64_t epoch,
+            const std::optional<Entities::Setting>& setting);
+  CacheShard& shardFor(const std::string& key);
+  void invalidate(const std::string& key);
+  void invalidatePrefix(const std::string& prefix);
+
   Gateways::Database::IDatabase& m_db;
+
+  std::vector<std::unique_ptr<CacheShard>> m_shards;  // empty if cache off
+  size_t m_shardCapacity = 0;
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_negativeHits{0};
+  std::atomic<uint64_t> m_misses{0};
 };
 
 }  // namespace Gateways::Repositories::Sqlite3
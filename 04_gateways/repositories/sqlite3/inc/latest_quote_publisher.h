@@ -0,0 +1,95 @@
+#ifndef REPOSITORIES_LATEST_QUOTE_PUBLISHER_H_
+#define REPOSITORIES_LATEST_QUOTE_PUBLISHER_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+#include "latest_quote_table.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+struct LatestQuoteOptions {
+  // Slots, rounded up to a power of two. New assets are rejected once
+  // three quarters are taken, which keeps probes short.
+  size_t capacity = 4096;
+  // Removes the name on destruction, unless another publisher has
+  // replaced the table since
+  bool unlinkOnClose = true;
+};
+
+struct LatestQuoteStats {
+  uint64_t published = 0;  // quotes written
+  uint64_t rejected = 0;   // points of ids too long, or of a full table
+  uint64_t assets = 0;
+};
+
+// ============================================================
+// LatestQuotePublisher - latest points into shared memory
+// ============================================================
+
+// Creates the table under a shared-memory name, replacing and closing any
+// table there before, and registers an ingest listener on the repository,
+// like HotSeriesCache: the construction publishes every asset's
+// getLatestPoint(), and each point addPoint()/addPoints() writes that is
+// at least as new as its asset's quote replaces it. Readers in other
+// processes open the name with LatestQuoteReader.
+//
+// deletePoints(), retention and writes made without the repository (or
+// undone by rolling back an enclosing transaction) do not reach the
+// listener; reload() after them, as with invalidateLatestCache().
+// One publisher per name. Thread-safe.
+class LatestQuotePublisher {
+ public:
+  // Throws LatestQuoteException if the table cannot be created
+  LatestQuotePublisher(TimeSeriesRepository& repository,
+                       const std::string& name,
+                       const LatestQuoteOptions& options = {});
+  // Removes the listener and marks the table closed for its readers
+  ~LatestQuotePublisher();
+
+  LatestQuotePublisher(const LatestQuotePublisher&) = delete;
+  LatestQuotePublisher& operator=(const LatestQuotePublisher&) = delete;
+
+  // Publishes getLatestPoint() of every asset again, clearing the quotes
+  // of assets left without points
+  void reload();
+
+  const std::string& name() const;
+  size_t capacity() const;
+  LatestQuoteStats stats() const;
+
+ private:
+  void onIngest(const std::vector<Entities::TimeSeriesPoint>& points);
+
+  // Callers hold m_mutex
+  // The asset's slot, claimed if new; nullptr if the point is rejected
+  LatestQuoteSlot* slotFor(const Entities::TimeSeriesPoint& point);
+  // The quote, or no point with nullptr
+  void write(LatestQuoteSlot& slot, const Entities::TimeSeriesPoint* point);
+
+  TimeSeriesRepository& m_repository;
+  const std::string m_name;
+  const LatestQuoteOptions m_options;
+
+  dev_t m_device = 0;  // of the object, to tell a successor's apart
+  ino_t m_inode = 0;
+  size_t m_bytes = 0;
+  LatestQuoteHeader* m_header = nullptr;
+  LatestQuoteSlot* m_slots = nullptr;
+  size_t m_mask = 0;
+
+  mutable std::mutex m_mutex;
+  LatestQuoteStats m_stats;
+  size_t m_listener = 0;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_LATEST_QUOTE_PUBLISHER_H_
@@ -0,0 +1,139 @@
+#ifndef REPOSITORIES_LATEST_QUOTE_TABLE_H_
+#define REPOSITORIES_LATEST_QUOTE_TABLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// Table Format (version 1)
+// ============================================================
+
+// A POSIX shared-memory object holding the latest point of each asset,
+// written by one publisher process and mapped read-only by any number of
+// readers. Integers are in host byte order, which byte_order records:
+//
+//   LatestQuoteHeader                     64 bytes
+//   capacity LatestQuoteSlots             128 bytes each
+//
+// The slots are an open-addressing table: an asset's home slot is its
+// latestQuoteHash() modulo capacity, a power of two, and probing moves to
+// the next slot. Keys are never removed, so an empty slot (sequence 0)
+// ends a probe, and a slot's key never changes once its sequence is
+// non-zero.
+//
+// Every slot is a seqlock: the publisher makes sequence odd, stores the
+// quote words and makes it even again. A reader whose two loads of
+// sequence differ, or are odd, read a torn quote and retries.
+inline constexpr char kLatestQuoteMagic[8] = {'T', 'S', 'Q', 'U',
+                                              'O', 'T', 'E', 'S'};
+inline constexpr uint32_t kLatestQuoteVersion = 1;
+inline constexpr uint32_t kLatestQuoteByteOrder = 0x01020304;
+
+inline constexpr size_t kQuoteMaxAssetIdBytes = 64;
+inline constexpr size_t kQuoteMaxUnitIdBytes = 16;
+
+// LatestQuoteHeader::state
+enum class QuoteTableState : uint64_t {
+  Creating = 0,  // the header is not written yet
+  Open = 1,
+  Closed = 2,  // the publisher is gone; reopen to follow its successor
+};
+
+struct LatestQuoteHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t capacity;    // slots
+  uint64_t slot_bytes;  // sizeof(LatestQuoteSlot)
+  std::atomic<uint64_t> state;   // QuoteTableState, stored last
+  std::atomic<uint64_t> assets;  // slots with a key
+  uint64_t reserved[2];
+};
+static_assert(sizeof(LatestQuoteHeader) == 64, "LatestQuoteHeader layout");
+
+// Words of LatestQuoteSlot::words. The key words (hash, asset id size
+// and id) are written before the slot's first sequence; the quote words
+// change under the seqlock.
+enum QuoteWord : size_t {
+  kQuoteHash = 0,
+  kQuoteAssetSize,
+  kQuoteAssetId,                        // 8 words, zero padded
+  kQuoteTimestamp = kQuoteAssetId + 8,  // int64 bits
+  kQuoteValue,                          // double bits
+  kQuoteUnitSize,  // size + 1; 0: the asset has no point
+  kQuoteUnitId,    // 2 words, zero padded
+  kQuoteWords = kQuoteUnitId + 2,
+};
+
+struct LatestQuoteSlot {
+  std::atomic<uint64_t> sequence;  // 0: empty, odd: being written
+  std::atomic<uint64_t> words[kQuoteWords];
+};
+static_assert(sizeof(LatestQuoteSlot) == 128, "LatestQuoteSlot layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Quote words must be lock-free to be shared across processes");
+
+// FNV-1a of the asset id; never 0
+uint64_t latestQuoteHash(std::string_view asset_id);
+
+class LatestQuoteException : public std::runtime_error {
+ public:
+  explicit LatestQuoteException(const std::string& msg)
+      : std::runtime_error("Latest quote table: " + msg) {}
+};
+
+struct LatestQuote {
+  int64_t timestamp_ms = 0;
+  double value = 0.0;
+  std::string unit_id;
+  // Moves on every publish of the asset, so pollers can skip unchanged
+  // quotes
+  uint64_t version = 0;
+};
+
+// ============================================================
+// LatestQuoteReader - lock-free lookups in another process' table
+// ============================================================
+
+// Maps a table read-only; depends on nothing but POSIX, so reader
+// processes link the small latest-quote reader library alone. Lookups take
+// no lock and make no system call: a probe of the mapped slots and a
+// seqlock read of the quote. Thread-safe.
+//
+// A reader keeps the mapping it opened. Once closed() turns true the
+// publisher has exited; a new one creates a new object under the name,
+// which a new reader opens.
+class LatestQuoteReader {
+ public:
+  // name: a shared-memory object name, such as "/cppref_quotes". Throws
+  // LatestQuoteException if it does not exist, is still being created or
+  // is of another format.
+  explicit LatestQuoteReader(const std::string& name);
+  ~LatestQuoteReader();
+
+  LatestQuoteReader(const LatestQuoteReader&) = delete;
+  LatestQuoteReader& operator=(const LatestQuoteReader&) = delete;
+
+  // False if the asset has no point; unit_id reuses its capacity
+  bool lookup(std::string_view asset_id, LatestQuote& quote) const;
+
+  size_t capacity() const;
+  size_t assets() const;
+  bool closed() const;
+
+ private:
+  const LatestQuoteHeader* m_header = nullptr;
+  const LatestQuoteSlot* m_slots = nullptr;
+  size_t m_bytes = 0;
+  size_t m_mask = 0;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_LATEST_QUOTE_TABLE_H_
@@ -0,0 +1,107 @@
+#ifndef REPOSITORIES_POINT_CACHE_H_
+#define REPOSITORIES_POINT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "gorilla_codec.h"
+#include "point_store.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+struct PointCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t seeded = 0;   // series loaded by a read
+  uint64_t evicted = 0;  // series dropped for the memory budget
+  uint64_t dropped = 0;  // series invalidated by a write or delete
+  uint64_t series = 0;
+  uint64_t bytes = 0;  // timestamp and value arrays
+};
+
+// ============================================================
+// PointCache - newest points per series, column by column
+// ============================================================
+
+// Each cached (asset key, unit key) series holds its newest points in a
+// ring of two parallel arrays, timestamps and values, up to
+// seriesPoints of them, and covers [coverage, +inf): every stored point
+// of the series from the coverage timestamp on is in the ring. A range
+// starting at or after it is answered by binary search on the
+// timestamps; anything older is a miss.
+//
+// seed() installs a series from a read that returned every stored point
+// from some timestamp on. write() keeps cached series current: newer
+// points append, evicting the oldest once the ring is full, equal
+// timestamps replace, and a point inserted inside the window drops the
+// series. Across series the least recently read is evicted while the
+// arrays exceed budgetBytes. Thread-safe.
+class PointCache {
+ public:
+  // Either 0 disables the cache
+  PointCache(size_t budget_bytes, size_t series_points);
+
+  bool enabled() const { return m_budget > 0 && m_seriesPoints > 0; }
+
+  // Appends the series' points in [from_ms, to_ms] and returns true on a
+  // hit. On a miss, epoch receives the value seed() must be given.
+  bool read(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+            int64_t to_ms, std::vector<int64_t>& timestamps,
+            std::vector<double>& values, uint64_t& epoch);
+
+  // samples: every stored point of the series at or after from_ms, by
+  // timestamp, as read after read() gave epoch. Ignored if a write or
+  // delete came in between.
+  void seed(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+            const std::vector<GorillaSample>& samples, uint64_t epoch);
+
+  // Points just stored, in write order (the last of equal timestamps wins)
+  void write(const std::vector<IPointStore::SeriesPoint>& points);
+  void forgetAsset(int64_t asset_key);
+  void clear();
+
+  PointCacheStats stats() const;
+
+ private:
+  using Key = std::pair<int64_t, int64_t>;  // asset key, unit key
+
+  struct Series {
+    // Logical point i is at (head + i) % size once the ring is full
+    std::vector<int64_t> timestamps;
+    std::vector<double> values;
+    size_t head = 0;
+    int64_t coverage = 0;
+    std::list<Key>::iterator lru;
+
+    size_t size() const { return timestamps.size(); }
+    int64_t timestampAt(size_t i) const;
+    // Logical index of the first point at or after timestamp_ms
+    size_t lowerBound(int64_t timestamp_ms) const;
+    size_t bytes() const;
+  };
+
+  // Callers hold m_mutex
+  // false if the series had to be dropped
+  bool apply(Series& series, const GorillaSample& sample);
+  void erase(std::map<Key, Series>::iterator it);
+  void enforceBudget();
+
+  const size_t m_budget;
+  const size_t m_seriesPoints;
+
+  mutable std::mutex m_mutex;
+  std::map<Key, Series> m_series;
+  std::list<Key> m_lru;  // front = most recently read
+  // Bumped by every write and delete, like the latest cache's epoch
+  uint64_t m_epoch = 0;
+  PointCacheStats m_stats;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_POINT_CACHE_H_
@@ -0,0 +1,62 @@
+#ifndef REPOSITORIES_POINT_STORE_H_
+#define REPOSITORIES_POINT_STORE_H_
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "gorilla_codec.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// IPointStore - alternative point layouts
+// ============================================================
+
+// Point storage behind TimeSeriesRepository when it does not use the
+// timeseries_points table: series are addressed by the surrogate keys the
+// repository derives, and every range is inclusive. Writes replace points
+// with equal timestamps.
+class IPointStore {
+ public:
+  struct SeriesPoint {
+    int64_t asset_key;
+    int64_t unit_key;
+    GorillaSample sample;
+  };
+  // Both return false to stop the scan
+  using SampleCallback = std::function<bool(const GorillaSample&)>;
+  using SeriesCallback = std::function<bool(const SeriesPoint&)>;
+
+  virtual ~IPointStore() = default;
+
+  // Needs asset_keys and unit_keys to exist
+  virtual void initSchema() = 0;
+
+  virtual void write(const std::vector<SeriesPoint>& points) = 0;
+
+  // Samples of one series in [from_ms, to_ms], by timestamp. scan()
+  // streams them.
+  virtual std::vector<GorillaSample> read(int64_t asset_key, int64_t unit_key,
+                                          int64_t from_ms, int64_t to_ms) = 0;
+  virtual void scan(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+                    int64_t to_ms, const SampleCallback& callback) = 0;
+  // All units of an asset in [from_ms, to_ms], by timestamp then unit.
+  // scan() streams them in bounded memory.
+  virtual std::vector<SeriesPoint> read(int64_t asset_key, int64_t from_ms,
+                                        int64_t to_ms) = 0;
+  virtual void scan(int64_t asset_key, int64_t from_ms, int64_t to_ms,
+                    const SeriesCallback& callback) = 0;
+
+  virtual std::optional<GorillaSample> latest(int64_t asset_key,
+                                              int64_t unit_key) = 0;
+  virtual std::optional<SeriesPoint> latest(int64_t asset_key) = 0;
+
+  virtual void erase(int64_t asset_key, int64_t from_ms, int64_t to_ms) = 0;
+  virtual void eraseAll(int64_t asset_key) = 0;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_POINT_STORE_H_
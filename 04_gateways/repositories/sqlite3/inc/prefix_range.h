@@ -0,0 +1,69 @@
+#ifndef REPOSITORIES_PREFIX_RANGE_H_
+#define REPOSITORIES_PREFIX_RANGE_H_
+
+#include <optional>
+#include <string>
+
+#include "database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// Prefix Ranges
+// ============================================================
+
+// The strings starting with a prefix, as the half-open range
+// [lower, upper) under SQLite's default BINARY collation. A range on an
+// indexed column is a seek plus the matching rows, where LIKE 'p%'
+// (case-insensitive by default) scans the whole table, and it takes
+// '%' and '_' in the prefix literally. upper is nullopt for an empty
+// prefix or one of only 0xFF bytes, which nothing bounds from above.
+struct PrefixRange {
+  std::string lower;
+  std::optional<std::string> upper;
+};
+
+inline PrefixRange prefixRange(const std::string& prefix) {
+  PrefixRange range{prefix, std::nullopt};
+  std::string upper = prefix;
+  while (!upper.empty()) {
+    if (static_cast<unsigned char>(upper.back()) != 0xFF) {
+      upper.back() = static_cast<char>(upper.back() + 1);
+      range.upper = std::move(upper);
+      break;
+    }
+    upper.pop_back();
+  }
+  return range;
+}
+
+// "column >= ? AND column < ?", without the upper bound if the range has
+// none
+inline std::string prefixCondition(const PrefixRange& range,
+                                   const std::string& column) {
+  std::string condition = column + " >= ?";
+  if (range.upper) {
+    condition += " AND " + column + " < ?";
+  }
+  return condition;
+}
+
+// Binds the placeholders of prefixCondition() from index on; returns the
+// next free index
+inline int bindPrefixRange(Gateways::Database::IStatement& stmt, int index,
+                           const PrefixRange& range) {
+  stmt.bind(index++, range.lower);
+  if (range.upper) {
+    stmt.bind(index++, *range.upper);
+  }
+  return index;
+}
+
+// True if key starts with prefix, byte for byte: what the range selects
+inline bool hasPrefix(const std::string& key, const std::string& prefix) {
+  return key.compare(0, prefix.size(), prefix) == 0;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_PREFIX_RANGE_H_
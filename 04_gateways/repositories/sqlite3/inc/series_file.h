@@ -0,0 +1,171 @@
+#ifndef REPOSITORIES_SERIES_FILE_H_
+#define REPOSITORIES_SERIES_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// Series File Format (version 1)
+// ============================================================
+
+// A flat file of whole series for moving data between environments and
+// for offline readers. Integers are in host byte order, which byte_order
+// records; every offset is from the start of the file and a multiple of
+// 8 where it points at an array:
+//
+//   SeriesFileHeader                      64 bytes
+//   per series: int64 timestamps[count], then double values[count]
+//   SeriesFileEntry[series_count]         by (asset id, unit id)
+//   string bytes                          ids, not NUL-terminated
+//
+// The header is written last; a file whose writer did not finish has no
+// magic and is rejected.
+inline constexpr char kSeriesFileMagic[8] = {'T', 'S', 'S', 'E',
+                                             'R', 'I', 'E', 'S'};
+inline constexpr uint32_t kSeriesFileVersion = 1;
+inline constexpr uint32_t kSeriesFileByteOrder = 0x01020304;
+
+struct SeriesFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t series_count;
+  uint64_t index_offset;
+  uint64_t strings_offset;
+  uint64_t strings_size;
+  uint64_t file_size;
+  uint64_t reserved;
+};
+static_assert(sizeof(SeriesFileHeader) == 64, "SeriesFileHeader layout");
+
+struct SeriesFileEntry {
+  uint64_t asset_offset;  // into the strings section
+  uint32_t asset_size;
+  uint32_t unit_size;
+  uint64_t unit_offset;
+  uint64_t point_count;
+  uint64_t timestamps_offset;
+  uint64_t values_offset;
+};
+static_assert(sizeof(SeriesFileEntry) == 48, "SeriesFileEntry layout");
+
+class SeriesFileException : public std::runtime_error {
+ public:
+  explicit SeriesFileException(const std::string& msg)
+      : std::runtime_error("Series file: " + msg) {}
+};
+
+// ============================================================
+// SeriesFileWriter - streams series into a file
+// ============================================================
+
+// Arrays are written as series are added, so memory holds one series at
+// a time plus the index. Throws SeriesFileException on I/O errors.
+class SeriesFileWriter {
+ public:
+  explicit SeriesFileWriter(const std::string& path);
+
+  SeriesFileWriter(const SeriesFileWriter&) = delete;
+  SeriesFileWriter& operator=(const SeriesFileWriter&) = delete;
+
+  // Throws std::invalid_argument if the arrays differ in length or the
+  // series was added before
+  void add(const std::string& asset_id, const std::string& unit_id,
+           const std::vector<int64_t>& timestamps,
+           const std::vector<double>& values);
+
+  // Writes index, strings and header; no add() afterwards
+  void finish();
+
+ private:
+  void write(const void* data, size_t size);
+
+  std::ofstream m_out;
+  uint64_t m_offset = 0;
+  std::set<std::pair<std::string, std::string>> m_added;
+  std::vector<SeriesFileEntry> m_entries;
+  std::string m_strings;
+  bool m_finished = false;
+};
+
+// ============================================================
+// MappedSeriesFile - zero-copy reader
+// ============================================================
+
+// One series in a mapped file; the pointers stay valid while the file is
+// mapped
+struct SeriesView {
+  std::string_view asset_id;
+  std::string_view unit_id;
+  const int64_t* timestamps;
+  const double* values;
+  size_t count;
+};
+
+// Maps the file read-only and checks the header and every index entry
+// against the file size up front, so views never point outside the
+// mapping. Throws SeriesFileException on unreadable or malformed files.
+class MappedSeriesFile {
+ public:
+  explicit MappedSeriesFile(const std::string& path);
+  ~MappedSeriesFile();
+
+  MappedSeriesFile(const MappedSeriesFile&) = delete;
+  MappedSeriesFile& operator=(const MappedSeriesFile&) = delete;
+  MappedSeriesFile(MappedSeriesFile&& other) noexcept;
+  MappedSeriesFile& operator=(MappedSeriesFile&& other) noexcept;
+
+  const SeriesFileHeader& header() const;
+  size_t seriesCount() const;
+  // By (asset id, unit id)
+  SeriesView series(size_t index) const;
+  // Binary search over the index
+  std::optional<SeriesView> find(std::string_view asset_id,
+                                 std::string_view unit_id) const;
+
+ private:
+  void unmap();
+  void validate() const;
+  const SeriesFileEntry& entry(size_t index) const;
+
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+// ============================================================
+// Export / Import
+// ============================================================
+
+struct SeriesFileStats {
+  size_t series = 0;
+  size_t points = 0;
+};
+
+// Every unit's points of each asset in [from_ms, to_ms], one asset read
+// at a time. Series without points are left out.
+SeriesFileStats exportSeries(TimeSeriesRepository& repository,
+                             const std::string& path,
+                             const std::vector<std::string>& asset_ids,
+                             int64_t from_ms, int64_t to_ms);
+
+// addPoints() in batches of batch_size; the assets and units must exist.
+// Points replace stored ones at the same timestamps.
+SeriesFileStats importSeries(TimeSeriesRepository& repository,
+                             const std::string& path,
+                             size_t batch_size = 10000);
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_SERIES_FILE_H_
@@ -0,0 +1,124 @@
+#ifndef REPOSITORIES_SHARD_SET_H_
+#define REPOSITORIES_SHARD_SET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "executor.h"
+#include "sqlite3_database_connector.h"
+#include "sqlite3_pool.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+struct ShardSetOptions {
+  // Database files; fixed once the directory has shards
+  size_t shards = 4;
+  // Each shard's pool: one writer connection and its readers
+  SqlitePoolOptions pool;
+  // Workers for forEach(); nullptr is Executor::shared()
+  Concurrency::Executor* executor = nullptr;
+};
+
+class ShardException : public std::runtime_error {
+ public:
+  explicit ShardException(const std::string& msg)
+      : std::runtime_error("Shard set: " + msg) {}
+};
+
+// ============================================================
+// ShardSet - one SQLite file per hash range of keys
+// ============================================================
+
+// Opens shard-<i>.db in a directory for i below options.shards, each
+// behind its own SqlitePool, so writes to different shards take
+// different write locks and run at the same time. shardOf() routes a key
+// (an asset or account id) by FNV-1a, so its shard never changes while
+// the count does not; every file records its index and the count, and
+// opening it with another count throws.
+//
+// The sharded repositories sit on top: single-key operations go straight
+// to their shard, and reads across shards run on forEach(), the caller
+// and executor workers one shard each.
+class ShardSet {
+ public:
+  // Creates the directory if needed. Throws std::invalid_argument for 0
+  // shards, ShardException for files of another layout, and
+  // ConnectionException if a file cannot be opened.
+  explicit ShardSet(const std::string& directory,
+                    const ShardSetOptions& options = {});
+
+  ShardSet(const ShardSet&) = delete;
+  ShardSet& operator=(const ShardSet&) = delete;
+
+  size_t size() const;
+  size_t shardOf(std::string_view key) const;
+  SqlitePool& shard(size_t index);
+  const std::string& path(size_t index) const;
+  const std::string& directory() const;
+
+  // Calls body(i) for every shard on the caller and up to size() - 1
+  // workers, and returns once they have. One call at a time per shard at
+  // most; workers do not see the caller's open transaction. The first
+  // exception is rethrown.
+  void forEach(const std::function<void(size_t)>& body);
+
+  // Indexes into keys grouped by shard: result[s] lists, in order, the i
+  // whose keys[i] is on shard s
+  std::vector<std::vector<size_t>> partition(
+      const std::vector<std::string>& keys) const;
+
+  // A multi-key read over forEach(): read(s, shard_keys) runs on every
+  // shard s with keys and returns one T per key of shard_keys, which is
+  // put back at that key's index in the result
+  template <typename T, typename Read>
+  std::vector<T> scatter(const std::vector<std::string>& keys, Read read);
+
+  // ATTACHes every shard file to db as <prefix><i>, for ad-hoc SQL
+  // across shards such as "SELECT ... FROM shard_0.accounts UNION ALL
+  // ...". SQLite allows 10 attached databases unless built with more.
+  void attach(SqliteDatabase& db, const std::string& prefix = "shard_") const;
+
+ private:
+  // Records the layout in a new file, or checks the one recorded
+  void checkLayout(size_t index, size_t count);
+
+  const std::string m_directory;
+  Concurrency::Executor& m_executor;
+  std::vector<std::string> m_paths;
+  std::vector<std::unique_ptr<SqlitePool>> m_pools;
+};
+
+template <typename T, typename Read>
+std::vector<T> ShardSet::scatter(const std::vector<std::string>& keys,
+                                 Read read) {
+  const auto groups = partition(keys);
+  std::vector<T> result(keys.size());
+  forEach([&](size_t s) {
+    if (groups[s].empty()) {
+      return;
+    }
+    std::vector<std::string> shard_keys;
+    shard_keys.reserve(groups[s].size());
+    for (size_t i : groups[s]) {
+      shard_keys.push_back(keys[i]);
+    }
+    auto part = read(s, shard_keys);
+    for (size_t j = 0; j < part.size(); ++j) {
+      result[groups[s][j]] = std::move(part[j]);
+    }
+  });
+  return result;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_SHARD_SET_H_
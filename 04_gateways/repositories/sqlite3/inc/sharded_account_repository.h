@@ -0,0 +1,121 @@
+#ifndef REPOSITORIES_SHARDED_ACCOUNT_REPOSITORY_H_
+#define REPOSITORIES_SHARDED_ACCOUNT_REPOSITORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "account_repository.h"
+#include "entities.h"
+#include "shard_set.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// ShardedAccountRepository - accounts hashed over a ShardSet
+// ============================================================
+
+// One AccountRepository per shard, with the same options. An account and
+// its properties live on shard shardOf(account id), so everything keyed
+// by an id goes straight to that shard; multi-account reads query the
+// shards in parallel and merge into the order one repository returns.
+//
+// Names are unique per file, so creating or renaming an account first
+// asks the other shards whether the name is taken and reports it as a
+// ConstraintException on accounts.name. Creates and renames hold one
+// mutex across that check and their write, so two threads cannot claim
+// one name on different shards; share one instance per ShardSet, as
+// another process writing the same files is not covered.
+//
+// USE_CASE and OVERRIDE come from account_repository.h.
+class ShardedAccountRepository USE_CASE {
+ public:
+  explicit ShardedAccountRepository(ShardSet& shards,
+                                    const AccountOptions& options = {});
+
+  // Every shard, in parallel
+  void initSchema();
+
+  AccountRepository& repositoryFor(const std::string& account_id);
+  AccountRepository& shard(size_t index);
+
+  // Account CRUD
+  void createAccount(const Entities::Account& account) OVERRIDE;
+  Entities::AccountConflict tryCreateAccount(
+      const Entities::Account& account) OVERRIDE;
+  // Checked as a whole first, then one transaction per shard, the shards
+  // in parallel: all or nothing per shard, not overall
+  void createAccounts(const std::vector<Entities::Account>& accounts)
+      OVERRIDE;
+  std::vector<Entities::AccountConflict> findAccountConflicts(
+      const std::vector<Entities::Account>& accounts) OVERRIDE;
+  std::optional<Entities::Account> getAccount(const std::string& id) OVERRIDE;
+  std::optional<Entities::Account> getAccountByName(
+      const std::string& name) OVERRIDE;
+  // Ordered by name
+  std::vector<Entities::Account> getAllAccounts() OVERRIDE;
+  // A page from every shard, merged by name and cut to limit
+  std::vector<Entities::AccountSummary> listAccounts(
+      const std::optional<std::string>& after_name, size_t limit) OVERRIDE;
+  std::vector<std::optional<Entities::Account>> getAccounts(
+      const std::vector<std::string>& ids);
+  void updateAccount(const Entities::Account& account) OVERRIDE;
+  void deleteAccount(const std::string& id) OVERRIDE;
+
+  bool accountExists(const std::string& id) OVERRIDE;
+  bool accountExistsByName(const std::string& name) OVERRIDE;
+
+  // Account Property CRUD, on the account's shard
+  void setProperty(
+      const std::string& account_id, const std::string& key,
+      const std::string& value,
+      const std::optional<std::string>& description = std::nullopt) OVERRIDE;
+  void setProperty(const Entities::AccountProperty& property) OVERRIDE;
+
+  std::optional<Entities::AccountProperty> getProperty(
+      const std::string& account_id, const std::string& key) OVERRIDE;
+  std::optional<std::string> getPropertyValue(const std::string& account_id,
+                                              const std::string& key) OVERRIDE;
+
+  std::vector<Entities::AccountProperty> getProperties(
+      const std::string& account_id) OVERRIDE;
+  std::vector<Entities::AccountProperty> getPropertiesByPrefix(
+      const std::string& account_id, const std::string& prefix) OVERRIDE;
+  std::vector<Entities::AccountProperty> listProperties(
+      const std::string& account_id,
+      const std::optional<std::string>& after_key, size_t limit) OVERRIDE;
+
+  std::vector<std::vector<Entities::AccountProperty>> getPropertiesForAccounts(
+      const std::vector<std::string>& account_ids) OVERRIDE;
+  std::vector<Entities::AccountWithProperties> getAccountsWithProperties(
+      const std::optional<std::string>& after_name, size_t limit) OVERRIDE;
+
+  bool propertyExists(const std::string& account_id,
+                      const std::string& key) OVERRIDE;
+  void removeProperty(const std::string& account_id,
+                      const std::string& key) OVERRIDE;
+  void removePropertiesByPrefix(const std::string& account_id,
+                                const std::string& prefix) OVERRIDE;
+  void clearProperties(const std::string& account_id) OVERRIDE;
+
+  // Count
+  int64_t countAccounts() OVERRIDE;
+  int64_t countProperties(const std::string& account_id) OVERRIDE;
+
+ private:
+  // Whether a shard other than except holds an account named name
+  bool nameTakenElsewhere(const std::string& name, size_t except);
+
+  ShardSet& m_shards;
+  std::vector<std::unique_ptr<AccountRepository>> m_repositories;
+  // Held from the name check to the write it guards
+  std::mutex m_namesMutex;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_SHARDED_ACCOUNT_REPOSITORY_H_
@@ -0,0 +1,120 @@
+#ifndef REPOSITORIES_SHARDED_TIMESERIES_REPOSITORY_H_
+#define REPOSITORIES_SHARDED_TIMESERIES_REPOSITORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+#include "shard_set.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// ShardedTimeSeriesRepository - assets hashed over a ShardSet
+// ============================================================
+
+// One TimeSeriesRepository per shard, with the same options. An asset,
+// its points and its latest points live on shard shardOf(asset id), so
+// asset and point operations go straight to that shard's repository.
+// addPoints() splits a batch by shard and writes the parts at the same
+// time, each on its shard's writer connection.
+//
+// Units and conversions are replicated: writes go to every shard, so any
+// shard's points and SQL functions can use them, and reads come from
+// shard 0. A replicated write is not atomic across shards; the first
+// failure is rethrown once every shard has been tried.
+//
+// getAllAssets() and the multi-asset reads query the shards in parallel
+// and merge the results into the order one repository returns. Everything
+// else (cursors, aggregates, listeners, the caches built on a repository)
+// is reached per shard through repositoryFor() and shard().
+class ShardedTimeSeriesRepository {
+ public:
+  explicit ShardedTimeSeriesRepository(ShardSet& shards,
+                                       const TimeSeriesOptions& options = {});
+
+  // Every shard, in parallel
+  void initSchema();
+
+  TimeSeriesRepository& repositoryFor(const std::string& asset_id);
+  TimeSeriesRepository& shard(size_t index);
+  size_t shardCount() const;
+
+  // Asset CRUD. getAllAssets() is ordered by name, then id.
+  void createAsset(const Entities::Asset& asset);
+  std::optional<Entities::Asset> getAsset(const std::string& id);
+  std::vector<Entities::Asset> getAllAssets();
+  std::vector<std::optional<Entities::Asset>> getAssets(
+      const std::vector<std::string>& ids);
+  void updateAsset(const Entities::Asset& asset);
+  void deleteAsset(const std::string& id);
+
+  // Unit and conversion CRUD, replicated
+  void createUnit(const Entities::Unit& unit);
+  std::optional<Entities::Unit> getUnit(const std::string& id);
+  std::vector<Entities::Unit> getAllUnits();
+  void updateUnit(const Entities::Unit& unit);
+  void deleteUnit(const std::string& id);
+  void createConversion(const Entities::UnitConversion& conversion);
+  std::optional<Entities::UnitConversion> getConversion(
+      const std::string& from_unit_id, const std::string& to_unit_id);
+  std::vector<Entities::UnitConversion> getConversionsFrom(
+      const std::string& from_unit_id);
+  std::vector<Entities::UnitConversion> getAllConversions();
+  void updateConversion(const Entities::UnitConversion& conversion);
+  void deleteConversion(const std::string& from_unit_id,
+                        const std::string& to_unit_id);
+
+  // Points. addPoints() is one transaction per shard, not one overall.
+  void addPoint(const Entities::TimeSeriesPoint& point);
+  void addPoints(const std::vector<Entities::TimeSeriesPoint>& points);
+  std::vector<Entities::TimeSeriesPoint> getPoints(const std::string& asset_id,
+                                                   int64_t from_ms,
+                                                   int64_t to_ms);
+  std::vector<Entities::TimeSeriesPoint> getPoints(const std::string& asset_id,
+                                                   const std::string& unit_id,
+                                                   int64_t from_ms,
+                                                   int64_t to_ms);
+  // result[i] is getPoints(asset_ids[i], from_ms, to_ms); one
+  // getPointsMulti() per shard, the shards in parallel
+  std::vector<std::vector<Entities::TimeSeriesPoint>> getPointsMulti(
+      const std::vector<std::string>& asset_ids, int64_t from_ms,
+      int64_t to_ms);
+  // TimeSeriesRepository::getPointsMerged() over the shards: ordered by
+  // timestamp, ties in the order of asset_ids, then of units
+  std::vector<Entities::TimeSeriesPoint> getPointsMerged(
+      const std::vector<std::string>& asset_ids, int64_t from_ms,
+      int64_t to_ms);
+
+  std::optional<Entities::TimeSeriesPoint> getLatestPoint(
+      const std::string& asset_id);
+  std::optional<Entities::TimeSeriesPoint> getLatestPoint(
+      const std::string& asset_id, const std::string& unit_id);
+  // result[i] is for asset_ids[i]; the shards in parallel
+  std::vector<std::optional<Entities::TimeSeriesPoint>> getLatestPoints(
+      const std::vector<std::string>& asset_ids);
+  std::vector<std::optional<Entities::TimeSeriesPoint>> getLatestPoints(
+      const std::vector<std::string>& asset_ids, const std::string& unit_id);
+
+  void deletePoints(const std::string& asset_id, int64_t from_ms,
+                    int64_t to_ms);
+  void deleteAllPoints(const std::string& asset_id);
+
+ private:
+  // write(repository) on every shard; the first failure is rethrown
+  // after the rest
+  template <typename Write>
+  void replicate(Write write);
+
+  ShardSet& m_shards;
+  std::vector<std::unique_ptr<TimeSeriesRepository>> m_repositories;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_SHARDED_TIMESERIES_REPOSITORY_H_
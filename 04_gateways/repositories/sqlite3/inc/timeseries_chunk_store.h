@@ -0,0 +1,70 @@
+#ifndef REPOSITORIES_TIMESERIES_CHUNK_STORE_H_
+#define REPOSITORIES_TIMESERIES_CHUNK_STORE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "database_connector.h"
+#include "gorilla_codec.h"
+#include "point_store.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+// ============================================================
+// TimeSeriesChunkStore - Gorilla-compressed point storage
+// ============================================================
+
+// One timeseries_chunks row holds every point of one (asset_key, unit_key)
+// series whose timestamp falls in [chunk_start, chunk_start + width), as a
+// gorillaEncode() blob. Reads select and decode only the chunks that
+// overlap the requested range. Writes decode the chunks they touch, merge
+// the new points (replacing equal timestamps) and re-encode, so batch
+// writes are much cheaper per point than single ones.
+//
+// The chunk width is recorded when the table is created; later opens use
+// the recorded width whatever they ask for.
+class TimeSeriesChunkStore : public IPointStore {
+ public:
+  TimeSeriesChunkStore(IDatabase& db, std::chrono::milliseconds chunk_width);
+
+  void initSchema() override;
+
+  std::chrono::milliseconds chunkWidth() const {
+    return std::chrono::milliseconds(m_chunkMs);
+  }
+
+  void write(const std::vector<SeriesPoint>& points) override;
+
+  // Only one decoded chunk is held at a time while scanning a series
+  std::vector<GorillaSample> read(int64_t asset_key, int64_t unit_key,
+                                  int64_t from_ms, int64_t to_ms) override;
+  void scan(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+            int64_t to_ms, const SampleCallback& callback) override;
+  std::vector<SeriesPoint> read(int64_t asset_key, int64_t from_ms,
+                                int64_t to_ms) override;
+  // Streams one chunk window (every unit's chunk with the same
+  // chunk_start) at a time
+  void scan(int64_t asset_key, int64_t from_ms, int64_t to_ms,
+            const SeriesCallback& callback) override;
+
+  std::optional<GorillaSample> latest(int64_t asset_key,
+                                      int64_t unit_key) override;
+  std::optional<SeriesPoint> latest(int64_t asset_key) override;
+
+  void erase(int64_t asset_key, int64_t from_ms, int64_t to_ms) override;
+  void eraseAll(int64_t asset_key) override;
+
+ private:
+  int64_t chunkStart(int64_t timestamp_ms) const;
+
+  IDatabase& m_db;
+  int64_t m_chunkMs;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_TIMESERIES_CHUNK_STORE_H_
@@ -0,0 +1,129 @@
+#ifndef REPOSITORIES_TIMESERIES_HOT_CACHE_H_
+#define REPOSITORIES_TIMESERIES_HOT_CACHE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "database_connector.h"
+#include "entities.h"
+#include "sqlite3_database_connector.h"
+#include "sqlite3_pool.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+struct HotCacheOptions {
+  // The horizon trails the newest timestamp seen by span: points at or
+  // after it are kept in memory
+  std::chrono::milliseconds span{std::chrono::hours(1)};
+};
+
+struct HotCacheStats {
+  uint64_t points = 0;  // in memory now
+  uint64_t series = 0;
+  uint64_t evicted = 0;  // dropped as the horizon moved past them
+  uint64_t ignored = 0;  // written before the horizon, so disk only
+  int64_t horizon = std::numeric_limits<int64_t>::min();
+};
+
+// A select() filter; unset ids match every asset or unit
+struct HotSeriesFilter {
+  std::optional<std::string> asset_id;
+  std::optional<std::string> unit_id;
+  int64_t from_ms = std::numeric_limits<int64_t>::min();
+  int64_t to_ms = std::numeric_limits<int64_t>::max();
+};
+
+// ============================================================
+// HotSeriesCache - the newest points of every series in memory
+// ============================================================
+
+// Registers an ingest listener on the repository, like
+// TimeSeriesIndicators, and keeps every point at or after horizon() in
+// memory: the construction loads them back from storage, and each batch
+// addPoint()/addPoints() writes is applied after it, moving the horizon
+// and evicting what falls behind it. A point written before the horizon
+// stays on disk only, so the cache always holds exactly the stored
+// points in [horizon(), newest].
+//
+// deletePoints(), retention and writes made without the repository (or
+// undone by rolling back an enclosing transaction) do not reach the
+// listener; reload() after them, as with invalidateLatestCache().
+// Thread-safe; ingest waits while reload() runs.
+class HotSeriesCache {
+ public:
+  explicit HotSeriesCache(TimeSeriesRepository& repository,
+                          const HotCacheOptions& options = {});
+  // Removes the listener
+  ~HotSeriesCache();
+
+  HotSeriesCache(const HotSeriesCache&) = delete;
+  HotSeriesCache& operator=(const HotSeriesCache&) = delete;
+
+  // Drops everything and reads the points past the horizon of the
+  // newest stored point again, one getPoints() per asset
+  void reload();
+
+  int64_t horizon() const;
+  // Matching points ordered by asset, unit, then timestamp
+  std::vector<Entities::TimeSeriesPoint> select(
+      const HotSeriesFilter& filter) const;
+  HotCacheStats stats() const;
+
+ private:
+  using SeriesKey = std::pair<std::string, std::string>;  // asset, unit
+
+  void onIngest(const std::vector<Entities::TimeSeriesPoint>& points);
+  // Callers hold m_mutex
+  void advance(int64_t newest_ms);
+  void insert(const Entities::TimeSeriesPoint& point);
+
+  TimeSeriesRepository& m_repository;
+  const HotCacheOptions m_options;
+
+  mutable std::mutex m_mutex;
+  std::map<SeriesKey, std::map<int64_t, double>> m_series;
+  std::optional<int64_t> m_newest;
+  HotCacheStats m_stats;
+
+  size_t m_listener = 0;
+};
+
+// ============================================================
+// SQL Access
+// ============================================================
+
+// Registers, on every connection of db, the virtual table `name` over
+// the cache, with the columns of the `timeseries` view (asset_id,
+// timestamp_ms, unit_id, value), and name_horizon(), the cache's current
+// horizon. Equality on asset_id and unit_id and ranges on timestamp_ms
+// are applied inside the scan, which copies the matching points out
+// under the cache's lock and never reads the database.
+void registerHotSeriesTable(SqliteDatabase& db, HotSeriesCache& cache,
+                            const std::string& name = "timeseries_hot");
+void registerHotSeriesTable(SqlitePool& db, HotSeriesCache& cache,
+                            const std::string& name = "timeseries_hot");
+
+// View `view` (created if missing) with every point: the hot table's,
+// UNION ALL the `timeseries` view's before the horizon, so each point
+// comes from one side and WHERE terms on the view reach both. Rows
+// storage only, since the other layouts leave `timeseries` empty. A
+// horizon that moves while a query runs can report a point crossing it
+// twice.
+void createHotSeriesView(IDatabase& db,
+                         const std::string& view = "timeseries_all",
+                         const std::string& hot_table = "timeseries_hot");
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_TIMESERIES_HOT_CACHE_H_
@@ -0,0 +1,193 @@
+#ifndef REPOSITORIES_TIMESERIES_INDICATORS_H_
+#define REPOSITORIES_TIMESERIES_INDICATORS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "database_connector.h"
+#include "ring_buffer.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+enum class IndicatorKind {
+  Sma,         // mean of the last window values
+  Ema,         // exponential, alpha = 2 / (window + 1)
+  Volatility,  // sample standard deviation of the last window returns
+  Vwap,        // mean of the last window values weighted by a second unit
+};
+
+// ============================================================
+// RollingIndicator - one windowed calculator
+// ============================================================
+
+// Each update() is O(1) and allocates nothing: running sums over a ring
+// of the window, allocated once at construction, with the sums
+// recomputed from the window once per window of evictions so rounding
+// does not build up.
+class RollingIndicator {
+ public:
+  // Throws std::invalid_argument if window is 0, or 1 for Volatility
+  RollingIndicator(IndicatorKind kind, size_t window);
+
+  // weight is used by Vwap only. Volatility takes the simple return
+  // against the previous value and skips it after a zero.
+  void update(double value, double weight = 1.0);
+
+  // nullopt until a value can be computed: the first update (two returns
+  // for Volatility, a non-zero weight for Vwap)
+  std::optional<double> value() const;
+  // Window filled; an Ema has seen window updates
+  bool ready() const;
+  uint64_t samples() const { return m_samples; }
+
+  // Round trip through restoreState() on any host with the same byte
+  // order. restoreState() throws std::invalid_argument if the state is
+  // malformed or from another kind or window.
+  std::vector<uint8_t> saveState() const;
+  void restoreState(BlobView state);
+
+ private:
+  void push(double value, double weight);
+  void recompute();
+
+  IndicatorKind m_kind;
+  size_t m_window;
+  uint64_t m_samples = 0;
+
+  // (value, weight); returns for Volatility. Unused by Ema.
+  Containers::RingBuffer<std::pair<double, double>> m_ring;
+  double m_sum = 0.0;  // of value * weight
+  double m_sumSquares = 0.0;
+  double m_weightSum = 0.0;
+  size_t m_evictions = 0;  // since the last recompute()
+
+  double m_ema = 0.0;
+  std::optional<double> m_previous;  // Volatility
+};
+
+// ============================================================
+// TimeSeriesIndicators - indicators kept current on ingest
+// ============================================================
+
+struct IndicatorSpec {
+  std::string name;  // unique
+  std::string asset_id;
+  std::string unit_id;
+  IndicatorKind kind = IndicatorKind::Sma;
+  size_t window = 20;
+  // Vwap only: each value is weighted by this unit's latest value of the
+  // same asset at or before its timestamp
+  std::string weight_unit_id;
+};
+
+struct IndicatorValue {
+  double value = 0.0;
+  int64_t timestamp_ms = 0;  // of the newest point folded in
+  uint64_t samples = 0;
+  bool ready = false;
+};
+
+struct IndicatorOptions {
+  // Updates of an indicator between automatic checkpoints; 0 leaves
+  // checkpointing to checkpoint()
+  size_t checkpointEvery = 1000;
+};
+
+struct IndicatorStats {
+  uint64_t updates = 0;   // points folded in on ingest
+  uint64_t skipped = 0;   // not newer than the indicator's last point
+  uint64_t replayed = 0;  // points read back from storage by add()
+  uint64_t checkpoints = 0;
+  uint64_t checkpointFailures = 0;  // automatic ones; the points stay
+};
+
+// Registers an ingest listener on the repository, so every point written
+// through addPoint()/addPoints() updates the indicators of its series in
+// O(1), and value() reads the current result from memory. Indicators
+// only move forward: a point not newer than the last one an indicator
+// folded in (a late or replaced point) is skipped, and deleting points
+// does not undo them; remove() and add() again to rebuild.
+//
+// State is checkpointed to timeseries_indicators with the timestamp it
+// covers. add() restores a checkpoint of the same spec and replays just
+// the points after it from storage, through SeriesCursor pages; without
+// one it replays the series' whole history. Ingest waits while add()
+// replays. Thread-safe.
+class TimeSeriesIndicators {
+ public:
+  TimeSeriesIndicators(IDatabase& db, TimeSeriesRepository& repository,
+                       const IndicatorOptions& options = {});
+  // Removes the listener; does not checkpoint
+  ~TimeSeriesIndicators();
+
+  TimeSeriesIndicators(const TimeSeriesIndicators&) = delete;
+  TimeSeriesIndicators& operator=(const TimeSeriesIndicators&) = delete;
+
+  void initSchema();
+
+  // Throws std::invalid_argument if the name is taken, the window is bad
+  // for the kind, or a Vwap has no weight unit
+  void add(const IndicatorSpec& spec);
+  // Drops the indicator and its checkpoint; false if unknown
+  bool remove(const std::string& name);
+
+  // nullopt for unknown names and indicators without a value yet
+  std::optional<IndicatorValue> value(const std::string& name) const;
+  std::vector<IndicatorSpec> specs() const;
+
+  // Saves every indicator with updates since its last checkpoint
+  void checkpoint();
+
+  IndicatorStats stats() const;
+
+ private:
+  struct Entry {
+    explicit Entry(const IndicatorSpec& spec)
+        : spec(spec), indicator(spec.kind, spec.window) {}
+
+    IndicatorSpec spec;
+    RollingIndicator indicator;
+    std::optional<int64_t> lastTimestamp;
+    // Vwap: as-of weight
+    std::optional<int64_t> weightTimestamp;
+    std::optional<double> weight;
+    size_t sinceCheckpoint = 0;
+  };
+
+  void onIngest(const std::vector<Entities::TimeSeriesPoint>& points);
+  // Folds in one point of the entry's value unit, or of its weight unit;
+  // false if it was skipped
+  bool apply(Entry& entry, bool weight, int64_t timestamp_ms, double value);
+  // Loads a checkpoint of the same spec; false if there is none
+  bool restore(Entry& entry);
+  // Points after the entry's timestamps, value and weight series merged
+  size_t replay(Entry& entry);
+  void save(Entry& entry);
+
+  IDatabase& m_db;
+  TimeSeriesRepository& m_repository;
+  const IndicatorOptions m_options;
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, std::unique_ptr<Entry>> m_entries;
+  // (asset id, unit id) -> entries reading that series
+  std::map<std::pair<std::string, std::string>, std::vector<Entry*>>
+      m_bySeries;
+  IndicatorStats m_stats;
+
+  size_t m_listener = 0;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_TIMESERIES_INDICATORS_H_
@@ -0,0 +1,85 @@
+#ifndef REPOSITORIES_TIMESERIES_PARTITION_STORE_H_
+#define REPOSITORIES_TIMESERIES_PARTITION_STORE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "database_connector.h"
+#include "point_store.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+// UTC calendar span of one partition
+enum class PartitionPeriod { Day, Month, Year };
+
+// One partition table, covering timestamps in [start_ms, end_ms)
+struct TimePartition {
+  int64_t start_ms;
+  int64_t end_ms;
+  std::string table;
+};
+
+// ============================================================
+// TimeSeriesPartitionStore - time-partitioned point tables
+// ============================================================
+
+// Points of each partition period live in their own table, shaped like
+// timeseries_points (e.g. timeseries_points_202401 for January 2024 when
+// monthly), created by the first write into the period and listed in
+// timeseries_partitions. Reads and range deletes only touch the tables
+// whose period overlaps the range, so their cost follows the range rather
+// than the history; dropBefore() expires whole periods with DROP TABLE.
+//
+// The period is recorded when the registry is created; later opens use
+// the recorded period whatever they ask for.
+class TimeSeriesPartitionStore : public IPointStore {
+ public:
+  TimeSeriesPartitionStore(IDatabase& db, PartitionPeriod period);
+
+  void initSchema() override;
+
+  PartitionPeriod period() const { return m_period; }
+
+  void write(const std::vector<SeriesPoint>& points) override;
+
+  std::vector<GorillaSample> read(int64_t asset_key, int64_t unit_key,
+                                  int64_t from_ms, int64_t to_ms) override;
+  void scan(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+            int64_t to_ms, const SampleCallback& callback) override;
+  std::vector<SeriesPoint> read(int64_t asset_key, int64_t from_ms,
+                                int64_t to_ms) override;
+  // Pages through each partition, so no statement is open during callback
+  void scan(int64_t asset_key, int64_t from_ms, int64_t to_ms,
+            const SeriesCallback& callback) override;
+
+  // Search partitions newest first
+  std::optional<GorillaSample> latest(int64_t asset_key,
+                                      int64_t unit_key) override;
+  std::optional<SeriesPoint> latest(int64_t asset_key) override;
+
+  void erase(int64_t asset_key, int64_t from_ms, int64_t to_ms) override;
+  void eraseAll(int64_t asset_key) override;
+
+  // By start_ms
+  std::vector<TimePartition> partitions();
+  // Drops every partition that ends at or before cutoff_ms; returns how
+  // many were dropped
+  size_t dropBefore(int64_t cutoff_ms);
+
+ private:
+  // Partitions overlapping [from_ms, to_ms], oldest first
+  std::vector<TimePartition> overlapping(int64_t from_ms, int64_t to_ms);
+  // Table for the partition holding timestamp_ms, created if missing
+  std::string partitionFor(int64_t timestamp_ms);
+
+  IDatabase& m_db;
+  PartitionPeriod m_period;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_TIMESERIES_PARTITION_STORE_H_
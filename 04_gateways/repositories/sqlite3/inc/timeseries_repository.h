@@ -1,27 +1,146 @@
 #ifndef REPOSITORIES_TIMESERIES_REPOSITORY_H_
 #define REPOSITORIES_TIMESERIES_REPOSITORY_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "database_connector.h"
 #include "entities.h"
+#include "executor.h"
+#include "point_cache.h"
+#include "timeseries_chunk_store.h"
+#include "timeseries_partition_store.h"
+#include "unit_conversion_graph.h"
+
 namespace Gateways::Repositories::Sqlite3 {
 
 using namespace Gateways::Database;
 
+enum class PointStorage {
+  Rows,    // one row per point in timeseries_points
+  Chunks,      // Gorilla-compressed blocks in timeseries_chunks
+  Partitions,  // one timeseries_points_<period> table per time period
+};
+
+struct TimeSeriesOptions {
+  PointStorage storage = PointStorage::Rows;
+  // Time span of one compressed block (Chunks only); fixed once the
+  // chunk table exists
+  std::chrono::milliseconds chunkWidth{std::chrono::hours(1)};
+  // Span of one partition table (Partitions only); fixed once the
+  // partition registry exists
+  PartitionPeriod partitionPeriod = PartitionPeriod::Month;
+  // Threads for getPointsMulti(), the caller's and executor workers.
+  // Above 1 only with an IDatabase that can prepare statements on several
+  // threads at once, such as SqlitePool, whose reader connections then
+  // run the queries in parallel
+  size_t readThreads = 1;
+  // Where those workers come from; nullptr is Executor::shared()
+  Concurrency::Executor* executor = nullptr;
+  // Rows storage: append points past their series' newest timestamp with
+  // a plain INSERT, see addPoints()
+  bool appendIngest = false;
+  // Read cache of the newest points of each (asset, unit) series, see
+  // getPoints(): the memory of all its timestamp and value arrays, and
+  // the points one series keeps. 0 bytes disables it.
+  size_t pointCacheBytes = 0;
+  size_t pointCacheSeriesPoints = 8192;
+};
+
+// Points written by addPoint()/addPoints() since construction
+struct IngestStats {
+  uint64_t appended = 0;  // plain INSERT past the high-water mark
+  uint64_t upserted = 0;  // INSERT OR REPLACE
+};
+
+// One bucket of aggregate(): points with timestamp_ms in
+// [bucket_start_ms, bucket_start_ms + bucket_ms). high and low are the
+// bucket's max and min.
+struct PointBucket {
+  int64_t bucket_start_ms = 0;
+  double open = 0.0;
+  double high = 0.0;
+  double low = 0.0;
+  double close = 0.0;
+  double avg = 0.0;
+  int64_t count = 0;
+};
+
+class TimeSeriesRepository;
+
+// Pull cursor over one series from openSeriesCursor(): next() yields the
+// points in timestamp order and returns false after the last. Points are
+// read a page at a time, each page a short query (or store scan) that
+// starts after the previous one's last timestamp, so memory stays at a
+// page and writes between pages are seen by the pages after them. Not
+// thread-safe; must not outlive its repository.
+class SeriesCursor {
+ public:
+  bool next(int64_t& timestamp_ms, double& value);
+
+ private:
+  friend class TimeSeriesRepository;
+  SeriesCursor(TimeSeriesRepository& repository, int64_t asset_key,
+               int64_t unit_key, int64_t from_ms, int64_t to_ms,
+               size_t page_size);
+
+  TimeSeriesRepository* m_repository;
+  int64_t m_assetKey;
+  int64_t m_unitKey;
+  int64_t m_from;  // start of the next page
+  int64_t m_to;
+  size_t m_pageSize;
+  std::vector<GorillaSample> m_page;
+  size_t m_pos = 0;
+  bool m_done = false;
+};
+
+// Points are stored in timeseries_points, a WITHOUT ROWID table clustered
+// on (asset_key, unit_key, timestamp_ms). The integer keys come from
+// asset_keys / unit_keys, which createAsset() and createUnit() fill in the
+// same transaction as the entity row. A key is a 63-bit hash of the id, so
+// resolving it never touches the database and cannot go stale across a
+// rollback; only the reverse unit lookup is cached. The read-only view
+// `timeseries` keeps the old string-keyed shape for ad-hoc SQL.
+//
+// With PointStorage::Chunks the point methods read and write
+// TimeSeriesChunkStore instead: under a byte per point for a slowly moving
+// gauge at a fixed interval, around 7 for full-precision noise, against a
+// row of 40+ bytes. With PointStorage::Partitions they go through
+// TimeSeriesPartitionStore: row tables per calendar period, so range reads
+// and deletes stay proportional to the range and dropPartitionsBefore()
+// expires history without a DELETE. In both cases the view,
+// timeseries_points and timeseries_latest are unused; points are not moved
+// between layouts.
 class TimeSeriesRepository {
  public:
-  explicit TimeSeriesRepository(IDatabase& db);
+  explicit TimeSeriesRepository(IDatabase& db,
+                                const TimeSeriesOptions& options = {});
 
-  // Schema management
+  // Schema management, versioned as "timeseries" with migrateSchema():
+  // a current schema is left alone, so startup costs a few reads. The
+  // first migration moves a string-keyed `timeseries` table from older
+  // schemas into timeseries_points and assigns keys to assets and units
+  // inserted without the repository.
   void initSchema();
 
   // Asset CRUD
   void createAsset(const Entities::Asset& asset);
   std::optional<Entities::Asset> getAsset(const std::string& id);
   std::vector<Entities::Asset> getAllAssets();
+  // Multi-get in one statement; result[i] is the asset for ids[i]
+  std::vector<std::optional<Entities::Asset>> getAssets(
+      const std::vector<std::string>& ids);
   void updateAsset(const Entities::Asset& asset);
   void deleteAsset(const std::string& id);
 
@@ -43,33 +162,273 @@ class TimeSeriesRepository {
   void deleteConversion(const std::string& from_unit_id,
                         const std::string& to_unit_id);
 
-  // Time Series Point CRUD
+  // Time Series Point CRUD. A point replaces any other of its series at
+  // the same timestamp. With options.appendIngest in Rows storage, a batch
+  // is sorted by series and time, and each point newer than everything
+  // stored for its series (the high-water mark, read through the latest
+  // cache and timeseries_latest) is appended without a conflict check;
+  // the rest go through INSERT OR REPLACE. ingestStats() counts both.
   void addPoint(const Entities::TimeSeriesPoint& point);
   void addPoints(const std::vector<Entities::TimeSeriesPoint>& points);
+  IngestStats ingestStats() const;
+
+  // Ingest listeners see every batch addPoint()/addPoints() wrote, as
+  // passed, on the writing thread once the write has succeeded. Calls are
+  // serialized and made under a lock that removeIngestListener() takes,
+  // so a removed listener is never called again; listeners must not add
+  // or remove listeners themselves. TimeSeriesIndicators registers one.
+  using IngestListener =
+      std::function<void(const std::vector<Entities::TimeSeriesPoint>&)>;
+  size_t addIngestListener(IngestListener listener);
+  void removeIngestListener(size_t id);
 
   std::vector<Entities::TimeSeriesPoint> getPoints(const std::string& asset_id,
                                                    int64_t from_ms,
                                                    int64_t to_ms);
+  // With options.pointCacheBytes set, a range of one series that starts
+  // inside the series' cached window is copied out of the PointCache
+  // without a query. A read that reaches the series' newest point seeds
+  // the cache with its newest pointCacheSeriesPoints points, which
+  // addPoint()/addPoints() then keep current; deletes and
+  // invalidateLatestCache() drop them. getPointColumns() reads the same
+  // cache.
   std::vector<Entities::TimeSeriesPoint> getPoints(const std::string& asset_id,
                                                    const std::string& unit_id,
                                                    int64_t from_ms,
                                                    int64_t to_ms);
+  PointCacheStats pointCacheStats() const;
+
+  // getPoints() in the compact form: the asset id once, and each point's
+  // unit id inline, so reading a range allocates per call, not per point.
+  // Throws std::length_error for a unit id longer than UnitCode holds.
+  Entities::CompactSeries getCompactPoints(const std::string& asset_id,
+                                           int64_t from_ms, int64_t to_ms);
 
+  // Multi-asset range read: result[i] is getPoints(asset_ids[i], from_ms,
+  // to_ms). With options.readThreads above 1 the assets are shared out
+  // between the caller and executor workers, up to that many threads,
+  // each query on its own pooled connection. Workers do not see the
+  // caller's open transaction, so call it outside one. The first failure
+  // is rethrown once the others have stopped.
+  std::vector<std::vector<Entities::TimeSeriesPoint>> getPointsMulti(
+      const std::vector<std::string>& asset_ids, int64_t from_ms,
+      int64_t to_ms);
+  // The same points k-way merged into one series ordered by timestamp;
+  // ties keep the order of asset_ids, then of units
+  std::vector<Entities::TimeSeriesPoint> getPointsMerged(
+      const std::vector<std::string>& asset_ids, int64_t from_ms,
+      int64_t to_ms);
+
+  // Streaming getPoints() for exports: the same points, in the same order,
+  // handed to visitor in batches of at most batch_size. Rows storage pages
+  // with keyset pagination on (timestamp_ms, unit_key), one short query
+  // per batch, and Partitions storage does the same per partition;
+  // Chunks storage decodes one chunk window at a time. Memory stays at a
+  // batch (or window) whatever the range. visitor returns false
+  // to stop. Returns the number of points visited; throws
+  // std::invalid_argument if batch_size is 0.
+  using PointBatchVisitor =
+      std::function<bool(const std::vector<Entities::TimeSeriesPoint>&)>;
+  size_t scanPoints(const std::string& asset_id, int64_t from_ms,
+                    int64_t to_ms, const PointBatchVisitor& visitor,
+                    size_t batch_size = 1000);
+
+  // Columnar read for analytics: columns[0] is timestamp_ms (Int64),
+  // columns[1] is value (Double), ordered by timestamp
+  ColumnarResult getPointColumns(const std::string& asset_id,
+                                 const std::string& unit_id, int64_t from_ms,
+                                 int64_t to_ms);
+
+  // Streaming read of one series in [from_ms, to_ms], page_size points
+  // per query; the shape Analytics::align() consumes. Throws
+  // std::invalid_argument if page_size is 0.
+  SeriesCursor openSeriesCursor(const std::string& asset_id,
+                                const std::string& unit_id, int64_t from_ms,
+                                int64_t to_ms, size_t page_size = 1024);
+
+  // Downsampling: one PointBucket per non-empty bucket in [from_ms, to_ms],
+  // by bucket start. Buckets are aligned to multiples of bucket_ms from
+  // the epoch and computed in one pass over the cursor, so only the
+  // buckets are materialized. Throws std::invalid_argument if bucket_ms
+  // is not positive.
+  std::vector<PointBucket> aggregate(const std::string& asset_id,
+                                     const std::string& unit_id,
+                                     int64_t from_ms, int64_t to_ms,
+                                     int64_t bucket_ms);
+
+  // Computed inside SQLite by the functions registerTimeSeriesFunctions()
+  // adds to the repository's database, so only results leave the query.
+  // Rows storage only; they throw std::logic_error otherwise, and
+  // QueryException if the functions are not registered.
+  //
+  // Every point of asset_id in [from_ms, to_ms] whose unit converts to
+  // to_unit_id, converted, ordered by timestamp then unit
+  std::vector<Entities::TimeSeriesPoint> getPointsIn(
+      const std::string& asset_id, const std::string& to_unit_id,
+      int64_t from_ms, int64_t to_ms);
+  // One point per stored point: ema(value, window) up to and including it
+  std::vector<Entities::TimeSeriesPoint> getEma(const std::string& asset_id,
+                                                const std::string& unit_id,
+                                                int64_t from_ms, int64_t to_ms,
+                                                size_t window);
+  // stddev() of the range; nullopt under two points
+  std::optional<double> getStddev(const std::string& asset_id,
+                                  const std::string& unit_id, int64_t from_ms,
+                                  int64_t to_ms);
+  // vwap() of the range, each value weighted by the asset's point in
+  // weight_unit_id at the same timestamp (points without one are left
+  // out); nullopt if the weights sum to zero
+  std::optional<double> getVwap(const std::string& asset_id,
+                                const std::string& unit_id,
+                                const std::string& weight_unit_id,
+                                int64_t from_ms, int64_t to_ms);
+
+  // Latest points. In Rows storage they are read from timeseries_latest,
+  // one row per series that addPoint()/addPoints() upsert in the same
+  // transaction and a delete trigger on timeseries_points repairs, so no
+  // lookup scans points. Per-series results are also cached in process
+  // (both storages); every repository write keeps the cache current.
   std::optional<Entities::TimeSeriesPoint> getLatestPoint(
       const std::string& asset_id);
   std::optional<Entities::TimeSeriesPoint> getLatestPoint(
       const std::string& asset_id, const std::string& unit_id);
+  // Latest point of each asset, cache misses in one statement; result[i] is
+  // for asset_ids[i]
+  std::vector<std::optional<Entities::TimeSeriesPoint>> getLatestPoints(
+      const std::vector<std::string>& asset_ids, const std::string& unit_id);
+  // getLatestPoint(asset_id) of each asset, in one statement in Rows
+  // storage; result[i] is for asset_ids[i]
+  std::vector<std::optional<Entities::TimeSeriesPoint>> getLatestPoints(
+      const std::vector<std::string>& asset_ids);
+  // For points written without the repository; also drops the point
+  // cache. Writes inside an enclosing transaction reach the caches only
+  // once it commits, and rolling it back drops them, so neither needs
+  // this. Inserting into timeseries_points directly also bypasses
+  // timeseries_latest.
+  void invalidateLatestCache();
 
   void deletePoints(const std::string& asset_id, int64_t from_ms,
                     int64_t to_ms);
   void deleteAllPoints(const std::string& asset_id);
 
-  // Utility
+  // Bounded retention step: deletes the oldest points of asset_id before
+  // before_ms, max_points of them plus any others sharing the last
+  // deleted timestamp, so one call holds the write lock for a bounded
+  // time. With rollup_bucket_ms above 0 the deleted points are first
+  // folded into timeseries_rollups in the same transaction. Returns the
+  // number deleted, 0 once nothing older is left. Throws
+  // std::invalid_argument if max_points is 0 or rollup_bucket_ms is
+  // negative. TimeSeriesRetention runs it over every asset.
+  size_t expirePoints(const std::string& asset_id, int64_t before_ms,
+                      size_t max_points, int64_t rollup_bucket_ms = 0);
+  // Buckets of width bucket_ms that expirePoints() rolled up for one
+  // series, bucket_start_ms in [from_ms, to_ms], by bucket start. Rolling
+  // up a bucket in several steps merges them, oldest points first.
+  std::vector<PointBucket> getRollups(const std::string& asset_id,
+                                      const std::string& unit_id,
+                                      int64_t bucket_ms, int64_t from_ms,
+                                      int64_t to_ms);
+
+  // Partitions storage only; both throw std::logic_error otherwise.
+  // dropPartitionsBefore() drops every partition ending at or before
+  // cutoff_ms, points of all assets included, and returns the count.
+  std::vector<TimePartition> getPartitions();
+  size_t dropPartitionsBefore(int64_t cutoff_ms);
+
+  PointStorage storage() const { return m_storage; }
+
+  // Utility. Factors come from a UnitConversionGraph loaded on first use
+  // and dropped by every conversion write and deleteUnit(), so both
+  // resolve multi-hop paths without touching the database. nullopt /
+  // false if the units are not connected.
   std::optional<double> convert(double value, const std::string& from_unit_id,
                                 const std::string& to_unit_id);
+  // Multiplies values[0, count) in place by one resolved factor; leaves
+  // them untouched and returns false if there is no path
+  bool convertSeries(double* values, size_t count,
+                     const std::string& from_unit_id,
+                     const std::string& to_unit_id);
+  // For unit_conversions changes made without the repository, or undone
+  // by rolling back an enclosing transaction
+  void invalidateConversions();
 
  private:
+  friend class SeriesCursor;
+
+  void backfillKeys(const std::string& table, const std::string& key_table);
+  void migrateLegacyPoints();
+  // Rows of (unit_key, timestamp_ms, value) for one asset
+  std::vector<Entities::TimeSeriesPoint> readPoints(
+      IStatement& stmt, const std::string& asset_id);
+  std::string unitId(int64_t unit_key);
+  // Up to limit points of one series in [from_ms, to_ms], oldest first
+  std::vector<GorillaSample> readPage(int64_t asset_key, int64_t unit_key,
+                                      int64_t from_ms, int64_t to_ms,
+                                      size_t limit);
+  void writeSeries(
+      const std::vector<IPointStore::SeriesPoint>& points);
+  // Rows storage with appendIngest
+  void appendSeries(const std::vector<IPointStore::SeriesPoint>& points,
+                    const std::vector<IPointStore::SeriesPoint>& newest);
+  // Newest stored timestamp of each series in series (sorted, distinct);
+  // nullopt for series without points
+  std::vector<std::optional<int64_t>> highWaterMarks(
+      const std::vector<std::pair<int64_t, int64_t>>& series);
+  std::optional<GorillaSample> latestSample(int64_t asset_key,
+                                            int64_t unit_key);
+  // One series in [from_ms, to_ms] through the point cache
+  void readCached(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+                  int64_t to_ms, std::vector<int64_t>& timestamps,
+                  std::vector<double>& values);
+  // Callers hold m_latestMutex
+  const GorillaSample* findLatest(int64_t asset_key, int64_t unit_key) const;
+  void rememberLatest(
+      const std::vector<IPointStore::SeriesPoint>& newest);
+  // rememberLatest() and the point cache write once the transaction the
+  // points were written in commits; a rollback drops both caches
+  void publishWrite(const std::vector<IPointStore::SeriesPoint>& newest,
+                    const std::vector<IPointStore::SeriesPoint>& points);
+  // Drops the latest and point cache entries of an asset, all if nullopt
+  void forgetCached(std::optional<int64_t> asset_key);
+  std::shared_ptr<const UnitConversionGraph> conversionGraph();
+  void notifyIngest(const std::vector<Entities::TimeSeriesPoint>& points);
+
   Gateways::Database::IDatabase& m_db;
+  PointStorage m_storage;
+  std::unique_ptr<IPointStore> m_store;  // all but Rows storage
+  TimeSeriesPartitionStore* m_partitions = nullptr;  // m_store if partitioned
+  size_t m_readThreads;
+  Concurrency::Executor& m_executor;
+  bool m_appendIngest;
+
+  std::atomic<uint64_t> m_appended{0};
+  std::atomic<uint64_t> m_upserted{0};
+
+  std::mutex m_listenersMutex;
+  std::map<size_t, IngestListener> m_listeners;
+  size_t m_nextListener = 1;
+
+  // unit_key -> units.id, for reads that span units
+  std::mutex m_unitIdsMutex;
+  std::unordered_map<int64_t, std::string> m_unitIds;
+
+  // asset_key -> unit_key -> latest sample. Reads fill it unless a write
+  // bumped m_latestEpoch meanwhile, so a racing read cannot cache a value
+  // older than the write.
+  std::mutex m_latestMutex;
+  std::unordered_map<int64_t, std::unordered_map<int64_t, GorillaSample>>
+      m_latest;
+  uint64_t m_latestEpoch = 0;
+
+  PointCache m_points;
+
+  // Loaded lazily; null until the next convert after a write
+  std::mutex m_conversionsMutex;
+  std::shared_ptr<const UnitConversionGraph> m_conversions;
+
+  // Last, so publishWrite() actions of a transaction that outlives the
+  // repository see it gone before anything else is
+  std::shared_ptr<const int> m_lifetime = std::make_shared<const int>(0);
 };
 
 }  // namespace Gateways::Repositories::Sqlite3
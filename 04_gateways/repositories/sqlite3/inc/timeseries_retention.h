@@ -0,0 +1,113 @@
+#ifndef REPOSITORIES_TIMESERIES_RETENTION_H_
+#define REPOSITORIES_TIMESERIES_RETENTION_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "database_connector.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+// ============================================================
+// RetentionOptions
+// ============================================================
+
+struct RetentionOptions {
+  // Points older than now - maxAge expire
+  std::chrono::milliseconds maxAge{std::chrono::hours(24 * 30)};
+  // Points deleted per transaction
+  size_t batchSize = 5000;
+  // Sleep between batches, so writers waiting for the lock get it
+  std::chrono::milliseconds batchPause{5};
+  // Width of the rollups expiring points are folded into; 0 deletes them
+  // without a rollup
+  std::chrono::milliseconds rollupBucket{0};
+  // Free pages returned per PRAGMA incremental_vacuum step after a pass,
+  // batchPause apart; 0 skips vacuuming. Has no effect unless the
+  // database was created with auto_vacuum = INCREMENTAL.
+  size_t vacuumPages = 1024;
+  // Background passes start this long after the previous one ended
+  std::chrono::milliseconds interval{std::chrono::minutes(1)};
+  // Milliseconds since the epoch; the system clock if empty
+  std::function<int64_t()> now;
+};
+
+struct RetentionStats {
+  uint64_t passes = 0;
+  uint64_t batches = 0;  // expirePoints() calls that deleted points
+  uint64_t pointsDeleted = 0;
+  uint64_t partitionsDropped = 0;
+  uint64_t pagesFreed = 0;
+  uint64_t failures = 0;  // background passes that threw
+};
+
+// ============================================================
+// TimeSeriesRetention - incremental expiry of old points
+// ============================================================
+
+// A pass expires every asset's points older than maxAge through
+// TimeSeriesRepository::expirePoints(), batchSize points per transaction
+// with batchPause between them, so ingestion never waits behind one large
+// DELETE. With Partitions storage and no rollups, partitions that have
+// fully expired are dropped first and only the rest is deleted by batch.
+// The pass ends by returning free pages to the filesystem in steps.
+//
+// runOnce() runs a pass on the calling thread; start() runs them on a
+// background thread until stop(). Passes never overlap. The repository's
+// database must allow use from the background thread (SqlitePool, or a
+// SqliteDatabase no other thread uses meanwhile).
+class TimeSeriesRetention {
+ public:
+  TimeSeriesRetention(IDatabase& db, TimeSeriesRepository& repository,
+                      const RetentionOptions& options = {});
+  ~TimeSeriesRetention();
+
+  TimeSeriesRetention(const TimeSeriesRetention&) = delete;
+  TimeSeriesRetention& operator=(const TimeSeriesRetention&) = delete;
+  TimeSeriesRetention(TimeSeriesRetention&&) = delete;
+  TimeSeriesRetention& operator=(TimeSeriesRetention&&) = delete;
+
+  // Stats of this pass alone; exceptions propagate
+  RetentionStats runOnce();
+
+  // First pass right away. stop() interrupts a pass between batches and
+  // joins the thread; it is idempotent.
+  void start();
+  void stop();
+  bool isRunning() const;
+
+  // Totals over all passes
+  RetentionStats stats() const;
+
+ private:
+  void run();
+  RetentionStats pass();
+  size_t vacuum();
+  // Sleeps for batchPause; false if stop() was called
+  bool pause();
+
+  IDatabase& m_db;
+  TimeSeriesRepository& m_repository;
+  const RetentionOptions m_options;
+
+  std::mutex m_passMutex;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_stopping = false;
+  RetentionStats m_stats;
+
+  std::thread m_worker;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_TIMESERIES_RETENTION_H_
@@ -0,0 +1,45 @@
+#ifndef REPOSITORIES_TIMESERIES_SQL_FUNCTIONS_H_
+#define REPOSITORIES_TIMESERIES_SQL_FUNCTIONS_H_
+
+#include "sqlite3_database_connector.h"
+#include "sqlite3_pool.h"
+#include "timeseries_repository.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+// ============================================================
+// Time Series SQL Functions
+// ============================================================
+
+// Registers, on every connection of db:
+//
+//   convert_unit(value, from_unit_id, to_unit_id)
+//     value in to_unit_id through repository.convert(), so multi-hop
+//     paths resolve from the in-memory graph; NULL if the units are not
+//     connected or an argument is NULL.
+//   ema(value, window)
+//     Exponential moving average, alpha = 2 / (window + 1), seeded with
+//     the first value like IndicatorKind::Ema. Order matters: use it as
+//     a window function, ema(value, n) OVER (ORDER BY timestamp_ms),
+//     whose frames must start at UNBOUNDED PRECEDING.
+//   vwap(value, weight)
+//     Sum of value * weight over the sum of the weights; NULL while that
+//     is zero.
+//   stddev(value)
+//     Sample standard deviation; NULL under two values.
+//
+// The last three are aggregates and window functions, vwap and stddev
+// with sliding frames too, and skip rows with a NULL value, as built-in
+// aggregates do. While a conversion write has dropped the repository's
+// graph, the next convert_unit() call reloads it through the repository's
+// database, from inside the running query.
+void registerTimeSeriesFunctions(SqliteDatabase& db,
+                                 TimeSeriesRepository& repository);
+void registerTimeSeriesFunctions(SqlitePool& db,
+                                 TimeSeriesRepository& repository);
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_TIMESERIES_SQL_FUNCTIONS_H_
@@ -0,0 +1,41 @@
+#ifndef REPOSITORIES_UNIT_CONVERSION_GRAPH_H_
+#define REPOSITORIES_UNIT_CONVERSION_GRAPH_H_
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "entities.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// UnitConversionGraph - resolved factors between all units
+// ============================================================
+
+// Immutable snapshot of unit_conversions with every reachable pair
+// resolved up front. Each row from -> to (factor f) is an edge, and so is
+// its reverse with 1 / f unless f is zero. A pair takes the path with the
+// fewest hops; on a tie a stored row beats the reverse of one, so direct
+// and reverse lookups give the same answers as single-row queries. Longer
+// paths multiply the factors along the way (EUR -> USD -> CHF).
+class UnitConversionGraph {
+ public:
+  UnitConversionGraph() = default;
+  explicit UnitConversionGraph(
+      const std::vector<Entities::UnitConversion>& conversions);
+
+  // Factor to multiply a from_unit_id value by; 1 for the same unit,
+  // nullopt if no path exists
+  std::optional<double> factor(const std::string& from_unit_id,
+                               const std::string& to_unit_id) const;
+
+ private:
+  std::unordered_map<std::string, std::unordered_map<std::string, double>>
+      m_factors;
+};
+
+}  // namespace Gateways::Repositories::Sqlite3
+
+#endif  // REPOSITORIES_UNIT_CONVERSION_GRAPH_H_
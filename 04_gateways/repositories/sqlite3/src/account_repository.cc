@@ -1,34 +1,111 @@
 #include "account_repository.h"
 
+#include <algorithm>
+#include <limits>
+
+#include "prefix_range.h"
+#include "tracing.h"
+
 namespace Gateways::Repositories::Sqlite3 {
 
 using namespace Gateways::Database;
 
-AccountRepository::AccountRepository(IDatabase& db) : m_db(db) {}
+namespace {
+
+// Columns: id, name, password_hash, created_at
+Entities::Account toAccount(const RowView& row) {
+  Entities::Account account;
+  account.id = row.get<std::string>(0);
+  account.name = row.get<std::string>(1);
+  account.password_hash = row.get<std::optional<std::vector<uint8_t>>>(2);
+  account.created_at = row.get<int64_t>(3);
+  return account;
+}
+
+// Columns: account_id, key, value, description
+Entities::AccountProperty toProperty(const RowView& row) {
+  Entities::AccountProperty property;
+  property.account_id = row.get<std::string>(0);
+  property.key = row.get<std::string>(1);
+  property.value = row.get<std::string>(2);
+  property.description = row.get<std::optional<std::string>>(3);
+  return property;
+}
+
+// Columns: id, name, created_at
+Entities::AccountSummary toSummary(const RowView& row) {
+  Entities::AccountSummary summary;
+  summary.id = row.get<std::string>(0);
+  summary.name = row.get<std::string>(1);
+  summary.created_at = row.get<int64_t>(2);
+  return summary;
+}
+
+// INSERT of rows accounts, four parameters each
+std::string insertAccountsSql(size_t rows) {
+  std::string sql =
+      "INSERT INTO accounts (id, name, password_hash, created_at) VALUES ";
+  for (size_t row = 0; row < rows; ++row) {
+    sql += row == 0 ? "(?, ?, ?, ?)" : ", (?, ?, ?, ?)";
+  }
+  return sql;
+}
+
+void bindAccount(IStatement& stmt, int first,
+                 const Entities::Account& account) {
+  stmt.bindStatic(first, account.id).bindStatic(first + 1, account.name);
+  if (account.password_hash) {
+    stmt.bindStatic(first + 2, *account.password_hash);
+  } else {
+    stmt.bind(first + 2, nullptr);
+  }
+  stmt.bind(first + 3, account.created_at);
+}
+
+// SQLite reads a negative LIMIT as no limit
+int64_t pageLimit(size_t limit) {
+  return static_cast<int64_t>(
+      std::min<size_t>(limit, std::numeric_limits<int64_t>::max()));
+}
+
+}  // namespace
+
+AccountRepository::AccountRepository(IDatabase& db,
+                                     const AccountOptions& options)
+    : m_db(db), m_options(options) {
+  if (options.existenceFilter) {
+    // Validates the filter options up front
+    BloomFilter(options.filterCapacity, options.filterFalsePositiveRate);
+    m_filters = std::make_unique<ExistenceFilters>();
+  }
+}
 
 void AccountRepository::initSchema() {
-  m_db.execute(R"(
-    CREATE TABLE IF NOT EXISTS accounts (
-      id TEXT PRIMARY KEY,
-      name TEXT NOT NULL UNIQUE,
-      password_hash BLOB,
-      created_at INTEGER NOT NULL
-    )
-  )");
-
-  m_db.execute(R"(
-    CREATE TABLE IF NOT EXISTS account_properties (
-      account_id TEXT NOT NULL,
-      key TEXT NOT NULL,
-      value TEXT NOT NULL,
-      description TEXT,
-      PRIMARY KEY (account_id, key),
-      FOREIGN KEY (account_id) REFERENCES accounts(id) ON DELETE CASCADE
-    )
-  )");
-
-  m_db.execute(
-      "CREATE INDEX IF NOT EXISTS idx_accounts_name ON accounts(name)");
+  // IF NOT EXISTS: databases from before versioning have the tables
+  migrateSchema(m_db, "accounts", {[](IDatabase& db) {
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS accounts (
+        id TEXT PRIMARY KEY,
+        name TEXT NOT NULL UNIQUE,
+        password_hash BLOB,
+        created_at INTEGER NOT NULL
+      )
+    )");
+
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS account_properties (
+        account_id TEXT NOT NULL,
+        key TEXT NOT NULL,
+        value TEXT NOT NULL,
+        description TEXT,
+        PRIMARY KEY (account_id, key),
+        FOREIGN KEY (account_id) REFERENCES accounts(id) ON DELETE CASCADE
+      )
+    )");
+
+    db.execute(
+        "CREATE INDEX IF NOT EXISTS idx_accounts_name ON accounts(name)");
+  }});
 }
 
 // ============================================================
@@ -36,43 +113,129 @@ void AccountRepository::initSchema() {
 // ============================================================
 
 void AccountRepository::createAccount(const Entities::Account& account) {
+  TRACE_SPAN("repository", "AccountRepository::createAccount");
   auto stmt = m_db.prepare(
       "INSERT INTO accounts (id, name, password_hash, created_at) "
       "VALUES (?, ?, ?, ?)");
   stmt->bind(1, account.id).bind(2, account.name);
 
   if (account.password_hash) {
-    stmt->bind(3, *account.password_hash);
+    stmt->bindStatic(3, *account.password_hash);
   } else {
     stmt->bind(3, nullptr);
   }
 
   stmt->bind(4, account.created_at);
   stmt->executeInsert();
+  remember(account);
 }
 
-std::optional<Entities::Account> AccountRepository::getAccount(
-    const std::string& id) {
-  auto stmt = m_db.prepare(
-      "SELECT id, name, password_hash, created_at FROM accounts WHERE id = ?");
-  stmt->bind(1, id);
-  auto result = stmt->execute();
+Entities::AccountConflict AccountRepository::tryCreateAccount(
+    const Entities::Account& account) {
+  TRACE_SPAN("repository", "AccountRepository::tryCreateAccount");
+  try {
+    createAccount(account);
+  } catch (const ConstraintException& e) {
+    // SQLite names the first constraint it found broken, and it checks
+    // the name index before the primary key: a taken name takes one
+    // more query to see whether the id is taken too
+    const std::string message = e.what();
+    if (message.find("accounts.id") != std::string::npos) {
+      return Entities::AccountConflict::Id;
+    }
+    if (message.find("accounts.name") != std::string::npos) {
+      auto stmt = m_db.prepare("SELECT 1 FROM accounts WHERE id = ?");
+      stmt->bind(1, account.id);
+      return stmt->step() ? Entities::AccountConflict::Id
+                          : Entities::AccountConflict::Name;
+    }
+    throw;
+  }
+  return Entities::AccountConflict::None;
+}
 
-  if (result.empty()) {
-    return std::nullopt;
+void AccountRepository::createAccounts(
+    const std::vector<Entities::Account>& accounts) {
+  TRACE_SPAN("repository", "AccountRepository::createAccounts");
+  if (accounts.empty()) {
+    return;
   }
 
-  Entities::Account account;
-  account.id = std::get<std::string>(result[0][0]);
-  account.name = std::get<std::string>(result[0][1]);
+  const size_t chunkRows = std::min(kAccountsPerInsert, accounts.size());
+  const size_t chunkedCount = accounts.size() - accounts.size() % chunkRows;
+
+  m_db.beginTransaction();
+  try {
+    auto insert = [&](IStatement& stmt, size_t first, size_t rows) {
+      for (size_t row = 0; row < rows; ++row) {
+        bindAccount(stmt, static_cast<int>(row * 4 + 1),
+                    accounts[first + row]);
+      }
+      stmt.executeUpdate();
+      stmt.reset();
+    };
+
+    auto chunk = m_db.prepare(insertAccountsSql(chunkRows));
+    for (size_t first = 0; first < chunkedCount; first += chunkRows) {
+      insert(*chunk, first, chunkRows);
+    }
+    if (const size_t tailRows = accounts.size() - chunkedCount) {
+      auto tail = m_db.prepare(insertAccountsSql(tailRows));
+      insert(*tail, chunkedCount, tailRows);
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
 
-  if (!std::holds_alternative<std::nullptr_t>(result[0][2])) {
-    account.password_hash = std::get<std::vector<uint8_t>>(result[0][2]);
+  for (const auto& account : accounts) {
+    remember(account);
   }
+}
 
-  account.created_at = std::get<int64_t>(result[0][3]);
+std::vector<Entities::AccountConflict> AccountRepository::findAccountConflicts(
+    const std::vector<Entities::Account>& accounts) {
+  std::vector<Entities::AccountConflict> conflicts(
+      accounts.size(), Entities::AccountConflict::None);
+  if (accounts.empty()) {
+    return conflicts;
+  }
 
-  return account;
+  std::vector<std::string> ids;
+  std::vector<std::string> names;
+  ids.reserve(accounts.size());
+  names.reserve(accounts.size());
+  for (const auto& account : accounts) {
+    ids.push_back(account.id);
+    names.push_back(account.name);
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT k.key, 0 FROM json_each(?) AS k "
+      "JOIN accounts AS a ON a.id = k.value "
+      "UNION ALL "
+      "SELECT k.key, 1 FROM json_each(?) AS k "
+      "JOIN accounts AS a ON a.name = k.value");
+  stmt->bind(1, toJsonArray(ids)).bind(2, toJsonArray(names));
+  for (const RowView& row : stmt->rows()) {
+    auto& conflict = conflicts[static_cast<size_t>(row.getInt64(0))];
+    if (row.getInt64(1) == 0) {
+      conflict = Entities::AccountConflict::Id;
+    } else if (conflict == Entities::AccountConflict::None) {
+      conflict = Entities::AccountConflict::Name;
+    }
+  }
+  return conflicts;
+}
+
+std::optional<Entities::Account> AccountRepository::getAccount(
+    const std::string& id) {
+  TRACE_SPAN("repository", "AccountRepository::getAccount");
+  auto stmt = m_db.prepare(
+      "SELECT id, name, password_hash, created_at FROM accounts WHERE id = ?");
+  stmt->bind(1, id);
+  return stmt->mapOne<Entities::Account>(toAccount);
 }
 
 std::optional<Entities::Account> AccountRepository::getAccountByName(
@@ -81,82 +244,109 @@ std::optional<Entities::Account> AccountRepository::getAccountByName(
       "SELECT id, name, password_hash, created_at FROM accounts WHERE name = "
       "?");
   stmt->bind(1, name);
-  auto result = stmt->execute();
-
-  if (result.empty()) {
-    return std::nullopt;
-  }
-
-  Entities::Account account;
-  account.id = std::get<std::string>(result[0][0]);
-  account.name = std::get<std::string>(result[0][1]);
-
-  if (!std::holds_alternative<std::nullptr_t>(result[0][2])) {
-    account.password_hash = std::get<std::vector<uint8_t>>(result[0][2]);
-  }
-
-  account.created_at = std::get<int64_t>(result[0][3]);
-
-  return account;
+  return stmt->mapOne<Entities::Account>(toAccount);
 }
 
 std::vector<Entities::Account> AccountRepository::getAllAccounts() {
-  auto result = m_db.query(
+  auto stmt = m_db.prepare(
       "SELECT id, name, password_hash, created_at FROM accounts ORDER BY name");
+  return stmt->mapRows<Entities::Account>(toAccount);
+}
 
-  std::vector<Entities::Account> accounts;
-  accounts.reserve(result.size());
-
-  for (const auto& row : result) {
-    Entities::Account account;
-    account.id = std::get<std::string>(row[0]);
-    account.name = std::get<std::string>(row[1]);
+std::vector<Entities::AccountSummary> AccountRepository::listAccounts(
+    const std::optional<std::string>& after_name, size_t limit) {
+  TRACE_SPAN("repository", "AccountRepository::listAccounts");
+  if (limit == 0) {
+    return {};
+  }
 
-    if (!std::holds_alternative<std::nullptr_t>(row[2])) {
-      account.password_hash = std::get<std::vector<uint8_t>>(row[2]);
-    }
+  std::unique_ptr<IStatement> stmt;
+  if (after_name) {
+    stmt = m_db.prepare(
+        "SELECT id, name, created_at FROM accounts WHERE name > ? "
+        "ORDER BY name LIMIT ?");
+    stmt->bind(1, *after_name).bind(2, pageLimit(limit));
+  } else {
+    stmt = m_db.prepare(
+        "SELECT id, name, created_at FROM accounts ORDER BY name LIMIT ?");
+    stmt->bind(1, pageLimit(limit));
+  }
+  return stmt->mapRows<Entities::AccountSummary>(toSummary);
+}
 
-    account.created_at = std::get<int64_t>(row[3]);
-    accounts.push_back(std::move(account));
+std::vector<std::optional<Entities::Account>> AccountRepository::getAccounts(
+    const std::vector<std::string>& ids) {
+  TRACE_SPAN("repository", "AccountRepository::getAccounts");
+  std::vector<std::optional<Entities::Account>> accounts(ids.size());
+  if (ids.empty()) {
+    return accounts;
   }
 
+  auto stmt = m_db.prepare(
+      "SELECT k.key, a.id, a.name, a.password_hash, a.created_at "
+      "FROM json_each(?) AS k JOIN accounts AS a ON a.id = k.value");
+  stmt->bind(1, toJsonArray(ids));
+  for (const RowView& row : stmt->rows()) {
+    Entities::Account account;
+    account.id = row.get<std::string>(1);
+    account.name = row.get<std::string>(2);
+    account.password_hash = row.get<std::optional<std::vector<uint8_t>>>(3);
+    account.created_at = row.get<int64_t>(4);
+    accounts[static_cast<size_t>(row.getInt64(0))] = std::move(account);
+  }
   return accounts;
 }
 
 void AccountRepository::updateAccount(const Entities::Account& account) {
+  TRACE_SPAN("repository", "AccountRepository::updateAccount");
   auto stmt = m_db.prepare(
       "UPDATE accounts SET name = ?, password_hash = ?, created_at = ? "
       "WHERE id = ?");
   stmt->bind(1, account.name);
 
   if (account.password_hash) {
-    stmt->bind(2, *account.password_hash);
+    stmt->bindStatic(2, *account.password_hash);
   } else {
     stmt->bind(2, nullptr);
   }
 
   stmt->bind(3, account.created_at).bind(4, account.id);
-  stmt->executeUpdate();
+  if (stmt->executeUpdate() > 0) {
+    remember(account);
+  }
 }
 
 void AccountRepository::deleteAccount(const std::string& id) {
+  TRACE_SPAN("repository", "AccountRepository::deleteAccount");
   auto stmt = m_db.prepare("DELETE FROM accounts WHERE id = ?");
   stmt->bind(1, id);
   stmt->executeUpdate();
 }
 
 bool AccountRepository::accountExists(const std::string& id) {
+  if (!mayExist(false, id)) {
+    return false;
+  }
   auto stmt = m_db.prepare("SELECT 1 FROM accounts WHERE id = ?");
   stmt->bind(1, id);
-  auto result = stmt->execute();
-  return !result.empty();
+  const bool exists = stmt->step();
+  if (!exists) {
+    notePossibleFalsePositive();
+  }
+  return exists;
 }
 
 bool AccountRepository::accountExistsByName(const std::string& name) {
+  if (!mayExist(true, name)) {
+    return false;
+  }
   auto stmt = m_db.prepare("SELECT 1 FROM accounts WHERE name = ?");
   stmt->bind(1, name);
-  auto result = stmt->execute();
-  return !result.empty();
+  const bool exists = stmt->step();
+  if (!exists) {
+    notePossibleFalsePositive();
+  }
+  return exists;
 }
 
 // ============================================================
@@ -166,6 +356,7 @@ bool AccountRepository::accountExistsByName(const std::string& name) {
 void AccountRepository::setProperty(
     const std::string& account_id, const std::string& key,
     const std::string& value, const std::optional<std::string>& description) {
+  TRACE_SPAN("repository", "AccountRepository::setProperty");
   auto stmt = m_db.prepare(
       "INSERT OR REPLACE INTO account_properties "
       "(account_id, key, value, description) VALUES (?, ?, ?, ?)");
@@ -187,26 +378,12 @@ void AccountRepository::setProperty(const Entities::AccountProperty& property) {
 
 std::optional<Entities::AccountProperty> AccountRepository::getProperty(
     const std::string& account_id, const std::string& key) {
+  TRACE_SPAN("repository", "AccountRepository::getProperty");
   auto stmt = m_db.prepare(
       "SELECT account_id, key, value, description FROM account_properties "
       "WHERE account_id = ? AND key = ?");
   stmt->bind(1, account_id).bind(2, key);
-  auto result = stmt->execute();
-
-  if (result.empty()) {
-    return std::nullopt;
-  }
-
-  Entities::AccountProperty property;
-  property.account_id = std::get<std::string>(result[0][0]);
-  property.key = std::get<std::string>(result[0][1]);
-  property.value = std::get<std::string>(result[0][2]);
-
-  if (!std::holds_alternative<std::nullptr_t>(result[0][3])) {
-    property.description = std::get<std::string>(result[0][3]);
-  }
-
-  return property;
+  return stmt->mapOne<Entities::AccountProperty>(toProperty);
 }
 
 std::optional<std::string> AccountRepository::getPropertyValue(
@@ -214,13 +391,7 @@ std::optional<std::string> AccountRepository::getPropertyValue(
   auto stmt = m_db.prepare(
       "SELECT value FROM account_properties WHERE account_id = ? AND key = ?");
   stmt->bind(1, account_id).bind(2, key);
-  auto result = stmt->execute();
-
-  if (result.empty()) {
-    return std::nullopt;
-  }
-
-  return std::get<std::string>(result[0][0]);
+  return stmt->fetchScalar<std::string>();
 }
 
 std::vector<Entities::AccountProperty> AccountRepository::getProperties(
@@ -229,52 +400,110 @@ std::vector<Entities::AccountProperty> AccountRepository::getProperties(
       "SELECT account_id, key, value, description FROM account_properties "
       "WHERE account_id = ? ORDER BY key");
   stmt->bind(1, account_id);
-  auto result = stmt->execute();
-
-  std::vector<Entities::AccountProperty> properties;
-  properties.reserve(result.size());
-
-  for (const auto& row : result) {
-    Entities::AccountProperty property;
-    property.account_id = std::get<std::string>(row[0]);
-    property.key = std::get<std::string>(row[1]);
-    property.value = std::get<std::string>(row[2]);
-
-    if (!std::holds_alternative<std::nullptr_t>(row[3])) {
-      property.description = std::get<std::string>(row[3]);
-    }
-
-    properties.push_back(std::move(property));
-  }
-
-  return properties;
+  return stmt->mapRows<Entities::AccountProperty>(toProperty);
 }
 
 std::vector<Entities::AccountProperty> AccountRepository::getPropertiesByPrefix(
     const std::string& account_id, const std::string& prefix) {
+  const auto range = prefixRange(prefix);
   auto stmt = m_db.prepare(
       "SELECT account_id, key, value, description FROM account_properties "
-      "WHERE account_id = ? AND key LIKE ? ORDER BY key");
-  stmt->bind(1, account_id).bind(2, prefix + "%");
-  auto result = stmt->execute();
+      "WHERE account_id = ? AND " +
+      prefixCondition(range, "key") + " ORDER BY key");
+  stmt->bind(1, account_id);
+  bindPrefixRange(*stmt, 2, range);
+  return stmt->mapRows<Entities::AccountProperty>(toProperty);
+}
 
-  std::vector<Entities::AccountProperty> properties;
-  properties.reserve(result.size());
+std::vector<Entities::AccountProperty> AccountRepository::listProperties(
+    const std::string& account_id, const std::optional<std::string>& after_key,
+    size_t limit) {
+  TRACE_SPAN("repository", "AccountRepository::listProperties");
+  if (limit == 0) {
+    return {};
+  }
 
-  for (const auto& row : result) {
+  std::unique_ptr<IStatement> stmt;
+  if (after_key) {
+    stmt = m_db.prepare(
+        "SELECT account_id, key, value, description FROM account_properties "
+        "WHERE account_id = ? AND key > ? ORDER BY key LIMIT ?");
+    stmt->bind(1, account_id).bind(2, *after_key).bind(3, pageLimit(limit));
+  } else {
+    stmt = m_db.prepare(
+        "SELECT account_id, key, value, description FROM account_properties "
+        "WHERE account_id = ? ORDER BY key LIMIT ?");
+    stmt->bind(1, account_id).bind(2, pageLimit(limit));
+  }
+  return stmt->mapRows<Entities::AccountProperty>(toProperty);
+}
+
+std::vector<std::vector<Entities::AccountProperty>>
+AccountRepository::getPropertiesForAccounts(
+    const std::vector<std::string>& account_ids) {
+  std::vector<std::vector<Entities::AccountProperty>> properties(
+      account_ids.size());
+  if (account_ids.empty()) {
+    return properties;
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT k.key, p.account_id, p.key, p.value, p.description "
+      "FROM json_each(?) AS k "
+      "JOIN account_properties AS p ON p.account_id = k.value "
+      "ORDER BY k.key, p.key");
+  stmt->bind(1, toJsonArray(account_ids));
+  for (const RowView& row : stmt->rows()) {
     Entities::AccountProperty property;
-    property.account_id = std::get<std::string>(row[0]);
-    property.key = std::get<std::string>(row[1]);
-    property.value = std::get<std::string>(row[2]);
+    property.account_id = row.get<std::string>(1);
+    property.key = row.get<std::string>(2);
+    property.value = row.get<std::string>(3);
+    property.description = row.get<std::optional<std::string>>(4);
+    properties[static_cast<size_t>(row.getInt64(0))].push_back(
+        std::move(property));
+  }
+  return properties;
+}
 
-    if (!std::holds_alternative<std::nullptr_t>(row[3])) {
-      property.description = std::get<std::string>(row[3]);
-    }
+std::vector<Entities::AccountWithProperties>
+AccountRepository::getAccountsWithProperties(
+    const std::optional<std::string>& after_name, size_t limit) {
+  if (limit == 0) {
+    return {};
+  }
 
-    properties.push_back(std::move(property));
+  // The page is cut first, so LIMIT counts accounts rather than rows
+  auto stmt = m_db.prepare(
+      std::string("WITH page AS (SELECT id, name, created_at FROM accounts ") +
+      (after_name ? "WHERE name > ? " : "") +
+      "ORDER BY name LIMIT ?) "
+      "SELECT page.id, page.name, page.created_at, p.key, p.value, "
+      "p.description FROM page "
+      "LEFT JOIN account_properties AS p ON p.account_id = page.id "
+      "ORDER BY page.name, p.key");
+  int index = 1;
+  if (after_name) {
+    stmt->bind(index++, *after_name);
   }
+  stmt->bind(index, pageLimit(limit));
 
-  return properties;
+  std::vector<Entities::AccountWithProperties> accounts;
+  for (const RowView& row : stmt->rows()) {
+    if (accounts.empty() || accounts.back().account.id != row.getText(0)) {
+      accounts.push_back({toSummary(row), {}});
+    }
+    // NULL key: an account without properties
+    if (row.isNull(3)) {
+      continue;
+    }
+    Entities::AccountProperty property;
+    property.account_id = accounts.back().account.id;
+    property.key = row.get<std::string>(3);
+    property.value = row.get<std::string>(4);
+    property.description = row.get<std::optional<std::string>>(5);
+    accounts.back().properties.push_back(std::move(property));
+  }
+  return accounts;
 }
 
 bool AccountRepository::propertyExists(const std::string& account_id,
@@ -282,8 +511,7 @@ bool AccountRepository::propertyExists(const std::string& account_id,
   auto stmt = m_db.prepare(
       "SELECT 1 FROM account_properties WHERE account_id = ? AND key = ?");
   stmt->bind(1, account_id).bind(2, key);
-  auto result = stmt->execute();
-  return !result.empty();
+  return stmt->step();
 }
 
 void AccountRepository::removeProperty(const std::string& account_id,
@@ -296,9 +524,12 @@ void AccountRepository::removeProperty(const std::string& account_id,
 
 void AccountRepository::removePropertiesByPrefix(const std::string& account_id,
                                                  const std::string& prefix) {
+  const auto range = prefixRange(prefix);
   auto stmt = m_db.prepare(
-      "DELETE FROM account_properties WHERE account_id = ? AND key LIKE ?");
-  stmt->bind(1, account_id).bind(2, prefix + "%");
+      "DELETE FROM account_properties WHERE account_id = ? AND " +
+      prefixCondition(range, "key"));
+  stmt->bind(1, account_id);
+  bindPrefixRange(*stmt, 2, range);
   stmt->executeUpdate();
 }
 
@@ -322,8 +553,76 @@ int64_t AccountRepository::countProperties(const std::string& account_id) {
   auto stmt = m_db.prepare(
       "SELECT COUNT(*) FROM account_properties WHERE account_id = ?");
   stmt->bind(1, account_id);
-  auto result = stmt->execute();
-  return std::get<int64_t>(result[0][0]);
+  return stmt->fetchScalar<int64_t>().value_or(0);
+}
+
+// ============================================================
+// Existence Filters
+// ============================================================
+
+AccountFilterStats AccountRepository::existenceFilterStats() const {
+  if (!m_filters) {
+    return {};
+  }
+  std::lock_guard<std::mutex> lock(m_filters->mutex);
+  return m_filters->stats;
+}
+
+void AccountRepository::rebuildExistenceFilters() {
+  if (!m_filters) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_filters->mutex);
+  m_filters->loaded = false;
+}
+
+bool AccountRepository::mayExist(bool byName, const std::string& key) {
+  if (!m_filters) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(m_filters->mutex);
+  if (!m_filters->loaded) {
+    const auto stored = static_cast<size_t>(countAccounts());
+    const size_t capacity = std::max(m_options.filterCapacity, 2 * stored);
+    auto ids = std::make_unique<BloomFilter>(
+        capacity, m_options.filterFalsePositiveRate);
+    auto names = std::make_unique<BloomFilter>(
+        capacity, m_options.filterFalsePositiveRate);
+    m_db.query("SELECT id, name FROM accounts", [&](const RowView& row) {
+      ids->add(row.getText(0));
+      names->add(row.getText(1));
+    });
+    m_filters->ids = std::move(ids);
+    m_filters->names = std::move(names);
+    m_filters->loaded = true;
+  }
+
+  ++m_filters->stats.checks;
+  const BloomFilter& filter = byName ? *m_filters->names : *m_filters->ids;
+  if (!filter.mayContain(key)) {
+    ++m_filters->stats.skipped;
+    return false;
+  }
+  return true;
+}
+
+void AccountRepository::notePossibleFalsePositive() {
+  if (m_filters) {
+    std::lock_guard<std::mutex> lock(m_filters->mutex);
+    ++m_filters->stats.falsePositives;
+  }
+}
+
+void AccountRepository::remember(const Entities::Account& account) {
+  if (!m_filters) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_filters->mutex);
+  if (m_filters->loaded) {
+    m_filters->ids->add(account.id);
+    m_filters->names->add(account.name);
+  }
 }
 
 }  // namespace Gateways::Repositories::Sqlite3
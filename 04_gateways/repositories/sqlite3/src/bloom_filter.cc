@@ -0,0 +1,68 @@
+#include "bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+BloomFilter::BloomFilter(size_t capacity, double false_positive_rate) {
+  if (capacity == 0) {
+    throw std::invalid_argument("Bloom filter capacity must be positive");
+  }
+  if (!(false_positive_rate > 0.0 && false_positive_rate < 1.0)) {
+    throw std::invalid_argument(
+        "Bloom filter false positive rate must be in (0, 1)");
+  }
+
+  // m = -n ln p / (ln 2)^2 bits and k = m / n ln 2 probes minimize the
+  // false positive rate for n keys
+  const double ln2 = std::log(2.0);
+  const double bits = -static_cast<double>(capacity) *
+                      std::log(false_positive_rate) / (ln2 * ln2);
+  m_bits = std::max<size_t>(64, static_cast<size_t>(std::ceil(bits)));
+  m_hashes = std::clamp<size_t>(
+      static_cast<size_t>(std::lround(bits / capacity * ln2)), 1, 30);
+  m_words.assign((m_bits + 63) / 64, 0);
+}
+
+void BloomFilter::add(std::string_view key) {
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  hash(key, h1, h2);
+  for (size_t i = 0; i < m_hashes; ++i) {
+    const uint64_t bit = (h1 + i * h2) % m_bits;
+    m_words[bit / 64] |= uint64_t{1} << (bit % 64);
+  }
+}
+
+bool BloomFilter::mayContain(std::string_view key) const {
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  hash(key, h1, h2);
+  for (size_t i = 0; i < m_hashes; ++i) {
+    const uint64_t bit = (h1 + i * h2) % m_bits;
+    if ((m_words[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BloomFilter::clear() { std::fill(m_words.begin(), m_words.end(), 0); }
+
+void BloomFilter::hash(std::string_view key, uint64_t& h1, uint64_t& h2) {
+  // FNV-1a, then a splitmix64 finalizer for the second, independent hash
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : key) {
+    h = (h ^ c) * 0x100000001b3ULL;
+  }
+  h1 = h;
+
+  h += 0x9e3779b97f4a7c15ULL;
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  h2 = (h ^ (h >> 31)) | 1;  // odd, so probes do not repeat early
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,261 @@
+#include "gorilla_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+// Delta-of-delta buckets after the single '0' bit for dod == 0: prefix,
+// prefix length, payload bits. The last bucket holds any 64-bit value.
+struct DodBucket {
+  uint64_t prefix;
+  int prefixBits;
+  int payloadBits;
+};
+
+constexpr DodBucket kDodBuckets[] = {
+    {0b10, 2, 7},
+    {0b110, 3, 9},
+    {0b1110, 4, 12},
+    {0b1111, 4, 64},
+};
+
+// Leading-zero counts above this are stored as this (5-bit field)
+constexpr int kMaxLeadingZeros = 31;
+
+class BitWriter {
+ public:
+  // Appends the low `bits` bits of value, most significant first
+  void write(uint64_t value, int bits) {
+    while (bits > 0) {
+      if (m_used == 0) {
+        m_bytes.push_back(0);
+      }
+      int room = 8 - m_used;
+      int take = std::min(room, bits);
+      auto chunk = static_cast<uint8_t>((value >> (bits - take)) &
+                                        ((1u << take) - 1));
+      m_bytes.back() |= static_cast<uint8_t>(chunk << (room - take));
+      bits -= take;
+      m_used = (m_used + take) % 8;
+    }
+  }
+
+  std::vector<uint8_t> release() { return std::move(m_bytes); }
+
+ private:
+  std::vector<uint8_t> m_bytes;
+  int m_used = 0;  // bits filled in the last byte
+};
+
+class BitReader {
+ public:
+  explicit BitReader(BlobView data) : m_data(data) {}
+
+  uint64_t read(int bits) {
+    uint64_t value = 0;
+    while (bits > 0) {
+      if (m_pos >= m_data.size() * 8) {
+        throw QueryException("Truncated time series chunk");
+      }
+      int offset = static_cast<int>(m_pos % 8);
+      int room = 8 - offset;
+      int take = std::min(room, bits);
+      uint64_t chunk =
+          (m_data.data()[m_pos / 8] >> (room - take)) & ((1u << take) - 1);
+      value = (value << take) | chunk;
+      bits -= take;
+      m_pos += static_cast<size_t>(take);
+    }
+    return value;
+  }
+
+  bool readBit() { return read(1) != 0; }
+
+ private:
+  BlobView m_data;
+  size_t m_pos = 0;
+};
+
+uint64_t toBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double fromBits(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+bool fitsSigned(int64_t value, int bits) {
+  if (bits >= 64) {
+    return true;
+  }
+  const int64_t limit = int64_t{1} << (bits - 1);
+  return value >= -limit && value < limit;
+}
+
+int64_t signExtend(uint64_t value, int bits) {
+  if (bits >= 64) {
+    return static_cast<int64_t>(value);
+  }
+  const uint64_t sign = uint64_t{1} << (bits - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+uint64_t payloadMask(int bits) {
+  return bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+}
+
+}  // namespace
+
+// ============================================================
+// Encoding
+// ============================================================
+
+std::vector<uint8_t> gorillaEncode(const std::vector<GorillaSample>& samples) {
+  if (samples.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("Too many samples for one chunk");
+  }
+
+  BitWriter writer;
+  writer.write(samples.size(), 32);
+  if (samples.empty()) {
+    return writer.release();
+  }
+
+  // Deltas use unsigned arithmetic so extreme timestamps wrap instead of
+  // overflowing; the decoder wraps the same way
+  uint64_t prevTimestamp = static_cast<uint64_t>(samples[0].timestamp_ms);
+  uint64_t prevDelta = 0;
+  uint64_t prevValue = toBits(samples[0].value);
+  int prevLeading = -1;  // no XOR window yet
+  int prevTrailing = 0;
+
+  writer.write(prevTimestamp, 64);
+  writer.write(prevValue, 64);
+
+  for (size_t i = 1; i < samples.size(); ++i) {
+    if (samples[i].timestamp_ms <= samples[i - 1].timestamp_ms) {
+      throw std::invalid_argument(
+          "Samples must have strictly increasing timestamps");
+    }
+
+    const auto timestamp = static_cast<uint64_t>(samples[i].timestamp_ms);
+    const uint64_t delta = timestamp - prevTimestamp;
+    const auto dod = static_cast<int64_t>(delta - prevDelta);
+    if (dod == 0) {
+      writer.write(0, 1);
+    } else {
+      for (const auto& bucket : kDodBuckets) {
+        if (fitsSigned(dod, bucket.payloadBits)) {
+          writer.write(bucket.prefix, bucket.prefixBits);
+          writer.write(static_cast<uint64_t>(dod) &
+                           payloadMask(bucket.payloadBits),
+                       bucket.payloadBits);
+          break;
+        }
+      }
+    }
+    prevTimestamp = timestamp;
+    prevDelta = delta;
+
+    const uint64_t value = toBits(samples[i].value);
+    const uint64_t xored = value ^ prevValue;
+    prevValue = value;
+    if (xored == 0) {
+      writer.write(0, 1);
+      continue;
+    }
+    writer.write(1, 1);
+
+    const int leading = std::min(__builtin_clzll(xored), kMaxLeadingZeros);
+    const int trailing = __builtin_ctzll(xored);
+    if (prevLeading >= 0 && leading >= prevLeading &&
+        trailing >= prevTrailing) {
+      // Meaningful bits fit the previous window
+      writer.write(0, 1);
+      writer.write(xored >> prevTrailing, 64 - prevLeading - prevTrailing);
+    } else {
+      const int length = 64 - leading - trailing;
+      writer.write(1, 1);
+      writer.write(static_cast<uint64_t>(leading), 5);
+      writer.write(static_cast<uint64_t>(length - 1), 6);
+      writer.write(xored >> trailing, length);
+      prevLeading = leading;
+      prevTrailing = trailing;
+    }
+  }
+
+  return writer.release();
+}
+
+// ============================================================
+// Decoding
+// ============================================================
+
+std::vector<GorillaSample> gorillaDecode(BlobView data) {
+  BitReader reader(data);
+  const auto count = static_cast<size_t>(reader.read(32));
+
+  std::vector<GorillaSample> samples;
+  if (count == 0) {
+    return samples;
+  }
+  // Every sample after the first takes at least two bits
+  samples.reserve(std::min(count, data.size() * 4 + 1));
+
+  uint64_t timestamp = reader.read(64);
+  uint64_t delta = 0;
+  uint64_t value = reader.read(64);
+  int leading = -1;
+  int trailing = 0;
+  samples.push_back({static_cast<int64_t>(timestamp), fromBits(value)});
+
+  for (size_t i = 1; i < count; ++i) {
+    if (reader.readBit()) {
+      int64_t dod = 0;
+      int prefixBits = 1;
+      for (const auto& bucket : kDodBuckets) {
+        // The last bucket is selected by its final prefix bit being 1
+        if (prefixBits == bucket.prefixBits || !reader.readBit()) {
+          dod = signExtend(reader.read(bucket.payloadBits),
+                           bucket.payloadBits);
+          break;
+        }
+        ++prefixBits;
+      }
+      delta += static_cast<uint64_t>(dod);
+    }
+    timestamp += delta;
+
+    if (reader.readBit()) {
+      if (reader.readBit()) {
+        leading = static_cast<int>(reader.read(5));
+        const int length = static_cast<int>(reader.read(6)) + 1;
+        trailing = 64 - leading - length;
+        if (trailing < 0) {
+          throw QueryException("Malformed time series chunk");
+        }
+      } else if (leading < 0) {
+        throw QueryException("Malformed time series chunk");
+      }
+      value ^= reader.read(64 - leading - trailing) << trailing;
+    }
+
+    samples.push_back({static_cast<int64_t>(timestamp), fromBits(value)});
+  }
+
+  return samples;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
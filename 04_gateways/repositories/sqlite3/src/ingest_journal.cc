@@ -0,0 +1,787 @@
+#include "ingest_journal.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+constexpr uint64_t kFirstRecord = sizeof(JournalSegmentHeader);
+constexpr size_t kMinSegmentBytes = 4096;
+constexpr const char* kSegmentSuffix = ".journal";
+
+// Per point: timestamp, value and the two id sizes
+constexpr size_t kPointBytes = 8 + 8 + 2 + 2;
+
+// ============================================================
+// CRC-32C
+// ============================================================
+
+#if defined(__SSE4_2__)
+uint32_t crc32c(const uint8_t* data, size_t size) {
+  uint64_t crc = 0xFFFFFFFFu;
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    crc = _mm_crc32_u64(crc, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc);
+  for (; size > 0; ++data, --size) {
+    crc32 = _mm_crc32_u8(crc32, *data);
+  }
+  return ~crc32;
+}
+#else
+std::array<uint32_t, 256> crc32cTable() {
+  constexpr uint32_t kPolynomial = 0x82F63B78;  // Castagnoli, reflected
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (crc & 1 ? kPolynomial : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+uint32_t crc32c(const uint8_t* data, size_t size) {
+  static const std::array<uint32_t, 256> table = crc32cTable();
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; ++i) {
+    crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+  }
+  return ~crc;
+}
+#endif
+
+// ============================================================
+// Records
+// ============================================================
+
+uint64_t recordBytes(uint32_t payload_size) {
+  return (sizeof(JournalRecordHeader) + payload_size + 7) & ~uint64_t{7};
+}
+
+template <typename T>
+void put(uint8_t*& out, T value) {
+  std::memcpy(out, &value, sizeof(value));
+  out += sizeof(value);
+}
+
+// Reads a T at offset from a payload of size bytes; false past the end
+template <typename T>
+bool take(const uint8_t* payload, size_t size, size_t& offset, T& value) {
+  if (size - offset < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, payload + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+// Appends the payload's points to out if it is not null; false if the
+// payload is malformed
+bool decodePayload(const uint8_t* payload, size_t size,
+                   std::vector<Entities::TimeSeriesPoint>* out) {
+  size_t offset = 0;
+  uint32_t count = 0;
+  if (!take(payload, size, offset, count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    int64_t timestamp_ms = 0;
+    double value = 0.0;
+    uint16_t asset_size = 0;
+    uint16_t unit_size = 0;
+    if (!take(payload, size, offset, timestamp_ms) ||
+        !take(payload, size, offset, value) ||
+        !take(payload, size, offset, asset_size) ||
+        !take(payload, size, offset, unit_size) ||
+        size - offset < size_t{asset_size} + unit_size) {
+      return false;
+    }
+    if (out) {
+      const auto* ids = reinterpret_cast<const char*>(payload + offset);
+      out->push_back({std::string(ids, asset_size), timestamp_ms,
+                      std::string(ids + asset_size, unit_size), value});
+    }
+    offset += size_t{asset_size} + unit_size;
+  }
+  return offset == size;
+}
+
+// ============================================================
+// Files
+// ============================================================
+
+size_t pageSize() {
+  static const auto size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+std::string errorText() { return std::strerror(errno); }
+
+// msync() of [begin, end) of a mapping, widened to whole pages
+void syncRange(uint8_t* data, uint64_t begin, uint64_t end) {
+  const uint64_t first = begin / pageSize() * pageSize();
+  if (::msync(data + first, static_cast<size_t>(end - first), MS_SYNC) != 0) {
+    throw IngestJournalException("msync failed: " + errorText());
+  }
+}
+
+// Makes a created or deleted segment file's directory entry durable
+void syncDirectory(const std::string& directory) {
+  const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    throw IngestJournalException("cannot open " + directory);
+  }
+  const int result = ::fsync(fd);
+  ::close(fd);
+  if (result != 0) {
+    throw IngestJournalException("cannot sync " + directory);
+  }
+}
+
+uint8_t* mapFile(int fd, size_t size) {
+  void* data =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  return data == MAP_FAILED ? nullptr : static_cast<uint8_t*>(data);
+}
+
+}  // namespace
+
+// ============================================================
+// Segment
+// ============================================================
+
+struct IngestJournal::Segment {
+  Segment(uint64_t number, std::string path, uint8_t* data, size_t size)
+      : number(number), path(std::move(path)), data(data), size(size) {}
+  ~Segment() { ::munmap(data, size); }
+
+  Segment(const Segment&) = delete;
+  Segment& operator=(const Segment&) = delete;
+
+  const uint64_t number;
+  const std::string path;
+  uint8_t* const data;
+  const size_t size;
+  uint64_t used = kFirstRecord;    // end of the last record, m_mutex
+  uint64_t synced = kFirstRecord;  // m_syncMutex
+};
+
+// ============================================================
+// IngestJournal Implementation
+// ============================================================
+
+IngestJournal::IngestJournal(const std::string& directory,
+                             const JournalOptions& options)
+    : m_directory(directory), m_options([&options] {
+        JournalOptions normalized = options;
+        normalized.segmentBytes =
+            (std::max(normalized.segmentBytes, kMinSegmentBytes) + 7) &
+            ~size_t{7};
+        return normalized;
+      }()) {
+  std::error_code error;
+  std::filesystem::create_directories(m_directory, error);
+  if (error) {
+    throw IngestJournalException("cannot create " + m_directory);
+  }
+  recover();
+
+  if (m_options.sync == JournalSync::Periodic) {
+    m_syncer = std::thread(&IngestJournal::syncLoop, this);
+  }
+}
+
+IngestJournal::~IngestJournal() {
+  if (m_syncer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_syncerMutex);
+      m_stopping = true;
+    }
+    m_syncerWake.notify_all();
+    m_syncer.join();
+  }
+  if (m_options.sync != JournalSync::None) {
+    try {
+      sync();
+    } catch (...) {
+      // Nothing to report to; the pages are still written back later
+    }
+  }
+}
+
+JournalPosition IngestJournal::append(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (points.empty()) {
+    return {m_current->number, m_current->used};
+  }
+  encode(points);
+  const uint64_t bytes = m_record.size();
+  if (bytes > m_options.segmentBytes - kFirstRecord) {
+    throw std::invalid_argument("Journal record of " + std::to_string(bytes) +
+                                " bytes does not fit in a segment");
+  }
+  if (m_current->used + bytes > m_current->size) {
+    auto next = createSegment(m_current->number + 1);
+    m_segments.emplace(next->number, next);
+    m_current = std::move(next);
+  }
+
+  std::shared_ptr<Segment> segment = m_current;
+  const uint64_t begin = segment->used;
+  std::memcpy(segment->data + begin, m_record.data(), bytes);
+  segment->used = begin + bytes;
+  ++m_stats.records;
+  m_stats.points += points.size();
+  m_stats.bytes += bytes;
+  const JournalPosition end{segment->number, segment->used};
+
+  if (m_options.sync == JournalSync::EveryAppend) {
+    ++m_stats.syncs;
+    lock.unlock();
+    // Other appends go on meanwhile; the segment stays mapped while held
+    syncRange(segment->data, begin, end.offset);
+  }
+  return end;
+}
+
+JournalPosition IngestJournal::append(const Entities::TimeSeriesPoint& point) {
+  return append(std::vector<Entities::TimeSeriesPoint>{point});
+}
+
+void IngestJournal::sync() {
+  std::lock_guard<std::mutex> sync_lock(m_syncMutex);
+  std::vector<std::pair<std::shared_ptr<Segment>, uint64_t>> dirty;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [number, segment] : m_segments) {
+      if (segment->synced < segment->used) {
+        dirty.emplace_back(segment, segment->used);
+      }
+    }
+  }
+  // Outside m_mutex, so appends are not held up
+  for (const auto& [segment, used] : dirty) {
+    syncRange(segment->data, segment->synced, used);
+    segment->synced = used;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.syncs += dirty.size();
+}
+
+JournalPosition IngestJournal::begin() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_segments.begin()->first, kFirstRecord};
+}
+
+JournalPosition IngestJournal::end() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_current->number, m_current->used};
+}
+
+JournalPosition IngestJournal::read(
+    JournalPosition from, size_t maxPoints,
+    std::vector<Entities::TimeSeriesPoint>& out) const {
+  JournalPosition position = from;
+  size_t taken = 0;
+  while (taken < maxPoints) {
+    std::shared_ptr<Segment> segment;
+    uint64_t used = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_segments.find(position.segment);
+      if (it == m_segments.end()) {
+        throw IngestJournalException(
+            "segment " + std::to_string(position.segment) + " is not kept");
+      }
+      segment = it->second;
+      used = segment->used;
+      if (position.offset >= used) {
+        if (segment == m_current) {
+          break;
+        }
+        // Past the end of a full segment: on to the next one
+        position = {std::next(it)->first, kFirstRecord};
+        continue;
+      }
+    }
+
+    // Bytes before `used` are never written again, so no lock is needed
+    JournalRecordHeader header;
+    std::memcpy(&header, segment->data + position.offset, sizeof(header));
+    const uint8_t* payload =
+        segment->data + position.offset + sizeof(header);
+    const size_t before = out.size();
+    if (position.offset % 8 != 0 || header.size == 0 ||
+        header.size > used - position.offset - sizeof(header) ||
+        !decodePayload(payload, header.size, &out)) {
+      out.resize(before);
+      throw IngestJournalException("no record at " +
+                                   std::to_string(position.segment) + ":" +
+                                   std::to_string(position.offset));
+    }
+    taken += out.size() - before;
+    position.offset += recordBytes(header.size);
+  }
+  return position;
+}
+
+size_t IngestJournal::release(JournalPosition upto) {
+  std::vector<std::shared_ptr<Segment>> released;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_segments.begin();
+         it != m_segments.end() && it->first < upto.segment &&
+         it->second != m_current;) {
+      released.push_back(it->second);
+      it = m_segments.erase(it);
+    }
+    m_stats.segmentsReleased += released.size();
+  }
+  // A reader still holding one keeps its mapping until it lets go
+  for (const auto& segment : released) {
+    ::unlink(segment->path.c_str());
+  }
+  return released.size();
+}
+
+JournalStats IngestJournal::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+const std::string& IngestJournal::directory() const { return m_directory; }
+
+void IngestJournal::recover() {
+  std::vector<uint64_t> numbers;
+  for (const auto& entry : std::filesystem::directory_iterator(m_directory)) {
+    const std::string name = entry.path().filename().string();
+    const size_t digits = name.size() - std::strlen(kSegmentSuffix);
+    if (name.size() > std::strlen(kSegmentSuffix) &&
+        name.compare(digits, std::string::npos, kSegmentSuffix) == 0 &&
+        std::all_of(name.begin(), name.begin() + digits,
+                    [](char c) { return c >= '0' && c <= '9'; })) {
+      numbers.push_back(std::stoull(name.substr(0, digits)));
+    }
+  }
+  std::sort(numbers.begin(), numbers.end());
+
+  for (size_t i = 0; i < numbers.size(); ++i) {
+    const bool last = i + 1 == numbers.size();
+    auto segment = openSegment(numbers[i]);
+    if (!segment) {
+      // Created, but the header never made it: the crash came first
+      if (!last) {
+        throw IngestJournalException("segment " + segmentPath(numbers[i]) +
+                                     " has no header");
+      }
+      ::unlink(segmentPath(numbers[i]).c_str());
+      break;
+    }
+
+    uint64_t offset = kFirstRecord;
+    bool torn = false;
+    while (segment->size - offset >= sizeof(JournalRecordHeader)) {
+      JournalRecordHeader header;
+      std::memcpy(&header, segment->data + offset, sizeof(header));
+      if (header.size == 0) {
+        break;
+      }
+      const uint8_t* payload = segment->data + offset + sizeof(header);
+      if (header.size > segment->size - offset - sizeof(header) ||
+          crc32c(payload, header.size) != header.checksum ||
+          !decodePayload(payload, header.size, nullptr)) {
+        torn = true;
+        break;
+      }
+      offset += recordBytes(header.size);
+      ++m_stats.recoveredRecords;
+    }
+    segment->used = offset;
+    segment->synced = offset;
+    m_stats.tornTails += torn ? 1 : 0;
+
+    if (last && torn) {
+      // Zero what follows, so a shorter record appended over the torn one
+      // leaves nothing that could pass for the next record. Truncating
+      // and growing the file does that without touching the pages.
+      const std::string path = segment->path;
+      const size_t size = segment->size;
+      segment.reset();
+      if (::truncate(path.c_str(), static_cast<off_t>(offset)) != 0 ||
+          ::truncate(path.c_str(), static_cast<off_t>(size)) != 0) {
+        throw IngestJournalException("cannot truncate " + path);
+      }
+      segment = openSegment(numbers[i]);
+      segment->used = offset;
+      segment->synced = offset;
+    }
+    m_segments.emplace(segment->number, segment);
+  }
+
+  if (m_segments.empty()) {
+    auto first = createSegment(numbers.empty() ? 1 : numbers.back());
+    m_segments.emplace(first->number, first);
+  }
+  m_current = m_segments.rbegin()->second;
+}
+
+std::shared_ptr<IngestJournal::Segment> IngestJournal::createSegment(
+    uint64_t number) {
+  const std::string path = segmentPath(number);
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw IngestJournalException("cannot create " + path);
+  }
+  const size_t size = m_options.segmentBytes;
+  uint8_t* data = nullptr;
+  if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+    data = mapFile(fd, size);
+  }
+  ::close(fd);
+  if (!data) {
+    ::unlink(path.c_str());
+    throw IngestJournalException("cannot map " + path + ": " + errorText());
+  }
+  auto segment = std::make_shared<Segment>(number, path, data, size);
+
+  JournalSegmentHeader header{};
+  std::memcpy(header.magic, kJournalMagic, sizeof(header.magic));
+  header.version = kJournalVersion;
+  header.byte_order = kJournalByteOrder;
+  header.segment = number;
+  header.segment_bytes = size;
+  std::memcpy(data, &header, sizeof(header));
+  if (m_options.sync != JournalSync::None) {
+    syncRange(data, 0, sizeof(header));
+    syncDirectory(m_directory);
+  }
+  ++m_stats.segmentsCreated;
+  return segment;
+}
+
+std::shared_ptr<IngestJournal::Segment> IngestJournal::openSegment(
+    uint64_t number) {
+  const std::string path = segmentPath(number);
+  const int fd = ::open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    throw IngestJournalException("cannot open " + path);
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw IngestJournalException("cannot stat " + path);
+  }
+  const auto size = static_cast<size_t>(info.st_size);
+  if (size < kFirstRecord) {
+    ::close(fd);
+    return nullptr;
+  }
+  uint8_t* data = mapFile(fd, size);
+  ::close(fd);
+  if (!data) {
+    throw IngestJournalException("cannot map " + path + ": " + errorText());
+  }
+  auto segment = std::make_shared<Segment>(number, path, data, size);
+
+  JournalSegmentHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  const JournalSegmentHeader unwritten{};
+  if (std::memcmp(&header, &unwritten, sizeof(header)) == 0) {
+    return nullptr;
+  }
+  if (std::memcmp(header.magic, kJournalMagic, sizeof(header.magic)) != 0) {
+    throw IngestJournalException(path + " is not a journal segment");
+  }
+  if (header.version != kJournalVersion) {
+    throw IngestJournalException(path + " has unsupported version " +
+                                 std::to_string(header.version));
+  }
+  if (header.byte_order != kJournalByteOrder) {
+    throw IngestJournalException(path + " was written with another byte order");
+  }
+  if (header.segment != number || header.segment_bytes != size) {
+    throw IngestJournalException(path + " was renamed or resized");
+  }
+  return segment;
+}
+
+std::string IngestJournal::segmentPath(uint64_t number) const {
+  // Zero-padded, so the names sort in segment order
+  std::string digits = std::to_string(number);
+  digits.insert(0, 20 - std::min<size_t>(20, digits.size()), '0');
+  return m_directory + "/" + digits + kSegmentSuffix;
+}
+
+void IngestJournal::encode(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  if (points.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("Too many points for one journal record");
+  }
+  size_t payload_size = sizeof(uint32_t) + points.size() * kPointBytes;
+  for (const auto& point : points) {
+    if (point.asset_id.size() > std::numeric_limits<uint16_t>::max() ||
+        point.unit_id.size() > std::numeric_limits<uint16_t>::max()) {
+      throw std::invalid_argument("Id too long for the ingest journal");
+    }
+    payload_size += point.asset_id.size() + point.unit_id.size();
+  }
+  if (payload_size > m_options.segmentBytes) {
+    throw std::invalid_argument("Journal record of " +
+                                std::to_string(payload_size) +
+                                " bytes does not fit in a segment");
+  }
+
+  // resize() only allocates while the buffer grows to its largest record
+  const auto size = static_cast<uint32_t>(payload_size);
+  m_record.resize(static_cast<size_t>(recordBytes(size)));
+  uint8_t* out = m_record.data() + sizeof(JournalRecordHeader);
+  put(out, static_cast<uint32_t>(points.size()));
+  for (const auto& point : points) {
+    put(out, point.timestamp_ms);
+    put(out, point.value);
+    put(out, static_cast<uint16_t>(point.asset_id.size()));
+    put(out, static_cast<uint16_t>(point.unit_id.size()));
+    std::memcpy(out, point.asset_id.data(), point.asset_id.size());
+    out += point.asset_id.size();
+    std::memcpy(out, point.unit_id.data(), point.unit_id.size());
+    out += point.unit_id.size();
+  }
+  std::fill(out, m_record.data() + m_record.size(), uint8_t{0});
+
+  const JournalRecordHeader header{
+      size, crc32c(m_record.data() + sizeof(JournalRecordHeader), size)};
+  std::memcpy(m_record.data(), &header, sizeof(header));
+}
+
+void IngestJournal::syncLoop() {
+  std::unique_lock<std::mutex> lock(m_syncerMutex);
+  while (!m_syncerWake.wait_for(lock, m_options.syncInterval,
+                                [this] { return m_stopping; })) {
+    lock.unlock();
+    try {
+      sync();
+    } catch (...) {
+      // The next interval retries
+    }
+    lock.lock();
+  }
+}
+
+// ============================================================
+// IngestJournalApplier Implementation
+// ============================================================
+
+IngestJournalApplier::IngestJournalApplier(IDatabase& db,
+                                           TimeSeriesRepository& repository,
+                                           IngestJournal& journal,
+                                           const JournalApplierOptions& options)
+    : m_db(db),
+      m_repository(repository),
+      m_journal(journal),
+      m_options([&options] {
+        JournalApplierOptions normalized = options;
+        normalized.batchPoints = std::max<size_t>(1, normalized.batchPoints);
+        return normalized;
+      }()) {}
+
+IngestJournalApplier::~IngestJournalApplier() { stop(); }
+
+void IngestJournalApplier::initSchema() {
+  migrateSchema(m_db, "ingest_journal", {[](IDatabase& db) {
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS ingest_journal_checkpoints (
+        name TEXT PRIMARY KEY,
+        segment INTEGER NOT NULL,
+        byte_offset INTEGER NOT NULL
+      ) WITHOUT ROWID
+    )");
+  }});
+}
+
+JournalPosition IngestJournalApplier::checkpoint() {
+  std::lock_guard<std::mutex> lock(m_batchMutex);
+  if (!m_loaded) {
+    auto stmt = m_db.prepare(
+        "SELECT segment, byte_offset FROM ingest_journal_checkpoints "
+        "WHERE name = ?");
+    stmt->bind(1, m_options.name);
+    JournalPosition position = m_journal.begin();
+    if (auto row = stmt->fetchOne<int64_t, int64_t>()) {
+      position = {static_cast<uint64_t>(std::get<0>(*row)),
+                  static_cast<uint64_t>(std::get<1>(*row))};
+      if (position < m_journal.begin() || m_journal.end() < position) {
+        throw IngestJournalException(
+            "checkpoint " + m_options.name + " at " +
+            std::to_string(position.segment) + ":" +
+            std::to_string(position.offset) + " is outside " +
+            m_journal.directory());
+      }
+    }
+    m_position = position;
+    m_loaded = true;
+    {
+      std::lock_guard<std::mutex> state_lock(m_mutex);
+      m_committed = position;
+    }
+    m_applied.notify_all();
+  }
+  return m_position;
+}
+
+size_t IngestJournalApplier::applyPending() {
+  const JournalPosition target = m_journal.end();
+  size_t points = 0;
+  while (checkpoint() < target) {
+    std::lock_guard<std::mutex> lock(m_batchMutex);
+    if (!applyBatch()) {
+      break;
+    }
+    points += m_batch.size();
+  }
+  return points;
+}
+
+void IngestJournalApplier::start() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_worker.joinable()) {
+    return;
+  }
+  m_stopping = false;
+  m_worker = std::thread(&IngestJournalApplier::run, this);
+}
+
+void IngestJournalApplier::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_worker.joinable()) {
+      return;
+    }
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  m_applied.notify_all();
+  m_worker.join();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_worker = std::thread();
+  m_stopping = false;
+}
+
+bool IngestJournalApplier::isRunning() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_worker.joinable() && !m_stopping;
+}
+
+void IngestJournalApplier::flush() {
+  const JournalPosition target = m_journal.end();
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_worker.joinable() && !m_stopping) {
+      m_wake.notify_all();
+      m_applied.wait(lock, [this, &target] {
+        // m_committed starts before any position, until loaded
+        return target <= m_committed || m_stopping;
+      });
+      return;
+    }
+  }
+  applyPending();
+}
+
+JournalApplierStats IngestJournalApplier::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void IngestJournalApplier::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stopping) {
+    lock.unlock();
+    bool more = false;
+    try {
+      checkpoint();
+      std::lock_guard<std::mutex> batch_lock(m_batchMutex);
+      more = applyBatch();
+    } catch (...) {
+      // Rolled back; the next poll retries the same records
+      lock.lock();
+      ++m_stats.failures;
+      lock.unlock();
+    }
+    lock.lock();
+    if (!more) {
+      // flush() wakes this early
+      m_wake.wait_for(lock, m_options.pollInterval);
+    }
+  }
+}
+
+bool IngestJournalApplier::applyBatch() {
+  m_batch.clear();
+  const JournalPosition next =
+      m_journal.read(m_position, m_options.batchPoints, m_batch);
+  if (next == m_position) {
+    return false;
+  }
+
+  m_db.beginTransaction();
+  try {
+    if (!m_batch.empty()) {
+      m_repository.addPoints(m_batch);
+    }
+    saveCheckpoint(next);
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    // The batch's points must not outlive it in the repository's caches
+    m_repository.invalidateLatestCache();
+    throw;
+  }
+  m_position = next;
+  const size_t released = m_journal.release(next);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.batches;
+    m_stats.points += m_batch.size();
+    m_stats.segmentsReleased += released;
+    m_committed = next;
+  }
+  m_applied.notify_all();
+  return true;
+}
+
+void IngestJournalApplier::saveCheckpoint(const JournalPosition& position) {
+  auto stmt = m_db.prepare(
+      "INSERT OR REPLACE INTO ingest_journal_checkpoints "
+      "(name, segment, byte_offset) VALUES (?, ?, ?)");
+  stmt->bind(1, m_options.name)
+      .bind(2, static_cast<int64_t>(position.segment))
+      .bind(3, static_cast<int64_t>(position.offset));
+  stmt->executeUpdate();
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
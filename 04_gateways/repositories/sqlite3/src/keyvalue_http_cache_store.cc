@@ -0,0 +1,27 @@
+#include "keyvalue_http_cache_store.h"
+
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+KeyValueHttpCacheStore::KeyValueHttpCacheStore(KeyValueRepository& repository,
+                                               std::string prefix)
+    : m_repository(repository), m_prefix(std::move(prefix)) {}
+
+std::optional<std::string> KeyValueHttpCacheStore::load(
+    const std::string& key) {
+  return m_repository.getValue(m_prefix + key);
+}
+
+void KeyValueHttpCacheStore::save(const std::string& key,
+                                  const std::string& value) {
+  m_repository.set(m_prefix + key, value);
+}
+
+void KeyValueHttpCacheStore::remove(const std::string& key) {
+  m_repository.remove(m_prefix + key);
+}
+
+void KeyValueHttpCacheStore::clear() { m_repository.removeByPrefix(m_prefix); }
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -1,19 +1,38 @@
 #include "keyvalue_repository.h"
 
+#include <algorithm>
+#include <functional>
+
+#include "prefix_range.h"
+
 namespace Gateways::Repositories::Sqlite3 {
 
 using namespace Gateways::Database;
 
-KeyValueRepository::KeyValueRepository(IDatabase& db) : m_db(db) {}
+KeyValueRepository::KeyValueRepository(IDatabase& db,
+                                       const KeyValueOptions& options)
+    : m_db(db) {
+  if (options.cache) {
+    const size_t shards = std::max<size_t>(1, options.cacheShards);
+    m_shards.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+      m_shards.push_back(std::make_unique<CacheShard>());
+    }
+    m_shardCapacity = std::max<size_t>(1, options.cacheCapacity / shards);
+  }
+}
 
 void KeyValueRepository::initSchema() {
-  m_db.execute(R"(
-    CREATE TABLE IF NOT EXISTS settings (
-      key TEXT PRIMARY KEY,
-      value TEXT NOT NULL,
-      description TEXT
-    )
-  )");
+  // IF NOT EXISTS: databases from before versioning have the table
+  migrateSchema(m_db, "settings", {[](IDatabase& db) {
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS settings (
+        key TEXT PRIMARY KEY,
+        value TEXT NOT NULL,
+        description TEXT
+      )
+    )");
+  }});
 }
 
 // ============================================================
@@ -34,6 +53,7 @@ void KeyValueRepository::set(const std::string& key, const std::string& value,
   }
 
   stmt->executeInsert();
+  invalidate(key);
 }
 
 void KeyValueRepository::set(const Entities::Setting& setting) {
@@ -42,6 +62,11 @@ void KeyValueRepository::set(const Entities::Setting& setting) {
 
 std::optional<Entities::Setting> KeyValueRepository::get(
     const std::string& key) {
+  return lookup(key);
+}
+
+std::optional<Entities::Setting> KeyValueRepository::load(
+    const std::string& key) {
   auto stmt = m_db.prepare(
       "SELECT key, value, description FROM settings WHERE key = ?");
   stmt->bind(1, key);
@@ -64,6 +89,14 @@ std::optional<Entities::Setting> KeyValueRepository::get(
 
 std::optional<std::string> KeyValueRepository::getValue(
     const std::string& key) {
+  if (!m_shards.empty()) {
+    auto setting = lookup(key);
+    if (!setting) {
+      return std::nullopt;
+    }
+    return std::move(setting->value);
+  }
+
   auto stmt = m_db.prepare("SELECT value FROM settings WHERE key = ?");
   stmt->bind(1, key);
   auto result = stmt->execute();
@@ -76,6 +109,10 @@ std::optional<std::string> KeyValueRepository::getValue(
 }
 
 bool KeyValueRepository::exists(const std::string& key) {
+  if (!m_shards.empty()) {
+    return lookup(key).has_value();
+  }
+
   auto stmt = m_db.prepare("SELECT 1 FROM settings WHERE key = ?");
   stmt->bind(1, key);
   auto result = stmt->execute();
@@ -86,6 +123,7 @@ void KeyValueRepository::remove(const std::string& key) {
   auto stmt = m_db.prepare("DELETE FROM settings WHERE key = ?");
   stmt->bind(1, key);
   stmt->executeUpdate();
+  invalidate(key);
 }
 
 // ============================================================
@@ -116,10 +154,11 @@ std::vector<Entities::Setting> KeyValueRepository::getAll() {
 
 std::vector<Entities::Setting> KeyValueRepository::getByPrefix(
     const std::string& prefix) {
+  const auto range = prefixRange(prefix);
   auto stmt = m_db.prepare(
-      "SELECT key, value, description FROM settings "
-      "WHERE key LIKE ? ORDER BY key");
-  stmt->bind(1, prefix + "%");
+      "SELECT key, value, description FROM settings WHERE " +
+      prefixCondition(range, "key") + " ORDER BY key");
+  bindPrefixRange(*stmt, 1, range);
   auto result = stmt->execute();
 
   std::vector<Entities::Setting> settings;
@@ -155,9 +194,10 @@ std::vector<std::string> KeyValueRepository::getKeys() {
 
 std::vector<std::string> KeyValueRepository::getKeysByPrefix(
     const std::string& prefix) {
-  auto stmt =
-      m_db.prepare("SELECT key FROM settings WHERE key LIKE ? ORDER BY key");
-  stmt->bind(1, prefix + "%");
+  const auto range = prefixRange(prefix);
+  auto stmt = m_db.prepare("SELECT key FROM settings WHERE " +
+                           prefixCondition(range, "key") + " ORDER BY key");
+  bindPrefixRange(*stmt, 1, range);
   auto result = stmt->execute();
 
   std::vector<std::string> keys;
@@ -171,12 +211,110 @@ std::vector<std::string> KeyValueRepository::getKeysByPrefix(
 }
 
 void KeyValueRepository::removeByPrefix(const std::string& prefix) {
-  auto stmt = m_db.prepare("DELETE FROM settings WHERE key LIKE ?");
-  stmt->bind(1, prefix + "%");
+  const auto range = prefixRange(prefix);
+  auto stmt = m_db.prepare("DELETE FROM settings WHERE " +
+                           prefixCondition(range, "key"));
+  bindPrefixRange(*stmt, 1, range);
   stmt->executeUpdate();
+  invalidatePrefix(prefix);
 }
 
-void KeyValueRepository::clear() { m_db.execute("DELETE FROM settings"); }
+void KeyValueRepository::clear() {
+  m_db.execute("DELETE FROM settings");
+  invalidateCache();
+}
+
+// ============================================================
+// Batches
+// ============================================================
+
+std::map<std::string, Entities::Setting> KeyValueRepository::getMany(
+    const std::vector<std::string>& keys) {
+  std::map<std::string, Entities::Setting> settings;
+
+  // Misses, with the epoch of their shard when they missed
+  std::map<std::string, uint64_t> missing;
+  for (const auto& key : keys) {
+    if (m_shards.empty()) {
+      missing.emplace(key, 0);
+      continue;
+    }
+    if (settings.count(key) != 0 || missing.count(key) != 0) {
+      continue;
+    }
+    std::optional<Entities::Setting> setting;
+    uint64_t epoch = 0;
+    if (!cached(key, setting, epoch)) {
+      missing.emplace(key, epoch);
+    } else if (setting) {
+      settings.emplace(key, std::move(*setting));
+    }
+  }
+  if (missing.empty()) {
+    return settings;
+  }
+
+  std::vector<std::string> lookups;
+  lookups.reserve(missing.size());
+  for (const auto& [key, epoch] : missing) {
+    lookups.push_back(key);
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT s.key, s.value, s.description "
+      "FROM json_each(?) AS k JOIN settings AS s ON s.key = k.value");
+  stmt->bind(1, toJsonArray(lookups));
+  for (const RowView& row : stmt->rows()) {
+    Entities::Setting setting;
+    setting.key = row.get<std::string>(0);
+    setting.value = row.get<std::string>(1);
+    setting.description = row.get<std::optional<std::string>>(2);
+    settings.emplace(setting.key, std::move(setting));
+  }
+
+  if (!m_shards.empty()) {
+    for (const auto& [key, epoch] : missing) {
+      auto it = settings.find(key);
+      fill(key, epoch,
+           it == settings.end() ? std::nullopt
+                                : std::optional<Entities::Setting>(it->second));
+    }
+  }
+  return settings;
+}
+
+void KeyValueRepository::setMany(
+    const std::vector<Entities::Setting>& settings) {
+  if (settings.empty()) {
+    return;
+  }
+
+  auto stmt = m_db.prepare(
+      "INSERT OR REPLACE INTO settings (key, value, description) "
+      "VALUES (?, ?, ?)");
+
+  m_db.beginTransaction();
+  try {
+    for (const auto& setting : settings) {
+      stmt->reset();
+      stmt->bind(1, setting.key).bind(2, setting.value);
+      if (setting.description) {
+        stmt->bind(3, *setting.description);
+      } else {
+        stmt->bind(3, nullptr);
+      }
+      stmt->executeInsert();
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+
+  for (const auto& setting : settings) {
+    invalidate(setting.key);
+  }
+}
 
 // ============================================================
 // Count
@@ -188,10 +326,113 @@ int64_t KeyValueRepository::count() {
 }
 
 int64_t KeyValueRepository::countByPrefix(const std::string& prefix) {
-  auto stmt = m_db.prepare("SELECT COUNT(*) FROM settings WHERE key LIKE ?");
-  stmt->bind(1, prefix + "%");
+  const auto range = prefixRange(prefix);
+  auto stmt = m_db.prepare("SELECT COUNT(*) FROM settings WHERE " +
+                           prefixCondition(range, "key"));
+  bindPrefixRange(*stmt, 1, range);
   auto result = stmt->execute();
   return std::get<int64_t>(result[0][0]);
 }
 
+// ============================================================
+// Cache
+// ============================================================
+
+KeyValueCacheStats KeyValueRepository::cacheStats() const {
+  KeyValueCacheStats stats;
+  stats.hits = m_hits.load(std::memory_order_relaxed);
+  stats.negativeHits = m_negativeHits.load(std::memory_order_relaxed);
+  stats.misses = m_misses.load(std::memory_order_relaxed);
+  for (const auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->entries.size();
+  }
+  return stats;
+}
+
+void KeyValueRepository::invalidateCache() {
+  for (auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->entries.clear();
+    ++shard->epoch;
+  }
+}
+
+std::optional<Entities::Setting> KeyValueRepository::lookup(
+    const std::string& key) {
+  if (m_shards.empty()) {
+    return load(key);
+  }
+
+  std::optional<Entities::Setting> setting;
+  uint64_t epoch = 0;
+  if (cached(key, setting, epoch)) {
+    return setting;
+  }
+  setting = load(key);
+  fill(key, epoch, setting);
+  return setting;
+}
+
+bool KeyValueRepository::cached(const std::string& key,
+                                std::optional<Entities::Setting>& setting,
+                                uint64_t& epoch) {
+  CacheShard& shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) {
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    epoch = shard.epoch;
+    return false;
+  }
+  m_hits.fetch_add(1, std::memory_order_relaxed);
+  if (!it->second) {
+    m_negativeHits.fetch_add(1, std::memory_order_relaxed);
+  }
+  setting = it->second;
+  return true;
+}
+
+void KeyValueRepository::fill(
+    const std::string& key, uint64_t epoch,
+    const std::optional<Entities::Setting>& setting) {
+  CacheShard& shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // An invalidation since the lookup may have made setting stale
+  if (shard.epoch != epoch) {
+    return;
+  }
+  if (shard.entries.size() >= m_shardCapacity &&
+      shard.entries.find(key) == shard.entries.end()) {
+    shard.entries.erase(shard.entries.begin());
+  }
+  shard.entries.insert_or_assign(key, setting);
+}
+
+KeyValueRepository::CacheShard& KeyValueRepository::shardFor(
+    const std::string& key) {
+  return *m_shards[std::hash<std::string>{}(key) % m_shards.size()];
+}
+
+void KeyValueRepository::invalidate(const std::string& key) {
+  if (m_shards.empty()) {
+    return;
+  }
+  CacheShard& shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.entries.erase(key);
+  ++shard.epoch;
+}
+
+void KeyValueRepository::invalidatePrefix(const std::string& prefix) {
+  for (auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (auto it = shard->entries.begin(); it != shard->entries.end();) {
+      it = hasPrefix(it->first, prefix) ? shard->entries.erase(it)
+                                           : std::next(it);
+    }
+    ++shard->epoch;
+  }
+}
+
 }  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,292 @@
+#include "latest_quote_publisher.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+namespace {
+
+std::string errorText() { return std::strerror(errno); }
+
+template <typename T>
+uint64_t toBits(T value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(value));
+  return bits;
+}
+
+// Word i of an id, zero padded
+uint64_t idWord(const std::string& id, size_t i) {
+  uint64_t word = 0;
+  if (i * 8 < id.size()) {
+    std::memcpy(&word, id.data() + i * 8,
+                std::min<size_t>(8, id.size() - i * 8));
+  }
+  return word;
+}
+
+void storeId(std::atomic<uint64_t>* words, size_t count,
+             const std::string& id) {
+  for (size_t i = 0; i < count; ++i) {
+    words[i].store(idWord(id, i), std::memory_order_relaxed);
+  }
+}
+
+std::string loadAssetId(const LatestQuoteSlot& slot) {
+  char id[kQuoteMaxAssetIdBytes];
+  for (size_t i = 0; i < kQuoteMaxAssetIdBytes / 8; ++i) {
+    const uint64_t word =
+        slot.words[kQuoteAssetId + i].load(std::memory_order_relaxed);
+    std::memcpy(id + i * 8, &word, sizeof(word));
+  }
+  return std::string(
+      id, slot.words[kQuoteAssetSize].load(std::memory_order_relaxed));
+}
+
+bool slotHolds(const LatestQuoteSlot& slot, uint64_t hash,
+               const std::string& asset_id) {
+  const auto& words = slot.words;
+  if (words[kQuoteHash].load(std::memory_order_relaxed) != hash ||
+      words[kQuoteAssetSize].load(std::memory_order_relaxed) !=
+          asset_id.size()) {
+    return false;
+  }
+  for (size_t i = 0; i * 8 < asset_id.size(); ++i) {
+    if (words[kQuoteAssetId + i].load(std::memory_order_relaxed) !=
+        idWord(asset_id, i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Marks a table left under the name closed, so its readers reopen, and
+// removes the name
+void replaceTable(const std::string& name) {
+  const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return;
+  }
+  struct stat info;
+  if (::fstat(fd, &info) == 0 &&
+      static_cast<size_t>(info.st_size) >= sizeof(LatestQuoteHeader)) {
+    void* data = ::mmap(nullptr, sizeof(LatestQuoteHeader),
+                        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+      auto* header = static_cast<LatestQuoteHeader*>(data);
+      if (std::memcmp(header->magic, kLatestQuoteMagic,
+                      sizeof(kLatestQuoteMagic)) == 0) {
+        header->state.store(static_cast<uint64_t>(QuoteTableState::Closed),
+                            std::memory_order_release);
+      }
+      ::munmap(data, sizeof(LatestQuoteHeader));
+    }
+  }
+  ::close(fd);
+  ::shm_unlink(name.c_str());
+}
+
+}  // namespace
+
+// ============================================================
+// LatestQuotePublisher Implementation
+// ============================================================
+
+LatestQuotePublisher::LatestQuotePublisher(TimeSeriesRepository& repository,
+                                           const std::string& name,
+                                           const LatestQuoteOptions& options)
+    : m_repository(repository), m_name(name), m_options(options) {
+  size_t capacity = 1;
+  while (capacity < std::max<size_t>(m_options.capacity, 4)) {
+    capacity <<= 1;
+  }
+  m_mask = capacity - 1;
+  m_bytes = sizeof(LatestQuoteHeader) + capacity * sizeof(LatestQuoteSlot);
+
+  replaceTable(m_name);
+  const int fd = ::shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) {
+    throw LatestQuoteException("cannot create " + m_name + ": " +
+                               errorText());
+  }
+  struct stat info;
+  void* data = MAP_FAILED;
+  if (::fstat(fd, &info) == 0 &&
+      ::ftruncate(fd, static_cast<off_t>(m_bytes)) == 0) {
+    data =
+        ::mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const std::string error = errorText();
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    ::shm_unlink(m_name.c_str());
+    throw LatestQuoteException("cannot map " + m_name + ": " + error);
+  }
+  m_device = info.st_dev;
+  m_inode = info.st_ino;
+
+  // The object starts zeroed: every slot empty, state Creating
+  m_header = static_cast<LatestQuoteHeader*>(data);
+  m_slots = reinterpret_cast<LatestQuoteSlot*>(m_header + 1);
+  std::memcpy(m_header->magic, kLatestQuoteMagic, sizeof(kLatestQuoteMagic));
+  m_header->version = kLatestQuoteVersion;
+  m_header->byte_order = kLatestQuoteByteOrder;
+  m_header->capacity = capacity;
+  m_header->slot_bytes = sizeof(LatestQuoteSlot);
+  m_header->state.store(static_cast<uint64_t>(QuoteTableState::Open),
+                        std::memory_order_release);
+
+  m_listener = m_repository.addIngestListener(
+      [this](const std::vector<Entities::TimeSeriesPoint>& points) {
+        onIngest(points);
+      });
+  try {
+    reload();
+  } catch (...) {
+    m_repository.removeIngestListener(m_listener);
+    ::munmap(data, m_bytes);
+    ::shm_unlink(m_name.c_str());
+    throw;
+  }
+}
+
+LatestQuotePublisher::~LatestQuotePublisher() {
+  m_repository.removeIngestListener(m_listener);
+  m_header->state.store(static_cast<uint64_t>(QuoteTableState::Closed),
+                        std::memory_order_release);
+  ::munmap(m_header, m_bytes);
+
+  if (m_options.unlinkOnClose) {
+    const int fd = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+    struct stat info;
+    if (fd >= 0 && ::fstat(fd, &info) == 0 && info.st_dev == m_device &&
+        info.st_ino == m_inode) {
+      ::shm_unlink(m_name.c_str());
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+}
+
+void LatestQuotePublisher::reload() {
+  // Ingest waits meanwhile, so no newer quote is overwritten
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::map<std::string, Entities::TimeSeriesPoint> latest;
+  for (const auto& asset : m_repository.getAllAssets()) {
+    if (auto point = m_repository.getLatestPoint(asset.id)) {
+      latest.emplace(asset.id, std::move(*point));
+    }
+  }
+
+  for (size_t i = 0; i <= m_mask; ++i) {
+    LatestQuoteSlot& slot = m_slots[i];
+    if (slot.sequence.load(std::memory_order_relaxed) != 0 &&
+        latest.find(loadAssetId(slot)) == latest.end()) {
+      write(slot, nullptr);
+    }
+  }
+  for (const auto& [asset_id, point] : latest) {
+    if (auto* slot = slotFor(point)) {
+      write(*slot, &point);
+    }
+  }
+}
+
+const std::string& LatestQuotePublisher::name() const { return m_name; }
+
+size_t LatestQuotePublisher::capacity() const { return m_mask + 1; }
+
+LatestQuoteStats LatestQuotePublisher::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void LatestQuotePublisher::onIngest(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& point : points) {
+    LatestQuoteSlot* slot = slotFor(point);
+    if (!slot) {
+      continue;
+    }
+    // Only this thread writes the slot, so its own reads need no retry
+    const auto& words = slot->words;
+    if (words[kQuoteUnitSize].load(std::memory_order_relaxed) != 0 &&
+        static_cast<int64_t>(
+            words[kQuoteTimestamp].load(std::memory_order_relaxed)) >
+            point.timestamp_ms) {
+      continue;  // older than the quote
+    }
+    write(*slot, &point);
+  }
+}
+
+LatestQuoteSlot* LatestQuotePublisher::slotFor(
+    const Entities::TimeSeriesPoint& point) {
+  if (point.asset_id.size() > kQuoteMaxAssetIdBytes ||
+      point.unit_id.size() > kQuoteMaxUnitIdBytes) {
+    ++m_stats.rejected;
+    return nullptr;
+  }
+  const uint64_t hash = latestQuoteHash(point.asset_id);
+  for (size_t i = hash & m_mask;; i = (i + 1) & m_mask) {
+    LatestQuoteSlot& slot = m_slots[i];
+    if (slot.sequence.load(std::memory_order_relaxed) != 0) {
+      if (slotHolds(slot, hash, point.asset_id)) {
+        return &slot;
+      }
+      continue;
+    }
+    // The asset is new; a quarter of the slots stays empty, so this
+    // probe always ends
+    if (m_stats.assets >= (m_mask + 1) / 4 * 3) {
+      ++m_stats.rejected;
+      return nullptr;
+    }
+    // The key is stored before the slot's first sequence, which
+    // publishes it
+    auto& words = slot.words;
+    words[kQuoteHash].store(hash, std::memory_order_relaxed);
+    words[kQuoteAssetSize].store(point.asset_id.size(),
+                                 std::memory_order_relaxed);
+    storeId(&words[kQuoteAssetId], kQuoteTimestamp - kQuoteAssetId,
+            point.asset_id);
+    ++m_stats.assets;
+    m_header->assets.store(m_stats.assets, std::memory_order_relaxed);
+    return &slot;
+  }
+}
+
+void LatestQuotePublisher::write(LatestQuoteSlot& slot,
+                                 const Entities::TimeSeriesPoint* point) {
+  const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_release);
+  // Keeps the quote stores below after the odd sequence
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto& words = slot.words;
+  if (point) {
+    words[kQuoteTimestamp].store(toBits(point->timestamp_ms),
+                                 std::memory_order_relaxed);
+    words[kQuoteValue].store(toBits(point->value), std::memory_order_relaxed);
+    words[kQuoteUnitSize].store(point->unit_id.size() + 1,
+                                std::memory_order_relaxed);
+    storeId(&words[kQuoteUnitId], kQuoteWords - kQuoteUnitId,
+            point->unit_id);
+    ++m_stats.published;
+  } else {
+    words[kQuoteUnitSize].store(0, std::memory_order_relaxed);
+  }
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
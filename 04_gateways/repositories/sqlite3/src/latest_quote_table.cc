@@ -0,0 +1,183 @@
+#include "latest_quote_table.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+namespace {
+
+// A slot whose sequence stays odd this long belongs to a publisher that
+// died mid-write
+constexpr int kMaxReadAttempts = 1 << 20;
+
+std::string errorText() { return std::strerror(errno); }
+
+template <typename T>
+T fromBits(uint64_t bits) {
+  T value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+bool keyMatches(const LatestQuoteSlot& slot, uint64_t hash,
+                std::string_view asset_id, const uint64_t* key) {
+  // Immutable once the sequence was seen non-zero, so no retry
+  const auto& words = slot.words;
+  if (words[kQuoteHash].load(std::memory_order_relaxed) != hash ||
+      words[kQuoteAssetSize].load(std::memory_order_relaxed) !=
+          asset_id.size()) {
+    return false;
+  }
+  for (size_t i = 0; i * 8 < asset_id.size(); ++i) {
+    if (words[kQuoteAssetId + i].load(std::memory_order_relaxed) != key[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+uint64_t latestQuoteHash(std::string_view asset_id) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (char c : asset_id) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+  }
+  return hash == 0 ? 1 : hash;
+}
+
+// ============================================================
+// LatestQuoteReader Implementation
+// ============================================================
+
+LatestQuoteReader::LatestQuoteReader(const std::string& name) {
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    throw LatestQuoteException("cannot open " + name + ": " + errorText());
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw LatestQuoteException("cannot stat " + name + ": " + errorText());
+  }
+  m_bytes = static_cast<size_t>(info.st_size);
+  if (m_bytes < sizeof(LatestQuoteHeader)) {
+    ::close(fd);
+    throw LatestQuoteException(name + " is still being created");
+  }
+  void* data = ::mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw LatestQuoteException("cannot map " + name + ": " + errorText());
+  }
+  m_header = static_cast<const LatestQuoteHeader*>(data);
+  m_slots = reinterpret_cast<const LatestQuoteSlot*>(m_header + 1);
+
+  const char* error = nullptr;
+  if (m_header->state.load(std::memory_order_acquire) ==
+      static_cast<uint64_t>(QuoteTableState::Creating)) {
+    error = " is still being created";
+  } else if (std::memcmp(m_header->magic, kLatestQuoteMagic,
+                         sizeof(kLatestQuoteMagic)) != 0 ||
+             m_header->version != kLatestQuoteVersion ||
+             m_header->byte_order != kLatestQuoteByteOrder ||
+             m_header->slot_bytes != sizeof(LatestQuoteSlot)) {
+    error = " is not a latest quote table of this format";
+  } else if (const uint64_t capacity = m_header->capacity;
+             capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+             (m_bytes - sizeof(LatestQuoteHeader)) / sizeof(LatestQuoteSlot) <
+                 capacity) {
+    error = " has a bad capacity";
+  }
+  if (error) {
+    ::munmap(data, m_bytes);
+    throw LatestQuoteException(name + error);
+  }
+  m_mask = static_cast<size_t>(m_header->capacity - 1);
+}
+
+LatestQuoteReader::~LatestQuoteReader() {
+  ::munmap(const_cast<LatestQuoteHeader*>(m_header), m_bytes);
+}
+
+bool LatestQuoteReader::lookup(std::string_view asset_id,
+                               LatestQuote& quote) const {
+  if (asset_id.size() > kQuoteMaxAssetIdBytes) {
+    return false;  // never published
+  }
+  uint64_t key[kQuoteMaxAssetIdBytes / 8] = {};
+  std::memcpy(key, asset_id.data(), asset_id.size());
+  const uint64_t hash = latestQuoteHash(asset_id);
+
+  const LatestQuoteSlot* slot = nullptr;
+  for (size_t i = hash & m_mask, probes = 0; probes <= m_mask;
+       i = (i + 1) & m_mask, ++probes) {
+    if (m_slots[i].sequence.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    if (keyMatches(m_slots[i], hash, asset_id, key)) {
+      slot = &m_slots[i];
+      break;
+    }
+  }
+  if (!slot) {
+    return false;
+  }
+
+  const auto& words = slot->words;
+  for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    const uint64_t before = slot->sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+      if (attempt > 64) {
+        std::this_thread::yield();
+      }
+      continue;
+    }
+    const uint64_t timestamp =
+        words[kQuoteTimestamp].load(std::memory_order_relaxed);
+    const uint64_t value = words[kQuoteValue].load(std::memory_order_relaxed);
+    const uint64_t unit_size =
+        words[kQuoteUnitSize].load(std::memory_order_relaxed);
+    uint64_t unit[kQuoteMaxUnitIdBytes / 8];
+    for (size_t i = 0; i < kQuoteMaxUnitIdBytes / 8; ++i) {
+      unit[i] = words[kQuoteUnitId + i].load(std::memory_order_relaxed);
+    }
+    // Orders the loads above before the check below
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) != before) {
+      continue;  // torn
+    }
+
+    if (unit_size == 0 || unit_size > kQuoteMaxUnitIdBytes + 1) {
+      return false;
+    }
+    quote.timestamp_ms = fromBits<int64_t>(timestamp);
+    quote.value = fromBits<double>(value);
+    quote.unit_id.assign(reinterpret_cast<const char*>(unit), unit_size - 1);
+    quote.version = before / 2;
+    return true;
+  }
+  throw LatestQuoteException("slot of " + std::string(asset_id) +
+                             " stuck mid-publish");
+}
+
+size_t LatestQuoteReader::capacity() const { return m_mask + 1; }
+
+size_t LatestQuoteReader::assets() const {
+  return static_cast<size_t>(
+      m_header->assets.load(std::memory_order_relaxed));
+}
+
+bool LatestQuoteReader::closed() const {
+  return m_header->state.load(std::memory_order_acquire) ==
+         static_cast<uint64_t>(QuoteTableState::Closed);
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
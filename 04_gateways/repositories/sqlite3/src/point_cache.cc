@@ -0,0 +1,243 @@
+#include "point_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <tuple>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+namespace {
+
+// Rings start small and double up to seriesPoints, so sparse series do
+// not pay for a full ring
+constexpr size_t kInitialSeriesPoints = 16;
+
+}  // namespace
+
+// ============================================================
+// PointCache::Series
+// ============================================================
+
+int64_t PointCache::Series::timestampAt(size_t i) const {
+  const size_t n = size();
+  return timestamps[head + i < n ? head + i : head + i - n];
+}
+
+size_t PointCache::Series::lowerBound(int64_t timestamp_ms) const {
+  size_t low = 0;
+  size_t high = size();
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    if (timestampAt(mid) < timestamp_ms) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+size_t PointCache::Series::bytes() const {
+  return timestamps.capacity() * sizeof(int64_t) +
+         values.capacity() * sizeof(double);
+}
+
+// ============================================================
+// PointCache
+// ============================================================
+
+PointCache::PointCache(size_t budget_bytes, size_t series_points)
+    : m_budget(budget_bytes), m_seriesPoints(series_points) {}
+
+bool PointCache::read(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+                      int64_t to_ms, std::vector<int64_t>& timestamps,
+                      std::vector<double>& values, uint64_t& epoch) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_series.find({asset_key, unit_key});
+  if (it == m_series.end() || from_ms < it->second.coverage) {
+    ++m_stats.misses;
+    epoch = m_epoch;
+    return false;
+  }
+  ++m_stats.hits;
+  Series& series = it->second;
+  m_lru.splice(m_lru.begin(), m_lru, series.lru);
+
+  const size_t n = series.size();
+  const size_t first = series.lowerBound(from_ms);
+  size_t last = first;
+  while (last < n && series.timestampAt(last) <= to_ms) {
+    ++last;
+  }
+  timestamps.reserve(timestamps.size() + (last - first));
+  values.reserve(values.size() + (last - first));
+  // At most two contiguous runs: the ring's tail, then its head
+  for (size_t i = first; i < last;) {
+    const size_t begin = (series.head + i) % n;
+    const size_t run = std::min(last - i, n - begin);
+    timestamps.insert(timestamps.end(), series.timestamps.begin() + begin,
+                      series.timestamps.begin() + begin + run);
+    values.insert(values.end(), series.values.begin() + begin,
+                  series.values.begin() + begin + run);
+    i += run;
+  }
+  return true;
+}
+
+void PointCache::seed(int64_t asset_key, int64_t unit_key, int64_t from_ms,
+                      const std::vector<GorillaSample>& samples,
+                      uint64_t epoch) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!enabled() || epoch != m_epoch) {
+    return;
+  }
+  const size_t kept = std::min(samples.size(), m_seriesPoints);
+  const size_t start = samples.size() - kept;
+  const int64_t coverage = start > 0 ? samples[start].timestamp_ms : from_ms;
+
+  const Key key{asset_key, unit_key};
+  auto it = m_series.find(key);
+  if (it != m_series.end()) {
+    if (it->second.coverage <= coverage) {
+      return;  // already reaches as far back
+    }
+    erase(it);
+  }
+
+  Series series;
+  series.timestamps.reserve(std::max(kept, kInitialSeriesPoints));
+  series.values.reserve(std::max(kept, kInitialSeriesPoints));
+  for (size_t i = start; i < samples.size(); ++i) {
+    series.timestamps.push_back(samples[i].timestamp_ms);
+    series.values.push_back(samples[i].value);
+  }
+  series.coverage = coverage;
+  m_lru.push_front(key);
+  series.lru = m_lru.begin();
+  m_stats.bytes += series.bytes();
+  m_series.emplace(key, std::move(series));
+  ++m_stats.seeded;
+  enforceBudget();
+}
+
+void PointCache::write(const std::vector<IPointStore::SeriesPoint>& points) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_epoch;
+  if (m_series.empty()) {
+    return;
+  }
+
+  std::vector<IPointStore::SeriesPoint> cached;
+  for (const auto& point : points) {
+    if (m_series.count({point.asset_key, point.unit_key})) {
+      cached.push_back(point);
+    }
+  }
+  // Stable, so the last of equal timestamps is applied last
+  std::stable_sort(cached.begin(), cached.end(),
+                   [](const IPointStore::SeriesPoint& a,
+                      const IPointStore::SeriesPoint& b) {
+                     return std::tie(a.asset_key, a.unit_key,
+                                     a.sample.timestamp_ms) <
+                            std::tie(b.asset_key, b.unit_key,
+                                     b.sample.timestamp_ms);
+                   });
+
+  for (size_t i = 0; i < cached.size();) {
+    const Key key{cached[i].asset_key, cached[i].unit_key};
+    auto it = m_series.find(key);
+    Series& series = it->second;
+    const size_t before = series.bytes();
+    bool kept = true;
+    for (; i < cached.size() && cached[i].asset_key == key.first &&
+           cached[i].unit_key == key.second;
+         ++i) {
+      if (kept && !apply(series, cached[i].sample)) {
+        kept = false;
+      }
+    }
+    m_stats.bytes = m_stats.bytes - before + series.bytes();
+    if (!kept) {
+      erase(it);
+      ++m_stats.dropped;
+    }
+  }
+  enforceBudget();
+}
+
+void PointCache::forgetAsset(int64_t asset_key) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_epoch;
+  auto it = m_series.lower_bound(
+      {asset_key, std::numeric_limits<int64_t>::min()});
+  while (it != m_series.end() && it->first.first == asset_key) {
+    auto next = std::next(it);
+    erase(it);
+    ++m_stats.dropped;
+    it = next;
+  }
+}
+
+void PointCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_epoch;
+  m_stats.dropped += m_series.size();
+  m_series.clear();
+  m_lru.clear();
+  m_stats.bytes = 0;
+}
+
+PointCacheStats PointCache::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  PointCacheStats stats = m_stats;
+  stats.series = m_series.size();
+  return stats;
+}
+
+bool PointCache::apply(Series& series, const GorillaSample& sample) {
+  const size_t n = series.size();
+  if (n == 0 || sample.timestamp_ms > series.timestampAt(n - 1)) {
+    if (n < m_seriesPoints) {
+      if (n == series.timestamps.capacity()) {
+        const size_t grown =
+            std::min(m_seriesPoints, std::max(kInitialSeriesPoints, 2 * n));
+        series.timestamps.reserve(grown);
+        series.values.reserve(grown);
+      }
+      series.timestamps.push_back(sample.timestamp_ms);
+      series.values.push_back(sample.value);
+    } else {
+      // Full: the newest point takes the oldest one's slot
+      series.coverage = series.timestamps[series.head] + 1;
+      series.timestamps[series.head] = sample.timestamp_ms;
+      series.values[series.head] = sample.value;
+      series.head = (series.head + 1) % n;
+    }
+    return true;
+  }
+  if (sample.timestamp_ms < series.coverage) {
+    return true;  // before the window
+  }
+  const size_t i = series.lowerBound(sample.timestamp_ms);
+  if (series.timestampAt(i) != sample.timestamp_ms) {
+    return false;  // a new point inside the window
+  }
+  series.values[(series.head + i) % n] = sample.value;
+  return true;
+}
+
+void PointCache::erase(std::map<Key, Series>::iterator it) {
+  m_stats.bytes -= it->second.bytes();
+  m_lru.erase(it->second.lru);
+  m_series.erase(it);
+}
+
+void PointCache::enforceBudget() {
+  while (m_stats.bytes > m_budget && !m_lru.empty()) {
+    erase(m_series.find(m_lru.back()));
+    ++m_stats.evicted;
+  }
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,332 @@
+#include "series_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+namespace {
+
+std::string_view stringAt(const std::string_view strings, uint64_t offset,
+                          uint32_t size) {
+  return strings.substr(static_cast<size_t>(offset), size);
+}
+
+// [offset, offset + count * width) inside a file of `size` bytes
+bool fits(uint64_t offset, uint64_t count, uint64_t width, uint64_t size) {
+  return offset <= size && count <= (size - offset) / width;
+}
+
+}  // namespace
+
+// ============================================================
+// SeriesFileWriter Implementation
+// ============================================================
+
+SeriesFileWriter::SeriesFileWriter(const std::string& path)
+    : m_out(path, std::ios::binary | std::ios::trunc) {
+  if (!m_out) {
+    throw SeriesFileException("cannot create " + path);
+  }
+  // Placeholder without magic until finish()
+  const SeriesFileHeader header{};
+  write(&header, sizeof(header));
+}
+
+void SeriesFileWriter::add(const std::string& asset_id,
+                           const std::string& unit_id,
+                           const std::vector<int64_t>& timestamps,
+                           const std::vector<double>& values) {
+  if (m_finished) {
+    throw std::logic_error("Series file already finished");
+  }
+  if (timestamps.size() != values.size()) {
+    throw std::invalid_argument("Timestamps and values differ in length");
+  }
+  if (asset_id.size() > std::numeric_limits<uint32_t>::max() ||
+      unit_id.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("Series id too long");
+  }
+  if (!m_added.emplace(asset_id, unit_id).second) {
+    throw std::invalid_argument("Series " + asset_id + "/" + unit_id +
+                                " added twice");
+  }
+
+  const uint64_t count = timestamps.size();
+  SeriesFileEntry entry{};
+  entry.asset_offset = m_strings.size();
+  entry.asset_size = static_cast<uint32_t>(asset_id.size());
+  entry.unit_offset = m_strings.size() + asset_id.size();
+  entry.unit_size = static_cast<uint32_t>(unit_id.size());
+  entry.point_count = count;
+  entry.timestamps_offset = m_offset;
+  entry.values_offset = m_offset + count * sizeof(int64_t);
+  m_strings += asset_id;
+  m_strings += unit_id;
+
+  write(timestamps.data(), count * sizeof(int64_t));
+  write(values.data(), count * sizeof(double));
+  m_entries.push_back(entry);
+}
+
+void SeriesFileWriter::finish() {
+  if (m_finished) {
+    return;
+  }
+  const std::string_view strings = m_strings;
+  std::sort(m_entries.begin(), m_entries.end(),
+            [strings](const SeriesFileEntry& a, const SeriesFileEntry& b) {
+              return std::make_pair(
+                         stringAt(strings, a.asset_offset, a.asset_size),
+                         stringAt(strings, a.unit_offset, a.unit_size)) <
+                     std::make_pair(
+                         stringAt(strings, b.asset_offset, b.asset_size),
+                         stringAt(strings, b.unit_offset, b.unit_size));
+            });
+
+  SeriesFileHeader header{};
+  std::memcpy(header.magic, kSeriesFileMagic, sizeof(header.magic));
+  header.version = kSeriesFileVersion;
+  header.byte_order = kSeriesFileByteOrder;
+  header.series_count = m_entries.size();
+  header.index_offset = m_offset;
+  write(m_entries.data(), m_entries.size() * sizeof(SeriesFileEntry));
+  header.strings_offset = m_offset;
+  header.strings_size = m_strings.size();
+  write(m_strings.data(), m_strings.size());
+  header.file_size = m_offset;
+
+  m_out.seekp(0);
+  m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  m_out.close();
+  if (!m_out) {
+    throw SeriesFileException("write failed");
+  }
+  m_finished = true;
+}
+
+void SeriesFileWriter::write(const void* data, size_t size) {
+  m_out.write(static_cast<const char*>(data),
+              static_cast<std::streamsize>(size));
+  if (!m_out) {
+    throw SeriesFileException("write failed");
+  }
+  m_offset += size;
+}
+
+// ============================================================
+// MappedSeriesFile Implementation
+// ============================================================
+
+MappedSeriesFile::MappedSeriesFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw SeriesFileException("cannot open " + path);
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0 ||
+      static_cast<uint64_t>(info.st_size) < sizeof(SeriesFileHeader)) {
+    ::close(fd);
+    throw SeriesFileException(path + " is too short");
+  }
+
+  m_size = static_cast<size_t>(info.st_size);
+  void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_size = 0;
+    throw SeriesFileException("cannot map " + path);
+  }
+  m_data = static_cast<const uint8_t*>(data);
+
+  try {
+    validate();
+  } catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+MappedSeriesFile::~MappedSeriesFile() { unmap(); }
+
+MappedSeriesFile::MappedSeriesFile(MappedSeriesFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)) {}
+
+MappedSeriesFile& MappedSeriesFile::operator=(
+    MappedSeriesFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+  }
+  return *this;
+}
+
+const SeriesFileHeader& MappedSeriesFile::header() const {
+  return *reinterpret_cast<const SeriesFileHeader*>(m_data);
+}
+
+size_t MappedSeriesFile::seriesCount() const {
+  return static_cast<size_t>(header().series_count);
+}
+
+SeriesView MappedSeriesFile::series(size_t index) const {
+  if (index >= seriesCount()) {
+    throw std::out_of_range("Series index out of range");
+  }
+  const SeriesFileEntry& e = entry(index);
+  const std::string_view strings(
+      reinterpret_cast<const char*>(m_data + header().strings_offset),
+      static_cast<size_t>(header().strings_size));
+  return {stringAt(strings, e.asset_offset, e.asset_size),
+          stringAt(strings, e.unit_offset, e.unit_size),
+          reinterpret_cast<const int64_t*>(m_data + e.timestamps_offset),
+          reinterpret_cast<const double*>(m_data + e.values_offset),
+          static_cast<size_t>(e.point_count)};
+}
+
+std::optional<SeriesView> MappedSeriesFile::find(
+    std::string_view asset_id, std::string_view unit_id) const {
+  const auto key = std::make_pair(asset_id, unit_id);
+  size_t low = 0;
+  size_t high = seriesCount();
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    SeriesView view = series(mid);
+    const auto probe = std::make_pair(view.asset_id, view.unit_id);
+    if (probe == key) {
+      return view;
+    }
+    if (probe < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return std::nullopt;
+}
+
+void MappedSeriesFile::unmap() {
+  if (m_data) {
+    ::munmap(const_cast<uint8_t*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+  }
+}
+
+void MappedSeriesFile::validate() const {
+  const SeriesFileHeader& h = header();
+  if (std::memcmp(h.magic, kSeriesFileMagic, sizeof(h.magic)) != 0) {
+    throw SeriesFileException("bad magic or unfinished file");
+  }
+  if (h.version != kSeriesFileVersion) {
+    throw SeriesFileException("unsupported version " +
+                              std::to_string(h.version));
+  }
+  if (h.byte_order != kSeriesFileByteOrder) {
+    throw SeriesFileException("written with another byte order");
+  }
+  const uint64_t size = m_size;
+  if (h.file_size != size) {
+    throw SeriesFileException("truncated or padded file");
+  }
+  if (h.index_offset % 8 != 0 ||
+      !fits(h.index_offset, h.series_count, sizeof(SeriesFileEntry), size) ||
+      !fits(h.strings_offset, h.strings_size, 1, size)) {
+    throw SeriesFileException("index or strings out of bounds");
+  }
+
+  std::optional<std::pair<std::string_view, std::string_view>> previous;
+  for (size_t i = 0; i < seriesCount(); ++i) {
+    const SeriesFileEntry& e = entry(i);
+    if (!fits(e.asset_offset, e.asset_size, 1, h.strings_size) ||
+        !fits(e.unit_offset, e.unit_size, 1, h.strings_size) ||
+        e.timestamps_offset % 8 != 0 || e.values_offset % 8 != 0 ||
+        !fits(e.timestamps_offset, e.point_count, sizeof(int64_t), size) ||
+        !fits(e.values_offset, e.point_count, sizeof(double), size)) {
+      throw SeriesFileException("series " + std::to_string(i) +
+                                " out of bounds");
+    }
+    SeriesView view = series(i);
+    auto key = std::make_pair(view.asset_id, view.unit_id);
+    if (previous && !(*previous < key)) {
+      throw SeriesFileException("index not sorted");
+    }
+    previous = key;
+  }
+}
+
+const SeriesFileEntry& MappedSeriesFile::entry(size_t index) const {
+  return reinterpret_cast<const SeriesFileEntry*>(
+      m_data + header().index_offset)[index];
+}
+
+// ============================================================
+// Export / Import
+// ============================================================
+
+SeriesFileStats exportSeries(TimeSeriesRepository& repository,
+                             const std::string& path,
+                             const std::vector<std::string>& asset_ids,
+                             int64_t from_ms, int64_t to_ms) {
+  SeriesFileWriter writer(path);
+  SeriesFileStats stats;
+  for (const auto& asset_id : asset_ids) {
+    // By unit id, each series in time order
+    std::map<std::string, std::pair<std::vector<int64_t>, std::vector<double>>>
+        series;
+    for (const auto& point : repository.getPoints(asset_id, from_ms, to_ms)) {
+      auto& [timestamps, values] = series[point.unit_id];
+      timestamps.push_back(point.timestamp_ms);
+      values.push_back(point.value);
+    }
+    for (const auto& [unit_id, arrays] : series) {
+      writer.add(asset_id, unit_id, arrays.first, arrays.second);
+      ++stats.series;
+      stats.points += arrays.first.size();
+    }
+  }
+  writer.finish();
+  return stats;
+}
+
+SeriesFileStats importSeries(TimeSeriesRepository& repository,
+                             const std::string& path, size_t batch_size) {
+  if (batch_size == 0) {
+    throw std::invalid_argument("Batch size must be positive");
+  }
+
+  MappedSeriesFile file(path);
+  SeriesFileStats stats;
+  std::vector<Entities::TimeSeriesPoint> batch;
+  batch.reserve(batch_size);
+  for (size_t i = 0; i < file.seriesCount(); ++i) {
+    const SeriesView view = file.series(i);
+    const std::string asset_id(view.asset_id);
+    const std::string unit_id(view.unit_id);
+    for (size_t j = 0; j < view.count; ++j) {
+      batch.push_back(
+          {asset_id, view.timestamps[j], unit_id, view.values[j]});
+      if (batch.size() == batch_size) {
+        repository.addPoints(batch);
+        batch.clear();
+      }
+    }
+    ++stats.series;
+    stats.points += view.count;
+  }
+  if (!batch.empty()) {
+    repository.addPoints(batch);
+  }
+  return stats;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,131 @@
+#include "shard_set.h"
+
+#include <filesystem>
+#include <tuple>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+// FNV-1a with a final mix, so the low bits a small shard count uses
+// depend on every byte
+uint64_t shardHash(std::string_view key) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+std::string quoteIdentifier(const std::string& name) {
+  std::string quoted = "\"";
+  for (char c : name) {
+    quoted += c;
+    if (c == '"') {
+      quoted += c;
+    }
+  }
+  return quoted + "\"";
+}
+
+}  // namespace
+
+// ============================================================
+// ShardSet Implementation
+// ============================================================
+
+ShardSet::ShardSet(const std::string& directory,
+                   const ShardSetOptions& options)
+    : m_directory(directory),
+      m_executor(options.executor ? *options.executor
+                                  : Concurrency::Executor::shared()) {
+  if (options.shards == 0) {
+    throw std::invalid_argument("A shard set needs at least one shard");
+  }
+  std::filesystem::create_directories(m_directory);
+  for (size_t i = 0; i < options.shards; ++i) {
+    m_paths.push_back(
+        (std::filesystem::path(m_directory) /
+         ("shard-" + std::to_string(i) + ".db"))
+            .string());
+    m_pools.push_back(std::make_unique<SqlitePool>(m_paths[i], options.pool));
+    checkLayout(i, options.shards);
+  }
+}
+
+size_t ShardSet::size() const { return m_pools.size(); }
+
+size_t ShardSet::shardOf(std::string_view key) const {
+  return static_cast<size_t>(shardHash(key) % m_pools.size());
+}
+
+SqlitePool& ShardSet::shard(size_t index) { return *m_pools.at(index); }
+
+const std::string& ShardSet::path(size_t index) const {
+  return m_paths.at(index);
+}
+
+const std::string& ShardSet::directory() const { return m_directory; }
+
+void ShardSet::forEach(const std::function<void(size_t)>& body) {
+  if (m_pools.size() == 1) {
+    body(0);
+    return;
+  }
+  m_executor.parallelFor(m_pools.size(), m_pools.size(), body);
+}
+
+std::vector<std::vector<size_t>> ShardSet::partition(
+    const std::vector<std::string>& keys) const {
+  std::vector<std::vector<size_t>> groups(m_pools.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    groups[shardOf(keys[i])].push_back(i);
+  }
+  return groups;
+}
+
+void ShardSet::attach(SqliteDatabase& db, const std::string& prefix) const {
+  for (size_t i = 0; i < m_paths.size(); ++i) {
+    auto stmt = db.prepare("ATTACH DATABASE ? AS " +
+                           quoteIdentifier(prefix + std::to_string(i)));
+    stmt->bind(1, m_paths[i]);
+    stmt->execute();
+  }
+}
+
+void ShardSet::checkLayout(size_t index, size_t count) {
+  SqlitePool& db = *m_pools[index];
+  migrateSchema(db, "shard_set",
+                {[](IDatabase& db) {
+                  db.execute(
+                      "CREATE TABLE shard_layout ("
+                      "id INTEGER PRIMARY KEY CHECK (id = 0), "
+                      "shard INTEGER NOT NULL, shards INTEGER NOT NULL)");
+                }});
+  auto claim = db.prepare(
+      "INSERT OR IGNORE INTO shard_layout (id, shard, shards) "
+      "VALUES (0, ?, ?)");
+  claim->bind(1, static_cast<int64_t>(index))
+      .bind(2, static_cast<int64_t>(count));
+  claim->executeInsert();
+
+  auto layout = db.prepare("SELECT shard, shards FROM shard_layout")
+                    ->fetchOne<int64_t, int64_t>();
+  const auto expected = std::make_tuple(static_cast<int64_t>(index),
+                                        static_cast<int64_t>(count));
+  if (!layout || *layout != expected) {
+    throw ShardException(
+        m_paths[index] + " is shard " +
+        std::to_string(layout ? std::get<0>(*layout) : -1) + " of " +
+        std::to_string(layout ? std::get<1>(*layout) : -1) +
+        ", not " + std::to_string(index) + " of " + std::to_string(count));
+  }
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
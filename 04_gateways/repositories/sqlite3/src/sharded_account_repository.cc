@@ -0,0 +1,346 @@
+#include "sharded_account_repository.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+// What one file's UNIQUE index would report
+[[noreturn]] void throwTaken(const char* column) {
+  throw ConstraintException(std::string("UNIQUE constraint failed: ") +
+                            "accounts." + column);
+}
+
+// Keeps the first limit items of the shards' pages, in name order
+template <typename T, typename Name>
+std::vector<T> mergePages(std::vector<std::vector<T>>& pages, size_t limit,
+                          Name name) {
+  std::vector<T> merged;
+  for (auto& page : pages) {
+    std::move(page.begin(), page.end(), std::back_inserter(merged));
+  }
+  std::sort(merged.begin(), merged.end(), [&](const T& a, const T& b) {
+    return name(a) < name(b);
+  });
+  if (merged.size() > limit) {
+    merged.resize(limit);
+  }
+  return merged;
+}
+
+}  // namespace
+
+// ============================================================
+// ShardedAccountRepository Implementation
+// ============================================================
+
+ShardedAccountRepository::ShardedAccountRepository(
+    ShardSet& shards, const AccountOptions& options)
+    : m_shards(shards) {
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    m_repositories.push_back(
+        std::make_unique<AccountRepository>(m_shards.shard(i), options));
+  }
+}
+
+void ShardedAccountRepository::initSchema() {
+  m_shards.forEach([this](size_t i) { m_repositories[i]->initSchema(); });
+}
+
+AccountRepository& ShardedAccountRepository::repositoryFor(
+    const std::string& account_id) {
+  return *m_repositories[m_shards.shardOf(account_id)];
+}
+
+AccountRepository& ShardedAccountRepository::shard(size_t index) {
+  return *m_repositories.at(index);
+}
+
+bool ShardedAccountRepository::nameTakenElsewhere(const std::string& name,
+                                                  size_t except) {
+  std::atomic<bool> taken{false};
+  m_shards.forEach([&](size_t i) {
+    if (i != except && m_repositories[i]->accountExistsByName(name)) {
+      taken = true;
+    }
+  });
+  return taken;
+}
+
+// ============================================================
+// Accounts
+// ============================================================
+
+void ShardedAccountRepository::createAccount(const Entities::Account& account) {
+  const size_t owner = m_shards.shardOf(account.id);
+  std::lock_guard<std::mutex> lock(m_namesMutex);
+  if (nameTakenElsewhere(account.name, owner)) {
+    throwTaken("name");
+  }
+  m_repositories[owner]->createAccount(account);
+}
+
+Entities::AccountConflict ShardedAccountRepository::tryCreateAccount(
+    const Entities::Account& account) {
+  const size_t owner = m_shards.shardOf(account.id);
+  std::lock_guard<std::mutex> lock(m_namesMutex);
+  // The id first, as one file reports it
+  if (m_repositories[owner]->accountExists(account.id)) {
+    return Entities::AccountConflict::Id;
+  }
+  if (nameTakenElsewhere(account.name, owner)) {
+    return Entities::AccountConflict::Name;
+  }
+  return m_repositories[owner]->tryCreateAccount(account);
+}
+
+void ShardedAccountRepository::createAccounts(
+    const std::vector<Entities::Account>& accounts) {
+  if (accounts.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_namesMutex);
+  // A name twice in the batch, on two shards, would pass both files
+  std::set<std::string> names;
+  for (const auto& account : accounts) {
+    if (!names.insert(account.name).second) {
+      throwTaken("name");
+    }
+  }
+  for (auto conflict : findAccountConflicts(accounts)) {
+    if (conflict == Entities::AccountConflict::Id) {
+      throwTaken("id");
+    }
+    if (conflict == Entities::AccountConflict::Name) {
+      throwTaken("name");
+    }
+  }
+
+  std::vector<std::vector<Entities::Account>> parts(m_repositories.size());
+  for (const auto& account : accounts) {
+    parts[m_shards.shardOf(account.id)].push_back(account);
+  }
+  m_shards.forEach([&](size_t i) {
+    if (!parts[i].empty()) {
+      m_repositories[i]->createAccounts(parts[i]);
+    }
+  });
+}
+
+std::vector<Entities::AccountConflict>
+ShardedAccountRepository::findAccountConflicts(
+    const std::vector<Entities::Account>& accounts) {
+  // Ids are only on their own shard, names may be on any
+  std::vector<std::vector<Entities::AccountConflict>> found(
+      m_repositories.size());
+  m_shards.forEach([&](size_t i) {
+    found[i] = m_repositories[i]->findAccountConflicts(accounts);
+  });
+
+  std::vector<Entities::AccountConflict> conflicts(
+      accounts.size(), Entities::AccountConflict::None);
+  for (size_t i = 0; i < accounts.size(); ++i) {
+    const size_t owner = m_shards.shardOf(accounts[i].id);
+    if (found[owner][i] == Entities::AccountConflict::Id) {
+      conflicts[i] = Entities::AccountConflict::Id;
+      continue;
+    }
+    for (const auto& shard : found) {
+      if (shard[i] != Entities::AccountConflict::None) {
+        conflicts[i] = Entities::AccountConflict::Name;
+        break;
+      }
+    }
+  }
+  return conflicts;
+}
+
+std::optional<Entities::Account> ShardedAccountRepository::getAccount(
+    const std::string& id) {
+  return repositoryFor(id).getAccount(id);
+}
+
+std::optional<Entities::Account> ShardedAccountRepository::getAccountByName(
+    const std::string& name) {
+  std::vector<std::optional<Entities::Account>> found(m_repositories.size());
+  m_shards.forEach(
+      [&](size_t i) { found[i] = m_repositories[i]->getAccountByName(name); });
+  for (auto& account : found) {
+    if (account) {
+      return account;
+    }
+  }
+  return std::nullopt;
+}
+
+std::vector<Entities::Account> ShardedAccountRepository::getAllAccounts() {
+  std::vector<std::vector<Entities::Account>> parts(m_repositories.size());
+  m_shards.forEach(
+      [&](size_t i) { parts[i] = m_repositories[i]->getAllAccounts(); });
+  return mergePages(parts, SIZE_MAX, [](const Entities::Account& account) {
+    return std::string_view(account.name);
+  });
+}
+
+std::vector<Entities::AccountSummary> ShardedAccountRepository::listAccounts(
+    const std::optional<std::string>& after_name, size_t limit) {
+  if (limit == 0) {
+    return {};
+  }
+  std::vector<std::vector<Entities::AccountSummary>> pages(
+      m_repositories.size());
+  m_shards.forEach([&](size_t i) {
+    pages[i] = m_repositories[i]->listAccounts(after_name, limit);
+  });
+  return mergePages(pages, limit, [](const Entities::AccountSummary& summary) {
+    return std::string_view(summary.name);
+  });
+}
+
+std::vector<std::optional<Entities::Account>>
+ShardedAccountRepository::getAccounts(const std::vector<std::string>& ids) {
+  return m_shards.scatter<std::optional<Entities::Account>>(
+      ids, [this](size_t s, const std::vector<std::string>& shard_ids) {
+        return m_repositories[s]->getAccounts(shard_ids);
+      });
+}
+
+void ShardedAccountRepository::updateAccount(const Entities::Account& account) {
+  const size_t owner = m_shards.shardOf(account.id);
+  std::lock_guard<std::mutex> lock(m_namesMutex);
+  if (nameTakenElsewhere(account.name, owner)) {
+    throwTaken("name");
+  }
+  m_repositories[owner]->updateAccount(account);
+}
+
+void ShardedAccountRepository::deleteAccount(const std::string& id) {
+  repositoryFor(id).deleteAccount(id);
+}
+
+bool ShardedAccountRepository::accountExists(const std::string& id) {
+  return repositoryFor(id).accountExists(id);
+}
+
+bool ShardedAccountRepository::accountExistsByName(const std::string& name) {
+  return nameTakenElsewhere(name, m_repositories.size());
+}
+
+// ============================================================
+// Account Properties
+// ============================================================
+
+void ShardedAccountRepository::setProperty(
+    const std::string& account_id, const std::string& key,
+    const std::string& value, const std::optional<std::string>& description) {
+  repositoryFor(account_id).setProperty(account_id, key, value, description);
+}
+
+void ShardedAccountRepository::setProperty(
+    const Entities::AccountProperty& property) {
+  repositoryFor(property.account_id).setProperty(property);
+}
+
+std::optional<Entities::AccountProperty> ShardedAccountRepository::getProperty(
+    const std::string& account_id, const std::string& key) {
+  return repositoryFor(account_id).getProperty(account_id, key);
+}
+
+std::optional<std::string> ShardedAccountRepository::getPropertyValue(
+    const std::string& account_id, const std::string& key) {
+  return repositoryFor(account_id).getPropertyValue(account_id, key);
+}
+
+std::vector<Entities::AccountProperty> ShardedAccountRepository::getProperties(
+    const std::string& account_id) {
+  return repositoryFor(account_id).getProperties(account_id);
+}
+
+std::vector<Entities::AccountProperty>
+ShardedAccountRepository::getPropertiesByPrefix(const std::string& account_id,
+                                                const std::string& prefix) {
+  return repositoryFor(account_id).getPropertiesByPrefix(account_id, prefix);
+}
+
+std::vector<Entities::AccountProperty> ShardedAccountRepository::listProperties(
+    const std::string& account_id, const std::optional<std::string>& after_key,
+    size_t limit) {
+  return repositoryFor(account_id).listProperties(account_id, after_key,
+                                                  limit);
+}
+
+std::vector<std::vector<Entities::AccountProperty>>
+ShardedAccountRepository::getPropertiesForAccounts(
+    const std::vector<std::string>& account_ids) {
+  return m_shards.scatter<std::vector<Entities::AccountProperty>>(
+      account_ids,
+      [this](size_t s, const std::vector<std::string>& shard_ids) {
+        return m_repositories[s]->getPropertiesForAccounts(shard_ids);
+      });
+}
+
+std::vector<Entities::AccountWithProperties>
+ShardedAccountRepository::getAccountsWithProperties(
+    const std::optional<std::string>& after_name, size_t limit) {
+  if (limit == 0) {
+    return {};
+  }
+  std::vector<std::vector<Entities::AccountWithProperties>> pages(
+      m_repositories.size());
+  m_shards.forEach([&](size_t i) {
+    pages[i] = m_repositories[i]->getAccountsWithProperties(after_name, limit);
+  });
+  return mergePages(pages, limit,
+                    [](const Entities::AccountWithProperties& entry) {
+                      return std::string_view(entry.account.name);
+                    });
+}
+
+bool ShardedAccountRepository::propertyExists(const std::string& account_id,
+                                              const std::string& key) {
+  return repositoryFor(account_id).propertyExists(account_id, key);
+}
+
+void ShardedAccountRepository::removeProperty(const std::string& account_id,
+                                              const std::string& key) {
+  repositoryFor(account_id).removeProperty(account_id, key);
+}
+
+void ShardedAccountRepository::removePropertiesByPrefix(
+    const std::string& account_id, const std::string& prefix) {
+  repositoryFor(account_id).removePropertiesByPrefix(account_id, prefix);
+}
+
+void ShardedAccountRepository::clearProperties(const std::string& account_id) {
+  repositoryFor(account_id).clearProperties(account_id);
+}
+
+// ============================================================
+// Count
+// ============================================================
+
+int64_t ShardedAccountRepository::countAccounts() {
+  std::vector<int64_t> counts(m_repositories.size());
+  m_shards.forEach(
+      [&](size_t i) { counts[i] = m_repositories[i]->countAccounts(); });
+  int64_t total = 0;
+  for (int64_t count : counts) {
+    total += count;
+  }
+  return total;
+}
+
+int64_t ShardedAccountRepository::countProperties(
+    const std::string& account_id) {
+  return repositoryFor(account_id).countProperties(account_id);
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,298 @@
+#include "sharded_timeseries_repository.h"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <queue>
+#include <tuple>
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+// ============================================================
+// ShardedTimeSeriesRepository Implementation
+// ============================================================
+
+ShardedTimeSeriesRepository::ShardedTimeSeriesRepository(
+    ShardSet& shards, const TimeSeriesOptions& options)
+    : m_shards(shards) {
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    m_repositories.push_back(
+        std::make_unique<TimeSeriesRepository>(m_shards.shard(i), options));
+  }
+}
+
+void ShardedTimeSeriesRepository::initSchema() {
+  m_shards.forEach([this](size_t i) { m_repositories[i]->initSchema(); });
+}
+
+TimeSeriesRepository& ShardedTimeSeriesRepository::repositoryFor(
+    const std::string& asset_id) {
+  return *m_repositories[m_shards.shardOf(asset_id)];
+}
+
+TimeSeriesRepository& ShardedTimeSeriesRepository::shard(size_t index) {
+  return *m_repositories.at(index);
+}
+
+size_t ShardedTimeSeriesRepository::shardCount() const {
+  return m_repositories.size();
+}
+
+template <typename Write>
+void ShardedTimeSeriesRepository::replicate(Write write) {
+  std::mutex mutex;
+  std::exception_ptr error;
+  m_shards.forEach([&](size_t i) {
+    try {
+      write(*m_repositories[i]);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+// ============================================================
+// Assets
+// ============================================================
+
+void ShardedTimeSeriesRepository::createAsset(const Entities::Asset& asset) {
+  repositoryFor(asset.id).createAsset(asset);
+}
+
+std::optional<Entities::Asset> ShardedTimeSeriesRepository::getAsset(
+    const std::string& id) {
+  return repositoryFor(id).getAsset(id);
+}
+
+std::vector<Entities::Asset> ShardedTimeSeriesRepository::getAllAssets() {
+  std::vector<std::vector<Entities::Asset>> parts(m_repositories.size());
+  m_shards.forEach(
+      [&](size_t i) { parts[i] = m_repositories[i]->getAllAssets(); });
+
+  std::vector<Entities::Asset> assets;
+  for (auto& part : parts) {
+    std::move(part.begin(), part.end(), std::back_inserter(assets));
+  }
+  std::sort(assets.begin(), assets.end(),
+            [](const Entities::Asset& a, const Entities::Asset& b) {
+              return std::tie(a.name, a.id) < std::tie(b.name, b.id);
+            });
+  return assets;
+}
+
+std::vector<std::optional<Entities::Asset>>
+ShardedTimeSeriesRepository::getAssets(const std::vector<std::string>& ids) {
+  return m_shards.scatter<std::optional<Entities::Asset>>(
+      ids, [this](size_t s, const std::vector<std::string>& shard_ids) {
+        return m_repositories[s]->getAssets(shard_ids);
+      });
+}
+
+void ShardedTimeSeriesRepository::updateAsset(const Entities::Asset& asset) {
+  repositoryFor(asset.id).updateAsset(asset);
+}
+
+void ShardedTimeSeriesRepository::deleteAsset(const std::string& id) {
+  repositoryFor(id).deleteAsset(id);
+}
+
+// ============================================================
+// Units and Conversions
+// ============================================================
+
+void ShardedTimeSeriesRepository::createUnit(const Entities::Unit& unit) {
+  replicate(
+      [&](TimeSeriesRepository& repository) { repository.createUnit(unit); });
+}
+
+std::optional<Entities::Unit> ShardedTimeSeriesRepository::getUnit(
+    const std::string& id) {
+  return m_repositories[0]->getUnit(id);
+}
+
+std::vector<Entities::Unit> ShardedTimeSeriesRepository::getAllUnits() {
+  return m_repositories[0]->getAllUnits();
+}
+
+void ShardedTimeSeriesRepository::updateUnit(const Entities::Unit& unit) {
+  replicate(
+      [&](TimeSeriesRepository& repository) { repository.updateUnit(unit); });
+}
+
+void ShardedTimeSeriesRepository::deleteUnit(const std::string& id) {
+  replicate(
+      [&](TimeSeriesRepository& repository) { repository.deleteUnit(id); });
+}
+
+void ShardedTimeSeriesRepository::createConversion(
+    const Entities::UnitConversion& conversion) {
+  replicate([&](TimeSeriesRepository& repository) {
+    repository.createConversion(conversion);
+  });
+}
+
+std::optional<Entities::UnitConversion>
+ShardedTimeSeriesRepository::getConversion(const std::string& from_unit_id,
+                                           const std::string& to_unit_id) {
+  return m_repositories[0]->getConversion(from_unit_id, to_unit_id);
+}
+
+std::vector<Entities::UnitConversion>
+ShardedTimeSeriesRepository::getConversionsFrom(
+    const std::string& from_unit_id) {
+  return m_repositories[0]->getConversionsFrom(from_unit_id);
+}
+
+std::vector<Entities::UnitConversion>
+ShardedTimeSeriesRepository::getAllConversions() {
+  return m_repositories[0]->getAllConversions();
+}
+
+void ShardedTimeSeriesRepository::updateConversion(
+    const Entities::UnitConversion& conversion) {
+  replicate([&](TimeSeriesRepository& repository) {
+    repository.updateConversion(conversion);
+  });
+}
+
+void ShardedTimeSeriesRepository::deleteConversion(
+    const std::string& from_unit_id, const std::string& to_unit_id) {
+  replicate([&](TimeSeriesRepository& repository) {
+    repository.deleteConversion(from_unit_id, to_unit_id);
+  });
+}
+
+// ============================================================
+// Points
+// ============================================================
+
+void ShardedTimeSeriesRepository::addPoint(
+    const Entities::TimeSeriesPoint& point) {
+  repositoryFor(point.asset_id).addPoint(point);
+}
+
+void ShardedTimeSeriesRepository::addPoints(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  std::vector<std::vector<Entities::TimeSeriesPoint>> parts(
+      m_repositories.size());
+  for (const auto& point : points) {
+    parts[m_shards.shardOf(point.asset_id)].push_back(point);
+  }
+  if (std::count_if(parts.begin(), parts.end(), [](const auto& part) {
+        return !part.empty();
+      }) <= 1) {
+    for (size_t i = 0; i < parts.size(); ++i) {
+      if (!parts[i].empty()) {
+        m_repositories[i]->addPoints(parts[i]);
+      }
+    }
+    return;
+  }
+  m_shards.forEach([&](size_t i) {
+    if (!parts[i].empty()) {
+      m_repositories[i]->addPoints(parts[i]);
+    }
+  });
+}
+
+std::vector<Entities::TimeSeriesPoint> ShardedTimeSeriesRepository::getPoints(
+    const std::string& asset_id, int64_t from_ms, int64_t to_ms) {
+  return repositoryFor(asset_id).getPoints(asset_id, from_ms, to_ms);
+}
+
+std::vector<Entities::TimeSeriesPoint> ShardedTimeSeriesRepository::getPoints(
+    const std::string& asset_id, const std::string& unit_id, int64_t from_ms,
+    int64_t to_ms) {
+  return repositoryFor(asset_id).getPoints(asset_id, unit_id, from_ms, to_ms);
+}
+
+std::vector<std::vector<Entities::TimeSeriesPoint>>
+ShardedTimeSeriesRepository::getPointsMulti(
+    const std::vector<std::string>& asset_ids, int64_t from_ms,
+    int64_t to_ms) {
+  return m_shards.scatter<std::vector<Entities::TimeSeriesPoint>>(
+      asset_ids, [&](size_t s, const std::vector<std::string>& shard_ids) {
+        return m_repositories[s]->getPointsMulti(shard_ids, from_ms, to_ms);
+      });
+}
+
+std::vector<Entities::TimeSeriesPoint>
+ShardedTimeSeriesRepository::getPointsMerged(
+    const std::vector<std::string>& asset_ids, int64_t from_ms,
+    int64_t to_ms) {
+  auto series = getPointsMulti(asset_ids, from_ms, to_ms);
+
+  // (timestamp_ms, series index, position in series), smallest on top
+  using Head = std::tuple<int64_t, size_t, size_t>;
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+  size_t total = 0;
+  for (size_t i = 0; i < series.size(); ++i) {
+    total += series[i].size();
+    if (!series[i].empty()) {
+      heads.emplace(series[i].front().timestamp_ms, i, 0);
+    }
+  }
+
+  std::vector<Entities::TimeSeriesPoint> merged;
+  merged.reserve(total);
+  while (!heads.empty()) {
+    auto [_, i, pos] = heads.top();
+    heads.pop();
+    merged.push_back(std::move(series[i][pos]));
+    if (++pos < series[i].size()) {
+      heads.emplace(series[i][pos].timestamp_ms, i, pos);
+    }
+  }
+  return merged;
+}
+
+std::optional<Entities::TimeSeriesPoint>
+ShardedTimeSeriesRepository::getLatestPoint(const std::string& asset_id) {
+  return repositoryFor(asset_id).getLatestPoint(asset_id);
+}
+
+std::optional<Entities::TimeSeriesPoint>
+ShardedTimeSeriesRepository::getLatestPoint(const std::string& asset_id,
+                                            const std::string& unit_id) {
+  return repositoryFor(asset_id).getLatestPoint(asset_id, unit_id);
+}
+
+std::vector<std::optional<Entities::TimeSeriesPoint>>
+ShardedTimeSeriesRepository::getLatestPoints(
+    const std::vector<std::string>& asset_ids) {
+  return m_shards.scatter<std::optional<Entities::TimeSeriesPoint>>(
+      asset_ids, [this](size_t s, const std::vector<std::string>& shard_ids) {
+        return m_repositories[s]->getLatestPoints(shard_ids);
+      });
+}
+
+std::vector<std::optional<Entities::TimeSeriesPoint>>
+ShardedTimeSeriesRepository::getLatestPoints(
+    const std::vector<std::string>& asset_ids, const std::string& unit_id) {
+  return m_shards.scatter<std::optional<Entities::TimeSeriesPoint>>(
+      asset_ids, [&](size_t s, const std::vector<std::string>& shard_ids) {
+        return m_repositories[s]->getLatestPoints(shard_ids, unit_id);
+      });
+}
+
+void ShardedTimeSeriesRepository::deletePoints(const std::string& asset_id,
+                                               int64_t from_ms,
+                                               int64_t to_ms) {
+  repositoryFor(asset_id).deletePoints(asset_id, from_ms, to_ms);
+}
+
+void ShardedTimeSeriesRepository::deleteAllPoints(
+    const std::string& asset_id) {
+  repositoryFor(asset_id).deleteAllPoints(asset_id);
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,403 @@
+#include "timeseries_chunk_store.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+using ChunkId = std::tuple<int64_t, int64_t, int64_t>;  // asset, unit, start
+
+// Existing samples with updates applied; updates win on equal timestamps
+std::vector<GorillaSample> merged(const std::vector<GorillaSample>& existing,
+                                  const std::vector<GorillaSample>& updates) {
+  std::map<int64_t, double> byTime;
+  for (const auto& sample : existing) {
+    byTime.emplace(sample.timestamp_ms, sample.value);
+  }
+  for (const auto& sample : updates) {
+    byTime[sample.timestamp_ms] = sample.value;
+  }
+
+  std::vector<GorillaSample> samples;
+  samples.reserve(byTime.size());
+  for (const auto& [timestamp_ms, value] : byTime) {
+    samples.push_back({timestamp_ms, value});
+  }
+  return samples;
+}
+
+void keepOutside(std::vector<GorillaSample>& samples, int64_t from_ms,
+                 int64_t to_ms) {
+  samples.erase(std::remove_if(samples.begin(), samples.end(),
+                               [&](const GorillaSample& sample) {
+                                 return sample.timestamp_ms >= from_ms &&
+                                        sample.timestamp_ms <= to_ms;
+                               }),
+                samples.end());
+}
+
+}  // namespace
+
+// ============================================================
+// TimeSeriesChunkStore Implementation
+// ============================================================
+
+TimeSeriesChunkStore::TimeSeriesChunkStore(
+    IDatabase& db, std::chrono::milliseconds chunk_width)
+    : m_db(db), m_chunkMs(chunk_width.count()) {
+  if (m_chunkMs <= 0) {
+    throw std::invalid_argument("Chunk width must be positive");
+  }
+}
+
+void TimeSeriesChunkStore::initSchema() {
+  // IF NOT EXISTS and OR IGNORE: databases from before versioning have
+  // the tables and the width
+  migrateSchema(m_db, "timeseries_chunks", {[this](IDatabase& db) {
+    // A rowid table: chunks run to kilobytes, too large to store inline
+    // in a WITHOUT ROWID b-tree
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS timeseries_chunks (
+        asset_key INTEGER NOT NULL,
+        unit_key INTEGER NOT NULL,
+        chunk_start INTEGER NOT NULL,
+        last_ms INTEGER NOT NULL,
+        point_count INTEGER NOT NULL,
+        data BLOB NOT NULL,
+        PRIMARY KEY (asset_key, unit_key, chunk_start),
+        FOREIGN KEY (asset_key) REFERENCES asset_keys(key) ON DELETE CASCADE,
+        FOREIGN KEY (unit_key) REFERENCES unit_keys(key) ON DELETE CASCADE
+      )
+    )");
+
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS timeseries_chunk_config (
+        id INTEGER PRIMARY KEY CHECK (id = 1),
+        chunk_ms INTEGER NOT NULL
+      )
+    )");
+
+    auto insert = db.prepare(
+        "INSERT OR IGNORE INTO timeseries_chunk_config (id, chunk_ms) "
+        "VALUES (1, ?)");
+    insert->bind(1, m_chunkMs);
+    insert->executeInsert();
+  }});
+
+  // The width is fixed by the first store on the database
+  auto stmt =
+      m_db.prepare("SELECT chunk_ms FROM timeseries_chunk_config WHERE id = 1");
+  m_chunkMs = stmt->fetchScalar<int64_t>().value_or(m_chunkMs);
+}
+
+void TimeSeriesChunkStore::write(const std::vector<SeriesPoint>& points) {
+  if (points.empty()) {
+    return;
+  }
+
+  std::map<ChunkId, std::vector<GorillaSample>> updates;
+  for (const auto& point : points) {
+    updates[{point.asset_key, point.unit_key,
+             chunkStart(point.sample.timestamp_ms)}]
+        .push_back(point.sample);
+  }
+
+  auto select = m_db.prepare(
+      "SELECT data FROM timeseries_chunks "
+      "WHERE asset_key = ? AND unit_key = ? AND chunk_start = ?");
+  auto upsert = m_db.prepare(
+      "INSERT OR REPLACE INTO timeseries_chunks "
+      "(asset_key, unit_key, chunk_start, last_ms, point_count, data) "
+      "VALUES (?, ?, ?, ?, ?, ?)");
+
+  m_db.beginTransaction();
+  try {
+    for (const auto& [id, samples] : updates) {
+      const auto& [asset_key, unit_key, start] = id;
+
+      std::vector<GorillaSample> existing;
+      select->reset();
+      select->bind(1, asset_key).bind(2, unit_key).bind(3, start);
+      for (const RowView& row : select->rows()) {
+        existing = gorillaDecode(row.getBlob(0));
+      }
+
+      auto chunk = merged(existing, samples);
+      auto data = gorillaEncode(chunk);
+      upsert->reset();
+      upsert->bind(1, asset_key)
+          .bind(2, unit_key)
+          .bind(3, start)
+          .bind(4, chunk.back().timestamp_ms)
+          .bind(5, static_cast<int64_t>(chunk.size()))
+          .bind(6, data);
+      upsert->executeInsert();
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+}
+
+std::vector<GorillaSample> TimeSeriesChunkStore::read(int64_t asset_key,
+                                                      int64_t unit_key,
+                                                      int64_t from_ms,
+                                                      int64_t to_ms) {
+  std::vector<GorillaSample> samples;
+  scan(asset_key, unit_key, from_ms, to_ms,
+       [&samples](const GorillaSample& sample) {
+         samples.push_back(sample);
+         return true;
+       });
+  return samples;
+}
+
+void TimeSeriesChunkStore::scan(int64_t asset_key, int64_t unit_key,
+                                int64_t from_ms, int64_t to_ms,
+                                const SampleCallback& callback) {
+  if (from_ms > to_ms) {
+    return;
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT data FROM timeseries_chunks "
+      "WHERE asset_key = ? AND unit_key = ? "
+      "AND chunk_start >= ? AND chunk_start <= ? ORDER BY chunk_start");
+  stmt->bind(1, asset_key)
+      .bind(2, unit_key)
+      .bind(3, chunkStart(from_ms))
+      .bind(4, chunkStart(to_ms));
+
+  for (const RowView& row : stmt->rows()) {
+    for (const auto& sample : gorillaDecode(row.getBlob(0))) {
+      if (sample.timestamp_ms >= from_ms && sample.timestamp_ms <= to_ms &&
+          !callback(sample)) {
+        return;
+      }
+    }
+  }
+}
+
+std::vector<TimeSeriesChunkStore::SeriesPoint> TimeSeriesChunkStore::read(
+    int64_t asset_key, int64_t from_ms, int64_t to_ms) {
+  std::vector<SeriesPoint> points;
+  if (from_ms > to_ms) {
+    return points;
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT unit_key, data FROM timeseries_chunks "
+      "WHERE asset_key = ? AND chunk_start >= ? AND chunk_start <= ?");
+  stmt->bind(1, asset_key)
+      .bind(2, chunkStart(from_ms))
+      .bind(3, chunkStart(to_ms));
+
+  for (const RowView& row : stmt->rows()) {
+    const int64_t unit_key = row.getInt64(0);
+    for (const auto& sample : gorillaDecode(row.getBlob(1))) {
+      if (sample.timestamp_ms >= from_ms && sample.timestamp_ms <= to_ms) {
+        points.push_back({asset_key, unit_key, sample});
+      }
+    }
+  }
+
+  std::sort(points.begin(), points.end(),
+            [](const SeriesPoint& a, const SeriesPoint& b) {
+              return std::tie(a.sample.timestamp_ms, a.unit_key) <
+                     std::tie(b.sample.timestamp_ms, b.unit_key);
+            });
+  return points;
+}
+
+void TimeSeriesChunkStore::scan(int64_t asset_key, int64_t from_ms,
+                                int64_t to_ms, const SeriesCallback& callback) {
+  if (from_ms > to_ms) {
+    return;
+  }
+
+  // Only the keys are sorted; blobs are fetched one window at a time
+  auto keys = m_db.prepare(
+      "SELECT chunk_start, rowid FROM timeseries_chunks "
+      "WHERE asset_key = ? AND chunk_start >= ? AND chunk_start <= ? "
+      "ORDER BY chunk_start");
+  keys->bind(1, asset_key)
+      .bind(2, chunkStart(from_ms))
+      .bind(3, chunkStart(to_ms));
+  auto chunks = keys->mapRows<std::pair<int64_t, int64_t>>(
+      [](const RowView& row) {
+        return std::make_pair(row.getInt64(0), row.getInt64(1));
+      });
+  keys.reset();
+
+  auto fetch = m_db.prepare(
+      "SELECT unit_key, data FROM timeseries_chunks WHERE rowid = ?");
+  std::vector<SeriesPoint> window;
+  for (size_t begin = 0; begin < chunks.size();) {
+    size_t end = begin;
+    window.clear();
+    for (; end < chunks.size() && chunks[end].first == chunks[begin].first;
+         ++end) {
+      fetch->reset();
+      fetch->bind(1, chunks[end].second);
+      for (const RowView& row : fetch->rows()) {
+        const int64_t unit_key = row.getInt64(0);
+        for (const auto& sample : gorillaDecode(row.getBlob(1))) {
+          if (sample.timestamp_ms >= from_ms && sample.timestamp_ms <= to_ms) {
+            window.push_back({asset_key, unit_key, sample});
+          }
+        }
+      }
+    }
+    begin = end;
+
+    std::sort(window.begin(), window.end(),
+              [](const SeriesPoint& a, const SeriesPoint& b) {
+                return std::tie(a.sample.timestamp_ms, a.unit_key) <
+                       std::tie(b.sample.timestamp_ms, b.unit_key);
+              });
+    for (const auto& point : window) {
+      if (!callback(point)) {
+        return;
+      }
+    }
+  }
+}
+
+std::optional<GorillaSample> TimeSeriesChunkStore::latest(int64_t asset_key,
+                                                          int64_t unit_key) {
+  auto stmt = m_db.prepare(
+      "SELECT data FROM timeseries_chunks "
+      "WHERE asset_key = ? AND unit_key = ? "
+      "ORDER BY chunk_start DESC LIMIT 1");
+  stmt->bind(1, asset_key).bind(2, unit_key);
+
+  for (const RowView& row : stmt->rows()) {
+    auto samples = gorillaDecode(row.getBlob(0));
+    if (!samples.empty()) {
+      return samples.back();
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<TimeSeriesChunkStore::SeriesPoint> TimeSeriesChunkStore::latest(
+    int64_t asset_key) {
+  auto stmt = m_db.prepare(
+      "SELECT unit_key, data FROM timeseries_chunks "
+      "WHERE asset_key = ? ORDER BY last_ms DESC LIMIT 1");
+  stmt->bind(1, asset_key);
+
+  for (const RowView& row : stmt->rows()) {
+    auto samples = gorillaDecode(row.getBlob(1));
+    if (!samples.empty()) {
+      return SeriesPoint{asset_key, row.getInt64(0), samples.back()};
+    }
+  }
+  return std::nullopt;
+}
+
+void TimeSeriesChunkStore::erase(int64_t asset_key, int64_t from_ms,
+                                 int64_t to_ms) {
+  if (from_ms > to_ms) {
+    return;
+  }
+
+  // Chunks are collected first; the table is not modified mid-scan
+  std::vector<std::pair<int64_t, int64_t>> covered;  // unit, start
+  std::map<ChunkId, std::vector<GorillaSample>> partial;
+  {
+    auto stmt = m_db.prepare(
+        "SELECT unit_key, chunk_start, data FROM timeseries_chunks "
+        "WHERE asset_key = ? AND chunk_start >= ? AND chunk_start <= ?");
+    stmt->bind(1, asset_key)
+        .bind(2, chunkStart(from_ms))
+        .bind(3, chunkStart(to_ms));
+
+    for (const RowView& row : stmt->rows()) {
+      const int64_t unit_key = row.getInt64(0);
+      const int64_t start = row.getInt64(1);
+      // Unsigned difference: to_ms >= start, and the span can exceed
+      // INT64_MAX
+      const bool inside =
+          start >= from_ms && static_cast<uint64_t>(to_ms) -
+                                      static_cast<uint64_t>(start) >=
+                                  static_cast<uint64_t>(m_chunkMs - 1);
+      if (inside) {
+        covered.emplace_back(unit_key, start);
+      } else {
+        auto samples = gorillaDecode(row.getBlob(2));
+        keepOutside(samples, from_ms, to_ms);
+        partial[{asset_key, unit_key, start}] = std::move(samples);
+      }
+    }
+  }
+
+  auto remove = m_db.prepare(
+      "DELETE FROM timeseries_chunks "
+      "WHERE asset_key = ? AND unit_key = ? AND chunk_start = ?");
+  auto update = m_db.prepare(
+      "UPDATE timeseries_chunks SET last_ms = ?, point_count = ?, data = ? "
+      "WHERE asset_key = ? AND unit_key = ? AND chunk_start = ?");
+
+  m_db.beginTransaction();
+  try {
+    for (const auto& [unit_key, start] : covered) {
+      remove->reset();
+      remove->bind(1, asset_key).bind(2, unit_key).bind(3, start);
+      remove->executeUpdate();
+    }
+    for (const auto& [id, samples] : partial) {
+      const auto& [asset, unit_key, start] = id;
+      if (samples.empty()) {
+        remove->reset();
+        remove->bind(1, asset).bind(2, unit_key).bind(3, start);
+        remove->executeUpdate();
+        continue;
+      }
+      auto data = gorillaEncode(samples);
+      update->reset();
+      update->bind(1, samples.back().timestamp_ms)
+          .bind(2, static_cast<int64_t>(samples.size()))
+          .bind(3, data)
+          .bind(4, asset)
+          .bind(5, unit_key)
+          .bind(6, start);
+      update->executeUpdate();
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+}
+
+void TimeSeriesChunkStore::eraseAll(int64_t asset_key) {
+  auto stmt =
+      m_db.prepare("DELETE FROM timeseries_chunks WHERE asset_key = ?");
+  stmt->bind(1, asset_key);
+  stmt->executeUpdate();
+}
+
+int64_t TimeSeriesChunkStore::chunkStart(int64_t timestamp_ms) const {
+  // Floor division, so negative timestamps align downwards too
+  int64_t chunk = timestamp_ms / m_chunkMs;
+  if (timestamp_ms % m_chunkMs < 0) {
+    --chunk;
+  }
+  // Only range bounds near INT64_MIN get here; no chunk starts below
+  if (chunk < std::numeric_limits<int64_t>::min() / m_chunkMs) {
+    return std::numeric_limits<int64_t>::min();
+  }
+  return chunk * m_chunkMs;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,356 @@
+#include "timeseries_hot_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+namespace {
+
+constexpr int64_t kMinTimestamp = std::numeric_limits<int64_t>::min();
+constexpr int64_t kMaxTimestamp = std::numeric_limits<int64_t>::max();
+
+}  // namespace
+
+// ============================================================
+// HotSeriesCache
+// ============================================================
+
+HotSeriesCache::HotSeriesCache(TimeSeriesRepository& repository,
+                               const HotCacheOptions& options)
+    : m_repository(repository), m_options(options) {
+  if (m_options.span.count() < 0) {
+    throw std::invalid_argument("Hot cache span must not be negative");
+  }
+  // Listening first: a batch written during the load is applied again
+  // once it is done
+  m_listener = m_repository.addIngestListener(
+      [this](const std::vector<Entities::TimeSeriesPoint>& points) {
+        onIngest(points);
+      });
+  try {
+    reload();
+  } catch (...) {
+    m_repository.removeIngestListener(m_listener);
+    throw;
+  }
+}
+
+HotSeriesCache::~HotSeriesCache() {
+  m_repository.removeIngestListener(m_listener);
+}
+
+void HotSeriesCache::reload() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_series.clear();
+  m_newest.reset();
+  m_stats.points = 0;
+  m_stats.horizon = kMinTimestamp;
+
+  auto assets = m_repository.getAllAssets();
+  for (const auto& asset : assets) {
+    if (auto latest = m_repository.getLatestPoint(asset.id)) {
+      advance(latest->timestamp_ms);
+    }
+  }
+  if (m_newest) {
+    for (const auto& asset : assets) {
+      for (const auto& point : m_repository.getPoints(
+               asset.id, m_stats.horizon, kMaxTimestamp)) {
+        insert(point);
+      }
+    }
+  }
+  m_stats.series = m_series.size();
+}
+
+int64_t HotSeriesCache::horizon() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats.horizon;
+}
+
+std::vector<Entities::TimeSeriesPoint> HotSeriesCache::select(
+    const HotSeriesFilter& filter) const {
+  std::vector<Entities::TimeSeriesPoint> points;
+  if (filter.from_ms > filter.to_ms) {
+    return points;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = filter.asset_id ? m_series.lower_bound({*filter.asset_id, ""})
+                            : m_series.begin();
+  for (; it != m_series.end(); ++it) {
+    const auto& [asset_id, unit_id] = it->first;
+    if (filter.asset_id && asset_id != *filter.asset_id) {
+      break;  // past the asset's series
+    }
+    if (filter.unit_id && unit_id != *filter.unit_id) {
+      continue;
+    }
+    const auto& samples = it->second;
+    for (auto sample = samples.lower_bound(filter.from_ms);
+         sample != samples.end() && sample->first <= filter.to_ms; ++sample) {
+      points.push_back({asset_id, sample->first, unit_id, sample->second});
+    }
+  }
+  return points;
+}
+
+HotCacheStats HotSeriesCache::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void HotSeriesCache::onIngest(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  int64_t newest = m_newest.value_or(kMinTimestamp);
+  for (const auto& point : points) {
+    newest = std::max(newest, point.timestamp_ms);
+  }
+  if (!points.empty()) {
+    advance(newest);
+  }
+  for (const auto& point : points) {
+    if (point.timestamp_ms < m_stats.horizon) {
+      ++m_stats.ignored;
+    } else {
+      insert(point);
+    }
+  }
+  m_stats.series = m_series.size();
+}
+
+void HotSeriesCache::advance(int64_t newest_ms) {
+  if (m_newest && newest_ms <= *m_newest) {
+    return;
+  }
+  m_newest = newest_ms;
+  const int64_t span = m_options.span.count();
+  const int64_t horizon =
+      newest_ms < kMinTimestamp + span ? kMinTimestamp : newest_ms - span;
+  if (horizon <= m_stats.horizon) {
+    return;
+  }
+  m_stats.horizon = horizon;
+  for (auto it = m_series.begin(); it != m_series.end();) {
+    auto& samples = it->second;
+    auto end = samples.lower_bound(horizon);
+    const auto dropped =
+        static_cast<uint64_t>(std::distance(samples.begin(), end));
+    samples.erase(samples.begin(), end);
+    m_stats.evicted += dropped;
+    m_stats.points -= dropped;
+    it = samples.empty() ? m_series.erase(it) : std::next(it);
+  }
+}
+
+void HotSeriesCache::insert(const Entities::TimeSeriesPoint& point) {
+  auto& samples = m_series[{point.asset_id, point.unit_id}];
+  // A point replaces its series' point at the same timestamp, as on disk
+  if (samples.insert_or_assign(point.timestamp_ms, point.value).second) {
+    ++m_stats.points;
+  }
+}
+
+// ============================================================
+// SQL Access
+// ============================================================
+
+namespace {
+
+enum HotColumn { kAssetId = 0, kTimestamp, kUnitId, kValue };
+
+// The integer a timestamp_ms term compares like, as SQLite would with
+// the column's INTEGER affinity; nullopt for values ordered above every
+// number (text that is not one, and blobs)
+std::optional<double> numberOf(const DbValue& value) {
+  if (const auto* i = std::get_if<int64_t>(&value)) {
+    return static_cast<double>(*i);
+  }
+  if (const auto* d = std::get_if<double>(&value)) {
+    return *d;
+  }
+  if (const auto* s = std::get_if<std::string>(&value)) {
+    char* end = nullptr;
+    const double parsed = std::strtod(s->c_str(), &end);
+    if (!s->empty() && *end == '\0') {
+      return parsed;
+    }
+  }
+  return std::nullopt;
+}
+
+int64_t clampTimestamp(double value) {
+  if (value <= static_cast<double>(kMinTimestamp)) {
+    return kMinTimestamp;
+  }
+  if (value >= static_cast<double>(kMaxTimestamp)) {
+    return kMaxTimestamp;
+  }
+  return static_cast<int64_t>(value);
+}
+
+// The text an asset_id or unit_id term compares like; nullopt if no id
+// can match
+std::optional<std::string> textOf(const DbValue& value) {
+  if (const auto* s = std::get_if<std::string>(&value)) {
+    return *s;
+  }
+  if (const auto* i = std::get_if<int64_t>(&value)) {
+    return std::to_string(*i);
+  }
+  return std::nullopt;
+}
+
+class HotSeriesTable : public VirtualTable {
+ public:
+  explicit HotSeriesTable(HotSeriesCache& cache) : m_cache(cache) {}
+
+  std::string schema() const override {
+    return "CREATE TABLE x(asset_id TEXT, timestamp_ms INTEGER, "
+           "unit_id TEXT, value REAL)";
+  }
+
+  bool filters(int column, ScanOp op) const override {
+    return column == kTimestamp ||
+           ((column == kAssetId || column == kUnitId) && op == ScanOp::Eq);
+  }
+
+  std::unique_ptr<VirtualTableCursor> scan(
+      const std::vector<ScanConstraint>& constraints) override {
+    HotSeriesFilter filter;
+    bool empty = false;
+    for (const auto& constraint : constraints) {
+      if (constraint.column == kTimestamp) {
+        empty |= !narrow(filter, constraint);
+        continue;
+      }
+      auto& id =
+          constraint.column == kAssetId ? filter.asset_id : filter.unit_id;
+      auto text = textOf(constraint.value);
+      if (!text || (id && *id != *text)) {
+        empty = true;
+      } else {
+        id = std::move(text);
+      }
+    }
+    return std::make_unique<Cursor>(
+        empty ? std::vector<Entities::TimeSeriesPoint>{}
+              : m_cache.select(filter));
+  }
+
+ private:
+  class Cursor : public VirtualTableCursor {
+   public:
+    explicit Cursor(std::vector<Entities::TimeSeriesPoint> points)
+        : m_points(std::move(points)) {}
+
+    bool next() override { return ++m_pos <= m_points.size(); }
+
+    DbValue column(int i) const override {
+      const auto& point = m_points[m_pos - 1];
+      switch (i) {
+        case kAssetId:
+          return point.asset_id;
+        case kTimestamp:
+          return point.timestamp_ms;
+        case kUnitId:
+          return point.unit_id;
+        default:
+          return point.value;
+      }
+    }
+
+   private:
+    std::vector<Entities::TimeSeriesPoint> m_points;
+    size_t m_pos = 0;  // 1-based current point
+  };
+
+  // Applies a timestamp_ms term to the filter's range; false if no
+  // point can match it
+  static bool narrow(HotSeriesFilter& filter,
+                     const ScanConstraint& constraint) {
+    if (std::holds_alternative<std::nullptr_t>(constraint.value)) {
+      return false;  // comparisons with NULL are never true
+    }
+    const auto number = numberOf(constraint.value);
+    if (!number) {
+      // Every timestamp is below it
+      return constraint.op == ScanOp::Lt || constraint.op == ScanOp::Le;
+    }
+    int64_t& from = filter.from_ms;
+    int64_t& to = filter.to_ms;
+    switch (constraint.op) {
+      case ScanOp::Eq:
+        if (std::floor(*number) != *number) {
+          return false;
+        }
+        from = std::max(from, clampTimestamp(*number));
+        to = std::min(to, clampTimestamp(*number));
+        break;
+      case ScanOp::Gt:
+        if (std::floor(*number) >= static_cast<double>(kMaxTimestamp)) {
+          return false;
+        }
+        from = std::max(from, clampTimestamp(std::floor(*number)) + 1);
+        break;
+      case ScanOp::Ge:
+        from = std::max(from, clampTimestamp(std::ceil(*number)));
+        break;
+      case ScanOp::Lt:
+        if (std::ceil(*number) <= static_cast<double>(kMinTimestamp)) {
+          return false;
+        }
+        to = std::min(to, clampTimestamp(std::ceil(*number)) - 1);
+        break;
+      case ScanOp::Le:
+        to = std::min(to, clampTimestamp(std::floor(*number)));
+        break;
+    }
+    return true;
+  }
+
+  HotSeriesCache& m_cache;
+};
+
+template <typename Database>
+void registerTable(Database& db, HotSeriesCache& cache,
+                   const std::string& name) {
+  db.createVirtualTable(name, std::make_shared<HotSeriesTable>(cache));
+  // Moves with every ingest, so not deterministic
+  SqlFunctionOptions options;
+  options.deterministic = false;
+  db.createFunction(
+      name + "_horizon", 0,
+      [&cache](const SqlFunctionArgs&) { return DbValue(cache.horizon()); },
+      options);
+}
+
+}  // namespace
+
+void registerHotSeriesTable(SqliteDatabase& db, HotSeriesCache& cache,
+                            const std::string& name) {
+  registerTable(db, cache, name);
+}
+
+void registerHotSeriesTable(SqlitePool& db, HotSeriesCache& cache,
+                            const std::string& name) {
+  registerTable(db, cache, name);
+}
+
+void createHotSeriesView(IDatabase& db, const std::string& view,
+                         const std::string& hot_table) {
+  db.execute("CREATE VIEW IF NOT EXISTS " + view +
+             " AS SELECT asset_id, timestamp_ms, unit_id, value FROM " +
+             hot_table +
+             " UNION ALL SELECT asset_id, timestamp_ms, unit_id, value "
+             "FROM timeseries WHERE timestamp_ms < " +
+             hot_table + "_horizon()");
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
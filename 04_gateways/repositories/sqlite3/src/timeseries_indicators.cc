@@ -0,0 +1,532 @@
+#include "timeseries_indicators.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+// Layout of saveState(), followed by `count` (value, weight) pairs
+struct IndicatorState {
+  uint32_t kind;
+  uint32_t has_previous;
+  uint64_t window;
+  uint64_t samples;
+  uint64_t count;
+  double ema;
+  double previous;
+};
+
+// Slots for the window; Ema keeps no window, and a bad window is
+// rejected by the constructor
+size_t ringCapacity(IndicatorKind kind, size_t window) {
+  return kind == IndicatorKind::Ema || window == 0 ? 1 : window;
+}
+
+constexpr int64_t kMinTimestamp = std::numeric_limits<int64_t>::min();
+constexpr int64_t kMaxTimestamp = std::numeric_limits<int64_t>::max();
+
+// First timestamp after `last`; nullopt if nothing can follow it
+std::optional<int64_t> after(std::optional<int64_t> last) {
+  if (!last) {
+    return kMinTimestamp;
+  }
+  if (*last == kMaxTimestamp) {
+    return std::nullopt;
+  }
+  return *last + 1;
+}
+
+void bindOptional(IStatement& stmt, int index, std::optional<int64_t> value) {
+  if (value) {
+    stmt.bind(index, *value);
+  } else {
+    stmt.bind(index, nullptr);
+  }
+}
+
+}  // namespace
+
+// ============================================================
+// RollingIndicator Implementation
+// ============================================================
+
+RollingIndicator::RollingIndicator(IndicatorKind kind, size_t window)
+    : m_kind(kind),
+      m_window(window),
+      m_ring(ringCapacity(kind, window),
+             Containers::RingOverflow::OverwriteOldest) {
+  if (window == 0 || (kind == IndicatorKind::Volatility && window < 2)) {
+    throw std::invalid_argument("Indicator window too small");
+  }
+}
+
+void RollingIndicator::update(double value, double weight) {
+  ++m_samples;
+  switch (m_kind) {
+    case IndicatorKind::Sma:
+      push(value, 1.0);
+      break;
+    case IndicatorKind::Ema: {
+      const double alpha = 2.0 / (static_cast<double>(m_window) + 1.0);
+      m_ema = m_samples == 1 ? value : m_ema + alpha * (value - m_ema);
+      break;
+    }
+    case IndicatorKind::Volatility:
+      if (m_previous && *m_previous != 0.0) {
+        push(value / *m_previous - 1.0, 1.0);
+      }
+      m_previous = value;
+      break;
+    case IndicatorKind::Vwap:
+      push(value, weight);
+      break;
+  }
+}
+
+std::optional<double> RollingIndicator::value() const {
+  if (m_samples == 0) {
+    return std::nullopt;
+  }
+  const double n = static_cast<double>(m_ring.size());
+  switch (m_kind) {
+    case IndicatorKind::Sma:
+      return m_sum / n;
+    case IndicatorKind::Ema:
+      return m_ema;
+    case IndicatorKind::Volatility: {
+      if (m_ring.size() < 2) {
+        return std::nullopt;
+      }
+      const double variance = (m_sumSquares - m_sum * m_sum / n) / (n - 1.0);
+      return std::sqrt(std::max(0.0, variance));
+    }
+    case IndicatorKind::Vwap:
+      if (m_weightSum == 0.0) {
+        return std::nullopt;
+      }
+      return m_sum / m_weightSum;
+  }
+  return std::nullopt;
+}
+
+bool RollingIndicator::ready() const {
+  if (m_kind == IndicatorKind::Ema) {
+    return m_samples >= m_window;
+  }
+  return m_ring.size() == m_window;
+}
+
+std::vector<uint8_t> RollingIndicator::saveState() const {
+  IndicatorState state{};
+  state.kind = static_cast<uint32_t>(m_kind);
+  state.has_previous = m_previous.has_value() ? 1 : 0;
+  state.window = m_window;
+  state.samples = m_samples;
+  state.count = m_ring.size();
+  state.ema = m_ema;
+  state.previous = m_previous.value_or(0.0);
+
+  std::vector<uint8_t> bytes(sizeof(state) +
+                             m_ring.size() * 2 * sizeof(double));
+  std::memcpy(bytes.data(), &state, sizeof(state));
+  uint8_t* out = bytes.data() + sizeof(state);
+  for (const auto& [value, weight] : m_ring) {
+    std::memcpy(out, &value, sizeof(value));
+    std::memcpy(out + sizeof(value), &weight, sizeof(weight));
+    out += 2 * sizeof(double);
+  }
+  return bytes;
+}
+
+void RollingIndicator::restoreState(BlobView bytes) {
+  IndicatorState state{};
+  if (bytes.size() < sizeof(state)) {
+    throw std::invalid_argument("Indicator state too short");
+  }
+  std::memcpy(&state, bytes.data(), sizeof(state));
+  if (state.kind != static_cast<uint32_t>(m_kind) ||
+      state.window != m_window) {
+    throw std::invalid_argument("Indicator state of another kind or window");
+  }
+  if (state.count > m_window ||
+      bytes.size() != sizeof(state) + state.count * 2 * sizeof(double)) {
+    throw std::invalid_argument("Indicator state malformed");
+  }
+
+  m_samples = state.samples;
+  m_ema = state.ema;
+  m_previous.reset();
+  if (state.has_previous != 0) {
+    m_previous = state.previous;
+  }
+  m_ring.clear();
+  const uint8_t* in = bytes.data() + sizeof(state);
+  for (uint64_t i = 0; i < state.count; ++i) {
+    double value = 0.0;
+    double weight = 0.0;
+    std::memcpy(&value, in, sizeof(value));
+    std::memcpy(&weight, in + sizeof(value), sizeof(weight));
+    m_ring.push({value, weight});
+    in += 2 * sizeof(double);
+  }
+  recompute();
+}
+
+void RollingIndicator::push(double value, double weight) {
+  // A full ring overwrites its oldest pair
+  const bool evicting = m_ring.full();
+  const auto [old_value, old_weight] =
+      evicting ? m_ring.front() : std::pair<double, double>();
+  m_ring.push({value, weight});
+  m_sum += value * weight;
+  m_sumSquares += value * value;
+  m_weightSum += weight;
+  if (evicting) {
+    m_sum -= old_value * old_weight;
+    m_sumSquares -= old_value * old_value;
+    m_weightSum -= old_weight;
+    if (++m_evictions >= m_window) {
+      recompute();
+    }
+  }
+}
+
+void RollingIndicator::recompute() {
+  m_sum = 0.0;
+  m_sumSquares = 0.0;
+  m_weightSum = 0.0;
+  for (const auto& [value, weight] : m_ring) {
+    m_sum += value * weight;
+    m_sumSquares += value * value;
+    m_weightSum += weight;
+  }
+  m_evictions = 0;
+}
+
+// ============================================================
+// TimeSeriesIndicators Implementation
+// ============================================================
+
+TimeSeriesIndicators::TimeSeriesIndicators(IDatabase& db,
+                                           TimeSeriesRepository& repository,
+                                           const IndicatorOptions& options)
+    : m_db(db), m_repository(repository), m_options(options) {
+  m_listener = m_repository.addIngestListener(
+      [this](const std::vector<Entities::TimeSeriesPoint>& points) {
+        onIngest(points);
+      });
+}
+
+TimeSeriesIndicators::~TimeSeriesIndicators() {
+  m_repository.removeIngestListener(m_listener);
+}
+
+void TimeSeriesIndicators::initSchema() {
+  // IF NOT EXISTS: databases from before versioning have the table
+  migrateSchema(m_db, "timeseries_indicators", {[](IDatabase& db) {
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS timeseries_indicators (
+        name TEXT PRIMARY KEY,
+        asset_id TEXT NOT NULL,
+        unit_id TEXT NOT NULL,
+        kind INTEGER NOT NULL,
+        window_size INTEGER NOT NULL,
+        weight_unit_id TEXT NOT NULL,
+        last_timestamp_ms INTEGER,
+        weight_timestamp_ms INTEGER,
+        weight REAL,
+        state BLOB NOT NULL
+      )
+    )");
+  }});
+}
+
+void TimeSeriesIndicators::add(const IndicatorSpec& spec) {
+  if (spec.name.empty()) {
+    throw std::invalid_argument("Indicator name must not be empty");
+  }
+  if (spec.kind == IndicatorKind::Vwap &&
+      (spec.weight_unit_id.empty() || spec.weight_unit_id == spec.unit_id)) {
+    throw std::invalid_argument("Vwap needs a separate weight unit");
+  }
+  auto entry = std::make_unique<Entry>(spec);
+  if (spec.kind != IndicatorKind::Vwap) {
+    entry->spec.weight_unit_id.clear();
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_entries.count(spec.name) != 0) {
+    throw std::invalid_argument("Indicator " + spec.name + " already exists");
+  }
+  const bool restored = restore(*entry);
+  const size_t replayed = replay(*entry);
+  m_stats.replayed += replayed;
+  if (!restored || replayed > 0) {
+    save(*entry);
+    ++m_stats.checkpoints;
+  }
+
+  Entry* raw = entry.get();
+  m_bySeries[{spec.asset_id, spec.unit_id}].push_back(raw);
+  if (!raw->spec.weight_unit_id.empty()) {
+    m_bySeries[{spec.asset_id, raw->spec.weight_unit_id}].push_back(raw);
+  }
+  m_entries.emplace(spec.name, std::move(entry));
+}
+
+bool TimeSeriesIndicators::remove(const std::string& name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(name);
+  if (it == m_entries.end()) {
+    return false;
+  }
+  Entry* raw = it->second.get();
+  for (auto series = m_bySeries.begin(); series != m_bySeries.end();) {
+    auto& entries = series->second;
+    entries.erase(std::remove(entries.begin(), entries.end(), raw),
+                  entries.end());
+    series = entries.empty() ? m_bySeries.erase(series) : std::next(series);
+  }
+  m_entries.erase(it);
+
+  auto stmt = m_db.prepare("DELETE FROM timeseries_indicators WHERE name = ?");
+  stmt->bind(1, name);
+  stmt->executeUpdate();
+  return true;
+}
+
+std::optional<IndicatorValue> TimeSeriesIndicators::value(
+    const std::string& name) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(name);
+  if (it == m_entries.end()) {
+    return std::nullopt;
+  }
+  const Entry& entry = *it->second;
+  auto current = entry.indicator.value();
+  if (!current) {
+    return std::nullopt;
+  }
+  return IndicatorValue{*current, entry.lastTimestamp.value_or(0),
+                        entry.indicator.samples(), entry.indicator.ready()};
+}
+
+std::vector<IndicatorSpec> TimeSeriesIndicators::specs() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<IndicatorSpec> specs;
+  specs.reserve(m_entries.size());
+  for (const auto& [name, entry] : m_entries) {
+    specs.push_back(entry->spec);
+  }
+  return specs;
+}
+
+void TimeSeriesIndicators::checkpoint() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t saved = 0;
+  m_db.beginTransaction();
+  try {
+    for (auto& [name, entry] : m_entries) {
+      if (entry->sinceCheckpoint > 0) {
+        save(*entry);
+        ++saved;
+      }
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+  m_stats.checkpoints += saved;
+}
+
+IndicatorStats TimeSeriesIndicators::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void TimeSeriesIndicators::onIngest(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_bySeries.empty()) {
+    return;
+  }
+
+  // (timestamp, value before weight, point, entry); stable, so points of
+  // one series keep their batch order
+  std::vector<std::tuple<int64_t, bool, const Entities::TimeSeriesPoint*,
+                         Entry*>>
+      updates;
+  for (const auto& point : points) {
+    auto it = m_bySeries.find({point.asset_id, point.unit_id});
+    if (it == m_bySeries.end()) {
+      continue;
+    }
+    for (Entry* entry : it->second) {
+      updates.emplace_back(point.timestamp_ms,
+                           point.unit_id == entry->spec.unit_id, &point,
+                           entry);
+    }
+  }
+  std::stable_sort(updates.begin(), updates.end(),
+                   [](const auto& a, const auto& b) {
+                     return std::tie(std::get<0>(a), std::get<1>(a)) <
+                            std::tie(std::get<0>(b), std::get<1>(b));
+                   });
+
+  for (const auto& [timestamp_ms, is_value, point, entry] : updates) {
+    if (apply(*entry, !is_value, timestamp_ms, point->value)) {
+      ++m_stats.updates;
+    } else {
+      ++m_stats.skipped;
+    }
+  }
+
+  if (m_options.checkpointEvery == 0) {
+    return;
+  }
+  for (auto& [name, entry] : m_entries) {
+    if (entry->sinceCheckpoint < m_options.checkpointEvery) {
+      continue;
+    }
+    // The points are already written; a failed checkpoint only means a
+    // longer replay after a restart
+    try {
+      save(*entry);
+      ++m_stats.checkpoints;
+    } catch (const std::exception&) {
+      ++m_stats.checkpointFailures;
+    }
+  }
+}
+
+bool TimeSeriesIndicators::apply(Entry& entry, bool weight,
+                                 int64_t timestamp_ms, double value) {
+  if (weight) {
+    if (entry.weightTimestamp && timestamp_ms <= *entry.weightTimestamp) {
+      return false;
+    }
+    entry.weightTimestamp = timestamp_ms;
+    entry.weight = value;
+  } else {
+    if (entry.lastTimestamp && timestamp_ms <= *entry.lastTimestamp) {
+      return false;
+    }
+    // A Vwap value before any weight counts but weighs nothing
+    entry.indicator.update(value, entry.weight.value_or(0.0));
+    entry.lastTimestamp = timestamp_ms;
+  }
+  ++entry.sinceCheckpoint;
+  return true;
+}
+
+bool TimeSeriesIndicators::restore(Entry& entry) {
+  auto stmt = m_db.prepare(
+      "SELECT asset_id, unit_id, kind, window_size, weight_unit_id, "
+      "last_timestamp_ms, weight_timestamp_ms, weight, state "
+      "FROM timeseries_indicators WHERE name = ?");
+  stmt->bind(1, entry.spec.name);
+  for (const RowView& row : stmt->rows()) {
+    const IndicatorSpec& spec = entry.spec;
+    // A checkpoint of another spec under this name is replaced
+    if (row.getText(0) != spec.asset_id || row.getText(1) != spec.unit_id ||
+        row.getInt64(2) != static_cast<int64_t>(spec.kind) ||
+        row.getInt64(3) != static_cast<int64_t>(spec.window) ||
+        row.getText(4) != spec.weight_unit_id) {
+      return false;
+    }
+    try {
+      entry.indicator.restoreState(row.getBlob(8));
+    } catch (const std::invalid_argument&) {
+      entry.indicator = RollingIndicator(spec.kind, spec.window);
+      return false;
+    }
+    if (!row.isNull(5)) {
+      entry.lastTimestamp = row.getInt64(5);
+    }
+    if (!row.isNull(6)) {
+      entry.weightTimestamp = row.getInt64(6);
+      entry.weight = row.getDouble(7);
+    }
+    return true;
+  }
+  return false;
+}
+
+size_t TimeSeriesIndicators::replay(Entry& entry) {
+  const IndicatorSpec& spec = entry.spec;
+  const auto values_from = after(entry.lastTimestamp);
+  const auto weights_from = after(entry.weightTimestamp);
+
+  std::optional<SeriesCursor> values;
+  std::optional<SeriesCursor> weights;
+  if (values_from) {
+    values.emplace(m_repository.openSeriesCursor(
+        spec.asset_id, spec.unit_id, *values_from, kMaxTimestamp));
+  }
+  if (!spec.weight_unit_id.empty() && weights_from) {
+    weights.emplace(m_repository.openSeriesCursor(
+        spec.asset_id, spec.weight_unit_id, *weights_from, kMaxTimestamp));
+  }
+
+  struct Head {
+    int64_t timestamp_ms = 0;
+    double value = 0.0;
+    bool valid = false;
+  };
+  auto pull = [](std::optional<SeriesCursor>& cursor, Head& head) {
+    head.valid = cursor && cursor->next(head.timestamp_ms, head.value);
+  };
+  Head value_head;
+  Head weight_head;
+  pull(values, value_head);
+  pull(weights, weight_head);
+
+  // Weights first at equal timestamps, as on ingest
+  size_t replayed = 0;
+  while (value_head.valid || weight_head.valid) {
+    const bool weight =
+        weight_head.valid && (!value_head.valid ||
+                              weight_head.timestamp_ms <=
+                                  value_head.timestamp_ms);
+    Head& head = weight ? weight_head : value_head;
+    apply(entry, weight, head.timestamp_ms, head.value);
+    ++replayed;
+    pull(weight ? weights : values, head);
+  }
+  return replayed;
+}
+
+void TimeSeriesIndicators::save(Entry& entry) {
+  auto stmt = m_db.prepare(
+      "INSERT OR REPLACE INTO timeseries_indicators "
+      "(name, asset_id, unit_id, kind, window_size, weight_unit_id, "
+      "last_timestamp_ms, weight_timestamp_ms, weight, state) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+  stmt->bind(1, entry.spec.name)
+      .bind(2, entry.spec.asset_id)
+      .bind(3, entry.spec.unit_id)
+      .bind(4, static_cast<int64_t>(entry.spec.kind))
+      .bind(5, static_cast<int64_t>(entry.spec.window))
+      .bind(6, entry.spec.weight_unit_id);
+  bindOptional(*stmt, 7, entry.lastTimestamp);
+  bindOptional(*stmt, 8, entry.weightTimestamp);
+  if (entry.weight) {
+    stmt->bind(9, *entry.weight);
+  } else {
+    stmt->bind(9, nullptr);
+  }
+  stmt->bind(10, entry.indicator.saveState());
+  stmt->executeUpdate();
+  entry.sinceCheckpoint = 0;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
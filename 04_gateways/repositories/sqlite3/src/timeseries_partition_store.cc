@@ -0,0 +1,432 @@
+#include "timeseries_partition_store.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+constexpr int64_t kDayMs = 86400000;
+// Rows per query when scanning an asset across units
+constexpr int64_t kScanPageRows = 1024;
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+  int64_t quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+// Proleptic Gregorian calendar conversions, from Howard Hinnant's
+// "chrono-Compatible Low-Level Date Algorithms"
+struct CivilDate {
+  int64_t year;
+  unsigned month;  // 1-12
+  unsigned day;    // 1-31
+};
+
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+  year -= month <= 2;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const auto yoe = static_cast<unsigned>(year - era * 400);
+  const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 +
+                       day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+CivilDate civilFromDays(int64_t days) {
+  days += 719468;
+  const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  const auto doe = static_cast<unsigned>(days - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+  const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+  return {static_cast<int64_t>(yoe) + era * 400 + (month <= 2), month, day};
+}
+
+// The partition holding timestamp_ms, named after its first UTC day
+TimePartition partitionOf(int64_t timestamp_ms, PartitionPeriod period) {
+  const int64_t day = floorDiv(timestamp_ms, kDayMs);
+  const CivilDate date = civilFromDays(day);
+
+  int64_t first = day;
+  int64_t next = day + 1;
+  char suffix[32];
+  switch (period) {
+    case PartitionPeriod::Day:
+      std::snprintf(suffix, sizeof(suffix), "%04" PRId64 "%02u%02u",
+                    date.year, date.month, date.day);
+      break;
+    case PartitionPeriod::Month:
+      first = daysFromCivil(date.year, date.month, 1);
+      next = date.month == 12 ? daysFromCivil(date.year + 1, 1, 1)
+                              : daysFromCivil(date.year, date.month + 1, 1);
+      std::snprintf(suffix, sizeof(suffix), "%04" PRId64 "%02u", date.year,
+                    date.month);
+      break;
+    case PartitionPeriod::Year:
+      first = daysFromCivil(date.year, 1, 1);
+      next = daysFromCivil(date.year + 1, 1, 1);
+      std::snprintf(suffix, sizeof(suffix), "%04" PRId64, date.year);
+      break;
+  }
+  return {first * kDayMs, next * kDayMs,
+          std::string("timeseries_points_") + suffix};
+}
+
+const char* periodName(PartitionPeriod period) {
+  switch (period) {
+    case PartitionPeriod::Day:
+      return "day";
+    case PartitionPeriod::Month:
+      return "month";
+    case PartitionPeriod::Year:
+      return "year";
+  }
+  return "month";
+}
+
+PartitionPeriod periodFromName(const std::string& name) {
+  if (name == "day") {
+    return PartitionPeriod::Day;
+  }
+  if (name == "year") {
+    return PartitionPeriod::Year;
+  }
+  return PartitionPeriod::Month;
+}
+
+std::string quoted(const std::string& table) { return "\"" + table + "\""; }
+
+std::vector<TimePartition> readPartitions(IStatement& stmt) {
+  return stmt.mapRows<TimePartition>([](const RowView& row) {
+    return TimePartition{row.get<int64_t>(0), row.get<int64_t>(1),
+                         row.get<std::string>(2)};
+  });
+}
+
+}  // namespace
+
+// ============================================================
+// TimeSeriesPartitionStore Implementation
+// ============================================================
+
+TimeSeriesPartitionStore::TimeSeriesPartitionStore(IDatabase& db,
+                                                   PartitionPeriod period)
+    : m_db(db), m_period(period) {}
+
+void TimeSeriesPartitionStore::initSchema() {
+  // IF NOT EXISTS and OR IGNORE: databases from before versioning have
+  // the tables and the period
+  migrateSchema(m_db, "timeseries_partitions", {[this](IDatabase& db) {
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS timeseries_partitions (
+        start_ms INTEGER PRIMARY KEY,
+        end_ms INTEGER NOT NULL,
+        name TEXT NOT NULL UNIQUE
+      )
+    )");
+
+    db.execute(R"(
+      CREATE TABLE IF NOT EXISTS timeseries_partition_config (
+        id INTEGER PRIMARY KEY CHECK (id = 1),
+        period TEXT NOT NULL
+      )
+    )");
+
+    auto insert = db.prepare(
+        "INSERT OR IGNORE INTO timeseries_partition_config (id, period) "
+        "VALUES (1, ?)");
+    insert->bind(1, std::string(periodName(m_period)));
+    insert->executeInsert();
+  }});
+
+  // The period is fixed by the first store on the database
+  auto stmt = m_db.prepare(
+      "SELECT period FROM timeseries_partition_config WHERE id = 1");
+  if (auto period = stmt->fetchScalar<std::string>()) {
+    m_period = periodFromName(*period);
+  }
+}
+
+void TimeSeriesPartitionStore::write(const std::vector<SeriesPoint>& points) {
+  if (points.empty()) {
+    return;
+  }
+
+  std::map<int64_t, std::vector<const SeriesPoint*>> byPartition;
+  for (const auto& point : points) {
+    byPartition[partitionOf(point.sample.timestamp_ms, m_period).start_ms]
+        .push_back(&point);
+  }
+
+  m_db.beginTransaction();
+  try {
+    for (const auto& [start_ms, group] : byPartition) {
+      const std::string table = partitionFor(start_ms);
+      auto insert = m_db.prepare(
+          "INSERT OR REPLACE INTO " + quoted(table) +
+          " (asset_key, unit_key, timestamp_ms, value) VALUES (?, ?, ?, ?)");
+      for (const SeriesPoint* point : group) {
+        insert->reset();
+        insert->bind(1, point->asset_key)
+            .bind(2, point->unit_key)
+            .bind(3, point->sample.timestamp_ms)
+            .bind(4, point->sample.value);
+        insert->executeInsert();
+      }
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+}
+
+std::vector<GorillaSample> TimeSeriesPartitionStore::read(int64_t asset_key,
+                                                          int64_t unit_key,
+                                                          int64_t from_ms,
+                                                          int64_t to_ms) {
+  std::vector<GorillaSample> samples;
+  scan(asset_key, unit_key, from_ms, to_ms,
+       [&samples](const GorillaSample& sample) {
+         samples.push_back(sample);
+         return true;
+       });
+  return samples;
+}
+
+void TimeSeriesPartitionStore::scan(int64_t asset_key, int64_t unit_key,
+                                    int64_t from_ms, int64_t to_ms,
+                                    const SampleCallback& callback) {
+  for (const auto& partition : overlapping(from_ms, to_ms)) {
+    auto stmt = m_db.prepare(
+        "SELECT timestamp_ms, value FROM " + quoted(partition.table) +
+        " WHERE asset_key = ? AND unit_key = ? "
+        "AND timestamp_ms >= ? AND timestamp_ms <= ? ORDER BY timestamp_ms");
+    stmt->bind(1, asset_key).bind(2, unit_key).bind(3, from_ms).bind(4, to_ms);
+    for (const RowView& row : stmt->rows()) {
+      if (!callback({row.getInt64(0), row.getDouble(1)})) {
+        return;
+      }
+    }
+  }
+}
+
+std::vector<IPointStore::SeriesPoint> TimeSeriesPartitionStore::read(
+    int64_t asset_key, int64_t from_ms, int64_t to_ms) {
+  std::vector<SeriesPoint> points;
+  scan(asset_key, from_ms, to_ms, [&points](const SeriesPoint& point) {
+    points.push_back(point);
+    return true;
+  });
+  return points;
+}
+
+void TimeSeriesPartitionStore::scan(int64_t asset_key, int64_t from_ms,
+                                    int64_t to_ms,
+                                    const SeriesCallback& callback) {
+  for (const auto& partition : overlapping(from_ms, to_ms)) {
+    // Keyset pages on (timestamp_ms, unit_key); unit keys are never
+    // negative, so (from_ms, -1) starts at from_ms
+    auto stmt = m_db.prepare(
+        "SELECT unit_key, timestamp_ms, value FROM " +
+        quoted(partition.table) +
+        " WHERE asset_key = ?1 AND (timestamp_ms, unit_key) > (?2, ?3) "
+        "AND timestamp_ms <= ?4 ORDER BY timestamp_ms, unit_key LIMIT ?5");
+    int64_t after_ms = from_ms;
+    int64_t after_unit = -1;
+    std::vector<SeriesPoint> page;
+    do {
+      stmt->reset();
+      stmt->bind(1, asset_key)
+          .bind(2, after_ms)
+          .bind(3, after_unit)
+          .bind(4, to_ms)
+          .bind(5, kScanPageRows);
+      page = stmt->mapRows<SeriesPoint>([asset_key](const RowView& row) {
+        return SeriesPoint{asset_key,
+                           row.getInt64(0),
+                           {row.getInt64(1), row.getDouble(2)}};
+      });
+      for (const auto& point : page) {
+        if (!callback(point)) {
+          return;
+        }
+      }
+      if (!page.empty()) {
+        after_ms = page.back().sample.timestamp_ms;
+        after_unit = page.back().unit_key;
+      }
+    } while (page.size() == static_cast<size_t>(kScanPageRows));
+  }
+}
+
+std::optional<GorillaSample> TimeSeriesPartitionStore::latest(
+    int64_t asset_key, int64_t unit_key) {
+  auto all = partitions();
+  for (auto it = all.rbegin(); it != all.rend(); ++it) {
+    auto stmt = m_db.prepare(
+        "SELECT timestamp_ms, value FROM " + quoted(it->table) +
+        " WHERE asset_key = ? AND unit_key = ? "
+        "ORDER BY timestamp_ms DESC LIMIT 1");
+    stmt->bind(1, asset_key).bind(2, unit_key);
+    auto sample = stmt->mapOne<GorillaSample>([](const RowView& row) {
+      return GorillaSample{row.getInt64(0), row.getDouble(1)};
+    });
+    if (sample) {
+      return sample;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<IPointStore::SeriesPoint> TimeSeriesPartitionStore::latest(
+    int64_t asset_key) {
+  auto all = partitions();
+  for (auto it = all.rbegin(); it != all.rend(); ++it) {
+    auto stmt = m_db.prepare(
+        "SELECT unit_key, timestamp_ms, value FROM " + quoted(it->table) +
+        " WHERE asset_key = ? ORDER BY timestamp_ms DESC LIMIT 1");
+    stmt->bind(1, asset_key);
+    auto point = stmt->mapOne<SeriesPoint>([asset_key](const RowView& row) {
+      return SeriesPoint{asset_key,
+                         row.getInt64(0),
+                         {row.getInt64(1), row.getDouble(2)}};
+    });
+    if (point) {
+      return point;
+    }
+  }
+  return std::nullopt;
+}
+
+void TimeSeriesPartitionStore::erase(int64_t asset_key, int64_t from_ms,
+                                     int64_t to_ms) {
+  auto targets = overlapping(from_ms, to_ms);
+  m_db.beginTransaction();
+  try {
+    for (const auto& partition : targets) {
+      auto stmt = m_db.prepare(
+          "DELETE FROM " + quoted(partition.table) +
+          " WHERE asset_key = ? AND timestamp_ms >= ? AND timestamp_ms <= ?");
+      stmt->bind(1, asset_key).bind(2, from_ms).bind(3, to_ms);
+      stmt->executeUpdate();
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+}
+
+void TimeSeriesPartitionStore::eraseAll(int64_t asset_key) {
+  auto targets = partitions();
+  m_db.beginTransaction();
+  try {
+    for (const auto& partition : targets) {
+      auto stmt = m_db.prepare("DELETE FROM " + quoted(partition.table) +
+                               " WHERE asset_key = ?");
+      stmt->bind(1, asset_key);
+      stmt->executeUpdate();
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+}
+
+std::vector<TimePartition> TimeSeriesPartitionStore::partitions() {
+  auto stmt = m_db.prepare(
+      "SELECT start_ms, end_ms, name FROM timeseries_partitions "
+      "ORDER BY start_ms");
+  return readPartitions(*stmt);
+}
+
+size_t TimeSeriesPartitionStore::dropBefore(int64_t cutoff_ms) {
+  auto select = m_db.prepare(
+      "SELECT start_ms, end_ms, name FROM timeseries_partitions "
+      "WHERE end_ms <= ? ORDER BY start_ms");
+  select->bind(1, cutoff_ms);
+  auto expired = readPartitions(*select);
+  select.reset();
+  if (expired.empty()) {
+    return 0;
+  }
+
+  m_db.beginTransaction();
+  try {
+    auto unregister =
+        m_db.prepare("DELETE FROM timeseries_partitions WHERE start_ms = ?");
+    for (const auto& partition : expired) {
+      m_db.execute("DROP TABLE IF EXISTS " + quoted(partition.table));
+      unregister->reset();
+      unregister->bind(1, partition.start_ms);
+      unregister->executeUpdate();
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+  return expired.size();
+}
+
+std::vector<TimePartition> TimeSeriesPartitionStore::overlapping(
+    int64_t from_ms, int64_t to_ms) {
+  if (from_ms > to_ms) {
+    return {};
+  }
+  auto stmt = m_db.prepare(
+      "SELECT start_ms, end_ms, name FROM timeseries_partitions "
+      "WHERE start_ms <= ? AND end_ms > ? ORDER BY start_ms");
+  stmt->bind(1, to_ms).bind(2, from_ms);
+  return readPartitions(*stmt);
+}
+
+std::string TimeSeriesPartitionStore::partitionFor(int64_t timestamp_ms) {
+  const TimePartition partition = partitionOf(timestamp_ms, m_period);
+  {
+    auto stmt = m_db.prepare(
+        "SELECT name FROM timeseries_partitions WHERE start_ms = ?");
+    stmt->bind(1, partition.start_ms);
+    if (auto table = stmt->fetchScalar<std::string>()) {
+      return *table;
+    }
+  }
+
+  const std::string table = quoted(partition.table);
+  m_db.execute("CREATE TABLE IF NOT EXISTS " + table + R"( (
+      asset_key INTEGER NOT NULL,
+      unit_key INTEGER NOT NULL,
+      timestamp_ms INTEGER NOT NULL,
+      value REAL NOT NULL,
+      PRIMARY KEY (asset_key, unit_key, timestamp_ms),
+      FOREIGN KEY (asset_key) REFERENCES asset_keys(key) ON DELETE CASCADE,
+      FOREIGN KEY (unit_key) REFERENCES unit_keys(key) ON DELETE CASCADE
+    ) WITHOUT ROWID
+  )");
+  // Cross-unit reads in time order, as for timeseries_points
+  m_db.execute("CREATE INDEX IF NOT EXISTS " +
+               quoted(partition.table + "_asset_time") + " ON " + table +
+               " (asset_key, timestamp_ms)");
+
+  auto insert = m_db.prepare(
+      "INSERT INTO timeseries_partitions (start_ms, end_ms, name) "
+      "VALUES (?, ?, ?)");
+  insert->bind(1, partition.start_ms)
+      .bind(2, partition.end_ms)
+      .bind(3, partition.table);
+  insert->executeInsert();
+  return partition.table;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -1,55 +1,307 @@
 #include "timeseries_repository.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <queue>
+#include <set>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
 namespace Gateways::Repositories::Sqlite3 {
 
 using namespace Gateways::Database;
 
-TimeSeriesRepository::TimeSeriesRepository(IDatabase& db) : m_db(db) {}
+namespace {
+
+// FNV-1a, masked to a non-negative SQLite INTEGER. Two ids that collide
+// fail the UNIQUE key constraint when the second one is created.
+int64_t surrogateKey(const std::string& id) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : id) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<int64_t>(hash & 0x7FFFFFFFFFFFFFFFULL);
+}
+
+IPointStore::SeriesPoint toSeriesPoint(
+    const Entities::TimeSeriesPoint& point) {
+  return {surrogateKey(point.asset_id),
+          surrogateKey(point.unit_id),
+          {point.timestamp_ms, point.value}};
+}
+
+std::vector<Entities::TimeSeriesPoint> toPoints(
+    const std::vector<GorillaSample>& samples, const std::string& asset_id,
+    const std::string& unit_id) {
+  std::vector<Entities::TimeSeriesPoint> points;
+  points.reserve(samples.size());
+  for (const auto& sample : samples) {
+    points.push_back({asset_id, sample.timestamp_ms, unit_id, sample.value});
+  }
+  return points;
+}
+
+// Newest point of each series in a batch; on equal timestamps the later
+// one, as INSERT OR REPLACE keeps it
+std::vector<IPointStore::SeriesPoint> newestPerSeries(
+    const std::vector<IPointStore::SeriesPoint>& points) {
+  std::map<std::pair<int64_t, int64_t>, IPointStore::SeriesPoint>
+      newest;
+  for (const auto& point : points) {
+    auto [it, inserted] =
+        newest.try_emplace({point.asset_key, point.unit_key}, point);
+    if (!inserted &&
+        point.sample.timestamp_ms >= it->second.sample.timestamp_ms) {
+      it->second = point;
+    }
+  }
+
+  std::vector<IPointStore::SeriesPoint> result;
+  result.reserve(newest.size());
+  for (const auto& [_, point] : newest) {
+    result.push_back(point);
+  }
+  return result;
+}
+
+// Same shape as getPointColumns() on rows: timestamp_ms, value
+ColumnarResult toColumns(const std::vector<GorillaSample>& samples) {
+  ColumnarResult result;
+  result.rowCount = samples.size();
+  result.columns.resize(2);
+  result.columns[0].kind = ColumnKind::Int64;
+  result.columns[1].kind = ColumnKind::Double;
+  result.columns[0].int64s.reserve(samples.size());
+  result.columns[1].doubles.reserve(samples.size());
+  for (const auto& sample : samples) {
+    result.columns[0].int64s.push_back(sample.timestamp_ms);
+    result.columns[1].doubles.push_back(sample.value);
+  }
+  for (auto& column : result.columns) {
+    column.nullBits.assign((samples.size() + 63) / 64, 0);
+  }
+  return result;
+}
+
+}  // namespace
+
+TimeSeriesRepository::TimeSeriesRepository(IDatabase& db,
+                                           const TimeSeriesOptions& options)
+    : m_db(db),
+      m_storage(options.storage),
+      m_readThreads(std::max<size_t>(options.readThreads, 1)),
+      m_executor(options.executor ? *options.executor
+                                  : Concurrency::Executor::shared()),
+      m_appendIngest(options.appendIngest),
+      m_points(options.pointCacheBytes, options.pointCacheSeriesPoints) {
+  if (options.storage == PointStorage::Chunks) {
+    m_store = std::make_unique<TimeSeriesChunkStore>(db, options.chunkWidth);
+  } else if (options.storage == PointStorage::Partitions) {
+    auto partitions =
+        std::make_unique<TimeSeriesPartitionStore>(db, options.partitionPeriod);
+    m_partitions = partitions.get();
+    m_store = std::move(partitions);
+  }
+}
 
 void TimeSeriesRepository::initSchema() {
-  m_db.execute(R"(
-    CREATE TABLE IF NOT EXISTS assets (
-      id TEXT PRIMARY KEY,
-      name TEXT NOT NULL,
-      description TEXT NOT NULL DEFAULT '',
-      source TEXT NOT NULL DEFAULT ''
-    )
-  )");
+  // Every step uses IF NOT EXISTS, or is safe to repeat, because
+  // databases from before versioning start at version 0 with some of the
+  // tables in place
+  const std::vector<Migration> migrations = {
+      // 1: string ids keyed to integers, and the clustered points table
+      [this](IDatabase& db) {
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS assets (
+            id TEXT PRIMARY KEY,
+            name TEXT NOT NULL,
+            description TEXT NOT NULL DEFAULT '',
+            source TEXT NOT NULL DEFAULT ''
+          )
+        )");
+
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS units (
+            id TEXT PRIMARY KEY,
+            symbol TEXT NOT NULL,
+            name TEXT NOT NULL
+          )
+        )");
+
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS unit_conversions (
+            from_unit_id TEXT NOT NULL,
+            to_unit_id TEXT NOT NULL,
+            factor REAL NOT NULL,
+            PRIMARY KEY (from_unit_id, to_unit_id),
+            FOREIGN KEY (from_unit_id) REFERENCES units(id) ON DELETE CASCADE,
+            FOREIGN KEY (to_unit_id) REFERENCES units(id) ON DELETE CASCADE
+          )
+        )");
+
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS asset_keys (
+            key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            FOREIGN KEY (id) REFERENCES assets(id) ON DELETE CASCADE
+          )
+        )");
+
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS unit_keys (
+            key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            FOREIGN KEY (id) REFERENCES units(id) ON DELETE CASCADE
+          )
+        )");
+
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS timeseries_points (
+            asset_key INTEGER NOT NULL,
+            unit_key INTEGER NOT NULL,
+            timestamp_ms INTEGER NOT NULL,
+            value REAL NOT NULL,
+            PRIMARY KEY (asset_key, unit_key, timestamp_ms),
+            FOREIGN KEY (asset_key) REFERENCES asset_keys(key)
+              ON DELETE CASCADE,
+            FOREIGN KEY (unit_key) REFERENCES unit_keys(key)
+              ON DELETE CASCADE
+          ) WITHOUT ROWID
+        )");
+
+        // Cross-unit reads in time order. The primary key is appended to
+        // the entries, so this is (asset_key, timestamp_ms, unit_key).
+        db.execute(
+            "CREATE INDEX IF NOT EXISTS idx_timeseries_points_asset_time "
+            "ON timeseries_points (asset_key, timestamp_ms)");
+
+        backfillKeys("assets", "asset_keys");
+        backfillKeys("units", "unit_keys");
+        migrateLegacyPoints();
+        db.execute(R"(
+          CREATE VIEW IF NOT EXISTS timeseries AS
+          SELECT a.id AS asset_id, p.timestamp_ms, u.id AS unit_id, p.value
+          FROM timeseries_points AS p
+          JOIN asset_keys AS a ON a.key = p.asset_key
+          JOIN unit_keys AS u ON u.key = p.unit_key
+        )");
+      },
+      // 2: the latest point of each series, kept by writes and a trigger
+      [](IDatabase& db) {
+        // No foreign keys: when a cascade removes a series, the trigger
+        // below removes its latest row along with the last point
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS timeseries_latest (
+            asset_key INTEGER NOT NULL,
+            unit_key INTEGER NOT NULL,
+            timestamp_ms INTEGER NOT NULL,
+            value REAL NOT NULL,
+            PRIMARY KEY (asset_key, unit_key)
+          ) WITHOUT ROWID
+        )");
+
+        // Only deleting the current latest row of a series needs a lookup
+        db.execute(R"(
+          CREATE TRIGGER IF NOT EXISTS timeseries_latest_after_delete
+          AFTER DELETE ON timeseries_points
+          WHEN OLD.timestamp_ms = (
+            SELECT timestamp_ms FROM timeseries_latest
+            WHERE asset_key = OLD.asset_key AND unit_key = OLD.unit_key)
+          BEGIN
+            DELETE FROM timeseries_latest
+            WHERE asset_key = OLD.asset_key AND unit_key = OLD.unit_key;
+            INSERT INTO timeseries_latest
+              (asset_key, unit_key, timestamp_ms, value)
+            SELECT asset_key, unit_key, timestamp_ms, value
+            FROM timeseries_points
+            WHERE asset_key = OLD.asset_key AND unit_key = OLD.unit_key
+            ORDER BY timestamp_ms DESC LIMIT 1;
+          END
+        )");
+
+        // MAX() makes SQLite take value from the same row
+        db.execute(R"(
+          INSERT OR REPLACE INTO timeseries_latest
+            (asset_key, unit_key, timestamp_ms, value)
+          SELECT asset_key, unit_key, MAX(timestamp_ms), value
+          FROM timeseries_points GROUP BY asset_key, unit_key
+        )");
+      },
+      // 3: written by expirePoints() before it deletes the points, in any
+      // storage
+      [](IDatabase& db) {
+        db.execute(R"(
+          CREATE TABLE IF NOT EXISTS timeseries_rollups (
+            asset_key INTEGER NOT NULL,
+            unit_key INTEGER NOT NULL,
+            bucket_ms INTEGER NOT NULL,
+            bucket_start_ms INTEGER NOT NULL,
+            open REAL NOT NULL,
+            high REAL NOT NULL,
+            low REAL NOT NULL,
+            close REAL NOT NULL,
+            avg REAL NOT NULL,
+            count INTEGER NOT NULL,
+            PRIMARY KEY (asset_key, unit_key, bucket_ms, bucket_start_ms),
+            FOREIGN KEY (asset_key) REFERENCES asset_keys(key)
+              ON DELETE CASCADE,
+            FOREIGN KEY (unit_key) REFERENCES unit_keys(key)
+              ON DELETE CASCADE
+          ) WITHOUT ROWID
+        )");
+      },
+  };
+  migrateSchema(m_db, "timeseries", migrations);
 
-  m_db.execute(R"(
-    CREATE TABLE IF NOT EXISTS units (
-      id TEXT PRIMARY KEY,
-      symbol TEXT NOT NULL,
-      name TEXT NOT NULL
-    )
-  )");
+  if (m_store) {
+    m_store->initSchema();
+  }
+}
 
-  m_db.execute(R"(
-    CREATE TABLE IF NOT EXISTS unit_conversions (
-      from_unit_id TEXT NOT NULL,
-      to_unit_id TEXT NOT NULL,
-      factor REAL NOT NULL,
-      PRIMARY KEY (from_unit_id, to_unit_id),
-      FOREIGN KEY (from_unit_id) REFERENCES units(id) ON DELETE CASCADE,
-      FOREIGN KEY (to_unit_id) REFERENCES units(id) ON DELETE CASCADE
-    )
-  )");
+void TimeSeriesRepository::backfillKeys(const std::string& table,
+                                        const std::string& key_table) {
+  auto missing = m_db.query("SELECT id FROM " + table +
+                            " WHERE id NOT IN (SELECT id FROM " + key_table +
+                            ")");
+  if (missing.empty()) {
+    return;
+  }
+
+  auto stmt =
+      m_db.prepare("INSERT INTO " + key_table + " (key, id) VALUES (?, ?)");
+  for (const auto& row : missing) {
+    const auto& id = std::get<std::string>(row[0]);
+    stmt->reset();
+    stmt->bind(1, surrogateKey(id)).bind(2, id);
+    stmt->executeInsert();
+  }
+}
 
+void TimeSeriesRepository::migrateLegacyPoints() {
+  {
+    // Scoped: an open statement would block the DROP TABLE below
+    auto stmt = m_db.prepare(
+        "SELECT type FROM sqlite_master WHERE name = 'timeseries'");
+    if (stmt->fetchScalar<std::string>() != "table") {
+      return;
+    }
+  }
+
+  // Rows whose asset or unit no longer exists (foreign keys were off) have
+  // no key to map to and are dropped with the old table
   m_db.execute(R"(
-    CREATE TABLE IF NOT EXISTS timeseries (
-      asset_id TEXT NOT NULL,
-      timestamp_ms INTEGER NOT NULL,
-      unit_id TEXT NOT NULL,
-      value REAL NOT NULL,
-      PRIMARY KEY (asset_id, timestamp_ms, unit_id),
-      FOREIGN KEY (asset_id) REFERENCES assets(id) ON DELETE CASCADE,
-      FOREIGN KEY (unit_id) REFERENCES units(id) ON DELETE CASCADE
-    )
+    INSERT OR REPLACE INTO timeseries_points
+      (asset_key, unit_key, timestamp_ms, value)
+    SELECT a.key, u.key, t.timestamp_ms, t.value
+    FROM timeseries AS t
+    JOIN asset_keys AS a ON a.id = t.asset_id
+    JOIN unit_keys AS u ON u.id = t.unit_id
   )");
-
-  m_db.execute(
-      "CREATE INDEX IF NOT EXISTS idx_timeseries_asset_time "
-      "ON timeseries(asset_id, timestamp_ms)");
+  m_db.execute("DROP TABLE timeseries");
 }
 
 // ============================================================
@@ -63,7 +315,18 @@ void TimeSeriesRepository::createAsset(const Entities::Asset& asset) {
       .bind(2, asset.name)
       .bind(3, asset.description)
       .bind(4, asset.source);
-  stmt->executeInsert();
+  auto keyStmt = m_db.prepare("INSERT INTO asset_keys (key, id) VALUES (?, ?)");
+  keyStmt->bind(1, surrogateKey(asset.id)).bind(2, asset.id);
+
+  m_db.beginTransaction();
+  try {
+    stmt->executeInsert();
+    keyStmt->executeInsert();
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
 }
 
 std::optional<Entities::Asset> TimeSeriesRepository::getAsset(
@@ -104,6 +367,28 @@ std::vector<Entities::Asset> TimeSeriesRepository::getAllAssets() {
   return assets;
 }
 
+std::vector<std::optional<Entities::Asset>> TimeSeriesRepository::getAssets(
+    const std::vector<std::string>& ids) {
+  std::vector<std::optional<Entities::Asset>> assets(ids.size());
+  if (ids.empty()) {
+    return assets;
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT k.key, a.id, a.name, a.description, a.source "
+      "FROM json_each(?) AS k JOIN assets AS a ON a.id = k.value");
+  stmt->bind(1, toJsonArray(ids));
+  for (const RowView& row : stmt->rows()) {
+    assets[static_cast<size_t>(row.getInt64(0))] = Entities::Asset{
+        row.get<std::string>(1),
+        row.get<std::string>(2),
+        row.get<std::string>(3),
+        row.get<std::string>(4),
+    };
+  }
+  return assets;
+}
+
 void TimeSeriesRepository::updateAsset(const Entities::Asset& asset) {
   auto stmt = m_db.prepare(
       "UPDATE assets SET name = ?, description = ?, source = ? WHERE id = ?");
@@ -118,6 +403,7 @@ void TimeSeriesRepository::deleteAsset(const std::string& id) {
   auto stmt = m_db.prepare("DELETE FROM assets WHERE id = ?");
   stmt->bind(1, id);
   stmt->executeUpdate();
+  forgetCached(surrogateKey(id));
 }
 
 // ============================================================
@@ -128,7 +414,18 @@ void TimeSeriesRepository::createUnit(const Entities::Unit& unit) {
   auto stmt =
       m_db.prepare("INSERT INTO units (id, symbol, name) VALUES (?, ?, ?)");
   stmt->bind(1, unit.id).bind(2, unit.symbol).bind(3, unit.name);
-  stmt->executeInsert();
+  auto keyStmt = m_db.prepare("INSERT INTO unit_keys (key, id) VALUES (?, ?)");
+  keyStmt->bind(1, surrogateKey(unit.id)).bind(2, unit.id);
+
+  m_db.beginTransaction();
+  try {
+    stmt->executeInsert();
+    keyStmt->executeInsert();
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
 }
 
 std::optional<Entities::Unit> TimeSeriesRepository::getUnit(
@@ -176,6 +473,13 @@ void TimeSeriesRepository::deleteUnit(const std::string& id) {
   auto stmt = m_db.prepare("DELETE FROM units WHERE id = ?");
   stmt->bind(1, id);
   stmt->executeUpdate();
+
+  // The delete cascades to the unit's conversions and points
+  invalidateConversions();
+  forgetCached(std::nullopt);
+
+  std::lock_guard<std::mutex> lock(m_unitIdsMutex);
+  m_unitIds.erase(surrogateKey(id));
 }
 
 // ============================================================
@@ -191,6 +495,7 @@ void TimeSeriesRepository::createConversion(
       .bind(2, conversion.to_unit_id)
       .bind(3, conversion.factor);
   stmt->executeInsert();
+  invalidateConversions();
 }
 
 std::optional<Entities::UnitConversion> TimeSeriesRepository::getConversion(
@@ -262,6 +567,7 @@ void TimeSeriesRepository::updateConversion(
       .bind(2, conversion.from_unit_id)
       .bind(3, conversion.to_unit_id);
   stmt->executeUpdate();
+  invalidateConversions();
 }
 
 void TimeSeriesRepository::deleteConversion(const std::string& from_unit_id,
@@ -270,6 +576,7 @@ void TimeSeriesRepository::deleteConversion(const std::string& from_unit_id,
       "DELETE FROM unit_conversions WHERE from_unit_id = ? AND to_unit_id = ?");
   stmt->bind(1, from_unit_id).bind(2, to_unit_id);
   stmt->executeUpdate();
+  invalidateConversions();
 }
 
 // ============================================================
@@ -277,14 +584,8 @@ void TimeSeriesRepository::deleteConversion(const std::string& from_unit_id,
 // ============================================================
 
 void TimeSeriesRepository::addPoint(const Entities::TimeSeriesPoint& point) {
-  auto stmt = m_db.prepare(
-      "INSERT OR REPLACE INTO timeseries "
-      "(asset_id, timestamp_ms, unit_id, value) VALUES (?, ?, ?, ?)");
-  stmt->bind(1, point.asset_id)
-      .bind(2, point.timestamp_ms)
-      .bind(3, point.unit_id)
-      .bind(4, point.value);
-  stmt->executeInsert();
+  writeSeries({toSeriesPoint(point)});
+  notifyIngest({point});
 }
 
 void TimeSeriesRepository::addPoints(
@@ -293,131 +594,1178 @@ void TimeSeriesRepository::addPoints(
     return;
   }
 
-  auto stmt = m_db.prepare(
-      "INSERT OR REPLACE INTO timeseries "
-      "(asset_id, timestamp_ms, unit_id, value) VALUES (?, ?, ?, ?)");
+  std::vector<IPointStore::SeriesPoint> series;
+  series.reserve(points.size());
+  for (const auto& point : points) {
+    series.push_back(toSeriesPoint(point));
+  }
+  writeSeries(series);
+  notifyIngest(points);
+}
 
-  m_db.beginTransaction();
-  try {
-    for (const auto& point : points) {
-      stmt->reset();
-      stmt->bind(1, point.asset_id)
-          .bind(2, point.timestamp_ms)
-          .bind(3, point.unit_id)
-          .bind(4, point.value);
-      stmt->executeInsert();
-    }
-    m_db.commit();
-  } catch (...) {
-    m_db.rollback();
-    throw;
+PointCacheStats TimeSeriesRepository::pointCacheStats() const {
+  return m_points.stats();
+}
+
+IngestStats TimeSeriesRepository::ingestStats() const {
+  return {m_appended.load(std::memory_order_relaxed),
+          m_upserted.load(std::memory_order_relaxed)};
+}
+
+size_t TimeSeriesRepository::addIngestListener(IngestListener listener) {
+  std::lock_guard<std::mutex> lock(m_listenersMutex);
+  const size_t id = m_nextListener++;
+  m_listeners.emplace(id, std::move(listener));
+  return id;
+}
+
+void TimeSeriesRepository::removeIngestListener(size_t id) {
+  std::lock_guard<std::mutex> lock(m_listenersMutex);
+  m_listeners.erase(id);
+}
+
+void TimeSeriesRepository::notifyIngest(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  std::lock_guard<std::mutex> lock(m_listenersMutex);
+  for (const auto& [id, listener] : m_listeners) {
+    listener(points);
   }
 }
 
 std::vector<Entities::TimeSeriesPoint> TimeSeriesRepository::getPoints(
     const std::string& asset_id, int64_t from_ms, int64_t to_ms) {
+  if (m_store) {
+    auto series = m_store->read(surrogateKey(asset_id), from_ms, to_ms);
+    std::vector<Entities::TimeSeriesPoint> points;
+    points.reserve(series.size());
+    for (const auto& point : series) {
+      points.push_back({asset_id, point.sample.timestamp_ms,
+                        unitId(point.unit_key), point.sample.value});
+    }
+    return points;
+  }
+
   auto stmt = m_db.prepare(
-      "SELECT asset_id, timestamp_ms, unit_id, value FROM timeseries "
-      "WHERE asset_id = ? AND timestamp_ms >= ? AND timestamp_ms <= ? "
+      "SELECT unit_key, timestamp_ms, value FROM timeseries_points "
+      "WHERE asset_key = ? AND timestamp_ms >= ? AND timestamp_ms <= ? "
       "ORDER BY timestamp_ms");
-  stmt->bind(1, asset_id).bind(2, from_ms).bind(3, to_ms);
-  auto result = stmt->execute();
+  stmt->bind(1, surrogateKey(asset_id)).bind(2, from_ms).bind(3, to_ms);
 
-  std::vector<Entities::TimeSeriesPoint> points;
-  points.reserve(result.size());
+  return readPoints(*stmt, asset_id);
+}
 
-  for (const auto& row : result) {
-    points.push_back({
-        std::get<std::string>(row[0]),
-        std::get<int64_t>(row[1]),
-        std::get<std::string>(row[2]),
-        std::get<double>(row[3]),
-    });
+std::vector<Entities::TimeSeriesPoint> TimeSeriesRepository::getPoints(
+    const std::string& asset_id, const std::string& unit_id, int64_t from_ms,
+    int64_t to_ms) {
+  if (m_points.enabled()) {
+    std::vector<int64_t> timestamps;
+    std::vector<double> values;
+    readCached(surrogateKey(asset_id), surrogateKey(unit_id), from_ms, to_ms,
+               timestamps, values);
+    std::vector<Entities::TimeSeriesPoint> points;
+    points.reserve(timestamps.size());
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+      points.push_back({asset_id, timestamps[i], unit_id, values[i]});
+    }
+    return points;
+  }
+  if (m_store) {
+    return toPoints(m_store->read(surrogateKey(asset_id),
+                                  surrogateKey(unit_id), from_ms, to_ms),
+                    asset_id, unit_id);
   }
 
-  return points;
+  auto stmt = m_db.prepare(
+      "SELECT timestamp_ms, value FROM timeseries_points "
+      "WHERE asset_key = ? AND unit_key = ? "
+      "AND timestamp_ms >= ? AND timestamp_ms <= ? "
+      "ORDER BY timestamp_ms");
+  stmt->bind(1, surrogateKey(asset_id))
+      .bind(2, surrogateKey(unit_id))
+      .bind(3, from_ms)
+      .bind(4, to_ms);
+
+  return stmt->mapRows<Entities::TimeSeriesPoint>([&](const RowView& row) {
+    return Entities::TimeSeriesPoint{asset_id, row.get<int64_t>(0), unit_id,
+                                     row.get<double>(1)};
+  });
 }
 
-std::vector<Entities::TimeSeriesPoint> TimeSeriesRepository::getPoints(
+Entities::CompactSeries TimeSeriesRepository::getCompactPoints(
+    const std::string& asset_id, int64_t from_ms, int64_t to_ms) {
+  Entities::CompactSeries series{asset_id, {}};
+  std::vector<int64_t> unitKeys;
+  if (m_store) {
+    auto stored = m_store->read(surrogateKey(asset_id), from_ms, to_ms);
+    series.points.reserve(stored.size());
+    unitKeys.reserve(stored.size());
+    for (const auto& point : stored) {
+      unitKeys.push_back(point.unit_key);
+      series.points.push_back(
+          {point.sample.timestamp_ms, point.sample.value, {}});
+    }
+  } else {
+    auto stmt = m_db.prepare(
+        "SELECT unit_key, timestamp_ms, value FROM timeseries_points "
+        "WHERE asset_key = ? AND timestamp_ms >= ? AND timestamp_ms <= ? "
+        "ORDER BY timestamp_ms");
+    stmt->bind(1, surrogateKey(asset_id)).bind(2, from_ms).bind(3, to_ms);
+    for (const RowView& row : stmt->rows()) {
+      unitKeys.push_back(row.get<int64_t>(0));
+      series.points.push_back({row.get<int64_t>(1), row.get<double>(2), {}});
+    }
+  }
+
+  // Resolved after the scan, as in readPoints(); a run of points in one
+  // unit looks its code up once
+  Entities::UnitCode unit;
+  for (size_t i = 0; i < unitKeys.size(); ++i) {
+    if (i == 0 || unitKeys[i] != unitKeys[i - 1]) {
+      unit = Entities::UnitCode(unitId(unitKeys[i]));
+    }
+    series.points[i].unit_id = unit;
+  }
+  return series;
+}
+
+std::vector<std::vector<Entities::TimeSeriesPoint>>
+TimeSeriesRepository::getPointsMulti(const std::vector<std::string>& asset_ids,
+                                     int64_t from_ms, int64_t to_ms) {
+  std::vector<std::vector<Entities::TimeSeriesPoint>> result(
+      asset_ids.size());
+  m_executor.parallelFor(asset_ids.size(), m_readThreads, [&](size_t i) {
+    result[i] = getPoints(asset_ids[i], from_ms, to_ms);
+  });
+  return result;
+}
+
+std::vector<Entities::TimeSeriesPoint> TimeSeriesRepository::getPointsMerged(
+    const std::vector<std::string>& asset_ids, int64_t from_ms,
+    int64_t to_ms) {
+  auto series = getPointsMulti(asset_ids, from_ms, to_ms);
+
+  // (timestamp_ms, series index, position in series), smallest on top
+  using Head = std::tuple<int64_t, size_t, size_t>;
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+  size_t total = 0;
+  for (size_t i = 0; i < series.size(); ++i) {
+    total += series[i].size();
+    if (!series[i].empty()) {
+      heads.emplace(series[i].front().timestamp_ms, i, 0);
+    }
+  }
+
+  std::vector<Entities::TimeSeriesPoint> merged;
+  merged.reserve(total);
+  while (!heads.empty()) {
+    auto [_, i, pos] = heads.top();
+    heads.pop();
+    merged.push_back(std::move(series[i][pos]));
+    if (++pos < series[i].size()) {
+      heads.emplace(series[i][pos].timestamp_ms, i, pos);
+    }
+  }
+  return merged;
+}
+
+size_t TimeSeriesRepository::scanPoints(const std::string& asset_id,
+                                        int64_t from_ms, int64_t to_ms,
+                                        const PointBatchVisitor& visitor,
+                                        size_t batch_size) {
+  if (batch_size == 0) {
+    throw std::invalid_argument("Batch size must be positive");
+  }
+
+  const int64_t asset_key = surrogateKey(asset_id);
+  size_t visited = 0;
+  if (m_store) {
+    std::vector<Entities::TimeSeriesPoint> batch;
+    batch.reserve(batch_size);
+    bool stopped = false;
+    m_store->scan(asset_key, from_ms, to_ms,
+                  [&](const IPointStore::SeriesPoint& point) {
+                    batch.push_back({asset_id, point.sample.timestamp_ms,
+                                     unitId(point.unit_key),
+                                     point.sample.value});
+                    if (batch.size() < batch_size) {
+                      return true;
+                    }
+                    visited += batch.size();
+                    stopped = !visitor(batch);
+                    batch.clear();
+                    return !stopped;
+                  });
+    if (!stopped && !batch.empty()) {
+      visited += batch.size();
+      visitor(batch);
+    }
+    return visited;
+  }
+
+  // Unit keys are never negative, so (from_ms, -1) starts at from_ms
+  auto stmt = m_db.prepare(
+      "SELECT unit_key, timestamp_ms, value FROM timeseries_points "
+      "WHERE asset_key = ?1 AND (timestamp_ms, unit_key) > (?2, ?3) "
+      "AND timestamp_ms <= ?4 ORDER BY timestamp_ms, unit_key LIMIT ?5");
+  int64_t after_ms = from_ms;
+  int64_t after_unit = -1;
+  while (true) {
+    stmt->reset();
+    stmt->bind(1, asset_key)
+        .bind(2, after_ms)
+        .bind(3, after_unit)
+        .bind(4, to_ms)
+        .bind(5, static_cast<int64_t>(batch_size));
+    auto batch = readPoints(*stmt, asset_id);
+    if (batch.empty()) {
+      break;
+    }
+
+    visited += batch.size();
+    after_ms = batch.back().timestamp_ms;
+    after_unit = surrogateKey(batch.back().unit_id);
+    if (!visitor(batch) || batch.size() < batch_size) {
+      break;
+    }
+  }
+  return visited;
+}
+
+ColumnarResult TimeSeriesRepository::getPointColumns(
     const std::string& asset_id, const std::string& unit_id, int64_t from_ms,
     int64_t to_ms) {
+  if (m_points.enabled()) {
+    ColumnarResult result;
+    result.columns.resize(2);
+    result.columns[0].kind = ColumnKind::Int64;
+    result.columns[1].kind = ColumnKind::Double;
+    readCached(surrogateKey(asset_id), surrogateKey(unit_id), from_ms, to_ms,
+               result.columns[0].int64s, result.columns[1].doubles);
+    result.rowCount = result.columns[0].int64s.size();
+    for (auto& column : result.columns) {
+      column.nullBits.assign((result.rowCount + 63) / 64, 0);
+    }
+    return result;
+  }
+  if (m_store) {
+    return toColumns(m_store->read(surrogateKey(asset_id),
+                                   surrogateKey(unit_id), from_ms, to_ms));
+  }
+
   auto stmt = m_db.prepare(
-      "SELECT asset_id, timestamp_ms, unit_id, value FROM timeseries "
-      "WHERE asset_id = ? AND unit_id = ? "
+      "SELECT timestamp_ms, value FROM timeseries_points "
+      "WHERE asset_key = ? AND unit_key = ? "
       "AND timestamp_ms >= ? AND timestamp_ms <= ? "
       "ORDER BY timestamp_ms");
-  stmt->bind(1, asset_id).bind(2, unit_id).bind(3, from_ms).bind(4, to_ms);
-  auto result = stmt->execute();
+  stmt->bind(1, surrogateKey(asset_id))
+      .bind(2, surrogateKey(unit_id))
+      .bind(3, from_ms)
+      .bind(4, to_ms);
 
-  std::vector<Entities::TimeSeriesPoint> points;
-  points.reserve(result.size());
+  return stmt->fetchColumns({ColumnKind::Int64, ColumnKind::Double});
+}
 
-  for (const auto& row : result) {
-    points.push_back({
-        std::get<std::string>(row[0]),
-        std::get<int64_t>(row[1]),
-        std::get<std::string>(row[2]),
-        std::get<double>(row[3]),
-    });
+SeriesCursor TimeSeriesRepository::openSeriesCursor(
+    const std::string& asset_id, const std::string& unit_id, int64_t from_ms,
+    int64_t to_ms, size_t page_size) {
+  if (page_size == 0) {
+    throw std::invalid_argument("Page size must be positive");
   }
+  return SeriesCursor(*this, surrogateKey(asset_id), surrogateKey(unit_id),
+                      from_ms, to_ms, page_size);
+}
 
-  return points;
+std::vector<GorillaSample> TimeSeriesRepository::readPage(int64_t asset_key,
+                                                          int64_t unit_key,
+                                                          int64_t from_ms,
+                                                          int64_t to_ms,
+                                                          size_t limit) {
+  std::vector<GorillaSample> page;
+  page.reserve(limit);
+  if (m_store) {
+    m_store->scan(asset_key, unit_key, from_ms, to_ms,
+                  [&page, limit](const GorillaSample& sample) {
+                    page.push_back(sample);
+                    return page.size() < limit;
+                  });
+    return page;
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT timestamp_ms, value FROM timeseries_points "
+      "WHERE asset_key = ? AND unit_key = ? "
+      "AND timestamp_ms >= ? AND timestamp_ms <= ? "
+      "ORDER BY timestamp_ms LIMIT ?");
+  stmt->bind(1, asset_key)
+      .bind(2, unit_key)
+      .bind(3, from_ms)
+      .bind(4, to_ms)
+      .bind(5, static_cast<int64_t>(limit));
+  for (const RowView& row : stmt->rows()) {
+    page.push_back({row.getInt64(0), row.getDouble(1)});
+  }
+  return page;
+}
+
+namespace {
+
+// Streaming OHLC kernel: points must arrive in timestamp order
+class BucketBuilder {
+ public:
+  explicit BucketBuilder(int64_t bucket_ms) : m_bucketMs(bucket_ms) {}
+
+  void add(int64_t timestamp_ms, double value) {
+    int64_t start = timestamp_ms / m_bucketMs;
+    if (timestamp_ms % m_bucketMs < 0) {
+      --start;  // floor, for timestamps before the epoch
+    }
+    start *= m_bucketMs;
+
+    if (m_buckets.empty() || m_buckets.back().bucket_start_ms != start) {
+      finishBucket();
+      m_buckets.push_back({start, value, value, value, value, 0.0, 0});
+      m_sum = 0.0;
+    }
+
+    auto& bucket = m_buckets.back();
+    bucket.high = std::max(bucket.high, value);
+    bucket.low = std::min(bucket.low, value);
+    bucket.close = value;
+    ++bucket.count;
+    m_sum += value;
+  }
+
+  std::vector<PointBucket> finish() {
+    finishBucket();
+    return std::move(m_buckets);
+  }
+
+ private:
+  void finishBucket() {
+    if (!m_buckets.empty() && m_buckets.back().count > 0) {
+      m_buckets.back().avg =
+          m_sum / static_cast<double>(m_buckets.back().count);
+    }
+  }
+
+  int64_t m_bucketMs;
+  double m_sum = 0.0;
+  std::vector<PointBucket> m_buckets;
+};
+
+}  // namespace
+
+std::vector<PointBucket> TimeSeriesRepository::aggregate(
+    const std::string& asset_id, const std::string& unit_id, int64_t from_ms,
+    int64_t to_ms, int64_t bucket_ms) {
+  if (bucket_ms <= 0) {
+    throw std::invalid_argument("Bucket width must be positive");
+  }
+
+  BucketBuilder builder(bucket_ms);
+  if (m_store) {
+    m_store->scan(surrogateKey(asset_id), surrogateKey(unit_id), from_ms,
+                  to_ms, [&builder](const GorillaSample& sample) {
+                    builder.add(sample.timestamp_ms, sample.value);
+                    return true;
+                  });
+    return builder.finish();
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT timestamp_ms, value FROM timeseries_points "
+      "WHERE asset_key = ? AND unit_key = ? "
+      "AND timestamp_ms >= ? AND timestamp_ms <= ? "
+      "ORDER BY timestamp_ms");
+  stmt->bind(1, surrogateKey(asset_id))
+      .bind(2, surrogateKey(unit_id))
+      .bind(3, from_ms)
+      .bind(4, to_ms);
+  for (const RowView& row : stmt->rows()) {
+    builder.add(row.getInt64(0), row.getDouble(1));
+  }
+  return builder.finish();
+}
+
+std::vector<Entities::TimeSeriesPoint> TimeSeriesRepository::getPointsIn(
+    const std::string& asset_id, const std::string& to_unit_id,
+    int64_t from_ms, int64_t to_ms) {
+  if (m_store) {
+    throw std::logic_error("SQL analytics need Rows storage");
+  }
+  // Loaded now, not by the first convert_unit() call inside the query
+  conversionGraph();
+
+  auto stmt = m_db.prepare(
+      "SELECT timestamp_ms, value FROM ("
+      "SELECT p.timestamp_ms, p.unit_key, "
+      "convert_unit(p.value, u.id, ?) AS value "
+      "FROM timeseries_points AS p JOIN unit_keys AS u ON u.key = p.unit_key "
+      "WHERE p.asset_key = ? AND p.timestamp_ms >= ? AND p.timestamp_ms <= ?) "
+      "WHERE value IS NOT NULL ORDER BY timestamp_ms, unit_key");
+  stmt->bind(1, to_unit_id)
+      .bind(2, surrogateKey(asset_id))
+      .bind(3, from_ms)
+      .bind(4, to_ms);
+  return stmt->mapRows<Entities::TimeSeriesPoint>(
+      [&asset_id, &to_unit_id](const RowView& row) {
+        return Entities::TimeSeriesPoint{asset_id, row.getInt64(0), to_unit_id,
+                                         row.getDouble(1)};
+      });
+}
+
+std::vector<Entities::TimeSeriesPoint> TimeSeriesRepository::getEma(
+    const std::string& asset_id, const std::string& unit_id, int64_t from_ms,
+    int64_t to_ms, size_t window) {
+  if (m_store) {
+    throw std::logic_error("SQL analytics need Rows storage");
+  }
+  if (window == 0) {
+    throw std::invalid_argument("EMA window must be positive");
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT timestamp_ms, "
+      "ema(value, ?) OVER (ORDER BY timestamp_ms ROWS UNBOUNDED PRECEDING) "
+      "FROM timeseries_points "
+      "WHERE asset_key = ? AND unit_key = ? "
+      "AND timestamp_ms >= ? AND timestamp_ms <= ? "
+      "ORDER BY timestamp_ms");
+  stmt->bind(1, static_cast<int64_t>(window))
+      .bind(2, surrogateKey(asset_id))
+      .bind(3, surrogateKey(unit_id))
+      .bind(4, from_ms)
+      .bind(5, to_ms);
+  return stmt->mapRows<Entities::TimeSeriesPoint>(
+      [&asset_id, &unit_id](const RowView& row) {
+        return Entities::TimeSeriesPoint{asset_id, row.getInt64(0), unit_id,
+                                         row.getDouble(1)};
+      });
+}
+
+std::optional<double> TimeSeriesRepository::getStddev(
+    const std::string& asset_id, const std::string& unit_id, int64_t from_ms,
+    int64_t to_ms) {
+  if (m_store) {
+    throw std::logic_error("SQL analytics need Rows storage");
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT stddev(value) FROM timeseries_points "
+      "WHERE asset_key = ? AND unit_key = ? "
+      "AND timestamp_ms >= ? AND timestamp_ms <= ?");
+  stmt->bind(1, surrogateKey(asset_id))
+      .bind(2, surrogateKey(unit_id))
+      .bind(3, from_ms)
+      .bind(4, to_ms);
+  return stmt->fetchScalar<std::optional<double>>().value_or(std::nullopt);
+}
+
+std::optional<double> TimeSeriesRepository::getVwap(
+    const std::string& asset_id, const std::string& unit_id,
+    const std::string& weight_unit_id, int64_t from_ms, int64_t to_ms) {
+  if (m_store) {
+    throw std::logic_error("SQL analytics need Rows storage");
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT vwap(p.value, w.value) FROM timeseries_points AS p "
+      "JOIN timeseries_points AS w ON w.asset_key = p.asset_key "
+      "AND w.unit_key = ? AND w.timestamp_ms = p.timestamp_ms "
+      "WHERE p.asset_key = ? AND p.unit_key = ? "
+      "AND p.timestamp_ms >= ? AND p.timestamp_ms <= ?");
+  const int64_t asset_key = surrogateKey(asset_id);
+  stmt->bind(1, surrogateKey(weight_unit_id))
+      .bind(2, asset_key)
+      .bind(3, surrogateKey(unit_id))
+      .bind(4, from_ms)
+      .bind(5, to_ms);
+  return stmt->fetchScalar<std::optional<double>>().value_or(std::nullopt);
 }
 
 std::optional<Entities::TimeSeriesPoint> TimeSeriesRepository::getLatestPoint(
     const std::string& asset_id) {
+  if (m_store) {
+    auto point = m_store->latest(surrogateKey(asset_id));
+    if (!point) {
+      return std::nullopt;
+    }
+    return Entities::TimeSeriesPoint{asset_id, point->sample.timestamp_ms,
+                                     unitId(point->unit_key),
+                                     point->sample.value};
+  }
+
   auto stmt = m_db.prepare(
-      "SELECT asset_id, timestamp_ms, unit_id, value FROM timeseries "
-      "WHERE asset_id = ? ORDER BY timestamp_ms DESC LIMIT 1");
-  stmt->bind(1, asset_id);
-  auto result = stmt->execute();
+      "SELECT unit_key, timestamp_ms, value FROM timeseries_latest "
+      "WHERE asset_key = ? ORDER BY timestamp_ms DESC LIMIT 1");
+  stmt->bind(1, surrogateKey(asset_id));
 
-  if (result.empty()) {
+  auto points = readPoints(*stmt, asset_id);
+  if (points.empty()) {
     return std::nullopt;
   }
-
-  return Entities::TimeSeriesPoint{
-      std::get<std::string>(result[0][0]),
-      std::get<int64_t>(result[0][1]),
-      std::get<std::string>(result[0][2]),
-      std::get<double>(result[0][3]),
-  };
+  return std::move(points.front());
 }
 
 std::optional<Entities::TimeSeriesPoint> TimeSeriesRepository::getLatestPoint(
     const std::string& asset_id, const std::string& unit_id) {
+  auto sample = latestSample(surrogateKey(asset_id), surrogateKey(unit_id));
+  if (!sample) {
+    return std::nullopt;
+  }
+  return Entities::TimeSeriesPoint{asset_id, sample->timestamp_ms, unit_id,
+                                   sample->value};
+}
+
+std::vector<std::optional<Entities::TimeSeriesPoint>>
+TimeSeriesRepository::getLatestPoints(const std::vector<std::string>& asset_ids,
+                                      const std::string& unit_id) {
+  std::vector<std::optional<Entities::TimeSeriesPoint>> points(
+      asset_ids.size());
+  if (asset_ids.empty()) {
+    return points;
+  }
+  if (m_store) {
+    for (size_t i = 0; i < asset_ids.size(); ++i) {
+      points[i] = getLatestPoint(asset_ids[i], unit_id);
+    }
+    return points;
+  }
+
+  // Served from the cache where possible, the rest in one statement
+  const int64_t unit_key = surrogateKey(unit_id);
+  std::vector<size_t> misses;
+  std::vector<DbValue> keys;
+  uint64_t epoch;
+  {
+    std::lock_guard<std::mutex> lock(m_latestMutex);
+    for (size_t i = 0; i < asset_ids.size(); ++i) {
+      const int64_t asset_key = surrogateKey(asset_ids[i]);
+      if (const auto* sample = findLatest(asset_key, unit_key)) {
+        points[i] = Entities::TimeSeriesPoint{asset_ids[i],
+                                              sample->timestamp_ms, unit_id,
+                                              sample->value};
+      } else {
+        misses.push_back(i);
+        keys.emplace_back(asset_key);
+      }
+    }
+    epoch = m_latestEpoch;
+  }
+  if (misses.empty()) {
+    return points;
+  }
+
   auto stmt = m_db.prepare(
-      "SELECT asset_id, timestamp_ms, unit_id, value FROM timeseries "
-      "WHERE asset_id = ? AND unit_id = ? "
-      "ORDER BY timestamp_ms DESC LIMIT 1");
-  stmt->bind(1, asset_id).bind(2, unit_id);
-  auto result = stmt->execute();
+      "SELECT k.key, l.timestamp_ms, l.value "
+      "FROM json_each(?1) AS k JOIN timeseries_latest AS l "
+      "ON l.asset_key = k.value AND l.unit_key = ?2");
+  stmt->bind(1, toJsonArray(keys)).bind(2, unit_key);
+
+  std::vector<std::pair<int64_t, GorillaSample>> found;
+  for (const RowView& row : stmt->rows()) {
+    auto miss = static_cast<size_t>(row.getInt64(0));
+    GorillaSample sample{row.get<int64_t>(1), row.get<double>(2)};
+    points[misses[miss]] = Entities::TimeSeriesPoint{
+        asset_ids[misses[miss]],
+        sample.timestamp_ms,
+        unit_id,
+        sample.value,
+    };
+    found.emplace_back(std::get<int64_t>(keys[miss]), sample);
+  }
 
-  if (result.empty()) {
-    return std::nullopt;
+  std::lock_guard<std::mutex> lock(m_latestMutex);
+  if (epoch == m_latestEpoch) {
+    for (const auto& [asset_key, sample] : found) {
+      m_latest[asset_key][unit_key] = sample;
+    }
   }
+  return points;
+}
 
-  return Entities::TimeSeriesPoint{
-      std::get<std::string>(result[0][0]),
-      std::get<int64_t>(result[0][1]),
-      std::get<std::string>(result[0][2]),
-      std::get<double>(result[0][3]),
-  };
+std::vector<std::optional<Entities::TimeSeriesPoint>>
+TimeSeriesRepository::getLatestPoints(
+    const std::vector<std::string>& asset_ids) {
+  std::vector<std::optional<Entities::TimeSeriesPoint>> points(
+      asset_ids.size());
+  if (asset_ids.empty()) {
+    return points;
+  }
+  if (m_store) {
+    for (size_t i = 0; i < asset_ids.size(); ++i) {
+      points[i] = getLatestPoint(asset_ids[i]);
+    }
+    return points;
+  }
+
+  std::vector<DbValue> keys;
+  keys.reserve(asset_ids.size());
+  for (const auto& asset_id : asset_ids) {
+    keys.emplace_back(surrogateKey(asset_id));
+  }
+
+  // MAX() makes SQLite take the other columns from the same row
+  auto stmt = m_db.prepare(
+      "SELECT k.key, l.unit_key, MAX(l.timestamp_ms), l.value "
+      "FROM json_each(?1) AS k JOIN timeseries_latest AS l "
+      "ON l.asset_key = k.value GROUP BY k.key");
+  stmt->bind(1, toJsonArray(keys));
+
+  std::vector<std::pair<size_t, int64_t>> unitKeys;
+  for (const RowView& row : stmt->rows()) {
+    const auto i = static_cast<size_t>(row.getInt64(0));
+    unitKeys.emplace_back(i, row.get<int64_t>(1));
+    points[i] = Entities::TimeSeriesPoint{asset_ids[i], row.get<int64_t>(2),
+                                          {}, row.get<double>(3)};
+  }
+
+  // Resolved after the scan, so no second statement runs while it is open
+  for (const auto& [i, unit_key] : unitKeys) {
+    points[i]->unit_id = unitId(unit_key);
+  }
+  return points;
 }
 
 void TimeSeriesRepository::deletePoints(const std::string& asset_id,
                                         int64_t from_ms, int64_t to_ms) {
-  auto stmt = m_db.prepare(
-      "DELETE FROM timeseries "
-      "WHERE asset_id = ? AND timestamp_ms >= ? AND timestamp_ms <= ?");
-  stmt->bind(1, asset_id).bind(2, from_ms).bind(3, to_ms);
-  stmt->executeUpdate();
+  if (m_store) {
+    m_store->erase(surrogateKey(asset_id), from_ms, to_ms);
+  } else {
+    auto stmt = m_db.prepare(
+        "DELETE FROM timeseries_points "
+        "WHERE asset_key = ? AND timestamp_ms >= ? AND timestamp_ms <= ?");
+    stmt->bind(1, surrogateKey(asset_id)).bind(2, from_ms).bind(3, to_ms);
+    stmt->executeUpdate();
+  }
+  forgetCached(surrogateKey(asset_id));
 }
 
 void TimeSeriesRepository::deleteAllPoints(const std::string& asset_id) {
-  auto stmt = m_db.prepare("DELETE FROM timeseries WHERE asset_id = ?");
-  stmt->bind(1, asset_id);
-  stmt->executeUpdate();
+  if (m_store) {
+    m_store->eraseAll(surrogateKey(asset_id));
+  } else {
+    auto stmt =
+        m_db.prepare("DELETE FROM timeseries_points WHERE asset_key = ?");
+    stmt->bind(1, surrogateKey(asset_id));
+    stmt->executeUpdate();
+  }
+  forgetCached(surrogateKey(asset_id));
+}
+
+size_t TimeSeriesRepository::expirePoints(const std::string& asset_id,
+                                          int64_t before_ms,
+                                          size_t max_points,
+                                          int64_t rollup_bucket_ms) {
+  if (max_points == 0) {
+    throw std::invalid_argument("Batch size must be positive");
+  }
+  if (rollup_bucket_ms < 0) {
+    throw std::invalid_argument("Bucket width must not be negative");
+  }
+  constexpr int64_t kMinMs = std::numeric_limits<int64_t>::min();
+  if (before_ms == kMinMs) {
+    return 0;
+  }
+
+  // Last timestamp of the batch: that of the max_points-th oldest point,
+  // or everything before before_ms if there are fewer
+  const int64_t asset_key = surrogateKey(asset_id);
+  std::optional<int64_t> bound;
+  if (m_store) {
+    size_t seen = 0;
+    m_store->scan(asset_key, kMinMs, before_ms - 1,
+                  [&](const IPointStore::SeriesPoint& point) {
+                    if (++seen == max_points) {
+                      bound = point.sample.timestamp_ms;
+                      return false;
+                    }
+                    return true;
+                  });
+  } else {
+    auto stmt = m_db.prepare(
+        "SELECT timestamp_ms FROM timeseries_points "
+        "WHERE asset_key = ? AND timestamp_ms < ? "
+        "ORDER BY timestamp_ms LIMIT 1 OFFSET ?");
+    stmt->bind(1, asset_key)
+        .bind(2, before_ms)
+        .bind(3, static_cast<int64_t>(max_points - 1));
+    bound = stmt->fetchScalar<int64_t>();
+  }
+  const int64_t to_ms = bound.value_or(before_ms - 1);
+
+  size_t deleted = 0;
+  m_db.beginTransaction();
+  try {
+    auto points = getPoints(asset_id, kMinMs, to_ms);
+    deleted = points.size();
+    if (rollup_bucket_ms > 0 && !points.empty()) {
+      // Points come by timestamp; each series gets its own buckets
+      std::map<std::string, BucketBuilder> builders;
+      for (const auto& point : points) {
+        builders.try_emplace(point.unit_id, rollup_bucket_ms)
+            .first->second.add(point.timestamp_ms, point.value);
+      }
+
+      // Later steps only ever append newer points to a bucket
+      auto upsert = m_db.prepare(R"(
+        INSERT INTO timeseries_rollups
+          (asset_key, unit_key, bucket_ms, bucket_start_ms,
+           open, high, low, close, avg, count)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT (asset_key, unit_key, bucket_ms, bucket_start_ms)
+        DO UPDATE SET
+          high = max(high, excluded.high),
+          low = min(low, excluded.low),
+          close = excluded.close,
+          avg = (avg * count + excluded.avg * excluded.count) /
+                (count + excluded.count),
+          count = count + excluded.count
+      )");
+      for (auto& [unit_id, builder] : builders) {
+        for (const auto& bucket : builder.finish()) {
+          upsert->reset();
+          upsert->bind(1, asset_key)
+              .bind(2, surrogateKey(unit_id))
+              .bind(3, rollup_bucket_ms)
+              .bind(4, bucket.bucket_start_ms)
+              .bind(5, bucket.open)
+              .bind(6, bucket.high)
+              .bind(7, bucket.low)
+              .bind(8, bucket.close)
+              .bind(9, bucket.avg)
+              .bind(10, bucket.count);
+          upsert->executeUpdate();
+        }
+      }
+    }
+    if (deleted > 0) {
+      deletePoints(asset_id, kMinMs, to_ms);
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+  return deleted;
+}
+
+std::vector<PointBucket> TimeSeriesRepository::getRollups(
+    const std::string& asset_id, const std::string& unit_id,
+    int64_t bucket_ms, int64_t from_ms, int64_t to_ms) {
+  auto stmt = m_db.prepare(
+      "SELECT bucket_start_ms, open, high, low, close, avg, count "
+      "FROM timeseries_rollups "
+      "WHERE asset_key = ? AND unit_key = ? AND bucket_ms = ? "
+      "AND bucket_start_ms >= ? AND bucket_start_ms <= ? "
+      "ORDER BY bucket_start_ms");
+  stmt->bind(1, surrogateKey(asset_id))
+      .bind(2, surrogateKey(unit_id))
+      .bind(3, bucket_ms)
+      .bind(4, from_ms)
+      .bind(5, to_ms);
+
+  return stmt->mapRows<PointBucket>([](const RowView& row) {
+    return PointBucket{row.getInt64(0),  row.getDouble(1), row.getDouble(2),
+                       row.getDouble(3), row.getDouble(4), row.getDouble(5),
+                       row.getInt64(6)};
+  });
+}
+
+std::vector<TimePartition> TimeSeriesRepository::getPartitions() {
+  if (!m_partitions) {
+    throw std::logic_error("Point storage is not partitioned");
+  }
+  return m_partitions->partitions();
+}
+
+size_t TimeSeriesRepository::dropPartitionsBefore(int64_t cutoff_ms) {
+  if (!m_partitions) {
+    throw std::logic_error("Point storage is not partitioned");
+  }
+  size_t dropped = m_partitions->dropBefore(cutoff_ms);
+  if (dropped > 0) {
+    forgetCached(std::nullopt);
+  }
+  return dropped;
+}
+
+std::vector<Entities::TimeSeriesPoint> TimeSeriesRepository::readPoints(
+    IStatement& stmt, const std::string& asset_id) {
+  std::vector<Entities::TimeSeriesPoint> points;
+  std::vector<int64_t> unitKeys;
+  for (const RowView& row : stmt.rows()) {
+    unitKeys.push_back(row.get<int64_t>(0));
+    points.push_back({asset_id, row.get<int64_t>(1), {}, row.get<double>(2)});
+  }
+
+  // Resolved after the scan, so no second statement runs while it is open
+  for (size_t i = 0; i < points.size(); ++i) {
+    points[i].unit_id = unitId(unitKeys[i]);
+  }
+  return points;
+}
+
+std::string TimeSeriesRepository::unitId(int64_t unit_key) {
+  {
+    std::lock_guard<std::mutex> lock(m_unitIdsMutex);
+    auto it = m_unitIds.find(unit_key);
+    if (it != m_unitIds.end()) {
+      return it->second;
+    }
+  }
+
+  auto stmt = m_db.prepare("SELECT id FROM unit_keys WHERE key = ?");
+  stmt->bind(1, unit_key);
+  auto id = stmt->fetchScalar<std::string>();
+  if (!id) {
+    throw QueryException("Unknown unit key: " + std::to_string(unit_key));
+  }
+
+  std::lock_guard<std::mutex> lock(m_unitIdsMutex);
+  m_unitIds.emplace(unit_key, *id);
+  return *id;
+}
+
+void TimeSeriesRepository::writeSeries(
+    const std::vector<IPointStore::SeriesPoint>& points) {
+  const auto newest = newestPerSeries(points);
+  if (m_store) {
+    m_store->write(points);
+    m_upserted.fetch_add(points.size(), std::memory_order_relaxed);
+    publishWrite(newest, points);
+    return;
+  }
+
+  if (m_appendIngest) {
+    appendSeries(points, newest);
+    return;
+  }
+
+  auto insert = m_db.prepare(
+      "INSERT OR REPLACE INTO timeseries_points "
+      "(asset_key, unit_key, timestamp_ms, value) VALUES (?, ?, ?, ?)");
+  // One upsert per series, not per point
+  auto latest = m_db.prepare(
+      "INSERT INTO timeseries_latest "
+      "(asset_key, unit_key, timestamp_ms, value) VALUES (?, ?, ?, ?) "
+      "ON CONFLICT (asset_key, unit_key) DO UPDATE SET "
+      "timestamp_ms = excluded.timestamp_ms, value = excluded.value "
+      "WHERE excluded.timestamp_ms >= timeseries_latest.timestamp_ms");
+
+  m_db.beginTransaction();
+  try {
+    for (const auto& point : points) {
+      insert->reset();
+      insert->bind(1, point.asset_key)
+          .bind(2, point.unit_key)
+          .bind(3, point.sample.timestamp_ms)
+          .bind(4, point.sample.value);
+      insert->executeInsert();
+    }
+    for (const auto& point : newest) {
+      latest->reset();
+      latest->bind(1, point.asset_key)
+          .bind(2, point.unit_key)
+          .bind(3, point.sample.timestamp_ms)
+          .bind(4, point.sample.value);
+      latest->executeInsert();
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+  m_upserted.fetch_add(points.size(), std::memory_order_relaxed);
+  publishWrite(newest, points);
+}
+
+void TimeSeriesRepository::appendSeries(
+    const std::vector<IPointStore::SeriesPoint>& points,
+    const std::vector<IPointStore::SeriesPoint>& newest) {
+  // Stable, so equal timestamps keep their order and the last one wins
+  std::vector<IPointStore::SeriesPoint> sorted = points;
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const IPointStore::SeriesPoint& a,
+                      const IPointStore::SeriesPoint& b) {
+                     return std::tie(a.asset_key, a.unit_key,
+                                     a.sample.timestamp_ms) <
+                            std::tie(b.asset_key, b.unit_key,
+                                     b.sample.timestamp_ms);
+                   });
+  std::vector<std::pair<int64_t, int64_t>> series;
+  series.reserve(newest.size());
+  for (const auto& point : newest) {
+    series.emplace_back(point.asset_key, point.unit_key);
+  }
+  auto marks = highWaterMarks(series);
+
+  auto append = m_db.prepare(
+      "INSERT INTO timeseries_points "
+      "(asset_key, unit_key, timestamp_ms, value) VALUES (?, ?, ?, ?)");
+  auto replace = m_db.prepare(
+      "INSERT OR REPLACE INTO timeseries_points "
+      "(asset_key, unit_key, timestamp_ms, value) VALUES (?, ?, ?, ?)");
+  auto latest = m_db.prepare(
+      "INSERT INTO timeseries_latest "
+      "(asset_key, unit_key, timestamp_ms, value) VALUES (?, ?, ?, ?) "
+      "ON CONFLICT (asset_key, unit_key) DO UPDATE SET "
+      "timestamp_ms = excluded.timestamp_ms, value = excluded.value "
+      "WHERE excluded.timestamp_ms >= timeseries_latest.timestamp_ms");
+  auto write = [](IStatement& stmt, const IPointStore::SeriesPoint& point) {
+    stmt.reset();
+    stmt.bind(1, point.asset_key)
+        .bind(2, point.unit_key)
+        .bind(3, point.sample.timestamp_ms)
+        .bind(4, point.sample.value);
+    stmt.executeInsert();
+  };
+
+  uint64_t appended = 0;
+  m_db.beginTransaction();
+  try {
+    size_t current = 0;  // index into series and marks
+    for (const auto& point : sorted) {
+      while (series[current] !=
+             std::make_pair(point.asset_key, point.unit_key)) {
+        ++current;
+      }
+      auto& mark = marks[current];
+      const int64_t timestamp_ms = point.sample.timestamp_ms;
+      bool done = false;
+      if (!mark || timestamp_ms > *mark) {
+        try {
+          write(*append, point);
+          ++appended;
+          done = true;
+        } catch (const QueryException&) {
+          // A point the mark did not know of, e.g. inserted without the
+          // repository; only this statement was undone
+        }
+      }
+      if (!done) {
+        write(*replace, point);
+      }
+      mark = mark ? std::max(*mark, timestamp_ms) : timestamp_ms;
+    }
+    for (const auto& point : newest) {
+      write(*latest, point);
+    }
+    m_db.commit();
+  } catch (...) {
+    m_db.rollback();
+    throw;
+  }
+  m_appended.fetch_add(appended, std::memory_order_relaxed);
+  m_upserted.fetch_add(points.size() - appended, std::memory_order_relaxed);
+  publishWrite(newest, points);
+}
+
+std::vector<std::optional<int64_t>> TimeSeriesRepository::highWaterMarks(
+    const std::vector<std::pair<int64_t, int64_t>>& series) {
+  std::vector<std::optional<int64_t>> marks(series.size());
+  std::vector<size_t> misses;
+  std::vector<DbValue> asset_keys;
+  std::vector<DbValue> unit_keys;
+  uint64_t epoch;
+  {
+    std::lock_guard<std::mutex> lock(m_latestMutex);
+    for (size_t i = 0; i < series.size(); ++i) {
+      const auto [asset_key, unit_key] = series[i];
+      if (const auto* sample = findLatest(asset_key, unit_key)) {
+        marks[i] = sample->timestamp_ms;
+      } else {
+        misses.push_back(i);
+        asset_keys.emplace_back(asset_key);
+        unit_keys.emplace_back(unit_key);
+      }
+    }
+    epoch = m_latestEpoch;
+  }
+  if (misses.empty()) {
+    return marks;
+  }
+
+  auto stmt = m_db.prepare(
+      "SELECT a.key, l.timestamp_ms, l.value FROM json_each(?1) AS a "
+      "JOIN json_each(?2) AS u ON u.key = a.key "
+      "JOIN timeseries_latest AS l "
+      "ON l.asset_key = a.value AND l.unit_key = u.value");
+  stmt->bind(1, toJsonArray(asset_keys)).bind(2, toJsonArray(unit_keys));
+
+  std::vector<std::pair<size_t, GorillaSample>> found;
+  for (const RowView& row : stmt->rows()) {
+    const size_t i = misses[static_cast<size_t>(row.getInt64(0))];
+    GorillaSample sample{row.get<int64_t>(1), row.get<double>(2)};
+    marks[i] = sample.timestamp_ms;
+    found.emplace_back(i, sample);
+  }
+
+  std::lock_guard<std::mutex> lock(m_latestMutex);
+  if (epoch == m_latestEpoch) {
+    for (const auto& [i, sample] : found) {
+      m_latest[series[i].first][series[i].second] = sample;
+    }
+  }
+  return marks;
+}
+
+std::optional<GorillaSample> TimeSeriesRepository::latestSample(
+    int64_t asset_key, int64_t unit_key) {
+  uint64_t epoch;
+  {
+    std::lock_guard<std::mutex> lock(m_latestMutex);
+    if (const auto* sample = findLatest(asset_key, unit_key)) {
+      return *sample;
+    }
+    epoch = m_latestEpoch;
+  }
+
+  std::optional<GorillaSample> sample;
+  if (m_store) {
+    sample = m_store->latest(asset_key, unit_key);
+  } else {
+    auto stmt = m_db.prepare(
+        "SELECT timestamp_ms, value FROM timeseries_latest "
+        "WHERE asset_key = ? AND unit_key = ?");
+    stmt->bind(1, asset_key).bind(2, unit_key);
+    sample = stmt->mapOne<GorillaSample>([](const RowView& row) {
+      return GorillaSample{row.get<int64_t>(0), row.get<double>(1)};
+    });
+  }
+
+  std::lock_guard<std::mutex> lock(m_latestMutex);
+  if (sample && epoch == m_latestEpoch) {
+    m_latest[asset_key][unit_key] = *sample;
+  }
+  return sample;
+}
+
+// Every stored point from from_ms on, when the range reaches the newest,
+// is what a seed needs; the epoch from the miss discards it if a write
+// or delete came in meanwhile
+void TimeSeriesRepository::readCached(int64_t asset_key, int64_t unit_key,
+                                      int64_t from_ms, int64_t to_ms,
+                                      std::vector<int64_t>& timestamps,
+                                      std::vector<double>& values) {
+  uint64_t epoch;
+  if (m_points.read(asset_key, unit_key, from_ms, to_ms, timestamps, values,
+                    epoch)) {
+    return;
+  }
+  const auto latest = latestSample(asset_key, unit_key);
+
+  std::vector<GorillaSample> samples;
+  if (m_store) {
+    samples = m_store->read(asset_key, unit_key, from_ms, to_ms);
+  } else {
+    auto stmt = m_db.prepare(
+        "SELECT timestamp_ms, value FROM timeseries_points "
+        "WHERE asset_key = ? AND unit_key = ? "
+        "AND timestamp_ms >= ? AND timestamp_ms <= ? "
+        "ORDER BY timestamp_ms");
+    stmt->bind(1, asset_key).bind(2, unit_key).bind(3, from_ms).bind(4, to_ms);
+    for (const RowView& row : stmt->rows()) {
+      samples.push_back({row.getInt64(0), row.getDouble(1)});
+    }
+  }
+  timestamps.reserve(timestamps.size() + samples.size());
+  values.reserve(values.size() + samples.size());
+  for (const auto& sample : samples) {
+    timestamps.push_back(sample.timestamp_ms);
+    values.push_back(sample.value);
+  }
+  if (!latest || latest->timestamp_ms <= to_ms) {
+    m_points.seed(asset_key, unit_key, from_ms, samples, epoch);
+  }
+}
+
+const GorillaSample* TimeSeriesRepository::findLatest(int64_t asset_key,
+                                                      int64_t unit_key) const {
+  auto asset = m_latest.find(asset_key);
+  if (asset == m_latest.end()) {
+    return nullptr;
+  }
+  auto unit = asset->second.find(unit_key);
+  return unit == asset->second.end() ? nullptr : &unit->second;
+}
+
+void TimeSeriesRepository::publishWrite(
+    const std::vector<IPointStore::SeriesPoint>& newest,
+    const std::vector<IPointStore::SeriesPoint>& points) {
+  std::vector<IPointStore::SeriesPoint> cached;
+  if (m_points.enabled()) {
+    cached = points;
+  }
+  std::weak_ptr<const int> alive = m_lifetime;
+  auto ran = std::make_shared<bool>(false);
+  m_db.onTransactionEnd(
+      [this, alive, ran, newest, cached = std::move(cached)](bool committed) {
+        *ran = true;
+        if (alive.expired()) {
+          return;
+        }
+        if (committed) {
+          rememberLatest(newest);
+          m_points.write(cached);
+        } else {
+          // Reads inside the transaction may have cached its points too
+          forgetCached(std::nullopt);
+        }
+      });
+  if (*ran) {
+    return;
+  }
+
+  // Deferred: until then the transaction reads its own points from
+  // storage, everyone else the committed ones
+  std::set<int64_t> assets;
+  for (const auto& point : newest) {
+    assets.insert(point.asset_key);
+  }
+  for (int64_t asset_key : assets) {
+    forgetCached(asset_key);
+  }
+}
+
+// Only advances series already cached: an uncached one may have a newer
+// point stored from an earlier, out-of-order write
+void TimeSeriesRepository::rememberLatest(
+    const std::vector<IPointStore::SeriesPoint>& newest) {
+  std::lock_guard<std::mutex> lock(m_latestMutex);
+  ++m_latestEpoch;
+  for (const auto& point : newest) {
+    auto asset = m_latest.find(point.asset_key);
+    if (asset == m_latest.end()) {
+      continue;
+    }
+    auto unit = asset->second.find(point.unit_key);
+    if (unit != asset->second.end() &&
+        point.sample.timestamp_ms >= unit->second.timestamp_ms) {
+      unit->second = point.sample;
+    }
+  }
+}
+
+void TimeSeriesRepository::forgetCached(std::optional<int64_t> asset_key) {
+  {
+    std::lock_guard<std::mutex> lock(m_latestMutex);
+    ++m_latestEpoch;
+    if (asset_key) {
+      m_latest.erase(*asset_key);
+    } else {
+      m_latest.clear();
+    }
+  }
+  if (asset_key) {
+    m_points.forgetAsset(*asset_key);
+  } else {
+    m_points.clear();
+  }
+}
+
+void TimeSeriesRepository::invalidateLatestCache() {
+  forgetCached(std::nullopt);
 }
 
 // ============================================================
@@ -427,22 +1775,83 @@ void TimeSeriesRepository::deleteAllPoints(const std::string& asset_id) {
 std::optional<double> TimeSeriesRepository::convert(
     double value, const std::string& from_unit_id,
     const std::string& to_unit_id) {
-  if (from_unit_id == to_unit_id) {
-    return value;
+  auto factor = conversionGraph()->factor(from_unit_id, to_unit_id);
+  if (!factor) {
+    return std::nullopt;
   }
+  return value * *factor;
+}
 
-  auto conversion = getConversion(from_unit_id, to_unit_id);
-  if (conversion) {
-    return value * conversion->factor;
+bool TimeSeriesRepository::convertSeries(double* values, size_t count,
+                                         const std::string& from_unit_id,
+                                         const std::string& to_unit_id) {
+  auto factor = conversionGraph()->factor(from_unit_id, to_unit_id);
+  if (!factor) {
+    return false;
   }
 
-  // Try reverse conversion
-  auto reverse = getConversion(to_unit_id, from_unit_id);
-  if (reverse && reverse->factor != 0.0) {
-    return value / reverse->factor;
+  // A plain loop over a local factor, which the compiler vectorizes
+  const double scale = *factor;
+  for (size_t i = 0; i < count; ++i) {
+    values[i] *= scale;
   }
+  return true;
+}
 
-  return std::nullopt;
+void TimeSeriesRepository::invalidateConversions() {
+  std::lock_guard<std::mutex> lock(m_conversionsMutex);
+  m_conversions.reset();
+}
+
+// Loads under the lock, so a write's invalidation waits for any load that
+// may have read the old rows and then discards its result
+std::shared_ptr<const UnitConversionGraph>
+TimeSeriesRepository::conversionGraph() {
+  std::lock_guard<std::mutex> lock(m_conversionsMutex);
+  if (!m_conversions) {
+    m_conversions =
+        std::make_shared<const UnitConversionGraph>(getAllConversions());
+  }
+  return m_conversions;
+}
+
+// ============================================================
+// SeriesCursor Implementation
+// ============================================================
+
+SeriesCursor::SeriesCursor(TimeSeriesRepository& repository,
+                           int64_t asset_key, int64_t unit_key,
+                           int64_t from_ms, int64_t to_ms, size_t page_size)
+    : m_repository(&repository),
+      m_assetKey(asset_key),
+      m_unitKey(unit_key),
+      m_from(from_ms),
+      m_to(to_ms),
+      m_pageSize(page_size),
+      m_done(from_ms > to_ms) {}
+
+bool SeriesCursor::next(int64_t& timestamp_ms, double& value) {
+  if (m_pos == m_page.size()) {
+    if (m_done) {
+      return false;
+    }
+    m_page = m_repository->readPage(m_assetKey, m_unitKey, m_from, m_to,
+                                    m_pageSize);
+    m_pos = 0;
+    // A short page is the last; so is one ending at the top of the range
+    if (m_page.size() < m_pageSize || m_page.back().timestamp_ms >= m_to) {
+      m_done = true;
+    } else {
+      m_from = m_page.back().timestamp_ms + 1;
+    }
+    if (m_page.empty()) {
+      return false;
+    }
+  }
+  timestamp_ms = m_page[m_pos].timestamp_ms;
+  value = m_page[m_pos].value;
+  ++m_pos;
+  return true;
 }
 
 }  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,177 @@
+#include "timeseries_retention.h"
+
+#include <algorithm>
+#include <string>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+using namespace Gateways::Database;
+
+namespace {
+
+RetentionOptions normalized(RetentionOptions options) {
+  options.batchSize = std::max<size_t>(1, options.batchSize);
+  if (!options.now) {
+    options.now = [] {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    };
+  }
+  return options;
+}
+
+void accumulate(RetentionStats& total, const RetentionStats& pass) {
+  total.passes += pass.passes;
+  total.batches += pass.batches;
+  total.pointsDeleted += pass.pointsDeleted;
+  total.partitionsDropped += pass.partitionsDropped;
+  total.pagesFreed += pass.pagesFreed;
+  total.failures += pass.failures;
+}
+
+int64_t pragmaValue(IDatabase& db, const std::string& name) {
+  auto stmt = db.prepare("PRAGMA " + name);
+  return stmt->fetchScalar<int64_t>().value_or(0);
+}
+
+}  // namespace
+
+// ============================================================
+// TimeSeriesRetention Implementation
+// ============================================================
+
+TimeSeriesRetention::TimeSeriesRetention(IDatabase& db,
+                                         TimeSeriesRepository& repository,
+                                         const RetentionOptions& options)
+    : m_db(db), m_repository(repository), m_options(normalized(options)) {}
+
+TimeSeriesRetention::~TimeSeriesRetention() { stop(); }
+
+RetentionStats TimeSeriesRetention::runOnce() {
+  std::lock_guard<std::mutex> pass_lock(m_passMutex);
+  RetentionStats stats = pass();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  accumulate(m_stats, stats);
+  return stats;
+}
+
+void TimeSeriesRetention::start() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_worker.joinable()) {
+    return;
+  }
+  m_stopping = false;
+  m_worker = std::thread(&TimeSeriesRetention::run, this);
+}
+
+void TimeSeriesRetention::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_worker.joinable()) {
+      return;
+    }
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  m_worker.join();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_worker = std::thread();
+  m_stopping = false;
+}
+
+bool TimeSeriesRetention::isRunning() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_worker.joinable() && !m_stopping;
+}
+
+RetentionStats TimeSeriesRetention::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void TimeSeriesRetention::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stopping) {
+    lock.unlock();
+    try {
+      runOnce();
+    } catch (...) {
+      // The next pass retries; the failed batch was rolled back
+      lock.lock();
+      ++m_stats.failures;
+      lock.unlock();
+    }
+    lock.lock();
+    m_wake.wait_for(lock, m_options.interval, [this] { return m_stopping; });
+  }
+}
+
+RetentionStats TimeSeriesRetention::pass() {
+  RetentionStats stats;
+  stats.passes = 1;
+
+  const int64_t cutoff_ms = m_options.now() - m_options.maxAge.count();
+  const int64_t rollup_ms = m_options.rollupBucket.count();
+  if (rollup_ms == 0 &&
+      m_repository.storage() == PointStorage::Partitions) {
+    stats.partitionsDropped = m_repository.dropPartitionsBefore(cutoff_ms);
+  }
+
+  for (const auto& asset : m_repository.getAllAssets()) {
+    while (true) {
+      size_t deleted = m_repository.expirePoints(
+          asset.id, cutoff_ms, m_options.batchSize, rollup_ms);
+      if (deleted == 0) {
+        break;
+      }
+      ++stats.batches;
+      stats.pointsDeleted += deleted;
+      if (!pause()) {
+        return stats;
+      }
+      if (deleted < m_options.batchSize) {
+        break;
+      }
+    }
+  }
+
+  stats.pagesFreed = vacuum();
+  return stats;
+}
+
+size_t TimeSeriesRetention::vacuum() {
+  constexpr int64_t kIncremental = 2;
+  if (m_options.vacuumPages == 0 ||
+      pragmaValue(m_db, "auto_vacuum") != kIncremental) {
+    return 0;
+  }
+
+  const std::string step =
+      "PRAGMA incremental_vacuum(" + std::to_string(m_options.vacuumPages) +
+      ")";
+  size_t freed = 0;
+  int64_t free_pages = pragmaValue(m_db, "freelist_count");
+  while (free_pages > 0) {
+    m_db.execute(step);
+    const int64_t left = pragmaValue(m_db, "freelist_count");
+    if (left >= free_pages) {
+      break;
+    }
+    freed += static_cast<size_t>(free_pages - left);
+    free_pages = left;
+    if (free_pages > 0 && !pause()) {
+      break;
+    }
+  }
+  return freed;
+}
+
+bool TimeSeriesRetention::pause() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return !m_wake.wait_for(lock, m_options.batchPause,
+                          [this] { return m_stopping; });
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,164 @@
+#include "timeseries_sql_functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+namespace {
+
+// ============================================================
+// Aggregates
+// ============================================================
+
+class EmaAggregate : public SqlAggregate {
+ public:
+  void step(const SqlFunctionArgs& args) override {
+    if (m_count == 0) {
+      const int64_t window = args.getInt64(1);
+      if (window < 1) {
+        throw std::invalid_argument("window must be at least 1");
+      }
+      m_alpha = 2.0 / (static_cast<double>(window) + 1.0);
+    }
+    if (args.isNull(0)) {
+      return;
+    }
+    const double value = args.getDouble(0);
+    m_ema = m_count++ == 0 ? value : m_ema + m_alpha * (value - m_ema);
+  }
+
+  DbValue value() const override {
+    if (m_count == 0) {
+      return nullptr;
+    }
+    return m_ema;
+  }
+
+ private:
+  uint64_t m_count = 0;
+  double m_alpha = 0.0;
+  double m_ema = 0.0;
+};
+
+class VwapAggregate : public SqlAggregate {
+ public:
+  void step(const SqlFunctionArgs& args) override { add(args, 1.0); }
+  void inverse(const SqlFunctionArgs& args) override { add(args, -1.0); }
+
+  DbValue value() const override {
+    if (m_weightSum == 0.0) {
+      return nullptr;
+    }
+    return m_sum / m_weightSum;
+  }
+
+ private:
+  void add(const SqlFunctionArgs& args, double sign) {
+    if (args.isNull(0) || args.isNull(1)) {
+      return;
+    }
+    const double weight = args.getDouble(1);
+    m_sum += sign * args.getDouble(0) * weight;
+    m_weightSum += sign * weight;
+  }
+
+  double m_sum = 0.0;
+  double m_weightSum = 0.0;
+};
+
+// Welford's running mean and sum of squared deviations, which removes a
+// value as exactly as it adds one
+class StddevAggregate : public SqlAggregate {
+ public:
+  void step(const SqlFunctionArgs& args) override {
+    if (args.isNull(0)) {
+      return;
+    }
+    const double value = args.getDouble(0);
+    ++m_count;
+    const double delta = value - m_mean;
+    m_mean += delta / static_cast<double>(m_count);
+    m_m2 += delta * (value - m_mean);
+  }
+
+  void inverse(const SqlFunctionArgs& args) override {
+    if (args.isNull(0)) {
+      return;
+    }
+    if (--m_count == 0) {
+      m_mean = 0.0;
+      m_m2 = 0.0;
+      return;
+    }
+    const double value = args.getDouble(0);
+    const double delta = value - m_mean;
+    m_mean -= delta / static_cast<double>(m_count);
+    m_m2 -= delta * (value - m_mean);
+  }
+
+  DbValue value() const override {
+    if (m_count < 2) {
+      return nullptr;
+    }
+    return std::sqrt(std::max(m_m2, 0.0) / static_cast<double>(m_count - 1));
+  }
+
+ private:
+  uint64_t m_count = 0;
+  double m_mean = 0.0;
+  double m_m2 = 0.0;
+};
+
+// ============================================================
+// Registration
+// ============================================================
+
+template <typename Database>
+void registerAll(Database& db, TimeSeriesRepository& repository) {
+  // The conversion table can change, so not deterministic
+  SqlFunctionOptions conversion;
+  conversion.deterministic = false;
+  db.createFunction(
+      "convert_unit", 3,
+      [&repository](const SqlFunctionArgs& args) -> DbValue {
+        if (args.isNull(0) || args.isNull(1) || args.isNull(2)) {
+          return nullptr;
+        }
+        auto converted =
+            repository.convert(args.getDouble(0), std::string(args.getText(1)),
+                               std::string(args.getText(2)));
+        if (!converted) {
+          return nullptr;
+        }
+        return *converted;
+      },
+      conversion);
+
+  SqlFunctionOptions window;
+  window.window = true;
+  db.createAggregate(
+      "ema", 2, [] { return std::make_unique<EmaAggregate>(); }, window);
+  db.createAggregate(
+      "vwap", 2, [] { return std::make_unique<VwapAggregate>(); }, window);
+  db.createAggregate(
+      "stddev", 1, [] { return std::make_unique<StddevAggregate>(); }, window);
+}
+
+}  // namespace
+
+void registerTimeSeriesFunctions(SqliteDatabase& db,
+                                 TimeSeriesRepository& repository) {
+  registerAll(db, repository);
+}
+
+void registerTimeSeriesFunctions(SqlitePool& db,
+                                 TimeSeriesRepository& repository) {
+  registerAll(db, repository);
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
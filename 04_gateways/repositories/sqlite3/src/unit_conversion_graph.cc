@@ -0,0 +1,79 @@
+#include "unit_conversion_graph.h"
+
+#include <deque>
+#include <utility>
+
+namespace Gateways::Repositories::Sqlite3 {
+
+namespace {
+
+struct Edge {
+  const std::string* to;
+  double factor;
+};
+
+using Adjacency = std::unordered_map<std::string, std::vector<Edge>>;
+
+// Stored rows go in first so breadth-first search reaches them before a
+// reverse edge of the same length
+Adjacency buildAdjacency(
+    const std::vector<Entities::UnitConversion>& conversions) {
+  Adjacency edges;
+  for (const auto& conversion : conversions) {
+    edges[conversion.from_unit_id].push_back(
+        {&conversion.to_unit_id, conversion.factor});
+    edges.try_emplace(conversion.to_unit_id);
+  }
+  for (const auto& conversion : conversions) {
+    if (conversion.factor != 0.0) {
+      edges[conversion.to_unit_id].push_back(
+          {&conversion.from_unit_id, 1.0 / conversion.factor});
+    }
+  }
+  return edges;
+}
+
+}  // namespace
+
+UnitConversionGraph::UnitConversionGraph(
+    const std::vector<Entities::UnitConversion>& conversions) {
+  const Adjacency edges = buildAdjacency(conversions);
+  m_factors.reserve(edges.size());
+
+  for (const auto& [source, _] : edges) {
+    auto& reached = m_factors[source];
+    reached.emplace(source, 1.0);
+
+    std::deque<std::pair<const std::string*, double>> frontier;
+    frontier.emplace_back(&source, 1.0);
+    while (!frontier.empty()) {
+      auto [unit, scale] = frontier.front();
+      frontier.pop_front();
+      for (const auto& edge : edges.at(*unit)) {
+        const double through = scale * edge.factor;
+        if (reached.emplace(*edge.to, through).second) {
+          frontier.emplace_back(edge.to, through);
+        }
+      }
+    }
+  }
+}
+
+std::optional<double> UnitConversionGraph::factor(
+    const std::string& from_unit_id, const std::string& to_unit_id) const {
+  if (from_unit_id == to_unit_id) {
+    return 1.0;
+  }
+
+  auto from = m_factors.find(from_unit_id);
+  if (from == m_factors.end()) {
+    return std::nullopt;
+  }
+  auto to = from->second.find(to_unit_id);
+  if (to == from->second.end()) {
+    return std::nullopt;
+  }
+  return to->second;
+}
+
+}  // namespace Gateways::Repositories::Sqlite3
@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -64,6 +66,78 @@ TEST_F(AccountRepositoryTest, CreateAccountWithPasswordHash) {
             (std::vector<uint8_t>{0x01, 0x02, 0x03, 0x04}));
 }
 
+TEST_F(AccountRepositoryTest, TryCreateAccountReportsConflicts) {
+  EXPECT_EQ(repo_->tryCreateAccount({"a1", "Alice", std::nullopt, 1000}),
+            Entities::AccountConflict::None);
+  EXPECT_EQ(repo_->tryCreateAccount({"a1", "Bob", std::nullopt, 1000}),
+            Entities::AccountConflict::Id);
+  EXPECT_EQ(repo_->tryCreateAccount({"a2", "Alice", std::nullopt, 1000}),
+            Entities::AccountConflict::Name);
+  // Both taken: the id is reported
+  EXPECT_EQ(repo_->tryCreateAccount({"a1", "Alice", std::nullopt, 1000}),
+            Entities::AccountConflict::Id);
+  EXPECT_EQ(repo_->countAccounts(), 1);
+}
+
+TEST_F(AccountRepositoryTest, TryCreateAccountIsOneStatement) {
+  db_->enableProfiling(true);
+  repo_->tryCreateAccount({"a1", "Alice", std::nullopt, 1000});
+  repo_->tryCreateAccount({"a1", "Bob", std::nullopt, 1000});
+
+  uint64_t calls = 0;
+  for (const auto& profile : db_->queryProfile()) {
+    calls += profile.calls;
+  }
+  EXPECT_EQ(calls, 2u);
+}
+
+TEST_F(AccountRepositoryTest, CreateAccountsSpansChunks) {
+  const size_t count = AccountRepository::kAccountsPerInsert * 2 + 7;
+  std::vector<Entities::Account> accounts;
+  for (size_t i = 0; i < count; ++i) {
+    accounts.push_back({"a" + std::to_string(i), "n" + std::to_string(i),
+                        std::nullopt, static_cast<int64_t>(i)});
+  }
+  accounts[3].password_hash = std::vector<uint8_t>{1, 2, 3};
+
+  repo_->createAccounts(accounts);
+
+  EXPECT_EQ(repo_->countAccounts(), static_cast<int64_t>(count));
+  auto last = repo_->getAccount("a" + std::to_string(count - 1));
+  ASSERT_TRUE(last.has_value());
+  EXPECT_EQ(last->name, "n" + std::to_string(count - 1));
+  EXPECT_EQ(repo_->getAccount("a3")->password_hash,
+            (std::vector<uint8_t>{1, 2, 3}));
+}
+
+TEST_F(AccountRepositoryTest, CreateAccountsIsAllOrNothing) {
+  repo_->createAccount({"a1", "Alice", std::nullopt, 1000});
+
+  EXPECT_THROW(repo_->createAccounts({{"a2", "Bob", std::nullopt, 1000},
+                                      {"a3", "Alice", std::nullopt, 1000}}),
+               Gateways::Database::ConstraintException);
+  EXPECT_EQ(repo_->countAccounts(), 1);
+  EXPECT_FALSE(repo_->accountExists("a2"));
+}
+
+TEST_F(AccountRepositoryTest, FindAccountConflictsChecksBatch) {
+  repo_->createAccount({"a1", "Alice", std::nullopt, 1000});
+  repo_->createAccount({"a2", "Bob", std::nullopt, 1000});
+
+  auto conflicts =
+      repo_->findAccountConflicts({{"a1", "Carol", std::nullopt, 0},
+                                   {"a3", "Bob", std::nullopt, 0},
+                                   {"a2", "Alice", std::nullopt, 0},
+                                   {"a4", "Dave", std::nullopt, 0}});
+
+  EXPECT_EQ(conflicts, (std::vector<Entities::AccountConflict>{
+                           Entities::AccountConflict::Id,
+                           Entities::AccountConflict::Name,
+                           Entities::AccountConflict::Id,
+                           Entities::AccountConflict::None}));
+  EXPECT_TRUE(repo_->findAccountConflicts({}).empty());
+}
+
 TEST_F(AccountRepositoryTest, GetAccountNotFound) {
   auto retrieved = repo_->getAccount("nonexistent");
   EXPECT_FALSE(retrieved.has_value());
@@ -101,6 +175,67 @@ TEST_F(AccountRepositoryTest, GetAllAccountsEmpty) {
   EXPECT_TRUE(accounts.empty());
 }
 
+TEST_F(AccountRepositoryTest, ListAccountsPagesByName) {
+  for (const char* name : {"Dave", "Alice", "Charlie", "Bob", "Eve"}) {
+    repo_->createAccount(
+        {std::string("id_") + name, name, std::vector<uint8_t>{0x01}, 1000});
+  }
+
+  std::vector<std::string> names;
+  std::optional<std::string> after;
+  size_t pages = 0;
+  for (;;) {
+    auto page = repo_->listAccounts(after, 2);
+    if (page.empty()) {
+      break;
+    }
+    ++pages;
+    for (const auto& summary : page) {
+      names.push_back(summary.name);
+    }
+    after = page.back().name;
+  }
+
+  EXPECT_EQ(pages, 3u);
+  EXPECT_EQ(names, (std::vector<std::string>{"Alice", "Bob", "Charlie",
+                                             "Dave", "Eve"}));
+  auto first = repo_->listAccounts(std::nullopt, 1);
+  ASSERT_EQ(first.size(), 1u);
+  EXPECT_EQ(first[0].id, "id_Alice");
+  EXPECT_EQ(first[0].created_at, 1000);
+  EXPECT_TRUE(repo_->listAccounts(std::nullopt, 0).empty());
+  EXPECT_EQ(repo_->listAccounts("Bz", 10).size(), 3u);
+}
+
+TEST_F(AccountRepositoryTest, ListAccountsSeeksTheNameIndex) {
+  auto plan = db_->prepare(
+      "EXPLAIN QUERY PLAN SELECT id, name, created_at FROM accounts "
+      "WHERE name > ? ORDER BY name LIMIT ?");
+  std::string detail;
+  for (const auto& row : plan->rows()) {
+    detail += std::string(row.getText(3));
+  }
+  EXPECT_NE(detail.find("SEARCH"), std::string::npos) << detail;
+  EXPECT_EQ(detail.find("TEMP B-TREE"), std::string::npos) << detail;
+}
+
+TEST_F(AccountRepositoryTest, GetAccountsByIds) {
+  repo_->createAccount({"a1", "Alice", std::vector<uint8_t>{0x01}, 1000});
+  repo_->createAccount({"a2", "Bob", std::nullopt, 2000});
+
+  auto accounts = repo_->getAccounts({"a2", "missing", "a1", "a2"});
+  ASSERT_EQ(accounts.size(), 4u);
+  ASSERT_TRUE(accounts[0].has_value());
+  EXPECT_EQ(accounts[0]->name, "Bob");
+  EXPECT_FALSE(accounts[1].has_value());
+  ASSERT_TRUE(accounts[2].has_value());
+  EXPECT_EQ(accounts[2]->password_hash, (std::vector<uint8_t>{0x01}));
+  ASSERT_TRUE(accounts[3].has_value());
+  EXPECT_EQ(accounts[3]->id, "a2");
+
+  EXPECT_TRUE(repo_->getAccounts({}).empty());
+}
+
 TEST_F(AccountRepositoryTest, UpdateAccount) {
   repo_->createAccount({"a1", "Original", std::nullopt, 1000});
 
@@ -167,6 +302,64 @@ TEST_F(AccountRepositoryTest, AccountExistsByName) {
   EXPECT_FALSE(repo_->accountExistsByName("Jane"));
 }
 
+class FilteredAccountRepositoryTest : public AccountRepositoryTest {
+ protected:
+  void SetUp() override {
+    AccountRepositoryTest::SetUp();
+    repo_->createAccount({"a1", "Alice", std::nullopt, 1000});
+    AccountOptions options;
+    options.existenceFilter = true;
+    options.filterCapacity = 100;
+    filtered_ = std::make_unique<AccountRepository>(*db_, options);
+  }
+
+  std::unique_ptr<AccountRepository> filtered_;
+};
+
+TEST_F(FilteredAccountRepositoryTest, MissesSkipTheQuery) {
+  EXPECT_TRUE(filtered_->accountExists("a1"));
+  EXPECT_TRUE(filtered_->accountExistsByName("Alice"));
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_FALSE(filtered_->accountExists("x" + std::to_string(i)));
+    EXPECT_FALSE(filtered_->accountExistsByName("y" + std::to_string(i)));
+  }
+
+  auto stats = filtered_->existenceFilterStats();
+  EXPECT_EQ(stats.checks, 102u);
+  EXPECT_GE(stats.skipped, 95u);
+  EXPECT_EQ(stats.skipped + stats.falsePositives, 100u);
+}
+
+TEST_F(FilteredAccountRepositoryTest, LearnsItsOwnWrites) {
+  EXPECT_FALSE(filtered_->accountExists("a2"));
+  EXPECT_EQ(filtered_->tryCreateAccount({"a2", "Bob", std::nullopt, 1000}),
+            Entities::AccountConflict::None);
+  EXPECT_TRUE(filtered_->accountExists("a2"));
+
+  filtered_->updateAccount({"a2", "Robert", std::nullopt, 1000});
+  EXPECT_TRUE(filtered_->accountExistsByName("Robert"));
+
+  filtered_->deleteAccount("a2");
+  EXPECT_FALSE(filtered_->accountExists("a2"));
+}
+
+TEST_F(FilteredAccountRepositoryTest, RebuildPicksUpOtherWriters) {
+  EXPECT_FALSE(filtered_->accountExistsByName("Carol"));
+  repo_->createAccount({"a3", "Carol", std::nullopt, 1000});
+
+  filtered_->rebuildExistenceFilters();
+  EXPECT_TRUE(filtered_->accountExistsByName("Carol"));
+}
+
+TEST_F(AccountRepositoryTest, ExistenceFilterOffByDefault) {
+  repo_->accountExists("a1");
+  EXPECT_EQ(repo_->existenceFilterStats().checks, 0u);
+  AccountOptions options;
+  options.existenceFilter = true;
+  options.filterFalsePositiveRate = 0.0;
+  EXPECT_THROW(AccountRepository(*db_, options), std::invalid_argument);
+}
+
 // ============================================================
 // Account Property CRUD
 // ============================================================
@@ -261,6 +454,78 @@ TEST_F(AccountRepositoryTest, GetPropertiesEmpty) {
   EXPECT_TRUE(props.empty());
 }
 
+TEST_F(AccountRepositoryTest, ListPropertiesPagesByKey) {
+  repo_->createAccount({"a1", "User", std::nullopt, 1000});
+  repo_->createAccount({"a2", "Other", std::nullopt, 1000});
+  for (int i = 0; i < 5; ++i) {
+    repo_->setProperty("a1", "key" + std::to_string(i), "v");
+  }
+  repo_->setProperty("a2", "key9", "v");
+
+  auto first = repo_->listProperties("a1", std::nullopt, 3);
+  ASSERT_EQ(first.size(), 3u);
+  EXPECT_EQ(first[0].key, "key0");
+  EXPECT_EQ(first[2].key, "key2");
+
+  auto rest = repo_->listProperties("a1", first.back().key, 3);
+  ASSERT_EQ(rest.size(), 2u);
+  EXPECT_EQ(rest[0].key, "key3");
+  EXPECT_EQ(rest[1].key, "key4");
+  EXPECT_TRUE(repo_->listProperties("a1", rest.back().key, 3).empty());
+  EXPECT_TRUE(repo_->listProperties("missing", std::nullopt, 3).empty());
+}
+
+TEST_F(AccountRepositoryTest, GetPropertiesForAccounts) {
+  repo_->createAccount({"a1", "User", std::nullopt, 1000});
+  repo_->createAccount({"a2", "Other", std::nullopt, 1000});
+  repo_->createAccount({"a3", "Bare", std::nullopt, 1000});
+  repo_->setProperty("a1", "b", "1");
+  repo_->setProperty("a1", "a", "2", "first");
+  repo_->setProperty("a2", "c", "3");
+
+  auto properties =
+      repo_->getPropertiesForAccounts({"a2", "a3", "missing", "a1", "a2"});
+  ASSERT_EQ(properties.size(), 5u);
+  ASSERT_EQ(properties[0].size(), 1u);
+  EXPECT_EQ(properties[0][0].key, "c");
+  EXPECT_TRUE(properties[1].empty());
+  EXPECT_TRUE(properties[2].empty());
+  ASSERT_EQ(properties[3].size(), 2u);
+  EXPECT_EQ(properties[3][0].key, "a");
+  EXPECT_EQ(*properties[3][0].description, "first");
+  EXPECT_EQ(properties[3][1].key, "b");
+  EXPECT_EQ(properties[4].size(), 1u);
+
+  EXPECT_TRUE(repo_->getPropertiesForAccounts({}).empty());
+}
+
+TEST_F(AccountRepositoryTest, GetAccountsWithProperties) {
+  repo_->createAccount({"a1", "Alice", std::vector<uint8_t>{0x01}, 1000});
+  repo_->createAccount({"a2", "Bob", std::nullopt, 2000});
+  repo_->createAccount({"a3", "Carol", std::nullopt, 3000});
+  for (int i = 0; i < 3; ++i) {
+    repo_->setProperty("a1", "k" + std::to_string(i), "v");
+  }
+  repo_->setProperty("a3", "k", "v");
+
+  // The limit counts accounts, not property rows
+  auto page = repo_->getAccountsWithProperties(std::nullopt, 2);
+  ASSERT_EQ(page.size(), 2u);
+  EXPECT_EQ(page[0].account.name, "Alice");
+  ASSERT_EQ(page[0].properties.size(), 3u);
+  EXPECT_EQ(page[0].properties[2].key, "k2");
+  EXPECT_EQ(page[0].properties[2].account_id, "a1");
+  EXPECT_EQ(page[1].account.name, "Bob");
+  EXPECT_TRUE(page[1].properties.empty());
+
+  auto rest = repo_->getAccountsWithProperties(page.back().account.name, 2);
+  ASSERT_EQ(rest.size(), 1u);
+  EXPECT_EQ(rest[0].account.id, "a3");
+  EXPECT_EQ(rest[0].account.created_at, 3000);
+  EXPECT_EQ(rest[0].properties.size(), 1u);
+  EXPECT_TRUE(repo_->getAccountsWithProperties(std::nullopt, 0).empty());
+}
+
 TEST_F(AccountRepositoryTest, GetPropertiesByPrefix) {
   repo_->createAccount({"a1", "User", std::nullopt, 1000});
   repo_->setProperty("a1", "ui.theme", "dark");
@@ -273,6 +538,24 @@ TEST_F(AccountRepositoryTest, GetPropertiesByPrefix) {
   EXPECT_EQ(uiProps[1].key, "ui.theme");
 }
 
+TEST_F(AccountRepositoryTest, PropertyPrefixesAreLiteral) {
+  repo_->createAccount({"a1", "User", std::nullopt, 1000});
+  repo_->createAccount({"a2", "Other", std::nullopt, 1000});
+  repo_->setProperty("a1", "ui_x", "1");
+  repo_->setProperty("a1", "uiXx", "2");
+  repo_->setProperty("a1", "UI_y", "3");
+  repo_->setProperty("a2", "ui_z", "4");
+
+  auto props = repo_->getPropertiesByPrefix("a1", "ui_");
+  ASSERT_EQ(props.size(), 1u);
+  EXPECT_EQ(props[0].key, "ui_x");
+
+  repo_->removePropertiesByPrefix("a1", "ui_");
+  EXPECT_TRUE(repo_->propertyExists("a1", "uiXx"));
+  EXPECT_TRUE(repo_->propertyExists("a1", "UI_y"));
+  EXPECT_TRUE(repo_->propertyExists("a2", "ui_z"));
+}
+
 TEST_F(AccountRepositoryTest, PropertyExists) {
   repo_->createAccount({"a1", "User", std::nullopt, 1000});
   repo_->setProperty("a1", "key", "value");
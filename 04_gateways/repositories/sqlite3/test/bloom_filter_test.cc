@@ -0,0 +1,52 @@
+#include "bloom_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+TEST(BloomFilterTest, NoFalseNegatives) {
+  BloomFilter filter(1000, 0.01);
+  for (int i = 0; i < 1000; ++i) {
+    filter.add("key" + std::to_string(i));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(filter.mayContain("key" + std::to_string(i))) << i;
+  }
+}
+
+TEST(BloomFilterTest, FalsePositiveRateNearTarget) {
+  BloomFilter filter(10000, 0.01);
+  for (int i = 0; i < 10000; ++i) {
+    filter.add("member" + std::to_string(i));
+  }
+
+  int positives = 0;
+  for (int i = 0; i < 100000; ++i) {
+    positives += filter.mayContain("other" + std::to_string(i)) ? 1 : 0;
+  }
+  EXPECT_LT(positives, 2000);  // 1% expected, 2% allowed
+  EXPECT_EQ(filter.hashCount(), 7u);
+}
+
+TEST(BloomFilterTest, EmptyAndClear) {
+  BloomFilter filter(10, 0.1);
+  EXPECT_FALSE(filter.mayContain(""));
+  filter.add("");
+  filter.add("a");
+  EXPECT_TRUE(filter.mayContain(""));
+  filter.clear();
+  EXPECT_FALSE(filter.mayContain("a"));
+}
+
+TEST(BloomFilterTest, RejectsBadSizing) {
+  EXPECT_THROW(BloomFilter(0, 0.01), std::invalid_argument);
+  EXPECT_THROW(BloomFilter(10, 0.0), std::invalid_argument);
+  EXPECT_THROW(BloomFilter(10, 1.0), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
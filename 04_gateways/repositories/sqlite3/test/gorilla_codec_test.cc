@@ -0,0 +1,120 @@
+#include "gorilla_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+uint64_t bitsOf(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Bit-exact comparison, so NaN payloads and -0.0 count
+void expectRoundTrip(const std::vector<GorillaSample>& samples) {
+  auto decoded = gorillaDecode(gorillaEncode(samples));
+  ASSERT_EQ(decoded.size(), samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(decoded[i].timestamp_ms, samples[i].timestamp_ms) << i;
+    EXPECT_EQ(bitsOf(decoded[i].value), bitsOf(samples[i].value)) << i;
+  }
+}
+
+// ============================================================
+// Round Trips
+// ============================================================
+TEST(GorillaCodecTest, EmptyAndSingleSample) {
+  expectRoundTrip({});
+  expectRoundTrip({{1000, 42.5}});
+}
+
+TEST(GorillaCodecTest, RegularIntervalsAndJitter) {
+  std::vector<GorillaSample> samples;
+  int64_t timestamp = 1700000000000;
+  for (int i = 0; i < 1000; ++i) {
+    // Mostly 1s apart, with jitter in every delta-of-delta bucket
+    timestamp += 1000 + (i % 7 == 0 ? 30 : 0) + (i % 11 == 0 ? 200 : 0) +
+                 (i % 13 == 0 ? 1500 : 0) + (i % 97 == 0 ? 86400000 : 0);
+    samples.push_back({timestamp, 20.0 + (i % 5) * 0.25});
+  }
+  expectRoundTrip(samples);
+}
+
+TEST(GorillaCodecTest, RandomValues) {
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  std::vector<GorillaSample> samples;
+  for (int64_t i = 0; i < 2000; ++i) {
+    samples.push_back({i * 250, dist(rng)});
+  }
+  expectRoundTrip(samples);
+}
+
+TEST(GorillaCodecTest, SpecialDoubles) {
+  expectRoundTrip({
+      {1, 0.0},
+      {2, -0.0},
+      {3, std::numeric_limits<double>::infinity()},
+      {4, -std::numeric_limits<double>::infinity()},
+      {5, std::numeric_limits<double>::quiet_NaN()},
+      {6, std::numeric_limits<double>::denorm_min()},
+      {7, std::numeric_limits<double>::max()},
+      {8, 1.0},
+  });
+}
+
+TEST(GorillaCodecTest, ExtremeTimestamps) {
+  expectRoundTrip({
+      {std::numeric_limits<int64_t>::min(), 1.0},
+      {-1, 2.0},
+      {0, 3.0},
+      {std::numeric_limits<int64_t>::max(), 4.0},
+  });
+}
+
+// ============================================================
+// Compression
+// ============================================================
+TEST(GorillaCodecTest, RegularSeriesCompressesBelowTwoBytesPerPoint) {
+  std::vector<GorillaSample> samples;
+  for (int64_t i = 0; i < 3600; ++i) {
+    // A slowly moving gauge, quantized like a real sensor
+    samples.push_back({1700000000000 + i * 1000, 21.5 + (i / 60) * 0.5});
+  }
+
+  auto data = gorillaEncode(samples);
+  EXPECT_LT(data.size(), samples.size() * 2);
+}
+
+// ============================================================
+// Errors
+// ============================================================
+TEST(GorillaCodecTest, UnsortedSamplesThrow) {
+  EXPECT_THROW(gorillaEncode({{2000, 1.0}, {1000, 2.0}}),
+               std::invalid_argument);
+  EXPECT_THROW(gorillaEncode({{1000, 1.0}, {1000, 2.0}}),
+               std::invalid_argument);
+}
+
+TEST(GorillaCodecTest, TruncatedDataThrows) {
+  std::vector<GorillaSample> samples;
+  for (int64_t i = 0; i < 100; ++i) {
+    samples.push_back({i * 1000, static_cast<double>(i) * 1.5});
+  }
+  auto data = gorillaEncode(samples);
+  data.resize(data.size() / 2);
+
+  EXPECT_THROW(gorillaDecode(data), Gateways::Database::QueryException);
+  EXPECT_THROW(gorillaDecode(BlobView()), Gateways::Database::QueryException);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
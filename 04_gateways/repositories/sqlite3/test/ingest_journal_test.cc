@@ -0,0 +1,325 @@
+#include "ingest_journal.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class IngestJournalTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() /
+           ("test_journal_" +
+            std::to_string(reinterpret_cast<uintptr_t>(this)));
+    std::filesystem::remove_all(dir_);
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    repo_ = std::make_unique<TimeSeriesRepository>(*db_);
+    repo_->initSchema();
+    repo_->createAsset({"a1", "Asset 1", "", ""});
+    repo_->createAsset({"a2", "Asset 2", "", ""});
+    repo_->createUnit({"u1", "X", "Unit X"});
+  }
+
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  // Small segments, so a few hundred points rotate
+  static JournalOptions smallSegments(JournalSync sync = JournalSync::None) {
+    JournalOptions options;
+    options.segmentBytes = 4096;
+    options.sync = sync;
+    return options;
+  }
+
+  // count points of a1 and a2, one second apart from start
+  static std::vector<Entities::TimeSeriesPoint> batch(int64_t start,
+                                                      int64_t count) {
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (int64_t i = start; i < start + count; ++i) {
+      points.push_back({i % 2 ? "a2" : "a1", i * 1000, "u1", i * 0.5});
+    }
+    return points;
+  }
+
+  static std::vector<Entities::TimeSeriesPoint> readAll(
+      const IngestJournal& journal) {
+    std::vector<Entities::TimeSeriesPoint> points;
+    const JournalPosition end =
+        journal.read(journal.begin(), SIZE_MAX, points);
+    EXPECT_EQ(end, journal.end());
+    return points;
+  }
+
+  size_t storedPoints() {
+    return repo_->getPoints("a1", 0, INT64_MAX).size() +
+           repo_->getPoints("a2", 0, INT64_MAX).size();
+  }
+
+  size_t segmentFiles() const {
+    return static_cast<size_t>(
+        std::distance(std::filesystem::directory_iterator(dir_),
+                      std::filesystem::directory_iterator()));
+  }
+
+  std::filesystem::path dir_;
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+// ============================================================
+// Appending and Reading
+// ============================================================
+TEST_F(IngestJournalTest, ReadsBackAppendedPointsAcrossSegments) {
+  IngestJournal journal(dir_.string(), smallSegments());
+  const JournalPosition start = journal.begin();
+  EXPECT_EQ(journal.end(), start);
+
+  for (int64_t i = 0; i < 50; ++i) {
+    const JournalPosition end = journal.append(batch(i * 10, 10));
+    EXPECT_EQ(end, journal.end());
+  }
+  auto stats = journal.stats();
+  EXPECT_EQ(stats.records, 50u);
+  EXPECT_EQ(stats.points, 500u);
+  EXPECT_GT(stats.segmentsCreated, 2u);
+  EXPECT_EQ(segmentFiles(), stats.segmentsCreated);
+
+  auto points = readAll(journal);
+  ASSERT_EQ(points.size(), 500u);
+  for (int64_t i = 0; i < 500; ++i) {
+    EXPECT_EQ(points[i].asset_id, i % 2 ? "a2" : "a1");
+    EXPECT_EQ(points[i].timestamp_ms, i * 1000);
+    EXPECT_EQ(points[i].unit_id, "u1");
+    EXPECT_DOUBLE_EQ(points[i].value, i * 0.5);
+  }
+}
+
+TEST_F(IngestJournalTest, ReadStopsAfterWholeRecords) {
+  IngestJournal journal(dir_.string(), smallSegments());
+  journal.append(batch(0, 10));
+  const JournalPosition middle = journal.append(batch(10, 10));
+  journal.append(batch(20, 10));
+
+  std::vector<Entities::TimeSeriesPoint> points;
+  EXPECT_EQ(journal.read(journal.begin(), 15, points), middle);
+  EXPECT_EQ(points.size(), 20u);
+  EXPECT_EQ(journal.read(middle, 1, points), journal.end());
+  EXPECT_EQ(points.size(), 30u);
+  EXPECT_EQ(journal.read(journal.end(), 1, points), journal.end());
+}
+
+TEST_F(IngestJournalTest, EmptyAppendWritesNothing) {
+  IngestJournal journal(dir_.string(), smallSegments());
+  EXPECT_EQ(journal.append(std::vector<Entities::TimeSeriesPoint>{}),
+            journal.begin());
+  EXPECT_EQ(journal.stats().records, 0u);
+}
+
+TEST_F(IngestJournalTest, RejectsRecordsLargerThanASegment) {
+  IngestJournal journal(dir_.string(), smallSegments());
+  EXPECT_THROW(journal.append(batch(0, 1000)), std::invalid_argument);
+  EXPECT_THROW(journal.append({std::string(70000, 'a'), 0, "u1", 1.0}),
+               std::invalid_argument);
+  EXPECT_EQ(journal.end(), journal.begin());
+}
+
+TEST_F(IngestJournalTest, EveryAppendSyncsEachRecord) {
+  IngestJournal journal(dir_.string(), smallSegments(JournalSync::EveryAppend));
+  journal.append(batch(0, 10));
+  journal.append(batch(10, 10));
+  EXPECT_EQ(journal.stats().syncs, 2u);
+}
+
+TEST_F(IngestJournalTest, SyncFlushesOnlyWhatIsDirty) {
+  IngestJournal journal(dir_.string(), smallSegments());
+  journal.append(batch(0, 10));
+  journal.sync();
+  EXPECT_EQ(journal.stats().syncs, 1u);
+  journal.sync();
+  EXPECT_EQ(journal.stats().syncs, 1u);
+}
+
+// ============================================================
+// Recovery
+// ============================================================
+TEST_F(IngestJournalTest, ReopeningResumesAfterTheLastRecord) {
+  JournalPosition end;
+  {
+    IngestJournal journal(dir_.string(), smallSegments());
+    for (int64_t i = 0; i < 30; ++i) {
+      end = journal.append(batch(i * 10, 10));
+    }
+  }
+  IngestJournal journal(dir_.string(), smallSegments());
+  EXPECT_EQ(journal.end(), end);
+  EXPECT_EQ(journal.stats().recoveredRecords, 30u);
+  EXPECT_EQ(journal.stats().tornTails, 0u);
+
+  journal.append(batch(300, 10));
+  EXPECT_EQ(readAll(journal).size(), 310u);
+}
+
+TEST_F(IngestJournalTest, DiscardsATornTail) {
+  JournalPosition kept;
+  {
+    IngestJournal journal(dir_.string(), smallSegments());
+    kept = journal.append(batch(0, 10));
+    journal.append(batch(10, 10));
+  }
+  // Flip a byte in the second record's payload, as a crash mid-copy would
+  // leave it
+  const auto path = (dir_ / "00000000000000000001.journal").string();
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(kept.offset + 20));
+    file.put('\x7f');
+  }
+
+  IngestJournal journal(dir_.string(), smallSegments());
+  EXPECT_EQ(journal.end(), kept);
+  EXPECT_EQ(journal.stats().recoveredRecords, 1u);
+  EXPECT_EQ(journal.stats().tornTails, 1u);
+
+  // A shorter record over the torn one leaves no trace of it
+  journal.append(batch(100, 1));
+  IngestJournal reopened(dir_.string(), smallSegments());
+  EXPECT_EQ(reopened.stats().tornTails, 0u);
+  EXPECT_EQ(readAll(reopened).size(), 11u);
+}
+
+TEST_F(IngestJournalTest, RejectsForeignSegments) {
+  std::filesystem::create_directories(dir_);
+  std::ofstream(dir_ / "00000000000000000001.journal")
+      << std::string(4096, 'x');
+  EXPECT_THROW(IngestJournal(dir_.string(), smallSegments()),
+               IngestJournalException);
+}
+
+// ============================================================
+// Applier
+// ============================================================
+TEST_F(IngestJournalTest, ApplierStoresPointsAndReleasesSegments) {
+  IngestJournal journal(dir_.string(), smallSegments());
+  for (int64_t i = 0; i < 50; ++i) {
+    journal.append(batch(i * 10, 10));
+  }
+  JournalApplierOptions options;
+  options.batchPoints = 100;
+  IngestJournalApplier applier(*db_, *repo_, journal, options);
+  applier.initSchema();
+
+  EXPECT_EQ(applier.applyPending(), 500u);
+  EXPECT_EQ(storedPoints(), 500u);
+  EXPECT_EQ(applier.checkpoint(), journal.end());
+  EXPECT_EQ(applier.applyPending(), 0u);
+
+  auto stats = applier.stats();
+  EXPECT_EQ(stats.points, 500u);
+  EXPECT_GE(stats.batches, 5u);
+  EXPECT_GT(stats.segmentsReleased, 0u);
+  EXPECT_EQ(segmentFiles(), 1u);
+  EXPECT_EQ(journal.begin().segment, journal.end().segment);
+}
+
+TEST_F(IngestJournalTest, ApplierResumesFromItsCheckpointAfterACrash) {
+  {
+    IngestJournal journal(dir_.string(), smallSegments());
+    journal.append(batch(0, 100));
+    IngestJournalApplier applier(*db_, *repo_, journal);
+    applier.initSchema();
+    EXPECT_EQ(applier.applyPending(), 100u);
+    journal.append(batch(100, 50));  // acknowledged, never applied
+  }
+
+  IngestJournal journal(dir_.string(), smallSegments());
+  IngestJournalApplier applier(*db_, *repo_, journal);
+  applier.initSchema();
+  EXPECT_EQ(applier.applyPending(), 50u);
+  EXPECT_EQ(storedPoints(), 150u);
+}
+
+TEST_F(IngestJournalTest, ApplierRejectsACheckpointOutsideTheJournal) {
+  {
+    IngestJournal journal(dir_.string(), smallSegments());
+    journal.append(batch(0, 100));
+    IngestJournalApplier applier(*db_, *repo_, journal);
+    applier.initSchema();
+    applier.applyPending();
+  }
+  std::filesystem::remove_all(dir_);
+
+  IngestJournal journal(dir_.string(), smallSegments());
+  IngestJournalApplier applier(*db_, *repo_, journal);
+  EXPECT_THROW(applier.checkpoint(), IngestJournalException);
+}
+
+TEST_F(IngestJournalTest, FailedBatchLeavesTheCheckpoint) {
+  IngestJournal journal(dir_.string(), smallSegments());
+  journal.append(batch(0, 10));
+  journal.append({"missing", 0, "u1", 1.0});  // unknown asset
+  IngestJournalApplier applier(*db_, *repo_, journal);
+  applier.initSchema();
+
+  const JournalPosition start = applier.checkpoint();
+  EXPECT_ANY_THROW(applier.applyPending());
+  EXPECT_EQ(applier.checkpoint(), start);
+  EXPECT_EQ(storedPoints(), 0u);
+}
+
+TEST_F(IngestJournalTest, FailedCheckpointLeavesNoCachedPoints) {
+  repo_->addPoint({"a1", 0, "u1", 1.0});
+  ASSERT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 0);
+
+  IngestJournal journal(dir_.string(), smallSegments());
+  journal.append(batch(10, 4));
+  IngestJournalApplier applier(*db_, *repo_, journal);
+  applier.initSchema();
+  db_->execute(
+      "CREATE TRIGGER fail_checkpoint BEFORE INSERT ON "
+      "ingest_journal_checkpoints BEGIN SELECT RAISE(ABORT, 'full'); END");
+
+  EXPECT_ANY_THROW(applier.applyPending());
+  auto latest = repo_->getLatestPoint("a1", "u1");
+  ASSERT_TRUE(latest.has_value());
+  EXPECT_EQ(latest->timestamp_ms, 0);
+  EXPECT_EQ(storedPoints(), 1u);
+
+  db_->execute("DROP TRIGGER fail_checkpoint");
+  EXPECT_EQ(applier.applyPending(), 4u);
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 12000);
+}
+
+TEST_F(IngestJournalTest, BackgroundApplierFlushes) {
+  IngestJournal journal(dir_.string(), smallSegments(JournalSync::Periodic));
+  JournalApplierOptions options;
+  options.pollInterval = std::chrono::milliseconds(1);
+  options.batchPoints = 64;
+  IngestJournalApplier applier(*db_, *repo_, journal, options);
+  applier.initSchema();
+
+  applier.start();
+  EXPECT_TRUE(applier.isRunning());
+  for (int64_t i = 0; i < 20; ++i) {
+    journal.append(batch(i * 10, 10));
+  }
+  applier.flush();
+  EXPECT_EQ(applier.stats().points, 200u);
+  applier.stop();
+  EXPECT_FALSE(applier.isRunning());
+  EXPECT_EQ(storedPoints(), 200u);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,55 @@
+#include "keyvalue_http_cache_store.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+class KeyValueHttpCacheStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    repo_ = std::make_unique<KeyValueRepository>(*db_);
+    repo_->initSchema();
+    store_ = std::make_unique<KeyValueHttpCacheStore>(*repo_);
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<KeyValueRepository> repo_;
+  std::unique_ptr<KeyValueHttpCacheStore> store_;
+};
+
+TEST_F(KeyValueHttpCacheStoreTest, SaveLoadRemove) {
+  const std::string key = "https://host/path?a=1&b=2";
+  EXPECT_FALSE(store_->load(key).has_value());
+
+  store_->save(key, "4:body");
+  EXPECT_EQ(store_->load(key), "4:body");
+  EXPECT_EQ(repo_->getValue("http_cache/" + key), "4:body");
+
+  store_->save(key, "5:other");
+  EXPECT_EQ(store_->load(key), "5:other");
+
+  store_->remove(key);
+  EXPECT_FALSE(store_->load(key).has_value());
+}
+
+TEST_F(KeyValueHttpCacheStoreTest, ClearKeepsOtherSettings) {
+  repo_->set("app/setting", "kept");
+  store_->save("u1", "a");
+  store_->save("u2", "b");
+
+  store_->clear();
+
+  EXPECT_FALSE(store_->load("u1").has_value());
+  EXPECT_FALSE(store_->load("u2").has_value());
+  EXPECT_EQ(repo_->getValue("app/setting"), "kept");
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
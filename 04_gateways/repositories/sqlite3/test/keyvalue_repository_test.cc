@@ -2,9 +2,12 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "prefix_range.h"
 #include "sqlite3_database_connector.h"
 
 namespace Gateways::Repositories::Sqlite3 {
@@ -209,6 +212,92 @@ TEST_F(KeyValueRepositoryTest, Clear) {
   EXPECT_EQ(repo_->count(), 0);
 }
 
+TEST_F(KeyValueRepositoryTest, PrefixesAreLiteral) {
+  repo_->set("100%.done", "1");
+  repo_->set("100x.done", "2");
+  repo_->set("a_b", "3");
+  repo_->set("aXb", "4");
+  repo_->set("UI.theme", "5");
+
+  EXPECT_EQ(repo_->getKeysByPrefix("100%"),
+            (std::vector<std::string>{"100%.done"}));
+  EXPECT_EQ(repo_->countByPrefix("a_"), 1);
+  EXPECT_TRUE(repo_->getByPrefix("ui.").empty());
+
+  repo_->removeByPrefix("a_");
+  EXPECT_TRUE(repo_->exists("aXb"));
+  EXPECT_FALSE(repo_->exists("a_b"));
+}
+
+TEST_F(KeyValueRepositoryTest, PrefixRangeEdges) {
+  const std::string high = "k\xff";
+  repo_->set(high, "1");
+  repo_->set(high + "\xff", "2");
+  repo_->set("l", "3");
+
+  EXPECT_EQ(repo_->countByPrefix(high), 2);
+  EXPECT_EQ(repo_->countByPrefix("\xff"), 0);
+  EXPECT_EQ(repo_->countByPrefix(""), 3);
+  EXPECT_EQ(repo_->getKeysByPrefix("").size(), 3u);
+}
+
+TEST_F(KeyValueRepositoryTest, PrefixScanSearchesTheIndex) {
+  auto stmt = db_->prepare(
+      "EXPLAIN QUERY PLAN SELECT COUNT(*) FROM settings WHERE " +
+      prefixCondition(prefixRange("ui."), "key"));
+  std::string plan;
+  for (const auto& row : stmt->rows()) {
+    plan += std::string(row.getText(3));
+  }
+  EXPECT_NE(plan.find("SEARCH"), std::string::npos) << plan;
+}
+
+// ============================================================
+// Batches
+// ============================================================
+TEST_F(KeyValueRepositoryTest, GetManyLeavesOutAbsentKeys) {
+  repo_->set("a", "1", "first");
+  repo_->set("b", "2");
+  repo_->set("c", "3");
+
+  auto settings = repo_->getMany({"c", "missing", "a", "c"});
+  ASSERT_EQ(settings.size(), 2u);
+  EXPECT_EQ(settings.at("a").value, "1");
+  EXPECT_EQ(*settings.at("a").description, "first");
+  EXPECT_EQ(settings.at("c").value, "3");
+  EXPECT_FALSE(settings.at("c").description.has_value());
+
+  EXPECT_TRUE(repo_->getMany({}).empty());
+}
+
+TEST_F(KeyValueRepositoryTest, SetManyWritesAll) {
+  repo_->set("keep", "old");
+  repo_->set("replace", "old");
+
+  repo_->setMany({{"replace", "new", "Replaced"},
+                  {"added", "1", std::nullopt},
+                  {"added", "2", std::nullopt}});
+
+  EXPECT_EQ(repo_->count(), 3);
+  EXPECT_EQ(repo_->getValue("keep"), "old");
+  EXPECT_EQ(*repo_->get("replace")->description, "Replaced");
+  EXPECT_EQ(repo_->getValue("added"), "2");
+  EXPECT_NO_THROW(repo_->setMany({}));
+}
+
+TEST_F(KeyValueRepositoryTest, SetManyIsAtomic) {
+  db_->execute(
+      "CREATE TRIGGER reject BEFORE INSERT ON settings "
+      "WHEN NEW.key = 'bad' BEGIN SELECT RAISE(ABORT, 'rejected'); END");
+  repo_->set("a", "old");
+
+  EXPECT_THROW(
+      repo_->setMany({{"a", "new", std::nullopt}, {"bad", "x", std::nullopt}}),
+      Gateways::Database::DatabaseException);
+  EXPECT_EQ(repo_->getValue("a"), "old");
+  EXPECT_EQ(repo_->count(), 1);
+}
+
 // ============================================================
 // Count
 // ============================================================
@@ -305,5 +394,188 @@ TEST_F(KeyValueRepositoryTest, AssetSourceMapping) {
   EXPECT_EQ(*source, "yahoo");
 }
 
+// ============================================================
+// Read-Through Cache
+// ============================================================
+class CachedKeyValueRepositoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    KeyValueOptions options;
+    options.cache = true;
+    options.cacheShards = 4;
+    repo_ = std::make_unique<KeyValueRepository>(*db_, options);
+    repo_->initSchema();
+  }
+
+  // Bypasses the repository, so only a cache miss can see it
+  void setDirectly(const std::string& key, const std::string& value) {
+    auto stmt = db_->prepare(
+        "INSERT OR REPLACE INTO settings (key, value) VALUES (?, ?)");
+    stmt->bind(1, key).bind(2, value);
+    stmt->executeInsert();
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<KeyValueRepository> repo_;
+};
+
+TEST_F(CachedKeyValueRepositoryTest, ServesRepeatReadsFromCache) {
+  repo_->set("ui.theme", "dark", "Theme");
+
+  EXPECT_EQ(repo_->get("ui.theme")->value, "dark");
+  setDirectly("ui.theme", "light");
+  EXPECT_EQ(repo_->getValue("ui.theme"), "dark");
+  EXPECT_TRUE(repo_->exists("ui.theme"));
+  EXPECT_EQ(*repo_->get("ui.theme")->description, "Theme");
+
+  auto stats = repo_->cacheStats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 3u);
+  EXPECT_EQ(stats.entries, 1u);
+  EXPECT_DOUBLE_EQ(stats.hitRate(), 0.75);
+
+  repo_->invalidateCache();
+  EXPECT_EQ(repo_->getValue("ui.theme"), "light");
+}
+
+TEST_F(CachedKeyValueRepositoryTest, CachesAbsentKeys) {
+  EXPECT_FALSE(repo_->exists("missing"));
+  EXPECT_FALSE(repo_->get("missing").has_value());
+  EXPECT_FALSE(repo_->getValue("missing").has_value());
+
+  auto stats = repo_->cacheStats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.negativeHits, 2u);
+
+  repo_->set("missing", "found");
+  EXPECT_EQ(repo_->getValue("missing"), "found");
+}
+
+TEST_F(CachedKeyValueRepositoryTest, WritesInvalidate) {
+  repo_->set("a.1", "x");
+  repo_->set("a.2", "x");
+  repo_->set("b.1", "x");
+  for (const char* key : {"a.1", "a.2", "b.1"}) {
+    repo_->get(key);
+  }
+
+  repo_->set("a.1", "y");
+  EXPECT_EQ(repo_->getValue("a.1"), "y");
+
+  repo_->remove("a.2");
+  EXPECT_FALSE(repo_->exists("a.2"));
+
+  repo_->set("a.2", "z");
+  repo_->get("a.2");
+  repo_->removeByPrefix("a.");
+  EXPECT_FALSE(repo_->exists("a.1"));
+  EXPECT_FALSE(repo_->exists("a.2"));
+  EXPECT_TRUE(repo_->exists("b.1"));
+
+  repo_->clear();
+  EXPECT_FALSE(repo_->exists("b.1"));
+}
+
+TEST_F(CachedKeyValueRepositoryTest, PrefixInvalidationIsLiteral) {
+  repo_->set("App.x", "1");
+  repo_->set("a_b.x", "2");
+  repo_->set("aXb.x", "3");
+  for (const char* key : {"App.x", "a_b.x", "aXb.x"}) {
+    repo_->get(key);
+  }
+
+  repo_->removeByPrefix("app");
+  repo_->removeByPrefix("a_b");
+  EXPECT_TRUE(repo_->exists("App.x"));
+  EXPECT_FALSE(repo_->exists("a_b.x"));
+  EXPECT_TRUE(repo_->exists("aXb.x"));
+  EXPECT_EQ(repo_->count(), 2);
+}
+
+TEST_F(CachedKeyValueRepositoryTest, CapacityBoundsEntries) {
+  KeyValueOptions options;
+  options.cache = true;
+  options.cacheShards = 2;
+  options.cacheCapacity = 4;
+  KeyValueRepository small(*db_, options);
+  for (int i = 0; i < 20; ++i) {
+    small.set("k" + std::to_string(i), "v");
+    small.get("k" + std::to_string(i));
+  }
+  EXPECT_LE(small.cacheStats().entries, 4u);
+  EXPECT_EQ(small.getValue("k0"), "v");
+}
+
+TEST_F(CachedKeyValueRepositoryTest, SharedAcrossThreads) {
+  for (int i = 0; i < 16; ++i) {
+    repo_->set("k" + std::to_string(i), std::to_string(i));
+    repo_->get("k" + std::to_string(i));
+  }
+
+  std::vector<std::thread> readers;
+  std::atomic<int> wrong{0};
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&] {
+      for (int n = 0; n < 1000; ++n) {
+        const int i = n % 16;
+        if (repo_->getValue("k" + std::to_string(i)) != std::to_string(i)) {
+          ++wrong;
+        }
+      }
+    });
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(wrong.load(), 0);
+  EXPECT_EQ(repo_->cacheStats().misses, 16u);
+  EXPECT_EQ(repo_->cacheStats().hits, 4000u);
+}
+
+TEST_F(CachedKeyValueRepositoryTest, GetManyFetchesOnlyMisses) {
+  repo_->set("a", "1");
+  repo_->set("b", "2");
+  repo_->get("a");
+  repo_->get("absent");
+
+  setDirectly("a", "changed");
+  auto settings = repo_->getMany({"a", "b", "absent", "other"});
+  ASSERT_EQ(settings.size(), 2u);
+  EXPECT_EQ(settings.at("a").value, "1");
+  EXPECT_EQ(settings.at("b").value, "2");
+
+  auto stats = repo_->cacheStats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 4u);
+  EXPECT_EQ(stats.entries, 4u);
+
+  // The misses were filled, absent ones included
+  setDirectly("b", "changed");
+  setDirectly("other", "added");
+  EXPECT_EQ(repo_->getValue("b"), "2");
+  EXPECT_FALSE(repo_->exists("other"));
+}
+
+TEST_F(CachedKeyValueRepositoryTest, SetManyInvalidates) {
+  repo_->set("a", "1");
+  repo_->get("a");
+  repo_->get("b");
+
+  repo_->setMany({{"a", "2", std::nullopt}, {"b", "3", std::nullopt}});
+  EXPECT_EQ(repo_->getValue("a"), "2");
+  EXPECT_EQ(repo_->getValue("b"), "3");
+}
+
+TEST_F(KeyValueRepositoryTest, CacheOffByDefault) {
+  repo_->set("key1", "value1");
+  repo_->get("key1");
+  repo_->get("key1");
+
+  auto stats = repo_->cacheStats();
+  EXPECT_EQ(stats.hits + stats.misses, 0u);
+  EXPECT_DOUBLE_EQ(stats.hitRate(), 0.0);
+}
+
 }  // namespace
 }  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,240 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "latest_quote_publisher.h"
+#include "latest_quote_table.h"
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class LatestQuoteTableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    repo_ = std::make_unique<TimeSeriesRepository>(*db_);
+    repo_->initSchema();
+    repo_->createAsset({"a1", "Asset 1", "", ""});
+    repo_->createAsset({"a2", "Asset 2", "", ""});
+    repo_->createAsset({"a3", "Asset 3", "", ""});
+    repo_->createUnit({"USD", "USD", "USD"});
+    repo_->createUnit({"EUR", "EUR", "EUR"});
+    name_ = "/cppref_quotes_test_" + std::to_string(::getpid()) + "_" +
+            std::to_string(reinterpret_cast<uintptr_t>(this));
+  }
+
+  void TearDown() override { ::shm_unlink(name_.c_str()); }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+  std::string name_;
+};
+
+// ============================================================
+// Publishing
+// ============================================================
+TEST_F(LatestQuoteTableTest, PublishesTheLatestPointOfEachAsset) {
+  repo_->addPoints({{"a1", 100, "USD", 1.0},
+                    {"a1", 200, "EUR", 2.0},
+                    {"a2", 50, "USD", 3.0}});
+  LatestQuotePublisher publisher(*repo_, name_);
+  LatestQuoteReader reader(name_);
+  EXPECT_EQ(reader.capacity(), 4096u);
+  EXPECT_EQ(reader.assets(), 2u);
+  EXPECT_FALSE(reader.closed());
+
+  LatestQuote quote;
+  ASSERT_TRUE(reader.lookup("a1", quote));
+  EXPECT_EQ(quote.timestamp_ms, 200);
+  EXPECT_DOUBLE_EQ(quote.value, 2.0);
+  EXPECT_EQ(quote.unit_id, "EUR");
+  EXPECT_FALSE(reader.lookup("a3", quote));  // no points
+  EXPECT_FALSE(reader.lookup("zz", quote));
+  EXPECT_FALSE(reader.lookup(std::string(100, 'x'), quote));
+
+  // Newer and equally new points replace the quote; older ones do not
+  ASSERT_TRUE(reader.lookup("a2", quote));
+  const uint64_t version = quote.version;
+  repo_->addPoints({{"a2", 60, "EUR", 4.0}, {"a2", 55, "USD", 5.0}});
+  ASSERT_TRUE(reader.lookup("a2", quote));
+  EXPECT_EQ(quote.timestamp_ms, 60);
+  EXPECT_EQ(quote.unit_id, "EUR");
+  EXPECT_GT(quote.version, version);
+  repo_->addPoint({"a2", 60, "USD", 6.0});
+  ASSERT_TRUE(reader.lookup("a2", quote));
+  EXPECT_DOUBLE_EQ(quote.value, 6.0);
+  EXPECT_EQ(quote.unit_id, "USD");
+
+  repo_->addPoint({"a3", 10, "USD", 7.0});
+  EXPECT_TRUE(reader.lookup("a3", quote));
+  EXPECT_EQ(reader.assets(), 3u);
+  auto stats = publisher.stats();
+  EXPECT_EQ(stats.assets, 3u);
+  EXPECT_EQ(stats.published, 5u);  // 2 loaded, 60, 60 again, a3
+  EXPECT_EQ(stats.rejected, 0u);
+}
+
+TEST_F(LatestQuoteTableTest, ReloadClearsDeletedPoints) {
+  repo_->addPoints({{"a1", 100, "USD", 1.0}, {"a2", 100, "USD", 2.0}});
+  LatestQuotePublisher publisher(*repo_, name_);
+  LatestQuoteReader reader(name_);
+  LatestQuote quote;
+
+  // Deletes reach the table through reload()
+  repo_->deletePoints("a2", 0, 1000);
+  repo_->addPoint({"a1", 50, "USD", 3.0});
+  repo_->deletePoints("a1", 100, 100);
+  EXPECT_TRUE(reader.lookup("a2", quote));
+  publisher.reload();
+  EXPECT_FALSE(reader.lookup("a2", quote));
+  ASSERT_TRUE(reader.lookup("a1", quote));
+  EXPECT_EQ(quote.timestamp_ms, 50);
+
+  repo_->addPoint({"a2", 10, "EUR", 4.0});
+  ASSERT_TRUE(reader.lookup("a2", quote));
+  EXPECT_EQ(quote.unit_id, "EUR");
+  EXPECT_EQ(reader.assets(), 2u);
+}
+
+TEST_F(LatestQuoteTableTest, RejectsLongIdsAndAFullTable) {
+  LatestQuoteOptions options;
+  options.capacity = 3;  // 4 slots, 3 assets
+  LatestQuotePublisher publisher(*repo_, name_, options);
+  EXPECT_EQ(publisher.capacity(), 4u);
+
+  const std::string long_id(kQuoteMaxAssetIdBytes + 1, 'x');
+  const std::string longest_id(kQuoteMaxAssetIdBytes, 'y');
+  repo_->createAsset({long_id, "Long", "", ""});
+  repo_->createAsset({longest_id, "Longest", "", ""});
+  repo_->addPoints({{long_id, 1, "USD", 1.0},
+                    {longest_id, 1, "USD", 2.0},
+                    {"a1", 1, "USD", 3.0},
+                    {"a2", 1, "USD", 4.0},
+                    {"a3", 1, "USD", 5.0}});
+
+  LatestQuoteReader reader(name_);
+  LatestQuote quote;
+  ASSERT_TRUE(reader.lookup(longest_id, quote));
+  EXPECT_DOUBLE_EQ(quote.value, 2.0);
+  EXPECT_TRUE(reader.lookup("a1", quote));
+  EXPECT_TRUE(reader.lookup("a2", quote));
+  EXPECT_FALSE(reader.lookup("a3", quote));
+  auto stats = publisher.stats();
+  EXPECT_EQ(stats.assets, 3u);
+  EXPECT_EQ(stats.rejected, 2u);
+}
+
+// ============================================================
+// Readers
+// ============================================================
+TEST_F(LatestQuoteTableTest, ReaderRejectsMissingAndForeignObjects) {
+  EXPECT_THROW(LatestQuoteReader reader(name_), LatestQuoteException);
+
+  const int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT, 0600);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(::ftruncate(fd, 4096), 0);
+  void* data = ::mmap(nullptr, 4096, PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  ASSERT_NE(data, MAP_FAILED);
+  EXPECT_THROW(LatestQuoteReader reader(name_), LatestQuoteException);
+  static_cast<uint64_t*>(data)[4] = 1;  // state Open, no magic
+  EXPECT_THROW(LatestQuoteReader reader(name_), LatestQuoteException);
+  ::munmap(data, 4096);
+}
+
+TEST_F(LatestQuoteTableTest, ReplacingAPublisherClosesTheOldTable) {
+  repo_->addPoint({"a1", 100, "USD", 1.0});
+  auto first = std::make_unique<LatestQuotePublisher>(*repo_, name_);
+  LatestQuoteReader old_reader(name_);
+  auto second = std::make_unique<LatestQuotePublisher>(*repo_, name_);
+  EXPECT_TRUE(old_reader.closed());
+
+  // The first one leaves its successor's name alone
+  first.reset();
+  LatestQuoteReader reader(name_);
+  EXPECT_FALSE(reader.closed());
+  repo_->addPoint({"a1", 200, "USD", 2.0});
+  LatestQuote quote;
+  ASSERT_TRUE(reader.lookup("a1", quote));
+  EXPECT_EQ(quote.timestamp_ms, 200);
+  ASSERT_TRUE(old_reader.lookup("a1", quote));
+  EXPECT_EQ(quote.timestamp_ms, 100);
+
+  second.reset();
+  EXPECT_TRUE(reader.closed());
+  EXPECT_THROW(LatestQuoteReader gone(name_), LatestQuoteException);
+}
+
+TEST_F(LatestQuoteTableTest, ReadersNeverSeeTornQuotes) {
+  LatestQuotePublisher publisher(*repo_, name_);
+  LatestQuoteReader reader(name_);
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+  std::atomic<int> hits{0};
+
+  std::thread poller([&] {
+    LatestQuote quote;
+    int64_t last = -1;
+    while (!done.load()) {
+      if (!reader.lookup("a1", quote)) {
+        continue;
+      }
+      // Each point's value and unit follow from its timestamp
+      const bool even = quote.timestamp_ms % 2 == 0;
+      if (quote.value != 2.0 * quote.timestamp_ms ||
+          quote.unit_id != (even ? "USD" : "EUR") ||
+          quote.timestamp_ms < last) {
+        ++torn;
+      }
+      last = quote.timestamp_ms;
+      ++hits;
+    }
+  });
+  for (int64_t ts = 0; ts < 2000; ++ts) {
+    repo_->addPoint({"a1", ts, ts % 2 == 0 ? "USD" : "EUR", 2.0 * ts});
+  }
+  done = true;
+  poller.join();
+  EXPECT_EQ(torn.load(), 0);
+  EXPECT_GT(hits.load(), 0);
+}
+
+TEST_F(LatestQuoteTableTest, WorksAcrossProcesses) {
+  repo_->addPoint({"a1", 100, "USD", 42.0});
+  LatestQuotePublisher publisher(*repo_, name_);
+
+  const pid_t child = ::fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    int code = 1;
+    try {
+      LatestQuoteReader reader(name_);
+      LatestQuote quote;
+      if (reader.lookup("a1", quote) && quote.value == 42.0) {
+        code = 0;
+      }
+    } catch (...) {
+    }
+    ::_exit(code);
+  }
+  int status = 0;
+  ASSERT_EQ(::waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
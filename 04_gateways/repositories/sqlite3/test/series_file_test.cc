@@ -0,0 +1,207 @@
+#include "series_file.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class SeriesFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = std::filesystem::temp_directory_path() /
+            ("test_series_" +
+             std::to_string(reinterpret_cast<uintptr_t>(this)) + ".bin");
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    repo_ = makeRepository(*db_);
+  }
+
+  void TearDown() override { std::filesystem::remove(path_); }
+
+  static std::unique_ptr<TimeSeriesRepository> makeRepository(
+      Gateways::Database::IDatabase& db) {
+    auto repo = std::make_unique<TimeSeriesRepository>(db);
+    repo->initSchema();
+    repo->createAsset({"a1", "Asset 1", "", ""});
+    repo->createAsset({"a2", "Asset 2", "", ""});
+    repo->createUnit({"u1", "X", "Unit X"});
+    repo->createUnit({"u2", "Y", "Unit Y"});
+    return repo;
+  }
+
+  // a1/u1 and a1/u2 over 100 seconds, a2/u1 over 10
+  void addPoints() {
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (int64_t i = 0; i < 100; ++i) {
+      points.push_back({"a1", i * 1000, "u1", i * 0.5});
+      points.push_back({"a1", i * 1000, "u2", -i * 0.5});
+    }
+    for (int64_t i = 0; i < 10; ++i) {
+      points.push_back({"a2", i * 1000, "u1", 100.0 + i});
+    }
+    repo_->addPoints(points);
+  }
+
+  void corrupt(size_t offset, const void* bytes, size_t size) {
+    std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(static_cast<const char*>(bytes),
+               static_cast<std::streamsize>(size));
+  }
+
+  std::filesystem::path path_;
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+// ============================================================
+// Export and Mapped Reads
+// ============================================================
+TEST_F(SeriesFileTest, ExportWritesOneSeriesPerUnit) {
+  addPoints();
+
+  auto stats =
+      exportSeries(*repo_, path_.string(), {"a2", "a1", "missing"}, 0, 49000);
+  EXPECT_EQ(stats.series, 3u);
+  EXPECT_EQ(stats.points, 110u);
+
+  MappedSeriesFile file(path_.string());
+  EXPECT_EQ(file.header().version, kSeriesFileVersion);
+  EXPECT_EQ(file.header().file_size, std::filesystem::file_size(path_));
+  ASSERT_EQ(file.seriesCount(), 3u);
+
+  // Index is sorted by ids whatever the export order
+  EXPECT_EQ(file.series(0).asset_id, "a1");
+  EXPECT_EQ(file.series(0).unit_id, "u1");
+  EXPECT_EQ(file.series(1).unit_id, "u2");
+  EXPECT_EQ(file.series(2).asset_id, "a2");
+
+  auto view = file.series(1);
+  ASSERT_EQ(view.count, 50u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(view.timestamps) % 8, 0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(view.values) % 8, 0u);
+  EXPECT_EQ(view.timestamps[0], 0);
+  EXPECT_EQ(view.timestamps[49], 49000);
+  EXPECT_DOUBLE_EQ(view.values[49], -24.5);
+}
+
+TEST_F(SeriesFileTest, FindUsesTheIndex) {
+  addPoints();
+  exportSeries(*repo_, path_.string(), {"a1", "a2"}, 0, 100000);
+
+  MappedSeriesFile file(path_.string());
+  auto view = file.find("a2", "u1");
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->count, 10u);
+  EXPECT_DOUBLE_EQ(view->values[9], 109.0);
+  EXPECT_FALSE(file.find("a2", "u2").has_value());
+  EXPECT_FALSE(file.find("a0", "u1").has_value());
+  EXPECT_THROW(file.series(3), std::out_of_range);
+}
+
+TEST_F(SeriesFileTest, EmptyExport) {
+  exportSeries(*repo_, path_.string(), {"a1"}, 0, 100000);
+
+  MappedSeriesFile file(path_.string());
+  EXPECT_EQ(file.seriesCount(), 0u);
+  EXPECT_EQ(file.header().file_size, sizeof(SeriesFileHeader));
+}
+
+TEST_F(SeriesFileTest, MovedFileKeepsMapping) {
+  addPoints();
+  exportSeries(*repo_, path_.string(), {"a2"}, 0, 100000);
+
+  MappedSeriesFile file(path_.string());
+  const int64_t* timestamps = file.series(0).timestamps;
+  MappedSeriesFile moved(std::move(file));
+  EXPECT_EQ(moved.series(0).timestamps, timestamps);
+  EXPECT_EQ(moved.series(0).timestamps[5], 5000);
+}
+
+// ============================================================
+// Import
+// ============================================================
+TEST_F(SeriesFileTest, ImportRoundTrips) {
+  addPoints();
+  exportSeries(*repo_, path_.string(), {"a1", "a2"}, 0, 100000);
+
+  Gateways::Database::SqliteDatabase target_db(":memory:");
+  auto target = makeRepository(target_db);
+  auto stats = importSeries(*target, path_.string(), 64);
+  EXPECT_EQ(stats.series, 3u);
+  EXPECT_EQ(stats.points, 210u);
+
+  for (const char* asset_id : {"a1", "a2"}) {
+    auto expected = repo_->getPoints(asset_id, 0, 100000);
+    auto actual = target->getPoints(asset_id, 0, 100000);
+    ASSERT_EQ(actual.size(), expected.size()) << asset_id;
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(actual[i].timestamp_ms, expected[i].timestamp_ms);
+      EXPECT_EQ(actual[i].unit_id, expected[i].unit_id);
+      EXPECT_DOUBLE_EQ(actual[i].value, expected[i].value);
+    }
+  }
+  EXPECT_EQ(target->getLatestPoint("a1", "u2")->timestamp_ms, 99000);
+
+  EXPECT_THROW(importSeries(*target, path_.string(), 0),
+               std::invalid_argument);
+}
+
+// ============================================================
+// Writer and Validation
+// ============================================================
+TEST_F(SeriesFileTest, WriterRejectsBadSeries) {
+  SeriesFileWriter writer(path_.string());
+  writer.add("a1", "u1", {1, 2}, {1.0, 2.0});
+
+  EXPECT_THROW(writer.add("a1", "u1", {3}, {3.0}), std::invalid_argument);
+  EXPECT_THROW(writer.add("a1", "u2", {3}, {}), std::invalid_argument);
+  writer.finish();
+  EXPECT_THROW(writer.add("a2", "u1", {}, {}), std::logic_error);
+}
+
+TEST_F(SeriesFileTest, UnfinishedFileIsRejected) {
+  {
+    SeriesFileWriter writer(path_.string());
+    writer.add("a1", "u1", {1, 2}, {1.0, 2.0});
+  }
+  EXPECT_THROW(MappedSeriesFile(path_.string()), SeriesFileException);
+}
+
+TEST_F(SeriesFileTest, MalformedFilesAreRejected) {
+  EXPECT_THROW(MappedSeriesFile(path_.string()), SeriesFileException);
+
+  addPoints();
+  exportSeries(*repo_, path_.string(), {"a2"}, 0, 100000);
+  EXPECT_NO_THROW(MappedSeriesFile(path_.string()));
+
+  // Point count past the end of the file
+  const uint64_t huge = uint64_t{1} << 60;
+  const auto index_offset = MappedSeriesFile(path_.string())
+                                .header()
+                                .index_offset;
+  corrupt(index_offset + offsetof(SeriesFileEntry, point_count), &huge,
+          sizeof(huge));
+  EXPECT_THROW(MappedSeriesFile(path_.string()), SeriesFileException);
+
+  const uint32_t version = 99;
+  corrupt(offsetof(SeriesFileHeader, version), &version, sizeof(version));
+  EXPECT_THROW(MappedSeriesFile(path_.string()), SeriesFileException);
+
+  std::filesystem::resize_file(path_, 100);
+  EXPECT_THROW(MappedSeriesFile(path_.string()), SeriesFileException);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
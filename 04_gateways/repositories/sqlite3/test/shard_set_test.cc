@@ -0,0 +1,156 @@
+#include "shard_set.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class ShardSetTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() /
+           ("test_shards_" + std::to_string(reinterpret_cast<uintptr_t>(this)));
+    std::filesystem::remove_all(dir_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  std::unique_ptr<ShardSet> open(size_t shards) {
+    ShardSetOptions options;
+    options.shards = shards;
+    return std::make_unique<ShardSet>(dir_.string(), options);
+  }
+
+  std::filesystem::path dir_;
+};
+
+// ============================================================
+// Layout and Routing
+// ============================================================
+TEST_F(ShardSetTest, OpensOneFilePerShard) {
+  auto shards = open(3);
+  EXPECT_EQ(shards->size(), 3u);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(std::filesystem::exists(shards->path(i)));
+  }
+}
+
+TEST_F(ShardSetTest, RejectsZeroShards) {
+  EXPECT_THROW(open(0), std::invalid_argument);
+}
+
+TEST_F(ShardSetTest, ReopeningWithAnotherCountThrows) {
+  open(3).reset();
+  EXPECT_NO_THROW(open(3));
+  EXPECT_THROW(open(2), ShardException);
+}
+
+TEST_F(ShardSetTest, RoutingIsStableAndSpread) {
+  auto shards = open(4);
+  std::set<size_t> used;
+  for (int i = 0; i < 100; ++i) {
+    const std::string key = "asset-" + std::to_string(i);
+    const size_t s = shards->shardOf(key);
+    ASSERT_LT(s, 4u);
+    EXPECT_EQ(shards->shardOf(key), s);
+    used.insert(s);
+  }
+  EXPECT_EQ(used.size(), 4u);
+
+  const size_t before = shards->shardOf("asset-7");
+  shards.reset();
+  EXPECT_EQ(open(4)->shardOf("asset-7"), before);
+}
+
+TEST_F(ShardSetTest, PartitionKeepsKeyOrderPerShard) {
+  auto shards = open(3);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 20; ++i) {
+    keys.push_back("k" + std::to_string(i));
+  }
+  auto groups = shards->partition(keys);
+  ASSERT_EQ(groups.size(), 3u);
+  size_t total = 0;
+  for (size_t s = 0; s < groups.size(); ++s) {
+    for (size_t j = 0; j < groups[s].size(); ++j) {
+      EXPECT_EQ(shards->shardOf(keys[groups[s][j]]), s);
+      if (j > 0) {
+        EXPECT_LT(groups[s][j - 1], groups[s][j]);
+      }
+    }
+    total += groups[s].size();
+  }
+  EXPECT_EQ(total, keys.size());
+}
+
+// ============================================================
+// Fan-out
+// ============================================================
+TEST_F(ShardSetTest, ForEachVisitsEveryShardOnce) {
+  auto shards = open(4);
+  std::vector<std::atomic<int>> calls(4);
+  shards->forEach([&](size_t i) { ++calls[i]; });
+  for (auto& count : calls) {
+    EXPECT_EQ(count.load(), 1);
+  }
+  EXPECT_THROW(shards->forEach([](size_t i) {
+    if (i == 2) {
+      throw std::runtime_error("shard 2");
+    }
+  }),
+               std::runtime_error);
+}
+
+TEST_F(ShardSetTest, ScatterPutsResultsBackInKeyOrder) {
+  auto shards = open(3);
+  std::vector<std::string> keys = {"x", "y", "z", "w", "v", "u"};
+  auto result = shards->scatter<std::string>(
+      keys, [&](size_t s, const std::vector<std::string>& shard_keys) {
+        std::vector<std::string> values;
+        for (const auto& key : shard_keys) {
+          values.push_back(key + "@" + std::to_string(s));
+        }
+        return values;
+      });
+  ASSERT_EQ(result.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(result[i],
+              keys[i] + "@" + std::to_string(shards->shardOf(keys[i])));
+  }
+}
+
+// ============================================================
+// ATTACH
+// ============================================================
+TEST_F(ShardSetTest, AttachQueriesEveryShardFile) {
+  auto shards = open(3);
+  Gateways::Database::SqliteDatabase db(":memory:");
+  shards->attach(db);
+
+  auto sum = db.prepare(
+                   "SELECT SUM(shard), COUNT(*) FROM ("
+                   "SELECT shard FROM shard_0.shard_layout UNION ALL "
+                   "SELECT shard FROM shard_1.shard_layout UNION ALL "
+                   "SELECT shard FROM shard_2.shard_layout)")
+                 ->fetchOne<int64_t, int64_t>();
+  ASSERT_TRUE(sum.has_value());
+  EXPECT_EQ(std::get<0>(*sum), 0 + 1 + 2);
+  EXPECT_EQ(std::get<1>(*sum), 3);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
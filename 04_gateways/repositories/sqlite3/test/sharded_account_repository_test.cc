@@ -0,0 +1,221 @@
+#include "sharded_account_repository.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class ShardedAccountRepositoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() /
+           ("test_sharded_acc_" +
+            std::to_string(reinterpret_cast<uintptr_t>(this)));
+    std::filesystem::remove_all(dir_);
+    ShardSetOptions options;
+    options.shards = 4;
+    shards_ = std::make_unique<ShardSet>(dir_.string(), options);
+    repo_ = std::make_unique<ShardedAccountRepository>(*shards_);
+    repo_->initSchema();
+  }
+
+  void TearDown() override {
+    repo_.reset();
+    shards_.reset();
+    std::filesystem::remove_all(dir_);
+  }
+
+  static Entities::Account account(const std::string& id,
+                                   const std::string& name) {
+    return {id, name, std::nullopt, 1704067200000};
+  }
+
+  // An id on another shard than id
+  std::string idElsewhere(const std::string& id) const {
+    for (int i = 0;; ++i) {
+      std::string other = "other-" + std::to_string(i);
+      if (shards_->shardOf(other) != shards_->shardOf(id)) {
+        return other;
+      }
+    }
+  }
+
+  std::filesystem::path dir_;
+  std::unique_ptr<ShardSet> shards_;
+  std::unique_ptr<ShardedAccountRepository> repo_;
+};
+
+// ============================================================
+// Account CRUD
+// ============================================================
+TEST_F(ShardedAccountRepositoryTest, AccountLivesOnItsShard) {
+  repo_->createAccount(account("acc-1", "Alice"));
+  const size_t owner = shards_->shardOf("acc-1");
+  for (size_t s = 0; s < shards_->size(); ++s) {
+    EXPECT_EQ(repo_->shard(s).accountExists("acc-1"), s == owner);
+  }
+  EXPECT_EQ(repo_->getAccount("acc-1")->name, "Alice");
+  EXPECT_EQ(repo_->getAccountByName("Alice")->id, "acc-1");
+  EXPECT_TRUE(repo_->accountExistsByName("Alice"));
+  EXPECT_FALSE(repo_->getAccountByName("Bob").has_value());
+}
+
+TEST_F(ShardedAccountRepositoryTest, NamesAreUniqueAcrossShards) {
+  repo_->createAccount(account("acc-1", "Alice"));
+  const std::string other = idElsewhere("acc-1");
+
+  EXPECT_THROW(repo_->createAccount(account(other, "Alice")),
+               Gateways::Database::ConstraintException);
+  EXPECT_EQ(repo_->tryCreateAccount(account(other, "Alice")),
+            Entities::AccountConflict::Name);
+  EXPECT_EQ(repo_->tryCreateAccount(account("acc-1", "Carol")),
+            Entities::AccountConflict::Id);
+
+  repo_->createAccount(account(other, "Bob"));
+  EXPECT_THROW(repo_->updateAccount(account(other, "Alice")),
+               Gateways::Database::ConstraintException);
+  EXPECT_NO_THROW(repo_->updateAccount(account("acc-1", "Alice")));
+  EXPECT_EQ(repo_->countAccounts(), 2);
+}
+
+TEST_F(ShardedAccountRepositoryTest, ConcurrentCreatesClaimANameOnce) {
+  constexpr int kThreads = 8;
+  std::atomic<int> created{0};
+  std::atomic<int> taken{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      const auto account = this->account("racer-" + std::to_string(t), "Ann");
+      if (t % 2) {
+        try {
+          repo_->createAccount(account);
+          ++created;
+        } catch (const Gateways::Database::ConstraintException&) {
+          ++taken;
+        }
+      } else if (repo_->tryCreateAccount(account) ==
+                 Entities::AccountConflict::None) {
+        ++created;
+      } else {
+        ++taken;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(created.load(), 1);
+  EXPECT_EQ(taken.load(), kThreads - 1);
+  EXPECT_EQ(repo_->countAccounts(), 1);
+}
+
+TEST_F(ShardedAccountRepositoryTest, CreateAccountsChecksWholeBatch) {
+  repo_->createAccount(account("acc-1", "Alice"));
+  std::vector<Entities::Account> batch = {account("b-1", "Bob"),
+                                          account("b-2", "Alice")};
+  EXPECT_EQ(repo_->findAccountConflicts(batch),
+            (std::vector<Entities::AccountConflict>{
+                Entities::AccountConflict::None,
+                Entities::AccountConflict::Name}));
+  EXPECT_THROW(repo_->createAccounts(batch),
+               Gateways::Database::ConstraintException);
+  EXPECT_THROW(repo_->createAccounts({account("c-1", "Carol"),
+                                      account("c-2", "Carol")}),
+               Gateways::Database::ConstraintException);
+  EXPECT_EQ(repo_->countAccounts(), 1);
+
+  std::vector<Entities::Account> accounts;
+  for (int i = 0; i < 40; ++i) {
+    accounts.push_back(account("id-" + std::to_string(i),
+                               "user-" + std::to_string(100 + i)));
+  }
+  repo_->createAccounts(accounts);
+  EXPECT_EQ(repo_->countAccounts(), 41);
+
+  auto found = repo_->getAccounts({"id-7", "missing", "acc-1"});
+  ASSERT_EQ(found.size(), 3u);
+  EXPECT_EQ(found[0]->name, "user-107");
+  EXPECT_FALSE(found[1].has_value());
+  EXPECT_EQ(found[2]->name, "Alice");
+}
+
+// ============================================================
+// Cross-Shard Listing
+// ============================================================
+TEST_F(ShardedAccountRepositoryTest, ListAccountsPagesAcrossShards) {
+  std::vector<Entities::Account> accounts;
+  for (int i = 0; i < 25; ++i) {
+    accounts.push_back(account("id-" + std::to_string(i),
+                               "user-" + std::to_string(100 + i)));
+  }
+  repo_->createAccounts(accounts);
+
+  auto all = repo_->getAllAccounts();
+  ASSERT_EQ(all.size(), 25u);
+  for (size_t i = 1; i < all.size(); ++i) {
+    EXPECT_LT(all[i - 1].name, all[i].name);
+  }
+
+  std::vector<std::string> paged;
+  std::optional<std::string> after;
+  for (;;) {
+    auto page = repo_->listAccounts(after, 7);
+    if (page.empty()) {
+      break;
+    }
+    EXPECT_LE(page.size(), 7u);
+    for (const auto& summary : page) {
+      paged.push_back(summary.name);
+    }
+    after = page.back().name;
+  }
+  ASSERT_EQ(paged.size(), 25u);
+  for (size_t i = 0; i < paged.size(); ++i) {
+    EXPECT_EQ(paged[i], all[i].name);
+  }
+  EXPECT_TRUE(repo_->listAccounts(std::nullopt, 0).empty());
+}
+
+// ============================================================
+// Account Properties
+// ============================================================
+TEST_F(ShardedAccountRepositoryTest, PropertiesFollowTheirAccount) {
+  repo_->createAccount(account("acc-1", "Alice"));
+  const std::string other = idElsewhere("acc-1");
+  repo_->createAccount(account(other, "Bob"));
+  repo_->setProperty("acc-1", "theme", "dark");
+  repo_->setProperty(other, "theme", "light");
+  repo_->setProperty(other, "lang", "en");
+
+  const size_t owner = shards_->shardOf("acc-1");
+  EXPECT_EQ(repo_->shard(owner).getPropertyValue("acc-1", "theme"), "dark");
+  EXPECT_EQ(repo_->countProperties(other), 2);
+
+  auto properties = repo_->getPropertiesForAccounts({other, "acc-1"});
+  ASSERT_EQ(properties.size(), 2u);
+  EXPECT_EQ(properties[0].size(), 2u);
+  ASSERT_EQ(properties[1].size(), 1u);
+  EXPECT_EQ(properties[1][0].value, "dark");
+
+  auto page = repo_->getAccountsWithProperties(std::nullopt, 10);
+  ASSERT_EQ(page.size(), 2u);
+  EXPECT_EQ(page[0].account.name, "Alice");
+  EXPECT_EQ(page[1].account.name, "Bob");
+  EXPECT_EQ(page[1].properties.size(), 2u);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
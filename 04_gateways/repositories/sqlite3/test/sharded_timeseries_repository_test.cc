@@ -0,0 +1,183 @@
+#include "sharded_timeseries_repository.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class ShardedTimeSeriesRepositoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() /
+           ("test_sharded_ts_" +
+            std::to_string(reinterpret_cast<uintptr_t>(this)));
+    std::filesystem::remove_all(dir_);
+    ShardSetOptions options;
+    options.shards = 3;
+    shards_ = std::make_unique<ShardSet>(dir_.string(), options);
+    repo_ = std::make_unique<ShardedTimeSeriesRepository>(*shards_);
+    repo_->initSchema();
+
+    // The same assets and units in one plain repository to compare with
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    plain_ = std::make_unique<TimeSeriesRepository>(*db_);
+    plain_->initSchema();
+
+    for (auto* unit : {&u1_, &u2_}) {
+      repo_->createUnit(*unit);
+      plain_->createUnit(*unit);
+    }
+    for (int i = 0; i < 8; ++i) {
+      Entities::Asset asset{"a" + std::to_string(i),
+                            "Asset " + std::to_string(7 - i), "", ""};
+      repo_->createAsset(asset);
+      plain_->createAsset(asset);
+      ids_.push_back(asset.id);
+    }
+  }
+
+  void TearDown() override {
+    repo_.reset();
+    shards_.reset();
+    std::filesystem::remove_all(dir_);
+  }
+
+  // Every asset, both units, interleaved timestamps
+  std::vector<Entities::TimeSeriesPoint> points() const {
+    std::vector<Entities::TimeSeriesPoint> result;
+    for (int64_t t = 0; t < 20; ++t) {
+      for (size_t i = 0; i < ids_.size(); ++i) {
+        const int64_t ts = t * 1000 + static_cast<int64_t>(i % 3) * 100;
+        result.push_back({ids_[i], ts, "u1", t + i * 0.5});
+        result.push_back({ids_[i], ts, "u2", -t - i * 0.5});
+      }
+    }
+    return result;
+  }
+
+  Entities::Unit u1_{"u1", "X", "Unit X"};
+  Entities::Unit u2_{"u2", "Y", "Unit Y"};
+  std::filesystem::path dir_;
+  std::unique_ptr<ShardSet> shards_;
+  std::unique_ptr<ShardedTimeSeriesRepository> repo_;
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> plain_;
+  std::vector<std::string> ids_;
+};
+
+void expectSamePoints(const std::vector<Entities::TimeSeriesPoint>& actual,
+                      const std::vector<Entities::TimeSeriesPoint>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].asset_id, expected[i].asset_id) << i;
+    EXPECT_EQ(actual[i].timestamp_ms, expected[i].timestamp_ms) << i;
+    EXPECT_EQ(actual[i].unit_id, expected[i].unit_id) << i;
+    EXPECT_DOUBLE_EQ(actual[i].value, expected[i].value) << i;
+  }
+}
+
+// ============================================================
+// Routing
+// ============================================================
+TEST_F(ShardedTimeSeriesRepositoryTest, AssetsLiveOnTheirShardOnly) {
+  std::set<size_t> used;
+  for (const auto& id : ids_) {
+    const size_t owner = shards_->shardOf(id);
+    used.insert(owner);
+    for (size_t s = 0; s < repo_->shardCount(); ++s) {
+      EXPECT_EQ(repo_->shard(s).getAsset(id).has_value(), s == owner) << id;
+    }
+    EXPECT_TRUE(repo_->getAsset(id).has_value());
+  }
+  EXPECT_GT(used.size(), 1u);
+}
+
+TEST_F(ShardedTimeSeriesRepositoryTest, AddPointsSplitsBatchByShard) {
+  repo_->addPoints(points());
+  for (const auto& id : ids_) {
+    const size_t owner = shards_->shardOf(id);
+    for (size_t s = 0; s < repo_->shardCount(); ++s) {
+      EXPECT_EQ(repo_->shard(s).getPoints(id, 0, 100000).size(),
+                s == owner ? 40u : 0u)
+          << id;
+    }
+  }
+  auto latest = repo_->getLatestPoint("a3", "u1");
+  ASSERT_TRUE(latest.has_value());
+  EXPECT_EQ(latest->timestamp_ms, 19000);
+}
+
+TEST_F(ShardedTimeSeriesRepositoryTest, UnitsAreReplicated) {
+  Entities::Unit u3{"u3", "Z", "Unit Z"};
+  repo_->createUnit(u3);
+  for (size_t s = 0; s < repo_->shardCount(); ++s) {
+    EXPECT_TRUE(repo_->shard(s).getUnit("u3").has_value());
+  }
+  EXPECT_EQ(repo_->getAllUnits().size(), 3u);
+
+  repo_->deleteUnit("u3");
+  for (size_t s = 0; s < repo_->shardCount(); ++s) {
+    EXPECT_FALSE(repo_->shard(s).getUnit("u3").has_value());
+  }
+}
+
+// ============================================================
+// Cross-Shard Reads
+// ============================================================
+TEST_F(ShardedTimeSeriesRepositoryTest, GetAllAssetsMatchesOneRepository) {
+  auto sharded = repo_->getAllAssets();
+  auto expected = plain_->getAllAssets();
+  ASSERT_EQ(sharded.size(), expected.size());
+  for (size_t i = 0; i < sharded.size(); ++i) {
+    EXPECT_EQ(sharded[i].id, expected[i].id);
+    EXPECT_EQ(sharded[i].name, expected[i].name);
+  }
+
+  auto assets = repo_->getAssets({"a5", "missing", "a0"});
+  ASSERT_EQ(assets.size(), 3u);
+  EXPECT_EQ(assets[0]->id, "a5");
+  EXPECT_FALSE(assets[1].has_value());
+  EXPECT_EQ(assets[2]->id, "a0");
+}
+
+TEST_F(ShardedTimeSeriesRepositoryTest, MultiAssetReadsMatchOneRepository) {
+  repo_->addPoints(points());
+  plain_->addPoints(points());
+  const std::vector<std::string> ids = {"a6", "a1", "missing", "a4", "a0"};
+
+  auto multi = repo_->getPointsMulti(ids, 2000, 15000);
+  auto expected = plain_->getPointsMulti(ids, 2000, 15000);
+  ASSERT_EQ(multi.size(), ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    expectSamePoints(multi[i], expected[i]);
+  }
+
+  expectSamePoints(repo_->getPointsMerged(ids, 2000, 15000),
+                   plain_->getPointsMerged(ids, 2000, 15000));
+
+  auto latest = repo_->getLatestPoints(ids, "u2");
+  auto expected_latest = plain_->getLatestPoints(ids, "u2");
+  ASSERT_EQ(latest.size(), expected_latest.size());
+  for (size_t i = 0; i < latest.size(); ++i) {
+    ASSERT_EQ(latest[i].has_value(), expected_latest[i].has_value());
+    if (latest[i]) {
+      EXPECT_EQ(latest[i]->timestamp_ms, expected_latest[i]->timestamp_ms);
+      EXPECT_DOUBLE_EQ(latest[i]->value, expected_latest[i]->value);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
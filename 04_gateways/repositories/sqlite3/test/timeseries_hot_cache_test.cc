@@ -0,0 +1,201 @@
+#include "timeseries_hot_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class HotSeriesCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    repo_ = makeRepository(*db_);
+  }
+
+  static std::unique_ptr<TimeSeriesRepository> makeRepository(IDatabase& db) {
+    auto repo = std::make_unique<TimeSeriesRepository>(db);
+    repo->initSchema();
+    repo->createAsset({"a1", "Asset 1", "", ""});
+    repo->createAsset({"a2", "Asset 2", "", ""});
+    repo->createUnit({"USD", "USD", "USD"});
+    repo->createUnit({"EUR", "EUR", "EUR"});
+    return repo;
+  }
+
+  static HotCacheOptions span(int64_t ms) {
+    HotCacheOptions options;
+    options.span = std::chrono::milliseconds(ms);
+    return options;
+  }
+
+  int64_t count(const std::string& sql) {
+    return *db_->prepare(sql)->fetchScalar<int64_t>();
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+// ============================================================
+// Cache
+// ============================================================
+TEST_F(HotSeriesCacheTest, KeepsPointsPastTheHorizon) {
+  HotSeriesCache cache(*repo_, span(1000));
+  EXPECT_EQ(cache.stats().points, 0u);
+
+  repo_->addPoints({{"a1", 0, "USD", 1.0},
+                    {"a1", 500, "USD", 2.0},
+                    {"a2", 1500, "EUR", 3.0}});
+  // Newest 1500: the horizon is 500
+  EXPECT_EQ(cache.horizon(), 500);
+  auto points = cache.select({});
+  ASSERT_EQ(points.size(), 2u);
+  EXPECT_EQ(points[0].asset_id, "a1");
+  EXPECT_EQ(points[0].timestamp_ms, 500);
+  EXPECT_EQ(points[1].asset_id, "a2");
+
+  // Behind the horizon: disk only
+  repo_->addPoint({"a1", 100, "USD", 9.0});
+  // Moves the horizon to 2000 and evicts everything older
+  repo_->addPoint({"a1", 3000, "USD", 4.0});
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.horizon, 2000);
+  EXPECT_EQ(stats.points, 1u);
+  EXPECT_EQ(stats.series, 1u);
+  EXPECT_EQ(stats.evicted, 2u);
+  EXPECT_EQ(stats.ignored, 2u);  // 0 in the first batch, then 100
+
+  // Replacing a point keeps one copy
+  repo_->addPoint({"a1", 3000, "USD", 5.0});
+  points = cache.select({"a1", "USD", 0, 5000});
+  ASSERT_EQ(points.size(), 1u);
+  EXPECT_DOUBLE_EQ(points[0].value, 5.0);
+}
+
+TEST_F(HotSeriesCacheTest, LoadsRecentPointsFromStorage) {
+  repo_->addPoints({{"a1", 0, "USD", 1.0},
+                    {"a1", 9000, "USD", 2.0},
+                    {"a2", 9500, "EUR", 3.0},
+                    {"a2", 10000, "USD", 4.0}});
+  HotSeriesCache cache(*repo_, span(1000));
+  EXPECT_EQ(cache.horizon(), 9000);
+  EXPECT_EQ(cache.stats().points, 3u);
+  EXPECT_EQ(cache.select({"a2", std::nullopt, 9600, 20000}).size(), 1u);
+
+  // Deletes reach the cache through reload()
+  repo_->deletePoints("a2", 0, 20000);
+  EXPECT_EQ(cache.stats().points, 3u);
+  cache.reload();
+  EXPECT_EQ(cache.stats().points, 1u);
+  EXPECT_EQ(cache.horizon(), 8000);
+}
+
+// ============================================================
+// Virtual Table
+// ============================================================
+TEST_F(HotSeriesCacheTest, HotTableAppliesAssetAndTimeTerms) {
+  HotSeriesCache cache(*repo_, span(1000));
+  registerHotSeriesTable(*db_, cache);
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t ts = 0; ts <= 2000; ts += 100) {
+    points.push_back({"a1", ts, "USD", static_cast<double>(ts)});
+    points.push_back({"a2", ts, "EUR", -static_cast<double>(ts)});
+  }
+  repo_->addPoints(points);
+
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot"), 22);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot WHERE asset_id = 'a1' "
+                  "AND timestamp_ms > 1500 AND timestamp_ms <= 1800"),
+            3);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot "
+                  "WHERE unit_id = 'EUR' AND timestamp_ms = 2000"),
+            1);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot "
+                  "WHERE asset_id = 'a1' AND asset_id = 'a2'"),
+            0);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot "
+                  "WHERE timestamp_ms >= '1950' AND timestamp_ms < 2000.5"),
+            2);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot "
+                  "WHERE asset_id IN ('a2', 'a3') AND value < -1900"),
+            1);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot "
+                  "WHERE timestamp_ms = NULL"),
+            0);
+  EXPECT_EQ(count("SELECT timeseries_hot_horizon()"), 1000);
+
+  auto stmt = db_->prepare(
+      "SELECT value FROM timeseries_hot WHERE asset_id = ? AND "
+      "timestamp_ms = ?");
+  stmt->bind(1, std::string("a2")).bind(2, int64_t{1200});
+  EXPECT_DOUBLE_EQ(*stmt->fetchScalar<double>(), -1200.0);
+}
+
+TEST_F(HotSeriesCacheTest, ViewCombinesHotAndColdPointsOnce) {
+  repo_->addPoints({{"a1", 0, "USD", 1.0}, {"a1", 1000, "USD", 2.0}});
+  HotSeriesCache cache(*repo_, span(500));
+  registerHotSeriesTable(*db_, cache);
+  createHotSeriesView(*db_);
+  repo_->addPoints({{"a1", 1200, "USD", 3.0}, {"a2", 1300, "EUR", 4.0}});
+
+  EXPECT_EQ(cache.horizon(), 800);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_all"), 4);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_all "
+                  "WHERE asset_id = 'a1' AND timestamp_ms >= 0"),
+            3);
+  EXPECT_EQ(count("SELECT count(*) FROM (SELECT * FROM timeseries_all "
+                  "EXCEPT SELECT * FROM timeseries)"),
+            0);
+
+  // Moving the horizon keeps each point on one side
+  repo_->addPoint({"a1", 5000, "USD", 5.0});
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_all"), 5);
+  EXPECT_EQ(count("SELECT count(*) FROM timeseries_hot"), 1);
+
+  createHotSeriesView(*db_);  // already there
+}
+
+TEST_F(HotSeriesCacheTest, HotTableWorksOnEveryPoolConnection) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("test_hot_cache_" +
+                     std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db");
+  {
+    Gateways::Database::SqlitePoolOptions options;
+    options.readerCount = 2;
+    Gateways::Database::SqlitePool pool(path.string(), options);
+    auto repo = makeRepository(pool);
+    HotSeriesCache cache(*repo, span(1000));
+    registerHotSeriesTable(pool, cache);
+    createHotSeriesView(pool);
+    repo->addPoints({{"a1", 0, "USD", 1.0}, {"a1", 5000, "USD", 2.0}});
+
+    // Both readers at once
+    {
+      std::vector<std::unique_ptr<IStatement>> stmts;
+      for (int i = 0; i < 2; ++i) {
+        stmts.push_back(pool.prepare(
+            "SELECT count(*) FROM timeseries_hot WHERE asset_id = 'a1'"));
+        EXPECT_EQ(stmts.back()->fetchScalar<int64_t>(), 1);
+      }
+    }
+    EXPECT_EQ(pool.prepare("SELECT count(*) FROM timeseries_all")
+                  ->fetchScalar<int64_t>(),
+              2);
+  }
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::filesystem::remove(path.string() + suffix);
+  }
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,282 @@
+#include "timeseries_indicators.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// RollingIndicator
+// ============================================================
+TEST(RollingIndicatorTest, SimpleMovingAverage) {
+  RollingIndicator sma(IndicatorKind::Sma, 3);
+  EXPECT_FALSE(sma.value().has_value());
+
+  sma.update(1.0);
+  sma.update(2.0);
+  EXPECT_DOUBLE_EQ(*sma.value(), 1.5);
+  EXPECT_FALSE(sma.ready());
+  sma.update(3.0);
+  sma.update(10.0);
+  EXPECT_DOUBLE_EQ(*sma.value(), 5.0);
+  EXPECT_TRUE(sma.ready());
+  EXPECT_EQ(sma.samples(), 4u);
+}
+
+TEST(RollingIndicatorTest, ExponentialMovingAverage) {
+  RollingIndicator ema(IndicatorKind::Ema, 3);  // alpha 0.5
+  ema.update(10.0);
+  EXPECT_DOUBLE_EQ(*ema.value(), 10.0);
+  ema.update(20.0);
+  ema.update(20.0);
+  EXPECT_DOUBLE_EQ(*ema.value(), 17.5);
+  EXPECT_TRUE(ema.ready());
+}
+
+TEST(RollingIndicatorTest, VolatilityOfReturns) {
+  RollingIndicator vol(IndicatorKind::Volatility, 2);
+  vol.update(100.0);
+  vol.update(110.0);  // +10%
+  EXPECT_FALSE(vol.value().has_value());
+  vol.update(99.0);  // -10%
+  EXPECT_NEAR(*vol.value(), std::sqrt(0.02), 1e-12);
+  vol.update(99.0);  // window is now -10%, 0%
+  EXPECT_NEAR(*vol.value(), std::sqrt(0.005), 1e-12);
+}
+
+TEST(RollingIndicatorTest, VolumeWeightedAverage) {
+  RollingIndicator vwap(IndicatorKind::Vwap, 2);
+  vwap.update(10.0, 0.0);
+  EXPECT_FALSE(vwap.value().has_value());
+  vwap.update(20.0, 1.0);
+  vwap.update(30.0, 3.0);
+  EXPECT_DOUBLE_EQ(*vwap.value(), 27.5);
+}
+
+TEST(RollingIndicatorTest, LongRunMatchesWindowMean) {
+  RollingIndicator sma(IndicatorKind::Sma, 7);
+  for (int i = 0; i < 100000; ++i) {
+    sma.update(1e6 + (i % 13) * 0.1);
+  }
+  double expected = 0.0;
+  for (int i = 100000 - 7; i < 100000; ++i) {
+    expected += 1e6 + (i % 13) * 0.1;
+  }
+  EXPECT_NEAR(*sma.value(), expected / 7, 1e-9);
+}
+
+TEST(RollingIndicatorTest, StateRoundTrips) {
+  RollingIndicator vol(IndicatorKind::Volatility, 3);
+  for (double v : {100.0, 101.0, 99.0, 102.0, 98.0}) {
+    vol.update(v);
+  }
+  RollingIndicator copy(IndicatorKind::Volatility, 3);
+  copy.restoreState(vol.saveState());
+  EXPECT_DOUBLE_EQ(*copy.value(), *vol.value());
+  EXPECT_EQ(copy.samples(), 5u);
+  vol.update(97.0);
+  copy.update(97.0);
+  EXPECT_DOUBLE_EQ(*copy.value(), *vol.value());
+
+  RollingIndicator other(IndicatorKind::Volatility, 4);
+  EXPECT_THROW(other.restoreState(vol.saveState()), std::invalid_argument);
+  std::vector<uint8_t> truncated = vol.saveState();
+  truncated.pop_back();
+  EXPECT_THROW(copy.restoreState(truncated), std::invalid_argument);
+}
+
+TEST(RollingIndicatorTest, RejectsBadWindow) {
+  EXPECT_THROW(RollingIndicator(IndicatorKind::Sma, 0), std::invalid_argument);
+  EXPECT_THROW(RollingIndicator(IndicatorKind::Volatility, 1),
+               std::invalid_argument);
+}
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class TimeSeriesIndicatorsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    repo_ = std::make_unique<TimeSeriesRepository>(*db_);
+    repo_->initSchema();
+    repo_->createAsset({"a1", "Asset 1", "", ""});
+    repo_->createAsset({"a2", "Asset 2", "", ""});
+    repo_->createUnit({"px", "P", "Price"});
+    repo_->createUnit({"vol", "V", "Volume"});
+  }
+
+  std::unique_ptr<TimeSeriesIndicators> open(
+      const IndicatorOptions& options = {}) {
+    auto indicators =
+        std::make_unique<TimeSeriesIndicators>(*db_, *repo_, options);
+    indicators->initSchema();
+    return indicators;
+  }
+
+  // Prices 1, 2, ..., count at one per second from first_ms
+  void addPrices(int64_t first_ms, int count, double first = 1.0) {
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (int i = 0; i < count; ++i) {
+      points.push_back({"a1", first_ms + i * 1000, "px", first + i});
+    }
+    repo_->addPoints(points);
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+// ============================================================
+// Ingest
+// ============================================================
+TEST_F(TimeSeriesIndicatorsTest, UpdatesOnIngest) {
+  auto indicators = open();
+  indicators->add({"sma", "a1", "px", IndicatorKind::Sma, 3, ""});
+  indicators->add({"ema", "a1", "px", IndicatorKind::Ema, 3, ""});
+  EXPECT_FALSE(indicators->value("sma").has_value());
+
+  addPrices(0, 5);
+  auto sma = indicators->value("sma");
+  ASSERT_TRUE(sma.has_value());
+  EXPECT_DOUBLE_EQ(sma->value, 4.0);
+  EXPECT_EQ(sma->timestamp_ms, 4000);
+  EXPECT_EQ(sma->samples, 5u);
+  EXPECT_TRUE(sma->ready);
+
+  repo_->addPoint({"a1", 5000, "px", 12.0});
+  EXPECT_DOUBLE_EQ(indicators->value("sma")->value, 7.0);
+  // Other series do not reach the indicator
+  repo_->addPoint({"a2", 6000, "px", 100.0});
+  EXPECT_EQ(indicators->value("sma")->samples, 6u);
+  EXPECT_EQ(indicators->stats().updates, 12u);
+  EXPECT_FALSE(indicators->value("missing").has_value());
+}
+
+TEST_F(TimeSeriesIndicatorsTest, SortsBatchesAndSkipsLatePoints) {
+  auto indicators = open();
+  indicators->add({"sma", "a1", "px", IndicatorKind::Sma, 2, ""});
+
+  repo_->addPoints({{"a1", 3000, "px", 3.0},
+                    {"a1", 1000, "px", 1.0},
+                    {"a1", 2000, "px", 2.0}});
+  EXPECT_DOUBLE_EQ(indicators->value("sma")->value, 2.5);
+
+  repo_->addPoint({"a1", 2500, "px", 100.0});
+  repo_->addPoint({"a1", 3000, "px", 100.0});
+  EXPECT_DOUBLE_EQ(indicators->value("sma")->value, 2.5);
+  EXPECT_EQ(indicators->stats().skipped, 2u);
+}
+
+TEST_F(TimeSeriesIndicatorsTest, VwapUsesLatestWeight) {
+  auto indicators = open();
+  EXPECT_THROW(
+      indicators->add({"vwap", "a1", "px", IndicatorKind::Vwap, 3, ""}),
+      std::invalid_argument);
+  indicators->add({"vwap", "a1", "px", IndicatorKind::Vwap, 3, "vol"});
+
+  repo_->addPoints({{"a1", 1000, "px", 10.0},
+                    {"a1", 1000, "vol", 1.0},
+                    {"a1", 2000, "px", 20.0},
+                    {"a1", 2000, "vol", 3.0},
+                    {"a1", 3000, "px", 40.0}});
+  // Weights 1, 3, 3
+  EXPECT_DOUBLE_EQ(indicators->value("vwap")->value, 190.0 / 7.0);
+}
+
+// ============================================================
+// Checkpoints and Replay
+// ============================================================
+TEST_F(TimeSeriesIndicatorsTest, AddReplaysHistory) {
+  addPrices(0, 10);
+  auto indicators = open();
+  indicators->add({"sma", "a1", "px", IndicatorKind::Sma, 4, ""});
+
+  EXPECT_DOUBLE_EQ(indicators->value("sma")->value, 8.5);
+  EXPECT_EQ(indicators->stats().replayed, 10u);
+  EXPECT_THROW(indicators->add({"sma", "a1", "px", IndicatorKind::Ema, 4, ""}),
+               std::invalid_argument);
+}
+
+TEST_F(TimeSeriesIndicatorsTest, RestartReplaysOnlyAfterCheckpoint) {
+  const IndicatorSpec spec{"vol", "a1", "px", IndicatorKind::Volatility, 5, ""};
+  double expected = 0.0;
+  {
+    IndicatorOptions options;
+    options.checkpointEvery = 0;
+    auto indicators = open(options);
+    indicators->add(spec);
+    addPrices(0, 20);
+    indicators->checkpoint();
+    EXPECT_EQ(indicators->stats().checkpoints, 2u);
+    // Written after the checkpoint: replayed on restart
+    addPrices(20000, 3, 21.0);
+    expected = indicators->value("vol")->value;
+  }
+
+  auto indicators = open();
+  indicators->add(spec);
+  EXPECT_EQ(indicators->stats().replayed, 3u);
+  auto value = indicators->value("vol");
+  ASSERT_TRUE(value.has_value());
+  EXPECT_DOUBLE_EQ(value->value, expected);
+  EXPECT_EQ(value->samples, 23u);
+  EXPECT_EQ(value->timestamp_ms, 22000);
+}
+
+TEST_F(TimeSeriesIndicatorsTest, AutomaticCheckpoints) {
+  IndicatorOptions options;
+  options.checkpointEvery = 10;
+  auto indicators = open(options);
+  indicators->add({"sma", "a1", "px", IndicatorKind::Sma, 3, ""});
+  addPrices(0, 25);
+  EXPECT_EQ(indicators->stats().checkpoints, 2u);  // on add, then after 25
+  indicators.reset();
+
+  auto reopened = open();
+  reopened->add({"sma", "a1", "px", IndicatorKind::Sma, 3, ""});
+  EXPECT_EQ(reopened->stats().replayed, 0u);
+  EXPECT_DOUBLE_EQ(reopened->value("sma")->value, 24.0);
+}
+
+TEST_F(TimeSeriesIndicatorsTest, ChangedSpecReplaysFully) {
+  addPrices(0, 10);
+  open()->add({"avg", "a1", "px", IndicatorKind::Sma, 3, ""});
+
+  auto indicators = open();
+  indicators->add({"avg", "a1", "px", IndicatorKind::Sma, 5, ""});
+  EXPECT_EQ(indicators->stats().replayed, 10u);
+  EXPECT_DOUBLE_EQ(indicators->value("avg")->value, 8.0);
+}
+
+TEST_F(TimeSeriesIndicatorsTest, RemoveDropsCheckpoint) {
+  addPrices(0, 5);
+  auto indicators = open();
+  indicators->add({"sma", "a1", "px", IndicatorKind::Sma, 3, ""});
+  EXPECT_TRUE(indicators->remove("sma"));
+  EXPECT_FALSE(indicators->remove("sma"));
+  EXPECT_TRUE(indicators->specs().empty());
+
+  auto stmt = db_->prepare("SELECT COUNT(*) FROM timeseries_indicators");
+  EXPECT_EQ(stmt->fetchScalar<int64_t>(), 0);
+  addPrices(5000, 1);
+  EXPECT_EQ(indicators->stats().updates, 0u);
+}
+
+TEST_F(TimeSeriesIndicatorsTest, DestroyedIndicatorsStopListening) {
+  auto indicators = open();
+  indicators->add({"sma", "a1", "px", IndicatorKind::Sma, 3, ""});
+  indicators.reset();
+  EXPECT_NO_THROW(addPrices(0, 3));
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
@@ -2,11 +2,16 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <filesystem>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "alloc_counter.h"
 #include "sqlite3_database_connector.h"
+#include "sqlite3_pool.h"
 
 namespace Gateways::Repositories::Sqlite3 {
 namespace {
@@ -31,6 +36,130 @@ TEST_F(TimeSeriesRepositoryTest, InitSchemaCreatesTablesIfNotExist) {
   EXPECT_NO_THROW(repo_->initSchema());
 }
 
+TEST_F(TimeSeriesRepositoryTest, InitSchemaLeavesCurrentSchemaAlone) {
+  EXPECT_EQ(Gateways::Database::schemaVersion(*db_, "timeseries"), 3);
+
+  db_->resetTransactionStats();
+  TimeSeriesRepository reopened(*db_);
+  reopened.initSchema();
+  EXPECT_EQ(db_->transactionStats().begins, 0u);
+}
+
+TEST_F(TimeSeriesRepositoryTest, PointsTableIsClusteredWithoutRowid) {
+  auto result = db_->query(
+      "SELECT sql FROM sqlite_master WHERE name = 'timeseries_points'");
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_NE(std::get<std::string>(result[0][0]).find("WITHOUT ROWID"),
+            std::string::npos);
+}
+
+TEST_F(TimeSeriesRepositoryTest, TimeseriesViewKeepsStringShape) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoint({"a1", 1000, "u1", 42.0});
+
+  auto result = db_->query(
+      "SELECT asset_id, timestamp_ms, unit_id, value FROM timeseries");
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(std::get<std::string>(result[0][0]), "a1");
+  EXPECT_EQ(std::get<int64_t>(result[0][1]), 1000);
+  EXPECT_EQ(std::get<std::string>(result[0][2]), "u1");
+  EXPECT_DOUBLE_EQ(std::get<double>(result[0][3]), 42.0);
+}
+
+TEST_F(TimeSeriesRepositoryTest, InitSchemaMigratesLegacyTable) {
+  Gateways::Database::SqliteDatabase legacy(":memory:");
+  legacy.execute(
+      "CREATE TABLE assets (id TEXT PRIMARY KEY, name TEXT NOT NULL, "
+      "description TEXT NOT NULL DEFAULT '', source TEXT NOT NULL DEFAULT '')");
+  legacy.execute(
+      "CREATE TABLE units (id TEXT PRIMARY KEY, symbol TEXT NOT NULL, "
+      "name TEXT NOT NULL)");
+  legacy.execute(
+      "CREATE TABLE timeseries (asset_id TEXT NOT NULL, "
+      "timestamp_ms INTEGER NOT NULL, unit_id TEXT NOT NULL, "
+      "value REAL NOT NULL, PRIMARY KEY (asset_id, timestamp_ms, unit_id))");
+  legacy.execute(
+      "CREATE INDEX idx_timeseries_asset_time "
+      "ON timeseries(asset_id, timestamp_ms)");
+  legacy.execute("INSERT INTO assets (id, name) VALUES ('a1', 'Asset')");
+  legacy.execute(
+      "INSERT INTO units (id, symbol, name) VALUES ('u1', 'X', 'Unit X'), "
+      "('u2', 'Y', 'Unit Y')");
+  legacy.execute(
+      "INSERT INTO timeseries VALUES ('a1', 1000, 'u1', 1.0), "
+      "('a1', 2000, 'u2', 2.0), ('a1', 3000, 'u1', 3.0)");
+
+  TimeSeriesRepository repo(legacy);
+  repo.initSchema();
+
+  auto points = repo.getPoints("a1", 0, 4000);
+  ASSERT_EQ(points.size(), 3u);
+  EXPECT_EQ(points[1].unit_id, "u2");
+  EXPECT_DOUBLE_EQ(points[1].value, 2.0);
+  EXPECT_EQ(repo.getPoints("a1", "u1", 0, 4000).size(), 2u);
+
+  auto type = legacy.query(
+      "SELECT type FROM sqlite_master WHERE name = 'timeseries'");
+  ASSERT_EQ(type.size(), 1u);
+  EXPECT_EQ(std::get<std::string>(type[0][0]), "view");
+
+  // The legacy (asset, time) index went with its table; one on the
+  // points table replaces it
+  auto indexes = legacy.query(
+      "SELECT name FROM sqlite_master WHERE type = 'index' AND sql IS NOT "
+      "NULL AND tbl_name IN ('timeseries', 'timeseries_points')");
+  ASSERT_EQ(indexes.size(), 1u);
+  EXPECT_EQ(std::get<std::string>(indexes[0][0]),
+            "idx_timeseries_points_asset_time");
+
+  // Migrated assets take part in new writes and cascades
+  repo.addPoint({"a1", 4000, "u1", 4.0});
+  EXPECT_EQ(repo.getPoints("a1", 0, 5000).size(), 4u);
+  repo.deleteUnit("u1");
+  EXPECT_EQ(repo.getPoints("a1", 0, 5000).size(), 1u);
+}
+
+TEST_F(TimeSeriesRepositoryTest, AssetRangeSeeksTheTimeIndex) {
+  auto plan = db_->prepare(
+      "EXPLAIN QUERY PLAN SELECT unit_key, timestamp_ms, value "
+      "FROM timeseries_points WHERE asset_key = ? AND timestamp_ms >= ? "
+      "AND timestamp_ms <= ? ORDER BY timestamp_ms");
+  std::string detail;
+  for (const auto& row : plan->rows()) {
+    detail += std::string(row.getText(3));
+  }
+  EXPECT_NE(detail.find("idx_timeseries_points_asset_time"), std::string::npos)
+      << detail;
+  EXPECT_EQ(detail.find("TEMP B-TREE"), std::string::npos) << detail;
+}
+
+TEST_F(TimeSeriesRepositoryTest, AddPointForUnknownAssetThrows) {
+  repo_->createUnit({"u1", "X", "Unit"});
+  EXPECT_THROW(repo_->addPoint({"missing", 1000, "u1", 1.0}),
+               Gateways::Database::QueryException);
+}
+
+TEST_F(TimeSeriesRepositoryTest, RolledBackAssetLeavesNoStaleKey) {
+  repo_->createUnit({"u1", "X", "Unit"});
+
+  db_->beginTransaction();
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->addPoint({"a1", 1000, "u1", 1.0});
+  db_->rollback();
+
+  repo_->createAsset({"a2", "Other", "", ""});
+  EXPECT_THROW(repo_->addPoint({"a1", 1000, "u1", 1.0}),
+               Gateways::Database::QueryException);
+
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->addPoint({"a1", 2000, "u1", 2.0});
+  auto points = repo_->getPoints("a1", 0, 4000);
+  ASSERT_EQ(points.size(), 1u);
+  EXPECT_EQ(points[0].timestamp_ms, 2000);
+  EXPECT_TRUE(repo_->getPoints("a2", 0, 4000).empty());
+}
+
 // ============================================================
 // Asset CRUD
 // ============================================================
@@ -65,6 +194,19 @@ TEST_F(TimeSeriesRepositoryTest, GetAllAssets) {
   EXPECT_EQ(assets[2].name, "Asset C");
 }
 
+TEST_F(TimeSeriesRepositoryTest, GetAssetsByIds) {
+  repo_->createAsset({"a1", "Asset 1", "First", "src"});
+  repo_->createAsset({"a2", "Asset 2", "", ""});
+
+  auto assets = repo_->getAssets({"a2", "nope", "a1"});
+  ASSERT_EQ(assets.size(), 3u);
+  ASSERT_TRUE(assets[0].has_value());
+  EXPECT_EQ(assets[0]->name, "Asset 2");
+  EXPECT_FALSE(assets[1].has_value());
+  ASSERT_TRUE(assets[2].has_value());
+  EXPECT_EQ(assets[2]->description, "First");
+}
+
 TEST_F(TimeSeriesRepositoryTest, GetAllAssetsEmpty) {
   auto assets = repo_->getAllAssets();
   EXPECT_TRUE(assets.empty());
@@ -270,6 +412,21 @@ TEST_F(TimeSeriesRepositoryTest, AddPointsMultiple) {
   EXPECT_DOUBLE_EQ(retrieved[2].value, 3.0);
 }
 
+TEST_F(TimeSeriesRepositoryTest, AddPointsInsideOuterTransaction) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+
+  {
+    auto group = db_->groupCommit();
+    repo_->addPoints({{"a1", 1000, "u1", 1.0}});
+    repo_->addPoints({{"a1", 2000, "u1", 2.0}});
+    group.commit();
+  }
+
+  EXPECT_EQ(repo_->getPoints("a1", 0, 4000).size(), 2u);
+  EXPECT_EQ(db_->transactionStats().groupedCommits, 2u);
+}
+
 TEST_F(TimeSeriesRepositoryTest, AddPointsEmpty) {
   // Should not throw
   EXPECT_NO_THROW(repo_->addPoints({}));
@@ -305,6 +462,213 @@ TEST_F(TimeSeriesRepositoryTest, GetPointsTimeRange) {
   EXPECT_EQ(points[1].timestamp_ms, 3000);
 }
 
+TEST_F(TimeSeriesRepositoryTest, GetCompactPointsMatchesGetPoints) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit 1"});
+  repo_->createUnit({"u2", "Y", "Unit 2"});
+  repo_->addPoint({"a1", 1000, "u1", 1.0});
+  repo_->addPoint({"a1", 2000, "u2", 2.0});
+  repo_->addPoint({"a1", 3000, "u1", 3.0});
+  repo_->addPoint({"a1", 4000, "u1", 4.0});
+
+  const auto points = repo_->getPoints("a1", 1000, 3000);
+  const auto compact = repo_->getCompactPoints("a1", 1000, 3000);
+  EXPECT_EQ(compact.asset_id, "a1");
+  ASSERT_EQ(compact.points.size(), points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(compact.points[i].timestamp_ms, points[i].timestamp_ms);
+    EXPECT_EQ(compact.points[i].unit_id.view(), points[i].unit_id);
+    EXPECT_DOUBLE_EQ(compact.points[i].value, points[i].value);
+  }
+}
+
+TEST_F(TimeSeriesRepositoryTest, GetCompactPointsRejectsLongUnitIds) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"EUR-per-share-consolidated", "EUR", "Euro"});
+  repo_->addPoint({"a1", 1000, "EUR-per-share-consolidated", 1.0});
+
+  EXPECT_THROW(repo_->getCompactPoints("a1", 0, 2000), std::length_error);
+}
+
+TEST_F(TimeSeriesRepositoryTest, GetPointColumns) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+
+  repo_->addPoint({"a1", 3000, "u1", 3.5});
+  repo_->addPoint({"a1", 1000, "u1", 1.5});
+  repo_->addPoint({"a1", 2000, "u1", 2.5});
+
+  auto result = repo_->getPointColumns("a1", "u1", 0, 2500);
+  ASSERT_EQ(result.rowCount, 2u);
+  ASSERT_EQ(result.columns.size(), 2u);
+  EXPECT_EQ(result.columns[0].int64s, (std::vector<int64_t>{1000, 2000}));
+  EXPECT_EQ(result.columns[1].doubles, (std::vector<double>{1.5, 2.5}));
+
+  auto empty = repo_->getPointColumns("a1", "u1", 5000, 6000);
+  EXPECT_EQ(empty.rowCount, 0u);
+  EXPECT_EQ(empty.columns[1].kind, ColumnKind::Double);
+}
+
+TEST_F(TimeSeriesRepositoryTest, AggregateOhlcBuckets) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoints({
+      {"a1", 0, "u1", 10.0},
+      {"a1", 20000, "u1", 14.0},
+      {"a1", 40000, "u1", 8.0},
+      {"a1", 59999, "u1", 12.0},
+      {"a1", 60000, "u1", 5.0},
+      {"a1", 180000, "u1", 7.0},  // minute 2 is empty
+  });
+
+  auto buckets = repo_->aggregate("a1", "u1", 0, 200000, 60000);
+  ASSERT_EQ(buckets.size(), 3u);
+  EXPECT_EQ(buckets[0].bucket_start_ms, 0);
+  EXPECT_DOUBLE_EQ(buckets[0].open, 10.0);
+  EXPECT_DOUBLE_EQ(buckets[0].high, 14.0);
+  EXPECT_DOUBLE_EQ(buckets[0].low, 8.0);
+  EXPECT_DOUBLE_EQ(buckets[0].close, 12.0);
+  EXPECT_DOUBLE_EQ(buckets[0].avg, 11.0);
+  EXPECT_EQ(buckets[0].count, 4);
+  EXPECT_EQ(buckets[1].bucket_start_ms, 60000);
+  EXPECT_EQ(buckets[1].count, 1);
+  EXPECT_EQ(buckets[2].bucket_start_ms, 180000);
+  EXPECT_DOUBLE_EQ(buckets[2].avg, 7.0);
+}
+
+TEST_F(TimeSeriesRepositoryTest, AggregateRespectsRangeAndEpochAlignment) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoints({
+      {"a1", -1500, "u1", 1.0},
+      {"a1", -500, "u1", 2.0},
+      {"a1", 500, "u1", 3.0},
+      {"a1", 1500, "u1", 4.0},
+  });
+
+  auto buckets = repo_->aggregate("a1", "u1", -1000, 1000, 1000);
+  ASSERT_EQ(buckets.size(), 2u);
+  EXPECT_EQ(buckets[0].bucket_start_ms, -1000);
+  EXPECT_DOUBLE_EQ(buckets[0].open, 2.0);
+  EXPECT_EQ(buckets[1].bucket_start_ms, 0);
+  EXPECT_DOUBLE_EQ(buckets[1].close, 3.0);
+
+  EXPECT_TRUE(repo_->aggregate("a1", "u1", 5000, 6000, 1000).empty());
+  EXPECT_THROW(repo_->aggregate("a1", "u1", 0, 1000, 0),
+               std::invalid_argument);
+}
+
+TEST_F(TimeSeriesRepositoryTest, ScanPointsPagesInTimeOrder) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit 1"});
+  repo_->createUnit({"u2", "Y", "Unit 2"});
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < 11; ++i) {
+    // Equal timestamps across units must not be skipped at a page edge
+    points.push_back({"a1", i * 1000, "u1", static_cast<double>(i)});
+    points.push_back({"a1", i * 1000, "u2", static_cast<double>(-i)});
+  }
+  repo_->addPoints(points);
+
+  std::vector<size_t> sizes;
+  std::vector<Entities::TimeSeriesPoint> scanned;
+  size_t visited = repo_->scanPoints(
+      "a1", 1000, 9000,
+      [&](const std::vector<Entities::TimeSeriesPoint>& batch) {
+        sizes.push_back(batch.size());
+        scanned.insert(scanned.end(), batch.begin(), batch.end());
+        return true;
+      },
+      3);
+
+  auto expected = repo_->getPoints("a1", 1000, 9000);
+  EXPECT_EQ(visited, 18u);
+  EXPECT_EQ(sizes, (std::vector<size_t>{3, 3, 3, 3, 3, 3}));
+  ASSERT_EQ(scanned.size(), expected.size());
+  for (size_t i = 0; i < scanned.size(); ++i) {
+    EXPECT_EQ(scanned[i].timestamp_ms, expected[i].timestamp_ms) << i;
+    EXPECT_EQ(scanned[i].unit_id, expected[i].unit_id) << i;
+    EXPECT_DOUBLE_EQ(scanned[i].value, expected[i].value) << i;
+  }
+}
+
+TEST_F(TimeSeriesRepositoryTest, ScanPointsStopsWhenVisitorDeclines) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < 10; ++i) {
+    points.push_back({"a1", i * 1000, "u1", static_cast<double>(i)});
+  }
+  repo_->addPoints(points);
+
+  int calls = 0;
+  size_t visited = repo_->scanPoints(
+      "a1", 0, 100000,
+      [&](const std::vector<Entities::TimeSeriesPoint>&) {
+        return ++calls < 2;
+      },
+      4);
+
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(visited, 8u);
+}
+
+TEST_F(TimeSeriesRepositoryTest, ScanPointsEmptyRangeAndBadBatch) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoint({"a1", 1000, "u1", 1.0});
+
+  int calls = 0;
+  auto visitor = [&](const std::vector<Entities::TimeSeriesPoint>&) {
+    ++calls;
+    return true;
+  };
+  EXPECT_EQ(repo_->scanPoints("a1", 2000, 3000, visitor), 0u);
+  EXPECT_EQ(repo_->scanPoints("missing", 0, 3000, visitor), 0u);
+  EXPECT_EQ(calls, 0);
+  EXPECT_THROW(repo_->scanPoints("a1", 0, 3000, visitor, 0),
+               std::invalid_argument);
+}
+
+TEST_F(TimeSeriesRepositoryTest, SeriesCursorPagesOneSeries) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit 1"});
+  repo_->createUnit({"u2", "Y", "Unit 2"});
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < 10; ++i) {
+    points.push_back({"a1", i * 1000, "u1", static_cast<double>(i)});
+    points.push_back({"a1", i * 1000, "u2", static_cast<double>(-i)});
+  }
+  repo_->addPoints(points);
+
+  auto cursor = repo_->openSeriesCursor("a1", "u1", 1000, 8000, 3);
+  std::vector<int64_t> timestamps;
+  int64_t ts = 0;
+  double value = 0.0;
+  while (cursor.next(ts, value)) {
+    EXPECT_DOUBLE_EQ(value, static_cast<double>(ts / 1000));
+    timestamps.push_back(ts);
+  }
+  EXPECT_EQ(timestamps, (std::vector<int64_t>{1000, 2000, 3000, 4000, 5000,
+                                              6000, 7000, 8000}));
+  EXPECT_FALSE(cursor.next(ts, value));
+
+  // Unbounded range ending on a full page
+  auto all = repo_->openSeriesCursor("a1", "u2",
+                                     std::numeric_limits<int64_t>::min(),
+                                     std::numeric_limits<int64_t>::max(), 5);
+  size_t count = 0;
+  while (all.next(ts, value)) {
+    ++count;
+  }
+  EXPECT_EQ(count, 10u);
+
+  auto empty = repo_->openSeriesCursor("a1", "u1", 20000, 30000);
+  EXPECT_FALSE(empty.next(ts, value));
+  EXPECT_THROW(repo_->openSeriesCursor("a1", "u1", 0, 1000, 0),
+               std::invalid_argument);
+}
+
 TEST_F(TimeSeriesRepositoryTest, GetLatestPoint) {
   repo_->createAsset({"a1", "Asset", "", ""});
   repo_->createUnit({"u1", "X", "Unit"});
@@ -339,6 +703,50 @@ TEST_F(TimeSeriesRepositoryTest, GetLatestPointWithUnit) {
   EXPECT_EQ(latest->unit_id, "u2");
 }
 
+TEST_F(TimeSeriesRepositoryTest, GetLatestPointsForManyAssets) {
+  repo_->createAsset({"a1", "Asset 1", "", ""});
+  repo_->createAsset({"a2", "Asset 2", "", ""});
+  repo_->createUnit({"u1", "X", "Unit 1"});
+  repo_->createUnit({"u2", "Y", "Unit 2"});
+
+  repo_->addPoint({"a1", 1000, "u1", 1.0});
+  repo_->addPoint({"a1", 3000, "u1", 3.0});
+  repo_->addPoint({"a1", 4000, "u2", 4.0});
+  repo_->addPoint({"a2", 2000, "u1", 2.0});
+
+  auto points = repo_->getLatestPoints({"a2", "a1", "a3"}, "u1");
+  ASSERT_EQ(points.size(), 3u);
+  ASSERT_TRUE(points[0].has_value());
+  EXPECT_EQ(points[0]->timestamp_ms, 2000);
+  ASSERT_TRUE(points[1].has_value());
+  EXPECT_EQ(points[1]->timestamp_ms, 3000);
+  EXPECT_DOUBLE_EQ(points[1]->value, 3.0);
+  EXPECT_FALSE(points[2].has_value());
+}
+
+TEST_F(TimeSeriesRepositoryTest, GetLatestPointsInAnyUnit) {
+  repo_->createAsset({"a1", "Asset 1", "", ""});
+  repo_->createAsset({"a2", "Asset 2", "", ""});
+  repo_->createUnit({"u1", "X", "Unit 1"});
+  repo_->createUnit({"u2", "Y", "Unit 2"});
+
+  repo_->addPoint({"a1", 3000, "u1", 3.0});
+  repo_->addPoint({"a1", 4000, "u2", 4.0});
+  repo_->addPoint({"a2", 2000, "u1", 2.0});
+
+  auto points = repo_->getLatestPoints({"a2", "a1", "a3"});
+  ASSERT_EQ(points.size(), 3u);
+  ASSERT_TRUE(points[0].has_value());
+  EXPECT_EQ(points[0]->asset_id, "a2");
+  EXPECT_EQ(points[0]->unit_id, "u1");
+  ASSERT_TRUE(points[1].has_value());
+  EXPECT_EQ(points[1]->timestamp_ms, 4000);
+  EXPECT_EQ(points[1]->unit_id, "u2");
+  EXPECT_DOUBLE_EQ(points[1]->value, 4.0);
+  EXPECT_FALSE(points[2].has_value());
+  EXPECT_TRUE(repo_->getLatestPoints(std::vector<std::string>{}).empty());
+}
+
 TEST_F(TimeSeriesRepositoryTest, GetLatestPointWithUnitNotFound) {
   repo_->createAsset({"a1", "Asset", "", ""});
   repo_->createUnit({"u1", "X", "Unit"});
@@ -347,6 +755,121 @@ TEST_F(TimeSeriesRepositoryTest, GetLatestPointWithUnitNotFound) {
   EXPECT_FALSE(latest.has_value());
 }
 
+TEST_F(TimeSeriesRepositoryTest, LatestTableTracksNewestPerSeries) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit 1"});
+  repo_->createUnit({"u2", "Y", "Unit 2"});
+
+  repo_->addPoints({{"a1", 3000, "u1", 3.0},
+                    {"a1", 1000, "u1", 1.0},
+                    {"a1", 2000, "u2", 2.0},
+                    {"a1", 3000, "u1", 3.5}});  // replaces the first
+  repo_->addPoint({"a1", 500, "u2", 0.5});      // older, no change
+
+  auto rows = db_->query(
+      "SELECT timestamp_ms, value FROM timeseries_latest ORDER BY value");
+  ASSERT_EQ(rows.size(), 2u);
+  EXPECT_EQ(std::get<int64_t>(rows[0][0]), 2000);
+  EXPECT_EQ(std::get<int64_t>(rows[1][0]), 3000);
+  EXPECT_DOUBLE_EQ(std::get<double>(rows[1][1]), 3.5);
+}
+
+TEST_F(TimeSeriesRepositoryTest, LatestRepairedAfterDeletes) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoints({{"a1", 1000, "u1", 1.0},
+                    {"a1", 2000, "u1", 2.0},
+                    {"a1", 3000, "u1", 3.0}});
+  ASSERT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 3000);
+
+  repo_->deletePoints("a1", 2500, 5000);
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 2000);
+  EXPECT_EQ(repo_->getLatestPoint("a1")->timestamp_ms, 2000);
+
+  // Not the latest: nothing to repair
+  repo_->deletePoints("a1", 0, 1500);
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 2000);
+
+  repo_->deleteAllPoints("a1");
+  EXPECT_FALSE(repo_->getLatestPoint("a1", "u1").has_value());
+  EXPECT_FALSE(repo_->getLatestPoint("a1").has_value());
+  EXPECT_TRUE(db_->query("SELECT * FROM timeseries_latest").empty());
+}
+
+TEST_F(TimeSeriesRepositoryTest, LatestFollowsCascadingDeletes) {
+  repo_->createAsset({"a1", "Asset 1", "", ""});
+  repo_->createAsset({"a2", "Asset 2", "", ""});
+  repo_->createUnit({"u1", "X", "Unit 1"});
+  repo_->createUnit({"u2", "Y", "Unit 2"});
+  repo_->addPoints({{"a1", 1000, "u1", 1.0},
+                    {"a1", 2000, "u2", 2.0},
+                    {"a2", 3000, "u1", 3.0}});
+  ASSERT_TRUE(repo_->getLatestPoint("a1", "u2").has_value());
+  ASSERT_TRUE(repo_->getLatestPoint("a2", "u1").has_value());
+
+  repo_->deleteUnit("u2");
+  EXPECT_FALSE(repo_->getLatestPoint("a1", "u2").has_value());
+  EXPECT_EQ(repo_->getLatestPoint("a1")->unit_id, "u1");
+
+  repo_->deleteAsset("a2");
+  EXPECT_FALSE(repo_->getLatestPoint("a2", "u1").has_value());
+  EXPECT_EQ(db_->query("SELECT * FROM timeseries_latest").size(), 1u);
+}
+
+TEST_F(TimeSeriesRepositoryTest, InitSchemaBackfillsLatestTable) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoints({{"a1", 1000, "u1", 1.0}, {"a1", 2000, "u1", 2.0}});
+
+  // As if the points predate the table: a database at version 1
+  db_->execute("DROP TABLE timeseries_latest");
+  db_->execute(
+      "UPDATE schema_versions SET version = 1 WHERE schema = 'timeseries'");
+  TimeSeriesRepository reopened(*db_);
+  reopened.initSchema();
+
+  auto latest = reopened.getLatestPoint("a1", "u1");
+  ASSERT_TRUE(latest.has_value());
+  EXPECT_EQ(latest->timestamp_ms, 2000);
+  EXPECT_DOUBLE_EQ(latest->value, 2.0);
+}
+
+TEST_F(TimeSeriesRepositoryTest, LatestCacheAdvancesWithWrites) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoint({"a1", 2000, "u1", 2.0});
+  ASSERT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 2000);
+
+  repo_->addPoint({"a1", 3000, "u1", 3.0});
+  repo_->addPoint({"a1", 1000, "u1", 1.0});
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 3000);
+
+  auto many = repo_->getLatestPoints({"a1"}, "u1");
+  ASSERT_TRUE(many[0].has_value());
+  EXPECT_DOUBLE_EQ(many[0]->value, 3.0);
+}
+
+TEST_F(TimeSeriesRepositoryTest, InvalidateLatestCacheAfterExternalWrite) {
+  repo_->createAsset({"a1", "Asset 1", "", ""});
+  repo_->createAsset({"a2", "Asset 2", "", ""});
+  repo_->createUnit({"u1", "X", "Unit"});
+  repo_->addPoints({{"a1", 1000, "u1", 1.0}, {"a2", 1000, "u1", 2.0}});
+
+  // a1 cached by the single lookup, a2 by the batch
+  ASSERT_DOUBLE_EQ(repo_->getLatestPoint("a1", "u1")->value, 1.0);
+  ASSERT_TRUE(repo_->getLatestPoints({"a1", "a2"}, "u1")[1].has_value());
+
+  db_->execute("UPDATE timeseries_latest SET value = value + 10");
+  auto cached = repo_->getLatestPoints({"a1", "a2"}, "u1");
+  EXPECT_DOUBLE_EQ(cached[0]->value, 1.0);
+  EXPECT_DOUBLE_EQ(cached[1]->value, 2.0);
+
+  repo_->invalidateLatestCache();
+  auto fresh = repo_->getLatestPoints({"a1", "a2"}, "u1");
+  EXPECT_DOUBLE_EQ(fresh[0]->value, 11.0);
+  EXPECT_DOUBLE_EQ(fresh[1]->value, 12.0);
+}
+
 TEST_F(TimeSeriesRepositoryTest, DeletePointsRange) {
   repo_->createAsset({"a1", "Asset", "", ""});
   repo_->createUnit({"u1", "X", "Unit"});
@@ -376,6 +899,95 @@ TEST_F(TimeSeriesRepositoryTest, DeleteAllPoints) {
   EXPECT_TRUE(points.empty());
 }
 
+// ============================================================
+// Allocation Budgets
+// ============================================================
+
+// Ids past the small-string buffer, so each copy of one allocates: a
+// point owns its asset and unit id, which is two allocations a row
+constexpr const char* kLongAsset = "ISIN-DE000BASF111-XETRA";
+constexpr const char* kLongUnit = "EUR-per-share-consolidated";
+constexpr int kBudgetRows = 1000;
+
+// A unit id that still fits the compact point's inline UnitCode
+constexpr const char* kCompactUnit = "EUR-per-share";
+
+void AddLongSeries(TimeSeriesRepository& repo,
+                   const char* unit_id = kLongUnit) {
+  repo.createAsset({kLongAsset, "BASF", "", ""});
+  repo.createUnit({unit_id, "EUR", "Euro"});
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < kBudgetRows; ++i) {
+    points.push_back({kLongAsset, i * 1000, unit_id, 1.0 + i});
+  }
+  repo.addPoints(points);
+}
+
+TEST_F(TimeSeriesRepositoryTest, GetPointsAllocatesOnlyTheIdsOfEachRow) {
+  AddLongSeries(*repo_);
+  repo_->getPoints(kLongAsset, 0, kBudgetRows * 1000);  // warms the caches
+
+  // The ids, plus preparing the statement and growing the vectors
+  AllocCounter::AllocationScope scope;
+  const auto points = repo_->getPoints(kLongAsset, 0, kBudgetRows * 1000);
+  const auto stats = scope.stats();
+  ASSERT_EQ(points.size(), static_cast<size_t>(kBudgetRows));
+  EXPECT_TRUE(AllocCounter::withinBudget(stats, kBudgetRows, 2, 128));
+
+  scope.reset();
+  const auto filtered =
+      repo_->getPoints(kLongAsset, kLongUnit, 0, kBudgetRows * 1000);
+  ASSERT_EQ(filtered.size(), static_cast<size_t>(kBudgetRows));
+  EXPECT_TRUE(AllocCounter::withinBudget(scope.stats(), kBudgetRows, 2, 128));
+}
+
+TEST(TimeSeriesChunkAllocationTest, GetPointsAllocatesOnlyTheIdsOfEachRow) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Chunks;
+  TimeSeriesRepository repo(db, options);
+  repo.initSchema();
+  AddLongSeries(repo);
+  repo.getPoints(kLongAsset, 0, kBudgetRows * 1000);
+
+  // Decoding a block allocates per block, not per sample
+  AllocCounter::AllocationScope scope;
+  const auto points = repo.getPoints(kLongAsset, 0, kBudgetRows * 1000);
+  const auto stats = scope.stats();
+  ASSERT_EQ(points.size(), static_cast<size_t>(kBudgetRows));
+  EXPECT_TRUE(AllocCounter::withinBudget(stats, kBudgetRows, 2, 64));
+}
+
+TEST_F(TimeSeriesRepositoryTest, GetCompactPointsAllocatesNothingPerRow) {
+  AddLongSeries(*repo_, kCompactUnit);
+  repo_->getCompactPoints(kLongAsset, 0, kBudgetRows * 1000);
+
+  // Preparing the statement and growing the vectors
+  AllocCounter::AllocationScope scope;
+  const auto series =
+      repo_->getCompactPoints(kLongAsset, 0, kBudgetRows * 1000);
+  const auto stats = scope.stats();
+  ASSERT_EQ(series.points.size(), static_cast<size_t>(kBudgetRows));
+  EXPECT_EQ(series.points.back().unit_id.view(), kCompactUnit);
+  EXPECT_TRUE(AllocCounter::withinBudget(stats, kBudgetRows, 0, 128));
+}
+
+TEST(TimeSeriesChunkAllocationTest, GetCompactPointsAllocatesNothingPerRow) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Chunks;
+  TimeSeriesRepository repo(db, options);
+  repo.initSchema();
+  AddLongSeries(repo, kCompactUnit);
+  repo.getCompactPoints(kLongAsset, 0, kBudgetRows * 1000);
+
+  AllocCounter::AllocationScope scope;
+  const auto series = repo.getCompactPoints(kLongAsset, 0, kBudgetRows * 1000);
+  const auto stats = scope.stats();
+  ASSERT_EQ(series.points.size(), static_cast<size_t>(kBudgetRows));
+  EXPECT_TRUE(AllocCounter::withinBudget(stats, kBudgetRows, 0, 64));
+}
+
 // ============================================================
 // Unit Conversion Utility
 // ============================================================
@@ -423,6 +1035,80 @@ TEST_F(TimeSeriesRepositoryTest, ConvertReverseZeroFactor) {
   EXPECT_FALSE(result.has_value());  // Can't divide by zero
 }
 
+TEST_F(TimeSeriesRepositoryTest, ConvertTransitive) {
+  repo_->createUnit({"EUR", "€", "Euro"});
+  repo_->createUnit({"USD", "$", "US Dollar"});
+  repo_->createUnit({"CHF", "Fr", "Swiss Franc"});
+  repo_->createConversion({"EUR", "USD", 1.10});
+  repo_->createConversion({"USD", "CHF", 0.90});
+
+  auto result = repo_->convert(100.0, "EUR", "CHF");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_DOUBLE_EQ(*result, 100.0 * 1.10 * 0.90);
+}
+
+TEST_F(TimeSeriesRepositoryTest, ConvertSeesConversionWrites) {
+  repo_->createUnit({"A", "a", "A"});
+  repo_->createUnit({"B", "b", "B"});
+  repo_->createUnit({"C", "c", "C"});
+  EXPECT_FALSE(repo_->convert(1.0, "A", "B").has_value());  // graph loaded
+
+  repo_->createConversion({"A", "B", 2.0});
+  EXPECT_DOUBLE_EQ(*repo_->convert(1.0, "A", "B"), 2.0);
+
+  repo_->updateConversion({"A", "B", 3.0});
+  EXPECT_DOUBLE_EQ(*repo_->convert(1.0, "A", "B"), 3.0);
+
+  repo_->deleteConversion("A", "B");
+  EXPECT_FALSE(repo_->convert(1.0, "A", "B").has_value());
+
+  // Cascade through deleteUnit
+  repo_->createConversion({"A", "C", 4.0});
+  EXPECT_DOUBLE_EQ(*repo_->convert(1.0, "A", "C"), 4.0);
+  repo_->deleteUnit("C");
+  EXPECT_FALSE(repo_->convert(1.0, "A", "C").has_value());
+}
+
+TEST_F(TimeSeriesRepositoryTest, InvalidateConversionsAfterExternalWrite) {
+  repo_->createUnit({"A", "a", "A"});
+  repo_->createUnit({"B", "b", "B"});
+  repo_->createConversion({"A", "B", 2.0});
+  EXPECT_DOUBLE_EQ(*repo_->convert(1.0, "A", "B"), 2.0);
+
+  db_->execute("UPDATE unit_conversions SET factor = 5.0");
+  EXPECT_DOUBLE_EQ(*repo_->convert(1.0, "A", "B"), 2.0);  // cached
+
+  repo_->invalidateConversions();
+  EXPECT_DOUBLE_EQ(*repo_->convert(1.0, "A", "B"), 5.0);
+}
+
+TEST_F(TimeSeriesRepositoryTest, ConvertSeries) {
+  repo_->createUnit({"EUR", "€", "Euro"});
+  repo_->createUnit({"USD", "$", "US Dollar"});
+  repo_->createUnit({"CHF", "Fr", "Swiss Franc"});
+  repo_->createConversion({"EUR", "USD", 2.0});
+  repo_->createConversion({"USD", "CHF", 0.5});
+
+  std::vector<double> values = {1.0, 2.0, 3.0, 4.0, 5.0};
+  ASSERT_TRUE(
+      repo_->convertSeries(values.data(), values.size(), "CHF", "USD"));
+  EXPECT_EQ(values, (std::vector<double>{2.0, 4.0, 6.0, 8.0, 10.0}));
+
+  ASSERT_TRUE(
+      repo_->convertSeries(values.data(), values.size(), "USD", "EUR"));
+  EXPECT_EQ(values, (std::vector<double>{1.0, 2.0, 3.0, 4.0, 5.0}));
+}
+
+TEST_F(TimeSeriesRepositoryTest, ConvertSeriesWithoutPathLeavesValues) {
+  repo_->createUnit({"A", "a", "A"});
+  repo_->createUnit({"B", "b", "B"});
+
+  std::vector<double> values = {1.0, 2.0};
+  EXPECT_FALSE(repo_->convertSeries(values.data(), values.size(), "A", "B"));
+  EXPECT_EQ(values, (std::vector<double>{1.0, 2.0}));
+  EXPECT_TRUE(repo_->convertSeries(nullptr, 0, "A", "A"));
+}
+
 // ============================================================
 // Time Series - Synthetic Asset for Dynamic Conversions
 // ============================================================
@@ -440,6 +1126,330 @@ TEST_F(TimeSeriesRepositoryTest, SyntheticAssetForDynamicConversion) {
   EXPECT_DOUBLE_EQ(latest->value, 1.10);
 }
 
+// ============================================================
+// Append-Only Ingest
+// ============================================================
+class AppendIngestTest : public TimeSeriesRepositoryTest {
+ protected:
+  void SetUp() override {
+    TimeSeriesRepositoryTest::SetUp();
+    TimeSeriesOptions options;
+    options.appendIngest = true;
+    repo_ = std::make_unique<TimeSeriesRepository>(*db_, options);
+    repo_->createAsset({"a1", "Asset", "", ""});
+    repo_->createUnit({"u1", "X", "Unit X"});
+    repo_->createUnit({"u2", "Y", "Unit Y"});
+  }
+};
+
+TEST_F(AppendIngestTest, MonotonicBatchesTakeTheFastPath) {
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < 50; ++i) {
+    points.push_back({"a1", i * 1000, "u1", static_cast<double>(i)});
+    points.push_back({"a1", i * 1000, "u2", static_cast<double>(-i)});
+  }
+  repo_->addPoints(points);
+  repo_->addPoint({"a1", 50000, "u1", 50.0});
+
+  auto stats = repo_->ingestStats();
+  EXPECT_EQ(stats.appended, 101u);
+  EXPECT_EQ(stats.upserted, 0u);
+  EXPECT_EQ(repo_->getPoints("a1", 0, 100000).size(), 101u);
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 50000);
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u2")->timestamp_ms, 49000);
+}
+
+TEST_F(AppendIngestTest, UnsortedBatchIsSortedFirst) {
+  repo_->addPoints({{"a1", 3000, "u1", 3.0},
+                    {"a1", 1000, "u2", 1.0},
+                    {"a1", 1000, "u1", 1.0},
+                    {"a1", 2000, "u1", 2.0}});
+
+  EXPECT_EQ(repo_->ingestStats().appended, 4u);
+  auto points = repo_->getPoints("a1", "u1", 0, 5000);
+  ASSERT_EQ(points.size(), 3u);
+  EXPECT_DOUBLE_EQ(points[2].value, 3.0);
+}
+
+TEST_F(AppendIngestTest, OutOfOrderPointsAreUpserted) {
+  repo_->addPoints({{"a1", 1000, "u1", 1.0}, {"a1", 5000, "u1", 5.0}});
+
+  // 3000 is behind the mark, 6000 is not; 7000 repeats in the batch
+  repo_->addPoints({{"a1", 3000, "u1", 3.0},
+                    {"a1", 5000, "u1", 50.0},
+                    {"a1", 6000, "u1", 6.0},
+                    {"a1", 7000, "u1", 7.0},
+                    {"a1", 7000, "u1", 70.0}});
+
+  auto stats = repo_->ingestStats();
+  EXPECT_EQ(stats.appended, 4u);
+  EXPECT_EQ(stats.upserted, 3u);
+  auto points = repo_->getPoints("a1", "u1", 0, 10000);
+  ASSERT_EQ(points.size(), 5u);
+  EXPECT_DOUBLE_EQ(points[1].value, 3.0);
+  EXPECT_DOUBLE_EQ(points[2].value, 50.0);
+  EXPECT_DOUBLE_EQ(points[4].value, 70.0);
+  EXPECT_DOUBLE_EQ(repo_->getLatestPoint("a1", "u1")->value, 70.0);
+}
+
+TEST_F(AppendIngestTest, PointUnknownToTheMarkFallsBack) {
+  repo_->addPoint({"a1", 1000, "u1", 1.0});
+  // Behind the repository's back: neither the cache nor
+  // timeseries_latest sees it
+  auto stmt = db_->prepare(
+      "INSERT INTO timeseries_points (asset_key, unit_key, timestamp_ms, "
+      "value) SELECT asset_key, unit_key, 2000, 2.0 FROM timeseries_points");
+  stmt->executeInsert();
+
+  repo_->addPoint({"a1", 2000, "u1", 20.0});
+
+  EXPECT_EQ(repo_->ingestStats().upserted, 1u);
+  auto points = repo_->getPoints("a1", "u1", 0, 5000);
+  ASSERT_EQ(points.size(), 2u);
+  EXPECT_DOUBLE_EQ(points[1].value, 20.0);
+}
+
+TEST_F(TimeSeriesRepositoryTest, DefaultIngestCountsUpserts) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit X"});
+  repo_->addPoints({{"a1", 1000, "u1", 1.0}, {"a1", 2000, "u1", 2.0}});
+
+  EXPECT_EQ(repo_->ingestStats().appended, 0u);
+  EXPECT_EQ(repo_->ingestStats().upserted, 2u);
+}
+
+// ============================================================
+// Point Cache
+// ============================================================
+class PointCacheRepositoryTest : public TimeSeriesRepositoryTest {
+ protected:
+  void SetUp() override {
+    TimeSeriesRepositoryTest::SetUp();
+    repo_ = makeRepository(*db_, PointStorage::Rows);
+  }
+
+  static std::unique_ptr<TimeSeriesRepository> makeRepository(
+      IDatabase& db, PointStorage storage, size_t series_points = 100) {
+    TimeSeriesOptions options;
+    options.storage = storage;
+    options.pointCacheBytes = 1 << 20;
+    options.pointCacheSeriesPoints = series_points;
+    auto repo = std::make_unique<TimeSeriesRepository>(db, options);
+    repo->initSchema();
+    repo->createAsset({"a1", "Asset", "", ""});
+    repo->createAsset({"a2", "Asset", "", ""});
+    repo->createUnit({"u1", "X", "Unit X"});
+    return repo;
+  }
+
+  static void addSeries(TimeSeriesRepository& repo, const std::string& asset,
+                        int64_t from, int64_t to) {
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (int64_t ts = from; ts <= to; ts += 1000) {
+      points.push_back({asset, ts, "u1", static_cast<double>(ts)});
+    }
+    repo.addPoints(points);
+  }
+};
+
+TEST_F(PointCacheRepositoryTest, RecentReadsAreServedFromTheCache) {
+  addSeries(*repo_, "a1", 0, 199000);
+
+  // Reaches the newest point: seeds the newest 100, from 100000
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 0, 300000).size(), 200u);
+  db_->enableProfiling(true);
+  auto points = repo_->getPoints("a1", "u1", 100000, 120500);
+  ASSERT_EQ(points.size(), 21u);
+  EXPECT_EQ(points.front().timestamp_ms, 100000);
+  EXPECT_EQ(points.back().timestamp_ms, 120000);
+  auto columns = repo_->getPointColumns("a1", "u1", 198000, 500000);
+  ASSERT_EQ(columns.rowCount, 2u);
+  EXPECT_EQ(columns.columns[0].int64s[1], 199000);
+  EXPECT_DOUBLE_EQ(columns.columns[1].doubles[0], 198000.0);
+  EXPECT_TRUE(db_->queryProfile().empty());
+
+  // Older than the window: a miss read from storage
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 99000, 101000).size(), 3u);
+  EXPECT_FALSE(db_->queryProfile().empty());
+  auto stats = repo_->pointCacheStats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.seeded, 1u);
+}
+
+TEST_F(PointCacheRepositoryTest, WritesKeepTheCacheCurrent) {
+  addSeries(*repo_, "a1", 0, 99000);
+  repo_->getPoints("a1", "u1", 0, 99000);  // all 100
+
+  // Appends slide the window; a replacement updates in place
+  addSeries(*repo_, "a1", 100000, 104000);
+  repo_->addPoint({"a1", 50000, "u1", -1.0});
+  auto points = repo_->getPoints("a1", "u1", 5000, 200000);
+  ASSERT_EQ(points.size(), 100u);
+  EXPECT_EQ(points.front().timestamp_ms, 5000);
+  EXPECT_DOUBLE_EQ(points[45].value, -1.0);
+  EXPECT_EQ(points.back().timestamp_ms, 104000);
+  EXPECT_EQ(repo_->pointCacheStats().hits, 1u);
+
+  // A new point inside the window drops the series; a read reaching the
+  // newest point seeds it again
+  repo_->addPoint({"a1", 50500, "u1", 0.5});
+  EXPECT_EQ(repo_->pointCacheStats().dropped, 1u);
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 50000, 200000).size(), 56u);
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 50000, 51000).size(), 3u);
+  EXPECT_EQ(repo_->pointCacheStats().hits, 2u);
+
+  // Deletes drop the asset's series
+  repo_->deletePoints("a1", 60000, 70000);
+  EXPECT_EQ(repo_->pointCacheStats().series, 0u);
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 55000, 75000).size(), 10u);
+}
+
+TEST_F(PointCacheRepositoryTest, CachesOnlySeeCommittedWrites) {
+  addSeries(*repo_, "a1", 0, 99000);
+  repo_->getPoints("a1", "u1", 0, 99000);
+  ASSERT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 99000);
+
+  // Cached by reads inside the transaction, then rolled back
+  db_->beginTransaction();
+  addSeries(*repo_, "a1", 100000, 104000);
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 104000);
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 90000, 200000).size(), 15u);
+  db_->rollback();
+
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 99000);
+  auto points = repo_->getPoints("a1", "u1", 90000, 200000);
+  ASSERT_EQ(points.size(), 10u);
+  EXPECT_EQ(points.back().timestamp_ms, 99000);
+
+  // Committed: what the transaction cached stays, and is current
+  db_->beginTransaction();
+  addSeries(*repo_, "a1", 100000, 101000);
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 0, 200000).size(), 102u);
+  db_->commit();
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 101000);
+  const uint64_t hits = repo_->pointCacheStats().hits;
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 95000, 200000).size(), 7u);
+  EXPECT_EQ(repo_->pointCacheStats().hits, hits + 1);
+}
+
+TEST_F(PointCacheRepositoryTest, BudgetEvictsTheLeastRecentlyReadSeries) {
+  TimeSeriesOptions options;
+  options.pointCacheBytes = 2 * 16 * 16;  // two minimal series
+  options.pointCacheSeriesPoints = 16;
+  TimeSeriesRepository repo(*db_, options);
+  repo.createAsset({"a3", "Asset", "", ""});
+  for (const char* asset : {"a1", "a2", "a3"}) {
+    addSeries(repo, asset, 0, 9000);
+  }
+
+  repo.getPoints("a1", "u1", 0, 9000);
+  repo.getPoints("a2", "u1", 0, 9000);
+  repo.getPoints("a1", "u1", 0, 9000);  // a2 is now the oldest
+  repo.getPoints("a3", "u1", 0, 9000);
+  auto stats = repo.pointCacheStats();
+  EXPECT_EQ(stats.series, 2u);
+  EXPECT_EQ(stats.evicted, 1u);
+  EXPECT_LE(stats.bytes, options.pointCacheBytes);
+
+  repo.getPoints("a1", "u1", 0, 9000);
+  repo.getPoints("a3", "u1", 0, 9000);
+  EXPECT_EQ(repo.pointCacheStats().hits, 3u);
+}
+
+TEST_F(PointCacheRepositoryTest, WorksWithChunkStorage) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  auto repo = makeRepository(db, PointStorage::Chunks, 10);
+  addSeries(*repo, "a1", 0, 19000);
+
+  EXPECT_EQ(repo->getPoints("a1", "u1", 15000, 19000).size(), 5u);
+  addSeries(*repo, "a1", 20000, 22000);
+  EXPECT_EQ(repo->getPoints("a1", "u1", 15000, 30000).size(), 8u);
+
+  // Past ten points the ring wraps and the window starts after 16000
+  addSeries(*repo, "a1", 23000, 26000);
+  auto points = repo->getPoints("a1", "u1", 16500, 30000);
+  ASSERT_EQ(points.size(), 10u);
+  EXPECT_EQ(points.front().timestamp_ms, 17000);
+  EXPECT_EQ(points.back().timestamp_ms, 26000);
+  EXPECT_EQ(repo->pointCacheStats().hits, 2u);
+  EXPECT_EQ(repo->getPoints("a1", "u1", 16000, 30000).size(), 11u);
+  EXPECT_EQ(repo->pointCacheStats().misses, 2u);
+
+  repo->invalidateLatestCache();
+  EXPECT_EQ(repo->pointCacheStats().series, 0u);
+}
+
+// ============================================================
+// Bounded Expiry and Rollups
+// ============================================================
+TEST_F(TimeSeriesRepositoryTest, ExpirePointsDeletesOldestInBatches) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit X"});
+  repo_->createUnit({"u2", "Y", "Unit Y"});
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < 10; ++i) {
+    points.push_back({"a1", i * 1000, "u1", static_cast<double>(i)});
+    points.push_back({"a1", i * 1000, "u2", static_cast<double>(-i)});
+  }
+  repo_->addPoints(points);
+
+  EXPECT_EQ(repo_->expirePoints("a1", 5000, 4), 4u);
+  EXPECT_EQ(repo_->getPoints("a1", 0, 10000).front().timestamp_ms, 2000);
+  // The third point is at 3000, so both units at 3000 go
+  EXPECT_EQ(repo_->expirePoints("a1", 5000, 3), 4u);
+  EXPECT_EQ(repo_->expirePoints("a1", 5000, 4), 2u);
+  EXPECT_EQ(repo_->expirePoints("a1", 5000, 4), 0u);
+
+  auto left = repo_->getPoints("a1", 0, 10000);
+  ASSERT_EQ(left.size(), 10u);
+  EXPECT_EQ(left.front().timestamp_ms, 5000);
+  EXPECT_EQ(repo_->getLatestPoint("a1", "u1")->timestamp_ms, 9000);
+
+  EXPECT_EQ(repo_->expirePoints("a1", 100000, 100), 10u);
+  EXPECT_FALSE(repo_->getLatestPoint("a1", "u1").has_value());
+  EXPECT_EQ(repo_->expirePoints("other", 100000, 100), 0u);
+
+  EXPECT_THROW(repo_->expirePoints("a1", 0, 0), std::invalid_argument);
+  EXPECT_THROW(repo_->expirePoints("a1", 0, 1, -1), std::invalid_argument);
+}
+
+TEST_F(TimeSeriesRepositoryTest, ExpirePointsRollsUpBeforeDeleting) {
+  repo_->createAsset({"a1", "Asset", "", ""});
+  repo_->createUnit({"u1", "X", "Unit X"});
+  repo_->createUnit({"u2", "Y", "Unit Y"});
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < 20; ++i) {
+    points.push_back({"a1", i * 1000, "u1", static_cast<double>(i % 7)});
+    points.push_back({"a1", i * 1000, "u2", 1.0});
+  }
+  repo_->addPoints(points);
+  auto expected = repo_->aggregate("a1", "u1", 0, 11999, 4000);
+
+  // Batches of 5 split the 4s buckets, so rollups merge across steps
+  while (repo_->expirePoints("a1", 12000, 5, 4000) > 0) {
+  }
+
+  EXPECT_EQ(repo_->getPoints("a1", 0, 20000).size(), 16u);
+  auto rollups = repo_->getRollups("a1", "u1", 4000, 0, 20000);
+  ASSERT_EQ(rollups.size(), expected.size());
+  for (size_t i = 0; i < rollups.size(); ++i) {
+    EXPECT_EQ(rollups[i].bucket_start_ms, expected[i].bucket_start_ms);
+    EXPECT_DOUBLE_EQ(rollups[i].open, expected[i].open);
+    EXPECT_DOUBLE_EQ(rollups[i].high, expected[i].high);
+    EXPECT_DOUBLE_EQ(rollups[i].low, expected[i].low);
+    EXPECT_DOUBLE_EQ(rollups[i].close, expected[i].close);
+    EXPECT_DOUBLE_EQ(rollups[i].avg, expected[i].avg);
+    EXPECT_EQ(rollups[i].count, expected[i].count);
+  }
+  EXPECT_EQ(repo_->getRollups("a1", "u2", 4000, 0, 20000).size(), 3u);
+  EXPECT_TRUE(repo_->getRollups("a1", "u1", 1000, 0, 20000).empty());
+
+  repo_->deleteAsset("a1");
+  auto count = db_->prepare("SELECT COUNT(*) FROM timeseries_rollups");
+  EXPECT_EQ(count->fetchScalar<int64_t>(), 0);
+}
+
 // ============================================================
 // Bulk Time Series Performance
 // ============================================================
@@ -459,5 +1469,707 @@ TEST_F(TimeSeriesRepositoryTest, BulkInsertPerformance) {
   EXPECT_EQ(retrieved.size(), 10000u);
 }
 
+// ============================================================
+// Compressed Chunk Storage
+// ============================================================
+class ChunkedTimeSeriesRepositoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    TimeSeriesOptions options;
+    options.storage = PointStorage::Chunks;
+    options.chunkWidth = std::chrono::seconds(10);
+    repo_ = std::make_unique<TimeSeriesRepository>(*db_, options);
+    repo_->initSchema();
+    repo_->createAsset({"a1", "Asset", "", ""});
+    repo_->createUnit({"u1", "X", "Unit X"});
+    repo_->createUnit({"u2", "Y", "Unit Y"});
+  }
+
+  // Points every second over [0, count) seconds
+  void addSeries(const std::string& unit_id, int64_t count) {
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (int64_t i = 0; i < count; ++i) {
+      points.push_back({"a1", i * 1000, unit_id, static_cast<double>(i)});
+    }
+    repo_->addPoints(points);
+  }
+
+  int64_t chunkCount() {
+    auto stmt = db_->prepare("SELECT COUNT(*) FROM timeseries_chunks");
+    return stmt->fetchScalar<int64_t>().value_or(-1);
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, RangeSpansChunks) {
+  addSeries("u1", 35);
+  EXPECT_EQ(chunkCount(), 4);
+
+  auto points = repo_->getPoints("a1", "u1", 8000, 21000);
+  ASSERT_EQ(points.size(), 14u);
+  EXPECT_EQ(points.front().timestamp_ms, 8000);
+  EXPECT_EQ(points.back().timestamp_ms, 21000);
+  EXPECT_EQ(points.back().unit_id, "u1");
+  EXPECT_DOUBLE_EQ(points.back().value, 21.0);
+
+  EXPECT_TRUE(repo_->getPoints("a1", "u1", 21000, 8000).empty());
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, AddPointMergesIntoChunk) {
+  addSeries("u1", 5);
+  repo_->addPoint({"a1", 2000, "u1", 99.0});  // replaces
+  repo_->addPoint({"a1", 2500, "u1", 2.5});   // inserts between
+
+  auto points = repo_->getPoints("a1", "u1", 0, 10000);
+  ASSERT_EQ(points.size(), 6u);
+  EXPECT_DOUBLE_EQ(points[2].value, 99.0);
+  EXPECT_EQ(points[3].timestamp_ms, 2500);
+  EXPECT_EQ(chunkCount(), 1);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, GetPointsAcrossUnits) {
+  repo_->addPoints({{"a1", 2000, "u2", 2.0}, {"a1", 1000, "u1", 1.0},
+                    {"a1", 15000, "u1", 15.0}});
+
+  auto points = repo_->getPoints("a1", 0, 20000);
+  ASSERT_EQ(points.size(), 3u);
+  EXPECT_EQ(points[0].unit_id, "u1");
+  EXPECT_EQ(points[1].unit_id, "u2");
+  EXPECT_EQ(points[2].timestamp_ms, 15000);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, LatestPoints) {
+  addSeries("u1", 25);
+  repo_->addPoint({"a1", 12000, "u2", -1.0});
+
+  auto latest = repo_->getLatestPoint("a1");
+  ASSERT_TRUE(latest.has_value());
+  EXPECT_EQ(latest->timestamp_ms, 24000);
+  EXPECT_EQ(latest->unit_id, "u1");
+
+  latest = repo_->getLatestPoint("a1", "u2");
+  ASSERT_TRUE(latest.has_value());
+  EXPECT_DOUBLE_EQ(latest->value, -1.0);
+
+  auto many = repo_->getLatestPoints({"a1", "missing"}, "u1");
+  ASSERT_EQ(many.size(), 2u);
+  ASSERT_TRUE(many[0].has_value());
+  EXPECT_EQ(many[0]->timestamp_ms, 24000);
+  EXPECT_FALSE(many[1].has_value());
+
+  many = repo_->getLatestPoints({"a1", "missing"});
+  ASSERT_TRUE(many[0].has_value());
+  EXPECT_EQ(many[0]->unit_id, "u1");
+  EXPECT_FALSE(many[1].has_value());
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, PointColumns) {
+  addSeries("u1", 30);
+
+  auto columns = repo_->getPointColumns("a1", "u1", 5000, 14000);
+  ASSERT_EQ(columns.rowCount, 10u);
+  ASSERT_EQ(columns.columns.size(), 2u);
+  EXPECT_EQ(columns.columns[0].int64s.front(), 5000);
+  EXPECT_DOUBLE_EQ(columns.columns[1].doubles.back(), 14.0);
+  EXPECT_FALSE(columns.columns[1].isNull(9));
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, DeletePointsTrimsAndDropsChunks) {
+  addSeries("u1", 30);
+  addSeries("u2", 30);
+
+  // Drops [10s, 20s) entirely, trims the chunks on either side
+  repo_->deletePoints("a1", 5000, 24000);
+  EXPECT_EQ(chunkCount(), 4);
+
+  auto points = repo_->getPoints("a1", "u1", 0, 30000);
+  ASSERT_EQ(points.size(), 10u);
+  EXPECT_EQ(points[4].timestamp_ms, 4000);
+  EXPECT_EQ(points[5].timestamp_ms, 25000);
+
+  repo_->deletePoints("a1", 25000, 29000);
+  EXPECT_EQ(chunkCount(), 2);
+
+  repo_->deleteAllPoints("a1");
+  EXPECT_EQ(chunkCount(), 0);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, DeleteCascadesToChunks) {
+  addSeries("u1", 20);
+  addSeries("u2", 20);
+
+  repo_->deleteUnit("u2");
+  EXPECT_EQ(chunkCount(), 2);
+  repo_->deleteAsset("a1");
+  EXPECT_EQ(chunkCount(), 0);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, ChunkWidthIsFixedOnceCreated) {
+  addSeries("u1", 20);
+
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Chunks;
+  options.chunkWidth = std::chrono::hours(24);
+  TimeSeriesRepository reopened(*db_, options);
+  reopened.initSchema();
+
+  EXPECT_EQ(reopened.getPoints("a1", "u1", 9000, 10000).size(), 2u);
+  reopened.addPoint({"a1", 25000, "u1", 25.0});
+  EXPECT_EQ(chunkCount(), 3);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, AggregateStreamsChunks) {
+  addSeries("u1", 35);
+
+  auto buckets = repo_->aggregate("a1", "u1", 5000, 34000, 15000);
+  ASSERT_EQ(buckets.size(), 3u);
+  EXPECT_EQ(buckets[0].bucket_start_ms, 0);
+  EXPECT_EQ(buckets[0].count, 10);
+  EXPECT_DOUBLE_EQ(buckets[0].open, 5.0);
+  EXPECT_EQ(buckets[1].count, 15);
+  EXPECT_DOUBLE_EQ(buckets[1].avg, 22.0);
+  EXPECT_DOUBLE_EQ(buckets[2].high, 34.0);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, ScanPointsStreamsWindows) {
+  addSeries("u1", 35);
+  addSeries("u2", 20);
+
+  std::vector<size_t> sizes;
+  std::vector<Entities::TimeSeriesPoint> scanned;
+  size_t visited = repo_->scanPoints(
+      "a1", 5000, 30000,
+      [&](const std::vector<Entities::TimeSeriesPoint>& batch) {
+        sizes.push_back(batch.size());
+        scanned.insert(scanned.end(), batch.begin(), batch.end());
+        return true;
+      },
+      8);
+
+  auto expected = repo_->getPoints("a1", 5000, 30000);
+  EXPECT_EQ(visited, expected.size());
+  EXPECT_EQ(sizes, (std::vector<size_t>{8, 8, 8, 8, 8, 1}));  // 26 + 15
+  ASSERT_EQ(scanned.size(), expected.size());
+  for (size_t i = 0; i < scanned.size(); ++i) {
+    EXPECT_EQ(scanned[i].timestamp_ms, expected[i].timestamp_ms) << i;
+    EXPECT_EQ(scanned[i].unit_id, expected[i].unit_id) << i;
+  }
+
+  int calls = 0;
+  visited = repo_->scanPoints(
+      "a1", 0, 40000,
+      [&](const std::vector<Entities::TimeSeriesPoint>&) {
+        ++calls;
+        return false;
+      },
+      8);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(visited, 8u);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, SeriesCursorAcrossChunks) {
+  addSeries("u1", 35);
+  addSeries("u2", 20);
+
+  auto cursor = repo_->openSeriesCursor("a1", "u1", 5000, 30000, 4);
+  std::vector<int64_t> timestamps;
+  int64_t ts = 0;
+  double value = 0.0;
+  while (cursor.next(ts, value)) {
+    timestamps.push_back(ts);
+  }
+  ASSERT_EQ(timestamps.size(), 26u);
+  for (size_t i = 0; i < timestamps.size(); ++i) {
+    EXPECT_EQ(timestamps[i], 5000 + static_cast<int64_t>(i) * 1000);
+  }
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, StoresFarFewerBytesThanRows) {
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (int64_t i = 0; i < 3600; ++i) {
+    points.push_back({"a1", i * 1000, "u1", 20.0 + (i / 60) * 0.25});
+  }
+  repo_->addPoints(points);
+
+  auto stmt =
+      db_->prepare("SELECT SUM(LENGTH(data)) FROM timeseries_chunks");
+  auto bytes = stmt->fetchScalar<int64_t>().value_or(0);
+  EXPECT_GT(bytes, 0);
+  // A row in timeseries_points is two 8-byte keys, a timestamp and a
+  // value before any b-tree overhead
+  EXPECT_LT(bytes * 10, static_cast<int64_t>(points.size()) * 32);
+}
+
+// ============================================================
+// Time-Partitioned Storage
+// ============================================================
+constexpr int64_t kDec31LastMs = 1704067199999;  // 2023-12-31T23:59:59.999Z
+constexpr int64_t kJan1Ms = 1704067200000;
+constexpr int64_t kJan15Ms = 1705276800000;
+constexpr int64_t kFeb1Ms = 1706745600000;
+constexpr int64_t kFeb10Ms = 1707523200000;
+constexpr int64_t kMar1Ms = 1709251200000;
+constexpr int64_t kMar5Ms = 1709596800000;
+constexpr int64_t kApr1Ms = 1711929600000;
+
+class PartitionedTimeSeriesRepositoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    TimeSeriesOptions options;
+    options.storage = PointStorage::Partitions;
+    options.partitionPeriod = PartitionPeriod::Month;
+    repo_ = std::make_unique<TimeSeriesRepository>(*db_, options);
+    repo_->initSchema();
+    repo_->createAsset({"a1", "Asset", "", ""});
+    repo_->createUnit({"u1", "X", "Unit X"});
+    repo_->createUnit({"u2", "Y", "Unit Y"});
+  }
+
+  // One point per unit at each timestamp, spanning Dec 2023 to Mar 2024
+  void addQuarter() {
+    std::vector<Entities::TimeSeriesPoint> points;
+    double value = 0.0;
+    for (int64_t ts : {kDec31LastMs, kJan1Ms, kJan15Ms, kFeb10Ms, kMar5Ms}) {
+      points.push_back({"a1", ts, "u1", value});
+      points.push_back({"a1", ts, "u2", -value});
+      value += 1.0;
+    }
+    repo_->addPoints(points);
+  }
+
+  bool tableExists(const std::string& name) {
+    auto stmt = db_->prepare(
+        "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' "
+        "AND name = ?");
+    stmt->bind(1, name);
+    return stmt->fetchScalar<int64_t>().value_or(0) > 0;
+  }
+
+  std::vector<std::string> partitionTables() {
+    std::vector<std::string> tables;
+    for (const auto& partition : repo_->getPartitions()) {
+      tables.push_back(partition.table);
+    }
+    return tables;
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, WritesCreateMonthlyPartitions) {
+  addQuarter();
+
+  auto partitions = repo_->getPartitions();
+  ASSERT_EQ(partitions.size(), 4u);
+  EXPECT_EQ(partitions[0].table, "timeseries_points_202312");
+  EXPECT_EQ(partitions[0].end_ms, kJan1Ms);
+  EXPECT_EQ(partitions[1].table, "timeseries_points_202401");
+  EXPECT_EQ(partitions[1].start_ms, kJan1Ms);
+  EXPECT_EQ(partitions[1].end_ms, kFeb1Ms);
+  EXPECT_EQ(partitions[3].table, "timeseries_points_202403");
+  EXPECT_EQ(partitions[3].end_ms, kApr1Ms);
+  for (const auto& partition : partitions) {
+    EXPECT_TRUE(tableExists(partition.table)) << partition.table;
+  }
+
+  auto stmt = db_->prepare("SELECT COUNT(*) FROM timeseries_points");
+  EXPECT_EQ(stmt->fetchScalar<int64_t>(), 0);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, PreEpochTimestamps) {
+  repo_->addPoint({"a1", -1, "u1", 1.0});
+  repo_->addPoint({"a1", 0, "u1", 2.0});
+
+  EXPECT_EQ(partitionTables(), (std::vector<std::string>{
+                                   "timeseries_points_196912",
+                                   "timeseries_points_197001"}));
+  auto points = repo_->getPoints("a1", "u1", -1000, 1000);
+  ASSERT_EQ(points.size(), 2u);
+  EXPECT_EQ(points[0].timestamp_ms, -1);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, RangesSpanPartitions) {
+  addQuarter();
+
+  auto points = repo_->getPoints("a1", "u1", kDec31LastMs, kFeb10Ms);
+  ASSERT_EQ(points.size(), 4u);
+  EXPECT_EQ(points.front().timestamp_ms, kDec31LastMs);
+  EXPECT_EQ(points.back().timestamp_ms, kFeb10Ms);
+  EXPECT_DOUBLE_EQ(points.back().value, 3.0);
+
+  auto all = repo_->getPoints("a1", kJan15Ms, kMar5Ms);
+  ASSERT_EQ(all.size(), 6u);
+  EXPECT_EQ(all[0].unit_id, "u1");
+  EXPECT_EQ(all[1].unit_id, "u2");
+  EXPECT_EQ(all[5].timestamp_ms, kMar5Ms);
+
+  auto columns = repo_->getPointColumns("a1", "u2", kJan1Ms, kMar1Ms);
+  ASSERT_EQ(columns.rowCount, 3u);
+  EXPECT_DOUBLE_EQ(columns.columns[1].doubles.back(), -3.0);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, RangeTouchesOnlyOverlapping) {
+  addQuarter();
+  // Any read of January would now fail
+  db_->execute("DROP TABLE timeseries_points_202401");
+
+  EXPECT_EQ(repo_->getPoints("a1", "u1", kFeb1Ms, kApr1Ms).size(), 2u);
+  EXPECT_EQ(repo_->getPoints("a1", kFeb10Ms, kMar5Ms).size(), 4u);
+  repo_->deletePoints("a1", kMar1Ms, kApr1Ms);
+  EXPECT_EQ(repo_->getPoints("a1", kFeb1Ms, kApr1Ms).size(), 2u);
+  EXPECT_THROW(repo_->getPoints("a1", "u1", kJan1Ms, kFeb1Ms),
+               Gateways::Database::DatabaseException);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, AddPointReplacesAcrossCalls) {
+  addQuarter();
+  repo_->addPoint({"a1", kJan15Ms, "u1", 42.0});
+
+  auto points = repo_->getPoints("a1", "u1", kJan15Ms, kJan15Ms);
+  ASSERT_EQ(points.size(), 1u);
+  EXPECT_DOUBLE_EQ(points[0].value, 42.0);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, LatestPoints) {
+  addQuarter();
+  repo_->addPoint({"a1", kFeb10Ms + 1, "u1", 9.0});
+  repo_->deletePoints("a1", kMar1Ms, kApr1Ms);
+  repo_->invalidateLatestCache();
+
+  auto latest = repo_->getLatestPoint("a1");
+  ASSERT_TRUE(latest.has_value());
+  EXPECT_EQ(latest->timestamp_ms, kFeb10Ms + 1);
+  EXPECT_EQ(latest->unit_id, "u1");
+
+  latest = repo_->getLatestPoint("a1", "u2");
+  ASSERT_TRUE(latest.has_value());
+  EXPECT_DOUBLE_EQ(latest->value, -3.0);
+
+  auto many = repo_->getLatestPoints({"a1", "missing"}, "u1");
+  ASSERT_EQ(many.size(), 2u);
+  ASSERT_TRUE(many[0].has_value());
+  EXPECT_DOUBLE_EQ(many[0]->value, 9.0);
+  EXPECT_FALSE(many[1].has_value());
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, ScanAndAggregate) {
+  addQuarter();
+
+  std::vector<size_t> sizes;
+  size_t visited = repo_->scanPoints(
+      "a1", kJan1Ms, kMar5Ms,
+      [&](const std::vector<Entities::TimeSeriesPoint>& batch) {
+        sizes.push_back(batch.size());
+        return true;
+      },
+      3);
+  EXPECT_EQ(visited, 8u);
+  EXPECT_EQ(sizes, (std::vector<size_t>{3, 3, 2}));
+
+  constexpr int64_t kDayMs = 86400000;
+  auto buckets =
+      repo_->aggregate("a1", "u1", kDec31LastMs, kMar5Ms, 31 * kDayMs);
+  ASSERT_FALSE(buckets.empty());
+  int64_t count = 0;
+  for (const auto& bucket : buckets) {
+    count += bucket.count;
+  }
+  EXPECT_EQ(count, 5);
+  EXPECT_DOUBLE_EQ(buckets.back().close, 4.0);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, DropPartitionsBefore) {
+  addQuarter();
+
+  // February ends after the cutoff, so it stays
+  EXPECT_EQ(repo_->dropPartitionsBefore(kFeb10Ms), 2u);
+  EXPECT_EQ(partitionTables(), (std::vector<std::string>{
+                                   "timeseries_points_202402",
+                                   "timeseries_points_202403"}));
+  EXPECT_FALSE(tableExists("timeseries_points_202312"));
+  EXPECT_FALSE(tableExists("timeseries_points_202401"));
+  EXPECT_TRUE(repo_->getPoints("a1", kDec31LastMs, kFeb1Ms).empty());
+  EXPECT_EQ(repo_->getPoints("a1", "u1", 0, kApr1Ms).size(), 2u);
+
+  EXPECT_EQ(repo_->dropPartitionsBefore(kFeb10Ms), 0u);
+  EXPECT_EQ(repo_->dropPartitionsBefore(kApr1Ms), 2u);
+  EXPECT_FALSE(repo_->getLatestPoint("a1", "u1").has_value());
+
+  // A dropped period is recreated by the next write into it
+  repo_->addPoint({"a1", kJan15Ms, "u1", 1.0});
+  EXPECT_EQ(partitionTables(),
+            (std::vector<std::string>{"timeseries_points_202401"}));
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, DeletesReachEveryPartition) {
+  addQuarter();
+
+  repo_->deletePoints("a1", kJan1Ms, kFeb10Ms);
+  auto points = repo_->getPoints("a1", "u1", 0, kApr1Ms);
+  ASSERT_EQ(points.size(), 2u);
+  EXPECT_EQ(points[0].timestamp_ms, kDec31LastMs);
+  EXPECT_EQ(points[1].timestamp_ms, kMar5Ms);
+
+  repo_->deleteAllPoints("a1");
+  EXPECT_TRUE(repo_->getPoints("a1", 0, kApr1Ms).empty());
+  // Emptied partitions stay until dropped
+  EXPECT_EQ(repo_->getPartitions().size(), 4u);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, DeleteCascadesToPartitions) {
+  addQuarter();
+
+  repo_->deleteUnit("u2");
+  EXPECT_EQ(repo_->getPoints("a1", 0, kApr1Ms).size(), 5u);
+  repo_->deleteAsset("a1");
+  repo_->createAsset({"a1", "Asset", "", ""});
+  EXPECT_TRUE(repo_->getPoints("a1", 0, kApr1Ms).empty());
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, PeriodIsFixedOnceCreated) {
+  addQuarter();
+
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Partitions;
+  options.partitionPeriod = PartitionPeriod::Day;
+  TimeSeriesRepository reopened(*db_, options);
+  reopened.initSchema();
+
+  EXPECT_EQ(reopened.getPoints("a1", "u1", kJan1Ms, kJan15Ms).size(), 2u);
+  reopened.addPoint({"a1", kFeb1Ms, "u1", 1.0});
+  EXPECT_EQ(partitionTables().size(), 4u);
+}
+
+TEST(TimeSeriesPartitionPeriodTest, DayAndYearNames) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesOptions daily_options;
+  daily_options.storage = PointStorage::Partitions;
+  daily_options.partitionPeriod = PartitionPeriod::Day;
+  TimeSeriesRepository daily(db, daily_options);
+  daily.initSchema();
+  daily.createAsset({"a1", "Asset", "", ""});
+  daily.createUnit({"u1", "X", "Unit X"});
+  daily.addPoints({{"a1", kJan15Ms, "u1", 1.0},
+                   {"a1", kJan15Ms + 86399999, "u1", 2.0}});
+
+  auto partitions = daily.getPartitions();
+  ASSERT_EQ(partitions.size(), 1u);
+  EXPECT_EQ(partitions[0].table, "timeseries_points_20240115");
+  EXPECT_EQ(partitions[0].end_ms - partitions[0].start_ms, 86400000);
+
+  Gateways::Database::SqliteDatabase other(":memory:");
+  TimeSeriesOptions yearly_options;
+  yearly_options.storage = PointStorage::Partitions;
+  yearly_options.partitionPeriod = PartitionPeriod::Year;
+  TimeSeriesRepository yearly(other, yearly_options);
+  yearly.initSchema();
+  yearly.createAsset({"a1", "Asset", "", ""});
+  yearly.createUnit({"u1", "X", "Unit X"});
+  yearly.addPoints({{"a1", kJan1Ms, "u1", 1.0},
+                    {"a1", kMar5Ms, "u1", 2.0}});
+
+  partitions = yearly.getPartitions();
+  ASSERT_EQ(partitions.size(), 1u);
+  EXPECT_EQ(partitions[0].table, "timeseries_points_2024");
+  EXPECT_EQ(partitions[0].start_ms, kJan1Ms);
+}
+
+TEST(TimeSeriesPartitionPeriodTest, RowStorageHasNoPartitions) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesRepository repo(db);
+  repo.initSchema();
+
+  EXPECT_THROW(repo.getPartitions(), std::logic_error);
+  EXPECT_THROW(repo.dropPartitionsBefore(kJan1Ms), std::logic_error);
+}
+
+// ============================================================
+// Parallel Multi-Asset Reads
+// ============================================================
+class MultiAssetTimeSeriesRepositoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = std::filesystem::temp_directory_path() /
+            ("test_ts_multi_" +
+             std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db");
+    Gateways::Database::SqlitePoolOptions options;
+    options.readerCount = 4;
+    pool_ = std::make_unique<Gateways::Database::SqlitePool>(path_.string(),
+                                                             options);
+  }
+
+  void TearDown() override {
+    repo_.reset();
+    pool_.reset();
+    std::filesystem::remove(path_);
+    std::filesystem::remove(path_.string() + "-wal");
+    std::filesystem::remove(path_.string() + "-shm");
+  }
+
+  // Asset i has i + 1 points per unit, one every 10s from 0
+  void populate(const TimeSeriesOptions& options, int asset_count) {
+    repo_ = std::make_unique<TimeSeriesRepository>(*pool_, options);
+    repo_->initSchema();
+    repo_->createUnit({"u1", "X", "Unit X"});
+    repo_->createUnit({"u2", "Y", "Unit Y"});
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (int i = 0; i < asset_count; ++i) {
+      std::string id = "a" + std::to_string(i);
+      assets_.push_back(id);
+      repo_->createAsset({id, id, "", ""});
+      for (int j = 0; j <= i; ++j) {
+        points.push_back({id, j * 10000, "u1", i + j * 0.5});
+        points.push_back({id, j * 10000, "u2", -i - j * 0.5});
+      }
+    }
+    repo_->addPoints(points);
+  }
+
+  std::filesystem::path path_;
+  std::unique_ptr<Gateways::Database::SqlitePool> pool_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+  std::vector<std::string> assets_;
+};
+
+TEST_F(MultiAssetTimeSeriesRepositoryTest, MatchesSequentialReads) {
+  TimeSeriesOptions options;
+  options.readThreads = 4;
+  populate(options, 24);
+  auto ids = assets_;
+  ids.push_back("missing");
+
+  auto result = repo_->getPointsMulti(ids, 20000, 150000);
+  ASSERT_EQ(result.size(), ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    auto expected = repo_->getPoints(ids[i], 20000, 150000);
+    ASSERT_EQ(result[i].size(), expected.size()) << ids[i];
+    for (size_t j = 0; j < expected.size(); ++j) {
+      EXPECT_EQ(result[i][j].asset_id, ids[i]);
+      EXPECT_EQ(result[i][j].timestamp_ms, expected[j].timestamp_ms);
+      EXPECT_EQ(result[i][j].unit_id, expected[j].unit_id);
+      EXPECT_DOUBLE_EQ(result[i][j].value, expected[j].value);
+    }
+  }
+  EXPECT_TRUE(result.back().empty());
+  EXPECT_EQ(result[23].size(), 28u);  // 14 timestamps, two units
+
+  EXPECT_TRUE(repo_->getPointsMulti({}, 0, 100000).empty());
+}
+
+TEST_F(MultiAssetTimeSeriesRepositoryTest, MergedIsOrderedByTimestamp) {
+  TimeSeriesOptions options;
+  options.readThreads = 3;
+  populate(options, 5);
+
+  auto merged = repo_->getPointsMerged({"a4", "a1", "a3"}, 0, 30000);
+  ASSERT_EQ(merged.size(), 20u);  // (4 + 2 + 4) timestamps, two units
+  for (size_t i = 1; i < merged.size(); ++i) {
+    EXPECT_LE(merged[i - 1].timestamp_ms, merged[i].timestamp_ms) << i;
+  }
+  // Equal timestamps follow the requested asset order, then the unit
+  EXPECT_EQ(merged[0].asset_id, "a4");
+  EXPECT_EQ(merged[1].asset_id, "a4");
+  EXPECT_EQ(merged[2].asset_id, "a1");
+  EXPECT_EQ(merged[4].asset_id, "a3");
+  EXPECT_EQ(merged[4].unit_id, "u1");
+  EXPECT_EQ(merged[5].unit_id, "u2");
+  EXPECT_EQ(merged.back().asset_id, "a3");
+  EXPECT_EQ(merged.back().timestamp_ms, 30000);
+}
+
+TEST_F(MultiAssetTimeSeriesRepositoryTest, PartitionedAndChunkedStorage) {
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Partitions;
+  options.readThreads = 4;
+  populate(options, 8);
+  auto partitioned = repo_->getPointsMulti(assets_, 0, 50000);
+  ASSERT_EQ(partitioned.size(), 8u);
+  EXPECT_EQ(partitioned[7].size(), 12u);
+  EXPECT_EQ(partitioned[7][11].unit_id, "u2");
+
+  TimeSeriesOptions chunked_options;
+  chunked_options.storage = PointStorage::Chunks;
+  chunked_options.readThreads = 4;
+  TimeSeriesRepository chunked(*pool_, chunked_options);
+  chunked.initSchema();
+  std::vector<Entities::TimeSeriesPoint> points;
+  for (const auto& id : assets_) {
+    points.push_back({id, 5000, "u1", 1.0});
+  }
+  chunked.addPoints(points);
+  auto result = chunked.getPointsMulti(assets_, 0, 10000);
+  ASSERT_EQ(result.size(), 8u);
+  for (const auto& series : result) {
+    ASSERT_EQ(series.size(), 1u);
+    EXPECT_EQ(series[0].timestamp_ms, 5000);
+  }
+}
+
+TEST_F(MultiAssetTimeSeriesRepositoryTest, WorkerFailureIsRethrown) {
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Partitions;
+  options.readThreads = 4;
+  populate(options, 8);
+  pool_->execute("DROP TABLE timeseries_points_197001");
+
+  EXPECT_THROW(repo_->getPointsMulti(assets_, 0, 50000),
+               Gateways::Database::DatabaseException);
+}
+
+TEST(TimeSeriesMultiReadTest, SequentialOnSingleConnection) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesRepository repo(db);
+  repo.initSchema();
+  repo.createAsset({"a1", "Asset", "", ""});
+  repo.createAsset({"a2", "Asset", "", ""});
+  repo.createUnit({"u1", "X", "Unit X"});
+  repo.addPoints({{"a1", 1000, "u1", 1.0},
+                  {"a2", 1000, "u1", 2.0},
+                  {"a2", 2000, "u1", 3.0}});
+
+  auto result = repo.getPointsMulti({"a2", "a1"}, 0, 5000);
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(result[0].size(), 2u);
+  EXPECT_EQ(result[1].size(), 1u);
+
+  auto merged = repo.getPointsMerged({"a2", "a1"}, 0, 5000);
+  ASSERT_EQ(merged.size(), 3u);
+  EXPECT_EQ(merged[0].asset_id, "a2");
+  EXPECT_EQ(merged[1].asset_id, "a1");
+  EXPECT_DOUBLE_EQ(merged[2].value, 3.0);
+}
+
+TEST_F(ChunkedTimeSeriesRepositoryTest, ExpirePointsTrimsChunks) {
+  addSeries("u1", 35);
+
+  EXPECT_EQ(repo_->expirePoints("a1", 25000, 12, 10000), 12u);
+  EXPECT_EQ(chunkCount(), 3);
+  EXPECT_EQ(repo_->expirePoints("a1", 25000, 100, 10000), 13u);
+  auto points = repo_->getPoints("a1", "u1", 0, 40000);
+  ASSERT_EQ(points.size(), 10u);
+  EXPECT_EQ(points.front().timestamp_ms, 25000);
+
+  auto rollups = repo_->getRollups("a1", "u1", 10000, 0, 40000);
+  ASSERT_EQ(rollups.size(), 3u);
+  EXPECT_EQ(rollups[1].count, 10);
+  EXPECT_EQ(rollups[2].count, 5);
+  EXPECT_DOUBLE_EQ(rollups[2].close, 24.0);
+}
+
+TEST_F(PartitionedTimeSeriesRepositoryTest, ExpirePointsAcrossPartitions) {
+  addQuarter();
+
+  EXPECT_EQ(repo_->expirePoints("a1", kFeb10Ms, 3), 4u);
+  EXPECT_EQ(repo_->expirePoints("a1", kFeb10Ms, 3), 2u);
+  EXPECT_EQ(repo_->expirePoints("a1", kFeb10Ms, 3), 0u);
+  EXPECT_EQ(repo_->getPoints("a1", 0, kApr1Ms).size(), 4u);
+  EXPECT_EQ(repo_->getPartitions().size(), 4u);
+}
+
 }  // namespace
 }  // namespace Gateways::Repositories::Sqlite3
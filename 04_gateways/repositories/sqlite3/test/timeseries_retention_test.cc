@@ -0,0 +1,211 @@
+#include "timeseries_retention.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sqlite3_database_connector.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+constexpr int64_t kDayMs = 86400000;
+constexpr int64_t kNowMs = 100 * kDayMs;
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class TimeSeriesRetentionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+  }
+
+  void open(const TimeSeriesOptions& options = {}) {
+    repo_ = std::make_unique<TimeSeriesRepository>(*db_, options);
+    repo_->initSchema();
+    repo_->createUnit({"u1", "X", "Unit X"});
+    for (const char* id : {"a1", "a2"}) {
+      repo_->createAsset({id, id, "", ""});
+    }
+  }
+
+  // One point per asset every hour over the 20 days before kNowMs
+  void addHistory() {
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (int64_t ts = kNowMs - 20 * kDayMs; ts < kNowMs; ts += 3600000) {
+      points.push_back({"a1", ts, "u1", 1.0});
+      points.push_back({"a2", ts, "u1", 2.0});
+    }
+    repo_->addPoints(points);
+  }
+
+  static RetentionOptions tenDays() {
+    RetentionOptions options;
+    options.maxAge = std::chrono::hours(24 * 10);
+    options.batchSize = 50;
+    options.batchPause = std::chrono::milliseconds(0);
+    options.now = [] { return kNowMs; };
+    return options;
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+// ============================================================
+// Passes
+// ============================================================
+TEST_F(TimeSeriesRetentionTest, RunOnceExpiresEveryAssetInBatches) {
+  open();
+  addHistory();
+  TimeSeriesRetention retention(*db_, *repo_, tenDays());
+
+  auto stats = retention.runOnce();
+  EXPECT_EQ(stats.passes, 1u);
+  EXPECT_EQ(stats.pointsDeleted, 480u);  // 10 days * 24 * 2 assets
+  EXPECT_EQ(stats.batches, 10u);         // 240 per asset in 50s
+  EXPECT_EQ(stats.partitionsDropped, 0u);
+
+  for (const char* id : {"a1", "a2"}) {
+    auto points = repo_->getPoints(id, 0, kNowMs);
+    ASSERT_EQ(points.size(), 240u) << id;
+    EXPECT_EQ(points.front().timestamp_ms, kNowMs - 10 * kDayMs);
+  }
+
+  EXPECT_EQ(retention.runOnce().pointsDeleted, 0u);
+  EXPECT_EQ(retention.stats().passes, 2u);
+  EXPECT_EQ(retention.stats().pointsDeleted, 480u);
+}
+
+TEST_F(TimeSeriesRetentionTest, RollsUpBeforeDeleting) {
+  open();
+  addHistory();
+  auto options = tenDays();
+  options.rollupBucket = std::chrono::hours(24);
+  TimeSeriesRetention retention(*db_, *repo_, options);
+
+  retention.runOnce();
+
+  auto rollups = repo_->getRollups("a2", "u1", kDayMs, 0, kNowMs);
+  ASSERT_EQ(rollups.size(), 10u);
+  EXPECT_EQ(rollups.front().bucket_start_ms, kNowMs - 20 * kDayMs);
+  for (const auto& bucket : rollups) {
+    EXPECT_EQ(bucket.count, 24);
+    EXPECT_DOUBLE_EQ(bucket.avg, 2.0);
+  }
+}
+
+TEST_F(TimeSeriesRetentionTest, DropsExpiredPartitionsFirst) {
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Partitions;
+  options.partitionPeriod = PartitionPeriod::Day;
+  open(options);
+  addHistory();
+  TimeSeriesRetention retention(*db_, *repo_, tenDays());
+
+  auto stats = retention.runOnce();
+  EXPECT_EQ(stats.partitionsDropped, 10u);
+  EXPECT_EQ(stats.pointsDeleted, 0u);
+  EXPECT_EQ(repo_->getPartitions().size(), 10u);
+  EXPECT_EQ(repo_->getPoints("a1", 0, kNowMs).size(), 240u);
+}
+
+TEST_F(TimeSeriesRetentionTest, ChunkedStorage) {
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Chunks;
+  options.chunkWidth = std::chrono::hours(24);
+  open(options);
+  addHistory();
+  TimeSeriesRetention retention(*db_, *repo_, tenDays());
+
+  EXPECT_EQ(retention.runOnce().pointsDeleted, 480u);
+  EXPECT_EQ(repo_->getPoints("a2", 0, kNowMs).size(), 240u);
+}
+
+// ============================================================
+// Incremental Vacuum
+// ============================================================
+TEST_F(TimeSeriesRetentionTest, IncrementalVacuumReturnsPages) {
+  auto path = std::filesystem::temp_directory_path() /
+              ("test_retention_" +
+               std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db");
+  {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(path.string());
+    db_->execute("PRAGMA auto_vacuum = INCREMENTAL");
+    open();
+    addHistory();
+    auto options = tenDays();
+    options.vacuumPages = 2;
+    TimeSeriesRetention retention(*db_, *repo_, options);
+
+    auto stats = retention.runOnce();
+    EXPECT_GT(stats.pagesFreed, 0u);
+    auto free_pages = db_->prepare("PRAGMA freelist_count");
+    EXPECT_EQ(free_pages->fetchScalar<int64_t>(), 0);
+  }
+  repo_.reset();
+  db_.reset();
+  std::filesystem::remove(path);
+}
+
+TEST_F(TimeSeriesRetentionTest, VacuumSkippedWithoutAutoVacuum) {
+  open();
+  addHistory();
+  TimeSeriesRetention retention(*db_, *repo_, tenDays());
+
+  EXPECT_EQ(retention.runOnce().pagesFreed, 0u);
+}
+
+// ============================================================
+// Background Thread
+// ============================================================
+TEST_F(TimeSeriesRetentionTest, BackgroundPassesUntilStopped) {
+  open();
+  addHistory();
+  auto options = tenDays();
+  options.interval = std::chrono::hours(1);
+  TimeSeriesRetention retention(*db_, *repo_, options);
+
+  retention.start();
+  EXPECT_TRUE(retention.isRunning());
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (retention.stats().passes == 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // Returns promptly although the next pass is an hour away
+  retention.stop();
+  EXPECT_FALSE(retention.isRunning());
+  EXPECT_EQ(retention.stats().passes, 1u);
+  EXPECT_EQ(retention.stats().pointsDeleted, 480u);
+
+  retention.stop();
+}
+
+TEST_F(TimeSeriesRetentionTest, StopInterruptsBetweenBatches) {
+  open();
+  addHistory();
+  auto options = tenDays();
+  options.batchSize = 10;
+  options.batchPause = std::chrono::hours(1);
+  TimeSeriesRetention retention(*db_, *repo_, options);
+
+  retention.start();
+  // The first batch takes well under this; the pause after it an hour
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  retention.stop();
+
+  auto stats = retention.stats();
+  EXPECT_EQ(stats.passes, 1u);
+  EXPECT_EQ(stats.batches, 1u);
+  EXPECT_EQ(stats.pointsDeleted, 10u);
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,242 @@
+#include "timeseries_sql_functions.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "timeseries_indicators.h"
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Test Fixture
+// ============================================================
+class TimeSeriesSqlFunctionsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    db_ = std::make_unique<Gateways::Database::SqliteDatabase>(":memory:");
+    repo_ = makeRepository(*db_);
+    registerTimeSeriesFunctions(*db_, *repo_);
+  }
+
+  static std::unique_ptr<TimeSeriesRepository> makeRepository(
+      IDatabase& db, const TimeSeriesOptions& options = {}) {
+    auto repo = std::make_unique<TimeSeriesRepository>(db, options);
+    repo->initSchema();
+    repo->createAsset({"a1", "Asset 1", "", ""});
+    for (const char* id : {"EUR", "USD", "CHF", "KG", "SHARES"}) {
+      repo->createUnit({id, id, id});
+    }
+    repo->createConversion({"EUR", "USD", 1.1});
+    repo->createConversion({"USD", "CHF", 0.9});
+    return repo;
+  }
+
+  // a1 prices in USD at 0, 1000, ... with volumes in SHARES at the same
+  // timestamps
+  void addTrades(const std::vector<double>& prices,
+                 const std::vector<double>& volumes) {
+    std::vector<Entities::TimeSeriesPoint> points;
+    for (size_t i = 0; i < prices.size(); ++i) {
+      const auto ts = static_cast<int64_t>(i) * 1000;
+      points.push_back({"a1", ts, "USD", prices[i]});
+      points.push_back({"a1", ts, "SHARES", volumes[i]});
+    }
+    repo_->addPoints(points);
+  }
+
+  std::vector<double> column(const std::string& sql) {
+    std::vector<double> values;
+    for (const auto& row : db_->query(sql)) {
+      values.push_back(std::holds_alternative<std::nullptr_t>(row[0])
+                           ? NAN
+                           : std::get<double>(row[0]));
+    }
+    return values;
+  }
+
+  std::unique_ptr<Gateways::Database::SqliteDatabase> db_;
+  std::unique_ptr<TimeSeriesRepository> repo_;
+};
+
+const std::vector<double> kPrices = {10.0, 11.0, 12.5, 12.0, 13.5, 13.0};
+const std::vector<double> kVolumes = {100, 50, 200, 0, 150, 75};
+
+double sampleStddev(const std::vector<double>& values) {
+  double mean = 0.0;
+  for (double v : values) {
+    mean += v;
+  }
+  mean /= static_cast<double>(values.size());
+  double squares = 0.0;
+  for (double v : values) {
+    squares += (v - mean) * (v - mean);
+  }
+  return std::sqrt(squares / static_cast<double>(values.size() - 1));
+}
+
+// ============================================================
+// Functions in SQL
+// ============================================================
+TEST_F(TimeSeriesSqlFunctionsTest, ConvertUnitFollowsTheConversionGraph) {
+  auto value = [this](const std::string& sql) { return column(sql).at(0); };
+  EXPECT_DOUBLE_EQ(value("SELECT convert_unit(10.0, 'EUR', 'USD')"), 11.0);
+  EXPECT_DOUBLE_EQ(value("SELECT convert_unit(11.0, 'USD', 'EUR')"), 10.0);
+  EXPECT_DOUBLE_EQ(value("SELECT convert_unit(10.0, 'EUR', 'CHF')"), 9.9);
+  EXPECT_DOUBLE_EQ(value("SELECT convert_unit(3.0, 'KG', 'KG')"), 3.0);
+  EXPECT_TRUE(std::isnan(value("SELECT convert_unit(1.0, 'EUR', 'KG')")));
+  EXPECT_TRUE(std::isnan(value("SELECT convert_unit(NULL, 'EUR', 'USD')")));
+
+  // Conversion writes are seen by the next call
+  repo_->updateConversion({"EUR", "USD", 1.2});
+  EXPECT_DOUBLE_EQ(value("SELECT convert_unit(10.0, 'EUR', 'USD')"), 12.0);
+}
+
+TEST_F(TimeSeriesSqlFunctionsTest, EmaMatchesTheRollingIndicator) {
+  addTrades(kPrices, kVolumes);
+  auto emas = column(
+      "SELECT ema(value, 3) OVER (ORDER BY timestamp_ms) FROM timeseries "
+      "WHERE asset_id = 'a1' AND unit_id = 'USD' ORDER BY timestamp_ms");
+
+  RollingIndicator indicator(IndicatorKind::Ema, 3);
+  ASSERT_EQ(emas.size(), kPrices.size());
+  for (size_t i = 0; i < kPrices.size(); ++i) {
+    indicator.update(kPrices[i]);
+    EXPECT_DOUBLE_EQ(emas[i], *indicator.value()) << i;
+  }
+  // As a plain aggregate: the last value
+  EXPECT_DOUBLE_EQ(
+      column("SELECT ema(value, 3) FROM (SELECT value FROM timeseries "
+             "WHERE unit_id = 'USD' ORDER BY timestamp_ms)")
+          .at(0),
+      *indicator.value());
+
+  EXPECT_THROW(db_->query("SELECT ema(value, 3) OVER (ORDER BY timestamp_ms "
+                          "ROWS 2 PRECEDING) FROM timeseries"),
+               QueryException);
+  EXPECT_THROW(db_->query("SELECT ema(value, 0) FROM timeseries"),
+               QueryException);
+}
+
+TEST_F(TimeSeriesSqlFunctionsTest, StddevAndVwapOverSlidingFrames) {
+  addTrades(kPrices, kVolumes);
+  auto stddevs = column(
+      "SELECT stddev(value) OVER (ORDER BY timestamp_ms ROWS 2 PRECEDING) "
+      "FROM timeseries WHERE unit_id = 'USD' ORDER BY timestamp_ms");
+  auto vwaps = column(
+      "SELECT vwap(p.value, v.value) OVER (ORDER BY p.timestamp_ms "
+      "ROWS 2 PRECEDING) FROM timeseries AS p JOIN timeseries AS v "
+      "ON v.timestamp_ms = p.timestamp_ms AND v.unit_id = 'SHARES' "
+      "WHERE p.unit_id = 'USD' ORDER BY p.timestamp_ms");
+
+  ASSERT_EQ(stddevs.size(), kPrices.size());
+  ASSERT_EQ(vwaps.size(), kPrices.size());
+  EXPECT_TRUE(std::isnan(stddevs[0]));  // one value
+  for (size_t i = 1; i < kPrices.size(); ++i) {
+    const size_t first = i < 2 ? 0 : i - 2;
+    std::vector<double> frame(kPrices.begin() + first,
+                              kPrices.begin() + i + 1);
+    EXPECT_NEAR(stddevs[i], sampleStddev(frame), 1e-12) << i;
+
+    double sum = 0.0;
+    double weights = 0.0;
+    for (size_t j = first; j <= i; ++j) {
+      sum += kPrices[j] * kVolumes[j];
+      weights += kVolumes[j];
+    }
+    EXPECT_NEAR(vwaps[i], sum / weights, 1e-12) << i;
+  }
+
+  EXPECT_NEAR(column("SELECT stddev(value) FROM timeseries "
+                     "WHERE unit_id = 'USD'")
+                  .at(0),
+              sampleStddev(kPrices), 1e-12);
+  EXPECT_TRUE(std::isnan(column("SELECT vwap(1.0, 0.0)").at(0)));
+}
+
+// ============================================================
+// Repository Queries
+// ============================================================
+TEST_F(TimeSeriesSqlFunctionsTest, GetPointsInConvertsEveryConnectedUnit) {
+  repo_->addPoints({{"a1", 0, "EUR", 10.0},
+                    {"a1", 0, "USD", 20.0},
+                    {"a1", 1000, "KG", 5.0},  // not convertible: left out
+                    {"a1", 2000, "CHF", 9.0}});
+
+  auto points = repo_->getPointsIn("a1", "USD", 0, 2000);
+  ASSERT_EQ(points.size(), 3u);
+  for (const auto& point : points) {
+    EXPECT_EQ(point.asset_id, "a1");
+    EXPECT_EQ(point.unit_id, "USD");
+  }
+  EXPECT_EQ(points[0].timestamp_ms, 0);
+  EXPECT_EQ(points[2].timestamp_ms, 2000);
+  // The two units at timestamp 0 come in unit key order
+  EXPECT_DOUBLE_EQ(points[0].value + points[1].value, 11.0 + 20.0);
+  EXPECT_DOUBLE_EQ(points[2].value, 10.0);
+}
+
+TEST_F(TimeSeriesSqlFunctionsTest, RepositoryAnalyticsReturnFinalValues) {
+  addTrades(kPrices, kVolumes);
+
+  auto emas = repo_->getEma("a1", "USD", 0, 10000, 3);
+  RollingIndicator indicator(IndicatorKind::Ema, 3);
+  ASSERT_EQ(emas.size(), kPrices.size());
+  for (size_t i = 0; i < kPrices.size(); ++i) {
+    indicator.update(kPrices[i]);
+    EXPECT_EQ(emas[i].timestamp_ms, static_cast<int64_t>(i) * 1000);
+    EXPECT_DOUBLE_EQ(emas[i].value, *indicator.value());
+  }
+  EXPECT_THROW(repo_->getEma("a1", "USD", 0, 10000, 0), std::invalid_argument);
+
+  EXPECT_NEAR(*repo_->getStddev("a1", "USD", 0, 10000), sampleStddev(kPrices),
+              1e-12);
+  EXPECT_FALSE(repo_->getStddev("a1", "USD", 0, 0).has_value());
+
+  RollingIndicator vwap(IndicatorKind::Vwap, kPrices.size());
+  for (size_t i = 0; i < kPrices.size(); ++i) {
+    vwap.update(kPrices[i], kVolumes[i]);
+  }
+  EXPECT_NEAR(*repo_->getVwap("a1", "USD", "SHARES", 0, 10000), *vwap.value(),
+              1e-12);
+  EXPECT_FALSE(repo_->getVwap("a1", "USD", "SHARES", 3000, 3000).has_value());
+}
+
+TEST_F(TimeSeriesSqlFunctionsTest, RepositoryAnalyticsNeedRowsStorage) {
+  Gateways::Database::SqliteDatabase db(":memory:");
+  TimeSeriesOptions options;
+  options.storage = PointStorage::Chunks;
+  auto repo = makeRepository(db, options);
+  EXPECT_THROW(repo->getEma("a1", "USD", 0, 1000, 3), std::logic_error);
+  EXPECT_THROW(repo->getStddev("a1", "USD", 0, 1000), std::logic_error);
+}
+
+TEST_F(TimeSeriesSqlFunctionsTest, WorksOnEveryPoolConnection) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("test_sql_functions_" +
+                     std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db");
+  {
+    Gateways::Database::SqlitePool pool(path.string());
+    auto repo = makeRepository(pool);
+    registerTimeSeriesFunctions(pool, *repo);
+    repo->addPoints({{"a1", 0, "EUR", 10.0}, {"a1", 1000, "EUR", 20.0}});
+
+    auto points = repo->getPointsIn("a1", "USD", 0, 1000);
+    ASSERT_EQ(points.size(), 2u);
+    EXPECT_DOUBLE_EQ(points[1].value, 22.0);
+    EXPECT_NEAR(*repo->getStddev("a1", "EUR", 0, 1000), std::sqrt(50.0),
+                1e-12);
+  }
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::filesystem::remove(path.string() + suffix);
+  }
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,77 @@
+#include "unit_conversion_graph.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace Gateways::Repositories::Sqlite3 {
+namespace {
+
+// ============================================================
+// Direct and Reverse
+// ============================================================
+TEST(UnitConversionGraphTest, SameUnitIsIdentity) {
+  UnitConversionGraph graph;
+
+  ASSERT_TRUE(graph.factor("EUR", "EUR").has_value());
+  EXPECT_DOUBLE_EQ(*graph.factor("EUR", "EUR"), 1.0);
+  EXPECT_FALSE(graph.factor("EUR", "USD").has_value());
+}
+
+TEST(UnitConversionGraphTest, DirectAndReverse) {
+  UnitConversionGraph graph({{"EUR", "USD", 2.0}});
+
+  EXPECT_DOUBLE_EQ(*graph.factor("EUR", "USD"), 2.0);
+  EXPECT_DOUBLE_EQ(*graph.factor("USD", "EUR"), 0.5);
+}
+
+TEST(UnitConversionGraphTest, StoredRowBeatsReverseOfOther) {
+  // Inconsistent on purpose: USD->EUR is not 1 / 2
+  UnitConversionGraph graph({{"EUR", "USD", 2.0}, {"USD", "EUR", 0.4}});
+
+  EXPECT_DOUBLE_EQ(*graph.factor("EUR", "USD"), 2.0);
+  EXPECT_DOUBLE_EQ(*graph.factor("USD", "EUR"), 0.4);
+}
+
+TEST(UnitConversionGraphTest, ZeroFactorHasNoReverse) {
+  UnitConversionGraph graph({{"A", "B", 0.0}});
+
+  EXPECT_DOUBLE_EQ(*graph.factor("A", "B"), 0.0);
+  EXPECT_FALSE(graph.factor("B", "A").has_value());
+}
+
+// ============================================================
+// Transitive
+// ============================================================
+TEST(UnitConversionGraphTest, MultiHopMultipliesFactors) {
+  UnitConversionGraph graph({{"EUR", "USD", 1.1}, {"USD", "CHF", 0.9}});
+
+  EXPECT_DOUBLE_EQ(*graph.factor("EUR", "CHF"), 1.1 * 0.9);
+  EXPECT_DOUBLE_EQ(*graph.factor("CHF", "EUR"), (1.0 / 0.9) * (1.0 / 1.1));
+}
+
+TEST(UnitConversionGraphTest, MixesStoredAndReverseEdges) {
+  // g -> kg stored, lb -> kg stored: g -> lb goes through kg backwards
+  UnitConversionGraph graph({{"g", "kg", 0.001}, {"lb", "kg", 0.45359237}});
+
+  EXPECT_DOUBLE_EQ(*graph.factor("g", "lb"), 0.001 / 0.45359237);
+}
+
+TEST(UnitConversionGraphTest, FewestHopsWins) {
+  UnitConversionGraph graph(
+      {{"A", "B", 2.0}, {"B", "C", 3.0}, {"C", "D", 5.0}, {"A", "D", 7.0}});
+
+  EXPECT_DOUBLE_EQ(*graph.factor("A", "D"), 7.0);
+  EXPECT_DOUBLE_EQ(*graph.factor("A", "C"), 6.0);
+}
+
+TEST(UnitConversionGraphTest, DisconnectedComponents) {
+  UnitConversionGraph graph({{"EUR", "USD", 1.1}, {"m", "km", 0.001}});
+
+  EXPECT_FALSE(graph.factor("EUR", "km").has_value());
+  EXPECT_FALSE(graph.factor("m", "unknown").has_value());
+}
+
+}  // namespace
+}  // namespace Gateways::Repositories::Sqlite3
@@ -0,0 +1,237 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "entities.h"
+#include "series_backtest.h"
+#include "series_covariance.h"
+#include "series_stats.h"
+
+namespace Analytics {
+namespace {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+// Points shaped like TimeSeriesRepository::getPoints() output
+std::vector<Entities::TimeSeriesPoint> makePoints(int64_t count) {
+  std::vector<Entities::TimeSeriesPoint> points;
+  points.reserve(static_cast<size_t>(count));
+  double price = 100.0;
+  for (int64_t i = 0; i < count; ++i) {
+    price += (i % 7 == 0 ? -0.75 : 0.5);
+    points.push_back({"BTC", 1700000000000 + i * 1000, "USD", price});
+  }
+  return points;
+}
+
+// The value column, as getPointColumns() hands it out
+std::vector<double> valuesOf(
+    const std::vector<Entities::TimeSeriesPoint>& points) {
+  std::vector<double> values;
+  values.reserve(points.size());
+  for (const auto& point : points) {
+    values.push_back(point.value);
+  }
+  return values;
+}
+
+// ============================================================
+// summarize: naive AoS loop vs scalar and SIMD kernels on SoA
+// ============================================================
+
+// range(0): points in the series
+void BM_SummarizeNaiveAos(benchmark::State& state) {
+  const auto points = makePoints(state.range(0));
+
+  for (auto _ : state) {
+    double total = 0.0;
+    double lo = points.front().value;
+    double hi = points.front().value;
+    for (const auto& point : points) {
+      total += point.value;
+      lo = point.value < lo ? point.value : lo;
+      hi = point.value > hi ? point.value : hi;
+    }
+    const double m = total / static_cast<double>(points.size());
+    double squares = 0.0;
+    for (const auto& point : points) {
+      squares += (point.value - m) * (point.value - m);
+    }
+    benchmark::DoNotOptimize(m);
+    benchmark::DoNotOptimize(squares);
+    benchmark::DoNotOptimize(lo);
+    benchmark::DoNotOptimize(hi);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SummarizeNaiveAos)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+void runSummarize(benchmark::State& state, SimdLevel level) {
+  const auto values = valuesOf(makePoints(state.range(0)));
+  if (!setSimdLevel(level)) {
+    state.SkipWithError("SIMD level not supported on this CPU");
+    return;
+  }
+
+  for (auto _ : state) {
+    Summary summary = summarize(values);
+    benchmark::DoNotOptimize(summary);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  setSimdLevel(detectedSimdLevel());
+}
+
+void BM_SummarizeScalarSoa(benchmark::State& state) {
+  runSummarize(state, SimdLevel::Scalar);
+}
+BENCHMARK(BM_SummarizeScalarSoa)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+void BM_SummarizeDispatchedSoa(benchmark::State& state) {
+  runSummarize(state, detectedSimdLevel());
+}
+BENCHMARK(BM_SummarizeDispatchedSoa)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20);
+
+// ============================================================
+// covariance: scalar vs SIMD
+// ============================================================
+
+void runCovariance(benchmark::State& state, SimdLevel level) {
+  const auto x = valuesOf(makePoints(state.range(0)));
+  std::vector<double> y(x.rbegin(), x.rend());
+  if (!setSimdLevel(level)) {
+    state.SkipWithError("SIMD level not supported on this CPU");
+    return;
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(covariance(x, y));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  setSimdLevel(detectedSimdLevel());
+}
+
+void BM_CovarianceScalar(benchmark::State& state) {
+  runCovariance(state, SimdLevel::Scalar);
+}
+BENCHMARK(BM_CovarianceScalar)->Arg(1 << 16);
+
+void BM_CovarianceDispatched(benchmark::State& state) {
+  runCovariance(state, detectedSimdLevel());
+}
+BENCHMARK(BM_CovarianceDispatched)->Arg(1 << 16);
+
+// ============================================================
+// covariance matrix: every pair vs blocked tiles on the executor
+// ============================================================
+
+// range(0) series of 1000 aligned prices each
+AlignedFrame makeFrame(int64_t series) {
+  AlignedFrame frame;
+  const auto prices = valuesOf(makePoints(1000 + series));
+  for (int64_t i = 0; i < 1000; ++i) {
+    frame.timestamps.push_back(i * 1000);
+  }
+  for (int64_t s = 0; s < series; ++s) {
+    frame.columns.emplace_back(prices.begin() + s, prices.begin() + s + 1000);
+  }
+  return frame;
+}
+
+void BM_CovarianceMatrixPairwise(benchmark::State& state) {
+  const auto frame = makeFrame(state.range(0));
+  const size_t n = frame.columns.size();
+
+  for (auto _ : state) {
+    std::vector<double> values(n * n);
+    for (size_t i = 0; i < n; ++i) {
+      const auto x = logReturns(frame.columns[i]);
+      for (size_t j = 0; j < n; ++j) {
+        values[i * n + j] = covariance(x, logReturns(frame.columns[j]));
+      }
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+}
+BENCHMARK(BM_CovarianceMatrixPairwise)
+    ->Arg(100)
+    ->Arg(500)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_CovarianceMatrixBlocked(benchmark::State& state) {
+  const auto frame = makeFrame(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(covarianceMatrix(frame).values.data());
+  }
+}
+BENCHMARK(BM_CovarianceMatrixBlocked)
+    ->Arg(100)
+    ->Arg(500)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_CovarianceMatrixIncrementalUpdate(benchmark::State& state) {
+  const auto frame = makeFrame(state.range(0));
+  IncrementalCovariance incremental(frame);
+  std::vector<double> row;
+  for (const auto& column : frame.columns) {
+    row.push_back(column.back());
+  }
+
+  for (auto _ : state) {
+    incremental.update(row);
+  }
+}
+BENCHMARK(BM_CovarianceMatrixIncrementalUpdate)->Arg(100)->Arg(500);
+
+// ============================================================
+// backtest: strategies over one shared pass
+// ============================================================
+
+// Sums the first price, about the cheapest strategy there is
+class SumStrategy : public BacktestStrategy {
+ public:
+  void onTick(const BacktestTick& tick) override {
+    total += tick.prices.data()[0];
+  }
+  double total = 0.0;
+};
+
+// range(0) strategies over 10 series of 100k points each
+void BM_Backtest(benchmark::State& state) {
+  std::vector<std::vector<int64_t>> timestamps(10);
+  std::vector<std::vector<double>> values(10);
+  const auto prices = valuesOf(makePoints(100000));
+  std::vector<SeriesSpan> series;
+  for (size_t s = 0; s < 10; ++s) {
+    for (int64_t i = 0; i < 100000; ++i) {
+      timestamps[s].push_back(i * 1000 + static_cast<int64_t>(s));
+    }
+    values[s] = prices;
+    series.emplace_back(timestamps[s], values[s]);
+  }
+  std::vector<SumStrategy> strategies(static_cast<size_t>(state.range(0)));
+  std::vector<BacktestStrategy*> pointers;
+  for (auto& strategy : strategies) {
+    pointers.push_back(&strategy);
+  }
+
+  uint64_t ticks = 0;
+  for (auto _ : state) {
+    ticks += runBacktest(std::as_const(series), pointers).ticks;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(ticks));
+}
+BENCHMARK(BM_Backtest)->Arg(1)->Arg(16)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace Analytics
+
+BENCHMARK_MAIN();
@@ -0,0 +1,346 @@
+#ifndef ANALYTICS_SERIES_ALIGN_H_
+#define ANALYTICS_SERIES_ALIGN_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Analytics {
+
+// ============================================================
+// Inputs
+// ============================================================
+
+// Non-owning sorted series as parallel arrays, e.g. a SeriesView of a
+// mapped series file or the two columns of getPointColumns()
+struct SeriesSpan {
+  const int64_t* timestamps = nullptr;
+  const double* values = nullptr;
+  size_t size = 0;
+
+  SeriesSpan() = default;
+  SeriesSpan(const int64_t* timestamps, const double* values, size_t size)
+      : timestamps(timestamps), values(values), size(size) {}
+  // Throws std::invalid_argument if the lengths differ
+  SeriesSpan(const std::vector<int64_t>& timestamps,
+             const std::vector<double>& values);
+};
+
+// The cursor shape align() reads: next() yields samples by timestamp and
+// returns false at the end. The time-series repository's SeriesCursor
+// has it too, so repository reads align without materializing series.
+class SpanCursor {
+ public:
+  explicit SpanCursor(SeriesSpan span) : m_span(span) {}
+
+  bool next(int64_t& timestamp_ms, double& value) {
+    if (m_pos == m_span.size) {
+      return false;
+    }
+    timestamp_ms = m_span.timestamps[m_pos];
+    value = m_span.values[m_pos];
+    ++m_pos;
+    return true;
+  }
+
+ private:
+  SeriesSpan m_span;
+  size_t m_pos = 0;
+};
+
+// Reads the timestamp_ms and value members of points in place, e.g. the
+// TimeSeriesPoints of LsTcRepository::fetchMany() or the CompactPoints
+// of a CompactSeries, so fetched series align without being copied into
+// columns. The points must outlive the cursor.
+template <typename Point>
+class PointCursor {
+ public:
+  PointCursor(const Point* points, size_t size)
+      : m_pos(points), m_end(points + size) {}
+  explicit PointCursor(const std::vector<Point>& points)
+      : PointCursor(points.data(), points.size()) {}
+  // A temporary would be gone before the first next()
+  explicit PointCursor(std::vector<Point>&&) = delete;
+
+  bool next(int64_t& timestamp_ms, double& value) {
+    if (m_pos == m_end) {
+      return false;
+    }
+    timestamp_ms = m_pos->timestamp_ms;
+    value = m_pos->value;
+    ++m_pos;
+    return true;
+  }
+
+ private:
+  const Point* m_pos;
+  const Point* m_end;
+};
+
+// ============================================================
+// Options and Output
+// ============================================================
+
+enum class FillMethod {
+  AsOf,    // last observation at or before the grid time, carried forward
+  Linear,  // interpolated between the observations around the grid time
+};
+
+struct AlignOptions {
+  FillMethod fill = FillMethod::AsOf;
+  // 0: the grid is the union of all input timestamps in [from_ms, to_ms].
+  // Otherwise from_ms, from_ms + step_ms, ... up to to_ms, which then
+  // must both be set.
+  int64_t step_ms = 0;
+  int64_t from_ms = std::numeric_limits<int64_t>::min();
+  int64_t to_ms = std::numeric_limits<int64_t>::max();
+  // AsOf only: observations older than this at the grid time are not
+  // carried
+  std::optional<int64_t> max_staleness_ms;
+};
+
+// SoA: row r is timestamps[r], with series i's value in columns[i][r].
+// NaN where a series has nothing to give: before its first observation,
+// past max_staleness_ms, or after its last one with Linear.
+struct AlignedFrame {
+  std::vector<int64_t> timestamps;
+  std::vector<std::vector<double>> columns;
+
+  size_t rows() const { return timestamps.size(); }
+};
+
+// ============================================================
+// Alignment
+// ============================================================
+
+namespace detail {
+template <typename Cursor>
+class AlignState;
+}  // namespace detail
+
+// One pass over every input: a k-way merge on the series' next
+// timestamps builds the union grid, and a fixed grid advances each
+// series up to each grid time. Inputs must be sorted by timestamp; for
+// repeated timestamps the last value wins. Throws std::invalid_argument
+// on an input that goes back in time or on bad grid options.
+template <typename Cursor>
+AlignedFrame align(std::vector<Cursor>& cursors,
+                   const AlignOptions& options = {});
+
+AlignedFrame align(const std::vector<SeriesSpan>& series,
+                   const AlignOptions& options = {});
+
+// The rows of align() one at a time, written into the caller's buffer,
+// so a replay over years of ticks holds no frame. Allocates nothing
+// after construction. The cursors must outlive the stream.
+template <typename Cursor>
+class AlignedStream {
+ public:
+  // Throws std::invalid_argument on bad grid options
+  explicit AlignedStream(std::vector<Cursor>& cursors,
+                         const AlignOptions& options = {});
+
+  size_t series() const { return m_states.size(); }
+
+  // The next grid time, and in row[i] the value of series i at it, as
+  // in an AlignedFrame; false after the last row. Throws
+  // std::invalid_argument on an input that goes back in time.
+  bool next(int64_t& timestamp_ms, double* row);
+
+ private:
+  using Head = std::pair<int64_t, size_t>;  // (next timestamp, series)
+
+  void emit(int64_t timestamp_ms, double* row) const;
+
+  AlignOptions m_options;
+  std::vector<detail::AlignState<Cursor>> m_states;
+  uint64_t m_step = 0;        // fixed grid: the next step
+  uint64_t m_steps = 0;       // and the last one
+  std::vector<Head> m_heads;  // union grid: min-heap, earliest first
+  std::vector<size_t> m_due;  // series at the current timestamp
+};
+
+// ============================================================
+// Implementation
+// ============================================================
+
+namespace detail {
+
+struct Sample {
+  int64_t timestamp_ms;
+  double value;
+};
+
+// Observations of one series around the current grid time
+template <typename Cursor>
+class AlignState {
+ public:
+  explicit AlignState(Cursor& cursor) : m_cursor(cursor) { pull(); }
+
+  const std::optional<Sample>& head() const { return m_head; }
+
+  // Consumes every observation at or before timestamp_ms
+  void advanceTo(int64_t timestamp_ms) {
+    while (m_head && m_head->timestamp_ms <= timestamp_ms) {
+      m_previous = m_head;
+      pull();
+    }
+  }
+
+  double valueAt(int64_t timestamp_ms, const AlignOptions& options) const {
+    constexpr double kMissing = std::numeric_limits<double>::quiet_NaN();
+    if (!m_previous) {
+      return kMissing;
+    }
+    if (m_previous->timestamp_ms == timestamp_ms) {
+      return m_previous->value;
+    }
+    if (options.fill == FillMethod::AsOf) {
+      if (options.max_staleness_ms &&
+          static_cast<uint64_t>(timestamp_ms) -
+                  static_cast<uint64_t>(m_previous->timestamp_ms) >
+              static_cast<uint64_t>(*options.max_staleness_ms)) {
+        return kMissing;
+      }
+      return m_previous->value;
+    }
+    if (!m_head) {
+      return kMissing;
+    }
+    const double span = static_cast<double>(m_head->timestamp_ms) -
+                        static_cast<double>(m_previous->timestamp_ms);
+    const double offset = static_cast<double>(timestamp_ms) -
+                          static_cast<double>(m_previous->timestamp_ms);
+    return m_previous->value +
+           (m_head->value - m_previous->value) * (offset / span);
+  }
+
+ private:
+  void pull() {
+    Sample sample{};
+    if (!m_cursor.next(sample.timestamp_ms, sample.value)) {
+      m_head.reset();
+      return;
+    }
+    if (m_head && sample.timestamp_ms < m_head->timestamp_ms) {
+      throw std::invalid_argument("Series is not sorted by timestamp");
+    }
+    m_head = sample;
+  }
+
+  Cursor& m_cursor;
+  std::optional<Sample> m_previous;  // newest consumed observation
+  std::optional<Sample> m_head;      // next observation
+};
+
+void validateAlignOptions(const AlignOptions& options);
+
+}  // namespace detail
+
+template <typename Cursor>
+AlignedStream<Cursor>::AlignedStream(std::vector<Cursor>& cursors,
+                                     const AlignOptions& options)
+    : m_options(options) {
+  detail::validateAlignOptions(options);
+
+  m_states.reserve(cursors.size());
+  for (auto& cursor : cursors) {
+    m_states.emplace_back(cursor);
+  }
+  if (options.step_ms > 0) {
+    m_steps = (static_cast<uint64_t>(options.to_ms) -
+               static_cast<uint64_t>(options.from_ms)) /
+              static_cast<uint64_t>(options.step_ms);
+    return;
+  }
+  m_heads.reserve(m_states.size());
+  m_due.reserve(m_states.size());
+  for (size_t i = 0; i < m_states.size(); ++i) {
+    if (m_states[i].head()) {
+      m_heads.emplace_back(m_states[i].head()->timestamp_ms, i);
+    }
+  }
+  std::make_heap(m_heads.begin(), m_heads.end(), std::greater<Head>());
+}
+
+template <typename Cursor>
+bool AlignedStream<Cursor>::next(int64_t& timestamp_ms, double* row) {
+  if (m_options.step_ms > 0) {
+    if (m_step > m_steps) {
+      return false;
+    }
+    timestamp_ms = static_cast<int64_t>(
+        static_cast<uint64_t>(m_options.from_ms) +
+        m_step * static_cast<uint64_t>(m_options.step_ms));
+    ++m_step;
+    for (auto& state : m_states) {
+      state.advanceTo(timestamp_ms);
+    }
+    emit(timestamp_ms, row);
+    return true;
+  }
+
+  const auto later = std::greater<Head>();
+  while (!m_heads.empty() && m_heads.front().first <= m_options.to_ms) {
+    const int64_t current = m_heads.front().first;
+    m_due.clear();
+    while (!m_heads.empty() && m_heads.front().first == current) {
+      std::pop_heap(m_heads.begin(), m_heads.end(), later);
+      m_due.push_back(m_heads.back().second);
+      m_heads.pop_back();
+    }
+    for (size_t i : m_due) {
+      m_states[i].advanceTo(current);
+      if (m_states[i].head()) {
+        m_heads.emplace_back(m_states[i].head()->timestamp_ms, i);
+        std::push_heap(m_heads.begin(), m_heads.end(), later);
+      }
+    }
+    if (current >= m_options.from_ms) {
+      timestamp_ms = current;
+      emit(current, row);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename Cursor>
+void AlignedStream<Cursor>::emit(int64_t timestamp_ms, double* row) const {
+  for (size_t i = 0; i < m_states.size(); ++i) {
+    row[i] = m_states[i].valueAt(timestamp_ms, m_options);
+  }
+}
+
+template <typename Cursor>
+AlignedFrame align(std::vector<Cursor>& cursors, const AlignOptions& options) {
+  AlignedStream<Cursor> stream(cursors, options);
+
+  AlignedFrame frame;
+  frame.columns.resize(stream.series());
+  if (options.step_ms > 0) {
+    frame.timestamps.reserve((static_cast<uint64_t>(options.to_ms) -
+                              static_cast<uint64_t>(options.from_ms)) /
+                                 static_cast<uint64_t>(options.step_ms) +
+                             1);
+  }
+  std::vector<double> row(stream.series());
+  int64_t timestamp_ms = 0;
+  while (stream.next(timestamp_ms, row.data())) {
+    frame.timestamps.push_back(timestamp_ms);
+    for (size_t i = 0; i < row.size(); ++i) {
+      frame.columns[i].push_back(row[i]);
+    }
+  }
+  return frame;
+}
+
+}  // namespace Analytics
+
+#endif  // ANALYTICS_SERIES_ALIGN_H_
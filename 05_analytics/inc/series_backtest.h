@@ -0,0 +1,184 @@
+#ifndef ANALYTICS_SERIES_BACKTEST_H_
+#define ANALYTICS_SERIES_BACKTEST_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "executor.h"
+#include "series_align.h"
+#include "series_stats.h"
+
+namespace Analytics {
+
+// ============================================================
+// Strategies
+// ============================================================
+
+// One aligned row as a strategy sees it. prices points into the engine's
+// buffer and is valid for the duration of the callback only.
+struct BacktestTick {
+  int64_t timestamp_ms = 0;
+  uint64_t index = 0;  // row number, from 0
+  ValueSpan prices;    // one per series; NaN where align() has none
+};
+
+// One parameter set of a strategy. Every instance sees every row in
+// order on one thread at a time, but different instances run on
+// different threads, so state shared between them needs its own
+// locking.
+class BacktestStrategy {
+ public:
+  virtual ~BacktestStrategy() = default;
+
+  virtual void onStart(size_t /*series*/) {}
+  virtual void onTick(const BacktestTick& tick) = 0;
+  virtual void onFinish() {}
+};
+
+// ============================================================
+// Options and Report
+// ============================================================
+
+struct BacktestOptions {
+  AlignOptions align;
+  // Rows per buffered block. Two blocks are held: strategies replay one
+  // while the next is read.
+  size_t block_rows = 4096;
+  // Where the strategies run; nullptr is Executor::shared()
+  Concurrency::Executor* executor = nullptr;
+  // Threads on one backtest, the caller's included; 0 is every executor
+  // worker plus the caller
+  size_t max_parallelism = 0;
+};
+
+struct BacktestReport {
+  uint64_t ticks = 0;  // aligned rows read, once for all strategies
+  size_t strategies = 0;
+  double elapsed_seconds = 0.0;
+  double ticks_per_second = 0.0;
+  // ticks * strategies per second: the callback rate
+  double strategy_ticks_per_second = 0.0;
+};
+
+// ============================================================
+// Engine
+// ============================================================
+
+// Replays the aligned rows of cursors through every strategy in one pass
+// over the data: an AlignedStream fills a block of rows, then each
+// strategy is an executor task over the whole block, while one more task
+// reads the next block into the second buffer. So the data is read once
+// however many parameter sets run, and the tick path allocates nothing:
+// rows live in the two preallocated blocks. Cursors can be repository
+// SeriesCursors or SpanCursors over a mapped series file. The first
+// exception from a strategy or a cursor stops the run and is rethrown
+// once the block's running tasks return; onFinish() is then not called.
+// Throws std::invalid_argument if block_rows is 0 or the align options
+// are bad.
+template <typename Cursor>
+BacktestReport runBacktest(std::vector<Cursor>& cursors,
+                           const std::vector<BacktestStrategy*>& strategies,
+                           const BacktestOptions& options = {});
+
+BacktestReport runBacktest(const std::vector<SeriesSpan>& series,
+                           const std::vector<BacktestStrategy*>& strategies,
+                           const BacktestOptions& options = {});
+
+// ============================================================
+// Implementation
+// ============================================================
+
+template <typename Cursor>
+BacktestReport runBacktest(std::vector<Cursor>& cursors,
+                           const std::vector<BacktestStrategy*>& strategies,
+                           const BacktestOptions& options) {
+  if (options.block_rows == 0) {
+    throw std::invalid_argument("Backtest blocks need at least one row");
+  }
+  const auto start = std::chrono::steady_clock::now();
+  AlignedStream<Cursor> stream(cursors, options.align);
+  const size_t series = stream.series();
+
+  struct Block {
+    std::vector<int64_t> timestamps;
+    std::vector<double> prices;  // row-major, series per row
+    size_t rows = 0;
+  };
+  Block blocks[2];
+  for (auto& block : blocks) {
+    block.timestamps.resize(options.block_rows);
+    block.prices.resize(options.block_rows * series);
+  }
+  auto fill = [&](Block& block) {
+    block.rows = 0;
+    while (block.rows < options.block_rows &&
+           stream.next(block.timestamps[block.rows],
+                       block.prices.data() + block.rows * series)) {
+      ++block.rows;
+    }
+  };
+
+  for (auto* strategy : strategies) {
+    strategy->onStart(series);
+  }
+
+  auto& executor = options.executor ? *options.executor
+                                    : Concurrency::Executor::shared();
+  const size_t parallelism = options.max_parallelism == 0
+                                 ? executor.threadCount() + 1
+                                 : options.max_parallelism;
+  BacktestReport report;
+  report.strategies = strategies.size();
+  size_t current = 0;
+  fill(blocks[current]);
+  while (blocks[current].rows > 0) {
+    const Block& block = blocks[current];
+    Block& next = blocks[1 - current];
+    // A short block was the end of the stream
+    const bool more = block.rows == options.block_rows;
+    next.rows = 0;
+    const uint64_t first = report.ticks;
+    // Task 0 reads ahead, so it is claimed first
+    const size_t reader = more ? 1 : 0;
+    executor.parallelFor(
+        strategies.size() + reader, parallelism, [&](size_t task) {
+          if (task < reader) {
+            fill(next);
+            return;
+          }
+          BacktestStrategy& strategy = *strategies[task - reader];
+          BacktestTick tick;
+          for (size_t row = 0; row < block.rows; ++row) {
+            tick.timestamp_ms = block.timestamps[row];
+            tick.index = first + row;
+            tick.prices =
+                ValueSpan(block.prices.data() + row * series, series);
+            strategy.onTick(tick);
+          }
+        });
+    report.ticks += block.rows;
+    current = 1 - current;
+  }
+
+  for (auto* strategy : strategies) {
+    strategy->onFinish();
+  }
+
+  report.elapsed_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  if (report.elapsed_seconds > 0.0) {
+    report.ticks_per_second =
+        static_cast<double>(report.ticks) / report.elapsed_seconds;
+    report.strategy_ticks_per_second =
+        report.ticks_per_second * static_cast<double>(report.strategies);
+  }
+  return report;
+}
+
+}  // namespace Analytics
+
+#endif  // ANALYTICS_SERIES_BACKTEST_H_
@@ -0,0 +1,104 @@
+#ifndef ANALYTICS_SERIES_COVARIANCE_H_
+#define ANALYTICS_SERIES_COVARIANCE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "executor.h"
+#include "series_align.h"
+#include "series_stats.h"
+
+namespace Analytics {
+
+// ============================================================
+// Options and Output
+// ============================================================
+
+enum class ReturnMethod {
+  Log,     // log(p[t] / p[t - 1]); prices must be positive
+  Simple,  // p[t] / p[t - 1] - 1
+};
+
+struct CovarianceOptions {
+  ReturnMethod returns = ReturnMethod::Log;
+  // Where the tiles run; nullptr is Executor::shared()
+  Concurrency::Executor* executor = nullptr;
+  // Threads working on one matrix, the caller's included; 0 is every
+  // executor worker plus the caller
+  size_t max_parallelism = 0;
+};
+
+// Sample covariance (n - 1) of every pair of return series, row-major
+struct CovarianceMatrix {
+  size_t assets = 0;
+  size_t observations = 0;     // returns per series
+  std::vector<double> means;   // mean return per series
+  std::vector<double> values;  // assets x assets; 0 below two returns
+
+  double at(size_t i, size_t j) const { return values[i * assets + j]; }
+
+  // Pearson correlation, row-major; NaN in the rows and columns of a
+  // series with zero variance
+  std::vector<double> correlation() const;
+};
+
+// ============================================================
+// Covariance Matrix
+// ============================================================
+
+// Covariance of the returns of every column of prices, as aligned by
+// align(). Only rows where every series has a price count: returns run
+// from one such row to the next, so a NaN anywhere drops that time for
+// all series. Returns are computed once per series and demeaned; the
+// N x N product then runs in cache-sized tiles of series and time on
+// the executor, with the multi-dot SIMD kernel as its inner loop. Work
+// is N^2 * T / 2 multiply-adds; memory is N * T returns.
+CovarianceMatrix covarianceMatrix(const AlignedFrame& prices,
+                                  const CovarianceOptions& options = {});
+
+// The same over returns already computed, one span per series, ignoring
+// options.returns. Throws std::invalid_argument if the spans differ in
+// length.
+CovarianceMatrix covarianceMatrix(const std::vector<ValueSpan>& returns,
+                                  const CovarianceOptions& options = {});
+
+// ============================================================
+// Incremental Updates
+// ============================================================
+
+// Keeps a covariance matrix current as aligned rows arrive, for a live
+// risk view that would otherwise recompute O(N^2 * T) per tick. Each
+// update() is one rank-1 Welford step, O(N^2), with the same result as
+// covarianceMatrix() over all rows so far, up to rounding.
+class IncrementalCovariance {
+ public:
+  // No history yet: the first complete row only sets the base prices
+  explicit IncrementalCovariance(size_t assets,
+                                 ReturnMethod returns = ReturnMethod::Log);
+  // Seeded with covarianceMatrix(prices, options), then continued from
+  // the last complete row of prices
+  explicit IncrementalCovariance(const AlignedFrame& prices,
+                                 const CovarianceOptions& options = {});
+
+  // Adds the returns from the last complete row to prices, one price per
+  // series in column order. A row with a NaN is skipped and returns
+  // false. Throws std::invalid_argument if prices has the wrong size.
+  bool update(ValueSpan prices);
+
+  size_t assets() const { return m_assets; }
+  size_t observations() const { return m_count; }
+  CovarianceMatrix covariance() const;
+
+ private:
+  size_t m_assets;
+  ReturnMethod m_returns;
+  size_t m_count = 0;
+  std::vector<double> m_last;       // last complete row; empty before one
+  std::vector<double> m_means;      // running mean return per series
+  std::vector<double> m_comoments;  // sums of deviation products
+  std::vector<double> m_deltas;     // scratch for update()
+};
+
+}  // namespace Analytics
+
+#endif  // ANALYTICS_SERIES_COVARIANCE_H_
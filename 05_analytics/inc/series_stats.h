@@ -0,0 +1,96 @@
+#ifndef ANALYTICS_SERIES_STATS_H_
+#define ANALYTICS_SERIES_STATS_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace Analytics {
+
+// ============================================================
+// ValueSpan
+// ============================================================
+
+// Non-owning view over contiguous doubles. The SoA input for the kernels,
+// e.g. the value column of TimeSeriesRepository::getPointColumns().
+class ValueSpan {
+ public:
+  constexpr ValueSpan() = default;
+  constexpr ValueSpan(const double* data, size_t size)
+      : m_data(data), m_size(size) {}
+  ValueSpan(const std::vector<double>& values)  // NOLINT: implicit by design
+      : m_data(values.data()), m_size(values.size()) {}
+
+  constexpr const double* data() const { return m_data; }
+  constexpr size_t size() const { return m_size; }
+  constexpr bool empty() const { return m_size == 0; }
+  constexpr const double* begin() const { return m_data; }
+  constexpr const double* end() const { return m_data + m_size; }
+
+ private:
+  const double* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+// ============================================================
+// Statistics Kernels
+// ============================================================
+
+// Vectorized with AVX2+FMA on x86-64 CPUs that have it and with NEON on
+// AArch64, chosen once at startup; everything else runs the scalar
+// kernels. SIMD paths sum in a different order, so results can differ
+// from the scalar ones in the last few ulps. Inputs must not contain NaN:
+// min/max propagate it differently per instruction set.
+
+struct Summary {
+  size_t count = 0;
+  double mean = 0.0;
+  double variance = 0.0;  // sample variance (n - 1); 0 below two values
+  double min = 0.0;
+  double max = 0.0;
+};
+
+double sum(ValueSpan values);
+
+// Throw std::invalid_argument on an empty span
+double mean(ValueSpan values);
+double min(ValueSpan values);
+double max(ValueSpan values);
+
+// Sample variance (n - 1), two-pass; 0 below two values
+double variance(ValueSpan values);
+
+// All of the above; a zeroed Summary for an empty span
+Summary summarize(ValueSpan values);
+
+// log(prices[i + 1] / prices[i]); prices.size() - 1 values. Only the
+// ratios are vectorized; the logarithms use std::log.
+std::vector<double> logReturns(ValueSpan prices);
+
+// Sample covariance (n - 1); 0 below two values. Throws
+// std::invalid_argument if the spans differ in length.
+double covariance(ValueSpan x, ValueSpan y);
+
+// x[i] * y[i], e.g. quantities times prices. Throws
+// std::invalid_argument if the spans differ in length.
+std::vector<double> multiply(ValueSpan x, ValueSpan y);
+
+// values[i] * factor
+std::vector<double> scale(ValueSpan values, double factor);
+
+// ============================================================
+// Dispatch
+// ============================================================
+
+enum class SimdLevel { Scalar, Avx2, Neon };
+
+// Best level this CPU and build support
+SimdLevel detectedSimdLevel();
+SimdLevel activeSimdLevel();
+
+// Switches every kernel to level, for tests and benchmarks. Returns false
+// (and changes nothing) if the CPU or build cannot run it.
+bool setSimdLevel(SimdLevel level);
+
+}  // namespace Analytics
+
+#endif  // ANALYTICS_SERIES_STATS_H_
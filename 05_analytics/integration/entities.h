@@ -0,0 +1,254 @@
+#ifndef DOMAIN_ENTITIES_H_
+#define DOMAIN_ENTITIES_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Entities {
+
+// ============================================================
+// Compact Identifiers
+// ============================================================
+
+// An id of up to Capacity bytes held inline, for short codes such as unit
+// ids: no heap allocation, and Capacity + 1 bytes. Making one from a
+// longer id throws std::length_error; fits() checks first.
+template <size_t Capacity>
+class InlineId {
+  static_assert(Capacity < 256, "the size is kept in one byte");
+
+ public:
+  InlineId() = default;
+  explicit InlineId(std::string_view id) {
+    if (!fits(id)) {
+      throw std::length_error("Id longer than " + std::to_string(Capacity) +
+                              " bytes: " + std::string(id));
+    }
+    std::memcpy(m_bytes.data(), id.data(), id.size());
+    m_size = static_cast<uint8_t>(id.size());
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+  static constexpr bool fits(std::string_view id) {
+    return id.size() <= Capacity;
+  }
+
+  std::string_view view() const { return {m_bytes.data(), m_size}; }
+  std::string str() const { return std::string(view()); }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  friend bool operator==(const InlineId& a, const InlineId& b) {
+    return a.view() == b.view();
+  }
+  friend bool operator!=(const InlineId& a, const InlineId& b) {
+    return !(a == b);
+  }
+  friend bool operator<(const InlineId& a, const InlineId& b) {
+    return a.view() < b.view();
+  }
+
+ private:
+  std::array<char, Capacity> m_bytes{};
+  uint8_t m_size = 0;
+};
+
+// Unit ids are short codes ("EUR", "degC"); 16 bytes
+using UnitCode = InlineId<15>;
+
+// A UUID as its 16 bytes rather than 36 characters
+class Uuid {
+ public:
+  Uuid() = default;  // the nil UUID
+  explicit Uuid(const std::array<uint8_t, 16>& bytes) : m_bytes(bytes) {}
+
+  // The 8-4-4-4-12 hex form, in either case; nullopt for anything else
+  static std::optional<Uuid> parse(std::string_view text) {
+    if (text.size() != 36) {
+      return std::nullopt;
+    }
+    Uuid uuid;
+    size_t byte = 0;
+    for (size_t i = 0; i < text.size();) {
+      if (i == 8 || i == 13 || i == 18 || i == 23) {
+        if (text[i++] != '-') {
+          return std::nullopt;
+        }
+        continue;
+      }
+      const int high = hexDigit(text[i]);
+      const int low = hexDigit(text[i + 1]);
+      if (high < 0 || low < 0) {
+        return std::nullopt;
+      }
+      uuid.m_bytes[byte++] = static_cast<uint8_t>(high << 4 | low);
+      i += 2;
+    }
+    return uuid;
+  }
+
+  // The lower-case 8-4-4-4-12 form
+  std::string str() const {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string text;
+    text.reserve(36);
+    for (size_t i = 0; i < m_bytes.size(); ++i) {
+      if (i == 4 || i == 6 || i == 8 || i == 10) {
+        text += '-';
+      }
+      text += kDigits[m_bytes[i] >> 4];
+      text += kDigits[m_bytes[i] & 0x0F];
+    }
+    return text;
+  }
+
+  const std::array<uint8_t, 16>& bytes() const { return m_bytes; }
+
+  friend bool operator==(const Uuid& a, const Uuid& b) {
+    return a.m_bytes == b.m_bytes;
+  }
+  friend bool operator!=(const Uuid& a, const Uuid& b) { return !(a == b); }
+  friend bool operator<(const Uuid& a, const Uuid& b) {
+    return a.m_bytes < b.m_bytes;
+  }
+
+ private:
+  static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  std::array<uint8_t, 16> m_bytes{};
+};
+
+// ============================================================
+// Time Series Entities
+// ============================================================
+
+struct Asset {
+  std::string id;  // UUID
+  std::string name;
+  std::string description;
+  std::string source;
+};
+
+struct Unit {
+  std::string id;      // e.g., "degC", "EUR", "USD"
+  std::string symbol;  // e.g., "°C", "€", "$"
+  std::string name;    // e.g., "Degrees Celsius", "Euro"
+};
+
+struct UnitConversion {
+  std::string from_unit_id;
+  std::string to_unit_id;
+  double factor;  // to = from * factor
+};
+
+struct TimeSeriesPoint {
+  std::string asset_id;
+  int64_t timestamp_ms;  // Unix milliseconds
+  std::string unit_id;
+  double value;
+};
+
+// A TimeSeriesPoint without the asset id, which its CompactSeries holds
+// once, and with the unit id inline: 32 bytes and no heap, where a
+// TimeSeriesPoint is 80 bytes and its two ids may allocate
+struct CompactPoint {
+  int64_t timestamp_ms;  // Unix milliseconds
+  double value;
+  UnitCode unit_id;
+};
+static_assert(sizeof(CompactPoint) == 32, "CompactPoint grew");
+
+// One asset's points in the compact form
+struct CompactSeries {
+  std::string asset_id;
+  std::vector<CompactPoint> points;
+};
+
+// One instrument's points from a network source, or why it failed
+struct InstrumentFetch {
+  std::string instrument_id;
+  std::vector<TimeSeriesPoint> points;
+  std::optional<std::string> error;
+};
+
+// ============================================================
+// Key-Value Storage Entities
+// ============================================================
+
+struct Setting {
+  std::string key;
+  std::string value;
+  std::optional<std::string> description;
+};
+
+// ============================================================
+// Account Entities
+// ============================================================
+
+struct Account {
+  std::string id;  // UUID or user-provided
+  std::string name;
+  std::optional<std::vector<uint8_t>> password_hash;
+  int64_t created_at;  // Unix milliseconds
+};
+
+// The uniqueness rule a new account broke, if any. The id is checked
+// before the name.
+enum class AccountConflict { None, Id, Name };
+
+// Account without its password hash, for listings
+struct AccountSummary {
+  std::string id;
+  std::string name;
+  int64_t created_at;  // Unix milliseconds
+};
+
+struct AccountProperty {
+  std::string account_id;
+  std::string key;
+  std::string value;
+  std::optional<std::string> description;
+};
+
+struct AccountWithProperties {
+  AccountSummary account;
+  std::vector<AccountProperty> properties;  // ordered by key
+};
+
+}  // namespace Entities
+
+// ============================================================
+// Hashing
+// ============================================================
+
+template <size_t Capacity>
+struct std::hash<Entities::InlineId<Capacity>> {
+  size_t operator()(const Entities::InlineId<Capacity>& id) const noexcept {
+    return std::hash<std::string_view>()(id.view());
+  }
+};
+
+template <>
+struct std::hash<Entities::Uuid> {
+  size_t operator()(const Entities::Uuid& uuid) const noexcept {
+    uint64_t halves[2];
+    std::memcpy(halves, uuid.bytes().data(), sizeof(halves));
+    return std::hash<uint64_t>()(halves[0] ^
+                                 (halves[1] * 0x9E3779B97F4A7C15ULL));
+  }
+};
+
+#endif  // DOMAIN_ENTITIES_H_
@@ -0,0 +1,46 @@
+#include "series_align.h"
+
+namespace Analytics {
+
+SeriesSpan::SeriesSpan(const std::vector<int64_t>& timestamps,
+                       const std::vector<double>& values)
+    : timestamps(timestamps.data()),
+      values(values.data()),
+      size(timestamps.size()) {
+  if (timestamps.size() != values.size()) {
+    throw std::invalid_argument("Timestamps and values differ in length");
+  }
+}
+
+namespace detail {
+
+void validateAlignOptions(const AlignOptions& options) {
+  if (options.step_ms < 0) {
+    throw std::invalid_argument("Grid step must not be negative");
+  }
+  if (options.from_ms > options.to_ms) {
+    throw std::invalid_argument("Grid starts after it ends");
+  }
+  if (options.step_ms > 0 &&
+      (options.from_ms == std::numeric_limits<int64_t>::min() ||
+       options.to_ms == std::numeric_limits<int64_t>::max())) {
+    throw std::invalid_argument("Fixed grid needs from_ms and to_ms");
+  }
+  if (options.max_staleness_ms && *options.max_staleness_ms < 0) {
+    throw std::invalid_argument("Staleness must not be negative");
+  }
+}
+
+}  // namespace detail
+
+AlignedFrame align(const std::vector<SeriesSpan>& series,
+                   const AlignOptions& options) {
+  std::vector<SpanCursor> cursors;
+  cursors.reserve(series.size());
+  for (const auto& span : series) {
+    cursors.emplace_back(span);
+  }
+  return align(cursors, options);
+}
+
+}  // namespace Analytics
@@ -0,0 +1,16 @@
+#include "series_backtest.h"
+
+namespace Analytics {
+
+BacktestReport runBacktest(const std::vector<SeriesSpan>& series,
+                           const std::vector<BacktestStrategy*>& strategies,
+                           const BacktestOptions& options) {
+  std::vector<SpanCursor> cursors;
+  cursors.reserve(series.size());
+  for (const auto& span : series) {
+    cursors.emplace_back(span);
+  }
+  return runBacktest(cursors, strategies, options);
+}
+
+}  // namespace Analytics
@@ -0,0 +1,307 @@
+#include "series_covariance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "stats_kernels.h"
+
+namespace Analytics {
+
+namespace {
+
+// Tile sides: 32 series by 256 returns is 64 KiB per tile, so a block's
+// two tiles stay in L2 while all of its pairs are summed
+constexpr size_t kTileSeries = 32;
+constexpr size_t kTileReturns = 256;
+
+// Series-major: series i's values start at data[i * length], so each one
+// is contiguous for the kernels
+struct SeriesBlock {
+  size_t series = 0;
+  size_t length = 0;
+  std::vector<double> data;
+
+  SeriesBlock(size_t series, size_t length)
+      : series(series), length(length), data(series * length) {}
+
+  double* row(size_t i) { return data.data() + i * length; }
+  const double* row(size_t i) const { return data.data() + i * length; }
+};
+
+Concurrency::Executor& executorOf(const CovarianceOptions& options) {
+  return options.executor ? *options.executor
+                          : Concurrency::Executor::shared();
+}
+
+size_t parallelismOf(const CovarianceOptions& options,
+                     const Concurrency::Executor& executor) {
+  return options.max_parallelism == 0 ? executor.threadCount() + 1
+                                      : options.max_parallelism;
+}
+
+bool hasNaN(ValueSpan values) {
+  return std::any_of(values.begin(), values.end(),
+                     [](double value) { return std::isnan(value); });
+}
+
+// Rows of frame where every series has a price
+std::vector<size_t> completeRows(const AlignedFrame& frame) {
+  std::vector<size_t> rows;
+  for (size_t row = 0; row < frame.rows(); ++row) {
+    bool complete = true;
+    for (const auto& column : frame.columns) {
+      if (std::isnan(column[row])) {
+        complete = false;
+        break;
+      }
+    }
+    if (complete) {
+      rows.push_back(row);
+    }
+  }
+  return rows;
+}
+
+double returnOf(double previous, double price, ReturnMethod method) {
+  return method == ReturnMethod::Log ? std::log(price / previous)
+                                     : price / previous - 1.0;
+}
+
+// Returns between consecutive complete rows, one series per task
+SeriesBlock returnsOf(const AlignedFrame& frame,
+                      const std::vector<size_t>& rows,
+                      const CovarianceOptions& options) {
+  SeriesBlock returns(frame.columns.size(),
+                      rows.size() < 2 ? 0 : rows.size() - 1);
+  if (returns.length == 0) {
+    return returns;
+  }
+
+  const auto& table = Kernels::active();
+  auto& executor = executorOf(options);
+  executor.parallelFor(
+      returns.series, parallelismOf(options, executor), [&](size_t i) {
+        const auto& column = frame.columns[i];
+        std::vector<double> prices(rows.size());
+        for (size_t r = 0; r < rows.size(); ++r) {
+          prices[r] = column[rows[r]];
+        }
+        double* out = returns.row(i);
+        table.ratios(prices.data(), prices.size(), out);
+        for (size_t t = 0; t < returns.length; ++t) {
+          out[t] = options.returns == ReturnMethod::Log ? std::log(out[t])
+                                                        : out[t] - 1.0;
+        }
+      });
+  return returns;
+}
+
+// Demeans returns in place, then sums the deviation products of every
+// pair of series tile by tile. A task owns one pair of series tiles and
+// writes both mirrored blocks of the result, so tasks never share a
+// cell.
+CovarianceMatrix covarianceOf(SeriesBlock& returns,
+                              const CovarianceOptions& options) {
+  const size_t n = returns.series;
+  const size_t length = returns.length;
+  CovarianceMatrix matrix;
+  matrix.assets = n;
+  matrix.observations = length;
+  matrix.means.assign(n, 0.0);
+  matrix.values.assign(n * n, 0.0);
+  if (length == 0) {
+    return matrix;
+  }
+
+  const auto& table = Kernels::active();
+  for (size_t i = 0; i < n; ++i) {
+    double* row = returns.row(i);
+    const double mean = table.sum(row, length) / static_cast<double>(length);
+    matrix.means[i] = mean;
+    for (size_t t = 0; t < length; ++t) {
+      row[t] -= mean;
+    }
+  }
+  if (length < 2) {
+    return matrix;
+  }
+
+  const size_t tiles = (n + kTileSeries - 1) / kTileSeries;
+  std::vector<std::pair<size_t, size_t>> blocks;
+  blocks.reserve(tiles * (tiles + 1) / 2);
+  for (size_t a = 0; a < tiles; ++a) {
+    for (size_t b = a; b < tiles; ++b) {
+      blocks.emplace_back(a, b);
+    }
+  }
+
+  const double divisor = static_cast<double>(length - 1);
+  auto& executor = executorOf(options);
+  executor.parallelFor(
+      blocks.size(), parallelismOf(options, executor), [&](size_t block) {
+        const size_t i_begin = blocks[block].first * kTileSeries;
+        const size_t i_end = std::min(n, i_begin + kTileSeries);
+        const size_t j_begin = blocks[block].second * kTileSeries;
+        const size_t j_end = std::min(n, j_begin + kTileSeries);
+        const bool diagonal = i_begin == j_begin;
+
+        std::vector<double> sums(kTileSeries * kTileSeries, 0.0);
+        const double* ys[kTileSeries];
+        double dots[kTileSeries];
+        for (size_t t = 0; t < length; t += kTileReturns) {
+          const size_t span = std::min(kTileReturns, length - t);
+          for (size_t i = i_begin; i < i_end; ++i) {
+            // On the diagonal only j >= i; the mirror fills the rest
+            const size_t first = diagonal ? i : j_begin;
+            const size_t count = j_end - first;
+            for (size_t c = 0; c < count; ++c) {
+              ys[c] = returns.row(first + c) + t;
+            }
+            table.dots(returns.row(i) + t, ys, count, span, dots);
+            double* sum = &sums[(i - i_begin) * kTileSeries + first - j_begin];
+            for (size_t c = 0; c < count; ++c) {
+              sum[c] += dots[c];
+            }
+          }
+        }
+
+        for (size_t i = i_begin; i < i_end; ++i) {
+          for (size_t j = diagonal ? i : j_begin; j < j_end; ++j) {
+            const double value =
+                sums[(i - i_begin) * kTileSeries + j - j_begin] / divisor;
+            matrix.values[i * n + j] = value;
+            matrix.values[j * n + i] = value;
+          }
+        }
+      });
+  return matrix;
+}
+
+}  // namespace
+
+// ============================================================
+// Covariance Matrix
+// ============================================================
+
+std::vector<double> CovarianceMatrix::correlation() const {
+  std::vector<double> deviations(assets);
+  for (size_t i = 0; i < assets; ++i) {
+    deviations[i] = std::sqrt(at(i, i));
+  }
+
+  std::vector<double> result(assets * assets);
+  for (size_t i = 0; i < assets; ++i) {
+    for (size_t j = 0; j < assets; ++j) {
+      const double scale = deviations[i] * deviations[j];
+      result[i * assets + j] =
+          scale > 0.0 ? (i == j ? 1.0 : at(i, j) / scale)
+                      : std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+  return result;
+}
+
+CovarianceMatrix covarianceMatrix(const AlignedFrame& prices,
+                                  const CovarianceOptions& options) {
+  auto returns = returnsOf(prices, completeRows(prices), options);
+  return covarianceOf(returns, options);
+}
+
+CovarianceMatrix covarianceMatrix(const std::vector<ValueSpan>& returns,
+                                  const CovarianceOptions& options) {
+  const size_t length = returns.empty() ? 0 : returns.front().size();
+  SeriesBlock block(returns.size(), length);
+  for (size_t i = 0; i < returns.size(); ++i) {
+    if (returns[i].size() != length) {
+      throw std::invalid_argument("Series differ in length");
+    }
+    std::copy(returns[i].begin(), returns[i].end(), block.row(i));
+  }
+  return covarianceOf(block, options);
+}
+
+// ============================================================
+// IncrementalCovariance
+// ============================================================
+
+IncrementalCovariance::IncrementalCovariance(size_t assets,
+                                             ReturnMethod returns)
+    : m_assets(assets),
+      m_returns(returns),
+      m_means(assets, 0.0),
+      m_comoments(assets * assets, 0.0),
+      m_deltas(assets) {}
+
+IncrementalCovariance::IncrementalCovariance(const AlignedFrame& prices,
+                                             const CovarianceOptions& options)
+    : IncrementalCovariance(prices.columns.size(), options.returns) {
+  const auto rows = completeRows(prices);
+  if (rows.empty()) {
+    return;
+  }
+  auto returns = returnsOf(prices, rows, options);
+  auto matrix = covarianceOf(returns, options);
+
+  m_count = matrix.observations;
+  m_means = std::move(matrix.means);
+  const double divisor = m_count < 2 ? 0.0 : static_cast<double>(m_count - 1);
+  for (size_t cell = 0; cell < m_comoments.size(); ++cell) {
+    m_comoments[cell] = matrix.values[cell] * divisor;
+  }
+  m_last.reserve(m_assets);
+  for (const auto& column : prices.columns) {
+    m_last.push_back(column[rows.back()]);
+  }
+}
+
+bool IncrementalCovariance::update(ValueSpan prices) {
+  if (prices.size() != m_assets) {
+    throw std::invalid_argument("Expected one price per series");
+  }
+  if (hasNaN(prices)) {
+    return false;
+  }
+  if (m_last.empty()) {
+    m_last.assign(prices.begin(), prices.end());
+    return true;
+  }
+
+  // C += (r - mean_old)(r - mean_new)', where r - mean_new is
+  // (r - mean_old) * (n - 1) / n: a symmetric rank-1 update, one
+  // multiply-add pass per row
+  ++m_count;
+  const double count = static_cast<double>(m_count);
+  for (size_t i = 0; i < m_assets; ++i) {
+    m_deltas[i] =
+        returnOf(m_last[i], prices.data()[i], m_returns) - m_means[i];
+    m_means[i] += m_deltas[i] / count;
+  }
+  const auto& table = Kernels::active();
+  const double weight = (count - 1.0) / count;
+  for (size_t i = 0; i < m_assets; ++i) {
+    table.addScaled(m_deltas.data(), m_assets, m_deltas[i] * weight,
+                    m_comoments.data() + i * m_assets);
+  }
+  std::copy(prices.begin(), prices.end(), m_last.begin());
+  return true;
+}
+
+CovarianceMatrix IncrementalCovariance::covariance() const {
+  CovarianceMatrix matrix;
+  matrix.assets = m_assets;
+  matrix.observations = m_count;
+  matrix.means = m_means;
+  matrix.values.assign(m_assets * m_assets, 0.0);
+  if (m_count >= 2) {
+    const double divisor = static_cast<double>(m_count - 1);
+    for (size_t cell = 0; cell < m_comoments.size(); ++cell) {
+      matrix.values[cell] = m_comoments[cell] / divisor;
+    }
+  }
+  return matrix;
+}
+
+}  // namespace Analytics
@@ -0,0 +1,282 @@
+#include "series_stats.h"
+
+#include <atomic>
+#include <cmath>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "stats_kernels.h"
+
+namespace Analytics {
+
+// ============================================================
+// Scalar Kernels
+// ============================================================
+
+namespace Kernels {
+namespace {
+
+double scalarSum(const double* data, size_t n) {
+  double total = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    total += data[i];
+  }
+  return total;
+}
+
+double scalarSumSquaredDeviations(const double* data, size_t n, double mean) {
+  double total = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    const double d = data[i] - mean;
+    total += d * d;
+  }
+  return total;
+}
+
+double scalarSumCrossDeviations(const double* x, const double* y, size_t n,
+                                double mean_x, double mean_y) {
+  double total = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    total += (x[i] - mean_x) * (y[i] - mean_y);
+  }
+  return total;
+}
+
+void scalarMinMax(const double* data, size_t n, double* min, double* max) {
+  double lo = data[0];
+  double hi = data[0];
+  for (size_t i = 1; i < n; ++i) {
+    lo = data[i] < lo ? data[i] : lo;
+    hi = data[i] > hi ? data[i] : hi;
+  }
+  *min = lo;
+  *max = hi;
+}
+
+void scalarRatios(const double* data, size_t n, double* out) {
+  for (size_t i = 0; i + 1 < n; ++i) {
+    out[i] = data[i + 1] / data[i];
+  }
+}
+
+void scalarMultiply(const double* x, const double* y, size_t n, double* out) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = x[i] * y[i];
+  }
+}
+
+void scalarScale(const double* data, size_t n, double factor, double* out) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = data[i] * factor;
+  }
+}
+
+void scalarDots(const double* x, const double* const* ys, size_t count,
+                size_t n, double* out) {
+  for (size_t c = 0; c < count; ++c) {
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      total += x[i] * ys[c][i];
+    }
+    out[c] = total;
+  }
+}
+
+void scalarAddScaled(const double* data, size_t n, double factor,
+                     double* out) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] += data[i] * factor;
+  }
+}
+
+}  // namespace
+
+const Table kScalar = {
+    SimdLevel::Scalar,
+    scalarSum,
+    scalarSumSquaredDeviations,
+    scalarSumCrossDeviations,
+    scalarMinMax,
+    scalarRatios,
+    scalarMultiply,
+    scalarScale,
+    scalarDots,
+    scalarAddScaled,
+};
+
+}  // namespace Kernels
+
+// ============================================================
+// Dispatch
+// ============================================================
+
+namespace {
+
+const Kernels::Table* tableFor(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::Scalar:
+      return &Kernels::kScalar;
+    case SimdLevel::Avx2:
+#if defined(__x86_64__) || defined(__i386__)
+      if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return &Kernels::kAvx2;
+      }
+#endif
+      return nullptr;
+    case SimdLevel::Neon:
+#if defined(__aarch64__)
+      return &Kernels::kNeon;  // baseline on AArch64
+#else
+      return nullptr;
+#endif
+  }
+  return nullptr;
+}
+
+const Kernels::Table* detectTable() {
+  for (auto level : {SimdLevel::Avx2, SimdLevel::Neon}) {
+    if (const auto* table = tableFor(level)) {
+      return table;
+    }
+  }
+  return &Kernels::kScalar;
+}
+
+std::atomic<const Kernels::Table*>& activeTable() {
+  static std::atomic<const Kernels::Table*> table{detectTable()};
+  return table;
+}
+
+const Kernels::Table& kernels() { return Kernels::active(); }
+
+void requireValues(ValueSpan values) {
+  if (values.empty()) {
+    throw std::invalid_argument("Empty series");
+  }
+}
+
+}  // namespace
+
+const Kernels::Table& Kernels::active() {
+  return *activeTable().load(std::memory_order_relaxed);
+}
+
+SimdLevel detectedSimdLevel() { return detectTable()->level; }
+
+SimdLevel activeSimdLevel() { return kernels().level; }
+
+bool setSimdLevel(SimdLevel level) {
+  const auto* table = tableFor(level);
+  if (!table) {
+    return false;
+  }
+  activeTable().store(table, std::memory_order_relaxed);
+  return true;
+}
+
+// ============================================================
+// Statistics
+// ============================================================
+
+double sum(ValueSpan values) {
+  return values.empty() ? 0.0 : kernels().sum(values.data(), values.size());
+}
+
+double mean(ValueSpan values) {
+  requireValues(values);
+  return sum(values) / static_cast<double>(values.size());
+}
+
+double min(ValueSpan values) {
+  requireValues(values);
+  double lo;
+  double hi;
+  kernels().minMax(values.data(), values.size(), &lo, &hi);
+  return lo;
+}
+
+double max(ValueSpan values) {
+  requireValues(values);
+  double lo;
+  double hi;
+  kernels().minMax(values.data(), values.size(), &lo, &hi);
+  return hi;
+}
+
+double variance(ValueSpan values) {
+  if (values.size() < 2) {
+    return 0.0;
+  }
+  const double m = mean(values);
+  return kernels().sumSquaredDeviations(values.data(), values.size(), m) /
+         static_cast<double>(values.size() - 1);
+}
+
+Summary summarize(ValueSpan values) {
+  Summary summary;
+  if (values.empty()) {
+    return summary;
+  }
+
+  const auto& table = kernels();
+  const size_t n = values.size();
+  summary.count = n;
+  summary.mean = table.sum(values.data(), n) / static_cast<double>(n);
+  if (n > 1) {
+    summary.variance =
+        table.sumSquaredDeviations(values.data(), n, summary.mean) /
+        static_cast<double>(n - 1);
+  }
+  table.minMax(values.data(), n, &summary.min, &summary.max);
+  return summary;
+}
+
+std::vector<double> logReturns(ValueSpan prices) {
+  if (prices.size() < 2) {
+    return {};
+  }
+
+  std::vector<double> returns(prices.size() - 1);
+  kernels().ratios(prices.data(), prices.size(), returns.data());
+  for (double& value : returns) {
+    value = std::log(value);
+  }
+  return returns;
+}
+
+std::vector<double> multiply(ValueSpan x, ValueSpan y) {
+  if (x.size() != y.size()) {
+    throw std::invalid_argument("Series differ in length");
+  }
+  std::vector<double> products(x.size());
+  if (!x.empty()) {
+    kernels().multiply(x.data(), y.data(), x.size(), products.data());
+  }
+  return products;
+}
+
+std::vector<double> scale(ValueSpan values, double factor) {
+  std::vector<double> scaled(values.size());
+  if (!values.empty()) {
+    kernels().scale(values.data(), values.size(), factor, scaled.data());
+  }
+  return scaled;
+}
+
+double covariance(ValueSpan x, ValueSpan y) {
+  if (x.size() != y.size()) {
+    throw std::invalid_argument("Series differ in length");
+  }
+  if (x.size() < 2) {
+    return 0.0;
+  }
+
+  const auto& table = kernels();
+  const size_t n = x.size();
+  const double mean_x = table.sum(x.data(), n) / static_cast<double>(n);
+  const double mean_y = table.sum(y.data(), n) / static_cast<double>(n);
+  return table.sumCrossDeviations(x.data(), y.data(), n, mean_x, mean_y) /
+         static_cast<double>(n - 1);
+}
+
+}  // namespace Analytics
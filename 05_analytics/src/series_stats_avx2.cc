@@ -0,0 +1,269 @@
+// AVX2+FMA kernels. Compiled for any x86 target: each function carries a
+// target attribute, and dispatch only selects them when the CPU reports
+// both extensions.
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#include "stats_kernels.h"
+
+#define ANALYTICS_AVX2 __attribute__((target("avx2,fma")))
+
+namespace Analytics::Kernels {
+namespace {
+
+// Four independent accumulators hide the add latency
+constexpr size_t kLanes = 4;
+constexpr size_t kStride = 4 * kLanes;
+
+ANALYTICS_AVX2 double horizontalSum(__m256d v) {
+  __m128d low = _mm256_castpd256_pd128(v);
+  __m128d high = _mm256_extractf128_pd(v, 1);
+  low = _mm_add_pd(low, high);
+  return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+ANALYTICS_AVX2 double avx2Sum(const double* data, size_t n) {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  __m256d acc2 = _mm256_setzero_pd();
+  __m256d acc3 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + kStride <= n; i += kStride) {
+    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+    acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+    acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(data + i + 8));
+    acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(data + i + 12));
+  }
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+  }
+
+  double total = horizontalSum(
+      _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+  for (; i < n; ++i) {
+    total += data[i];
+  }
+  return total;
+}
+
+ANALYTICS_AVX2 double avx2SumSquaredDeviations(const double* data, size_t n,
+                                               double mean) {
+  const __m256d m = _mm256_set1_pd(mean);
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  __m256d acc2 = _mm256_setzero_pd();
+  __m256d acc3 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + kStride <= n; i += kStride) {
+    __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(data + i), m);
+    __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 4), m);
+    __m256d d2 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 8), m);
+    __m256d d3 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 12), m);
+    acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+    acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+    acc2 = _mm256_fmadd_pd(d2, d2, acc2);
+    acc3 = _mm256_fmadd_pd(d3, d3, acc3);
+  }
+  for (; i + 4 <= n; i += 4) {
+    __m256d d = _mm256_sub_pd(_mm256_loadu_pd(data + i), m);
+    acc0 = _mm256_fmadd_pd(d, d, acc0);
+  }
+
+  double total = horizontalSum(
+      _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+  for (; i < n; ++i) {
+    const double d = data[i] - mean;
+    total += d * d;
+  }
+  return total;
+}
+
+ANALYTICS_AVX2 double avx2SumCrossDeviations(const double* x, const double* y,
+                                             size_t n, double mean_x,
+                                             double mean_y) {
+  const __m256d mx = _mm256_set1_pd(mean_x);
+  const __m256d my = _mm256_set1_pd(mean_y);
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), mx);
+    __m256d dy0 = _mm256_sub_pd(_mm256_loadu_pd(y + i), my);
+    __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), mx);
+    __m256d dy1 = _mm256_sub_pd(_mm256_loadu_pd(y + i + 4), my);
+    acc0 = _mm256_fmadd_pd(dx0, dy0, acc0);
+    acc1 = _mm256_fmadd_pd(dx1, dy1, acc1);
+  }
+  for (; i + 4 <= n; i += 4) {
+    __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), mx);
+    __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), my);
+    acc0 = _mm256_fmadd_pd(dx, dy, acc0);
+  }
+
+  double total = horizontalSum(_mm256_add_pd(acc0, acc1));
+  for (; i < n; ++i) {
+    total += (x[i] - mean_x) * (y[i] - mean_y);
+  }
+  return total;
+}
+
+ANALYTICS_AVX2 void avx2MinMax(const double* data, size_t n, double* min,
+                               double* max) {
+  __m256d lo = _mm256_set1_pd(data[0]);
+  __m256d hi = lo;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d v = _mm256_loadu_pd(data + i);
+    lo = _mm256_min_pd(lo, v);
+    hi = _mm256_max_pd(hi, v);
+  }
+
+  alignas(32) double los[4];
+  alignas(32) double his[4];
+  _mm256_store_pd(los, lo);
+  _mm256_store_pd(his, hi);
+  double low = los[0];
+  double high = his[0];
+  for (int lane = 1; lane < 4; ++lane) {
+    low = los[lane] < low ? los[lane] : low;
+    high = his[lane] > high ? his[lane] : high;
+  }
+  for (; i < n; ++i) {
+    low = data[i] < low ? data[i] : low;
+    high = data[i] > high ? data[i] : high;
+  }
+  *min = low;
+  *max = high;
+}
+
+ANALYTICS_AVX2 void avx2Ratios(const double* data, size_t n, double* out) {
+  const size_t count = n - 1;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(data + i + 1),
+                                            _mm256_loadu_pd(data + i)));
+  }
+  for (; i < count; ++i) {
+    out[i] = data[i + 1] / data[i];
+  }
+}
+
+ANALYTICS_AVX2 void avx2Multiply(const double* x, const double* y, size_t n,
+                                 double* out) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(x + i),
+                                            _mm256_loadu_pd(y + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] = x[i] * y[i];
+  }
+}
+
+ANALYTICS_AVX2 void avx2Scale(const double* data, size_t n, double factor,
+                              double* out) {
+  const __m256d f = _mm256_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(data + i), f));
+  }
+  for (; i < n; ++i) {
+    out[i] = data[i] * factor;
+  }
+}
+
+ANALYTICS_AVX2 double avx2Dot(const double* x, const double* y, size_t n) {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i),
+                           acc0);
+    acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4),
+                           _mm256_loadu_pd(y + i + 4), acc1);
+  }
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i),
+                           acc0);
+  }
+
+  double total = horizontalSum(_mm256_add_pd(acc0, acc1));
+  for (; i < n; ++i) {
+    total += x[i] * y[i];
+  }
+  return total;
+}
+
+// Four ys at a time: each load of x feeds four independent FMA chains
+ANALYTICS_AVX2 void avx2Dots(const double* x, const double* const* ys,
+                             size_t count, size_t n, double* out) {
+  size_t c = 0;
+  for (; c + 4 <= count; c += 4) {
+    const double* y0 = ys[c];
+    const double* y1 = ys[c + 1];
+    const double* y2 = ys[c + 2];
+    const double* y3 = ys[c + 3];
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const __m256d v = _mm256_loadu_pd(x + i);
+      acc0 = _mm256_fmadd_pd(v, _mm256_loadu_pd(y0 + i), acc0);
+      acc1 = _mm256_fmadd_pd(v, _mm256_loadu_pd(y1 + i), acc1);
+      acc2 = _mm256_fmadd_pd(v, _mm256_loadu_pd(y2 + i), acc2);
+      acc3 = _mm256_fmadd_pd(v, _mm256_loadu_pd(y3 + i), acc3);
+    }
+    double t0 = horizontalSum(acc0);
+    double t1 = horizontalSum(acc1);
+    double t2 = horizontalSum(acc2);
+    double t3 = horizontalSum(acc3);
+    for (; i < n; ++i) {
+      t0 += x[i] * y0[i];
+      t1 += x[i] * y1[i];
+      t2 += x[i] * y2[i];
+      t3 += x[i] * y3[i];
+    }
+    out[c] = t0;
+    out[c + 1] = t1;
+    out[c + 2] = t2;
+    out[c + 3] = t3;
+  }
+  for (; c < count; ++c) {
+    out[c] = avx2Dot(x, ys[c], n);
+  }
+}
+
+ANALYTICS_AVX2 void avx2AddScaled(const double* data, size_t n, double factor,
+                                  double* out) {
+  const __m256d f = _mm256_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_fmadd_pd(_mm256_loadu_pd(data + i), f,
+                                              _mm256_loadu_pd(out + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] += data[i] * factor;
+  }
+}
+
+}  // namespace
+
+const Table kAvx2 = {
+    SimdLevel::Avx2,
+    avx2Sum,
+    avx2SumSquaredDeviations,
+    avx2SumCrossDeviations,
+    avx2MinMax,
+    avx2Ratios,
+    avx2Multiply,
+    avx2Scale,
+    avx2Dots,
+    avx2AddScaled,
+};
+
+}  // namespace Analytics::Kernels
+
+#endif  // __x86_64__ || __i386__
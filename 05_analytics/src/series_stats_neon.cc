@@ -0,0 +1,226 @@
+// NEON kernels. Advanced SIMD is mandatory on AArch64, so no runtime
+// check is needed; other targets compile this file to nothing.
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+#include "stats_kernels.h"
+
+namespace Analytics::Kernels {
+namespace {
+
+double neonSum(const double* data, size_t n) {
+  float64x2_t acc0 = vdupq_n_f64(0.0);
+  float64x2_t acc1 = vdupq_n_f64(0.0);
+  float64x2_t acc2 = vdupq_n_f64(0.0);
+  float64x2_t acc3 = vdupq_n_f64(0.0);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = vaddq_f64(acc0, vld1q_f64(data + i));
+    acc1 = vaddq_f64(acc1, vld1q_f64(data + i + 2));
+    acc2 = vaddq_f64(acc2, vld1q_f64(data + i + 4));
+    acc3 = vaddq_f64(acc3, vld1q_f64(data + i + 6));
+  }
+  for (; i + 2 <= n; i += 2) {
+    acc0 = vaddq_f64(acc0, vld1q_f64(data + i));
+  }
+
+  double total =
+      vaddvq_f64(vaddq_f64(vaddq_f64(acc0, acc1), vaddq_f64(acc2, acc3)));
+  for (; i < n; ++i) {
+    total += data[i];
+  }
+  return total;
+}
+
+double neonSumSquaredDeviations(const double* data, size_t n, double mean) {
+  const float64x2_t m = vdupq_n_f64(mean);
+  float64x2_t acc0 = vdupq_n_f64(0.0);
+  float64x2_t acc1 = vdupq_n_f64(0.0);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float64x2_t d0 = vsubq_f64(vld1q_f64(data + i), m);
+    float64x2_t d1 = vsubq_f64(vld1q_f64(data + i + 2), m);
+    acc0 = vfmaq_f64(acc0, d0, d0);
+    acc1 = vfmaq_f64(acc1, d1, d1);
+  }
+  for (; i + 2 <= n; i += 2) {
+    float64x2_t d = vsubq_f64(vld1q_f64(data + i), m);
+    acc0 = vfmaq_f64(acc0, d, d);
+  }
+
+  double total = vaddvq_f64(vaddq_f64(acc0, acc1));
+  for (; i < n; ++i) {
+    const double d = data[i] - mean;
+    total += d * d;
+  }
+  return total;
+}
+
+double neonSumCrossDeviations(const double* x, const double* y, size_t n,
+                              double mean_x, double mean_y) {
+  const float64x2_t mx = vdupq_n_f64(mean_x);
+  const float64x2_t my = vdupq_n_f64(mean_y);
+  float64x2_t acc0 = vdupq_n_f64(0.0);
+  float64x2_t acc1 = vdupq_n_f64(0.0);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc0 = vfmaq_f64(acc0, vsubq_f64(vld1q_f64(x + i), mx),
+                     vsubq_f64(vld1q_f64(y + i), my));
+    acc1 = vfmaq_f64(acc1, vsubq_f64(vld1q_f64(x + i + 2), mx),
+                     vsubq_f64(vld1q_f64(y + i + 2), my));
+  }
+  for (; i + 2 <= n; i += 2) {
+    acc0 = vfmaq_f64(acc0, vsubq_f64(vld1q_f64(x + i), mx),
+                     vsubq_f64(vld1q_f64(y + i), my));
+  }
+
+  double total = vaddvq_f64(vaddq_f64(acc0, acc1));
+  for (; i < n; ++i) {
+    total += (x[i] - mean_x) * (y[i] - mean_y);
+  }
+  return total;
+}
+
+void neonMinMax(const double* data, size_t n, double* min, double* max) {
+  float64x2_t lo = vdupq_n_f64(data[0]);
+  float64x2_t hi = lo;
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    float64x2_t v = vld1q_f64(data + i);
+    lo = vminq_f64(lo, v);
+    hi = vmaxq_f64(hi, v);
+  }
+
+  double low = vminvq_f64(lo);
+  double high = vmaxvq_f64(hi);
+  for (; i < n; ++i) {
+    low = data[i] < low ? data[i] : low;
+    high = data[i] > high ? data[i] : high;
+  }
+  *min = low;
+  *max = high;
+}
+
+void neonRatios(const double* data, size_t n, double* out) {
+  const size_t count = n - 1;
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    vst1q_f64(out + i, vdivq_f64(vld1q_f64(data + i + 1), vld1q_f64(data + i)));
+  }
+  for (; i < count; ++i) {
+    out[i] = data[i + 1] / data[i];
+  }
+}
+
+void neonMultiply(const double* x, const double* y, size_t n, double* out) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    vst1q_f64(out + i, vmulq_f64(vld1q_f64(x + i), vld1q_f64(y + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] = x[i] * y[i];
+  }
+}
+
+void neonScale(const double* data, size_t n, double factor, double* out) {
+  const float64x2_t f = vdupq_n_f64(factor);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    vst1q_f64(out + i, vmulq_f64(vld1q_f64(data + i), f));
+  }
+  for (; i < n; ++i) {
+    out[i] = data[i] * factor;
+  }
+}
+
+double neonDot(const double* x, const double* y, size_t n) {
+  float64x2_t acc0 = vdupq_n_f64(0.0);
+  float64x2_t acc1 = vdupq_n_f64(0.0);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc0 = vfmaq_f64(acc0, vld1q_f64(x + i), vld1q_f64(y + i));
+    acc1 = vfmaq_f64(acc1, vld1q_f64(x + i + 2), vld1q_f64(y + i + 2));
+  }
+  for (; i + 2 <= n; i += 2) {
+    acc0 = vfmaq_f64(acc0, vld1q_f64(x + i), vld1q_f64(y + i));
+  }
+
+  double total = vaddvq_f64(vaddq_f64(acc0, acc1));
+  for (; i < n; ++i) {
+    total += x[i] * y[i];
+  }
+  return total;
+}
+
+// Four ys at a time: each load of x feeds four independent FMA chains
+void neonDots(const double* x, const double* const* ys, size_t count,
+              size_t n, double* out) {
+  size_t c = 0;
+  for (; c + 4 <= count; c += 4) {
+    const double* y0 = ys[c];
+    const double* y1 = ys[c + 1];
+    const double* y2 = ys[c + 2];
+    const double* y3 = ys[c + 3];
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    float64x2_t acc2 = vdupq_n_f64(0.0);
+    float64x2_t acc3 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+      const float64x2_t v = vld1q_f64(x + i);
+      acc0 = vfmaq_f64(acc0, v, vld1q_f64(y0 + i));
+      acc1 = vfmaq_f64(acc1, v, vld1q_f64(y1 + i));
+      acc2 = vfmaq_f64(acc2, v, vld1q_f64(y2 + i));
+      acc3 = vfmaq_f64(acc3, v, vld1q_f64(y3 + i));
+    }
+    double t0 = vaddvq_f64(acc0);
+    double t1 = vaddvq_f64(acc1);
+    double t2 = vaddvq_f64(acc2);
+    double t3 = vaddvq_f64(acc3);
+    for (; i < n; ++i) {
+      t0 += x[i] * y0[i];
+      t1 += x[i] * y1[i];
+      t2 += x[i] * y2[i];
+      t3 += x[i] * y3[i];
+    }
+    out[c] = t0;
+    out[c + 1] = t1;
+    out[c + 2] = t2;
+    out[c + 3] = t3;
+  }
+  for (; c < count; ++c) {
+    out[c] = neonDot(x, ys[c], n);
+  }
+}
+
+void neonAddScaled(const double* data, size_t n, double factor,
+                   double* out) {
+  const float64x2_t f = vdupq_n_f64(factor);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    vst1q_f64(out + i, vfmaq_f64(vld1q_f64(out + i), vld1q_f64(data + i), f));
+  }
+  for (; i < n; ++i) {
+    out[i] += data[i] * factor;
+  }
+}
+
+}  // namespace
+
+const Table kNeon = {
+    SimdLevel::Neon,
+    neonSum,
+    neonSumSquaredDeviations,
+    neonSumCrossDeviations,
+    neonMinMax,
+    neonRatios,
+    neonMultiply,
+    neonScale,
+    neonDots,
+    neonAddScaled,
+};
+
+}  // namespace Analytics::Kernels
+
+#endif  // __aarch64__
@@ -0,0 +1,50 @@
+#ifndef ANALYTICS_STATS_KERNELS_H_
+#define ANALYTICS_STATS_KERNELS_H_
+
+#include <cstddef>
+
+#include "series_stats.h"
+
+// Private to the library: one table of kernels per instruction set.
+// Every kernel gets n >= 1.
+namespace Analytics::Kernels {
+
+struct Table {
+  SimdLevel level;
+  double (*sum)(const double* data, size_t n);
+  // sum((data[i] - mean)^2)
+  double (*sumSquaredDeviations)(const double* data, size_t n, double mean);
+  // sum((x[i] - mean_x) * (y[i] - mean_y))
+  double (*sumCrossDeviations)(const double* x, const double* y, size_t n,
+                               double mean_x, double mean_y);
+  void (*minMax)(const double* data, size_t n, double* min, double* max);
+  // out[i] = data[i + 1] / data[i] for i < n - 1
+  void (*ratios)(const double* data, size_t n, double* out);
+  // out[i] = x[i] * y[i]
+  void (*multiply)(const double* x, const double* y, size_t n, double* out);
+  // out[i] = data[i] * factor
+  void (*scale)(const double* data, size_t n, double factor, double* out);
+  // out[c] = sum(x[i] * ys[c][i]) for c < count; one pass over x feeds
+  // every y, the inner loop of the blocked covariance matrix
+  void (*dots)(const double* x, const double* const* ys, size_t count,
+               size_t n, double* out);
+  // out[i] += data[i] * factor
+  void (*addScaled)(const double* data, size_t n, double factor,
+                    double* out);
+};
+
+// The table the public functions run on, chosen at startup or by
+// setSimdLevel()
+const Table& active();
+
+extern const Table kScalar;
+#if defined(__x86_64__) || defined(__i386__)
+extern const Table kAvx2;
+#endif
+#if defined(__aarch64__)
+extern const Table kNeon;
+#endif
+
+}  // namespace Analytics::Kernels
+
+#endif  // ANALYTICS_STATS_KERNELS_H_
@@ -0,0 +1,250 @@
+#include "series_align.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "entities.h"
+
+namespace Analytics {
+namespace {
+
+// Owns the arrays a SeriesSpan points at
+struct Series {
+  std::vector<int64_t> timestamps;
+  std::vector<double> values;
+
+  SeriesSpan span() const { return {timestamps, values}; }
+};
+
+// Counts pulls, to check every input is read once
+class CountingCursor {
+ public:
+  CountingCursor(const Series& series, size_t& pulls)
+      : m_cursor(series.span()), m_pulls(pulls) {}
+
+  bool next(int64_t& timestamp_ms, double& value) {
+    ++m_pulls;
+    return m_cursor.next(timestamp_ms, value);
+  }
+
+ private:
+  SpanCursor m_cursor;
+  size_t& m_pulls;
+};
+
+// ============================================================
+// Union Grid
+// ============================================================
+TEST(SeriesAlignTest, AsOfCarriesLastObservation) {
+  const Series a{{10, 30, 50}, {1.0, 3.0, 5.0}};
+  const Series b{{20, 30}, {20.0, 30.0}};
+
+  auto frame = align({a.span(), b.span()});
+  EXPECT_EQ(frame.timestamps, (std::vector<int64_t>{10, 20, 30, 50}));
+  ASSERT_EQ(frame.columns.size(), 2u);
+  EXPECT_EQ(frame.columns[0], (std::vector<double>{1.0, 1.0, 3.0, 5.0}));
+  EXPECT_TRUE(std::isnan(frame.columns[1][0]));
+  EXPECT_DOUBLE_EQ(frame.columns[1][1], 20.0);
+  EXPECT_DOUBLE_EQ(frame.columns[1][2], 30.0);
+  EXPECT_DOUBLE_EQ(frame.columns[1][3], 30.0);
+}
+
+TEST(SeriesAlignTest, LinearInterpolatesBetweenObservations) {
+  const Series a{{0, 100}, {0.0, 10.0}};
+  const Series b{{25, 50, 150}, {1.0, 2.0, 3.0}};
+
+  AlignOptions options;
+  options.fill = FillMethod::Linear;
+  auto frame = align({a.span(), b.span()}, options);
+  EXPECT_EQ(frame.timestamps, (std::vector<int64_t>{0, 25, 50, 100, 150}));
+  EXPECT_DOUBLE_EQ(frame.columns[0][1], 2.5);
+  EXPECT_DOUBLE_EQ(frame.columns[0][2], 5.0);
+  EXPECT_DOUBLE_EQ(frame.columns[0][3], 10.0);
+  // Nothing to interpolate towards after the last observation
+  EXPECT_TRUE(std::isnan(frame.columns[0][4]));
+  EXPECT_TRUE(std::isnan(frame.columns[1][0]));
+  EXPECT_DOUBLE_EQ(frame.columns[1][3], 2.5);
+}
+
+TEST(SeriesAlignTest, RangeKeepsEarlierObservations) {
+  const Series a{{0, 10, 20, 30}, {0.0, 1.0, 2.0, 3.0}};
+  const Series b{{5, 25}, {50.0, 250.0}};
+
+  AlignOptions options;
+  options.from_ms = 10;
+  options.to_ms = 25;
+  auto frame = align({a.span(), b.span()}, options);
+  EXPECT_EQ(frame.timestamps, (std::vector<int64_t>{10, 20, 25}));
+  EXPECT_EQ(frame.columns[0], (std::vector<double>{1.0, 2.0, 2.0}));
+  // The 5 ms observation is outside the range but still carried
+  EXPECT_EQ(frame.columns[1], (std::vector<double>{50.0, 50.0, 250.0}));
+}
+
+TEST(SeriesAlignTest, RepeatedTimestampsKeepLastValue) {
+  const Series a{{10, 10, 20}, {1.0, 2.0, 3.0}};
+
+  auto frame = align({a.span()});
+  EXPECT_EQ(frame.timestamps, (std::vector<int64_t>{10, 20}));
+  EXPECT_EQ(frame.columns[0], (std::vector<double>{2.0, 3.0}));
+}
+
+TEST(SeriesAlignTest, StalenessLimitsCarry) {
+  const Series a{{0, 100}, {1.0, 2.0}};
+  const Series b{{40, 60, 70}, {0.0, 0.0, 0.0}};
+
+  AlignOptions options;
+  options.max_staleness_ms = 50;
+  auto frame = align({a.span(), b.span()}, options);
+  EXPECT_EQ(frame.timestamps, (std::vector<int64_t>{0, 40, 60, 70, 100}));
+  EXPECT_DOUBLE_EQ(frame.columns[0][1], 1.0);
+  EXPECT_TRUE(std::isnan(frame.columns[0][2]));
+  EXPECT_TRUE(std::isnan(frame.columns[0][3]));
+  EXPECT_DOUBLE_EQ(frame.columns[0][4], 2.0);
+}
+
+TEST(SeriesAlignTest, EmptyInputs) {
+  EXPECT_EQ(align(std::vector<SeriesSpan>{}).rows(), 0u);
+
+  const Series a{{10}, {1.0}};
+  auto frame = align({a.span(), Series{}.span()});
+  ASSERT_EQ(frame.rows(), 1u);
+  EXPECT_TRUE(std::isnan(frame.columns[1][0]));
+}
+
+// ============================================================
+// Fixed Grid
+// ============================================================
+TEST(SeriesAlignTest, FixedGridAsOf) {
+  const Series a{{5, 12, 31}, {1.0, 2.0, 3.0}};
+
+  AlignOptions options;
+  options.step_ms = 10;
+  options.from_ms = 0;
+  options.to_ms = 35;
+  auto frame = align({a.span()}, options);
+  EXPECT_EQ(frame.timestamps, (std::vector<int64_t>{0, 10, 20, 30}));
+  EXPECT_TRUE(std::isnan(frame.columns[0][0]));
+  EXPECT_DOUBLE_EQ(frame.columns[0][1], 1.0);
+  EXPECT_DOUBLE_EQ(frame.columns[0][2], 2.0);
+  EXPECT_DOUBLE_EQ(frame.columns[0][3], 2.0);
+}
+
+TEST(SeriesAlignTest, FixedGridLinear) {
+  const Series a{{0, 40}, {0.0, 4.0}};
+
+  AlignOptions options;
+  options.fill = FillMethod::Linear;
+  options.step_ms = 10;
+  options.from_ms = 0;
+  options.to_ms = 40;
+  auto frame = align({a.span()}, options);
+  EXPECT_EQ(frame.columns[0], (std::vector<double>{0.0, 1.0, 2.0, 3.0, 4.0}));
+}
+
+// ============================================================
+// Cursors and Validation
+// ============================================================
+TEST(SeriesAlignTest, ReadsEachCursorOnce) {
+  std::vector<Series> inputs(3);
+  for (int64_t i = 0; i < 1000; ++i) {
+    inputs[i % 3].timestamps.push_back(i);
+    inputs[i % 3].values.push_back(static_cast<double>(i));
+  }
+  size_t pulls = 0;
+  std::vector<CountingCursor> cursors;
+  for (const auto& series : inputs) {
+    cursors.emplace_back(series, pulls);
+  }
+
+  auto frame = align(cursors);
+  EXPECT_EQ(frame.rows(), 1000u);
+  // Every sample plus one end-of-series pull per input
+  EXPECT_EQ(pulls, 1003u);
+  EXPECT_DOUBLE_EQ(frame.columns[2][999], 998.0);
+}
+
+TEST(SeriesAlignTest, StreamYieldsTheFrameRowByRow) {
+  const Series a{{0, 10, 20, 30}, {0.0, 1.0, 2.0, 3.0}};
+  const Series b{{5, 25}, {50.0, 250.0}};
+  AlignOptions options;
+  options.from_ms = 10;
+  options.to_ms = 25;
+  const auto frame = align({a.span(), b.span()}, options);
+
+  std::vector<SpanCursor> cursors = {SpanCursor(a.span()),
+                                     SpanCursor(b.span())};
+  AlignedStream<SpanCursor> stream(cursors, options);
+  ASSERT_EQ(stream.series(), 2u);
+  int64_t timestamp_ms = 0;
+  double row[2];
+  for (size_t r = 0; r < frame.rows(); ++r) {
+    ASSERT_TRUE(stream.next(timestamp_ms, row));
+    EXPECT_EQ(timestamp_ms, frame.timestamps[r]);
+    EXPECT_DOUBLE_EQ(row[0], frame.columns[0][r]);
+    EXPECT_DOUBLE_EQ(row[1], frame.columns[1][r]);
+  }
+  EXPECT_FALSE(stream.next(timestamp_ms, row));
+  EXPECT_FALSE(stream.next(timestamp_ms, row));
+}
+
+TEST(SeriesAlignTest, PointCursorsReadFetchedSeriesInPlace) {
+  // As LsTcRepository::fetchMany() returns them: irregular, per asset
+  const std::vector<Entities::TimeSeriesPoint> a = {
+      {"A", 10, "", 1.0}, {"A", 35, "", 3.5}, {"A", 50, "", 5.0}};
+  const std::vector<Entities::TimeSeriesPoint> b = {{"B", 20, "", 20.0},
+                                                    {"B", 35, "", 35.0}};
+
+  std::vector<PointCursor<Entities::TimeSeriesPoint>> cursors = {
+      PointCursor<Entities::TimeSeriesPoint>(a),
+      PointCursor<Entities::TimeSeriesPoint>(b)};
+  auto frame = align(cursors);
+  EXPECT_EQ(frame.timestamps, (std::vector<int64_t>{10, 20, 35, 50}));
+  EXPECT_EQ(frame.columns[0], (std::vector<double>{1.0, 1.0, 3.5, 5.0}));
+  EXPECT_TRUE(std::isnan(frame.columns[1][0]));
+  EXPECT_DOUBLE_EQ(frame.columns[1][3], 35.0);
+
+  // parseCompactResponse()'s form gives the same frame
+  Entities::CompactSeries compact_a{"A", {}};
+  for (const auto& point : a) {
+    compact_a.points.push_back({point.timestamp_ms, point.value, {}});
+  }
+  Entities::CompactSeries compact_b{"B", {}};
+  for (const auto& point : b) {
+    compact_b.points.push_back({point.timestamp_ms, point.value, {}});
+  }
+  std::vector<PointCursor<Entities::CompactPoint>> compact = {
+      PointCursor<Entities::CompactPoint>(compact_a.points),
+      PointCursor<Entities::CompactPoint>(compact_b.points)};
+  auto compact_frame = align(compact);
+  EXPECT_EQ(compact_frame.timestamps, frame.timestamps);
+  EXPECT_EQ(compact_frame.columns[0], frame.columns[0]);
+  EXPECT_DOUBLE_EQ(compact_frame.columns[1][2], 35.0);
+}
+
+TEST(SeriesAlignTest, RejectsBadInput) {
+  const Series unsorted{{10, 5}, {1.0, 2.0}};
+  EXPECT_THROW(align({unsorted.span()}), std::invalid_argument);
+
+  EXPECT_THROW(SeriesSpan(std::vector<int64_t>{1}, std::vector<double>{}),
+               std::invalid_argument);
+  AlignOptions no_range;
+  no_range.step_ms = 10;
+  EXPECT_THROW(align(std::vector<SeriesSpan>{}, no_range),
+               std::invalid_argument);
+  AlignOptions inverted;
+  inverted.from_ms = 10;
+  inverted.to_ms = 0;
+  EXPECT_THROW(align(std::vector<SeriesSpan>{}, inverted),
+               std::invalid_argument);
+  AlignOptions negative_step;
+  negative_step.step_ms = -1;
+  EXPECT_THROW(align(std::vector<SeriesSpan>{}, negative_step),
+               std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace Analytics
@@ -0,0 +1,303 @@
+#include "series_backtest.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "alloc_counter.h"
+
+namespace Analytics {
+namespace {
+
+// Owns the arrays a SeriesSpan points at
+struct Series {
+  std::vector<int64_t> timestamps;
+  std::vector<double> values;
+
+  SeriesSpan span() const { return {timestamps, values}; }
+};
+
+Series sawtooth(size_t count, int64_t start_ms, int64_t step_ms,
+                double base) {
+  Series series;
+  for (size_t i = 0; i < count; ++i) {
+    series.timestamps.push_back(start_ms + static_cast<int64_t>(i) * step_ms);
+    series.values.push_back(base + static_cast<double>(i % 37) -
+                            0.5 * static_cast<double>(i % 11));
+  }
+  return series;
+}
+
+// Counts pulls, to check the data is read once
+class CountingCursor {
+ public:
+  CountingCursor(const Series& series, size_t& pulls)
+      : m_cursor(series.span()), m_pulls(pulls) {}
+
+  bool next(int64_t& timestamp_ms, double& value) {
+    ++m_pulls;
+    return m_cursor.next(timestamp_ms, value);
+  }
+
+ private:
+  SpanCursor m_cursor;
+  size_t& m_pulls;
+};
+
+// Keeps every tick it sees
+class RecordingStrategy : public BacktestStrategy {
+ public:
+  void onStart(size_t series) override {
+    ++starts;
+    this->series = series;
+  }
+  void onTick(const BacktestTick& tick) override {
+    timestamps.push_back(tick.timestamp_ms);
+    indices.push_back(tick.index);
+    rows.emplace_back(tick.prices.begin(), tick.prices.end());
+  }
+  void onFinish() override { ++finishes; }
+
+  int starts = 0;
+  int finishes = 0;
+  size_t series = 0;
+  std::vector<int64_t> timestamps;
+  std::vector<uint64_t> indices;
+  std::vector<std::vector<double>> rows;
+};
+
+// Moving-average crossover on series 0, one parameter set per instance:
+// long while the fast average is above the slow one. Its windows are
+// allocated up front, so ticks allocate nothing.
+class CrossoverStrategy : public BacktestStrategy {
+ public:
+  CrossoverStrategy(size_t fast, size_t slow)
+      : m_fast(fast), m_slow(slow), m_window(slow, 0.0) {}
+
+  void onTick(const BacktestTick& tick) override {
+    const double price = tick.prices.data()[0];
+    if (std::isnan(price)) {
+      return;
+    }
+    if (m_seen > 0 && m_long) {
+      pnl += price - m_last;
+    }
+    m_window[m_seen % m_slow] = price;
+    ++m_seen;
+    m_last = price;
+    if (m_seen < m_slow) {
+      return;
+    }
+    double fast = 0.0;
+    double slow = 0.0;
+    for (size_t k = 0; k < m_slow; ++k) {
+      const double value = m_window[(m_seen - 1 - k) % m_slow];
+      slow += value;
+      if (k < m_fast) {
+        fast += value;
+      }
+    }
+    const bool was_long = m_long;
+    m_long = fast / static_cast<double>(m_fast) >
+             slow / static_cast<double>(m_slow);
+    trades += m_long != was_long ? 1 : 0;
+  }
+
+  double pnl = 0.0;
+  int trades = 0;
+
+ private:
+  size_t m_fast;
+  size_t m_slow;
+  std::vector<double> m_window;
+  size_t m_seen = 0;
+  double m_last = 0.0;
+  bool m_long = false;
+};
+
+class ThrowingStrategy : public BacktestStrategy {
+ public:
+  void onTick(const BacktestTick& tick) override {
+    if (tick.index == 5) {
+      throw std::runtime_error("strategy failed");
+    }
+  }
+  void onFinish() override { finished = true; }
+
+  bool finished = false;
+};
+
+// ============================================================
+// Replay
+// ============================================================
+TEST(SeriesBacktestTest, EveryStrategySeesTheAlignedRowsInOrder) {
+  const auto a = sawtooth(100, 0, 10, 100.0);
+  const auto b = sawtooth(40, 5, 25, 50.0);
+  const auto frame = align({a.span(), b.span()});
+
+  RecordingStrategy first;
+  RecordingStrategy second;
+  BacktestOptions options;
+  options.block_rows = 7;  // many blocks, the last one short
+  auto report =
+      runBacktest({a.span(), b.span()}, {&first, &second}, options);
+
+  EXPECT_EQ(report.ticks, frame.rows());
+  EXPECT_EQ(report.strategies, 2u);
+  for (const auto* strategy : {&first, &second}) {
+    EXPECT_EQ(strategy->starts, 1);
+    EXPECT_EQ(strategy->finishes, 1);
+    EXPECT_EQ(strategy->series, 2u);
+    EXPECT_EQ(strategy->timestamps, frame.timestamps);
+    ASSERT_EQ(strategy->rows.size(), frame.rows());
+    for (size_t row = 0; row < frame.rows(); ++row) {
+      EXPECT_EQ(strategy->indices[row], row);
+      for (size_t i = 0; i < 2; ++i) {
+        const double expected = frame.columns[i][row];
+        const double actual = strategy->rows[row][i];
+        EXPECT_TRUE(expected == actual ||
+                    (std::isnan(expected) && std::isnan(actual)))
+            << "row " << row << " series " << i;
+      }
+    }
+  }
+}
+
+TEST(SeriesBacktestTest, FixedGridFromAlignOptions) {
+  const auto a = sawtooth(50, 0, 10, 100.0);
+  RecordingStrategy strategy;
+  BacktestOptions options;
+  options.align.step_ms = 100;
+  options.align.from_ms = 0;
+  options.align.to_ms = 490;
+
+  auto report = runBacktest({a.span()}, {&strategy}, options);
+
+  EXPECT_EQ(report.ticks, 5u);
+  EXPECT_EQ(strategy.timestamps,
+            (std::vector<int64_t>{0, 100, 200, 300, 400}));
+}
+
+TEST(SeriesBacktestTest, ParameterSetsShareOnePassOverTheData) {
+  const auto a = sawtooth(5000, 0, 1000, 100.0);
+  const auto b = sawtooth(3000, 500, 1500, 20.0);
+  size_t pulls = 0;
+  std::vector<CountingCursor> cursors = {{a, pulls}, {b, pulls}};
+
+  std::vector<std::pair<size_t, size_t>> parameters;
+  for (size_t fast = 2; fast <= 6; ++fast) {
+    for (size_t slow : {10, 20, 40}) {
+      parameters.emplace_back(fast, slow);
+    }
+  }
+  std::vector<CrossoverStrategy> strategies;
+  for (const auto& [fast, slow] : parameters) {
+    strategies.emplace_back(fast, slow);
+  }
+  std::vector<BacktestStrategy*> pointers;
+  for (auto& strategy : strategies) {
+    pointers.push_back(&strategy);
+  }
+  BacktestOptions options;
+  options.block_rows = 256;
+  auto report = runBacktest(cursors, pointers, options);
+
+  // Every point once, plus the end of each series
+  EXPECT_EQ(pulls, a.values.size() + b.values.size() + 2);
+  EXPECT_GT(report.ticks, 5000u);
+  EXPECT_GT(report.ticks_per_second, 0.0);
+  EXPECT_DOUBLE_EQ(report.strategy_ticks_per_second,
+                   report.ticks_per_second * 15);
+
+  // Each parameter set ends as it would alone
+  for (size_t k = 0; k < strategies.size(); ++k) {
+    CrossoverStrategy alone(parameters[k].first, parameters[k].second);
+    BacktestOptions serial;
+    serial.max_parallelism = 1;
+    runBacktest({a.span(), b.span()}, {&alone}, serial);
+    EXPECT_DOUBLE_EQ(strategies[k].pnl, alone.pnl) << k;
+    EXPECT_EQ(strategies[k].trades, alone.trades) << k;
+  }
+}
+
+TEST(SeriesBacktestTest, RunsOnTheGivenExecutor) {
+  const auto a = sawtooth(1000, 0, 10, 100.0);
+  Concurrency::Executor executor(Concurrency::ExecutorOptions{2, 16});
+  CrossoverStrategy fast(2, 10);
+  CrossoverStrategy slow(5, 40);
+  BacktestOptions options;
+  options.executor = &executor;
+  options.block_rows = 64;
+
+  auto report = runBacktest({a.span()}, {&fast, &slow}, options);
+
+  EXPECT_EQ(report.ticks, 1000u);
+  EXPECT_GT(fast.trades, 0);
+}
+
+TEST(SeriesBacktestTest, NoStrategiesStillCountsTicks) {
+  const auto a = sawtooth(10, 0, 10, 100.0);
+
+  EXPECT_EQ(runBacktest({a.span()}, {}).ticks, 10u);
+  EXPECT_EQ(runBacktest(std::vector<SeriesSpan>{}, {}).ticks, 0u);
+}
+
+// ============================================================
+// Allocations
+// ============================================================
+TEST(SeriesBacktestTest, TicksAllocateNothing) {
+  const auto a = sawtooth(20000, 0, 1000, 100.0);
+  const auto b = sawtooth(20000, 500, 1000, 20.0);
+  std::vector<CrossoverStrategy> strategies(8, CrossoverStrategy(3, 30));
+  std::vector<BacktestStrategy*> pointers;
+  for (auto& strategy : strategies) {
+    pointers.push_back(&strategy);
+  }
+  const std::vector<SeriesSpan> series = {a.span(), b.span()};
+  Concurrency::Executor executor(Concurrency::ExecutorOptions{4, 64});
+  BacktestOptions options;
+  options.executor = &executor;
+  options.block_rows = 1024;
+
+  AllocCounter::AllocationScope scope(AllocCounter::Threads::All);
+  auto report = runBacktest(series, pointers, options);
+
+  // 40000 rows in 40 blocks: the buffers, the stream's state and the
+  // executor's bookkeeping of each block, nothing per tick
+  ASSERT_EQ(report.ticks, 40000u);
+  EXPECT_TRUE(AllocCounter::withinBudget(scope.stats(), report.ticks, 0,
+                                         40 * 8 + 64));
+}
+
+// ============================================================
+// Failure Cases
+// ============================================================
+TEST(SeriesBacktestTest, StrategyExceptionStopsTheRun) {
+  const auto a = sawtooth(100, 0, 10, 100.0);
+  ThrowingStrategy strategy;
+  BacktestOptions options;
+  options.block_rows = 4;
+
+  EXPECT_THROW(runBacktest({a.span()}, {&strategy}, options),
+               std::runtime_error);
+  EXPECT_FALSE(strategy.finished);
+}
+
+TEST(SeriesBacktestTest, RejectsBadOptions) {
+  const auto a = sawtooth(10, 0, 10, 100.0);
+  BacktestOptions empty_blocks;
+  empty_blocks.block_rows = 0;
+  EXPECT_THROW(runBacktest({a.span()}, {}, empty_blocks),
+               std::invalid_argument);
+
+  BacktestOptions bad_grid;
+  bad_grid.align.step_ms = 10;  // without from_ms and to_ms
+  EXPECT_THROW(runBacktest({a.span()}, {}, bad_grid), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace Analytics
@@ -0,0 +1,253 @@
+#include "series_covariance.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace Analytics {
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// series random walks of rows prices each, correlated through a common
+// factor so the off-diagonal terms are not all near zero
+AlignedFrame randomFrame(size_t series, size_t rows, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> step(0.0, 0.01);
+  AlignedFrame frame;
+  frame.columns.assign(series, std::vector<double>(rows));
+  std::vector<double> prices(series, 100.0);
+  for (size_t r = 0; r < rows; ++r) {
+    frame.timestamps.push_back(static_cast<int64_t>(r) * 1000);
+    const double market = step(rng);
+    for (size_t i = 0; i < series; ++i) {
+      prices[i] *= std::exp(market * static_cast<double>(i % 5) + step(rng));
+      frame.columns[i][r] = prices[i];
+    }
+  }
+  return frame;
+}
+
+// The pairwise reference: covariance() of every pair of logReturns()
+std::vector<double> pairwiseReference(const AlignedFrame& frame) {
+  const size_t n = frame.columns.size();
+  std::vector<std::vector<double>> returns;
+  for (const auto& column : frame.columns) {
+    returns.push_back(logReturns(column));
+  }
+  std::vector<double> values(n * n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      values[i * n + j] = covariance(returns[i], returns[j]);
+    }
+  }
+  return values;
+}
+
+AlignedFrame firstRows(const AlignedFrame& frame, size_t rows) {
+  AlignedFrame head;
+  head.timestamps.assign(frame.timestamps.begin(),
+                         frame.timestamps.begin() + rows);
+  for (const auto& column : frame.columns) {
+    head.columns.emplace_back(column.begin(), column.begin() + rows);
+  }
+  return head;
+}
+
+std::vector<double> rowOf(const AlignedFrame& frame, size_t row) {
+  std::vector<double> prices;
+  for (const auto& column : frame.columns) {
+    prices.push_back(column[row]);
+  }
+  return prices;
+}
+
+void expectMatrixNear(const std::vector<double>& actual,
+                      const std::vector<double>& expected, double tolerance) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t cell = 0; cell < actual.size(); ++cell) {
+    EXPECT_NEAR(actual[cell], expected[cell], tolerance) << "cell " << cell;
+  }
+}
+
+class SeriesCovarianceTest : public ::testing::Test {
+ protected:
+  void TearDown() override { setSimdLevel(detectedSimdLevel()); }
+};
+
+// ============================================================
+// Covariance Matrix
+// ============================================================
+TEST_F(SeriesCovarianceTest, MatchesPairwiseCovarianceAtEveryLevel) {
+  // Sizes off the tile and vector widths, across several tiles of each
+  const auto frame = randomFrame(70, 601, 7);
+  const auto expected = pairwiseReference(frame);
+
+  for (auto level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Neon}) {
+    if (!setSimdLevel(level)) {
+      continue;
+    }
+    const auto matrix = covarianceMatrix(frame);
+    EXPECT_EQ(matrix.assets, 70u);
+    EXPECT_EQ(matrix.observations, 600u);
+    expectMatrixNear(matrix.values, expected, 1e-12);
+    EXPECT_NEAR(matrix.means[3], mean(logReturns(frame.columns[3])), 1e-15);
+  }
+}
+
+TEST_F(SeriesCovarianceTest, IsSymmetric) {
+  const auto matrix = covarianceMatrix(randomFrame(40, 50, 3));
+
+  for (size_t i = 0; i < matrix.assets; ++i) {
+    for (size_t j = 0; j < matrix.assets; ++j) {
+      EXPECT_EQ(matrix.at(i, j), matrix.at(j, i));
+    }
+  }
+}
+
+TEST_F(SeriesCovarianceTest, SameResultOnAnyExecutorAndParallelism) {
+  const auto frame = randomFrame(100, 300, 11);
+  const auto shared = covarianceMatrix(frame);
+
+  Concurrency::Executor executor(Concurrency::ExecutorOptions{3, 64});
+  const auto pooled = covarianceMatrix(
+      frame, {ReturnMethod::Log, &executor, 0});
+  const auto serial = covarianceMatrix(
+      frame, {ReturnMethod::Log, &executor, 1});
+
+  // Each tile is summed in the same order whichever thread runs it
+  EXPECT_EQ(pooled.values, shared.values);
+  EXPECT_EQ(serial.values, shared.values);
+}
+
+TEST_F(SeriesCovarianceTest, SimpleReturns) {
+  AlignedFrame frame;
+  frame.timestamps = {0, 1, 2, 3};
+  frame.columns = {{100.0, 110.0, 99.0, 99.0}, {10.0, 10.5, 10.5, 11.55}};
+
+  const auto matrix = covarianceMatrix(frame, {ReturnMethod::Simple});
+
+  const std::vector<double> x = {0.1, -0.1, 0.0};
+  const std::vector<double> y = {0.05, 0.0, 0.1};
+  EXPECT_NEAR(matrix.at(0, 0), variance(x), 1e-12);
+  EXPECT_NEAR(matrix.at(0, 1), covariance(x, y), 1e-12);
+  EXPECT_NEAR(matrix.at(1, 1), variance(y), 1e-12);
+}
+
+TEST_F(SeriesCovarianceTest, SkipsRowsWhereAnySeriesIsMissing) {
+  AlignedFrame frame;
+  frame.timestamps = {0, 1, 2, 3, 4};
+  frame.columns = {{1.0, 2.0, 4.0, 8.0, 4.0}, {kNaN, 3.0, kNaN, 6.0, 9.0}};
+
+  const auto matrix = covarianceMatrix(frame);
+
+  // Rows 1, 3 and 4: returns over 2 -> 8 -> 4 and 3 -> 6 -> 9
+  AlignedFrame complete;
+  complete.timestamps = {1, 3, 4};
+  complete.columns = {{2.0, 8.0, 4.0}, {3.0, 6.0, 9.0}};
+  EXPECT_EQ(matrix.observations, 2u);
+  expectMatrixNear(matrix.values, pairwiseReference(complete), 1e-15);
+}
+
+TEST_F(SeriesCovarianceTest, FewerThanTwoReturnsGiveZeros) {
+  auto matrix = covarianceMatrix(firstRows(randomFrame(3, 10, 1), 1));
+  EXPECT_EQ(matrix.observations, 0u);
+  EXPECT_EQ(matrix.values, std::vector<double>(9, 0.0));
+
+  matrix = covarianceMatrix(firstRows(randomFrame(3, 10, 1), 2));
+  EXPECT_EQ(matrix.observations, 1u);
+  EXPECT_EQ(matrix.values, std::vector<double>(9, 0.0));
+  EXPECT_NE(matrix.means[0], 0.0);
+
+  EXPECT_EQ(covarianceMatrix(AlignedFrame{}).assets, 0u);
+}
+
+TEST_F(SeriesCovarianceTest, FromReturns) {
+  const std::vector<double> x = {0.01, -0.02, 0.03, 0.0};
+  const std::vector<double> y = {0.02, -0.01, 0.01, 0.01};
+
+  const auto matrix = covarianceMatrix(std::vector<ValueSpan>{x, y});
+
+  EXPECT_EQ(matrix.observations, 4u);
+  EXPECT_NEAR(matrix.at(0, 1), covariance(x, y), 1e-15);
+  EXPECT_NEAR(matrix.at(1, 1), variance(y), 1e-15);
+}
+
+TEST_F(SeriesCovarianceTest, FromReturnsRejectsDifferentLengths) {
+  const std::vector<double> x = {0.01, 0.02, 0.03};
+  const std::vector<double> y = {0.01, 0.02};
+
+  EXPECT_THROW(covarianceMatrix(std::vector<ValueSpan>{x, y}),
+               std::invalid_argument);
+}
+
+TEST_F(SeriesCovarianceTest, Correlation) {
+  const std::vector<double> x = {0.01, -0.02, 0.03, 0.0};
+  const std::vector<double> doubled = {0.02, -0.04, 0.06, 0.0};
+  const std::vector<double> flat = {0.01, 0.01, 0.01, 0.01};
+
+  const auto correlation =
+      covarianceMatrix(std::vector<ValueSpan>{x, doubled, flat})
+          .correlation();
+
+  EXPECT_DOUBLE_EQ(correlation[0], 1.0);
+  EXPECT_NEAR(correlation[1], 1.0, 1e-12);
+  EXPECT_NEAR(correlation[3], 1.0, 1e-12);
+  // No variance, no correlation
+  EXPECT_TRUE(std::isnan(correlation[2]));
+  EXPECT_TRUE(std::isnan(correlation[8]));
+}
+
+// ============================================================
+// Incremental Updates
+// ============================================================
+TEST_F(SeriesCovarianceTest, IncrementalMatchesFullRecompute) {
+  const auto frame = randomFrame(37, 400, 5);
+  IncrementalCovariance incremental(firstRows(frame, 250));
+
+  for (size_t row = 250; row < frame.rows(); ++row) {
+    EXPECT_TRUE(incremental.update(rowOf(frame, row)));
+  }
+
+  const auto expected = covarianceMatrix(frame);
+  const auto actual = incremental.covariance();
+  EXPECT_EQ(actual.observations, 399u);
+  expectMatrixNear(actual.values, expected.values, 1e-12);
+  expectMatrixNear(actual.means, expected.means, 1e-15);
+}
+
+TEST_F(SeriesCovarianceTest, IncrementalFromNothing) {
+  const auto frame = randomFrame(5, 50, 9);
+  IncrementalCovariance incremental(5);
+  EXPECT_EQ(incremental.observations(), 0u);
+
+  for (size_t row = 0; row < frame.rows(); ++row) {
+    EXPECT_TRUE(incremental.update(rowOf(frame, row)));
+  }
+
+  EXPECT_EQ(incremental.observations(), 49u);
+  expectMatrixNear(incremental.covariance().values,
+                   covarianceMatrix(frame).values, 1e-12);
+}
+
+TEST_F(SeriesCovarianceTest, IncrementalSkipsIncompleteRows) {
+  IncrementalCovariance incremental(2, ReturnMethod::Simple);
+  EXPECT_TRUE(incremental.update(std::vector<double>{100.0, 10.0}));
+  EXPECT_FALSE(incremental.update(std::vector<double>{kNaN, 11.0}));
+  EXPECT_TRUE(incremental.update(std::vector<double>{110.0, 11.0}));
+  EXPECT_TRUE(incremental.update(std::vector<double>{99.0, 9.9}));
+
+  // Returns over the complete rows only: 0.1 then -0.1 for both
+  const auto matrix = incremental.covariance();
+  EXPECT_EQ(matrix.observations, 2u);
+  EXPECT_NEAR(matrix.at(0, 1), 0.02, 1e-12);
+  EXPECT_THROW(incremental.update(std::vector<double>{1.0}),
+               std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace Analytics
@@ -0,0 +1,201 @@
+#include "series_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace Analytics {
+namespace {
+
+std::vector<double> randomWalk(size_t count, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> step(0.0, 1.0);
+  std::vector<double> values;
+  values.reserve(count);
+  double price = 100.0;
+  for (size_t i = 0; i < count; ++i) {
+    price += step(rng);
+    values.push_back(price);
+  }
+  return values;
+}
+
+// Levels to run next to the scalar reference on this machine
+std::vector<SimdLevel> supportedLevels() {
+  std::vector<SimdLevel> levels;
+  for (auto level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Neon}) {
+    if (setSimdLevel(level)) {
+      levels.push_back(level);
+    }
+  }
+  setSimdLevel(detectedSimdLevel());
+  return levels;
+}
+
+class SeriesStatsTest : public ::testing::Test {
+ protected:
+  void TearDown() override { setSimdLevel(detectedSimdLevel()); }
+};
+
+// ============================================================
+// Known Values
+// ============================================================
+TEST_F(SeriesStatsTest, SummaryOfSmallSeries) {
+  const std::vector<double> values = {2, 4, 4, 4, 5, 5, 7, 9};
+
+  EXPECT_DOUBLE_EQ(sum(values), 40.0);
+  EXPECT_DOUBLE_EQ(mean(values), 5.0);
+  EXPECT_DOUBLE_EQ(variance(values), 32.0 / 7.0);
+  EXPECT_DOUBLE_EQ(min(values), 2.0);
+  EXPECT_DOUBLE_EQ(max(values), 9.0);
+
+  Summary summary = summarize(values);
+  EXPECT_EQ(summary.count, 8u);
+  EXPECT_DOUBLE_EQ(summary.mean, 5.0);
+  EXPECT_DOUBLE_EQ(summary.variance, 32.0 / 7.0);
+  EXPECT_DOUBLE_EQ(summary.min, 2.0);
+  EXPECT_DOUBLE_EQ(summary.max, 9.0);
+}
+
+TEST_F(SeriesStatsTest, LogReturns) {
+  const std::vector<double> prices = {100.0, 110.0, 99.0, 99.0};
+
+  auto returns = logReturns(prices);
+  ASSERT_EQ(returns.size(), 3u);
+  EXPECT_DOUBLE_EQ(returns[0], std::log(1.1));
+  EXPECT_DOUBLE_EQ(returns[1], std::log(0.9));
+  EXPECT_DOUBLE_EQ(returns[2], 0.0);
+}
+
+TEST_F(SeriesStatsTest, Covariance) {
+  const std::vector<double> x = {1, 2, 3, 4, 5};
+  const std::vector<double> y = {2, 4, 6, 8, 10};
+  const std::vector<double> flat = {3, 3, 3, 3, 3};
+
+  EXPECT_DOUBLE_EQ(covariance(x, y), 5.0);
+  EXPECT_DOUBLE_EQ(covariance(x, x), variance(x));
+  EXPECT_DOUBLE_EQ(covariance(x, flat), 0.0);
+}
+
+TEST_F(SeriesStatsTest, ExtremesAnywhereInSeries) {
+  // Forces min and max into the vector body and into the scalar tail
+  for (size_t position : {0u, 5u, 16u, 36u}) {
+    std::vector<double> values(37, 1.0);
+    values[position] = -4.0;
+    values[36 - position] = 8.0;
+    EXPECT_DOUBLE_EQ(min(values), -4.0) << position;
+    EXPECT_DOUBLE_EQ(max(values), 8.0) << position;
+  }
+}
+
+// ============================================================
+// Edge Cases
+// ============================================================
+TEST_F(SeriesStatsTest, EmptyAndShortSeries) {
+  const std::vector<double> empty;
+  const std::vector<double> one = {42.0};
+
+  EXPECT_DOUBLE_EQ(sum(empty), 0.0);
+  EXPECT_THROW(mean(empty), std::invalid_argument);
+  EXPECT_THROW(min(empty), std::invalid_argument);
+  EXPECT_THROW(max(empty), std::invalid_argument);
+
+  EXPECT_EQ(summarize(empty).count, 0u);
+  EXPECT_DOUBLE_EQ(variance(one), 0.0);
+  EXPECT_DOUBLE_EQ(summarize(one).mean, 42.0);
+  EXPECT_DOUBLE_EQ(summarize(one).variance, 0.0);
+
+  EXPECT_TRUE(logReturns(empty).empty());
+  EXPECT_TRUE(logReturns(one).empty());
+  EXPECT_DOUBLE_EQ(covariance(one, one), 0.0);
+}
+
+TEST_F(SeriesStatsTest, CovarianceLengthMismatchThrows) {
+  const std::vector<double> x = {1, 2, 3};
+  const std::vector<double> y = {1, 2};
+
+  EXPECT_THROW(covariance(x, y), std::invalid_argument);
+}
+
+TEST_F(SeriesStatsTest, MultiplyAndScale) {
+  const std::vector<double> quantities = {10, 2, 0.5};
+  const std::vector<double> prices = {1.5, 100, 8};
+
+  EXPECT_EQ(multiply(quantities, prices), (std::vector<double>{15, 200, 4}));
+  EXPECT_EQ(scale(prices, 0.5), (std::vector<double>{0.75, 50, 4}));
+  EXPECT_TRUE(multiply({}, {}).empty());
+  EXPECT_TRUE(scale({}, 2.0).empty());
+  const std::vector<double> shorter = {1, 2};
+  EXPECT_THROW(multiply(quantities, shorter), std::invalid_argument);
+}
+
+TEST_F(SeriesStatsTest, SpanOverRawPointer) {
+  const double values[] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+
+  // Only the middle four
+  EXPECT_DOUBLE_EQ(mean(ValueSpan(values + 1, 4)), 3.5);
+}
+
+// ============================================================
+// Dispatch
+// ============================================================
+TEST_F(SeriesStatsTest, DetectedLevelIsActiveByDefault) {
+  EXPECT_EQ(activeSimdLevel(), detectedSimdLevel());
+  EXPECT_TRUE(setSimdLevel(SimdLevel::Scalar));
+  EXPECT_EQ(activeSimdLevel(), SimdLevel::Scalar);
+}
+
+TEST_F(SeriesStatsTest, UnsupportedLevelIsRejected) {
+#if defined(__aarch64__)
+  const SimdLevel foreign = SimdLevel::Avx2;
+#else
+  const SimdLevel foreign = SimdLevel::Neon;
+#endif
+  ASSERT_TRUE(setSimdLevel(SimdLevel::Scalar));
+
+  EXPECT_FALSE(setSimdLevel(foreign));
+  EXPECT_EQ(activeSimdLevel(), SimdLevel::Scalar);
+}
+
+TEST_F(SeriesStatsTest, EveryLevelMatchesScalar) {
+  // Odd lengths run every vector tail
+  for (size_t count : {2u, 3u, 7u, 15u, 16u, 17u, 33u, 1001u}) {
+    const auto x = randomWalk(count, 7);
+    const auto y = randomWalk(count, 11);
+
+    ASSERT_TRUE(setSimdLevel(SimdLevel::Scalar));
+    const Summary expected = summarize(x);
+    const double expected_cov = covariance(x, y);
+    const auto expected_returns = logReturns(x);
+    const auto expected_products = multiply(x, y);
+    const auto expected_scaled = scale(x, 0.37);
+
+    for (auto level : supportedLevels()) {
+      ASSERT_TRUE(setSimdLevel(level));
+      const double tolerance = 1e-9 * (1.0 + std::fabs(expected.mean));
+      Summary actual = summarize(x);
+      EXPECT_EQ(actual.count, expected.count);
+      EXPECT_NEAR(actual.mean, expected.mean, tolerance) << count;
+      EXPECT_NEAR(actual.variance, expected.variance,
+                  1e-9 * (1.0 + expected.variance))
+          << count;
+      EXPECT_DOUBLE_EQ(actual.min, expected.min) << count;
+      EXPECT_DOUBLE_EQ(actual.max, expected.max) << count;
+      EXPECT_NEAR(covariance(x, y), expected_cov,
+                  1e-9 * (1.0 + std::fabs(expected_cov)))
+          << count;
+
+      // Division and multiplication are correctly rounded in every
+      // instruction set
+      EXPECT_EQ(logReturns(x), expected_returns) << count;
+      EXPECT_EQ(multiply(x, y), expected_products) << count;
+      EXPECT_EQ(scale(x, 0.37), expected_scaled) << count;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace Analytics
@@ -0,0 +1,288 @@
+// tracing.h
+#ifndef TRACING_TRACING_H_
+#define TRACING_TRACING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Scoped spans for following one request through the layers, exported as
+// Chrome trace_event JSON (chrome://tracing, ui.perfetto.dev).
+//
+//   void AccountRepository::createAccount(...) {
+//     TRACE_SPAN("repository", "AccountRepository::createAccount");
+//     ...
+//   }
+//
+//   Tracing::Tracer::instance().start();
+//   ...
+//   Tracing::Tracer::instance().writeChromeTrace(file);
+//
+// Header-only, so every module takes it by include path alone; the
+// tracer is one per process however many modules are linked. Until
+// start() a span is one relaxed atomic load. Defining TRACING_DISABLED
+// (ENABLE_TRACING=OFF) compiles TRACE_SPAN to nothing.
+
+namespace Tracing {
+
+// ============================================================
+// SpanEvent
+// ============================================================
+
+// One finished span. Category and name are not copied, so they must be
+// string literals or otherwise stay valid until the span is exported or
+// cleared.
+struct SpanEvent {
+  const char* category = "";
+  const char* name = "";
+  int64_t start_ns = 0;  // steady clock
+  int64_t duration_ns = 0;
+  uint32_t thread_id = 0;  // 1 for the first thread that traced, ...
+};
+
+// ============================================================
+// ThreadBuffer
+// ============================================================
+
+// Ring of one thread's spans; when full, each new span overwrites the
+// oldest. Only its thread records, so the lock is uncontended but for
+// a concurrent export.
+class ThreadBuffer {
+ public:
+  ThreadBuffer(uint32_t thread_id, size_t capacity)
+      : m_threadId(thread_id), m_capacity(std::max<size_t>(capacity, 1)) {}
+
+  uint32_t threadId() const { return m_threadId; }
+
+  void record(const SpanEvent& event) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_events.size() < m_capacity) {
+      m_events.push_back(event);
+      return;
+    }
+    m_events[m_next] = event;
+    m_next = (m_next + 1) % m_capacity;
+    ++m_dropped;
+  }
+
+  // Appends the spans oldest first
+  void collect(std::vector<SpanEvent>& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out.insert(out.end(), m_events.begin() + m_next, m_events.end());
+    out.insert(out.end(), m_events.begin(), m_events.begin() + m_next);
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.clear();
+    m_next = 0;
+    m_dropped = 0;
+  }
+
+  // Spans overwritten since the last clear()
+  uint64_t dropped() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+  }
+
+ private:
+  const uint32_t m_threadId;
+  const size_t m_capacity;
+  mutable std::mutex m_mutex;
+  std::vector<SpanEvent> m_events;  // grows to m_capacity, then wraps
+  size_t m_next = 0;                // oldest once full
+  uint64_t m_dropped = 0;
+};
+
+// ============================================================
+// Tracer
+// ============================================================
+
+// The process-wide recorder. Buffers outlive their threads, so spans of
+// finished workers are still exported; clear() releases those.
+class Tracer {
+ public:
+  static constexpr size_t kDefaultBufferCapacity = 16384;  // per thread
+
+  static Tracer& instance() {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void start() { m_enabled.store(true, std::memory_order_relaxed); }
+  void stop() { m_enabled.store(false, std::memory_order_relaxed); }
+  bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  // Takes effect for threads that have not traced yet
+  void setBufferCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+  }
+
+  void record(const char* category, const char* name, int64_t start_ns,
+              int64_t duration_ns) {
+    ThreadBuffer& buffer = threadBuffer();
+    buffer.record({category, name, start_ns, duration_ns, buffer.threadId()});
+  }
+
+  // Every thread's spans, by start time
+  std::vector<SpanEvent> events() const {
+    std::vector<SpanEvent> events;
+    for (const auto& buffer : buffers()) {
+      buffer->collect(events);
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const SpanEvent& a, const SpanEvent& b) {
+                       return a.start_ns < b.start_ns;
+                     });
+    return events;
+  }
+
+  uint64_t dropped() const {
+    uint64_t dropped = 0;
+    for (const auto& buffer : buffers()) {
+      dropped += buffer->dropped();
+    }
+    return dropped;
+  }
+
+  // Discards all spans, and the buffers of threads that have exited
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto exited = [](const std::shared_ptr<ThreadBuffer>& buffer) {
+      return buffer.use_count() == 1;  // only the registry holds it
+    };
+    m_buffers.erase(
+        std::remove_if(m_buffers.begin(), m_buffers.end(), exited),
+        m_buffers.end());
+    for (const auto& buffer : m_buffers) {
+      buffer->clear();
+    }
+  }
+
+  // {"traceEvents":[...]} with one complete ("X") event per span, in
+  // microseconds from the first span
+  void writeChromeTrace(std::ostream& out) const {
+    const auto spans = events();
+    const int64_t origin = spans.empty() ? 0 : spans.front().start_ns;
+    std::string json = "{\"traceEvents\":[";
+    char number[64];
+    for (size_t i = 0; i < spans.size(); ++i) {
+      const auto& span = spans[i];
+      if (i > 0) json += ',';
+      json += "\n{\"name\":";
+      appendJsonString(span.name, json);
+      json += ",\"cat\":";
+      appendJsonString(span.category, json);
+      const int length = std::snprintf(
+          number, sizeof(number),
+          ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+          static_cast<double>(span.start_ns - origin) / 1000.0,
+          static_cast<double>(span.duration_ns) / 1000.0, span.thread_id);
+      json.append(number, static_cast<size_t>(length));
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    out << json;
+  }
+
+  // The calling thread's buffer, registered on first use
+  ThreadBuffer& threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      buffer = std::make_shared<ThreadBuffer>(++m_lastThreadId, m_capacity);
+      m_buffers.push_back(buffer);
+    }
+    return *buffer;
+  }
+
+ private:
+  Tracer() = default;
+
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buffers;
+  }
+
+  static void appendJsonString(const char* text, std::string& out) {
+    out += '"';
+    for (; *text != '\0'; ++text) {
+      const char c = *text;
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        out += escaped;
+      } else {
+        out += c;
+      }
+    }
+    out += '"';
+  }
+
+  std::atomic<bool> m_enabled{false};
+  mutable std::mutex m_mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+  size_t m_capacity = kDefaultBufferCapacity;
+  uint32_t m_lastThreadId = 0;
+};
+
+// ============================================================
+// Span
+// ============================================================
+
+// Records [construction, destruction) on the calling thread if the
+// tracer was started when it was constructed
+class Span {
+ public:
+  Span(const char* category, const char* name)
+      : m_category(category),
+        m_name(name),
+        m_startNs(Tracer::instance().enabled() ? Tracer::nowNs() : -1) {}
+
+  ~Span() {
+    if (m_startNs >= 0) {
+      Tracer::instance().record(m_category, m_name, m_startNs,
+                                Tracer::nowNs() - m_startNs);
+    }
+  }
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+ private:
+  const char* m_category;
+  const char* m_name;
+  int64_t m_startNs;
+};
+
+}  // namespace Tracing
+
+#define TRACING_CONCAT_INNER(a, b) a##b
+#define TRACING_CONCAT(a, b) TRACING_CONCAT_INNER(a, b)
+
+#ifndef TRACING_DISABLED
+// A span over the rest of the enclosing scope
+#define TRACE_SPAN(category, name) \
+  ::Tracing::Span TRACING_CONCAT(trace_span_, __LINE__)(category, name)
+#else
+#define TRACE_SPAN(category, name) static_cast<void>(0)
+#endif
+
+#endif  // TRACING_TRACING_H_
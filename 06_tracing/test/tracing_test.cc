@@ -0,0 +1,135 @@
+#include "tracing.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Tracing {
+namespace {
+
+class TracingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Tracer::instance().stop();
+    Tracer::instance().clear();
+  }
+  void TearDown() override {
+    Tracer::instance().stop();
+    Tracer::instance().setBufferCapacity(Tracer::kDefaultBufferCapacity);
+    Tracer::instance().clear();
+  }
+};
+
+TEST_F(TracingTest, NothingIsRecordedUntilStarted) {
+  { TRACE_SPAN("test", "before"); }
+  EXPECT_TRUE(Tracer::instance().events().empty());
+
+  Tracer::instance().start();
+  { TRACE_SPAN("test", "during"); }
+  Tracer::instance().stop();
+  { TRACE_SPAN("test", "after"); }
+
+  const auto events = Tracer::instance().events();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_STREQ(events[0].name, "during");
+  EXPECT_STREQ(events[0].category, "test");
+}
+
+TEST_F(TracingTest, NestedSpansEnclose) {
+  Tracer::instance().start();
+  {
+    TRACE_SPAN("test", "outer");
+    {
+      TRACE_SPAN("test", "inner");
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  const auto events = Tracer::instance().events();
+  ASSERT_EQ(events.size(), 2u);
+  // By start time, so the outer span comes first
+  const auto& outer = events[0];
+  const auto& inner = events[1];
+  EXPECT_STREQ(outer.name, "outer");
+  EXPECT_STREQ(inner.name, "inner");
+  EXPECT_GE(inner.duration_ns, 1000000);
+  EXPECT_LE(outer.start_ns, inner.start_ns);
+  EXPECT_GE(outer.start_ns + outer.duration_ns,
+            inner.start_ns + inner.duration_ns);
+  EXPECT_EQ(outer.thread_id, inner.thread_id);
+}
+
+TEST_F(TracingTest, FullBufferKeepsTheNewest) {
+  Tracer::instance().setBufferCapacity(4);
+  Tracer::instance().start();
+  // Capacity applies to threads that have not traced yet
+  std::thread worker([] {
+    for (int i = 0; i < 10; ++i) {
+      Span span("test", i < 6 ? "old" : "new");
+    }
+  });
+  worker.join();
+
+  const auto events = Tracer::instance().events();
+  ASSERT_EQ(events.size(), 4u);
+  for (const auto& event : events) {
+    EXPECT_STREQ(event.name, "new");
+  }
+  EXPECT_EQ(Tracer::instance().dropped(), 6u);
+}
+
+TEST_F(TracingTest, ThreadsGetTheirOwnIdsAndOutliveExit) {
+  Tracer::instance().start();
+  { TRACE_SPAN("test", "main"); }
+  std::thread worker([] { TRACE_SPAN("test", "worker"); });
+  worker.join();
+
+  auto events = Tracer::instance().events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_NE(events[0].thread_id, events[1].thread_id);
+
+  // The worker's buffer goes with its spans
+  Tracer::instance().clear();
+  EXPECT_TRUE(Tracer::instance().events().empty());
+  { TRACE_SPAN("test", "main"); }
+  events = Tracer::instance().events();
+  ASSERT_EQ(events.size(), 1u);
+}
+
+TEST_F(TracingTest, ChromeTraceHasOneCompleteEventPerSpan) {
+  Tracer::instance().start();
+  { TRACE_SPAN("cli", "Say \"hi\""); }
+  { TRACE_SPAN("db", "SqliteDatabase::execute"); }
+
+  std::ostringstream out;
+  Tracer::instance().writeChromeTrace(out);
+  const std::string json = out.str();
+
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_NE(json.find("\"name\":\"Say \\\"hi\\\"\",\"cat\":\"cli\","
+                      "\"ph\":\"X\",\"ts\":0.000,"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"SqliteDatabase::execute\",\"cat\":\"db\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"displayTimeUnit\":\"ms\"}"), std::string::npos);
+
+  size_t complete = 0;
+  for (size_t at = json.find("\"ph\":\"X\""); at != std::string::npos;
+       at = json.find("\"ph\":\"X\"", at + 1)) {
+    ++complete;
+  }
+  EXPECT_EQ(complete, 2u);
+}
+
+TEST_F(TracingTest, EmptyTraceIsValid) {
+  std::ostringstream out;
+  Tracer::instance().writeChromeTrace(out);
+  EXPECT_EQ(out.str(), "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+}  // namespace
+}  // namespace Tracing
@@ -0,0 +1,428 @@
+// executor.h
+#ifndef CONCURRENCY_EXECUTOR_H_
+#define CONCURRENCY_EXECUTOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A thread pool shared by the gateways, use cases and presenters, so
+// each parallel operation borrows workers instead of starting threads.
+//
+//   auto future = Concurrency::Executor::shared().submit([] { return 42; });
+//   Concurrency::Executor::shared().parallelFor(ids.size(), 8,
+//                                               [&](size_t i) { ... });
+//
+// Every worker owns a deque: tasks a worker submits go to the back of its
+// own and it takes from the back, so related work stays on one core;
+// tasks from other threads go to a shared FIFO queue; an idle worker
+// steals from the front of the others' deques. Submissions from outside
+// block while queueCapacity tasks wait (backpressure); a worker's own
+// submissions never block, as that could deadlock the pool.
+//
+// Header-only, like 06_tracing: modules take it by include path.
+
+namespace Concurrency {
+
+// ============================================================
+// Cancellation
+// ============================================================
+
+class OperationCancelled : public std::runtime_error {
+ public:
+  OperationCancelled() : std::runtime_error("Operation cancelled") {}
+};
+
+// Cooperative: tasks check cancelled() at points where stopping is safe.
+// A default-constructed token is never cancelled.
+class CancellationToken {
+ public:
+  CancellationToken() = default;
+
+  bool cancelled() const {
+    return m_flag && m_flag->load(std::memory_order_acquire);
+  }
+  // Throws OperationCancelled once cancelled
+  void throwIfCancelled() const {
+    if (cancelled()) {
+      throw OperationCancelled();
+    }
+  }
+
+ private:
+  friend class CancellationSource;
+  explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> flag)
+      : m_flag(std::move(flag)) {}
+
+  std::shared_ptr<const std::atomic<bool>> m_flag;
+};
+
+class CancellationSource {
+ public:
+  CancellationSource() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+  CancellationToken token() const { return CancellationToken(m_flag); }
+  void cancel() { m_flag->store(true, std::memory_order_release); }
+  bool cancelled() const { return m_flag->load(std::memory_order_acquire); }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+// ============================================================
+// Executor
+// ============================================================
+
+struct ExecutorOptions {
+  // Worker threads; 0 starts one per core
+  size_t threads = 0;
+  // Tasks waiting before a submission from outside the pool blocks
+  size_t queueCapacity = 1024;
+};
+
+class Executor {
+ public:
+  // Throws std::invalid_argument if queueCapacity is 0
+  explicit Executor(const ExecutorOptions& options = {})
+      : m_capacity(options.queueCapacity) {
+    if (options.queueCapacity == 0) {
+      throw std::invalid_argument("Executor queue capacity must be positive");
+    }
+    size_t threads = options.threads;
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+      m_workers[i]->thread = std::thread([this, i] { run(i); });
+    }
+  }
+
+  // Runs every queued task, then joins the workers. Must not run on one
+  // of them.
+  ~Executor() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_available.notify_all();
+    m_notFull.notify_all();
+    for (auto& worker : m_workers) {
+      worker->thread.join();
+    }
+  }
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+  Executor(Executor&&) = delete;
+  Executor& operator=(Executor&&) = delete;
+
+  // The process-wide pool, one worker per core, started on first use
+  static Executor& shared() {
+    static Executor executor;
+    return executor;
+  }
+
+  size_t threadCount() const { return m_workers.size(); }
+  bool onWorkerThread() const { return context().executor == this; }
+
+  // Runs task on a worker; the future holds its result or exception.
+  // Throws std::logic_error once the executor is being destroyed.
+  template <typename F>
+  auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    auto [wrapped, future] = package(std::forward<F>(task));
+    enqueue(std::move(wrapped), true);
+    return std::move(future);
+  }
+
+  // As above, but if token is cancelled before a worker starts the task,
+  // it is skipped and the future throws OperationCancelled
+  template <typename F>
+  auto submit(CancellationToken token, F&& task)
+      -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    return submit([token = std::move(token),
+                   task = std::forward<F>(task)]() mutable {
+      token.throwIfCancelled();
+      return task();
+    });
+  }
+
+  // submit() that returns nullopt instead of blocking when the queue is
+  // full
+  template <typename F>
+  auto trySubmit(F&& task)
+      -> std::optional<std::future<std::invoke_result_t<std::decay_t<F>>>> {
+    auto [wrapped, future] = package(std::forward<F>(task));
+    if (!enqueue(std::move(wrapped), false)) {
+      return std::nullopt;
+    }
+    return std::move(future);
+  }
+
+  // Fire and forget: an exception the task throws is dropped
+  void post(std::function<void()> task) {
+    enqueue(guard(std::move(task)), true);
+  }
+  // post() that returns false instead of blocking when the queue is full
+  bool tryPost(std::function<void()> task) {
+    return enqueue(guard(std::move(task)), false);
+  }
+
+  // Calls body(i) for every i in [0, count) on the calling thread and up
+  // to maxParallelism - 1 workers, and returns once all calls have. The
+  // caller works too, so this makes progress however busy the pool is,
+  // also from inside one of its tasks. After the first exception, or
+  // once token is cancelled, no further calls start; the exception, or
+  // OperationCancelled, is rethrown. maxParallelism 0 means 1.
+  void parallelFor(size_t count, size_t maxParallelism,
+                   const std::function<void(size_t)>& body,
+                   const CancellationToken& token = {}) {
+    auto state = std::make_shared<ForState>(count, body, token);
+    const size_t helpers =
+        std::min({std::max<size_t>(maxParallelism, 1), count,
+                  threadCount() + 1}) -
+        (count > 0 ? 1 : 0);
+    for (size_t h = 0; h < helpers; ++h) {
+      // A helper that finds the pool full is left out, not waited for
+      if (!enqueue([state] { state->work(); }, false)) {
+        break;
+      }
+    }
+    state->work();
+    state->finish();  // late helpers return without touching body
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+    if (token.cancelled()) {
+      throw OperationCancelled();
+    }
+  }
+
+ private:
+  using Task = std::function<void()>;
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;  // the owner at the back, thieves the front
+    std::thread thread;
+  };
+
+  struct Context {
+    const Executor* executor = nullptr;
+    size_t index = 0;
+  };
+
+  struct ForState {
+    ForState(size_t count, const std::function<void(size_t)>& body,
+             const CancellationToken& token)
+        : count(count), body(&body), token(token) {}
+
+    void work() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) {
+          return;
+        }
+        ++running;
+      }
+      while (!failed.load(std::memory_order_relaxed) && !token.cancelled()) {
+        const size_t i = next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count) {
+          break;
+        }
+        try {
+          (*body)(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+          failed.store(true, std::memory_order_relaxed);
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--running == 0) {
+        idle.notify_all();
+      }
+    }
+
+    // Waits for the running helpers; those not yet started never will
+    void finish() {
+      std::unique_lock<std::mutex> lock(mutex);
+      closed = true;
+      idle.wait(lock, [this] { return running == 0; });
+    }
+
+    const size_t count;
+    const std::function<void(size_t)>* body;  // valid until finish()
+    const CancellationToken token;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    std::condition_variable idle;
+    size_t running = 0;
+    bool closed = false;
+    std::exception_ptr error;
+  };
+
+  static Context& context() {
+    thread_local Context current;
+    return current;
+  }
+
+  template <typename F>
+  static auto package(F&& task) {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+    // std::function needs a copyable target
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(
+        std::forward<F>(task));
+    auto future = packaged->get_future();
+    return std::make_pair(Task([packaged] { (*packaged)(); }),
+                          std::move(future));
+  }
+
+  static Task guard(std::function<void()> task) {
+    return [task = std::move(task)] {
+      try {
+        task();
+      } catch (...) {
+      }
+    };
+  }
+
+  // Returns false if block is false and the queue is full
+  bool enqueue(Task task, bool block) {
+    const Context& self = context();
+    const bool inside = self.executor == this;
+    if (!inside) {
+      if (m_queued.load() >= m_capacity) {
+        if (!block) {
+          return false;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_blocked;
+        m_notFull.wait(lock, [this] {
+          return m_stopping || m_queued.load() < m_capacity;
+        });
+        --m_blocked;
+      }
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_stopping) {
+        throw std::logic_error("Executor is shutting down");
+      }
+      m_injected.push_back(std::move(task));
+      m_queued.fetch_add(1);
+    } else {
+      if (!block && m_queued.load() >= m_capacity) {
+        return false;
+      }
+      // Counted first, so a thief's decrement cannot run ahead of it
+      m_queued.fetch_add(1);
+      Worker& worker = *m_workers[self.index];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+    }
+    // Paired with the sleeper's count in run(): one of the two sees the
+    // other, so no wake-up is lost
+    if (m_sleeping.load() > 0) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_available.notify_one();
+    }
+    return true;
+  }
+
+  // The own deque's back, then the shared queue, then other deques' fronts
+  bool tryTake(size_t self, Task& task) {
+    if (!takeFrom(self, task)) {
+      return false;
+    }
+    // Paired with the submitter's count in enqueue(), as for sleepers
+    if (m_queued.fetch_sub(1) <= m_capacity && m_blocked.load() > 0) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_notFull.notify_one();
+    }
+    return true;
+  }
+
+  bool takeFrom(size_t self, Task& task) {
+    {
+      Worker& own = *m_workers[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_injected.empty()) {
+        task = std::move(m_injected.front());
+        m_injected.pop_front();
+        return true;
+      }
+    }
+    for (size_t k = 1; k < m_workers.size(); ++k) {
+      Worker& victim = *m_workers[(self + k) % m_workers.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(size_t self) {
+    context() = {this, self};
+    Task task;
+    while (true) {
+      if (tryTake(self, task)) {
+        task();
+        task = nullptr;  // captures go before the next wait
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      ++m_sleeping;
+      m_available.wait(lock,
+                       [this] { return m_stopping || m_queued.load() > 0; });
+      --m_sleeping;
+      if (m_stopping && m_queued.load() == 0) {
+        return;  // drained
+      }
+    }
+  }
+
+  const size_t m_capacity;
+  std::vector<std::unique_ptr<Worker>> m_workers;
+
+  std::mutex m_mutex;
+  std::deque<Task> m_injected;  // from outside the pool; under m_mutex
+  std::condition_variable m_available;
+  std::condition_variable m_notFull;
+  std::atomic<size_t> m_queued{0};  // in any queue, not yet started
+  std::atomic<size_t> m_sleeping{0};
+  std::atomic<size_t> m_blocked{0};  // submitters waiting for room
+  bool m_stopping = false;           // under m_mutex
+};
+
+}  // namespace Concurrency
+
+#endif  // CONCURRENCY_EXECUTOR_H_
@@ -0,0 +1,225 @@
+#include "executor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Concurrency {
+namespace {
+
+using namespace std::chrono_literals;
+
+ExecutorOptions Options(size_t threads, size_t capacity = 1024) {
+  ExecutorOptions options;
+  options.threads = threads;
+  options.queueCapacity = capacity;
+  return options;
+}
+
+// Holds workers in a task until opened
+class Gate {
+ public:
+  void wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_opened.wait(lock, [this] { return m_open; });
+  }
+  void open() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_open = true;
+    }
+    m_opened.notify_all();
+  }
+
+ private:
+  std::mutex m_mutex;
+  std::condition_variable m_opened;
+  bool m_open = false;
+};
+
+TEST(ExecutorTest, SubmitReturnsResultsAndExceptions) {
+  Executor executor(Options(2));
+  EXPECT_EQ(executor.threadCount(), 2u);
+
+  auto answer = executor.submit([] { return 42; });
+  auto text = executor.submit([] { return std::string("done"); });
+  auto failure = executor.submit([]() -> int {
+    throw std::runtime_error("boom");
+  });
+  EXPECT_EQ(answer.get(), 42);
+  EXPECT_EQ(text.get(), "done");
+  EXPECT_THROW(failure.get(), std::runtime_error);
+}
+
+TEST(ExecutorTest, TasksRunOnWorkerThreads) {
+  Executor executor(Options(2));
+  EXPECT_FALSE(executor.onWorkerThread());
+  EXPECT_TRUE(executor.submit([&] { return executor.onWorkerThread(); }).get());
+}
+
+TEST(ExecutorTest, RejectsZeroCapacity) {
+  EXPECT_THROW(Executor(Options(1, 0)), std::invalid_argument);
+}
+
+TEST(ExecutorTest, WorkerSubmissionsAreStolenByIdleWorkers) {
+  Executor executor(Options(4));
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  std::atomic<int> done{0};
+
+  // One task fans out onto its own deque; the others steal from it
+  executor
+      .submit([&] {
+        std::vector<std::future<void>> children;
+        for (int i = 0; i < 64; ++i) {
+          children.push_back(executor.submit([&] {
+            std::this_thread::sleep_for(1ms);
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+            ++done;
+          }));
+        }
+        return children.size();
+      })
+      .get();
+  while (done.load() < 64) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_GT(threads.size(), 1u);
+}
+
+TEST(ExecutorTest, FullQueueBlocksSubmitAndFailsTrySubmit) {
+  Executor executor(Options(1, 2));
+  Gate gate;
+  std::promise<void> started;
+  executor.post([&] {
+    started.set_value();
+    gate.wait();
+  });
+  started.get_future().wait();
+
+  // The worker is held, so two tasks fill the queue
+  auto first = executor.submit([] { return 1; });
+  auto second = executor.submit([] { return 2; });
+  EXPECT_FALSE(executor.trySubmit([] { return 3; }).has_value());
+  EXPECT_FALSE(executor.tryPost([] {}));
+
+  std::atomic<bool> submitted{false};
+  std::thread producer([&] {
+    executor.submit([] { return 4; }).get();
+    submitted = true;
+  });
+  std::this_thread::sleep_for(20ms);
+  EXPECT_FALSE(submitted.load());  // waiting for room
+
+  gate.open();
+  producer.join();
+  EXPECT_TRUE(submitted.load());
+  EXPECT_EQ(first.get() + second.get(), 3);
+}
+
+TEST(ExecutorTest, CancelledTaskIsSkipped) {
+  Executor executor(Options(1));
+  Gate gate;
+  executor.post([&] { gate.wait(); });
+
+  CancellationSource source;
+  std::atomic<bool> ran{false};
+  auto skipped = executor.submit(source.token(), [&] { ran = true; });
+  auto kept = executor.submit(CancellationToken(), [] { return 7; });
+  source.cancel();
+  gate.open();
+
+  EXPECT_THROW(skipped.get(), OperationCancelled);
+  EXPECT_EQ(kept.get(), 7);
+  EXPECT_FALSE(ran.load());
+}
+
+TEST(ExecutorTest, ParallelForCallsEveryIndexOnce) {
+  Executor executor(Options(3));
+  std::vector<std::atomic<int>> calls(1000);
+  executor.parallelFor(calls.size(), 4, [&](size_t i) { ++calls[i]; });
+  for (const auto& count : calls) {
+    EXPECT_EQ(count.load(), 1);
+  }
+
+  // Nothing to do, and a parallelism of 0, are both fine
+  executor.parallelFor(0, 4, [](size_t) { FAIL(); });
+  int serial = 0;
+  executor.parallelFor(5, 0, [&](size_t) { ++serial; });
+  EXPECT_EQ(serial, 5);
+}
+
+TEST(ExecutorTest, ParallelForRethrowsAndStops) {
+  Executor executor(Options(2));
+  std::atomic<int> calls{0};
+  EXPECT_THROW(executor.parallelFor(10000, 3,
+                                    [&](size_t i) {
+                                      ++calls;
+                                      if (i == 10) {
+                                        throw std::runtime_error("bad");
+                                      }
+                                    }),
+               std::runtime_error);
+  EXPECT_LT(calls.load(), 10000);
+}
+
+TEST(ExecutorTest, ParallelForHonoursCancellation) {
+  Executor executor(Options(2));
+  CancellationSource source;
+  std::atomic<int> calls{0};
+  EXPECT_THROW(executor.parallelFor(10000, 3,
+                                    [&](size_t i) {
+                                      ++calls;
+                                      if (i == 5) source.cancel();
+                                    },
+                                    source.token()),
+               OperationCancelled);
+  EXPECT_LT(calls.load(), 10000);
+}
+
+TEST(ExecutorTest, NestedParallelForDoesNotDeadlock) {
+  // Every worker is inside the outer loop, so inner loops run on their
+  // callers
+  Executor executor(Options(1));
+  std::atomic<int> calls{0};
+  executor.submit([&] {
+            executor.parallelFor(4, 4, [&](size_t) {
+              executor.parallelFor(4, 4, [&](size_t) { ++calls; });
+            });
+          })
+      .get();
+  EXPECT_EQ(calls.load(), 16);
+}
+
+TEST(ExecutorTest, DestructorRunsQueuedTasks) {
+  std::atomic<int> ran{0};
+  {
+    Executor executor(Options(1));
+    Gate gate;
+    executor.post([&] { gate.wait(); });
+    for (int i = 0; i < 10; ++i) {
+      executor.post([&] { ++ran; });
+    }
+    executor.post([] { throw std::runtime_error("dropped"); });
+    gate.open();
+  }
+  EXPECT_EQ(ran.load(), 10);
+}
+
+TEST(ExecutorTest, SharedExecutorIsOnePerProcess) {
+  EXPECT_EQ(&Executor::shared(), &Executor::shared());
+  EXPECT_GE(Executor::shared().threadCount(), 1u);
+  EXPECT_EQ(Executor::shared().submit([] { return 1; }).get(), 1);
+}
+
+}  // namespace
+}  // namespace Concurrency
@@ -0,0 +1,100 @@
+// alloc_counter.h
+#ifndef ALLOC_COUNTER_ALLOC_COUNTER_H_
+#define ALLOC_COUNTER_ALLOC_COUNTER_H_
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts heap allocations inside a scope, so tests can hold hot paths to
+// an allocation budget:
+//
+//   AllocCounter::AllocationScope scope;
+//   for (int i = 0; i < kRows; ++i) statement.execute();
+//   EXPECT_TRUE(AllocCounter::withinBudget(scope.stats(), kRows, 2));
+//
+// The counts come from replacing the global operator new and delete in
+// src/alloc_counter.cc, which a test executable adds to its sources; a
+// test that includes this header without it fails to link. Compiled
+// with ALLOC_COUNTER_HOOK_MALLOC (glibc only), malloc, calloc, realloc
+// and free are counted too, which covers C libraries such as SQLite.
+
+namespace AllocCounter {
+
+// ============================================================
+// AllocationStats
+// ============================================================
+
+struct AllocationStats {
+  uint64_t allocations = 0;  // operator new, and malloc if hooked
+  uint64_t deallocations = 0;
+  uint64_t bytes = 0;  // requested by those allocations
+};
+
+// Counts of the calling thread, or of every thread, since the start
+AllocationStats threadTotals();
+AllocationStats processTotals();
+
+// Whether the malloc family is counted (ALLOC_COUNTER_HOOK_MALLOC)
+bool mallocHooked();
+
+// ============================================================
+// AllocationScope
+// ============================================================
+
+enum class Threads {
+  Current,  // the thread that made the scope
+  All,      // every thread, e.g. for work handed to an executor
+};
+
+// Allocations since construction or the last reset(). Counting Current
+// leaves out other threads, such as gtest's or a pool's idle workers.
+class AllocationScope {
+ public:
+  explicit AllocationScope(Threads threads = Threads::Current)
+      : m_threads(threads), m_start(totals()) {}
+
+  AllocationStats stats() const {
+    const AllocationStats now = totals();
+    return {now.allocations - m_start.allocations,
+            now.deallocations - m_start.deallocations,
+            now.bytes - m_start.bytes};
+  }
+
+  void reset() { m_start = totals(); }
+
+ private:
+  AllocationStats totals() const {
+    return m_threads == Threads::All ? processTotals() : threadTotals();
+  }
+
+  Threads m_threads;
+  AllocationStats m_start;
+};
+
+// Passes if stats has at most per_operation allocations per operation,
+// plus overhead for the scope as a whole (a result vector growing, say),
+// with the counts in the failure message
+inline ::testing::AssertionResult withinBudget(const AllocationStats& stats,
+                                               uint64_t operations,
+                                               double per_operation,
+                                               uint64_t overhead = 0) {
+  const double budget = per_operation * static_cast<double>(operations) +
+                        static_cast<double>(overhead);
+  if (static_cast<double>(stats.allocations) <= budget) {
+    return ::testing::AssertionSuccess();
+  }
+  auto failure = ::testing::AssertionFailure()
+                 << stats.allocations << " allocations (" << stats.bytes
+                 << " bytes) for " << operations << " operations, budget "
+                 << per_operation << " per operation";
+  if (overhead > 0) {
+    failure << " plus " << overhead;
+  }
+  return failure;
+}
+
+}  // namespace AllocCounter
+
+#endif  // ALLOC_COUNTER_ALLOC_COUNTER_H_
@@ -0,0 +1,237 @@
+// alloc_counter.cc - the global allocation functions that do the counting.
+// Link into one test executable at most once.
+#include "alloc_counter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(ALLOC_COUNTER_HOOK_MALLOC) && !defined(__GLIBC__)
+#error "ALLOC_COUNTER_HOOK_MALLOC needs glibc's __libc_malloc"
+#endif
+
+#ifdef ALLOC_COUNTER_HOOK_MALLOC
+// glibc's own entry points, so the hooks below can forward to them
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+}
+#endif
+
+namespace AllocCounter {
+
+namespace {
+
+// Constant-initialised, so counting never allocates or runs a
+// constructor, also on threads that are starting or exiting
+thread_local AllocationStats t_counts;
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_deallocations{0};
+std::atomic<uint64_t> g_bytes{0};
+
+void countAllocation(size_t size) {
+  ++t_counts.allocations;
+  t_counts.bytes += size;
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void countDeallocation() {
+  ++t_counts.deallocations;
+  g_deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Allocate without being counted a second time by the malloc hooks
+void* rawAllocate(size_t size) {
+#ifdef ALLOC_COUNTER_HOOK_MALLOC
+  return __libc_malloc(size);
+#else
+  return std::malloc(size);
+#endif
+}
+
+void rawFree(void* pointer) {
+#ifdef ALLOC_COUNTER_HOOK_MALLOC
+  __libc_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+void* allocate(size_t size) {
+  void* pointer = rawAllocate(size == 0 ? 1 : size);
+  if (pointer) {
+    countAllocation(size);
+  }
+  return pointer;
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) {
+  void* pointer = nullptr;
+  const size_t align =
+      std::max(static_cast<size_t>(alignment), sizeof(void*));
+  if (posix_memalign(&pointer, align, size == 0 ? 1 : size) != 0) {
+    return nullptr;
+  }
+  countAllocation(size);
+  return pointer;
+}
+
+void deallocate(void* pointer) {
+  if (pointer) {
+    countDeallocation();
+    rawFree(pointer);
+  }
+}
+
+}  // namespace
+
+AllocationStats threadTotals() { return t_counts; }
+
+AllocationStats processTotals() {
+  return {g_allocations.load(std::memory_order_relaxed),
+          g_deallocations.load(std::memory_order_relaxed),
+          g_bytes.load(std::memory_order_relaxed)};
+}
+
+bool mallocHooked() {
+#ifdef ALLOC_COUNTER_HOOK_MALLOC
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace AllocCounter
+
+// ============================================================
+// operator new / delete
+// ============================================================
+
+void* operator new(size_t size) {
+  void* pointer = AllocCounter::allocate(size);
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return AllocCounter::allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return AllocCounter::allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  void* pointer = AllocCounter::allocateAligned(size, alignment);
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return AllocCounter::allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return AllocCounter::allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept {
+  AllocCounter::deallocate(pointer);
+}
+
+// ============================================================
+// malloc family
+// ============================================================
+
+#ifdef ALLOC_COUNTER_HOOK_MALLOC
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+  void* pointer = __libc_malloc(size);
+  if (pointer) {
+    AllocCounter::countAllocation(size);
+  }
+  return pointer;
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  void* pointer = __libc_calloc(count, size);
+  if (pointer) {
+    AllocCounter::countAllocation(count * size);
+  }
+  return pointer;
+}
+
+// Counted as a new allocation and the release of the old one
+void* realloc(void* pointer, size_t size) noexcept {
+  void* moved = __libc_realloc(pointer, size);
+  if (moved) {
+    AllocCounter::countAllocation(size);
+  }
+  if (pointer && (moved || size == 0)) {
+    AllocCounter::countDeallocation();
+  }
+  return moved;
+}
+
+void free(void* pointer) noexcept {
+  if (pointer) {
+    AllocCounter::countDeallocation();
+  }
+  __libc_free(pointer);
+}
+
+}  // extern "C"
+#endif
@@ -0,0 +1,118 @@
+#include "alloc_counter.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AllocCounter {
+namespace {
+
+// Keeps the optimizer from pairing up and removing a new and its delete
+void Keep(void* pointer) { asm volatile("" : : "g"(pointer) : "memory"); }
+
+struct alignas(64) CacheLine {
+  char bytes[64];
+};
+
+TEST(AllocCounterTest, CountsNewAndDeleteInScope) {
+  AllocationScope scope;
+  auto value = std::make_unique<int64_t>(7);
+  Keep(value.get());
+
+  AllocationStats stats = scope.stats();
+  EXPECT_EQ(stats.allocations, 1u);
+  EXPECT_EQ(stats.deallocations, 0u);
+  EXPECT_EQ(stats.bytes, sizeof(int64_t));
+
+  value.reset();
+  EXPECT_EQ(scope.stats().deallocations, 1u);
+
+  scope.reset();
+  EXPECT_EQ(scope.stats().allocations, 0u);
+}
+
+TEST(AllocCounterTest, CountsArrayAlignedAndNothrowForms) {
+  AllocationScope scope;
+  int* array = new int[16];
+  Keep(array);
+  auto* line = new CacheLine;
+  Keep(line);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(line) % alignof(CacheLine), 0u);
+  int* nothrow = new (std::nothrow) int(3);
+  Keep(nothrow);
+  delete nothrow;
+  delete line;
+  delete[] array;
+
+  const AllocationStats stats = scope.stats();
+  EXPECT_EQ(stats.allocations, 3u);
+  EXPECT_EQ(stats.deallocations, 3u);
+  EXPECT_EQ(stats.bytes, 16 * sizeof(int) + sizeof(CacheLine) + sizeof(int));
+}
+
+TEST(AllocCounterTest, CurrentLeavesOutOtherThreads) {
+  AllocationScope mine;
+  AllocationScope all(Threads::All);
+  std::thread other([] {
+    std::string text(1000, 'x');
+    Keep(text.data());
+  });
+  other.join();
+
+  // Starting the thread allocates its state here, the string there
+  EXPECT_LT(mine.stats().bytes, 1000u);
+  EXPECT_GE(all.stats().bytes, 1000u);
+}
+
+TEST(AllocCounterTest, CountsTheMallocFamilyWhenHooked) {
+  AllocationScope scope;
+  void* block = std::malloc(100);
+  Keep(block);
+  block = std::realloc(block, 200);
+  Keep(block);
+  std::free(block);
+
+  const AllocationStats stats = scope.stats();
+  if (mallocHooked()) {
+    EXPECT_EQ(stats.allocations, 2u);
+    EXPECT_EQ(stats.deallocations, 2u);
+    EXPECT_EQ(stats.bytes, 300u);
+  } else {
+    EXPECT_EQ(stats.allocations, 0u);
+  }
+}
+
+TEST(AllocCounterTest, ReservedVectorPushesWithoutAllocating) {
+  std::vector<int64_t> values;
+  values.reserve(1000);
+  AllocationScope scope;
+  for (int64_t i = 0; i < 1000; ++i) {
+    values.push_back(i);
+  }
+  EXPECT_TRUE(withinBudget(scope.stats(), 1000, 0));
+}
+
+TEST(AllocCounterTest, WithinBudgetReportsTheCounts) {
+  AllocationStats stats;
+  stats.allocations = 30;
+  stats.bytes = 480;
+  EXPECT_TRUE(withinBudget(stats, 10, 3));
+
+  const auto result = withinBudget(stats, 10, 2);
+  EXPECT_FALSE(result);
+  EXPECT_STREQ(result.message(),
+               "30 allocations (480 bytes) for 10 operations, budget 2 per "
+               "operation");
+
+  EXPECT_TRUE(withinBudget(stats, 10, 2, 10));
+  EXPECT_STREQ(withinBudget(stats, 10, 2, 5).message(),
+               "30 allocations (480 bytes) for 10 operations, budget 2 per "
+               "operation plus 5");
+}
+
+}  // namespace
+}  // namespace AllocCounter
@@ -0,0 +1,315 @@
+#ifndef CONTAINERS_RING_BUFFER_H_
+#define CONTAINERS_RING_BUFFER_H_
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Containers {
+
+// RingBuffer<T> takes its capacity at construction instead of as N
+inline constexpr size_t kDynamicCapacity = std::numeric_limits<size_t>::max();
+
+// What push() does when the buffer is full
+enum class RingOverflow {
+  Reject,           // leaves the buffer unchanged and returns false
+  OverwriteOldest,  // drops the oldest element to make room
+};
+
+// ============================================================
+// RingSegment - a contiguous run of elements
+// ============================================================
+
+// A view of size() elements from data(), valid until the buffer is next
+// modified. U is T or const T.
+template <typename U>
+class RingSegment {
+ public:
+  RingSegment() = default;
+  RingSegment(U* data, size_t size) : m_data(data), m_size(size) {}
+
+  U* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  U* begin() const { return m_data; }
+  U* end() const { return m_data + m_size; }
+  U& operator[](size_t i) const { return m_data[i]; }
+
+ private:
+  U* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+// The elements oldest first: first, then second. second is empty unless
+// the elements wrap past the end of the storage.
+template <typename U>
+struct RingSegments {
+  RingSegment<U> first;
+  RingSegment<U> second;
+};
+
+// ============================================================
+// RingBuffer - fixed-memory FIFO window
+// ============================================================
+
+// FIFO of at most capacity elements in storage allocated once: inline
+// (std::array) when N is given, on the heap at construction for
+// RingBuffer<T>. push(), pop() and clear() never allocate, so a window
+// of records such as CompactPoints or (value, weight) pairs can be
+// updated on a hot path. Elements are assigned into slots that were
+// default-constructed up front, so T needs a default constructor and
+// assignment; popped elements stay in their slot, not destroyed, until
+// they are overwritten.
+//
+// Index 0 and front() are the oldest element, back() the newest.
+// Iterators are random access, in that order, and are invalidated by
+// any modification. Not thread-safe.
+//
+//   RingBuffer<CompactPoint, 256> window(RingOverflow::OverwriteOldest);
+//   RingBuffer<double> returns(window_size, RingOverflow::OverwriteOldest);
+template <typename T, size_t N = kDynamicCapacity>
+class RingBuffer {
+  static_assert(N > 0, "RingBuffer capacity must be positive");
+  static_assert(std::is_default_constructible_v<T>,
+                "RingBuffer slots are default-constructed up front");
+
+  template <bool Const>
+  class Iterator;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  template <size_t M = N, std::enable_if_t<M != kDynamicCapacity, int> = 0>
+  explicit RingBuffer(RingOverflow overflow = RingOverflow::Reject)
+      : m_overflow(overflow) {}
+
+  // Throws std::invalid_argument if capacity is 0
+  template <size_t M = N, std::enable_if_t<M == kDynamicCapacity, int> = 0>
+  explicit RingBuffer(size_t capacity,
+                      RingOverflow overflow = RingOverflow::Reject)
+      : m_overflow(overflow) {
+    if (capacity == 0) {
+      throw std::invalid_argument("RingBuffer capacity must be positive");
+    }
+    m_slots.resize(capacity);
+  }
+
+  size_t capacity() const { return m_slots.size(); }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  bool full() const { return m_size == capacity(); }
+  RingOverflow overflow() const { return m_overflow; }
+
+  // Appends value as the newest element. When full, Reject returns false
+  // and OverwriteOldest replaces the oldest element; front() before the
+  // push is the element about to go.
+  bool push(const T& value) { return pushImpl(value); }
+  bool push(T&& value) { return pushImpl(std::move(value)); }
+
+  // Drops the oldest element; false if empty
+  bool pop() {
+    if (m_size == 0) {
+      return false;
+    }
+    m_first = wrap(m_first + 1);
+    --m_size;
+    return true;
+  }
+
+  // Drops the oldest min(count, size()) elements
+  void pop(size_t count) {
+    if (count >= m_size) {
+      clear();
+      return;
+    }
+    m_first = wrap(m_first + count);
+    m_size -= count;
+  }
+
+  void clear() {
+    m_first = 0;
+    m_size = 0;
+  }
+
+  // Undefined if empty, like std::deque
+  T& front() { return m_slots[m_first]; }
+  const T& front() const { return m_slots[m_first]; }
+  T& back() { return (*this)[m_size - 1]; }
+  const T& back() const { return (*this)[m_size - 1]; }
+
+  // i from the oldest; undefined past size()
+  T& operator[](size_t i) { return m_slots[wrap(m_first + i)]; }
+  const T& operator[](size_t i) const { return m_slots[wrap(m_first + i)]; }
+
+  // Throws std::out_of_range past size()
+  T& at(size_t i) {
+    checkIndex(i);
+    return (*this)[i];
+  }
+  const T& at(size_t i) const {
+    checkIndex(i);
+    return (*this)[i];
+  }
+
+  // The elements as at most two contiguous runs, for memcpy or a kernel
+  // over a ValueSpan
+  RingSegments<T> segments() { return segmentsOf<T>(m_slots.data()); }
+  RingSegments<const T> segments() const {
+    return segmentsOf<const T>(m_slots.data());
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, m_size); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, m_size); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+ private:
+  using Storage =
+      std::conditional_t<N == kDynamicCapacity, std::vector<T>,
+                         std::array<T, N == kDynamicCapacity ? 1 : N>>;
+
+  // No modulo: index is below 2 * capacity() wherever it is called
+  size_t wrap(size_t index) const {
+    return index >= capacity() ? index - capacity() : index;
+  }
+
+  template <typename V>
+  bool pushImpl(V&& value) {
+    if (full()) {
+      if (m_overflow == RingOverflow::Reject) {
+        return false;
+      }
+      // The oldest slot becomes the newest
+      m_slots[m_first] = std::forward<V>(value);
+      m_first = wrap(m_first + 1);
+      return true;
+    }
+    m_slots[wrap(m_first + m_size)] = std::forward<V>(value);
+    ++m_size;
+    return true;
+  }
+
+  template <typename U, typename Pointer>
+  RingSegments<U> segmentsOf(Pointer slots) const {
+    const size_t head = capacity() - m_first;
+    if (m_size <= head) {
+      return {{slots + m_first, m_size}, {}};
+    }
+    return {{slots + m_first, head}, {slots, m_size - head}};
+  }
+
+  void checkIndex(size_t i) const {
+    if (i >= m_size) {
+      throw std::out_of_range("RingBuffer index out of range");
+    }
+  }
+
+  Storage m_slots{};
+  size_t m_first = 0;  // slot of the oldest element
+  size_t m_size = 0;
+  RingOverflow m_overflow;
+};
+
+// ============================================================
+// Iterator
+// ============================================================
+
+// Position i from the oldest element; compares by position, so iterators
+// of different buffers must not be mixed
+template <typename T, size_t N>
+template <bool Const>
+class RingBuffer<T, N>::Iterator {
+  using Ring = std::conditional_t<Const, const RingBuffer, RingBuffer>;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = std::conditional_t<Const, const T*, T*>;
+  using reference = std::conditional_t<Const, const T&, T&>;
+
+  Iterator() = default;
+  Iterator(Ring* ring, size_t index) : m_ring(ring), m_index(index) {}
+  // iterator converts to const_iterator
+  template <bool C = Const, std::enable_if_t<C, int> = 0>
+  Iterator(const Iterator<false>& other)  // NOLINT(runtime/explicit)
+      : m_ring(other.m_ring), m_index(other.m_index) {}
+
+  reference operator*() const { return (*m_ring)[m_index]; }
+  pointer operator->() const { return &(*m_ring)[m_index]; }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  Iterator& operator++() {
+    ++m_index;
+    return *this;
+  }
+  Iterator operator++(int) {
+    Iterator previous = *this;
+    ++m_index;
+    return previous;
+  }
+  Iterator& operator--() {
+    --m_index;
+    return *this;
+  }
+  Iterator operator--(int) {
+    Iterator previous = *this;
+    --m_index;
+    return previous;
+  }
+  Iterator& operator+=(difference_type n) {
+    m_index = static_cast<size_t>(static_cast<difference_type>(m_index) + n);
+    return *this;
+  }
+  Iterator& operator-=(difference_type n) { return *this += -n; }
+
+  friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+  friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+  friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+  friend difference_type operator-(const Iterator& a, const Iterator& b) {
+    return static_cast<difference_type>(a.m_index) -
+           static_cast<difference_type>(b.m_index);
+  }
+
+  friend bool operator==(const Iterator& a, const Iterator& b) {
+    return a.m_index == b.m_index;
+  }
+  friend bool operator!=(const Iterator& a, const Iterator& b) {
+    return a.m_index != b.m_index;
+  }
+  friend bool operator<(const Iterator& a, const Iterator& b) {
+    return a.m_index < b.m_index;
+  }
+  friend bool operator>(const Iterator& a, const Iterator& b) {
+    return b < a;
+  }
+  friend bool operator<=(const Iterator& a, const Iterator& b) {
+    return !(b < a);
+  }
+  friend bool operator>=(const Iterator& a, const Iterator& b) {
+    return !(a < b);
+  }
+
+ private:
+  friend class Iterator<!Const>;
+
+  Ring* m_ring = nullptr;
+  size_t m_index = 0;
+};
+
+}  // namespace Containers
+
+#endif  // CONTAINERS_RING_BUFFER_H_
@@ -0,0 +1,248 @@
+#include "ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "alloc_counter.h"
+
+namespace Containers {
+namespace {
+
+// A compact record like the time-series points kept in windows
+struct Tick {
+  int64_t timestamp_ms = 0;
+  double value = 0.0;
+};
+
+template <typename Ring>
+std::vector<int> contents(const Ring& ring) {
+  return std::vector<int>(ring.begin(), ring.end());
+}
+
+template <typename Segment>
+std::vector<int> contents(const Segment& first, const Segment& second) {
+  std::vector<int> values(first.begin(), first.end());
+  values.insert(values.end(), second.begin(), second.end());
+  return values;
+}
+
+// ============================================================
+// Construction
+// ============================================================
+TEST(RingBufferTest, FixedCapacityIsInline) {
+  RingBuffer<Tick, 8> ring;
+
+  EXPECT_EQ(ring.capacity(), 8u);
+  EXPECT_TRUE(ring.empty());
+  EXPECT_FALSE(ring.full());
+  EXPECT_EQ(ring.overflow(), RingOverflow::Reject);
+  EXPECT_GE(sizeof(ring), 8 * sizeof(Tick));
+}
+
+TEST(RingBufferTest, RuntimeCapacity) {
+  RingBuffer<double> ring(5, RingOverflow::OverwriteOldest);
+
+  EXPECT_EQ(ring.capacity(), 5u);
+  EXPECT_EQ(ring.overflow(), RingOverflow::OverwriteOldest);
+  EXPECT_THROW(RingBuffer<double>(0), std::invalid_argument);
+}
+
+// ============================================================
+// Push and Pop
+// ============================================================
+TEST(RingBufferTest, FifoOrder) {
+  RingBuffer<int, 4> ring;
+  for (int i = 1; i <= 3; ++i) {
+    EXPECT_TRUE(ring.push(i));
+  }
+
+  EXPECT_EQ(ring.size(), 3u);
+  EXPECT_EQ(ring.front(), 1);
+  EXPECT_EQ(ring.back(), 3);
+  EXPECT_TRUE(ring.pop());
+  EXPECT_EQ(ring.front(), 2);
+  EXPECT_EQ(contents(ring), (std::vector<int>{2, 3}));
+}
+
+TEST(RingBufferTest, RejectWhenFull) {
+  RingBuffer<int, 3> ring;
+  ring.push(1);
+  ring.push(2);
+  ring.push(3);
+
+  EXPECT_TRUE(ring.full());
+  EXPECT_FALSE(ring.push(4));
+  EXPECT_EQ(contents(ring), (std::vector<int>{1, 2, 3}));
+}
+
+TEST(RingBufferTest, OverwriteOldestKeepsTheNewest) {
+  RingBuffer<int> ring(3, RingOverflow::OverwriteOldest);
+  for (int i = 1; i <= 7; ++i) {
+    EXPECT_TRUE(ring.push(i));
+  }
+
+  EXPECT_TRUE(ring.full());
+  EXPECT_EQ(ring.front(), 5);
+  EXPECT_EQ(ring.back(), 7);
+  EXPECT_EQ(contents(ring), (std::vector<int>{5, 6, 7}));
+}
+
+TEST(RingBufferTest, PopCountAndClear) {
+  RingBuffer<int, 5> ring;
+  for (int i = 0; i < 5; ++i) {
+    ring.push(i);
+  }
+
+  ring.pop(2);
+  EXPECT_EQ(contents(ring), (std::vector<int>{2, 3, 4}));
+  ring.pop(10);
+  EXPECT_TRUE(ring.empty());
+  EXPECT_FALSE(ring.pop());
+
+  ring.push(9);
+  ring.clear();
+  EXPECT_TRUE(ring.empty());
+  EXPECT_TRUE(ring.push(1));
+  EXPECT_EQ(ring.front(), 1);
+}
+
+TEST(RingBufferTest, MovesIntoSlots) {
+  RingBuffer<std::string> ring(2, RingOverflow::OverwriteOldest);
+  std::string long_text(100, 'x');
+
+  ring.push(std::move(long_text));
+  ring.push("b");
+  ring.push("c");
+
+  EXPECT_EQ(ring.front(), "b");
+  EXPECT_EQ(ring.back(), "c");
+}
+
+// ============================================================
+// Access
+// ============================================================
+TEST(RingBufferTest, IndexFromTheOldest) {
+  RingBuffer<int, 4> ring(RingOverflow::OverwriteOldest);
+  for (int i = 0; i < 6; ++i) {
+    ring.push(i);
+  }
+
+  EXPECT_EQ(ring[0], 2);
+  EXPECT_EQ(ring[3], 5);
+  ring[1] = 30;
+  EXPECT_EQ(ring.at(1), 30);
+  EXPECT_THROW(ring.at(4), std::out_of_range);
+}
+
+TEST(RingBufferTest, SegmentsSplitAtTheWrap) {
+  RingBuffer<int, 5> ring(RingOverflow::OverwriteOldest);
+  for (int i = 0; i < 3; ++i) {
+    ring.push(i);
+  }
+  auto segments = ring.segments();
+  EXPECT_EQ(segments.first.size(), 3u);
+  EXPECT_TRUE(segments.second.empty());
+
+  for (int i = 3; i < 8; ++i) {
+    ring.push(i);
+  }
+  // Slots 3 and 4, then 0 to 2
+  segments = ring.segments();
+  EXPECT_EQ(segments.first.size(), 2u);
+  EXPECT_EQ(segments.second.size(), 3u);
+  EXPECT_EQ(segments.second.data() + 3, segments.first.data());
+  EXPECT_EQ(contents(segments.first, segments.second),
+            (std::vector<int>{3, 4, 5, 6, 7}));
+
+  // Writable through the mutable view
+  segments.first[0] = 30;
+  EXPECT_EQ(ring.front(), 30);
+}
+
+TEST(RingBufferTest, ConstSegmentsAreReadOnly) {
+  RingBuffer<int> ring(2);
+  const auto& view = ring;
+
+  using Segment = decltype(view.segments().first);
+  EXPECT_TRUE((std::is_same_v<Segment, RingSegment<const int>>));
+  EXPECT_TRUE(view.segments().first.empty());
+  EXPECT_TRUE(view.segments().second.empty());
+}
+
+// ============================================================
+// Iterators
+// ============================================================
+TEST(RingBufferTest, IteratorsAreRandomAccess) {
+  RingBuffer<int> ring(4, RingOverflow::OverwriteOldest);
+  for (int i = 0; i < 6; ++i) {
+    ring.push(i);
+  }
+
+  using Category = std::iterator_traits<
+      RingBuffer<int>::const_iterator>::iterator_category;
+  EXPECT_TRUE(
+      (std::is_same_v<Category, std::random_access_iterator_tag>));
+
+  auto it = ring.begin();
+  EXPECT_EQ(ring.end() - it, 4);
+  EXPECT_EQ(it[1], 3);
+  EXPECT_EQ(*(it + 3), 5);
+  EXPECT_EQ(*(ring.end() - 1), 5);
+  EXPECT_TRUE(it < ring.end());
+  EXPECT_EQ(std::accumulate(ring.cbegin(), ring.cend(), 0), 2 + 3 + 4 + 5);
+  EXPECT_EQ(*std::max_element(ring.begin(), ring.end()), 5);
+
+  RingBuffer<int>::const_iterator converted = ring.begin();
+  EXPECT_EQ(*converted, 2);
+}
+
+TEST(RingBufferTest, IteratorsWriteThrough) {
+  RingBuffer<Tick, 3> ring(RingOverflow::OverwriteOldest);
+  for (int64_t t = 0; t < 5; ++t) {
+    ring.push({t, 1.0});
+  }
+
+  for (auto& tick : ring) {
+    tick.value *= 2;
+  }
+  std::reverse(ring.begin(), ring.end());
+
+  EXPECT_EQ(ring.front().timestamp_ms, 4);
+  EXPECT_EQ(ring.back().timestamp_ms, 2);
+  EXPECT_DOUBLE_EQ(ring[1].value, 2.0);
+}
+
+// ============================================================
+// Allocations
+// ============================================================
+TEST(RingBufferTest, PushesAllocateNothing) {
+  RingBuffer<Tick> ring(64, RingOverflow::OverwriteOldest);
+  RingBuffer<Tick, 64> fixed(RingOverflow::OverwriteOldest);
+
+  AllocCounter::AllocationScope scope;
+  double sum = 0.0;
+  for (int64_t t = 0; t < 10000; ++t) {
+    ring.push({t, static_cast<double>(t)});
+    fixed.push({t, static_cast<double>(t)});
+    if (t % 7 == 0) {
+      ring.pop();
+    }
+    for (const auto& tick : ring.segments().first) {
+      sum += tick.value;
+    }
+  }
+
+  EXPECT_GT(sum, 0.0);
+  EXPECT_TRUE(AllocCounter::withinBudget(scope.stats(), 10000, 0));
+}
+
+}  // namespace
+}  // namespace Containers
@@ -0,0 +1,131 @@
+// Batch Calculator overloads against a loop of scalar calls, the way
+// array code used Calculator before they existed. range(0) is the number
+// of elements.
+
+#include "calculator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Values in a small range, so no product overflows; every 97th divisor
+// is zero
+struct Inputs {
+    explicit Inputs(size_t count) {
+        uint32_t state = 12345;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 1664525u + 1013904223u;
+            a.push_back(static_cast<int>(state >> 20) - 2048);
+            b.push_back(i % 97 == 0 ? 0 : static_cast<int>(i % 1000) - 500);
+        }
+    }
+
+    std::vector<int> a;
+    std::vector<int> b;
+};
+
+// =============================================================================
+// Add
+// =============================================================================
+
+void BM_AddScalar(benchmark::State& state) {
+    my_project::Calculator calc;
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<int> out(in.a.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = calc.Add(in.a[i], in.b[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddScalar)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+void BM_AddBatch(benchmark::State& state) {
+    my_project::Calculator calc;
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<int> out(in.a.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.Add(in.a, in.b, out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddBatch)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+// =============================================================================
+// Multiply
+// =============================================================================
+
+void BM_MultiplyScalar(benchmark::State& state) {
+    my_project::Calculator calc;
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<int> out(in.a.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = calc.Multiply(in.a[i], in.b[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiplyScalar)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+void BM_MultiplyBatch(benchmark::State& state) {
+    my_project::Calculator calc;
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<int> out(in.a.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.Multiply(in.a, in.b, out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiplyBatch)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+// =============================================================================
+// Divide
+// =============================================================================
+
+// Catches the exception per zero divisor, as a scalar caller has to
+void BM_DivideScalar(benchmark::State& state) {
+    my_project::Calculator calc;
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<double> out(in.a.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            try {
+                out[i] = calc.Divide(in.a[i], in.b[i]);
+            } catch (const std::invalid_argument&) {
+                out[i] = 0.0;
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DivideScalar)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+void BM_DivideBatch(benchmark::State& state) {
+    my_project::Calculator calc;
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<double> out(in.a.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.Divide(in.a, in.b, out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DivideBatch)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -1,9 +1,43 @@
 #include "calculator.h"
 
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
 namespace my_project {
 
+namespace {
+
+void CheckSizes(size_t a, size_t b, size_t out) {
+    if (a != b || a != out) {
+        throw std::invalid_argument("Batch sizes differ");
+    }
+}
+
+// Wrapping arithmetic: unsigned overflow is defined, signed is not
+int WrappingAdd(int a, int b) {
+    const uint32_t result = static_cast<uint32_t>(a) + static_cast<uint32_t>(b);
+    return static_cast<int>(result);
+}
+
+int WrappingSubtract(int a, int b) {
+    const uint32_t result = static_cast<uint32_t>(a) - static_cast<uint32_t>(b);
+    return static_cast<int>(result);
+}
+
+int WrappingMultiply(int a, int b) {
+    const uint32_t result = static_cast<uint32_t>(a) * static_cast<uint32_t>(b);
+    return static_cast<int>(result);
+}
+
+// |a| as the 64-bit operand of a widening multiply
+uint64_t Magnitude(int a) {
+    const uint32_t mask = 0 - static_cast<uint32_t>(a < 0);
+    return (static_cast<uint32_t>(a) ^ mask) - mask;
+}
+
+}  // namespace
+
 int Calculator::Add(int a, int b) {
     return a + b;
 }
@@ -23,4 +57,89 @@ double Calculator::Divide(int a, int b) {
     return static_cast<double>(a) / b;
 }
 
+// The batch loops read both inputs before writing, so out may alias
+// them. GCC and Clang vectorize them at -O3. Overflow is OR-ed into one
+// flag word.
+
+BatchStatus Calculator::Add(Span<const int> a, Span<const int> b,
+                            Span<int> out) {
+    CheckSizes(a.size(), b.size(), out.size());
+    int overflow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const int x = a[i];
+        const int y = b[i];
+        const int sum = WrappingAdd(x, y);
+        // Operands of one sign and a result of the other
+        overflow |= (x ^ sum) & (y ^ sum);
+        out[i] = sum;
+    }
+    BatchStatus status;
+    status.overflow = overflow < 0;
+    return status;
+}
+
+BatchStatus Calculator::Subtract(Span<const int> a, Span<const int> b,
+                                 Span<int> out) {
+    CheckSizes(a.size(), b.size(), out.size());
+    int overflow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const int x = a[i];
+        const int y = b[i];
+        const int difference = WrappingSubtract(x, y);
+        // Operands of different signs and a result of the subtrahend's
+        overflow |= (x ^ y) & (x ^ difference);
+        out[i] = difference;
+    }
+    BatchStatus status;
+    status.overflow = overflow < 0;
+    return status;
+}
+
+BatchStatus Calculator::Multiply(Span<const int> a, Span<const int> b,
+                                 Span<int> out) {
+    CheckSizes(a.size(), b.size(), out.size());
+    uint64_t high = 0;
+    int sign = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const int x = a[i];
+        const int y = b[i];
+        const int product = WrappingMultiply(x, y);
+        // A 32x32->64 unsigned multiply of the magnitudes has a vector
+        // instruction from SSE2 on, the signed one does not. The product
+        // overflows if the magnitude needs more than 32 bits, or if it
+        // is the sign of the wrapped result that is wrong.
+        high |= Magnitude(x) * Magnitude(y) >> 32;
+        sign |= (product ^ x ^ y) & -static_cast<int>(product != 0);
+        out[i] = product;
+    }
+    BatchStatus status;
+    status.overflow = high != 0 || sign < 0;
+    return status;
+}
+
+BatchStatus Calculator::Divide(Span<const int> a, Span<const int> b,
+                               Span<double> out) {
+    CheckSizes(a.size(), b.size(), out.size());
+    constexpr uint64_t kNaNBits = 0x7ff8000000000000;  // quiet NaN exponent
+    size_t zeros = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const int divisor = b[i];
+        const uint64_t zero = divisor == 0;
+        // Divide by 1 where the divisor is 0, then OR the NaN bits into
+        // that lane. A select would keep the loop scalar, as the compiler
+        // may not pick between results of a division that can trap.
+        const double quotient =
+            static_cast<double>(a[i]) /
+            static_cast<double>(divisor + static_cast<int>(zero));
+        uint64_t bits;
+        std::memcpy(&bits, &quotient, sizeof(bits));
+        bits |= (0 - zero) & kNaNBits;
+        std::memcpy(&out[i], &bits, sizeof(bits));
+        zeros += zero;
+    }
+    BatchStatus status;
+    status.divide_by_zero = zeros;
+    return status;
+}
+
 }  // namespace my_project
@@ -5,32 +5,55 @@
 
 namespace my_project {
 
+namespace {
+
+// Flips the case bit of bytes in [first, first + 25]. A select and no
+// locale lookup, so GCC and Clang vectorize the loop from -O2.
+void FlipCase(std::string& input, char first) {
+    for (char& c : input) {
+        const unsigned char offset = static_cast<unsigned char>(c - first);
+        c = offset < 26 ? static_cast<char>(c ^ 0x20) : c;
+    }
+}
+
+bool IsSpace(unsigned char c) { return std::isspace(c); }
+
+}  // namespace
+
 std::string ToUpper(const std::string& input) {
     std::string result = input;
-    std::transform(result.begin(), result.end(), result.begin(),
-                   [](unsigned char c) { return std::toupper(c); });
+    ToUpperInPlace(result);
     return result;
 }
 
 std::string ToLower(const std::string& input) {
     std::string result = input;
-    std::transform(result.begin(), result.end(), result.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    ToLowerInPlace(result);
     return result;
 }
 
+void ToUpperInPlace(std::string& input) {
+    FlipCase(input, 'a');
+}
+
+void ToLowerInPlace(std::string& input) {
+    FlipCase(input, 'A');
+}
+
 std::string Trim(const std::string& input) {
-    auto start = std::find_if_not(input.begin(), input.end(),
-                                   [](unsigned char c) { return std::isspace(c); });
-    auto end = std::find_if_not(input.rbegin(), input.rend(),
-                                 [](unsigned char c) { return std::isspace(c); }).base();
+    return std::string(TrimView(input));
+}
+
+std::string_view TrimView(std::string_view input) {
+    auto start = std::find_if_not(input.begin(), input.end(), IsSpace);
+    auto end = std::find_if_not(input.rbegin(), input.rend(), IsSpace).base();
     
-    return (start < end) ? std::string(start, end) : std::string();
+    return (start < end) ? input.substr(start - input.begin(), end - start)
+                         : std::string_view();
 }
 
 bool IsBlank(const std::string& input) {
-    return std::all_of(input.begin(), input.end(),
-                       [](unsigned char c) { return std::isspace(c); });
+    return std::all_of(input.begin(), input.end(), IsSpace);
 }
 
 }  // namespace my_project
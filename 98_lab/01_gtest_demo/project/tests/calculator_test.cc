@@ -2,6 +2,11 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
 namespace my_project {
 namespace {
 
@@ -76,5 +81,145 @@ TEST_F(CalculatorTest, DivideByZeroThrows) {
     EXPECT_THROW(calc_.Divide(5, 0), std::invalid_argument);
 }
 
+// =============================================================================
+// Batch Tests
+// =============================================================================
+
+constexpr int kMax = std::numeric_limits<int>::max();
+constexpr int kMin = std::numeric_limits<int>::min();
+
+TEST_F(CalculatorTest, BatchMatchesScalar) {
+    // Long enough for a vector body and a scalar tail
+    std::vector<int> a;
+    std::vector<int> b;
+    for (int i = 0; i < 37; ++i) {
+        a.push_back(i * 7 - 100);
+        b.push_back(i % 5 == 0 ? -i - 1 : i + 1);
+    }
+    std::vector<int> sums(a.size());
+    std::vector<int> differences(a.size());
+    std::vector<int> products(a.size());
+    std::vector<double> quotients(a.size());
+
+    EXPECT_TRUE(calc_.Add(a, b, sums).ok());
+    EXPECT_TRUE(calc_.Subtract(a, b, differences).ok());
+    EXPECT_TRUE(calc_.Multiply(a, b, products).ok());
+    EXPECT_TRUE(calc_.Divide(a, b, quotients).ok());
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(sums[i], calc_.Add(a[i], b[i])) << i;
+        EXPECT_EQ(differences[i], calc_.Subtract(a[i], b[i])) << i;
+        EXPECT_EQ(products[i], calc_.Multiply(a[i], b[i])) << i;
+        EXPECT_DOUBLE_EQ(quotients[i], calc_.Divide(a[i], b[i])) << i;
+    }
+}
+
+TEST_F(CalculatorTest, BatchEmpty) {
+    std::vector<int> none;
+    std::vector<double> quotients;
+
+    EXPECT_TRUE(calc_.Add(none, none, none).ok());
+    EXPECT_TRUE(calc_.Divide(none, none, quotients).ok());
+}
+
+TEST_F(CalculatorTest, BatchAddOverflowSetsFlag) {
+    std::vector<int> a = {1, kMax, 2, kMin};
+    std::vector<int> b = {1, 1, 2, 0};
+    std::vector<int> out(a.size());
+
+    BatchStatus status = calc_.Add(a, b, out);
+    EXPECT_TRUE(status.overflow);
+    EXPECT_EQ(status.divide_by_zero, 0u);
+    EXPECT_EQ(out[1], kMin);  // wrapped
+    EXPECT_EQ(out[2], 4);
+
+    a = {kMin, 5};
+    b = {-1, -5};
+    out.resize(2);
+    EXPECT_TRUE(calc_.Add(a, b, out).overflow);
+}
+
+TEST_F(CalculatorTest, BatchSubtractOverflowSetsFlag) {
+    std::vector<int> a = {0, kMin, -1};
+    std::vector<int> b = {1, 1, kMax};
+    std::vector<int> out(a.size());
+
+    EXPECT_TRUE(calc_.Subtract(a, b, out).overflow);
+    EXPECT_EQ(out[1], kMax);  // wrapped
+    EXPECT_EQ(out[2], kMin);  // exactly representable
+
+    a = {0};
+    b = {kMin};
+    out.resize(1);
+    EXPECT_TRUE(calc_.Subtract(a, b, out).overflow);
+}
+
+TEST_F(CalculatorTest, BatchMultiplyOverflowSetsFlag) {
+    std::vector<int> a = {65536, -65536, kMin};
+    std::vector<int> b = {32767, 32768, 1};
+    std::vector<int> out(a.size());
+
+    // Both limits exactly, without overflow
+    EXPECT_FALSE(calc_.Multiply(a, b, out).overflow);
+    EXPECT_EQ(out[1], kMin);
+
+    a = {3, 65536};
+    b = {4, 32768};
+    out.resize(2);
+    EXPECT_TRUE(calc_.Multiply(a, b, out).overflow);
+    EXPECT_EQ(out[0], 12);
+
+    a = {kMin};
+    b = {-1};
+    out.resize(1);
+    EXPECT_TRUE(calc_.Multiply(a, b, out).overflow);
+}
+
+TEST_F(CalculatorTest, BatchDivideByZeroMasksToNaN) {
+    std::vector<int> a = {10, 7, -3, 0, 9};
+    std::vector<int> b = {2, 0, 0, 0, -3};
+    std::vector<double> out(a.size());
+
+    BatchStatus status = calc_.Divide(a, b, out);
+    EXPECT_FALSE(status.overflow);
+    EXPECT_EQ(status.divide_by_zero, 3u);
+    EXPECT_FALSE(status.ok());
+    EXPECT_DOUBLE_EQ(out[0], 5.0);
+    EXPECT_TRUE(std::isnan(out[1]));
+    EXPECT_TRUE(std::isnan(out[2]));
+    EXPECT_TRUE(std::isnan(out[3]));
+    EXPECT_DOUBLE_EQ(out[4], -3.0);
+}
+
+TEST_F(CalculatorTest, BatchInPlace) {
+    std::vector<int> values = {1, 2, 3};
+    std::vector<int> step = {10, 20, 30};
+
+    EXPECT_TRUE(calc_.Add(values, step, values).ok());
+    EXPECT_EQ(values, (std::vector<int>{11, 22, 33}));
+    EXPECT_TRUE(calc_.Multiply(values, values, values).ok());
+    EXPECT_EQ(values, (std::vector<int>{121, 484, 1089}));
+}
+
+TEST_F(CalculatorTest, BatchSizeMismatchThrows) {
+    std::vector<int> a = {1, 2, 3};
+    std::vector<int> b = {1, 2};
+    std::vector<int> out(3);
+    std::vector<double> quotients(3);
+
+    EXPECT_THROW(calc_.Add(a, b, out), std::invalid_argument);
+    EXPECT_THROW(calc_.Multiply(a, a, b), std::invalid_argument);
+    EXPECT_THROW(calc_.Divide(b, b, quotients), std::invalid_argument);
+}
+
+TEST_F(CalculatorTest, BatchFromPointerAndSize) {
+    const int a[] = {4, 9};
+    const int b[] = {2, 3};
+    double out[2];
+
+    EXPECT_TRUE(calc_.Divide(Span<const int>(a, 2), Span<const int>(b, 2),
+                             Span<double>(out, 2)).ok());
+    EXPECT_DOUBLE_EQ(out[1], 3.0);
+}
+
 }  // namespace
 }  // namespace my_project
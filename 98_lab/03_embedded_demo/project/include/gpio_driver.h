@@ -6,6 +6,11 @@
  * 
  * This module provides a basic GPIO interface for controlling
  * digital pins on embedded microcontrollers.
+ *
+ * Besides the per-pin calls there are port-wide calls that take a
+ * 16-bit pin mask and map to single register accesses, for driving a
+ * parallel bus a word at a time, and pin handles that are validated
+ * once so hot loops skip the checks.
  */
 
 #ifndef GPIO_DRIVER_H
@@ -30,6 +35,11 @@ typedef enum {
     GPIO_OUTPUT = 1  /**< Pin configured as output */
 } gpio_direction_t;
 
+/**
+ * @brief Mask of pins within a port, bit n for pin n
+ */
+typedef uint16_t gpio_mask_t;
+
 /**
  * @brief GPIO pin configuration structure
  */
@@ -114,4 +124,134 @@ int gpio_read(uint8_t port, uint8_t pin, gpio_state_t *state);
  */
 int gpio_toggle(uint8_t port, uint8_t pin);
 
+/**
+ * @brief Write several pins of a port at once
+ *
+ * Sets the pins in mask to the matching bits of values in one write to
+ * the port's set/reset register; pins outside mask are unchanged. Every
+ * pin in mask must be an initialized output, or nothing is written.
+ *
+ * @param port GPIO port number (0-15)
+ * @param mask Pins to write
+ * @param values New levels, bit n for pin n
+ * @return 0 on success, -1 on error
+ *
+ * @code
+ * // Put a byte on pins 0-7 of port 1
+ * gpio_write_port(1, 0x00FF, byte);
+ * @endcode
+ */
+int gpio_write_port(uint8_t port, gpio_mask_t mask, gpio_mask_t values);
+
+/**
+ * @brief Read all pins of a port at once
+ *
+ * Outputs read back what was written, inputs read the input register,
+ * as in gpio_read(). Pins not initialized read as 0.
+ *
+ * @param port GPIO port number (0-15)
+ * @param values Pointer to store the levels, bit n for pin n
+ * @return 0 on success, -1 on error
+ *
+ * @pre values must not be NULL
+ */
+int gpio_read_port(uint8_t port, gpio_mask_t *values);
+
+/**
+ * @brief Drive the pins in mask high
+ *
+ * One write to the set half of the port's set/reset register, so it
+ * cannot race with other pins of the port being changed elsewhere.
+ *
+ * @param port GPIO port number (0-15)
+ * @param mask Pins to set; each must be an initialized output
+ * @return 0 on success, -1 on error
+ */
+int gpio_set_port(uint8_t port, gpio_mask_t mask);
+
+/**
+ * @brief Drive the pins in mask low
+ *
+ * @param port GPIO port number (0-15)
+ * @param mask Pins to clear; each must be an initialized output
+ * @return 0 on success, -1 on error
+ */
+int gpio_clear_port(uint8_t port, gpio_mask_t mask);
+
+/**
+ * @brief Invert the pins in mask
+ *
+ * One write to the port's toggle register.
+ *
+ * @param port GPIO port number (0-15)
+ * @param mask Pins to toggle; each must be an initialized output
+ * @return 0 on success, -1 on error
+ */
+int gpio_toggle_port(uint8_t port, gpio_mask_t mask);
+
+/**
+ * @brief Precomputed pin for hot loops
+ *
+ * Filled by gpio_pin_handle(). Treat as opaque.
+ */
+typedef struct {
+    uint8_t port;       /**< GPIO port number */
+    gpio_mask_t mask;   /**< Single-bit mask of the pin */
+} gpio_pin_t;
+
+/**
+ * @brief Validate a pin once and get a handle to it
+ *
+ * The gpio_pin_*() calls on the handle do no checks, so they cost one
+ * register access each. The pin must stay configured as it was: a
+ * handle does not notice a later gpio_init() of the same pin.
+ *
+ * @param port GPIO port number (0-15)
+ * @param pin Pin number within port (0-15)
+ * @param handle Pointer to the handle to fill
+ * @return 0 on success, -1 on error
+ *
+ * @pre handle must not be NULL
+ * @pre Pin must be initialized
+ *
+ * @code
+ * gpio_pin_t clock;
+ * gpio_pin_handle(0, 5, &clock);
+ * for (int i = 0; i < 8; i++) {
+ *     gpio_pin_set(clock);
+ *     gpio_pin_clear(clock);
+ * }
+ * @endcode
+ */
+int gpio_pin_handle(uint8_t port, uint8_t pin, gpio_pin_t *handle);
+
+/**
+ * @brief Drive a pin high without validation
+ *
+ * @param handle Handle of an output pin from gpio_pin_handle()
+ */
+void gpio_pin_set(gpio_pin_t handle);
+
+/**
+ * @brief Drive a pin low without validation
+ *
+ * @param handle Handle of an output pin from gpio_pin_handle()
+ */
+void gpio_pin_clear(gpio_pin_t handle);
+
+/**
+ * @brief Invert a pin without validation
+ *
+ * @param handle Handle of an output pin from gpio_pin_handle()
+ */
+void gpio_pin_toggle(gpio_pin_t handle);
+
+/**
+ * @brief Read a pin without validation
+ *
+ * @param handle Handle from gpio_pin_handle()
+ * @return Current pin state, as gpio_read() would return it
+ */
+gpio_state_t gpio_pin_read(gpio_pin_t handle);
+
 #endif /* GPIO_DRIVER_H */
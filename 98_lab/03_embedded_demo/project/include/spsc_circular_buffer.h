@@ -0,0 +1,223 @@
+/**
+ * @file spsc_circular_buffer.h
+ * @brief Lock-free single-producer/single-consumer circular buffer
+ * @author Embedded Team
+ * @date 2026-10-14
+ *
+ * Byte FIFO for one writer and one reader running concurrently, such as
+ * a UART or SPI interrupt handler feeding the main loop, or a DMA
+ * engine filling a region the application later drains. No locks and no
+ * interrupt masking: each side owns one index and publishes it with
+ * release ordering.
+ *
+ * Differences from circular_buffer_t:
+ * - capacity must be a power of two; indices wrap with a mask
+ * - head and tail are free-running counters on separate cache lines,
+ *   so neither side writes a field the other one writes
+ * - bulk put/get move a whole block with at most two memcpy calls
+ * - reserve/commit hand out contiguous regions for zero-copy DMA
+ *
+ * Producer functions (put, put_bulk, write_reserve, write_commit) may
+ * only be called from one context at a time, as may consumer functions
+ * (get, get_bulk, read_reserve, read_commit). Size queries may be
+ * called from either side; from the other side they are a snapshot.
+ */
+
+#ifndef SPSC_CIRCULAR_BUFFER_H
+#define SPSC_CIRCULAR_BUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+ * @brief Cache line size the indices are padded to
+ *
+ * 64 bytes suits most application cores; override for parts with other
+ * line sizes. On cores without a data cache it only costs RAM.
+ */
+#ifndef SPSC_CACHE_LINE_SIZE
+#define SPSC_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * @brief SPSC circular buffer structure
+ *
+ * Internal structure for managing buffer state.
+ * Users should not access fields directly.
+ */
+typedef struct {
+    /* Shared, read-only after init */
+    _Alignas(SPSC_CACHE_LINE_SIZE) uint8_t *buffer; /**< Data storage */
+    size_t capacity;            /**< Bytes, a power of two */
+    size_t mask;                /**< capacity - 1 */
+
+    /* Producer side */
+    _Alignas(SPSC_CACHE_LINE_SIZE) atomic_size_t head; /**< Bytes written */
+    size_t cached_tail;         /**< Producer's last view of tail */
+
+    /* Consumer side */
+    _Alignas(SPSC_CACHE_LINE_SIZE) atomic_size_t tail; /**< Bytes read */
+    size_t cached_head;         /**< Consumer's last view of head */
+} spsc_circular_buffer_t;
+
+/**
+ * @brief Initialize an SPSC circular buffer
+ *
+ * The storage must remain valid for the lifetime of the buffer. Must not
+ * race with any other call on the same buffer.
+ *
+ * @param cb Pointer to buffer structure
+ * @param buffer Pointer to data storage array
+ * @param capacity Size of the data storage array, a power of two
+ * @return 0 on success, -1 on error
+ *
+ * @pre cb must not be NULL
+ * @pre buffer must not be NULL
+ * @pre capacity must be a power of two
+ *
+ * @code
+ * static uint8_t storage[1024];
+ * static spsc_circular_buffer_t uart_rx;
+ * spsc_circular_buffer_init(&uart_rx, storage, sizeof(storage));
+ * @endcode
+ */
+int spsc_circular_buffer_init(spsc_circular_buffer_t *cb, uint8_t *buffer,
+                              size_t capacity);
+
+/**
+ * @brief Write a byte (producer)
+ *
+ * @param cb Pointer to buffer
+ * @param data Byte to write
+ * @return 0 on success, -1 if the buffer is full
+ */
+int spsc_circular_buffer_put(spsc_circular_buffer_t *cb, uint8_t data);
+
+/**
+ * @brief Read a byte (consumer)
+ *
+ * @param cb Pointer to buffer
+ * @param data Pointer to store the read byte
+ * @return 0 on success, -1 if the buffer is empty
+ *
+ * @pre data must not be NULL
+ */
+int spsc_circular_buffer_get(spsc_circular_buffer_t *cb, uint8_t *data);
+
+/**
+ * @brief Write up to len bytes (producer)
+ *
+ * Copies as many bytes as fit, with at most two memcpy calls, and
+ * publishes them at once.
+ *
+ * @param cb Pointer to buffer
+ * @param data Bytes to write
+ * @param len Number of bytes to write
+ * @return Number of bytes written, 0 if full or on error
+ */
+size_t spsc_circular_buffer_put_bulk(spsc_circular_buffer_t *cb,
+                                     const uint8_t *data, size_t len);
+
+/**
+ * @brief Read up to len bytes (consumer)
+ *
+ * Copies as many bytes as are stored, with at most two memcpy calls,
+ * and frees them at once.
+ *
+ * @param cb Pointer to buffer
+ * @param data Destination for the bytes
+ * @param len Maximum number of bytes to read
+ * @return Number of bytes read, 0 if empty or on error
+ */
+size_t spsc_circular_buffer_get_bulk(spsc_circular_buffer_t *cb,
+                                     uint8_t *data, size_t len);
+
+/**
+ * @brief Reserve a contiguous free region for writing (producer)
+ *
+ * The region ends at the next wrap or at the oldest unread byte. Write
+ * into it, e.g. by pointing a DMA transfer at it, then publish the
+ * bytes written with spsc_circular_buffer_write_commit(). Nothing is
+ * visible to the consumer before the commit.
+ *
+ * @param cb Pointer to buffer
+ * @param region Set to the start of the region, NULL if it is empty
+ * @return Length of the region in bytes, 0 if full or on error
+ *
+ * @code
+ * uint8_t *region;
+ * size_t len = spsc_circular_buffer_write_reserve(&uart_rx, &region);
+ * dma_start(region, len);
+ * ...
+ * spsc_circular_buffer_write_commit(&uart_rx, dma_transferred());
+ * @endcode
+ */
+size_t spsc_circular_buffer_write_reserve(spsc_circular_buffer_t *cb,
+                                          uint8_t **region);
+
+/**
+ * @brief Publish bytes written into a reserved region (producer)
+ *
+ * @param cb Pointer to buffer
+ * @param len Bytes written, at most the reserved length
+ * @return 0 on success, -1 if len exceeds the free space
+ */
+int spsc_circular_buffer_write_commit(spsc_circular_buffer_t *cb, size_t len);
+
+/**
+ * @brief Get the contiguous stored region for reading (consumer)
+ *
+ * The region ends at the next wrap or at the newest byte; the bytes
+ * stay in the buffer until spsc_circular_buffer_read_commit().
+ *
+ * @param cb Pointer to buffer
+ * @param region Set to the start of the region, NULL if it is empty
+ * @return Length of the region in bytes, 0 if empty or on error
+ */
+size_t spsc_circular_buffer_read_reserve(spsc_circular_buffer_t *cb,
+                                         const uint8_t **region);
+
+/**
+ * @brief Free bytes read from a reserved region (consumer)
+ *
+ * @param cb Pointer to buffer
+ * @param len Bytes consumed, at most the stored length
+ * @return 0 on success, -1 if len exceeds the stored bytes
+ */
+int spsc_circular_buffer_read_commit(spsc_circular_buffer_t *cb, size_t len);
+
+/**
+ * @brief Get number of bytes in buffer
+ *
+ * @param cb Pointer to buffer
+ * @return Number of bytes currently stored
+ */
+size_t spsc_circular_buffer_size(const spsc_circular_buffer_t *cb);
+
+/**
+ * @brief Get available space in buffer
+ *
+ * @param cb Pointer to buffer
+ * @return Number of free bytes
+ */
+size_t spsc_circular_buffer_available(const spsc_circular_buffer_t *cb);
+
+/**
+ * @brief Check if buffer is empty
+ *
+ * @param cb Pointer to buffer
+ * @return true if buffer is empty, false otherwise
+ */
+bool spsc_circular_buffer_is_empty(const spsc_circular_buffer_t *cb);
+
+/**
+ * @brief Check if buffer is full
+ *
+ * @param cb Pointer to buffer
+ * @return true if buffer is full, false otherwise
+ */
+bool spsc_circular_buffer_is_full(const spsc_circular_buffer_t *cb);
+
+#endif /* SPSC_CIRCULAR_BUFFER_H */
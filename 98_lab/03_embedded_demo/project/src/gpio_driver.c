@@ -16,12 +16,49 @@ typedef struct {
     uint16_t output;     /* Output data register */
     uint16_t input;      /* Input data register (simulated) */
     uint16_t pullup;     /* Pull-up enable register */
-    bool initialized[MAX_PINS];  /* Track initialization per pin */
+    uint16_t initialized;  /* Track initialization, bit per pin */
 } gpio_port_regs_t;
 
 /* Simulated hardware registers */
 static gpio_port_regs_t gpio_ports[MAX_PORTS];
 
+/* Register accesses. On hardware each is a single load or store: the
+   set/reset register takes pins to drive high in its low half and pins
+   to drive low in its high half, and the toggle register inverts the
+   pins written to it, so neither needs a read-modify-write. */
+static void port_write_set_reset(gpio_port_regs_t *regs, uint32_t set_reset) {
+    uint16_t reset = (uint16_t)(set_reset >> 16);
+    uint16_t set = (uint16_t)set_reset;
+
+    regs->output = (uint16_t)((regs->output & ~reset) | set);
+}
+
+static void port_write_toggle(gpio_port_regs_t *regs, uint16_t mask) {
+    regs->output ^= mask;
+}
+
+/* Outputs read back the output register, inputs the input register */
+static uint16_t port_read_levels(const gpio_port_regs_t *regs) {
+    return (uint16_t)((regs->output & regs->direction) |
+                      (regs->input & ~regs->direction));
+}
+
+/* The port's registers if every pin in mask is an initialized output,
+   NULL otherwise */
+static gpio_port_regs_t *output_port(uint8_t port, uint16_t mask) {
+    if (port >= MAX_PORTS) {
+        return NULL;
+    }
+
+    gpio_port_regs_t *port_regs = &gpio_ports[port];
+    uint16_t outputs = port_regs->initialized & port_regs->direction;
+    if ((mask & outputs) != mask) {
+        return NULL;
+    }
+
+    return port_regs;
+}
+
 int gpio_init(const gpio_config_t *config) {
     /* Validate parameters */
     if (config == NULL) {
@@ -59,36 +96,30 @@ int gpio_init(const gpio_config_t *config) {
     }
     
     /* Mark pin as initialized */
-    port_regs->initialized[config->pin] = true;
+    port_regs->initialized |= pin_mask;
     
     return 0;
 }
 
 int gpio_write(uint8_t port, uint8_t pin, gpio_state_t state) {
     /* Validate parameters */
-    if (port >= MAX_PORTS || pin >= MAX_PINS) {
-        return -1;
-    }
-    
-    gpio_port_regs_t *port_regs = &gpio_ports[port];
-    
-    /* Check if pin is initialized */
-    if (!port_regs->initialized[pin]) {
+    if (pin >= MAX_PINS) {
         return -1;
     }
     
     uint16_t pin_mask = (1 << pin);
     
-    /* Check if pin is configured as output */
-    if (!(port_regs->direction & pin_mask)) {
-        return -1;  /* Pin is input */
+    /* Pin must be initialized as output */
+    gpio_port_regs_t *port_regs = output_port(port, pin_mask);
+    if (port_regs == NULL) {
+        return -1;
     }
     
     /* Write the state */
     if (state == GPIO_HIGH) {
-        port_regs->output |= pin_mask;
+        port_write_set_reset(port_regs, pin_mask);
     } else {
-        port_regs->output &= ~pin_mask;
+        port_write_set_reset(port_regs, (uint32_t)pin_mask << 16);
     }
     
     return 0;
@@ -102,37 +133,120 @@ int gpio_read(uint8_t port, uint8_t pin, gpio_state_t *state) {
     
     gpio_port_regs_t *port_regs = &gpio_ports[port];
     
+    uint16_t pin_mask = (1 << pin);
+    
     /* Check if pin is initialized */
-    if (!port_regs->initialized[pin]) {
+    if (!(port_regs->initialized & pin_mask)) {
         return -1;
     }
     
-    uint16_t pin_mask = (1 << pin);
-    uint16_t reg_value;
+    *state = (port_read_levels(port_regs) & pin_mask) ? GPIO_HIGH : GPIO_LOW;
     
-    /* Read from input register for inputs, output register for outputs */
-    if (port_regs->direction & pin_mask) {
-        reg_value = port_regs->output;  /* Output pin - read back what was written */
-    } else {
-        reg_value = port_regs->input;   /* Input pin - read input register */
+    return 0;
+}
+
+int gpio_toggle(uint8_t port, uint8_t pin) {
+    /* Validate parameters */
+    if (pin >= MAX_PINS) {
+        return -1;
     }
     
-    *state = (reg_value & pin_mask) ? GPIO_HIGH : GPIO_LOW;
+    return gpio_toggle_port(port, (uint16_t)(1 << pin));
+}
+
+int gpio_write_port(uint8_t port, gpio_mask_t mask, gpio_mask_t values) {
+    gpio_port_regs_t *port_regs = output_port(port, mask);
+    if (port_regs == NULL) {
+        return -1;
+    }
+    
+    /* Ones in mask are set, zeros in mask reset, in one write */
+    uint16_t set = values & mask;
+    uint16_t reset = (uint16_t)(~values & mask);
+    port_write_set_reset(port_regs, ((uint32_t)reset << 16) | set);
     
     return 0;
 }
 
-int gpio_toggle(uint8_t port, uint8_t pin) {
-    gpio_state_t current_state;
+int gpio_read_port(uint8_t port, gpio_mask_t *values) {
+    if (port >= MAX_PORTS || values == NULL) {
+        return -1;
+    }
+    
+    gpio_port_regs_t *port_regs = &gpio_ports[port];
+    *values = port_read_levels(port_regs) & port_regs->initialized;
     
-    /* Read current state */
-    if (gpio_read(port, pin, &current_state) != 0) {
+    return 0;
+}
+
+int gpio_set_port(uint8_t port, gpio_mask_t mask) {
+    gpio_port_regs_t *port_regs = output_port(port, mask);
+    if (port_regs == NULL) {
         return -1;
     }
     
-    /* Write opposite state */
-    gpio_state_t new_state = (current_state == GPIO_HIGH) ? GPIO_LOW : GPIO_HIGH;
-    return gpio_write(port, pin, new_state);
+    port_write_set_reset(port_regs, mask);
+    
+    return 0;
+}
+
+int gpio_clear_port(uint8_t port, gpio_mask_t mask) {
+    gpio_port_regs_t *port_regs = output_port(port, mask);
+    if (port_regs == NULL) {
+        return -1;
+    }
+    
+    port_write_set_reset(port_regs, (uint32_t)mask << 16);
+    
+    return 0;
+}
+
+int gpio_toggle_port(uint8_t port, gpio_mask_t mask) {
+    gpio_port_regs_t *port_regs = output_port(port, mask);
+    if (port_regs == NULL) {
+        return -1;
+    }
+    
+    port_write_toggle(port_regs, mask);
+    
+    return 0;
+}
+
+int gpio_pin_handle(uint8_t port, uint8_t pin, gpio_pin_t *handle) {
+    /* Validate parameters */
+    if (port >= MAX_PORTS || pin >= MAX_PINS || handle == NULL) {
+        return -1;
+    }
+    
+    uint16_t pin_mask = (1 << pin);
+    
+    /* Check if pin is initialized */
+    if (!(gpio_ports[port].initialized & pin_mask)) {
+        return -1;
+    }
+    
+    handle->port = port;
+    handle->mask = pin_mask;
+    
+    return 0;
+}
+
+/* Handle calls: validated by gpio_pin_handle(), one access each */
+void gpio_pin_set(gpio_pin_t handle) {
+    port_write_set_reset(&gpio_ports[handle.port], handle.mask);
+}
+
+void gpio_pin_clear(gpio_pin_t handle) {
+    port_write_set_reset(&gpio_ports[handle.port], (uint32_t)handle.mask << 16);
+}
+
+void gpio_pin_toggle(gpio_pin_t handle) {
+    port_write_toggle(&gpio_ports[handle.port], handle.mask);
+}
+
+gpio_state_t gpio_pin_read(gpio_pin_t handle) {
+    return (port_read_levels(&gpio_ports[handle.port]) & handle.mask)
+               ? GPIO_HIGH : GPIO_LOW;
 }
 
 /* Test helper function - simulates external input change */
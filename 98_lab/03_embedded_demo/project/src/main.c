@@ -5,12 +5,15 @@
  * This simple application demonstrates:
  * - GPIO pin initialization and control
  * - Circular buffer for data storage
+ * - Lock-free SPSC buffer with bulk and DMA-style transfers
  * - Integration of multiple modules
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "gpio_driver.h"
 #include "circular_buffer.h"
+#include "spsc_circular_buffer.h"
 
 /* External test helper for simulating inputs */
 extern void gpio_simulate_input(uint8_t port, uint8_t pin, gpio_state_t state);
@@ -73,6 +76,34 @@ int main(void) {
     printf("  After simulated press: %s\n\n", 
            button_state == GPIO_HIGH ? "HIGH" : "LOW");
     
+    /* ===== Port-wide GPIO Demo ===== */
+    printf("--- Port-wide GPIO Demo ---\n");
+    
+    /* Pins 0-7 of port 2 as an 8-bit parallel bus */
+    for (uint8_t pin = 0; pin < 8; pin++) {
+        gpio_config_t bus_config = {
+            .port = 2,
+            .pin = pin,
+            .dir = GPIO_OUTPUT,
+            .pull_up = false
+        };
+        gpio_init(&bus_config);
+    }
+    
+    gpio_mask_t bus_value;
+    gpio_write_port(2, 0x00FF, 0x5A);
+    gpio_read_port(2, &bus_value);
+    printf("  Bus written in one call: 0x%02X\n", bus_value);
+    
+    /* Strobe pin 7 through a handle: no validation per call */
+    gpio_pin_t strobe;
+    gpio_pin_handle(2, 7, &strobe);
+    for (int i = 0; i < 3; i++) {
+        gpio_pin_toggle(strobe);
+    }
+    gpio_read_port(2, &bus_value);
+    printf("  After 3 strobe toggles: 0x%02X\n\n", bus_value);
+    
     /* ===== Circular Buffer Demo ===== */
     printf("--- Circular Buffer Demo ---\n");
     
@@ -140,6 +171,40 @@ int main(void) {
     }
     printf("\n");
     
+    /* ===== SPSC Buffer Demo ===== */
+    printf("\n--- SPSC Buffer Demo ---\n");
+
+    static uint8_t dma_storage[16];
+    static spsc_circular_buffer_t dma_rx_buffer;
+
+    if (spsc_circular_buffer_init(&dma_rx_buffer, dma_storage, sizeof(dma_storage)) == 0) {
+        printf("✓ DMA RX buffer initialized (16 bytes, lock-free)\n");
+    }
+
+    /* Bulk write, then read part of it back to move the tail */
+    const uint8_t frame[] = "0123456789";
+    uint8_t chunk[16];
+    size_t written = spsc_circular_buffer_put_bulk(&dma_rx_buffer, frame, 10);
+    size_t read = spsc_circular_buffer_get_bulk(&dma_rx_buffer, chunk, 8);
+    printf("  Bulk put %zu bytes, bulk get %zu bytes\n", written, read);
+
+    /* Simulate a DMA transfer into the reserved region */
+    uint8_t *region;
+    size_t region_len = spsc_circular_buffer_write_reserve(&dma_rx_buffer, &region);
+    printf("  Reserved %zu contiguous bytes up to the wrap\n", region_len);
+    memset(region, 'D', region_len);
+    spsc_circular_buffer_write_commit(&dma_rx_buffer, region_len);
+
+    /* Drain in place, one contiguous region at a time */
+    printf("  Draining in place: \"");
+    const uint8_t *stored;
+    size_t stored_len;
+    while ((stored_len = spsc_circular_buffer_read_reserve(&dma_rx_buffer, &stored)) > 0) {
+        printf("%.*s", (int)stored_len, (const char *)stored);
+        spsc_circular_buffer_read_commit(&dma_rx_buffer, stored_len);
+    }
+    printf("\"\n");
+
     printf("\n========================================\n");
     printf("  Demo Complete!\n");
     printf("========================================\n");
@@ -0,0 +1,276 @@
+/**
+ * @file spsc_circular_buffer.c
+ * @brief Lock-free SPSC circular buffer implementation
+ *
+ * head and tail count bytes written and read since init and wrap only
+ * through size_t overflow, so head - tail is always the stored byte
+ * count and a full buffer needs no sacrificed slot. Each side loads the
+ * other side's index with acquire, which makes the bytes behind it
+ * visible, and stores its own with release after touching the data.
+ * The other side's index is cached and only reloaded when the cached
+ * value says there is no room, which keeps the shared cache line quiet.
+ */
+
+#include "spsc_circular_buffer.h"
+#include <string.h>
+
+/* Free bytes for the producer, reloading tail only when needed */
+static size_t producer_free(spsc_circular_buffer_t *cb, size_t head,
+                            size_t wanted) {
+    size_t free_bytes = cb->capacity - (head - cb->cached_tail);
+
+    if (free_bytes < wanted) {
+        cb->cached_tail = atomic_load_explicit(&cb->tail,
+                                               memory_order_acquire);
+        free_bytes = cb->capacity - (head - cb->cached_tail);
+    }
+
+    return free_bytes;
+}
+
+/* Stored bytes for the consumer, reloading head only when needed */
+static size_t consumer_stored(spsc_circular_buffer_t *cb, size_t tail,
+                              size_t wanted) {
+    size_t stored = cb->cached_head - tail;
+
+    if (stored < wanted) {
+        cb->cached_head = atomic_load_explicit(&cb->head,
+                                               memory_order_acquire);
+        stored = cb->cached_head - tail;
+    }
+
+    return stored;
+}
+
+int spsc_circular_buffer_init(spsc_circular_buffer_t *cb, uint8_t *buffer,
+                              size_t capacity) {
+    if (cb == NULL || buffer == NULL) {
+        return -1;
+    }
+
+    /* Power of two, so an index wraps with a mask */
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+
+    cb->buffer = buffer;
+    cb->capacity = capacity;
+    cb->mask = capacity - 1;
+    atomic_init(&cb->head, 0);
+    atomic_init(&cb->tail, 0);
+    cb->cached_tail = 0;
+    cb->cached_head = 0;
+
+    return 0;
+}
+
+int spsc_circular_buffer_put(spsc_circular_buffer_t *cb, uint8_t data) {
+    if (cb == NULL) {
+        return -1;
+    }
+
+    size_t head = atomic_load_explicit(&cb->head, memory_order_relaxed);
+    if (producer_free(cb, head, 1) == 0) {
+        return -1;
+    }
+
+    cb->buffer[head & cb->mask] = data;
+
+    /* Publish the byte */
+    atomic_store_explicit(&cb->head, head + 1, memory_order_release);
+
+    return 0;
+}
+
+int spsc_circular_buffer_get(spsc_circular_buffer_t *cb, uint8_t *data) {
+    if (cb == NULL || data == NULL) {
+        return -1;
+    }
+
+    size_t tail = atomic_load_explicit(&cb->tail, memory_order_relaxed);
+    if (consumer_stored(cb, tail, 1) == 0) {
+        return -1;
+    }
+
+    *data = cb->buffer[tail & cb->mask];
+
+    /* Hand the slot back to the producer */
+    atomic_store_explicit(&cb->tail, tail + 1, memory_order_release);
+
+    return 0;
+}
+
+size_t spsc_circular_buffer_put_bulk(spsc_circular_buffer_t *cb,
+                                     const uint8_t *data, size_t len) {
+    if (cb == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+
+    size_t head = atomic_load_explicit(&cb->head, memory_order_relaxed);
+    size_t free_bytes = producer_free(cb, head, len);
+    size_t count = len < free_bytes ? len : free_bytes;
+    if (count == 0) {
+        return 0;
+    }
+
+    /* Up to the end of the storage, then the rest from the start */
+    size_t offset = head & cb->mask;
+    size_t first = cb->capacity - offset;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(cb->buffer + offset, data, first);
+    if (count > first) {
+        memcpy(cb->buffer, data + first, count - first);
+    }
+
+    atomic_store_explicit(&cb->head, head + count, memory_order_release);
+
+    return count;
+}
+
+size_t spsc_circular_buffer_get_bulk(spsc_circular_buffer_t *cb,
+                                     uint8_t *data, size_t len) {
+    if (cb == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+
+    size_t tail = atomic_load_explicit(&cb->tail, memory_order_relaxed);
+    size_t stored = consumer_stored(cb, tail, len);
+    size_t count = len < stored ? len : stored;
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t offset = tail & cb->mask;
+    size_t first = cb->capacity - offset;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(data, cb->buffer + offset, first);
+    if (count > first) {
+        memcpy(data + first, cb->buffer, count - first);
+    }
+
+    atomic_store_explicit(&cb->tail, tail + count, memory_order_release);
+
+    return count;
+}
+
+size_t spsc_circular_buffer_write_reserve(spsc_circular_buffer_t *cb,
+                                          uint8_t **region) {
+    if (region != NULL) {
+        *region = NULL;
+    }
+    if (cb == NULL || region == NULL) {
+        return 0;
+    }
+
+    size_t head = atomic_load_explicit(&cb->head, memory_order_relaxed);
+    size_t offset = head & cb->mask;
+    size_t contiguous = cb->capacity - offset;
+
+    /* Reload tail unless the cached view already frees the whole run */
+    size_t free_bytes = producer_free(cb, head, contiguous);
+    if (free_bytes < contiguous) {
+        contiguous = free_bytes;
+    }
+    if (contiguous > 0) {
+        *region = cb->buffer + offset;
+    }
+
+    return contiguous;
+}
+
+int spsc_circular_buffer_write_commit(spsc_circular_buffer_t *cb,
+                                      size_t len) {
+    if (cb == NULL) {
+        return -1;
+    }
+
+    size_t head = atomic_load_explicit(&cb->head, memory_order_relaxed);
+    if (len > producer_free(cb, head, len)) {
+        return -1;
+    }
+
+    atomic_store_explicit(&cb->head, head + len, memory_order_release);
+
+    return 0;
+}
+
+size_t spsc_circular_buffer_read_reserve(spsc_circular_buffer_t *cb,
+                                         const uint8_t **region) {
+    if (region != NULL) {
+        *region = NULL;
+    }
+    if (cb == NULL || region == NULL) {
+        return 0;
+    }
+
+    size_t tail = atomic_load_explicit(&cb->tail, memory_order_relaxed);
+    size_t offset = tail & cb->mask;
+    size_t contiguous = cb->capacity - offset;
+
+    size_t stored = consumer_stored(cb, tail, contiguous);
+    if (stored < contiguous) {
+        contiguous = stored;
+    }
+    if (contiguous > 0) {
+        *region = cb->buffer + offset;
+    }
+
+    return contiguous;
+}
+
+int spsc_circular_buffer_read_commit(spsc_circular_buffer_t *cb, size_t len) {
+    if (cb == NULL) {
+        return -1;
+    }
+
+    size_t tail = atomic_load_explicit(&cb->tail, memory_order_relaxed);
+    if (len > consumer_stored(cb, tail, len)) {
+        return -1;
+    }
+
+    atomic_store_explicit(&cb->tail, tail + len, memory_order_release);
+
+    return 0;
+}
+
+size_t spsc_circular_buffer_size(const spsc_circular_buffer_t *cb) {
+    if (cb == NULL) {
+        return 0;
+    }
+
+    /* tail first: head only grows, so the difference cannot go negative */
+    size_t tail = atomic_load_explicit(&cb->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&cb->head, memory_order_acquire);
+    size_t stored = head - tail;
+
+    /* tail may have moved on while head was loaded */
+    return stored > cb->capacity ? cb->capacity : stored;
+}
+
+size_t spsc_circular_buffer_available(const spsc_circular_buffer_t *cb) {
+    if (cb == NULL) {
+        return 0;
+    }
+
+    return (cb->capacity - spsc_circular_buffer_size(cb));
+}
+
+bool spsc_circular_buffer_is_empty(const spsc_circular_buffer_t *cb) {
+    if (cb == NULL) {
+        return true;
+    }
+
+    return (spsc_circular_buffer_size(cb) == 0);
+}
+
+bool spsc_circular_buffer_is_full(const spsc_circular_buffer_t *cb) {
+    if (cb == NULL) {
+        return false;
+    }
+
+    return (spsc_circular_buffer_size(cb) >= cb->capacity);
+}
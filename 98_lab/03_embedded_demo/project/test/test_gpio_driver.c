@@ -178,3 +178,122 @@ void test_gpio_input_with_pullup(void) {
     gpio_read(4, 10, &state);
     TEST_ASSERT_EQUAL(GPIO_HIGH, state);
 }
+
+/* Initializes pins 0-7 of a port as outputs, the bus of the port tests */
+static void init_bus(uint8_t port) {
+    for (uint8_t pin = 0; pin < 8; pin++) {
+        gpio_config_t config = {
+            .port = port,
+            .pin = pin,
+            .dir = GPIO_OUTPUT,
+            .pull_up = false
+        };
+        gpio_init(&config);
+    }
+}
+
+void test_gpio_write_port_changes_only_masked_pins(void) {
+    init_bus(8);
+    gpio_mask_t values;
+    
+    TEST_ASSERT_EQUAL_INT(0, gpio_write_port(8, 0x00FF, 0x00A5));
+    TEST_ASSERT_EQUAL_INT(0, gpio_read_port(8, &values));
+    TEST_ASSERT_EQUAL_HEX16(0x00A5, values);
+    
+    /* Low nibble only; bits outside the mask are ignored */
+    TEST_ASSERT_EQUAL_INT(0, gpio_write_port(8, 0x000F, 0xFFF0));
+    gpio_read_port(8, &values);
+    TEST_ASSERT_EQUAL_HEX16(0x00A0, values);
+}
+
+void test_gpio_write_port_rejects_input_and_uninitialized_pins(void) {
+    init_bus(9);
+    gpio_config_t input = {
+        .port = 9,
+        .pin = 8,
+        .dir = GPIO_INPUT,
+        .pull_up = false
+    };
+    gpio_init(&input);
+    gpio_mask_t values;
+    
+    TEST_ASSERT_EQUAL_INT(-1, gpio_write_port(9, 0x01FF, 0x01FF));
+    TEST_ASSERT_EQUAL_INT(-1, gpio_set_port(9, 0x8000));
+    TEST_ASSERT_EQUAL_INT(-1, gpio_write_port(16, 0x0001, 0x0001));
+    
+    /* Nothing was written */
+    gpio_read_port(9, &values);
+    TEST_ASSERT_EQUAL_HEX16(0x0000, values);
+}
+
+void test_gpio_read_port_mixes_inputs_and_outputs(void) {
+    init_bus(10);
+    gpio_config_t input = {
+        .port = 10,
+        .pin = 12,
+        .dir = GPIO_INPUT,
+        .pull_up = false
+    };
+    gpio_init(&input);
+    gpio_mask_t values;
+    
+    gpio_write_port(10, 0x00FF, 0x0003);
+    gpio_simulate_input(10, 12, GPIO_HIGH);
+    /* Not initialized, so not reported */
+    gpio_simulate_input(10, 13, GPIO_HIGH);
+    
+    TEST_ASSERT_EQUAL_INT(0, gpio_read_port(10, &values));
+    TEST_ASSERT_EQUAL_HEX16(0x1003, values);
+    TEST_ASSERT_EQUAL_INT(-1, gpio_read_port(10, NULL));
+}
+
+void test_gpio_set_clear_toggle_port(void) {
+    init_bus(11);
+    gpio_mask_t values;
+    
+    TEST_ASSERT_EQUAL_INT(0, gpio_set_port(11, 0x00F0));
+    TEST_ASSERT_EQUAL_INT(0, gpio_clear_port(11, 0x0030));
+    TEST_ASSERT_EQUAL_INT(0, gpio_toggle_port(11, 0x0081));
+    
+    gpio_read_port(11, &values);
+    TEST_ASSERT_EQUAL_HEX16(0x0041, values);
+    
+    gpio_state_t state;
+    gpio_read(11, 6, &state);
+    TEST_ASSERT_EQUAL(GPIO_HIGH, state);
+}
+
+void test_gpio_pin_handle(void) {
+    init_bus(12);
+    gpio_pin_t clock;
+    
+    TEST_ASSERT_EQUAL_INT(0, gpio_pin_handle(12, 2, &clock));
+    
+    gpio_pin_set(clock);
+    TEST_ASSERT_EQUAL(GPIO_HIGH, gpio_pin_read(clock));
+    gpio_pin_toggle(clock);
+    TEST_ASSERT_EQUAL(GPIO_LOW, gpio_pin_read(clock));
+    gpio_pin_toggle(clock);
+    gpio_pin_clear(clock);
+    TEST_ASSERT_EQUAL(GPIO_LOW, gpio_pin_read(clock));
+    
+    /* Other pins of the port are untouched */
+    gpio_mask_t values;
+    gpio_pin_set(clock);
+    gpio_read_port(12, &values);
+    TEST_ASSERT_EQUAL_HEX16(0x0004, values);
+}
+
+void test_gpio_pin_handle_validates_once(void) {
+    gpio_pin_t handle;
+    
+    TEST_ASSERT_EQUAL_INT(-1, gpio_pin_handle(12, 15, &handle));  /* Not initialized */
+    TEST_ASSERT_EQUAL_INT(-1, gpio_pin_handle(16, 0, &handle));
+    TEST_ASSERT_EQUAL_INT(-1, gpio_pin_handle(12, 16, &handle));
+    TEST_ASSERT_EQUAL_INT(-1, gpio_pin_handle(12, 0, NULL));
+    
+    /* Inputs read through a handle too */
+    gpio_simulate_input(2, 4, GPIO_HIGH);
+    TEST_ASSERT_EQUAL_INT(0, gpio_pin_handle(2, 4, &handle));
+    TEST_ASSERT_EQUAL(GPIO_HIGH, gpio_pin_read(handle));
+}
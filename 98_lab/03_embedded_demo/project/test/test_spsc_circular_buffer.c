@@ -0,0 +1,249 @@
+/**
+ * @file test_spsc_circular_buffer.c
+ * @brief Unit tests for the lock-free SPSC circular buffer
+ */
+
+#include "unity.h"
+#include "spsc_circular_buffer.h"
+#include <stdint.h>
+
+#define BUFFER_SIZE 8
+
+static uint8_t storage[BUFFER_SIZE];
+static spsc_circular_buffer_t buffer;
+
+void setUp(void) {
+    /* Initialize buffer before each test */
+    spsc_circular_buffer_init(&buffer, storage, BUFFER_SIZE);
+}
+
+void tearDown(void) {
+    /* Cleanup after each test */
+}
+
+/* Moves head and tail to offset without leaving data behind */
+static void advance_to(size_t offset) {
+    uint8_t data;
+    for (size_t i = 0; i < offset; i++) {
+        spsc_circular_buffer_put(&buffer, 0);
+        spsc_circular_buffer_get(&buffer, &data);
+    }
+}
+
+void test_spsc_circular_buffer_init_success(void) {
+    uint8_t temp_storage[16];
+    spsc_circular_buffer_t temp_buffer;
+
+    TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_init(&temp_buffer, temp_storage, 16));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_size(&temp_buffer));
+    TEST_ASSERT_EQUAL_size_t(16, spsc_circular_buffer_available(&temp_buffer));
+    TEST_ASSERT_TRUE(spsc_circular_buffer_is_empty(&temp_buffer));
+    TEST_ASSERT_FALSE(spsc_circular_buffer_is_full(&temp_buffer));
+}
+
+void test_spsc_circular_buffer_init_invalid_arguments(void) {
+    uint8_t temp_storage[16];
+    spsc_circular_buffer_t temp_buffer;
+
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_init(NULL, temp_storage, 16));
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_init(&temp_buffer, NULL, 16));
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_init(&temp_buffer, temp_storage, 0));
+}
+
+void test_spsc_circular_buffer_init_rejects_non_power_of_two(void) {
+    uint8_t temp_storage[16];
+    spsc_circular_buffer_t temp_buffer;
+
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_init(&temp_buffer, temp_storage, 12));
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_init(&temp_buffer, temp_storage, 3));
+    TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_init(&temp_buffer, temp_storage, 1));
+}
+
+void test_spsc_circular_buffer_indices_on_separate_cache_lines(void) {
+    uintptr_t head = (uintptr_t)&buffer.head;
+    uintptr_t tail = (uintptr_t)&buffer.tail;
+
+    TEST_ASSERT_EQUAL_size_t(0, head % SPSC_CACHE_LINE_SIZE);
+    TEST_ASSERT_EQUAL_size_t(0, tail % SPSC_CACHE_LINE_SIZE);
+    TEST_ASSERT_TRUE(tail - head >= SPSC_CACHE_LINE_SIZE);
+}
+
+void test_spsc_circular_buffer_put_get_fifo_order(void) {
+    uint8_t data;
+
+    for (uint8_t i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_put(&buffer, i));
+    }
+    TEST_ASSERT_EQUAL_size_t(5, spsc_circular_buffer_size(&buffer));
+
+    for (uint8_t i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_get(&buffer, &data));
+        TEST_ASSERT_EQUAL_HEX8(i, data);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_get(&buffer, &data));
+}
+
+void test_spsc_circular_buffer_uses_every_slot(void) {
+    /* No slot is sacrificed to tell full from empty */
+    for (size_t i = 0; i < BUFFER_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_put(&buffer, (uint8_t)i));
+    }
+
+    TEST_ASSERT_TRUE(spsc_circular_buffer_is_full(&buffer));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_available(&buffer));
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_put(&buffer, 0xFF));
+}
+
+void test_spsc_circular_buffer_put_bulk_wraps(void) {
+    const uint8_t input[6] = {1, 2, 3, 4, 5, 6};
+    uint8_t data;
+
+    advance_to(5);
+
+    TEST_ASSERT_EQUAL_size_t(6, spsc_circular_buffer_put_bulk(&buffer, input, 6));
+
+    /* Three bytes at the end of the storage, three at the start */
+    TEST_ASSERT_EQUAL_HEX8(1, storage[5]);
+    TEST_ASSERT_EQUAL_HEX8(3, storage[7]);
+    TEST_ASSERT_EQUAL_HEX8(4, storage[0]);
+    TEST_ASSERT_EQUAL_HEX8(6, storage[2]);
+    for (uint8_t i = 1; i <= 6; i++) {
+        spsc_circular_buffer_get(&buffer, &data);
+        TEST_ASSERT_EQUAL_HEX8(i, data);
+    }
+}
+
+void test_spsc_circular_buffer_put_bulk_partial_when_nearly_full(void) {
+    const uint8_t input[BUFFER_SIZE] = {0};
+
+    spsc_circular_buffer_put(&buffer, 0x11);
+    spsc_circular_buffer_put(&buffer, 0x22);
+
+    TEST_ASSERT_EQUAL_size_t(BUFFER_SIZE - 2,
+                             spsc_circular_buffer_put_bulk(&buffer, input, BUFFER_SIZE));
+    TEST_ASSERT_TRUE(spsc_circular_buffer_is_full(&buffer));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_put_bulk(&buffer, input, 1));
+}
+
+void test_spsc_circular_buffer_get_bulk_wraps(void) {
+    const uint8_t input[7] = {10, 11, 12, 13, 14, 15, 16};
+    uint8_t output[BUFFER_SIZE] = {0};
+
+    advance_to(6);
+    spsc_circular_buffer_put_bulk(&buffer, input, 7);
+
+    /* Asking for more returns what is stored */
+    TEST_ASSERT_EQUAL_size_t(7, spsc_circular_buffer_get_bulk(&buffer, output, BUFFER_SIZE));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(input, output, 7);
+    TEST_ASSERT_TRUE(spsc_circular_buffer_is_empty(&buffer));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_get_bulk(&buffer, output, 1));
+}
+
+void test_spsc_circular_buffer_write_reserve_stops_at_wrap(void) {
+    uint8_t *region;
+
+    advance_to(5);
+
+    /* Eight bytes free but only three before the wrap */
+    TEST_ASSERT_EQUAL_size_t(3, spsc_circular_buffer_write_reserve(&buffer, &region));
+    TEST_ASSERT_EQUAL_PTR(&storage[5], region);
+
+    region[0] = 0xA0;
+    region[1] = 0xA1;
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_size(&buffer));
+    TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_write_commit(&buffer, 2));
+    TEST_ASSERT_EQUAL_size_t(2, spsc_circular_buffer_size(&buffer));
+
+    /* The next region starts after the committed bytes */
+    TEST_ASSERT_EQUAL_size_t(1, spsc_circular_buffer_write_reserve(&buffer, &region));
+    TEST_ASSERT_EQUAL_PTR(&storage[7], region);
+}
+
+void test_spsc_circular_buffer_write_reserve_stops_at_unread_data(void) {
+    uint8_t *region;
+    uint8_t data;
+
+    for (uint8_t i = 0; i < BUFFER_SIZE; i++) {
+        spsc_circular_buffer_put(&buffer, i);
+    }
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_write_reserve(&buffer, &region));
+    TEST_ASSERT_NULL(region);
+
+    spsc_circular_buffer_get(&buffer, &data);
+    spsc_circular_buffer_get(&buffer, &data);
+
+    TEST_ASSERT_EQUAL_size_t(2, spsc_circular_buffer_write_reserve(&buffer, &region));
+    TEST_ASSERT_EQUAL_PTR(&storage[0], region);
+}
+
+void test_spsc_circular_buffer_write_commit_rejects_overrun(void) {
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_write_commit(&buffer, BUFFER_SIZE + 1));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_size(&buffer));
+}
+
+void test_spsc_circular_buffer_read_reserve_in_place(void) {
+    const uint8_t input[6] = {1, 2, 3, 4, 5, 6};
+    const uint8_t *region;
+
+    advance_to(5);
+    spsc_circular_buffer_put_bulk(&buffer, input, 6);
+
+    /* Two regions: up to the wrap, then from the start */
+    TEST_ASSERT_EQUAL_size_t(3, spsc_circular_buffer_read_reserve(&buffer, &region));
+    TEST_ASSERT_EQUAL_PTR(&storage[5], region);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(input, region, 3);
+    TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_read_commit(&buffer, 3));
+
+    TEST_ASSERT_EQUAL_size_t(3, spsc_circular_buffer_read_reserve(&buffer, &region));
+    TEST_ASSERT_EQUAL_PTR(&storage[0], region);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(input + 3, region, 3);
+    TEST_ASSERT_EQUAL_INT(0, spsc_circular_buffer_read_commit(&buffer, 3));
+
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_read_reserve(&buffer, &region));
+    TEST_ASSERT_NULL(region);
+}
+
+void test_spsc_circular_buffer_read_commit_rejects_overrun(void) {
+    spsc_circular_buffer_put(&buffer, 0x42);
+
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_read_commit(&buffer, 2));
+    TEST_ASSERT_EQUAL_size_t(1, spsc_circular_buffer_size(&buffer));
+}
+
+void test_spsc_circular_buffer_many_wraps(void) {
+    uint8_t input[5];
+    uint8_t output[5];
+    uint8_t next = 0;
+    uint8_t expected = 0;
+
+    /* Odd-sized blocks land on every offset */
+    for (int round = 0; round < 100; round++) {
+        for (size_t i = 0; i < sizeof(input); i++) {
+            input[i] = next++;
+        }
+        TEST_ASSERT_EQUAL_size_t(5, spsc_circular_buffer_put_bulk(&buffer, input, 5));
+        TEST_ASSERT_EQUAL_size_t(5, spsc_circular_buffer_get_bulk(&buffer, output, 5));
+        for (size_t i = 0; i < sizeof(output); i++) {
+            TEST_ASSERT_EQUAL_HEX8(expected++, output[i]);
+        }
+    }
+    TEST_ASSERT_TRUE(spsc_circular_buffer_is_empty(&buffer));
+}
+
+void test_spsc_circular_buffer_null_arguments(void) {
+    uint8_t data;
+    uint8_t *region = storage;
+
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_put(NULL, 0x42));
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_get(NULL, &data));
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_get(&buffer, NULL));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_put_bulk(&buffer, NULL, 4));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_get_bulk(&buffer, NULL, 4));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_write_reserve(NULL, &region));
+    TEST_ASSERT_NULL(region);
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_write_commit(NULL, 1));
+    TEST_ASSERT_EQUAL_INT(-1, spsc_circular_buffer_read_commit(NULL, 1));
+    TEST_ASSERT_EQUAL_size_t(0, spsc_circular_buffer_size(NULL));
+    TEST_ASSERT_TRUE(spsc_circular_buffer_is_empty(NULL));
+    TEST_ASSERT_FALSE(spsc_circular_buffer_is_full(NULL));
+}
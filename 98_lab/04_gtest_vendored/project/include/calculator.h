@@ -1,8 +1,24 @@
 #ifndef MY_PROJECT_CALCULATOR_H_
 #define MY_PROJECT_CALCULATOR_H_
 
+#include <cstddef>
+
+#include "span.h"
+
 namespace my_project {
 
+// Outcome of a batch operation, for the whole batch rather than per
+// element
+struct BatchStatus {
+    // Some result did not fit in an int; those elements hold the
+    // wrapped value
+    bool overflow = false;
+    // Elements with a zero divisor; those hold NaN
+    size_t divide_by_zero = 0;
+
+    bool ok() const { return !overflow && divide_by_zero == 0; }
+};
+
 class Calculator {
  public:
     Calculator() = default;
@@ -12,6 +28,19 @@ class Calculator {
     int Subtract(int a, int b);
     int Multiply(int a, int b);
     double Divide(int a, int b);
+
+    // Element-wise out[i] = a[i] op b[i] over whole arrays. The loops have
+    // no branches or calls, so they vectorize at -O3; errors are
+    // collected into the returned status instead of stopping the batch.
+    // out may be a or b. Throws std::invalid_argument if the sizes
+    // differ.
+    BatchStatus Add(Span<const int> a, Span<const int> b, Span<int> out);
+    BatchStatus Subtract(Span<const int> a, Span<const int> b, Span<int> out);
+    BatchStatus Multiply(Span<const int> a, Span<const int> b, Span<int> out);
+    // A zero divisor gives NaN for that element and is counted, rather
+    // than throwing as Divide(int, int) does
+    BatchStatus Divide(Span<const int> a, Span<const int> b,
+                       Span<double> out);
 };
 
 }  // namespace my_project
@@ -0,0 +1,39 @@
+#ifndef MY_PROJECT_SPAN_H_
+#define MY_PROJECT_SPAN_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace my_project {
+
+// A pointer and a length, until the project moves to C++20's std::span.
+// Converts from any contiguous container with data() and size(), such as
+// std::vector or std::array; Span<const T> also from const containers.
+template <typename T>
+class Span {
+ public:
+    Span() = default;
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename Container,
+              typename = std::enable_if_t<std::is_convertible_v<
+                  decltype(std::declval<Container&>().data()), T*>>>
+    Span(Container& container)  // NOLINT(runtime/explicit)
+        : data_(container.data()), size_(container.size()) {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](size_t i) const { return data_[i]; }
+
+ private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace my_project
+
+#endif  // MY_PROJECT_SPAN_H_
@@ -2,18 +2,31 @@
 #define MY_PROJECT_STRING_UTILS_H_
 
 #include <string>
+#include <string_view>
 
 namespace my_project {
 
+// Case conversion is ASCII only, like std::toupper in the "C" locale,
+// and written so the compiler vectorizes it.
+
 // Converts string to uppercase
 std::string ToUpper(const std::string& input);
 
 // Converts string to lowercase
 std::string ToLower(const std::string& input);
 
+// Converts string to uppercase without copying
+void ToUpperInPlace(std::string& input);
+
+// Converts string to lowercase without copying
+void ToLowerInPlace(std::string& input);
+
 // Trims whitespace from both ends
 std::string Trim(const std::string& input);
 
+// Trims whitespace from both ends; a view into input, no copy
+std::string_view TrimView(std::string_view input);
+
 // Checks if string is empty or whitespace only
 bool IsBlank(const std::string& input);
 
@@ -25,6 +25,20 @@ TEST(StringUtilsTest, ToUpperHandlesEmptyString) {
     EXPECT_EQ(ToUpper(""), "");
 }
 
+TEST(StringUtilsTest, ToUpperLeavesNonLettersAlone) {
+    EXPECT_EQ(ToUpper("a@[`{z09\xe9"), "A@[`{Z09\xe9");
+}
+
+TEST(StringUtilsTest, ToUpperInPlaceConvertsWithoutCopy) {
+    std::string text = "price of btc/usd";
+    const char* data = text.data();
+    
+    ToUpperInPlace(text);
+    
+    EXPECT_EQ(text, "PRICE OF BTC/USD");
+    EXPECT_EQ(text.data(), data);
+}
+
 // =============================================================================
 // ToLower Tests
 // =============================================================================
@@ -41,6 +55,14 @@ TEST(StringUtilsTest, ToLowerHandlesMixedCase) {
     EXPECT_EQ(ToLower("HeLLo WoRLd"), "hello world");
 }
 
+TEST(StringUtilsTest, ToLowerInPlaceMatchesToLower) {
+    std::string text = "Mixed CASE Log Line 42";
+    
+    ToLowerInPlace(text);
+    
+    EXPECT_EQ(text, ToLower("Mixed CASE Log Line 42"));
+}
+
 // =============================================================================
 // Trim Tests
 // =============================================================================
@@ -73,6 +95,16 @@ TEST(StringUtilsTest, TrimHandlesTabs) {
     EXPECT_EQ(Trim("\t\thello\t\t"), "hello");
 }
 
+TEST(StringUtilsTest, TrimViewPointsIntoInput) {
+    const std::string text = " \t field \r\n";
+    
+    std::string_view trimmed = TrimView(text);
+    
+    EXPECT_EQ(trimmed, "field");
+    EXPECT_EQ(trimmed.data(), text.data() + 3);
+    EXPECT_TRUE(TrimView("   ").empty());
+}
+
 // =============================================================================
 // IsBlank Tests
 // =============================================================================
@@ -0,0 +1,110 @@
+/**
+ * @file CalculatorBenchmark.cpp
+ * @brief Batch Calculator operations against scalar loops
+ *
+ * The scalar loops chain a Calculator per element, the way array code
+ * used it before the batch operations; the divide loop catches the
+ * exception for each zero divisor. range(0) is the number of elements.
+ * BENCHMARK_MAIN is in StringUtilsBenchmark.cpp.
+ */
+
+#include "Calculator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// ============================================================
+// Inputs
+// ============================================================
+
+// Prices and quantities of an order book export; every 97th quantity is
+// zero, for the divide benchmarks
+struct Inputs {
+    explicit Inputs(size_t count) {
+        uint32_t state = 12345;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 1664525u + 1013904223u;
+            prices.push_back(100.0 + static_cast<double>(state >> 16) / 64.0);
+            quantities.push_back(
+                i % 97 == 0 ? 0.0 : static_cast<double>(i % 500));
+        }
+    }
+
+    std::vector<double> prices;
+    std::vector<double> quantities;
+};
+
+// ============================================================
+// Multiply
+// ============================================================
+
+void BM_MultiplyScalar(benchmark::State& state) {
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<double> out(in.prices.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = Calculator(in.prices[i])
+                         .multiply(in.quantities[i])
+                         .getResult();
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiplyScalar)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+void BM_MultiplyBatch(benchmark::State& state) {
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<double> out(in.prices.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            Calculator::multiply(in.prices, in.quantities, out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiplyBatch)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+// ============================================================
+// Divide
+// ============================================================
+
+void BM_DivideScalar(benchmark::State& state) {
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<double> out(in.prices.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            try {
+                out[i] = Calculator(in.prices[i])
+                             .divide(in.quantities[i])
+                             .getResult();
+            } catch (const std::invalid_argument&) {
+                out[i] = 0.0;
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DivideScalar)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+void BM_DivideBatch(benchmark::State& state) {
+    const Inputs in(static_cast<size_t>(state.range(0)));
+    std::vector<double> out(in.prices.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            Calculator::divide(in.prices, in.quantities, out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DivideBatch)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+}  // namespace
@@ -0,0 +1,166 @@
+/**
+ * @file StringUtilsBenchmark.cpp
+ * @brief StringUtils against the byte-at-a-time implementations
+ *
+ * The Reference functions are the previous StringUtils bodies:
+ * std::transform with ::toupper, and split through std::stringstream.
+ */
+
+#include "StringUtils.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ============================================================
+// Reference implementations
+// ============================================================
+
+std::string referenceToUpper(const std::string& str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+    return result;
+}
+
+std::vector<std::string> referenceSplit(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(str);
+    std::string token;
+    while (std::getline(ss, token, delimiter)) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+// ============================================================
+// Inputs
+// ============================================================
+
+// A log line of mixed case, repeated to length bytes
+std::string logText(size_t length) {
+    const std::string line =
+        "2026-10-14T08:11:13Z INFO ingest: Fetched 512 Points for BTC/usd in 3ms\n";
+    std::string text;
+    while (text.size() < length) {
+        text += line;
+    }
+    text.resize(length);
+    return text;
+}
+
+// A CSV row of fields short fields, as in a price export
+std::string csvRow(size_t fields) {
+    std::string row;
+    for (size_t i = 0; i < fields; ++i) {
+        row += (i == 0 ? "" : ",") + std::to_string(1700000000 + i * 37);
+    }
+    return row;
+}
+
+// ============================================================
+// Case conversion; range(0): bytes
+// ============================================================
+
+void BM_ToUpperReference(benchmark::State& state) {
+    const std::string text = logText(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(referenceToUpper(text));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ToUpperReference)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+void BM_ToUpper(benchmark::State& state) {
+    const std::string text = logText(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(StringUtils::toUpper(text));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ToUpper)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+void BM_ToUpperInPlace(benchmark::State& state) {
+    std::string text = logText(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        // Alternating keeps every pass doing the same work
+        StringUtils::toUpperInPlace(text);
+        StringUtils::toLowerInPlace(text);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_ToUpperInPlace)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+// ============================================================
+// Trim
+// ============================================================
+
+void BM_Trim(benchmark::State& state) {
+    const std::string field = "   BTC/USD 64210.5 \t\r\n";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(StringUtils::trim(field));
+    }
+}
+BENCHMARK(BM_Trim);
+
+void BM_TrimView(benchmark::State& state) {
+    const std::string field = "   BTC/USD 64210.5 \t\r\n";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(StringUtils::trimView(field));
+    }
+}
+BENCHMARK(BM_TrimView);
+
+// ============================================================
+// Split; range(0): fields in the row
+// ============================================================
+
+void BM_SplitReference(benchmark::State& state) {
+    const std::string row = csvRow(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(referenceSplit(row, ','));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SplitReference)->Arg(8)->Arg(64);
+
+void BM_Split(benchmark::State& state) {
+    const std::string row = csvRow(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(StringUtils::split(row, ','));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Split)->Arg(8)->Arg(64);
+
+void BM_SplitView(benchmark::State& state) {
+    const std::string row = csvRow(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(StringUtils::splitView(row, ','));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SplitView)->Arg(8)->Arg(64);
+
+void BM_SplitTokens(benchmark::State& state) {
+    const std::string row = csvRow(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        size_t bytes = 0;
+        for (std::string_view field : StringUtils::tokens(row, ',')) {
+            bytes += field.size();
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SplitTokens)->Arg(8)->Arg(64);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -8,8 +8,31 @@
 #ifndef CALCULATOR_H
 #define CALCULATOR_H
 
+#include <cstddef>
 #include <string>
 
+#include "Span.h"
+
+/**
+ * @struct BatchStatus
+ * @brief Outcome of a batch operation, for the whole batch
+ *
+ * One flag and one count instead of a status per element, so the batch
+ * loops can collect them without branches.
+ */
+struct BatchStatus {
+    /// Some result is not finite: it overflowed, or an input was inf or NaN
+    bool overflow = false;
+    /// Elements with a zero divisor; those hold NaN
+    size_t divideByZero = 0;
+
+    /**
+     * @brief Check that every element has a finite result
+     * @return true if there was no overflow and no zero divisor
+     */
+    bool ok() const { return !overflow && divideByZero == 0; }
+};
+
 /**
  * @class Calculator
  * @brief Performs basic arithmetic operations
@@ -81,6 +104,37 @@ public:
      */
     std::string toString() const;
 
+    /**
+     * @name Batch operations
+     * Element-wise out[i] = a[i] op b[i] over whole arrays, independent
+     * of the current result. The loops have no branches or calls, so the
+     * compiler vectorizes them at -O3; errors are collected into the
+     * returned status instead of stopping the batch. out may be a or b.
+     *
+     * @code
+     * std::vector<double> notional(prices.size());
+     * BatchStatus status = Calculator::multiply(prices, quantities, notional);
+     * @endcode
+     *
+     * @throws std::invalid_argument if the sizes differ
+     * @{
+     */
+    static BatchStatus add(Span<const double> a, Span<const double> b,
+                           Span<double> out);
+    static BatchStatus subtract(Span<const double> a, Span<const double> b,
+                                Span<double> out);
+    static BatchStatus multiply(Span<const double> a, Span<const double> b,
+                                Span<double> out);
+    /**
+     * @brief Element-wise division
+     *
+     * A zero divisor gives NaN for that element and is counted in
+     * BatchStatus::divideByZero, rather than throwing as divide() does.
+     */
+    static BatchStatus divide(Span<const double> a, Span<const double> b,
+                              Span<double> out);
+    /** @} */
+
 private:
     double m_result;  ///< Current calculation result
 };
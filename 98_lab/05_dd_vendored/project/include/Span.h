@@ -0,0 +1,62 @@
+/**
+ * @file Span.h
+ * @brief Non-owning view of a contiguous array
+ * @author Documentation Demo
+ * @date 2026-10-14
+ */
+
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class Span
+ * @brief A pointer and a length, standing in for C++20's std::span
+ *
+ * Converts from any contiguous container with data() and size(), such as
+ * std::vector or std::array; Span<const T> also from const containers.
+ * The container must outlive the span.
+ *
+ * @tparam T Element type, const for a read-only view
+ */
+template <typename T>
+class Span {
+public:
+    /**
+     * @brief Empty span
+     */
+    Span() = default;
+
+    /**
+     * @brief View of size elements from data
+     * @param data First element
+     * @param size Number of elements
+     */
+    Span(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    /**
+     * @brief View of a whole container
+     * @param container Container with contiguous data() and size()
+     */
+    template <typename Container,
+              typename = std::enable_if_t<std::is_convertible_v<
+                  decltype(std::declval<Container&>().data()), T*>>>
+    Span(Container& container)
+        : m_data(container.data()), m_size(container.size()) {}
+
+    T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+    T& operator[](size_t i) const { return m_data[i]; }
+
+private:
+    T* m_data = nullptr;  ///< First element
+    size_t m_size = 0;    ///< Number of elements
+};
+
+#endif // SPAN_H
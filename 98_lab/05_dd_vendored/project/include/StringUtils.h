@@ -8,7 +8,10 @@
 #ifndef STRINGUTILS_H
 #define STRINGUTILS_H
 
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -17,9 +20,16 @@
  * 
  * This class contains static methods for string manipulation
  * such as trimming, splitting, and case conversion.
+ *
+ * Case conversion is ASCII only, like std::toupper in the default "C"
+ * locale, and converts 16 bytes at a time with SSE2 or NEON where the
+ * target has them. The *InPlace and *View variants allocate nothing,
+ * for use on ingestion paths such as log and CSV parsing.
  */
 class StringUtils {
 public:
+    class SplitRange;
+
     /**
      * @brief Convert string to uppercase
      * @param str The input string
@@ -34,6 +44,18 @@ public:
      */
     static std::string toLower(const std::string& str);
     
+    /**
+     * @brief Convert string to uppercase without copying
+     * @param str The string to convert
+     */
+    static void toUpperInPlace(std::string& str);
+    
+    /**
+     * @brief Convert string to lowercase without copying
+     * @param str The string to convert
+     */
+    static void toLowerInPlace(std::string& str);
+    
     /**
      * @brief Remove leading and trailing whitespace
      * @param str The input string
@@ -41,14 +63,54 @@ public:
      */
     static std::string trim(const std::string& str);
     
+    /**
+     * @brief Remove leading and trailing whitespace without copying
+     * @param str The input string
+     * @return View of the trimmed part of str
+     */
+    static std::string_view trimView(std::string_view str);
+    
+    /**
+     * @brief Remove leading and trailing whitespace in place
+     * @param str The string to trim; keeps its capacity
+     */
+    static void trimInPlace(std::string& str);
+    
     /**
      * @brief Split a string by delimiter
      * @param str The input string
      * @param delimiter The delimiter character
      * @return Vector of split strings
+     *
+     * Like std::getline: an empty string gives no tokens, and a
+     * trailing delimiter does not start an empty last token.
      */
     static std::vector<std::string> split(const std::string& str, char delimiter);
     
+    /**
+     * @brief Split a string by delimiter into views
+     * @param str The input string; must outlive the views
+     * @param delimiter The delimiter character
+     * @return Views of the tokens, as split() would return them
+     */
+    static std::vector<std::string_view> splitView(std::string_view str,
+                                                   char delimiter);
+    
+    /**
+     * @brief Split a string lazily
+     * @param str The input string; must outlive the range
+     * @param delimiter The delimiter character
+     * @return Range over the tokens split() would return, found one at
+     *         a time as it is iterated, without allocating
+     *
+     * @code
+     * for (std::string_view field : StringUtils::tokens(line, ',')) {
+     *     parse(field);
+     * }
+     * @endcode
+     */
+    static SplitRange tokens(std::string_view str, char delimiter);
+    
     /**
      * @brief Check if string starts with a prefix
      * @param str The input string
@@ -77,4 +139,85 @@ private:
     StringUtils() = delete;
 };
 
+/**
+ * @class StringUtils::SplitRange
+ * @brief Forward range of the tokens of a string, from tokens()
+ */
+class StringUtils::SplitRange {
+public:
+    /**
+     * @brief Forward iterator yielding one token per step
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        /** @brief The end iterator */
+        Iterator() = default;
+
+        Iterator(std::string_view str, char delimiter)
+            : m_rest(str), m_delimiter(delimiter), m_atEnd(false) {
+            advance();
+        }
+
+        reference operator*() const { return m_token; }
+        pointer operator->() const { return &m_token; }
+
+        Iterator& operator++() {
+            advance();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            advance();
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return m_atEnd == other.m_atEnd &&
+                   (m_atEnd || m_token.data() == other.m_token.data());
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        void advance() {
+            if (m_rest.empty()) {
+                m_atEnd = true;
+                return;
+            }
+            size_t pos = m_rest.find(m_delimiter);
+            if (pos == std::string_view::npos) {
+                m_token = m_rest;
+                m_rest = std::string_view();
+            } else {
+                m_token = m_rest.substr(0, pos);
+                m_rest.remove_prefix(pos + 1);
+            }
+        }
+
+        std::string_view m_rest;
+        std::string_view m_token;
+        char m_delimiter = '\0';
+        bool m_atEnd = true;
+    };
+
+    SplitRange(std::string_view str, char delimiter)
+        : m_str(str), m_delimiter(delimiter) {}
+
+    Iterator begin() const { return Iterator(m_str, m_delimiter); }
+    Iterator end() const { return Iterator(); }
+
+private:
+    std::string_view m_str;
+    char m_delimiter;
+};
+
 #endif // STRINGUTILS_H
@@ -4,10 +4,62 @@
  */
 
 #include "Calculator.h"
+#include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 #include <iomanip>
 
+namespace {
+
+uint64_t bitsOf(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// All bits clear for a finite value, some set for inf and NaN
+uint64_t nonFiniteBits(double value) {
+    return bitsOf(value - value);
+}
+
+void checkSizes(size_t a, size_t b, size_t out) {
+    if (a != b || a != out) {
+        throw std::invalid_argument("Batch sizes differ");
+    }
+}
+
+/**
+ * @brief out[i] = op(a[i], b[i]), noting non-finite results
+ *
+ * r - r is +0.0, all bits clear, for a finite r and NaN for inf or NaN,
+ * so OR-ing its bits into one word finds them without a branch. The
+ * batch loops work on bits rather than with double compares, which keep
+ * GCC from vectorizing them.
+ */
+template <typename Op>
+BatchStatus elementWise(Span<const double> a, Span<const double> b,
+                        Span<double> out, Op op) {
+    checkSizes(a.size(), b.size(), out.size());
+    uint64_t nonFinite = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const double result = op(a[i], b[i]);
+        nonFinite |= nonFiniteBits(result);
+        out[i] = result;
+    }
+    BatchStatus status;
+    status.overflow = nonFinite != 0;
+    return status;
+}
+
+}  // namespace
+
 Calculator::Calculator() : m_result(0.0) {
 }
 
@@ -53,3 +105,46 @@ std::string Calculator::toString() const {
     oss << std::fixed << std::setprecision(2) << m_result;
     return oss.str();
 }
+
+BatchStatus Calculator::add(Span<const double> a, Span<const double> b,
+                            Span<double> out) {
+    return elementWise(a, b, out, [](double x, double y) { return x + y; });
+}
+
+BatchStatus Calculator::subtract(Span<const double> a, Span<const double> b,
+                                 Span<double> out) {
+    return elementWise(a, b, out, [](double x, double y) { return x - y; });
+}
+
+BatchStatus Calculator::multiply(Span<const double> a, Span<const double> b,
+                                 Span<double> out) {
+    return elementWise(a, b, out, [](double x, double y) { return x * y; });
+}
+
+BatchStatus Calculator::divide(Span<const double> a, Span<const double> b,
+                               Span<double> out) {
+    checkSizes(a.size(), b.size(), out.size());
+    constexpr uint64_t magnitudeBits = 0x7fffffffffffffff;
+    constexpr uint64_t oneBits = 0x3ff0000000000000;  // 1.0
+    constexpr uint64_t nanBits = 0x7ff8000000000000;  // quiet NaN
+    uint64_t nonFinite = 0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const uint64_t divisor = bitsOf(b[i]);
+        // 1 for +0.0 and -0.0: only a zero magnitude sets bit 63 when 1
+        // is subtracted
+        const uint64_t zero = ((divisor & magnitudeBits) - 1) >> 63;
+        const uint64_t mask = 0 - zero;
+        // Divide by +-1.0 where the divisor is zero, then OR the NaN bits
+        // into that lane; selecting between division results instead
+        // would keep the loop scalar, as the division may trap
+        const double quotient = a[i] / fromBits(divisor | (mask & oneBits));
+        nonFinite |= nonFiniteBits(quotient);
+        out[i] = fromBits(bitsOf(quotient) | (mask & nanBits));
+        zeros += zero;
+    }
+    BatchStatus status;
+    status.overflow = nonFinite != 0;
+    status.divideByZero = zeros;
+    return status;
+}
@@ -4,43 +4,128 @@
  */
 
 #include "StringUtils.h"
-#include <algorithm>
-#include <sstream>
-#include <cctype>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const char* const kWhitespace = " \t\n\r";
+
+/**
+ * @brief Flip the case bit of every byte in [first, first + 25]
+ *
+ * 'a' flips lowercase letters to uppercase, 'A' the other way round;
+ * bytes outside the range, non-ASCII ones included, are left alone.
+ * SSE2 is part of x86-64 and NEON of AArch64, so there is no runtime
+ * dispatch; other targets take the scalar loop.
+ */
+void flipCase(char* data, size_t size, char first) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Shift the range to the bottom of the signed bytes, so one signed
+    // compare tests both ends
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80 - first));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(0x80 + 26));
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i inRange = _mm_cmplt_epi8(_mm_add_epi8(bytes, bias), limit);
+        bytes = _mm_xor_si128(bytes, _mm_and_si128(inRange, caseBit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), bytes);
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t start = vdupq_n_u8(static_cast<uint8_t>(first));
+    const uint8x16_t letters = vdupq_n_u8(26);
+    const uint8x16_t caseBit = vdupq_n_u8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(data + i);
+        uint8x16_t v = vld1q_u8(bytes);
+        uint8x16_t inRange = vcltq_u8(vsubq_u8(v, start), letters);
+        vst1q_u8(bytes, veorq_u8(v, vandq_u8(inRange, caseBit)));
+    }
+#endif
+    for (; i < size; ++i) {
+        unsigned char offset = static_cast<unsigned char>(data[i] - first);
+        if (offset < 26) {
+            data[i] ^= 0x20;
+        }
+    }
+}
+
+}  // namespace
 
 std::string StringUtils::toUpper(const std::string& str) {
     std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+    toUpperInPlace(result);
     return result;
 }
 
 std::string StringUtils::toLower(const std::string& str) {
     std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    toLowerInPlace(result);
     return result;
 }
 
+void StringUtils::toUpperInPlace(std::string& str) {
+    flipCase(str.data(), str.size(), 'a');
+}
+
+void StringUtils::toLowerInPlace(std::string& str) {
+    flipCase(str.data(), str.size(), 'A');
+}
+
 std::string StringUtils::trim(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) {
-        return "";
+    return std::string(trimView(str));
+}
+
+std::string_view StringUtils::trimView(std::string_view str) {
+    size_t start = str.find_first_not_of(kWhitespace);
+    if (start == std::string_view::npos) {
+        return std::string_view();
     }
-    size_t end = str.find_last_not_of(" \t\n\r");
+    size_t end = str.find_last_not_of(kWhitespace);
     return str.substr(start, end - start + 1);
 }
 
+void StringUtils::trimInPlace(std::string& str) {
+    size_t end = str.find_last_not_of(kWhitespace);
+    if (end == std::string::npos) {
+        str.clear();
+        return;
+    }
+    str.erase(end + 1);
+    str.erase(0, str.find_first_not_of(kWhitespace));
+}
+
 std::vector<std::string> StringUtils::split(const std::string& str, char delimiter) {
     std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
     
-    while (std::getline(ss, token, delimiter)) {
+    for (std::string_view token : StringUtils::tokens(str, delimiter)) {
+        tokens.emplace_back(token);
+    }
+    
+    return tokens;
+}
+
+std::vector<std::string_view> StringUtils::splitView(std::string_view str,
+                                                     char delimiter) {
+    std::vector<std::string_view> tokens;
+    
+    for (std::string_view token : StringUtils::tokens(str, delimiter)) {
         tokens.push_back(token);
     }
     
     return tokens;
 }
 
+StringUtils::SplitRange StringUtils::tokens(std::string_view str, char delimiter) {
+    return SplitRange(str, delimiter);
+}
+
 bool StringUtils::startsWith(const std::string& str, const std::string& prefix) {
     if (prefix.length() > str.length()) {
         return false;
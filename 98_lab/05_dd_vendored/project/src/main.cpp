@@ -12,6 +12,7 @@
 #include "StringUtils.h"
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 /**
  * @brief Demonstrates calculator operations
@@ -37,6 +38,17 @@ void demonstrateCalculator() {
     std::cout << "Result of 100 / 4 - 10 = " 
               << calc.getResult() << std::endl;
     
+    // Whole arrays at once; a zero divisor gives NaN instead of throwing
+    std::vector<double> totals = {250.0, 90.0, 12.5};
+    std::vector<double> counts = {4.0, 0.0, 5.0};
+    std::vector<double> averages(totals.size());
+    BatchStatus status = Calculator::divide(totals, counts, averages);
+    
+    std::cout << "Averages of {250, 90, 12.5} / {4, 0, 5} = {"
+              << averages[0] << ", " << averages[1] << ", " << averages[2]
+              << "}, " << status.divideByZero << " zero divisor(s)"
+              << std::endl;
+    
     std::cout << std::endl;
 }
 
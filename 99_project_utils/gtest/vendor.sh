@@ -56,6 +56,7 @@ docker exec "$TMP_CONTAINER" bash -c "
         git \
         libgtest-dev \
         libgmock-dev \
+        libbenchmark-dev \
         gcovr \
         lcov \
         valgrind \
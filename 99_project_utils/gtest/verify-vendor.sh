@@ -74,6 +74,7 @@ if [ -d "apt-packages" ]; then
             "cmake"
             "libgtest-dev"
             "libgmock-dev"
+            "libbenchmark-dev"
             "gcovr"
             "lcov"
         )